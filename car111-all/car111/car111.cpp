@@ -38,6 +38,7 @@
 #include <stdlib.h> 
 #include <string.h> 
 #include <math.h>
+#include <time.h>
 
 #include <tgf.h> 
 #include <track.h> 
@@ -46,17 +47,54 @@
 #include <robottools.h>
 #include <robot.h>
 
-#undef _name  // interferes with a MACRO in fuzzylite
 #include "fuzzy_controller.h"
+#include "telemetry_recorder.h"
+
+
+// record telemetry of each tick ( 1 or 0 ). The robot only copies a record
+// to a ring buffer of TELEMETRY_BUFFER_SIZE records and a writer thread
+// appends encoded blocks to telemetry file of the track.
+#define RECORD_TELEMETRY              1
+#define TELEMETRY_BUFFER_SIZE         8192
+// maximum length of telemetry, fuzzy table and fuzzy parameter file names
+#define FILE_NAME_BUFFER_SIZE         1024
+// telemetry file name for a given track ( see telemetry_format.h )
+#define TELEMETRY_FILE_NAME_FORMAT    "%s/%s%s.%s"
+#define TELEMETRY_FILE_NAME(track_name)  \
+    getenv("HOME"), ".torcs/drivers/car111/telemetry_", track_name, "tlm"
+
+// interpolate fuzzy outputs from fuzzy table ( 1 or 0 ) made by car111_fuzzy_table
+// tool, instead of running fuzzy engine at each tick. Engine is still used for
+// inputs outside exact cells of the table ( and for all inputs without the file ).
+#define USE_FUZZY_TABLE               1
+// fuzzy table file name ( see fuzzy_table.h )
+#define FUZZY_TABLE_FILE_NAME_FORMAT  "%s/%s"
+#define FUZZY_TABLE_FILE_NAME  \
+    getenv("HOME"), ".torcs/drivers/car111/fuzzy_table.bin"
+
+// use terms of fuzzy parameter file ( 1 or 0 ) made by car111_fuzzy_tune tool,
+// instead of compiled terms, when the file is there ( fuzzy table is then only
+// used if it was made for version of the parameters )
+#define USE_FUZZY_PARAMETERS          1
+// fuzzy parameter file name ( see fuzzy_parameters.h )
+#define FUZZY_PARAMETERS_FILE_NAME_FORMAT  "%s/%s"
+#define FUZZY_PARAMETERS_FILE_NAME  \
+    getenv("HOME"), ".torcs/drivers/car111/fuzzy_parameters.txt"
 
 
 static tTrack    *curTrack;
 
-static controller::FuzzyController m_fuzzy_controller;
+// fuzzy controller of the car ( created by initTrack, so that nothing is set
+// up when the module is loaded, and deleted when the car is shut down )
+static controller::FuzzyController * m_fuzzy_controller = NULL;
 
 static const int SC = 1;
 static float distance_raced = 0;
 
+// telemetry of the car and ticks driven in this race
+static controller_telemetry::telemetry_recorder m_telemetry;
+static unsigned int m_tick = 0;
+
 
 static void initTrack(int index, tTrack* track, void *carHandle, void **carParmHandle, tSituation *s);
 static void newrace(int index, tCarElt* car, tSituation *s);
@@ -64,6 +102,7 @@ static void drive(int index, tCarElt* car, tSituation *s);
 static void endrace(int index, tCarElt *car, tSituation *s);
 static void shutdown(int index);
 static int  InitFuncPt(int index, void *pt);
+static void load_fuzzy_controller();
 
 
 /* 
@@ -104,23 +143,71 @@ InitFuncPt(int index, void *pt)
 
 /* Called for every track change or new race. */
 static void  
-initTrack(int index, tTrack* track, void *carHandle, void **carParmHandle, tSituation *s)
+initTrack(int /* index */, tTrack* track, void * /* carHandle */, void **carParmHandle, tSituation * /* s */)
 {
     curTrack = track;
     *carParmHandle = NULL;
+
+    if(m_fuzzy_controller == NULL)
+    {
+        load_fuzzy_controller();
+    }
+}
+
+/* Creates fuzzy controller ( and loads its fuzzy parameters and table ) and
+ * prints time it took. */
+static void
+load_fuzzy_controller()
+{
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    m_fuzzy_controller = new controller::FuzzyController();
+    if(USE_FUZZY_PARAMETERS)
+    {
+        char fuzzy_parameters_file_name[FILE_NAME_BUFFER_SIZE];
+        sprintf(fuzzy_parameters_file_name, FUZZY_PARAMETERS_FILE_NAME_FORMAT,
+                FUZZY_PARAMETERS_FILE_NAME);
+        m_fuzzy_controller->use_parameters(fuzzy_parameters_file_name);
+    }
+    if(USE_FUZZY_TABLE)
+    {
+        char fuzzy_table_file_name[FILE_NAME_BUFFER_SIZE];
+        sprintf(fuzzy_table_file_name, FUZZY_TABLE_FILE_NAME_FORMAT, FUZZY_TABLE_FILE_NAME);
+        m_fuzzy_controller->use_table(fuzzy_table_file_name);
+    }
+
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Fuzzy Controller - ready in %.3f ms\n",
+            (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) * 1e-6);
 }
 
 /* Start a new race. */
 static void  
-newrace(int index, tCarElt* car, tSituation *s)
+newrace(int /* index */, tCarElt* /* car */, tSituation * /* s */)
 {
     // reset distance raced
     distance_raced = 0;
+
+    // race is identified by microseconds of real time at its start
+    m_tick = 0;
+    if(RECORD_TELEMETRY)
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+
+        char telemetry_file_name[FILE_NAME_BUFFER_SIZE];
+        sprintf(telemetry_file_name, TELEMETRY_FILE_NAME_FORMAT,
+                TELEMETRY_FILE_NAME(curTrack->name));
+        m_telemetry.start(telemetry_file_name,
+                now.tv_sec * 1000000ULL + now.tv_nsec / 1000, TELEMETRY_BUFFER_SIZE);
+    }
 }
 
 /* Drive during race. */
 static void  
-drive(int index, tCarElt* car, tSituation *s)
+drive(int /* index */, tCarElt* car, tSituation *s)
 {
     // clear previous values
     memset((void *)&car->ctrl, 0, sizeof(tCarCtrl));
@@ -154,7 +241,7 @@ drive(int index, tCarElt* car, tSituation *s)
     inputs.stability = 0;
 
     // run engine for fuzzy outputs
-    controller::fuzzy_outputs outputs = m_fuzzy_controller.get_output(&inputs);
+    controller::fuzzy_outputs outputs = m_fuzzy_controller->get_output(&inputs);
 
     // set outputs
     car->ctrl.gear = outputs.gear;
@@ -162,20 +249,61 @@ drive(int index, tCarElt* car, tSituation *s)
     car->ctrl.brakeCmd = outputs.brake;
     car->ctrl.accelCmd = outputs.accel;
 
+    // telemetry of this tick is put in buffer of the recorder ( it is
+    // written by its writer thread )
+    if(m_telemetry.is_recording())
+    {
+        controller_telemetry::telemetry_record record;
+        record.tick = m_tick;
+        record.time = s->currentTime;
+        record.segment_id = car->_trkPos.seg->id;
+        record.speed_x = car->_speed_x;
+        record.speed_y = car->_speed_y;
+        record.accel_x = car->_accel_x;
+        record.to_left = car->_trkPos.toLeft;
+        record.to_right = car->_trkPos.toRight;
+        record.damage = car->_dammage;
+        record.path = inputs.path;
+        record.next_path = inputs.next_path;
+        record.gear = outputs.gear;
+        record.steer = outputs.steer;
+        record.accel = outputs.accel;
+        record.brake = outputs.brake;
+        record.Q_accel = TELEMETRY_NO_Q_ACTION;
+        record.reward = 0;
+        m_telemetry.record(record);
+    }
+    m_tick++;
+
     // update distance raced
     distance_raced = car->_distRaced;
 }
 
 /* End of the current race */
 static void
-endrace(int index, tCarElt *car, tSituation *s)
+endrace(int /* index */, tCarElt * /* car */, tSituation * /* s */)
 {
 }
 
 /* Called before the module is unloaded */
 static void
-shutdown(int index)
+shutdown(int /* index */)
 {
+    // remaining telemetry is written and index of the race is appended
+    if(m_telemetry.is_recording())
+    {
+        m_telemetry.stop();
+
+        controller_telemetry::telemetry_stats telemetry_stats;
+        m_telemetry.get_stats(telemetry_stats);
+        printf("telemetry - %lld records, %lld dropped, %lld bytes\n",
+                telemetry_stats.records, telemetry_stats.dropped_records,
+                telemetry_stats.bytes_written);
+    }
+
+    delete m_fuzzy_controller;
+    m_fuzzy_controller = NULL;
+
     printf("*** shutdown *** total distance raced - %f\n", distance_raced);
 }
 
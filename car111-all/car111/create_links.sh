@@ -8,5 +8,5 @@
 #
 
 
-find . -mindepth 2 \( -iname '*\.h' -o -iname '*\.cpp' \) -type f -ok ln -sf {} \;
+find -L . -mindepth 2 \( -iname '*\.h' -o -iname '*\.cpp' \) -type f -ok ln -sf {} \;
 
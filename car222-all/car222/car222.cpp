@@ -58,6 +58,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
 
 #include <tgf.h>
 #include <track.h>
@@ -66,33 +69,74 @@
 #include <robottools.h>
 #include <robot.h>
 
-#undef _name  // interferes with a MACRO in fuzzylite
 #include "fuzzy_controller.h"
 #include "q_learning.h"
 #include "car222_race_config.h"
 #include "race_reward.h"
 #include "car_utils.h"
+#include "telemetry_recorder.h"
 
 
 // maximum length of Q value file name
 #define FILE_NAME_BUFFER_SIZE         1024
-// speed y is clipped to this value
-#define SPEED_Y_CLIP_VALUE            1
-// distance on left/right side of the track is clipped to this value
-#define TRACK_SIDE_CLIP_DISTANCE      6
+// maximum number of car222 cars ( robot indices ) in a race
+#define CAR222_MAX_INSTANCES          10
 
 
 extern tRmInfo	*ReInfo;
 
 static tTrack    *curTrack;
 
-static controller::FuzzyController m_fuzzy_controller;
+/**
+ * a car222 car in the race. Each car has its own Q Learner ( its own
+ * transitions and rewards ) and fuzzy controller ( its own gear hysteresis
+ * and locked outputs ), and all of them update the same Q table.
+ **/
+typedef struct car222_instance_struct
+{
 
-static controller::QLearner m_q_learner(controller::_Q_maps_storage);
+    // fuzzy controller of the car ( created by initTrack, so that nothing is
+    // set up when the module is loaded, and deleted when the car is shut down )
+    controller::FuzzyController * fuzzy_controller;
+    // Q Learner of the car ( NULL when it is not in the race )
+    controller::QLearner * q_learner;
+    // damages of the car after previous reward
+    float prev_damages;
+    float distance_raced;
+    // non-zero after the car has gone outside the track ( in TRAINING_MODE )
+    int is_out_of_track;
+    // steps of the car in this race ( if trajectories are recorded )
+    std::vector<controller_storage::Q_trajectory_step> trajectory;
+    // telemetry of the car and ticks driven in this race
+    controller_telemetry::telemetry_recorder telemetry;
+    unsigned int tick;
+
+} car222_instance;
+
+// cars by robot index ( index 1 is at 0 )
+static car222_instance m_instances[CAR222_MAX_INSTANCES];
+// number of cars in this race and number of them that have been shut down
+static int m_instances_in_race = 0;
+static int m_instances_shut_down = 0;
+// number of cars that are racing ( not outside the track )
+static int m_racing_instances = 0;
+// id of this race in telemetry files ( microseconds of real time at its start )
+static unsigned long long int m_race_id = 0;
 
 static const int SC = 1;
-static float distance_raced = 0;
 static char QLearner_File[FILE_NAME_BUFFER_SIZE] = "";
+static char QLearner_Binary_File[FILE_NAME_BUFFER_SIZE] = "";
+
+#ifdef TRAINING_MODE
+// configuration of training farm ( "worker_count" is 0 if not a worker )
+static controller_storage::Q_farm_config m_farm_config;
+// binary Q value file of this worker of training farm
+static char QLearner_Worker_File[FILE_NAME_BUFFER_SIZE] = "";
+// trajectory log of the track ( if trajectories are recorded )
+static char Trajectory_File[FILE_NAME_BUFFER_SIZE] = "";
+// version of fuzzy controller that Q values of this training are learnt with
+static char Fuzzy_Controller_Version[FUZZY_PARAMETERS_VERSION_SIZE] = "";
+#endif
 
 
 static void initTrack(int index, tTrack* track, void *carHandle,
@@ -103,6 +147,13 @@ static void drive(int index, tCarElt* car, tSituation *s);
 static void endrace(int index, tCarElt *car, tSituation *s);
 static void shutdown(int index);
 static int  InitFuncPt(int index, void *pt);
+static controller::FuzzyController * load_fuzzy_controller(int index);
+
+#ifndef TRAINING_MODE
+static void get_Q_table_source(const char * track_name,
+        const char * fuzzy_controller_version,
+        controller_storage::Q_table_source & source);
+#endif
 
 
 /* 
@@ -113,13 +164,23 @@ car222(tModInfo *modInfo)
 {
     memset(modInfo, 0, 10*sizeof(tModInfo));
 
-    modInfo->name    = strdup("car222");                    /* name of the module */
-    modInfo->desc    = strdup(
-            "Autonomous vehicle with Q Learning and fuzzy control");      /* description */
+    // one interface for each car ( names are same as in car222.xml )
+    for(int i = 0; i < CAR222_MAX_INSTANCES; i++)
+    {
+        char name[32] = "car222";
+        if(i > 0)
+        {
+            sprintf(name, "car222 %d", i + 1);
+        }
+
+        modInfo[i].name    = strdup(name);                  /* name of the module */
+        modInfo[i].desc    = strdup(
+                "Autonomous vehicle with Q Learning and fuzzy control");  /* description */
 
-    modInfo->fctInit = InitFuncPt;                          /* init function */
-    modInfo->gfId    = ROB_IDENT;                           /* supported framework version */
-    modInfo->index   = 1;
+        modInfo[i].fctInit = InitFuncPt;                    /* init function */
+        modInfo[i].gfId    = ROB_IDENT;                     /* supported framework version */
+        modInfo[i].index   = i + 1;
+    }
 
     return 0;
 }
@@ -143,16 +204,72 @@ InitFuncPt(int index, void *pt)
 
 /* Called for every track change or new race. */
 static void  
-initTrack(int index, tTrack* track, void *carHandle, void **carParmHandle, tSituation *s)
+initTrack(int index, tTrack* track, void * /* carHandle */, void **carParmHandle, tSituation * /* s */)
 {
+#ifndef TRAINING_MODE
+    // track is same for all the cars, so its Q table is loaded only once
+    const int is_first_instance = (curTrack != track);
+#endif
+
     curTrack = track;
     *carParmHandle = NULL;
+
+    if(index >= 1 && index <= CAR222_MAX_INSTANCES &&
+            m_instances[index - 1].fuzzy_controller == NULL)
+    {
+        m_instances[index - 1].fuzzy_controller = load_fuzzy_controller(index);
+    }
+
+#ifndef TRAINING_MODE
+    if(!is_first_instance)
+    {
+        return;
+    }
+
+    // start loading Q table of the track while rest of the race is set up
+    controller_storage::Q_table_source source;
+    get_Q_table_source(curTrack->name,
+            m_instances[index - 1].fuzzy_controller->get_version(), source);
+    controller::_Q_table_cache.preload_table(source);
+#endif
+}
+
+
+/* creates fuzzy controller of a car ( and loads its fuzzy parameters and table )
+ * and prints time it took */
+static controller::FuzzyController * load_fuzzy_controller(int index)
+{
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    controller::FuzzyController * fuzzy_controller = new controller::FuzzyController();
+    if(USE_FUZZY_PARAMETERS)
+    {
+        char fuzzy_parameters_file_name[FILE_NAME_BUFFER_SIZE];
+        sprintf(fuzzy_parameters_file_name, FUZZY_PARAMETERS_FILE_NAME_FORMAT,
+                FUZZY_PARAMETERS_FILE_NAME);
+        fuzzy_controller->use_parameters(fuzzy_parameters_file_name);
+    }
+    if(USE_FUZZY_TABLE)
+    {
+        char fuzzy_table_file_name[FILE_NAME_BUFFER_SIZE];
+        sprintf(fuzzy_table_file_name, FUZZY_TABLE_FILE_NAME_FORMAT, FUZZY_TABLE_FILE_NAME);
+        fuzzy_controller->use_table(fuzzy_table_file_name);
+    }
+
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("Fuzzy Controller ( car %d ) - ready in %.3f ms\n", index,
+            (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) * 1e-6);
+
+    return fuzzy_controller;
 }
 
 
 #if TRAINING_MODE
 
-void adjust_learning_parameters()
+/* returns row of LEARNING_PARAMETERS for current training_race_counter */
+static int get_learning_stage()
 {
     int learning_stage = 0;
 
@@ -165,52 +282,327 @@ void adjust_learning_parameters()
         learning_stage++;
     }
 
+    return learning_stage;
+}
+
+
+void adjust_learning_parameters(controller::QLearner & t_q_learner)
+{
+    const int learning_stage = get_learning_stage();
+
     // set parameters for corresponding learning_stage
-    m_q_learner.set_learning_rate(controller::LEARNING_PARAMETERS[learning_stage][1]);
-    m_q_learner.set_discount(controller::LEARNING_PARAMETERS[learning_stage][2]);
-    m_q_learner.set_epsilon(controller::LEARNING_PARAMETERS[learning_stage][3]);
+    t_q_learner.set_learning_rate(controller::LEARNING_PARAMETERS[learning_stage][1]);
+    t_q_learner.set_discount(controller::LEARNING_PARAMETERS[learning_stage][2]);
+    t_q_learner.set_epsilon(controller::LEARNING_PARAMETERS[learning_stage][3]);
+    t_q_learner.set_lambda(controller::LEARNING_PARAMETERS[learning_stage][4]);
 }
 
 #endif
 
 
-/* Start a new race. */
-static void  
-newrace(int index, tCarElt* car, tSituation *s)
+/* returns non-zero if dense layout of Q table is selected */
+static int is_dense_layout_selected()
 {
-    setbuf(stdout, NULL);
+    int use_dense_table = (Q_TABLE_LAYOUT == Q_TABLE_DENSE);
+
+    // layout selected at build time can be overridden at load time
+    const char * layout_from_env = getenv(Q_TABLE_LAYOUT_ENV);
+    if(layout_from_env != NULL)
+    {
+        use_dense_table = (strcmp(layout_from_env, "dense") == 0);
+    }
+
+    return use_dense_table;
+}
+
+
+#ifdef TRAINING_MODE
+
+/* selects layout of Q table before Q values are loaded */
+static void select_Q_table_layout()
+{
+    if(is_dense_layout_selected() &&
+            !controller::_Q_maps_storage._Q_maps->is_using_dense_table())
+    {
+        controller::_Q_maps_storage._Q_maps->use_dense_table(
+                controller::Q_DENSE_TABLE_BOUNDS);
+    }
+}
+
+
+/**
+ * loads Q values from Q value file of configured type ( see Q_VALUE_FILE_TYPE )
+ * learnt with the given version of fuzzy controller
+ **/
+static long long int load_Q_value_file(const char * fuzzy_controller_version)
+{
+    controller_storage::Q_maps * _Q_maps = controller::_Q_maps_storage._Q_maps;
+
+    // workers of training farm write ( and merge ) binary files with float values
+    const int is_farm_worker = (m_farm_config.worker_count > 0);
 
+    // ids are checked against binary file and written to it
+    _Q_maps->set_version_ids(Q_LEARNER_ID, RACE_REWARD_ID, fuzzy_controller_version);
+    _Q_maps->set_binary_value_encoding(is_farm_worker ? Q_VALUES_FLOAT32 : Q_VALUE_ENCODING);
+
+    // workers of training farm record visits ( starting from those of last merge )
+    if(is_farm_worker)
+    {
+        if(controller::_Q_maps_storage._Q_visit_counts == NULL)
+        {
+            controller::_Q_maps_storage._Q_visit_counts =
+                new controller_storage::Q_visit_counts;
+        }
+        controller::_Q_maps_storage._Q_visit_counts->load_from_file(QLearner_Binary_File);
+    }
+
+    // text file is used when there is no binary file yet
+    if((Q_VALUE_FILE_TYPE == Q_FILE_BINARY || is_farm_worker) &&
+            access(QLearner_Binary_File, R_OK) == 0)
+    {
+        return _Q_maps->load_maps_from_binary_file(QLearner_Binary_File);
+    }
+
+    const long long int training_counter = _Q_maps->load_maps_from_file(QLearner_File);
+
+    // races after loading text file may have been journaled for binary file
+    if(Q_VALUE_FILE_TYPE == Q_FILE_BINARY)
+    {
+        return _Q_maps->replay_journal(QLearner_Binary_File);
+    }
+
+    return training_counter;
+}
+
+
+/**
+ * writes Q values and visit counts of this worker of training farm, waits
+ * until they are merged with those of other workers ( into Q value file of
+ * the track ) and continues with merged Q values
+ **/
+static void sync_with_training_farm()
+{
+    // visit counts are written first, as merge starts when Q value file is written
+    controller::_Q_maps_storage._Q_visit_counts->write_to_file(
+            QLearner_Worker_File, controller::training_race_counter);
+    controller::_Q_maps_storage._Q_maps->write_maps_to_binary_file(
+            QLearner_Worker_File, controller::training_race_counter);
+
+    controller_storage::wait_for_merged_Q_values(
+            QLearner_Binary_File, controller::training_race_counter);
+
+    // merged Q values replace Q values of this worker
+    controller::_Q_maps_storage.reset_Q_maps();
+    select_Q_table_layout();
+    controller::training_race_counter = load_Q_value_file(Fuzzy_Controller_Version);
+}
+
+#else
+
+/**
+ * fills source of Q table of given track for Q_table_cache ( the table is
+ * checked against the given version of fuzzy controller )
+ **/
+static void get_Q_table_source(const char * track_name,
+        const char * fuzzy_controller_version,
+        controller_storage::Q_table_source & source)
+{
+    char file_name[FILE_NAME_BUFFER_SIZE];
+
+    source.track_name = track_name;
+
+    sprintf(file_name, Q_VALUE_FILE_NAME_FORMAT, Q_VALUE_FILE_NAME(track_name));
+    source.text_file_name = file_name;
+    sprintf(file_name, Q_VALUE_FILE_NAME_FORMAT, Q_VALUE_BINARY_FILE_NAME(track_name));
+    source.binary_file_name = file_name;
+    source.use_binary_file = (Q_VALUE_FILE_TYPE == Q_FILE_BINARY);
+
+    source.Q_learner_id = Q_LEARNER_ID;
+    source.reward_id = RACE_REWARD_ID;
+    source.fuzzy_controller_version = fuzzy_controller_version;
+
+    source.use_dense_table = is_dense_layout_selected();
+    source.dense_bounds = controller::Q_DENSE_TABLE_BOUNDS;
+}
+
+#endif
+
+
+/**
+ * sets up Q values for the race ( called for the first car that starts the
+ * race, as all the cars share the same Q table ) for the version of fuzzy
+ * controller of the cars ( which may be that of tuned fuzzy parameters )
+ **/
+static void start_race_Q_values(const char * fuzzy_controller_version)
+{
     sprintf(QLearner_File, Q_VALUE_FILE_NAME_FORMAT, Q_VALUE_FILE_NAME(curTrack->name));
+    sprintf(QLearner_Binary_File, Q_VALUE_FILE_NAME_FORMAT,
+            Q_VALUE_BINARY_FILE_NAME(curTrack->name));
 
 #ifdef TRAINING_MODE
 
+    // replay of steps of previous races ends when this race starts
+    if(EXPERIENCE_REPLAY)
+    {
+        controller::_Q_replay_buffer.stop_replay();
+
+        controller_storage::Q_replay_stats replay_stats;
+        controller::_Q_replay_buffer.get_stats(replay_stats);
+        if(replay_stats.replayed_updates > 0)
+        {
+            printf("experience replay - %lld updates in %.3f seconds ( %lu steps in buffer )\n",
+                    replay_stats.replayed_updates, replay_stats.replay_seconds,
+                    controller::_Q_replay_buffer.get_size());
+        }
+    }
+
+    // planning from model of the track ends when this race starts
+    if(DYNA_PLANNING)
+    {
+        controller::_Q_transition_model.stop_planning();
+
+        controller_storage::Q_model_stats model_stats;
+        controller::_Q_transition_model.get_stats(model_stats);
+        printf("Dyna-Q planning - %lld updates in %.3f seconds after last race,"
+                " %lld updates in all ( model has %lld pairs, %.1f MB,"
+                " %lld steps dropped )\n",
+                model_stats.thread_updates, model_stats.thread_seconds,
+                model_stats.planning_updates, model_stats.pairs,
+                model_stats.memory_footprint / (1024.0 * 1024.0),
+                model_stats.dropped_steps);
+    }
+
+    sprintf(Trajectory_File, TRAJECTORY_FILE_NAME_FORMAT, TRAJECTORY_FILE_NAME(curTrack->name));
+
+    // this process is a worker of training farm if it is configured in environment
+    if(controller_storage::get_farm_config(m_farm_config))
+    {
+        sprintf(QLearner_Worker_File, Q_VALUE_WORKER_FILE_NAME_FORMAT,
+                Q_VALUE_WORKER_FILE_NAME(curTrack->name, m_farm_config.worker_index));
+    }
+
     // try to read values from Q file for the first time
     // this race counter is Zero when initialized at game start
     if(controller::training_race_counter == 0)
     {
-        controller::training_race_counter = controller::_Q_maps_storage.
-            _Q_maps->load_maps_from_file(QLearner_File);
+        select_Q_table_layout();
+
+        strcpy(Fuzzy_Controller_Version, fuzzy_controller_version);
+        controller::training_race_counter = load_Q_value_file(Fuzzy_Controller_Version);
 
         printf("training counter set to - %d\n", controller::training_race_counter);
 
         printf("reward configuration set to - %s\n", RACE_REWARD_ID);
     }
 
-    adjust_learning_parameters();
+    if(DYNA_PLANNING)
+    {
+        controller::_Q_transition_model.set_memory_budget(
+                (size_t) DYNA_MODEL_BUDGET_MB * 1024 * 1024);
+    }
+
+    if(EXPERIENCE_REPLAY && controller::_Q_replay_buffer.get_capacity() == 0)
+    {
+        controller::_Q_replay_buffer.set_capacity(REPLAY_BUFFER_SIZE);
+
+        printf("replay buffer - %d steps, %.1f MB\n", REPLAY_BUFFER_SIZE,
+                controller::_Q_replay_buffer.get_memory_footprint() / (1024.0 * 1024.0));
+    }
 
 #else
 
-    // in RACE_MODE loads Q File for each new race
-    // files would be different for different tracks
-    controller::_Q_maps_storage._Q_maps->load_maps_from_file(QLearner_File);
+    // in RACE_MODE Q table of the track is taken from cache of Q tables.
+    // It is loaded only for the first race on the track ( or when its Q value
+    // files have changed ) and tables of different tracks are kept apart.
+    controller_storage::Q_table_source source;
+    get_Q_table_source(curTrack->name, fuzzy_controller_version, source);
+
+    controller::_Q_table_cache.set_memory_budget(
+            (size_t) Q_TABLE_CACHE_BUDGET_MB * 1024 * 1024);
+    controller::_Q_maps_storage.use_Q_maps(controller::_Q_table_cache.get_table(source));
+
+#endif
+}
+
+
+/* Start a new race. */
+static void  
+newrace(int index, tCarElt* /* car */, tSituation * /* s */)
+{
+    setbuf(stdout, NULL);
+
+    if(index < 1 || index > CAR222_MAX_INSTANCES)
+    {
+        printf("car222 : robot index %d is not supported\n", index);
+        return;
+    }
+
+    car222_instance & instance = m_instances[index - 1];
+
+    // Q values are checked against version of fuzzy controller, so it is
+    // created before them ( if it was deleted when the car was shut down )
+    if(instance.fuzzy_controller == NULL)
+    {
+        instance.fuzzy_controller = load_fuzzy_controller(index);
+    }
+
+    // first car sets up Q values shared by all the cars
+    if(m_instances_in_race == 0)
+    {
+        start_race_Q_values(instance.fuzzy_controller->get_version());
+
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        m_race_id = now.tv_sec * 1000000ULL + now.tv_nsec / 1000;
+    }
+    m_instances_in_race++;
+    m_racing_instances++;
+
+    instance.q_learner = new controller::QLearner(controller::_Q_maps_storage);
+
+#ifdef TRAINING_MODE
+    adjust_learning_parameters(*instance.q_learner);
+
+    // steps of the car are recorded for experience replay
+    if(EXPERIENCE_REPLAY)
+    {
+        instance.q_learner->set_replay_buffer(&controller::_Q_replay_buffer);
+    }
+
+    // steps of the car are learnt by model of the track for planning
+    if(DYNA_PLANNING)
+    {
+        instance.q_learner->set_transition_model(&controller::_Q_transition_model,
+                DYNA_PLANNING_STEPS);
+    }
+
+    // Q values are updated by a learner thread while the car is driven
+    if(LEARN_IN_BACKGROUND)
+    {
+        instance.q_learner->start_learner_thread(TRANSITION_QUEUE_SIZE);
+    }
 
+    // steps of previous race have been written to trajectory log
+    instance.trajectory.clear();
 #endif
 
     // reset previous damages
-    prev_damages = 0;
+    instance.prev_damages = 0;
 
     // reset distance raced
-    distance_raced = 0;
+    instance.distance_raced = 0;
+
+    instance.is_out_of_track = 0;
+
+    // each car records its telemetry to its own file
+    instance.tick = 0;
+    if(RECORD_TELEMETRY)
+    {
+        char telemetry_file_name[FILE_NAME_BUFFER_SIZE];
+        sprintf(telemetry_file_name, TELEMETRY_FILE_NAME_FORMAT,
+                TELEMETRY_FILE_NAME(curTrack->name, index));
+        instance.telemetry.start(telemetry_file_name, m_race_id, TELEMETRY_BUFFER_SIZE);
+    }
 }
 
 
@@ -218,6 +610,23 @@ newrace(int index, tCarElt* car, tSituation *s)
 static void  
 drive(int index, tCarElt* car, tSituation *s)
 {
+    if(index < 1 || index > CAR222_MAX_INSTANCES ||
+            m_instances[index - 1].q_learner == NULL ||
+            m_instances[index - 1].fuzzy_controller == NULL)
+    {
+        return;
+    }
+
+    car222_instance & instance = m_instances[index - 1];
+
+#ifdef TRAINING_MODE
+    // car has reached the end state of this race
+    if(instance.is_out_of_track)
+    {
+        return;
+    }
+#endif
+
     // calculate steering angle
     float angle = RtTrackSideTgAngleL(&(car->_trkPos)) - car->_yaw;
     NORM_PI_PI(angle);
@@ -246,8 +655,15 @@ drive(int index, tCarElt* car, tSituation *s)
     // for version "v1.0.0" this is left to 0
     _fuz_inputs.stability = 0;
 
-    // run engine for fuzzy outputs
-    controller::fuzzy_outputs _fuz_outputs = m_fuzzy_controller.get_output(&(_fuz_inputs));
+    // run engine for fuzzy outputs - accel is overridden by Q Learner below,
+    // so it is only needed for telemetry
+    int fuzzy_output_mask = FUZZY_OUTPUT_STEER | FUZZY_OUTPUT_BRAKE | FUZZY_OUTPUT_GEAR;
+    if(instance.telemetry.is_recording())
+    {
+        fuzzy_output_mask |= FUZZY_OUTPUT_ACCEL;
+    }
+    controller::fuzzy_outputs _fuz_outputs = instance.fuzzy_controller->get_output(&(_fuz_inputs),
+            fuzzy_output_mask);
 
     // set outputs
     car->ctrl.gear = _fuz_outputs.gear;
@@ -255,91 +671,131 @@ drive(int index, tCarElt* car, tSituation *s)
     car->ctrl.brakeCmd = _fuz_outputs.brake;
     car->ctrl.accelCmd = _fuz_outputs.accel;
 
+    // values of this step that Q state and reward are found from
+    controller_storage::Q_trajectory_step step;
+    step.speed_x = car->_speed_x;
+    step.speed_y = car->_speed_y;
+    step.to_right = car->_trkPos.toRight;
+    step.to_left = car->_trkPos.toLeft;
+    step.path = _fuz_inputs.path;
+    step.next_path = _fuz_inputs.next_path;
+    step.damages = car->_dammage;
+
     controller::Q_state t_Q_state;
-    t_Q_state.speed_x = car->_speed_x;
-    // clip speed y to (-SPEED_Y_CLIP_VALUE) and (+SPEED_Y_CLIP_VALUE)
-    // very high values of speed y are not much relevant
-    t_Q_state.speed_y = clip_min_max(car->_speed_y,
-                -SPEED_Y_CLIP_VALUE, SPEED_Y_CLIP_VALUE);
-
-    // large distances on either side do not have much information,
-    // so clip right side distance on track to
-    // (-TRACK_SIDE_CLIP_DISTANCE) and (+TRACK_SIDE_CLIP_DISTANCE)
-    t_Q_state.right_side_distance =
-        (int) clip_min_max(car->_trkPos.toRight,
-                -TRACK_SIDE_CLIP_DISTANCE, TRACK_SIDE_CLIP_DISTANCE);
-    // large distances on either side do not have much information,
-    // so clip left side distance on track to
-    // (-TRACK_SIDE_CLIP_DISTANCE) and (+TRACK_SIDE_CLIP_DISTANCE)
-    t_Q_state.left_side_distance =
-        (int) clip_min_max(car->_trkPos.toLeft,
-                -TRACK_SIDE_CLIP_DISTANCE, TRACK_SIDE_CLIP_DISTANCE);
-
-    // values are same as those for the fuzzy inputs
-    t_Q_state.path = _fuz_inputs.path;
-    t_Q_state.next_path = _fuz_inputs.next_path;
+    set_Q_state(step, t_Q_state);
 
     // suggested accel value by Q Learner overrides accelCmd
     controller::Q_action suggested_action;
-    m_q_learner.get_suggested_action(t_Q_state, suggested_action);
+    instance.q_learner->get_suggested_action(t_Q_state, suggested_action);
     car->ctrl.accelCmd = suggested_action.accel;
 
+    // get reward for being in current state
+    float reward = get_reward(get_race_step(step), instance.prev_damages);
+
+    // telemetry of this tick is put in buffer of the recorder ( it is
+    // written by its writer thread )
+    if(instance.telemetry.is_recording())
+    {
+        controller_telemetry::telemetry_record record;
+        record.tick = instance.tick;
+        record.time = s->currentTime;
+        record.segment_id = car->_trkPos.seg->id;
+        record.speed_x = car->_speed_x;
+        record.speed_y = car->_speed_y;
+        record.accel_x = car->_accel_x;
+        record.to_left = car->_trkPos.toLeft;
+        record.to_right = car->_trkPos.toRight;
+        record.damage = car->_dammage;
+        record.path = _fuz_inputs.path;
+        record.next_path = _fuz_inputs.next_path;
+        record.gear = _fuz_outputs.gear;
+        record.steer = _fuz_outputs.steer;
+        record.accel = _fuz_outputs.accel;
+        record.brake = _fuz_outputs.brake;
+        record.Q_accel = suggested_action.accel;
+        record.reward = reward;
+        instance.telemetry.record(record);
+    }
+    instance.tick++;
+
 #ifdef TRAINING_MODE
 
     /**
      * while driving in TRAINING_MODE :
      *  1. state, action, rewards are updated in Q Learner
-     *  2. race ends as soon as the car goes outside the track
+     *  2. car stops racing as soon as it goes outside the track and race ends
+     *     when all car222 cars are outside the track
      **/
 
-    // get reward for being in current state
-    float reward = get_reward(car);
     controller::Q_action t_Q_action;
     t_Q_action.accel = car->ctrl.accelCmd;
 
+    // step is kept for trajectory log of the race
+    if(RECORD_TRAJECTORIES)
+    {
+        step.accel = car->ctrl.accelCmd;
+        instance.trajectory.push_back(step);
+    }
+
     // check if it is outside the track
-    if(car->_trkPos.toRight < 0 || car->_trkPos.toLeft < 0)
+    if(is_outside_track(step))
     {
-        // end the race if it is outside the track
+        // end the race of the car if it is outside the track
         car->_state = RM_RACE_ENDED;
-        ReInfo->s->_raceState = RM_RACE_ENDED;
+        instance.is_out_of_track = 1;
+
+        // end the race when no other car222 car is racing
+        m_racing_instances--;
+        if(m_racing_instances == 0)
+        {
+            ReInfo->s->_raceState = RM_RACE_ENDED;
+        }
 
         // race ends here and this state will not be updated
         // so set this state as the terminal state
-        t_Q_state.speed_x = -99;     // largest negative speed_x "-99" to mark end state
-        t_Q_state.speed_y = 0;
-        t_Q_state.right_side_distance = -1.0;
-        t_Q_state.left_side_distance = -1.0;
-        t_Q_state.path = 0;
-        t_Q_state.next_path = 0;
-
-        // set default action for end state
-        t_Q_action.accel = 0;
+        set_end_Q_state(t_Q_state, t_Q_action);
     }
 
     // update state, action and reward
-    m_q_learner.set_state_action_and_reward(t_Q_state, t_Q_action, reward);
+    instance.q_learner->set_state_action_and_reward(t_Q_state, t_Q_action, reward);
 
 #endif
 
     // update distance raced
-    distance_raced = car->_distRaced;
+    instance.distance_raced = car->_distRaced;
 }
 
 /* End of the current race */
 static void
-endrace(int index, tCarElt *car, tSituation *s)
+endrace(int /* index */, tCarElt * /* car */, tSituation * /* s */)
 {
 }
 
-/* Called before the module is unloaded */
-static void
-shutdown(int index)
+#ifdef TRAINING_MODE
+
+/**
+ * returns non-zero if training race counter has reached a multiple of the
+ * given period since its previous value ( the counter increases by number
+ * of cars in a race, so it may go past the multiple )
+ **/
+static int has_reached_multiple_of(const int previous_counter, const int period)
 {
+    return (controller::training_race_counter / period) != (previous_counter / period);
+}
 
-#ifdef TRAINING_MODE
 
-    controller::training_race_counter++; 
+/**
+ * updates training race counter and journals or writes Q values after a race
+ * ( called when the last car of the race is shut down )
+ **/
+static void end_race_Q_values()
+{
+    // race counter counts races of each car and a worker of training farm
+    // counts races of all the workers
+    const int is_farm_worker = (m_farm_config.worker_count > 0);
+    const int previous_counter = controller::training_race_counter;
+    controller::training_race_counter +=
+        m_instances_in_race * (is_farm_worker ? m_farm_config.worker_count : 1);
 
     // make sure it is still learning before modifying values in Q map storage
     if(controller::training_race_counter <=
@@ -349,21 +805,169 @@ shutdown(int index)
         controller::_Q_maps_storage._Q_maps->m_training_counter =
             controller::training_race_counter;
 
+        const char * written_Q_value_file = is_farm_worker ? QLearner_Worker_File :
+            ((Q_VALUE_FILE_TYPE == Q_FILE_BINARY) ? QLearner_Binary_File : QLearner_File);
+
+        // append updates of this race to journal of the file
+        if(JOURNAL_EACH_RACE)
+        {
+            controller::_Q_maps_storage._Q_maps->append_to_journal(
+                    written_Q_value_file, controller::training_race_counter);
+        }
+
+        if(is_farm_worker)
+        {
+            // Q values are written and merged with those of other workers
+            if(has_reached_multiple_of(previous_counter,
+                        FARM_SYNC_AFTER_N_RACES * m_farm_config.worker_count))
+            {
+                sync_with_training_farm();
+            }
+        }
         // write to file after each WRITE_AFTER_N_RACES
-        if(controller::training_race_counter % WRITE_AFTER_N_RACES == 0)
+        // ( this also merges journal of previous races into the file )
+        else if(has_reached_multiple_of(previous_counter, WRITE_AFTER_N_RACES))
+        {
+            if(WRITE_IN_BACKGROUND)
+            {
+                // next race starts while a snapshot of Q values is written
+                controller::_Q_maps_storage._Q_maps->start_background_write(
+                        written_Q_value_file, controller::training_race_counter,
+                        Q_VALUE_FILE_TYPE == Q_FILE_BINARY);
+            }
+            else if(Q_VALUE_FILE_TYPE == Q_FILE_BINARY)
+            {
+                controller::_Q_maps_storage._Q_maps->write_maps_to_binary_file(
+                        written_Q_value_file, controller::training_race_counter);
+            }
+            else
+            {
+                controller::_Q_maps_storage._Q_maps->write_maps_to_file(
+                        written_Q_value_file, controller::training_race_counter);
+            }
+        }
+
+        // steps of races are replayed until the next race starts
+        if(EXPERIENCE_REPLAY)
+        {
+            const int learning_stage = get_learning_stage();
+
+            controller_storage::Q_replay_parameters replay_parameters;
+            replay_parameters.learning_rate =
+                controller::LEARNING_PARAMETERS[learning_stage][1];
+            replay_parameters.discount = controller::LEARNING_PARAMETERS[learning_stage][2];
+            replay_parameters.batch_size = REPLAY_BATCH_SIZE;
+            replay_parameters.prioritized = REPLAY_PRIORITIZED;
+            replay_parameters.max_updates = REPLAY_UPDATES_PER_RACE;
+            replay_parameters.visit_counts = controller::_Q_maps_storage._Q_visit_counts;
+
+            controller::_Q_replay_buffer.start_replay(
+                    controller::_Q_maps_storage._Q_maps, replay_parameters);
+        }
+
+        // planning from model of the track until the next race starts
+        if(DYNA_PLANNING && DYNA_UPDATES_PER_RACE > 0)
         {
-            controller::_Q_maps_storage._Q_maps->write_maps_to_file(
-                    QLearner_File, controller::training_race_counter);
+            const int learning_stage = get_learning_stage();
+
+            controller_storage::Q_planning_parameters planning_parameters;
+            planning_parameters.learning_rate =
+                controller::LEARNING_PARAMETERS[learning_stage][1];
+            planning_parameters.discount =
+                controller::LEARNING_PARAMETERS[learning_stage][2];
+            planning_parameters.max_updates = DYNA_UPDATES_PER_RACE;
+            planning_parameters.visit_counts = controller::_Q_maps_storage._Q_visit_counts;
+
+            controller::_Q_transition_model.start_planning(
+                    controller::_Q_maps_storage._Q_maps, planning_parameters);
         }
     }
+}
+
+#endif
+
+
+/* Called before the module is unloaded */
+static void
+shutdown(int index)
+{
+    if(index < 1 || index > CAR222_MAX_INSTANCES ||
+            m_instances[index - 1].q_learner == NULL)
+    {
+        return;
+    }
+
+    car222_instance & instance = m_instances[index - 1];
+
+#ifdef TRAINING_MODE
+    // wait for Q value updates of the learner thread
+    instance.q_learner->stop_learner_thread();
+
+    if(LEARN_IN_BACKGROUND)
+    {
+        // depth shows how far the learner thread was behind the car
+        controller::Q_queue_stats queue_stats;
+        instance.q_learner->get_queue_stats(queue_stats);
+        printf("learner queue ( car %d ) - max depth %lld, mean depth %.2f,"
+                " full queue waits %lld\n", index, queue_stats.max_depth,
+                (queue_stats.transitions == 0) ? 0.0 :
+                (double) queue_stats.depth_sum / queue_stats.transitions,
+                queue_stats.full_waits);
+    }
+
+    // steps of this race are appended to trajectory log of the track
+    if(RECORD_TRAJECTORIES && !instance.trajectory.empty())
+    {
+        controller_storage::append_trajectory(Trajectory_File, instance.trajectory);
+    }
+#endif
+
+    delete instance.q_learner;
+    instance.q_learner = NULL;
+
+    delete instance.fuzzy_controller;
+    instance.fuzzy_controller = NULL;
+
+    // remaining telemetry is written and index of the race is appended
+    if(instance.telemetry.is_recording())
+    {
+        instance.telemetry.stop();
+
+        controller_telemetry::telemetry_stats telemetry_stats;
+        instance.telemetry.get_stats(telemetry_stats);
+        printf("telemetry ( car %d ) - %lld records, %lld dropped, %lld bytes"
+                " ( %.1f bytes per record )\n", index, telemetry_stats.records,
+                telemetry_stats.dropped_records, telemetry_stats.bytes_written,
+                (telemetry_stats.records == 0) ? 0.0 :
+                (double) telemetry_stats.bytes_written / telemetry_stats.records);
+    }
+
+    // Q values are journaled or written once after all the cars are shut down
+    m_instances_shut_down++;
+    const int is_last_instance = (m_instances_shut_down == m_instances_in_race);
+
+#ifdef TRAINING_MODE
+
+    if(is_last_instance)
+    {
+        end_race_Q_values();
+    }
 
-    printf("*** shutdown TRAINING RACE NO. - %d   *** total distance raced - %f\n",
-            controller::training_race_counter, distance_raced);
+    printf("*** shutdown TRAINING RACE NO. - %d ( car %d )   *** total distance raced - %f\n",
+            controller::training_race_counter, index, instance.distance_raced);
 
 #else
 
-    printf("*** shutdown *** total distance raced - %f\n", distance_raced);
+    printf("*** shutdown ( car %d ) *** total distance raced - %f\n",
+            index, instance.distance_raced);
 
 #endif
+
+    if(is_last_instance)
+    {
+        m_instances_in_race = 0;
+        m_instances_shut_down = 0;
+        m_racing_instances = 0;
+    }
 }
 
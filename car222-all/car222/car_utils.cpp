@@ -26,6 +26,9 @@
  */
 
 
+#include "car_utils.h"
+
+
 float clip_min_max(const float & given_value,
         const float & MIN_VALUE,
         const float & MAX_VALUE)
@@ -44,3 +47,62 @@ float clip_min_max(const float & given_value,
     return clipped_value;
 }
 
+
+void set_Q_state(const controller_storage::Q_trajectory_step & step,
+        controller::Q_state & Q_state)
+{
+    Q_state.speed_x = step.speed_x;
+    // clip speed y to (-SPEED_Y_CLIP_VALUE) and (+SPEED_Y_CLIP_VALUE)
+    // very high values of speed y are not much relevant
+    Q_state.speed_y = clip_min_max(step.speed_y,
+                -SPEED_Y_CLIP_VALUE, SPEED_Y_CLIP_VALUE);
+
+    // large distances on either side do not have much information,
+    // so clip right side distance on track to
+    // (-TRACK_SIDE_CLIP_DISTANCE) and (+TRACK_SIDE_CLIP_DISTANCE)
+    Q_state.right_side_distance =
+        (int) clip_min_max(step.to_right,
+                -TRACK_SIDE_CLIP_DISTANCE, TRACK_SIDE_CLIP_DISTANCE);
+    // large distances on either side do not have much information,
+    // so clip left side distance on track to
+    // (-TRACK_SIDE_CLIP_DISTANCE) and (+TRACK_SIDE_CLIP_DISTANCE)
+    Q_state.left_side_distance =
+        (int) clip_min_max(step.to_left,
+                -TRACK_SIDE_CLIP_DISTANCE, TRACK_SIDE_CLIP_DISTANCE);
+
+    // values are same as those for the fuzzy inputs
+    Q_state.path = step.path;
+    Q_state.next_path = step.next_path;
+}
+
+
+void set_end_Q_state(controller::Q_state & Q_state, controller::Q_action & Q_action)
+{
+    Q_state.speed_x = -99;     // largest negative speed_x "-99" to mark end state
+    Q_state.speed_y = 0;
+    Q_state.right_side_distance = -1.0;
+    Q_state.left_side_distance = -1.0;
+    Q_state.path = 0;
+    Q_state.next_path = 0;
+
+    // set default action for end state
+    Q_action.accel = 0;
+}
+
+
+int is_outside_track(const controller_storage::Q_trajectory_step & step)
+{
+    return step.to_right < 0 || step.to_left < 0;
+}
+
+
+race_step get_race_step(const controller_storage::Q_trajectory_step & step)
+{
+    race_step values;
+    values.speed_x = step.speed_x;
+    values.to_right = step.to_right;
+    values.to_left = step.to_left;
+    values.damages = step.damages;
+    return values;
+}
+
@@ -30,6 +30,17 @@
 #define  CAR_UTILS_H
 
 
+#include "q_learning.h"
+#include "race_reward.h"
+#include "car222_trajectory_log.h"
+
+
+// speed y is clipped to this value
+#define SPEED_Y_CLIP_VALUE            1
+// distance on left/right side of the track is clipped to this value
+#define TRACK_SIDE_CLIP_DISTANCE      6
+
+
 /**
  * clips given value between MIN VALUE and MAX VALUE
  **/
@@ -38,6 +49,25 @@ extern float clip_min_max(const float & given_value,
         const float & MAX_VALUE);
 
 
+/**
+ * sets Q state for a step of a car ( from a race or from a trajectory log,
+ * so both have same states )
+ **/
+extern void set_Q_state(const controller_storage::Q_trajectory_step & step,
+        controller::Q_state & Q_state);
+
+/**
+ * sets terminal state ( car has gone outside the track ) and its default action
+ **/
+extern void set_end_Q_state(controller::Q_state & Q_state, controller::Q_action & Q_action);
+
+/* returns non-zero if car is outside the track at the step */
+extern int is_outside_track(const controller_storage::Q_trajectory_step & step);
+
+/* returns values of the step that its reward depends on */
+extern race_step get_race_step(const controller_storage::Q_trajectory_step & step);
+
+
 #endif
 
 
@@ -8,5 +8,5 @@
 #
 
 
-find . -mindepth 2 \( -iname '*\.h' -o -iname '*\.cpp' \) -type f -exec ln -sf {} \;
+find -L . -mindepth 2 \( -iname '*\.h' -o -iname '*\.cpp' \) -type f -exec ln -sf {} \;
 
@@ -12,8 +12,25 @@ cd $TORCS_BASE/src/libs/raceengineclient/
 
 # these links will get re-exported by Makefile
 ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_string_formats.h
+ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_Q_state_key.h
+ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_Q_binary_format.h
+ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_Q_dense_table.h
+ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_Q_dense_table.cpp
 ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_Q_maps.h
 ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_Q_maps.cpp
+ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_Q_text_codec.h
+ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_Q_text_codec.cpp
+ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_Q_table_cache.h
+ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_Q_table_cache.cpp
+ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_Q_visit_counts.h
+ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_Q_visit_counts.cpp
+ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_training_farm.h
+ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_training_farm.cpp
+ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_Q_replay.h
+ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_Q_replay.cpp
+ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_Q_model.h
+ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_Q_model.cpp
+ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_trajectory_log.h
 ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_race_config.h
 ln -sf $TORCS_BASE/src/drivers/car222/rl/car222_race_init.cpp
 
@@ -1,66 +0,0 @@
-/*
- * =====================================================================================
- * Copyright (C) 2018 M.S.Khan
- *
- * This program is free software: you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation, either version 3 of the License, or
- * (at your option) any later version.
- *
- * This program is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
- *
- * You should have received a copy of the GNU General Public License
- * along with this program.  If not, see <http://www.gnu.org/licenses/>.
- * =====================================================================================
- */
-
-/*
- * fuzzy_values.h
- *
- *     version  : 1.0.0
- *  created on  : 18 Feb 2018
- *      author  : M.S.Khan
- */
-
-
-#ifndef FUZZY_VALUES_H_
-#define FUZZY_VALUES_H_
-
-
-#define SLOW                     "slow"
-#define VERY_SLOW                "very_slow"
-#define VERY_VERY_SLOW           "very_very_slow"
-#define MEDIUM                   "medium"
-#define FAST                     "fast"
-#define VERY_FAST                "very_fast"
-
-#define LEFT                     "left"
-#define TOO_LEFT                 "too_left"
-#define STRAIGHT                 "straight"
-#define RIGHT                    "right"
-#define TOO_RIGHT                "too_right"
-
-#define LOW                      "low"
-#define VERY_LOW                 "very_low"
-#define HIGH                     "high"
-#define VERY_HIGH                "very_high"
-
-#define STABLE                   "stable"
-#define UNSTABLE                 "unstable"
-
-#define NEGATIVE                 "negative"
-
-#define REVERSE_GEAR             "reverse_gear"
-#define LOW_GEAR                 "low_gear"
-#define VERY_LOW_GEAR            "very_low_gear"
-#define MEDIUM_GEAR              "medium_gear"
-#define HIGH_GEAR                "high_gear"
-#define VERY_HIGH_GEAR           "very_high_gear"
-
-
-#endif      /** ifndef FUZZY_VALUES_H_ **/
-
-
@@ -31,19 +31,16 @@
 #include "race_reward.h"
 
 
-/* total damages incurred until current step */
-float prev_damages;
-
-
 /* 
  * ===  FUNCTION  ============================================================
  *         Name:  get_reward
  *  Description:  It returns reward for car being in current state ( how fast
  *                it is moving, whether it is outside the track, whether
- *                there was any damage ).
+ *                there was any damage ). "prev_damages" is total damages of
+ *                the car until previous step ( it is updated for next step ).
  * ===========================================================================
  */
-float get_reward(tCarElt * car)
+float get_reward(const race_step & step, float & prev_damages)
 {
     //reward accumulated in current step
     float reward = 0;
@@ -51,27 +48,27 @@ float get_reward(tCarElt * car)
     float damage_for_step = 0;
 
     // penalize if there is damage in current step
-    if(car->_dammage > prev_damages)
+    if(step.damages > prev_damages)
     {
         // damage incurred in this step
-        damage_for_step = car->_dammage - prev_damages;
+        damage_for_step = step.damages - prev_damages;
 
         // penalty is a product of DAMAGE_COEFFICIENT and damage for this step
         reward -= DAMAGE_COEFFICIENT*damage_for_step;
 
         // reset previous damages to total damages so far
-        prev_damages = car->_dammage;
+        prev_damages = step.damages;
     }
 
 
     // if outside of right side of the track
-    if(car->_trkPos.toRight < 0)
+    if(step.to_right < 0)
     {
         // reward is negative when outside
         reward -= PENALTY_FOR_GOING_OUT;
     }
     // else if outside of left side of the track
-    else if(car->_trkPos.toLeft < 0)
+    else if(step.to_left < 0)
     {
         // reward is negative when outside
         reward -= PENALTY_FOR_GOING_OUT;
@@ -84,7 +81,7 @@ float get_reward(tCarElt * car)
         if(damage_for_step == 0)
         {
             // for simplicity - get rid of the fractional part of the speed
-            int speed_x = (int) car->_speed_x;
+            int speed_x = (int) step.speed_x;
 
             // this version of reward system does not assume reverse gear as necessary
             // penalize for going slow or reverse
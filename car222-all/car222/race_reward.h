@@ -29,8 +29,6 @@
 #ifndef RACE_REWARD_H_
 #define RACE_REWARD_H_
 
-#include <car.h>
-
 
 // id of this reward configuration
 #define  RACE_REWARD_ID               "1.1.0-10.0-5-45-1.0D8-1.0D1024-10000-1.0D256"
@@ -52,11 +50,24 @@
 #define  SPEED_UNIT_REWARD                  1.0/256
 
 
-// total damages incurred until current step
-extern float prev_damages;
+/**
+ * values of a car in current state that its reward depends on. Reward does
+ * not need TORCS, so it can also be found for steps of a trajectory log.
+ **/
+typedef struct race_step_struct
+{
+
+    float speed_x;              // speed in x direction
+    float to_right;             // distance to track edge on right side
+    float to_left;              // distance to track edge on left side
+    float damages;              // total damages of the car so far
+
+} race_step;
+
 
 // returns reward for car being in current state
-extern float get_reward(tCarElt * car);
+// ( "prev_damages" is total damages of the car until previous step )
+extern float get_reward(const race_step & step, float & prev_damages);
 
 
 #endif      /** ifndef RACE_REWARD_H_ **/
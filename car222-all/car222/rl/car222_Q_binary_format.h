@@ -0,0 +1,388 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * car222_Q_binary_format.h
+ *
+ * Layout of binary Q value files
+ *
+ * A binary Q value file is a header followed by an array of records. Records
+ * are grouped by the velocity maps of Q_maps ( shards ) and are sorted by
+ * state key within each shard, so the file can be memory mapped and searched
+ * in place without parsing it.
+ *
+ *      +--------------------------------+
+ *      | Q_binary_header                |
+ *      +--------------------------------+
+ *      | Q_file_record [shard 0]  ...   |  sorted by state key
+ *      | Q_file_record [shard 1]  ...   |  sorted by state key
+ *      |  ...                           |
+ *      | Q_file_record [default shard]  |  sorted by state key
+ *      +--------------------------------+
+ *
+ * Q values of records are either stored as floats ( Q_file_record ) or are
+ * quantized to 16 bit levels with an exponent for each state
+ * ( Q_quantized_record ), as given by "value_encoding" of the header.
+ *
+ * Updates made after a Q value file was written are appended to a journal
+ * file ( Q value file name followed by Q_JOURNAL_FILE_SUFFIX ). A journal is
+ * a sequence of blocks, one for each training race, and each block has the
+ * final records of the states updated during that race.
+ *
+ *      +--------------------------------+
+ *      | Q_journal_block_header         |
+ *      | Q_file_record ...              |  states updated in a race
+ *      +--------------------------------+
+ *      | Q_journal_block_header         |
+ *      |  ...                           |
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  CAR222_Q_BINARY_FORMAT_H_
+#define  CAR222_Q_BINARY_FORMAT_H_
+
+
+#include <math.h>
+
+#include "car222_Q_state_key.h"
+
+
+// magic characters at the start of a binary Q value file
+#define Q_BINARY_MAGIC               "C222QBIN"
+// version of binary Q value file layout
+#define Q_BINARY_FORMAT_VERSION      2
+// oldest version of binary Q value file layout that can be read
+// ( version 1 has no value encoding and its Q values are floats )
+#define Q_BINARY_MIN_FORMAT_VERSION  1
+// marks byte order of the machine that wrote the file
+#define Q_BINARY_BYTE_ORDER_MARK     0x01020304u
+
+// length of version id strings in the header ( including null character )
+#define Q_BINARY_ID_LENGTH           64
+
+// encoding of Q values in records of a binary Q value file
+#define Q_VALUES_FLOAT32             0
+#define Q_VALUES_INT16               1
+
+// magic characters at the start of each block of a journal file
+#define Q_JOURNAL_MAGIC              "C222QJNL"
+// version of journal block layout
+#define Q_JOURNAL_FORMAT_VERSION     1
+// suffix added to Q value file name for its journal file
+#define Q_JOURNAL_FILE_SUFFIX        ".journal"
+// suffix added to journal file name while the file is written in background
+#define Q_JOURNAL_CHECKPOINT_SUFFIX  ".checkpoint"
+
+// magic characters at the start of a visit count file
+#define Q_VISIT_MAGIC                "C222QVIS"
+// version of visit count file layout
+#define Q_VISIT_FORMAT_VERSION       1
+// suffix added to Q value file name for its visit count file
+#define Q_VISIT_FILE_SUFFIX          ".visits"
+
+// number of shards ( velocity maps and the default map of Q_maps )
+#define Q_BINARY_SHARDS              (6 * 10 + 1)
+
+
+namespace controller_storage
+{
+
+    /**
+     * Q values of all the actions of a state stored as one record.
+     *
+     * Besides Q values it caches the max Q value among tried actions
+     * (with its action) and a mask of tried actions, so selecting an action,
+     * finding max Q value or an untried action for a state only needs this
+     * record. An action that has not been tried has zero Q value and its bit
+     * is not set in "tried_actions".
+     *
+     * Records are written to binary Q value files ( with Q_VALUES_FLOAT32 )
+     * and to journals as they are in memory, so any change to this struct
+     * needs a new Q_BINARY_FORMAT_VERSION and Q_JOURNAL_FORMAT_VERSION.
+     **/
+    typedef struct Q_state_record_struct
+    {
+
+        // Q values of actions ( indexed by Q_action_index )
+        float Q_values[Q_ACTION_SPACE_SIZE];
+        // max Q value among tried actions
+        float max_Q_value;
+        // action with max Q value ( lowest index if there is a tie )
+        Q_action_index max_Q_action;
+        // bit mask of tried actions ( bit i is set when action i is tried )
+        unsigned short tried_actions;
+
+    } Q_state_record;
+
+
+    /**
+     * Q value record of a state along with its key as it is stored
+     * in a binary Q value file
+     **/
+    typedef struct Q_file_record_struct
+    {
+
+        Q_state_key state_key;
+        Q_state_record state_record;
+
+    } Q_file_record;
+
+
+    /**
+     * Q value record of a state along with its key as it is stored in a
+     * binary Q value file with Q_VALUES_INT16 encoding.
+     *
+     * Q values of a state share an exponent, i.e. Q value of action i is
+     * "Q_levels[i] * 2^Q_exponent" ( see "quantize_Q_record" ). Max Q action
+     * is the one found from float Q values.
+     **/
+    typedef struct Q_quantized_record_struct
+    {
+
+        Q_state_key state_key;
+        // Q values of actions as levels of 2^Q_exponent ( 0 for untried actions )
+        short Q_levels[Q_ACTION_SPACE_SIZE];
+        // bit mask of tried actions
+        unsigned short tried_actions;
+        // action with max Q value
+        Q_action_index max_Q_action;
+        // exponent shared by Q values of the state
+        signed char Q_exponent;
+
+    } Q_quantized_record;
+
+
+    /**
+     * header of a binary Q value file
+     **/
+    typedef struct Q_binary_header_struct
+    {
+
+        // Q_BINARY_MAGIC ( without null character )
+        char magic[8];
+        // Q_BINARY_FORMAT_VERSION
+        unsigned int format_version;
+        // Q_BINARY_BYTE_ORDER_MARK as written by the machine
+        unsigned int byte_order_mark;
+        // size of this header and of each record in bytes
+        unsigned int header_size;
+        unsigned int record_size;
+
+        // id of QLearner, reward configuration and fuzzy controller version
+        // that were used for learning the Q values
+        char Q_learner_id[Q_BINARY_ID_LENGTH];
+        char reward_id[Q_BINARY_ID_LENGTH];
+        char fuzzy_controller_version[Q_BINARY_ID_LENGTH];
+
+        // training counter ( same as "stats" line of a text Q value file )
+        long long int training_counter;
+
+        // number of records ( states ) in the file
+        unsigned long long int record_count;
+
+        // index of first record of each shard ( last value is "record_count" )
+        unsigned long long int shard_offsets[Q_BINARY_SHARDS + 1];
+
+        // fields below are not there in version 1 ( see "header_size" )
+
+        // encoding of Q values in records ( Q_VALUES_FLOAT32 or Q_VALUES_INT16 )
+        unsigned int value_encoding;
+        unsigned int reserved;
+
+    } Q_binary_header;
+
+    /**
+     * header of a block of records in a journal file
+     **/
+    typedef struct Q_journal_block_header_struct
+    {
+
+        // Q_JOURNAL_MAGIC ( without null character )
+        char magic[8];
+        // Q_JOURNAL_FORMAT_VERSION ( records are Q_file_record )
+        unsigned int format_version;
+        // size of each record in bytes
+        unsigned int record_size;
+
+        // training counter after the race whose updates are in this block
+        long long int training_counter;
+
+        // number of records in this block
+        unsigned long long int record_count;
+
+        // checksum of records ( to find a block that was partly written )
+        unsigned long long int checksum;
+
+    } Q_journal_block_header;
+
+
+    /**
+     * number of Q value updates of each action of a state ( see Q_visit_counts )
+     **/
+    typedef struct Q_visit_record_struct
+    {
+
+        // visit counts of actions ( indexed by Q_action_index )
+        unsigned int visit_counts[Q_ACTION_SPACE_SIZE];
+
+    } Q_visit_record;
+
+
+    /**
+     * visit counts of a state along with its key as it is stored in a visit
+     * count file ( records are sorted by state key )
+     **/
+    typedef struct Q_visit_file_record_struct
+    {
+
+        Q_state_key state_key;
+        Q_visit_record visit_record;
+
+    } Q_visit_file_record;
+
+
+    /**
+     * header of a visit count file
+     **/
+    typedef struct Q_visit_header_struct
+    {
+
+        // Q_VISIT_MAGIC ( without null character )
+        char magic[8];
+        // Q_VISIT_FORMAT_VERSION
+        unsigned int format_version;
+        // Q_BINARY_BYTE_ORDER_MARK as written by the machine
+        unsigned int byte_order_mark;
+        // size of each record in bytes
+        unsigned int record_size;
+        unsigned int reserved;
+
+        // training counter of the Q value file written along with it
+        long long int training_counter;
+
+        // number of records ( states ) in the file
+        unsigned long long int record_count;
+
+    } Q_visit_header;
+
+
+    /**
+     * returns index of the shard for a state with given magnitude of speed_x.
+     * There is a shard for each speed_x magnitude in [0, 59] and states with
+     * other speed_x are in the last ( default ) shard.
+     **/
+    inline int get_Q_shard_for(const long speed_x_magnitude)
+    {
+        // check for bounds
+        if(speed_x_magnitude < 0 || speed_x_magnitude >= Q_BINARY_SHARDS - 1)
+        {
+            return Q_BINARY_SHARDS - 1;
+        }
+
+        return (int) speed_x_magnitude;
+    }
+
+
+    /**
+     * quantizes Q values of a record to 16 bit levels. Exponent is the smallest
+     * one for which the largest Q value, once rounded, fits in the levels, so
+     * each Q value is within half a level of its float value. A non-zero Q value
+     * never becomes zero ( its sign is kept ), so one that is less than half a
+     * level becomes one level ( within a level of its float value ). Order of
+     * Q values is kept, so max Q action and sign of max Q value are same as
+     * those of the float values.
+     **/
+    inline void quantize_Q_record(const Q_state_key state_key,
+            const Q_state_record & state_record, Q_quantized_record & quantized_record)
+    {
+        float max_magnitude = 0;
+        for(int i = 0; i < Q_ACTION_SPACE_SIZE; i++)
+        {
+            if((state_record.tried_actions & (1u << i)) &&
+                    fabsf(state_record.Q_values[i]) > max_magnitude)
+            {
+                max_magnitude = fabsf(state_record.Q_values[i]);
+            }
+        }
+
+        // max magnitude is less than 2^15 levels
+        int exponent = 0;
+        frexpf(max_magnitude, &exponent);
+        exponent = (max_magnitude == 0) ? 0 : exponent - 15;
+
+        // ( just below a power of 2 it is rounded to 2^15 levels, which don't fit )
+        if(lrint(ldexp((double) max_magnitude, -exponent)) > 32767)
+        {
+            exponent++;
+        }
+        exponent = (exponent < -128) ? -128 : ((exponent > 127) ? 127 : exponent);
+
+        quantized_record.state_key = state_key;
+        for(int i = 0; i < Q_ACTION_SPACE_SIZE; i++)
+        {
+            long level = 0;
+            const float Q_value = state_record.Q_values[i];
+            if((state_record.tried_actions & (1u << i)) && Q_value != 0)
+            {
+                level = lrint(ldexp((double) Q_value, -exponent));
+                level = (level > 32767) ? 32767 : ((level < -32767) ? -32767 : level);
+                if(level == 0)
+                {
+                    level = (Q_value < 0) ? -1 : 1;
+                }
+            }
+            quantized_record.Q_levels[i] = (short) level;
+        }
+        quantized_record.tried_actions = state_record.tried_actions;
+        quantized_record.max_Q_action = state_record.max_Q_action;
+        quantized_record.Q_exponent = (signed char) exponent;
+    }
+
+    /* sets Q values of a record from a quantized record ( see "quantize_Q_record" ) */
+    inline void dequantize_Q_record(const Q_quantized_record & quantized_record,
+            Q_state_record & state_record)
+    {
+        // a level times a power of 2 is exact in float
+        const float level_value = ldexpf(1.0f, quantized_record.Q_exponent);
+        for(int i = 0; i < Q_ACTION_SPACE_SIZE; i++)
+        {
+            state_record.Q_values[i] = quantized_record.Q_levels[i] * level_value;
+        }
+        state_record.tried_actions = quantized_record.tried_actions;
+        state_record.max_Q_action = quantized_record.max_Q_action;
+        state_record.max_Q_value = state_record.Q_values[quantized_record.max_Q_action];
+    }
+
+
+    static_assert(sizeof(Q_quantized_record) == 32,
+            "quantized records should be 32 bytes");
+    static_assert(sizeof(Q_binary_header) % sizeof(Q_state_key) == 0,
+            "records after the header should be aligned for their state keys");
+    static_assert(sizeof(Q_journal_block_header) % sizeof(Q_state_key) == 0,
+            "records after a block header should be aligned for their state keys");
+
+}
+
+
+#endif      /* ifndef CAR222_Q_BINARY_FORMAT_H_ */
+
+
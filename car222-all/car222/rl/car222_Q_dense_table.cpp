@@ -0,0 +1,344 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * car222_Q_dense_table.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "car222_Q_dense_table.h"
+
+
+namespace
+{
+
+    using namespace controller_storage;
+
+    /**
+     * returns non-zero if a dimension with given bounds has a separate
+     * slot for "-0" ( only fractional dimensions can have "-0" and it is
+     * kept just before the slot for "+0" ).
+     **/
+    template <typename DIMENSION>
+    inline int has_negative_zero(const long min_steps, const long max_steps)
+    {
+        return DIMENSION::STEPS_PER_UNIT > 1 && min_steps <= 0 && max_steps >= 0;
+    }
+
+    /* returns number of slots along a dimension with given bounds */
+    template <typename DIMENSION>
+    inline long get_dimension_slot_count(const long min_steps, const long max_steps)
+    {
+        return (max_steps < min_steps) ? 0 :
+            (max_steps - min_steps + 1 + has_negative_zero<DIMENSION>(min_steps, max_steps));
+    }
+
+    /* returns slot along a dimension for the given key or -1 if it is out of bounds */
+    template <typename DIMENSION>
+    inline long get_dimension_slot(const Q_state_key state_key,
+            const long min_steps, const long max_steps)
+    {
+        const long magnitude = DIMENSION::magnitude(state_key);
+        const int negative = DIMENSION::is_negative(state_key);
+        const long steps = negative ? -magnitude : magnitude;
+
+        if(steps < min_steps || steps > max_steps)
+        {
+            return -1;
+        }
+
+        // "+0" and positive values are after the slot for "-0"
+        return steps - min_steps +
+            ((has_negative_zero<DIMENSION>(min_steps, max_steps) && !negative) ? 1 : 0);
+    }
+
+    /* returns bits of the key for the given slot along a dimension */
+    template <typename DIMENSION>
+    inline Q_state_key get_dimension_key(long slot,
+            const long min_steps, const long max_steps)
+    {
+        if(has_negative_zero<DIMENSION>(min_steps, max_steps))
+        {
+            // slot for "-0"
+            const long negative_zero_slot = -min_steps;
+
+            if(slot == negative_zero_slot)
+            {
+                return DIMENSION::encode_steps(0, 1);
+            }
+            else if(slot > negative_zero_slot)
+            {
+                slot--;
+            }
+        }
+
+        const long steps = slot + min_steps;
+        return DIMENSION::encode_steps(steps < 0 ? -steps : steps, steps < 0);
+    }
+
+
+    /**
+     * returns action with max Q value among tried actions
+     * ( lowest action if there is a tie ) and sets max Q value.
+     * "tried_actions" should have at least one bit set.
+     **/
+    inline int find_max_Q_action(const float * Q_values,
+            const unsigned int tried_actions, float & max_Q_value)
+    {
+#if (defined(__AVX2__) || defined(__SSE2__))
+
+        static_assert(Q_ACTION_SPACE_SIZE == 9,
+                "vectorized argmax is written for 8 lanes and one more action");
+
+#if defined(__AVX2__)
+
+        // lanes of untried actions are set to -infinity
+        const __m256i lane_bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+        const __m256i tried_lanes = _mm256_cmpeq_epi32(
+                _mm256_and_si256(_mm256_set1_epi32(tried_actions), lane_bits), lane_bits);
+        const __m256 values = _mm256_blendv_ps(_mm256_set1_ps(-INFINITY),
+                _mm256_loadu_ps(Q_values), _mm256_castsi256_ps(tried_lanes));
+
+        // max of 8 lanes
+        __m128 max_values = _mm_max_ps(_mm256_castps256_ps128(values),
+                _mm256_extractf128_ps(values, 1));
+
+#else
+
+        // lanes of untried actions are set to -infinity
+        const __m128i tried = _mm_set1_epi32(tried_actions);
+        const __m128i low_lane_bits = _mm_setr_epi32(1, 2, 4, 8);
+        const __m128i high_lane_bits = _mm_setr_epi32(16, 32, 64, 128);
+        const __m128 low_tried_lanes = _mm_castsi128_ps(_mm_cmpeq_epi32(
+                    _mm_and_si128(tried, low_lane_bits), low_lane_bits));
+        const __m128 high_tried_lanes = _mm_castsi128_ps(_mm_cmpeq_epi32(
+                    _mm_and_si128(tried, high_lane_bits), high_lane_bits));
+        const __m128 minus_infinity = _mm_set1_ps(-INFINITY);
+        const __m128 low_values = _mm_or_ps(
+                _mm_and_ps(low_tried_lanes, _mm_loadu_ps(Q_values)),
+                _mm_andnot_ps(low_tried_lanes, minus_infinity));
+        const __m128 high_values = _mm_or_ps(
+                _mm_and_ps(high_tried_lanes, _mm_loadu_ps(Q_values + 4)),
+                _mm_andnot_ps(high_tried_lanes, minus_infinity));
+
+        // max of 8 lanes
+        __m128 max_values = _mm_max_ps(low_values, high_values);
+
+#endif
+
+        max_values = _mm_max_ps(max_values, _mm_movehl_ps(max_values, max_values));
+        max_values = _mm_max_ss(max_values, _mm_shuffle_ps(max_values, max_values, 1));
+        const float max_of_lanes = _mm_cvtss_f32(max_values);
+
+        // last action is not in the lanes (it wins only if it is greater)
+        if((tried_actions & (1u << 8)) && (!(tried_actions & 0xff) || Q_values[8] > max_of_lanes))
+        {
+            max_Q_value = Q_values[8];
+            return 8;
+        }
+
+        // lowest lane that has max value
+#if defined(__AVX2__)
+        const int max_lanes = _mm256_movemask_ps(
+                _mm256_cmp_ps(values, _mm256_set1_ps(max_of_lanes), _CMP_EQ_OQ));
+#else
+        const __m128 max_of_lanes_4 = _mm_set1_ps(max_of_lanes);
+        const int max_lanes = _mm_movemask_ps(_mm_cmpeq_ps(low_values, max_of_lanes_4))
+            | (_mm_movemask_ps(_mm_cmpeq_ps(high_values, max_of_lanes_4)) << 4);
+#endif
+
+        max_Q_value = max_of_lanes;
+        return __builtin_ctz(max_lanes & tried_actions);
+
+#else
+
+        int max_Q_action = -1;
+        for(int i = 0; i < Q_ACTION_SPACE_SIZE; i++)
+        {
+            if( (tried_actions & (1u << i)) &&
+                    (max_Q_action < 0 || Q_values[i] > max_Q_value) )
+            {
+                max_Q_value = Q_values[i];
+                max_Q_action = i;
+            }
+        }
+
+        return max_Q_action;
+
+#endif
+    }
+
+}
+
+
+controller_storage::Q_dense_table::Q_dense_table(const Q_dense_bounds & t_bounds)
+{
+    m_bounds = t_bounds;
+    m_Q_values = NULL;
+    m_tried_actions = NULL;
+
+    // slots along each dimension
+    m_slot_counts[0] = get_dimension_slot_count<speed_x_dimension>(
+            m_bounds.min_steps[0], m_bounds.max_steps[0]);
+    m_slot_counts[1] = get_dimension_slot_count<speed_y_dimension>(
+            m_bounds.min_steps[1], m_bounds.max_steps[1]);
+    m_slot_counts[2] = get_dimension_slot_count<right_side_distance_dimension>(
+            m_bounds.min_steps[2], m_bounds.max_steps[2]);
+    m_slot_counts[3] = get_dimension_slot_count<left_side_distance_dimension>(
+            m_bounds.min_steps[3], m_bounds.max_steps[3]);
+    m_slot_counts[4] = get_dimension_slot_count<path_dimension>(
+            m_bounds.min_steps[4], m_bounds.max_steps[4]);
+    m_slot_counts[5] = get_dimension_slot_count<next_path_dimension>(
+            m_bounds.min_steps[5], m_bounds.max_steps[5]);
+
+    // last dimension has consecutive slots
+    m_number_of_slots = 1;
+    for(int i = Q_STATE_DIMENSIONS - 1; i >= 0; i--)
+    {
+        m_slot_strides[i] = m_number_of_slots;
+        m_number_of_slots *= m_slot_counts[i];
+    }
+
+    if(m_number_of_slots <= 0)
+    {
+        puts("empty bounds for dense Q table");
+        return;
+    }
+
+    // zero initialized Q values and tried action masks
+    m_Q_values = (float *) calloc(m_number_of_slots * Q_ACTION_SPACE_SIZE, sizeof(float));
+    m_tried_actions = (unsigned short *) calloc(m_number_of_slots, sizeof(unsigned short));
+
+    if(!is_allocated())
+    {
+        printf("couldn't allocate dense Q table of %ld states\n", m_number_of_slots);
+
+        free(m_Q_values);
+        free(m_tried_actions);
+        m_Q_values = NULL;
+        m_tried_actions = NULL;
+    }
+}
+
+
+controller_storage::Q_dense_table::~Q_dense_table()
+{
+    free(m_Q_values);
+    free(m_tried_actions);
+}
+
+
+long controller_storage::Q_dense_table::get_slot_for(const Q_state_key state_key) const
+{
+    const long dimension_slots[Q_STATE_DIMENSIONS] =
+    {
+        get_dimension_slot<speed_x_dimension>(state_key,
+                m_bounds.min_steps[0], m_bounds.max_steps[0]),
+        get_dimension_slot<speed_y_dimension>(state_key,
+                m_bounds.min_steps[1], m_bounds.max_steps[1]),
+        get_dimension_slot<right_side_distance_dimension>(state_key,
+                m_bounds.min_steps[2], m_bounds.max_steps[2]),
+        get_dimension_slot<left_side_distance_dimension>(state_key,
+                m_bounds.min_steps[3], m_bounds.max_steps[3]),
+        get_dimension_slot<path_dimension>(state_key,
+                m_bounds.min_steps[4], m_bounds.max_steps[4]),
+        get_dimension_slot<next_path_dimension>(state_key,
+                m_bounds.min_steps[5], m_bounds.max_steps[5])
+    };
+
+    long slot = 0;
+    for(int i = 0; i < Q_STATE_DIMENSIONS; i++)
+    {
+        // out of bounds in any dimension
+        if(dimension_slots[i] < 0)
+        {
+            return -1;
+        }
+
+        slot += dimension_slots[i] * m_slot_strides[i];
+    }
+
+    return slot;
+}
+
+
+controller_storage::Q_state_key controller_storage::Q_dense_table::get_key_for(
+        const long slot) const
+{
+    // slot along each dimension
+    long dimension_slots[Q_STATE_DIMENSIONS];
+    for(int i = 0; i < Q_STATE_DIMENSIONS; i++)
+    {
+        dimension_slots[i] = (slot / m_slot_strides[i]) % m_slot_counts[i];
+    }
+
+    return get_dimension_key<speed_x_dimension>(dimension_slots[0],
+                m_bounds.min_steps[0], m_bounds.max_steps[0])
+        | get_dimension_key<speed_y_dimension>(dimension_slots[1],
+                m_bounds.min_steps[1], m_bounds.max_steps[1])
+        | get_dimension_key<right_side_distance_dimension>(dimension_slots[2],
+                m_bounds.min_steps[2], m_bounds.max_steps[2])
+        | get_dimension_key<left_side_distance_dimension>(dimension_slots[3],
+                m_bounds.min_steps[3], m_bounds.max_steps[3])
+        | get_dimension_key<path_dimension>(dimension_slots[4],
+                m_bounds.min_steps[4], m_bounds.max_steps[4])
+        | get_dimension_key<next_path_dimension>(dimension_slots[5],
+                m_bounds.min_steps[5], m_bounds.max_steps[5]);
+}
+
+
+int controller_storage::Q_dense_table::get_max_Q_action(const long slot,
+        float & max_Q_value) const
+{
+    const unsigned int tried_actions = m_tried_actions[slot];
+
+    // no action has been tried
+    if(tried_actions == 0)
+    {
+        max_Q_value = 0;
+        return -1;
+    }
+
+    return find_max_Q_action(get_Q_values(slot), tried_actions, max_Q_value);
+}
+
+
+size_t controller_storage::Q_dense_table::get_memory_footprint() const
+{
+    if(!is_allocated())
+    {
+        return sizeof(*this);
+    }
+
+    return sizeof(*this) + m_number_of_slots *
+        (Q_ACTION_SPACE_SIZE * sizeof(float) + sizeof(unsigned short));
+}
+
+
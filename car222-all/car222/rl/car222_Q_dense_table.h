@@ -0,0 +1,201 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * car222_Q_dense_table.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  CAR222_Q_DENSE_TABLE_H_
+#define  CAR222_Q_DENSE_TABLE_H_
+
+
+#include <stddef.h>
+
+#include "car222_Q_state_key.h"
+
+
+// number of dimensions in a Q state
+#define Q_STATE_DIMENSIONS 6
+
+
+namespace controller_storage
+{
+
+    /**
+     * Bounds of the states kept in a dense Q table.
+     *
+     * Bounds of each dimension are inclusive and are given in quantization
+     * steps of the dimension ( e.g. speed_y bounds {-10, 10} are for speed_y
+     * values in [-1.0, 1.0] ). Dimensions are in the order of the fields in
+     * a Q state - speed_x, speed_y, right_side_distance, left_side_distance,
+     * path and next_path.
+     **/
+    typedef struct Q_dense_bounds_struct
+    {
+
+        long min_steps[Q_STATE_DIMENSIONS];
+        long max_steps[Q_STATE_DIMENSIONS];
+
+    } Q_dense_bounds;
+
+
+    /*
+     * ==========================================================================
+     *        Class:  Q_dense_table
+     *  Description:  Q values of all the states within given bounds stored
+     *                as one contiguous float tensor [states x actions]. A state
+     *                finds its slot (row) in the tensor by index arithmetic on
+     *                its key, so it does not need any search.
+     *
+     *                Along with the tensor, it keeps a mask of tried actions for
+     *                each slot. Max Q value of a slot is not cached, instead it
+     *                is found by a vectorized argmax over the row (AVX2 or SSE2
+     *                when the compiler targets them).
+     *
+     *                States outside the bounds are not kept here and the caller
+     *                ( Q_maps ) keeps them in its sparse maps.
+     * ==========================================================================
+     */
+    class Q_dense_table
+    {
+        public :
+
+            /** MEMBER FUNCTIONS **/
+
+            /* constructor with bounds of the table ( check "is_allocated" after it ) */
+            explicit Q_dense_table(const Q_dense_bounds & t_bounds);
+
+            ~Q_dense_table();
+
+            /* returns non-zero if memory for the table could be allocated */
+            inline int is_allocated() const
+            {
+                return m_Q_values != NULL && m_tried_actions != NULL;
+            }
+
+            /* returns slot of the given state or -1 if it is outside the bounds */
+            long get_slot_for(const Q_state_key state_key) const;
+
+            /* returns state key of the given slot */
+            Q_state_key get_key_for(const long slot) const;
+
+            /**
+             * returns number of consecutive slots of states with given speed_x
+             * ( in quantization steps ) and sets first of those slots. It returns
+             * 0 if speed_x is out of the bounds. Speed_x is the outermost dimension
+             * of the table, so these slots are all the slots for that speed_x.
+             **/
+            inline long get_slots_for_speed_x(const long speed_x_steps, long & first_slot) const
+            {
+                if(speed_x_steps < m_bounds.min_steps[0] || speed_x_steps > m_bounds.max_steps[0])
+                {
+                    first_slot = 0;
+                    return 0;
+                }
+
+                first_slot = (speed_x_steps - m_bounds.min_steps[0]) * m_slot_strides[0];
+                return m_slot_strides[0];
+            }
+
+            /* returns number of slots ( states ) in the table */
+            inline long get_number_of_slots() const
+            {
+                return m_number_of_slots;
+            }
+
+            /* returns Q values ( row of Q_ACTION_SPACE_SIZE values ) of the given slot */
+            inline const float * get_Q_values(const long slot) const
+            {
+                return m_Q_values + slot * Q_ACTION_SPACE_SIZE;
+            }
+
+            /* returns mask of tried actions of the given slot */
+            inline unsigned short get_tried_actions(const long slot) const
+            {
+                return m_tried_actions[slot];
+            }
+
+            /* sets Q value of given action in given slot and marks it as tried */
+            inline void set_Q_value(const long slot, const Q_action_index action_index,
+                    const float t_Q_value)
+            {
+                m_Q_values[slot * Q_ACTION_SPACE_SIZE + action_index] = t_Q_value;
+                m_tried_actions[slot] |= (1u << action_index);
+            }
+
+            /**
+             * finds max Q value among tried actions of the given slot and
+             * returns its action ( lowest action if there is a tie ).
+             * It returns -1 if no action has been tried for the slot.
+             **/
+            int get_max_Q_action(const long slot, float & max_Q_value) const;
+
+            /* returns bounds of the table */
+            inline const Q_dense_bounds & get_bounds() const
+            {
+                return m_bounds;
+            }
+
+            /* returns bytes used by the table */
+            size_t get_memory_footprint() const;
+
+
+        private :
+
+            /** MEMBER VARIABLES **/
+
+            /* bounds of the table */
+            Q_dense_bounds m_bounds;
+
+            /* slots along each dimension */
+            long m_slot_counts[Q_STATE_DIMENSIONS];
+
+            /* distance between consecutive slots of each dimension */
+            long m_slot_strides[Q_STATE_DIMENSIONS];
+
+            /* total number of slots */
+            long m_number_of_slots;
+
+            /* tensor of Q values [m_number_of_slots x Q_ACTION_SPACE_SIZE] */
+            float * m_Q_values;
+
+            /* mask of tried actions for each slot */
+            unsigned short * m_tried_actions;
+
+
+            /** MEMBER FUNCTIONS **/
+
+            // restricted copy constructor
+            Q_dense_table(const Q_dense_table &other) = delete;
+
+            // restricted assignment operator
+            Q_dense_table& operator=(const Q_dense_table &other) = delete;
+
+    };
+
+}
+
+
+#endif      /* ifndef CAR222_Q_DENSE_TABLE_H_ */
+
+
@@ -26,12 +26,279 @@
 
 
 #include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <string>
 #include <map>
 #include <vector>
+#include <algorithm>
 
-#include "car222_string_formats.h"
 #include "car222_Q_maps.h"
+#include "car222_Q_text_codec.h"
+
+
+namespace
+{
+
+    /* locks a mutex while it is in scope */
+    class mutex_guard
+    {
+        public :
+
+            explicit mutex_guard(pthread_mutex_t & t_mutex) : m_mutex(t_mutex)
+            {
+                pthread_mutex_lock(&m_mutex);
+            }
+
+            ~mutex_guard()
+            {
+                pthread_mutex_unlock(&m_mutex);
+            }
+
+        private :
+
+            pthread_mutex_t & m_mutex;
+
+            mutex_guard(const mutex_guard &other) = delete;
+            mutex_guard& operator=(const mutex_guard &other) = delete;
+    };
+
+}
+
+
+/* orders file records by state key */
+static inline bool is_key_less(const controller_storage::Q_file_record & record,
+        const controller_storage::Q_state_key state_key)
+{
+    return record.state_key < state_key;
+}
+
+static inline bool is_record_less(const controller_storage::Q_file_record & record_1,
+        const controller_storage::Q_file_record & record_2)
+{
+    return record_1.state_key < record_2.state_key;
+}
+
+static inline bool is_quantized_key_less(
+        const controller_storage::Q_quantized_record & record,
+        const controller_storage::Q_state_key state_key)
+{
+    return record.state_key < state_key;
+}
+
+
+/* copies given string to a fixed length id field of binary file header */
+static void copy_id(char * id_field, const std::string & id)
+{
+    memset(id_field, 0, Q_BINARY_ID_LENGTH);
+    strncpy(id_field, id.c_str(), Q_BINARY_ID_LENGTH - 1);
+}
+
+
+/* returns FNV-1a hash of given bytes ( checksum of journal blocks ) */
+static unsigned long long int get_checksum(const void * data, const size_t size)
+{
+    const unsigned char * bytes = (const unsigned char *) data;
+    unsigned long long int hash = 14695981039346656037ULL;
+    for(size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+
+/**
+ * flushes a temporary Q value file to disk, closes it and renames it to the
+ * given Q value file name. Returns 0 on success, else -1 ( and the temporary
+ * file is removed ). "write_error" tells if writing the file had failed.
+ **/
+static int close_and_rename(FILE * temporary_file, const std::string & temporary_file_name,
+        const std::string & t_Q_value_file_name, int write_error)
+{
+    write_error = write_error || fflush(temporary_file) != 0
+        || fsync(fileno(temporary_file)) != 0;
+
+    // closing the file
+    if(fclose(temporary_file) == EOF || write_error)
+    {
+        printf("error writing file \'%s\'\n", temporary_file_name.c_str());
+        remove(temporary_file_name.c_str());
+        return -1;
+    }
+
+    if(rename(temporary_file_name.c_str(), t_Q_value_file_name.c_str()) != 0)
+    {
+        printf("error renaming file \'%s\' to \'%s\'\n",
+                temporary_file_name.c_str(), t_Q_value_file_name.c_str());
+        remove(temporary_file_name.c_str());
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/* prints a warning if an id in binary file header differs from the expected id */
+static void check_id(const char * id_name, const char * id_field, const std::string & id)
+{
+    if(!id.empty() && strncmp(id_field, id.c_str(), Q_BINARY_ID_LENGTH) != 0)
+    {
+        printf("warning: Q value file has %s \"%.*s\" instead of \"%s\"\n",
+                id_name, Q_BINARY_ID_LENGTH, id_field, id.c_str());
+    }
+}
+
+
+/* writes a snapshot to a text Q value file ( see MAP_WRITE_FORMAT ) */
+static int write_text_snapshot(const controller_storage::Q_maps_snapshot & snapshot)
+{
+    // file is written with a temporary name and renamed when it is complete
+    const std::string temporary_file_name = snapshot.file_name + ".tmp";
+
+    FILE * t_Q_value_file = fopen(temporary_file_name.c_str(), "w");
+    if(t_Q_value_file == NULL)
+    {
+        printf("couldn't open file \'%s\' for writing the map.\n",
+                temporary_file_name.c_str());
+        return -1;
+    }
+
+    printf("writing map to file \'%s\'\n", snapshot.file_name.c_str());
+
+    // write states of each shard followed by the counter
+    const int write_error = controller_storage::write_Q_text_file(t_Q_value_file,
+            snapshot.shard_records, snapshot.training_counter) != 0;
+
+    // closing the file
+    const int close_value = close_and_rename(t_Q_value_file, temporary_file_name,
+            snapshot.file_name, write_error);
+
+    if(close_value == 0)
+    {
+        printf("file closed \'%s\'\n", snapshot.file_name.c_str());
+    }
+
+    return close_value;
+}
+
+
+/* writes a snapshot to a binary Q value file ( see car222_Q_binary_format.h ) */
+static int write_binary_snapshot(const controller_storage::Q_maps_snapshot & snapshot)
+{
+    using namespace controller_storage;
+
+    // file is written with a temporary name and renamed when it is complete
+    const std::string temporary_file_name = snapshot.file_name + ".tmp";
+
+    FILE * t_Q_value_file = fopen(temporary_file_name.c_str(), "wb");
+    if(t_Q_value_file == NULL)
+    {
+        printf("couldn't open file \'%s\' for writing the map.\n",
+                temporary_file_name.c_str());
+        return -1;
+    }
+
+    printf("writing map to binary file \'%s\'\n", snapshot.file_name.c_str());
+
+    Q_binary_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, Q_BINARY_MAGIC, sizeof(header.magic));
+    header.format_version = Q_BINARY_FORMAT_VERSION;
+    header.byte_order_mark = Q_BINARY_BYTE_ORDER_MARK;
+    header.header_size = sizeof(Q_binary_header);
+    header.value_encoding = snapshot.value_encoding;
+    header.record_size = (snapshot.value_encoding == Q_VALUES_INT16)
+        ? sizeof(Q_quantized_record) : sizeof(Q_file_record);
+    copy_id(header.Q_learner_id, snapshot.Q_learner_id);
+    copy_id(header.reward_id, snapshot.reward_id);
+    copy_id(header.fuzzy_controller_version, snapshot.fuzzy_controller_version);
+    header.training_counter = snapshot.training_counter;
+
+    // offset of each shard
+    for(int shard = 0; shard < Q_MAP_SHARDS; shard++)
+    {
+        header.shard_offsets[shard] = header.record_count;
+        header.record_count += snapshot.shard_records[shard].size();
+    }
+    header.shard_offsets[Q_MAP_SHARDS] = header.record_count;
+
+    int write_error = fwrite(&header, sizeof(header), 1, t_Q_value_file) != 1;
+    std::vector<Q_quantized_record> quantized_records;
+    for(int shard = 0; shard < Q_MAP_SHARDS && !write_error; shard++)
+    {
+        const std::vector<Q_file_record> & shard_records = snapshot.shard_records[shard];
+        if(shard_records.empty())
+        {
+            continue;
+        }
+
+        if(snapshot.value_encoding == Q_VALUES_INT16)
+        {
+            quantized_records.resize(shard_records.size());
+            for(size_t i = 0; i < shard_records.size(); i++)
+            {
+                quantize_Q_record(shard_records[i].state_key,
+                        shard_records[i].state_record, quantized_records[i]);
+            }
+
+            write_error = fwrite(&quantized_records[0], sizeof(Q_quantized_record),
+                    quantized_records.size(), t_Q_value_file) != quantized_records.size();
+        }
+        else
+        {
+            write_error = fwrite(&shard_records[0], sizeof(Q_file_record),
+                    shard_records.size(), t_Q_value_file) != shard_records.size();
+        }
+    }
+
+    // closing the file
+    const int close_value = close_and_rename(t_Q_value_file, temporary_file_name,
+            snapshot.file_name, write_error);
+
+    if(close_value == 0)
+    {
+        printf("file closed \'%s\' (%llu states%s)\n",
+                snapshot.file_name.c_str(), header.record_count,
+                (snapshot.value_encoding == Q_VALUES_INT16) ? ", quantized" : "");
+    }
+
+    return close_value;
+}
+
+
+/* writes a snapshot to its file ( text or binary ) */
+static int write_snapshot(const controller_storage::Q_maps_snapshot & snapshot)
+{
+    return snapshot.binary_file ? write_binary_snapshot(snapshot) : write_text_snapshot(snapshot);
+}
+
+
+/**
+ * thread function that writes the given snapshot ( Q_maps_snapshot * ) and
+ * removes checkpoint journal of the file once it is written
+ **/
+static void * run_background_write(void * t_snapshot)
+{
+    controller_storage::Q_maps_snapshot * snapshot =
+        (controller_storage::Q_maps_snapshot *) t_snapshot;
+
+    snapshot->write_result = write_snapshot(*snapshot);
+    if(snapshot->write_result == 0)
+    {
+        remove((snapshot->file_name + Q_JOURNAL_FILE_SUFFIX
+                    Q_JOURNAL_CHECKPOINT_SUFFIX).c_str());
+    }
+
+    return NULL;
+}
 
 
 controller_storage::Q_maps::Q_maps()
@@ -45,31 +312,46 @@ controller_storage::Q_maps::Q_maps()
     {
         for(int j = 0; j < Q_MAP_ARRAY_COLUMNS; j++)
         {
-            velocity_Q_map_pointers[i][j] = new state_action_Q_map;
+            velocity_Q_map_pointers[i][j] = new state_Q_record_map;
         }
     }
 
     // default velocity Q map pointer
-    default_velocity_Q_map_pointer = new state_action_Q_map;
+    default_velocity_Q_map_pointer = new state_Q_record_map;
 
-    // map for state to max Q value and corresponding action
-    max_Q_and_action_map_pointer = new state_max_Q_and_action_map;
-}
+    // sparse maps are used until a dense table is asked for
+    m_dense_table = NULL;
 
+    // no file is written in background
+    m_writer_snapshot = NULL;
 
-controller_storage::Q_maps::~Q_maps()
-{
-    // delete max Q and action map values
-    for(std::map<std::string, max_Q_and_action * >::iterator
-            max_iterator = max_Q_and_action_map_pointer->begin();
-            max_iterator != max_Q_and_action_map_pointer->end();
-            max_iterator++)
+    // binary files have float Q values unless quantization is asked for
+    m_binary_value_encoding = Q_VALUES_FLOAT32;
+
+    // no binary file is mapped
+    m_mapped_file = NULL;
+    m_mapped_file_size = 0;
+    m_mapped_file_writable = 0;
+    for(int i = 0; i < Q_MAP_SHARDS; i++)
     {
-        delete max_iterator->second;
+        m_mapped_shards[i] = NULL;
+        m_quantized_shards[i] = NULL;
+        m_mapped_shard_sizes[i] = 0;
     }
-    // delete max Q and action map pointer
-    delete max_Q_and_action_map_pointer;
 
+    m_is_recording_updates = 1;
+
+    for(int i = 0; i < Q_MAP_SHARDS; i++)
+    {
+        pthread_mutex_init(&m_shard_locks[i], NULL);
+    }
+}
+
+
+controller_storage::Q_maps::~Q_maps()
+{
+    // finish writing file in background
+    wait_for_background_write();
 
     // delete velocity Q map pointers
     for(int i = 0; i < Q_MAP_ARRAY_ROWS; i++)
@@ -82,109 +364,287 @@ controller_storage::Q_maps::~Q_maps()
 
     // delete default velocity Q map pointer
     delete default_velocity_Q_map_pointer;
+
+    // delete dense table
+    delete m_dense_table;
+
+    // unmap binary file
+    release_mapped_file(0);
+
+    for(int i = 0; i < Q_MAP_SHARDS; i++)
+    {
+        pthread_mutex_destroy(&m_shard_locks[i]);
+    }
 }
 
 
-float controller_storage::Q_maps::get_Q_value_for(
-        const std::string & state_string,
-        const std::string & action_string) const
+void controller_storage::Q_maps::set_version_ids(const std::string & t_Q_learner_id,
+        const std::string & t_reward_id,
+        const std::string & t_fuzzy_controller_version)
+{
+    m_Q_learner_id = t_Q_learner_id;
+    m_reward_id = t_reward_id;
+    m_fuzzy_controller_version = t_fuzzy_controller_version;
+}
+
+
+void controller_storage::Q_maps::set_binary_value_encoding(const int t_value_encoding)
+{
+    m_binary_value_encoding = t_value_encoding;
+}
+
+
+controller_storage::Q_file_record * controller_storage::Q_maps::find_mapped_record(
+        const Q_state_key state_key) const
+{
+    if(m_mapped_file == NULL || m_mapped_shards[0] == NULL)
+    {
+        return NULL;
+    }
+
+    // binary search in the sorted records of the state's shard
+    const int shard = get_shard_for(speed_x_dimension::magnitude(state_key));
+    Q_file_record * shard_end = m_mapped_shards[shard] + m_mapped_shard_sizes[shard];
+    Q_file_record * found_record =
+        std::lower_bound(m_mapped_shards[shard], shard_end, state_key, is_key_less);
+
+    return (found_record != shard_end && found_record->state_key == state_key)
+        ? found_record : NULL;
+}
+
+
+const controller_storage::Q_quantized_record * controller_storage::Q_maps::find_quantized_record(
+        const Q_state_key state_key) const
+{
+    if(m_mapped_file == NULL || m_quantized_shards[0] == NULL)
+    {
+        return NULL;
+    }
+
+    // binary search in the sorted records of the state's shard
+    const int shard = get_shard_for(speed_x_dimension::magnitude(state_key));
+    const Q_quantized_record * shard_end = m_quantized_shards[shard] + m_mapped_shard_sizes[shard];
+    const Q_quantized_record * found_record = std::lower_bound(m_quantized_shards[shard],
+            shard_end, state_key, is_quantized_key_less);
+
+    return (found_record != shard_end && found_record->state_key == state_key)
+        ? found_record : NULL;
+}
+
+
+int controller_storage::Q_maps::get_mapped_record(const Q_state_key state_key,
+        Q_state_record & state_record) const
+{
+    const Q_file_record * mapped_record = find_mapped_record(state_key);
+    if(mapped_record != NULL)
+    {
+        state_record = mapped_record->state_record;
+        return 1;
+    }
+
+    const Q_quantized_record * quantized_record = find_quantized_record(state_key);
+    if(quantized_record != NULL)
+    {
+        dequantize_Q_record(*quantized_record, state_record);
+        return 1;
+    }
+
+    return 0;
+}
+
+
+void controller_storage::Q_maps::get_mapped_file_record(const int shard, const size_t index,
+        Q_file_record & file_record) const
+{
+    if(m_quantized_shards[shard] != NULL)
+    {
+        file_record.state_key = m_quantized_shards[shard][index].state_key;
+        dequantize_Q_record(m_quantized_shards[shard][index], file_record.state_record);
+    }
+    else
+    {
+        file_record = m_mapped_shards[shard][index];
+    }
+}
+
+
+const controller_storage::Q_state_record * controller_storage::Q_maps::find_sparse_record(
+        const Q_state_key state_key, Q_state_record & mapped_record_copy) const
 {
     // get the map for the given state
-    std::map<std::string, float> state_Q_value_map =
-        get_map_for(state_string);
-    // get the combined map key for state and action
-    const std::string map_key = state_string + '|' + action_string;
+    const state_Q_record_map & state_Q_value_map =
+        get_map_for(speed_x_dimension::magnitude(state_key));
+
+    state_Q_record_map::const_iterator
+        iterator_to_searched_key = state_Q_value_map.find(state_key);
+
+    if(iterator_to_searched_key != state_Q_value_map.end())
+    {
+        return &(iterator_to_searched_key->second);
+    }
+
+    // check mapped file if state is not in sparse maps
+    const Q_file_record * mapped_record = find_mapped_record(state_key);
+    if(mapped_record != NULL)
+    {
+        return &(mapped_record->state_record);
+    }
+
+    // quantized records are copied as float records
+    return get_mapped_record(state_key, mapped_record_copy) ? &mapped_record_copy : NULL;
+}
+
+
+void controller_storage::Q_maps::get_dense_record(
+        const Q_dense_table & dense_table,
+        const long slot, Q_state_record & state_record)
+{
+    memcpy(state_record.Q_values, dense_table.get_Q_values(slot),
+            sizeof(state_record.Q_values));
+    state_record.tried_actions = dense_table.get_tried_actions(slot);
+
+    const int max_Q_action = dense_table.get_max_Q_action(slot, state_record.max_Q_value);
+    state_record.max_Q_action = (max_Q_action < 0) ? 0 : max_Q_action;
+}
+
+
+int controller_storage::Q_maps::get_record_for(
+        const Q_state_key state_key,
+        Q_state_record & state_record) const
+{
+    const mutex_guard lock(get_lock_for(state_key));
+
+    // check dense table first
+    if(m_dense_table != NULL)
+    {
+        const long slot = m_dense_table->get_slot_for(state_key);
+        if(slot >= 0)
+        {
+            if(m_dense_table->get_tried_actions(slot) == 0)
+            {
+                return 0;
+            }
+
+            get_dense_record(*m_dense_table, slot, state_record);
+            return 1;
+        }
+    }
 
-    std::map<std::string, float>::const_iterator
-        iterator_to_searched_key = state_Q_value_map.find(map_key);
+    Q_state_record mapped_record_copy;
+    const Q_state_record * found_record = find_sparse_record(state_key, mapped_record_copy);
+
+    // return 0 if not found else copy the record
+    if(found_record == NULL)
+    {
+        return 0;
+    }
+
+    state_record = *found_record;
+    return 1;
+}
+
+
+float controller_storage::Q_maps::get_Q_value_for(
+        const Q_state_key state_key,
+        const Q_action_index action_index) const
+{
+    const mutex_guard lock(get_lock_for(state_key));
+
+    return find_Q_value(state_key, action_index);
+}
+
+
+float controller_storage::Q_maps::find_Q_value(
+        const Q_state_key state_key,
+        const Q_action_index action_index) const
+{
+    // dense table has a row for this state
+    if(m_dense_table != NULL)
+    {
+        const long slot = m_dense_table->get_slot_for(state_key);
+        if(slot >= 0)
+        {
+            // untried actions have 0 value in the table
+            return m_dense_table->get_Q_values(slot)[action_index];
+        }
+    }
+
+    Q_state_record mapped_record_copy;
+    const Q_state_record * found_record = find_sparse_record(state_key, mapped_record_copy);
 
     // return 0 if not found else return the value
-    return (iterator_to_searched_key == state_Q_value_map.end())
-        ? 0 : iterator_to_searched_key->second;
+    // (value of an untried action in a record is also 0)
+    return (found_record == NULL) ? 0 : found_record->Q_values[action_index];
 }
 
 
 float controller_storage::Q_maps::get_max_Q_value_for(
-        const std::string & state_name) const
+        const Q_state_key state_key) const
 {
-    state_max_Q_and_action_map::const_iterator iterator_max_to_searched_state =
-        max_Q_and_action_map_pointer->find(state_name);
+    const mutex_guard lock(get_lock_for(state_key));
+
+    // dense table has a row for this state
+    if(m_dense_table != NULL)
+    {
+        const long slot = m_dense_table->get_slot_for(state_key);
+        if(slot >= 0)
+        {
+            // max is 0 if no action has been tried
+            float max_Q_value;
+            m_dense_table->get_max_Q_action(slot, max_Q_value);
+            return max_Q_value;
+        }
+    }
+
+    Q_state_record mapped_record_copy;
+    const Q_state_record * found_record = find_sparse_record(state_key, mapped_record_copy);
 
     // return 0 if state is not found else return the max Q value
-    return (iterator_max_to_searched_state == max_Q_and_action_map_pointer->end())
-        ? 0 : iterator_max_to_searched_state->second->max_Q_value;
+    return (found_record == NULL) ? 0 : found_record->max_Q_value;
 }
 
 
 void controller_storage::Q_maps::check_and_update_max_Q(
-        const std::string & state_name,
-        const std::string & action_name,
-        const float given_Q_value,
-        const std::map<std::string, float> & state_Q_value_map)
+        Q_state_record & state_record,
+        const Q_action_index action_index,
+        const float given_Q_value)
 {
     // update max Q value and max Q value action for this state if -
-    // 1. state is not there in the max_Q_and_action_map
-    // 2. max Q value for the state has changed
+    // 1. this is the first action tried for the state
+    // 2. given Q value is greater than max Q value (or equal for a lower action)
     // 3. Q value for max Q action has changed
 
-    // scan action as float value
-    float action_as_float_value;
-    sscanf(action_name.c_str(), ACTION_READ_FORMAT, &(action_as_float_value));
-
-    state_max_Q_and_action_map::iterator iterator_max_to_searched_state =
-        max_Q_and_action_map_pointer->find(state_name);
-
-    // check if this state is not there in the map
-    if(iterator_max_to_searched_state == max_Q_and_action_map_pointer->end())
+    // check if this is the only tried action of the state
+    if(state_record.tried_actions == (1u << action_index))
     {
-        // add this state and set iterator to newly added state
-        iterator_max_to_searched_state = (max_Q_and_action_map_pointer->
-                insert( std::pair<std::string, max_Q_and_action*>
-                    (state_name, new max_Q_and_action) )).first;
-
-        // update max Q value and max Q action for this new added state
-        iterator_max_to_searched_state->second->max_Q_value = given_Q_value;
-        iterator_max_to_searched_state->second->max_Q_action = action_as_float_value;
+        // update max Q value and max Q action for this new state
+        state_record.max_Q_value = given_Q_value;
+        state_record.max_Q_action = action_index;
     }
     // if given Q value is greater than previous max Q value
-    else if(iterator_max_to_searched_state->second->max_Q_value <= given_Q_value)
+    else if(state_record.max_Q_value < given_Q_value ||
+            (state_record.max_Q_value == given_Q_value &&
+             action_index < state_record.max_Q_action))
     {
         // update max Q value to given Q value
-        iterator_max_to_searched_state->second->max_Q_value = given_Q_value;
+        state_record.max_Q_value = given_Q_value;
         // update max Q value action to given action
-        iterator_max_to_searched_state->second->max_Q_action = action_as_float_value;
+        state_record.max_Q_action = action_index;
     }
     // else check if this is the Q value of max Q action
-    else if(iterator_max_to_searched_state->second->max_Q_action ==
-            action_as_float_value)
-    {
-        // initialize max Q value to given Q value
-        iterator_max_to_searched_state->second->max_Q_value = given_Q_value;
-        // initialize max Q action to given action
-        iterator_max_to_searched_state->second->max_Q_action = action_as_float_value;
-
-        // check matching states if they have Q value greater than set max Q value
-        for(std::map<std::string, float>::const_iterator
-                state_Q_value_map_iterator = state_Q_value_map.begin();
-                state_Q_value_map_iterator != state_Q_value_map.end();
-                state_Q_value_map_iterator++)
-        {
-            // if state name matches and the Q value is greater than set max Q value
-            // then update the max Q value and max Q action
-            if( (state_Q_value_map_iterator->
-                        first.compare(0, STATE_NAME_LENGTH, state_name) == 0) &&
-                    (state_Q_value_map_iterator->second >
-                     iterator_max_to_searched_state->second->max_Q_value) )
+    else if(state_record.max_Q_action == action_index)
+    {
+        // find max again among all tried actions of this state
+        // (lowest action wins if there is a tie)
+        int max_found = 0;
+        for(int i = 0; i < Q_ACTION_SPACE_SIZE; i++)
+        {
+            if( (state_record.tried_actions & (1u << i)) &&
+                    (!max_found || state_record.Q_values[i] > state_record.max_Q_value) )
             {
-                // for setting max Q action
-                // scan action from the state-action key as float value
-                sscanf(state_Q_value_map_iterator->first.c_str(),
-                        STATE_MASK ACTION_READ_FORMAT,
-                        &(iterator_max_to_searched_state->second->max_Q_action));
-
-                // set Q value for this state-action as the max Q value
-                iterator_max_to_searched_state->second->max_Q_value =
-                    state_Q_value_map_iterator->second;
+                state_record.max_Q_value = state_record.Q_values[i];
+                state_record.max_Q_action = (Q_action_index) i;
+                max_found = 1;
             }
         }
     }
@@ -192,42 +652,438 @@ void controller_storage::Q_maps::check_and_update_max_Q(
 
 
 void controller_storage::Q_maps::update_Q_value_for(
-        const std::string & state_name,
-        const std::string & action_name,
+        const Q_state_key state_key,
+        const Q_action_index action_index,
         const float t_Q_value)
 {
-    // first character and second characters are the keys
-    // 0 is a sign character
-    std::map<std::string, float> & state_Q_value_map =
-        get_map_for(state_name.at(1), state_name.at(2));
-    const std::string map_key = state_name + '|' + action_name;
+    const mutex_guard lock(get_lock_for(state_key));
+
+    set_Q_value(state_key, action_index, t_Q_value);
+}
+
+
+float controller_storage::Q_maps::update_Q_value_towards(
+        const Q_state_key state_key,
+        const Q_action_index action_index,
+        const float target,
+        const float learning_rate)
+{
+    const mutex_guard lock(get_lock_for(state_key));
+
+    const float Q_value = find_Q_value(state_key, action_index);
+
+    const float updated_Q_value =
+        ((1 - learning_rate) * Q_value) + (learning_rate * target);
+
+    set_Q_value(state_key, action_index, updated_Q_value);
+
+    return target - Q_value;
+}
+
+
+void controller_storage::Q_maps::add_to_Q_values(
+        const Q_state_key * state_keys,
+        const Q_action_index * action_indices,
+        const float * increments,
+        const int count)
+{
+    for(int i = 0; i < count; i++)
+    {
+        const mutex_guard lock(get_lock_for(state_keys[i]));
+
+        set_Q_value(state_keys[i], action_indices[i],
+                find_Q_value(state_keys[i], action_indices[i]) + increments[i]);
+    }
+}
+
+
+void controller_storage::Q_maps::set_Q_value(
+        const Q_state_key state_key,
+        const Q_action_index action_index,
+        const float t_Q_value)
+{
+    // remember the state for journal ( its shard is locked by the caller )
+    if(m_is_recording_updates)
+    {
+        m_updated_states[get_shard_for(speed_x_dimension::magnitude(state_key))]
+            .insert(state_key);
+    }
+
+    // dense table has a row for this state
+    if(m_dense_table != NULL)
+    {
+        const long slot = m_dense_table->get_slot_for(state_key);
+        if(slot >= 0)
+        {
+            // max Q value of dense table is found when it is needed
+            m_dense_table->set_Q_value(slot, action_index, t_Q_value);
+            return;
+        }
+    }
+
+    // magnitude of speed_x selects the map
+    state_Q_record_map & state_Q_value_map =
+        get_map_for(speed_x_dimension::magnitude(state_key));
+
+    state_Q_record_map::iterator
+        iterator_to_searched_key = state_Q_value_map.lower_bound(state_key);
+
+    Q_state_record * state_record = NULL;
+    if(iterator_to_searched_key != state_Q_value_map.end() &&
+            iterator_to_searched_key->first == state_key)
+    {
+        state_record = &(iterator_to_searched_key->second);
+    }
+    else
+    {
+        Q_file_record * mapped_record = find_mapped_record(state_key);
+
+        if(mapped_record != NULL && m_mapped_file_writable)
+        {
+            // update record of a writable mapped file in place
+            state_record = &(mapped_record->state_record);
+        }
+        else
+        {
+            // adds a zero initialized record (or a copy of read-only or
+            // quantized mapped record) if this state is not there in the map
+            Q_state_record new_record = Q_state_record();
+            get_mapped_record(state_key, new_record);
+            state_record = &(state_Q_value_map.insert(iterator_to_searched_key,
+                        std::make_pair(state_key, new_record))->second);
+        }
+    }
+
+    // update Q value and mark this action as tried
+    state_record->Q_values[action_index] = t_Q_value;
+    state_record->tried_actions |= (1u << action_index);
+
+    // check and update max Q value and action for this state
+    check_and_update_max_Q(*state_record, action_index, t_Q_value);
+}
+
+
+void controller_storage::Q_maps::get_all_Q_value_maps(
+        std::vector<state_Q_record_map * > & map_list) const
+{
+    map_list.clear();
+
+    // push each velocity map pointer to the vector
+    for(int i = 0; i < Q_MAP_ARRAY_ROWS; i++)
+    {
+        for(int j = 0; j < Q_MAP_ARRAY_COLUMNS; j++)
+        {
+            map_list.push_back(velocity_Q_map_pointers[i][j]);
+        }
+    }
+
+    // push default map pointer to the vector
+    map_list.push_back(default_velocity_Q_map_pointer);
+}
+
+
+void controller_storage::Q_maps::get_shard_records(const int shard,
+        std::vector<Q_file_record> & records) const
+{
+    records.clear();
+
+    std::vector<state_Q_record_map *> map_pointer_list;
+    get_all_Q_value_maps(map_pointer_list);
+    const state_Q_record_map & state_Q_value_map = *(map_pointer_list[shard]);
+
+    Q_file_record file_record;
+
+    // merge records of sparse map and of mapped file (both are sorted by key)
+    // record in sparse map is used if a state is in both
+    state_Q_record_map::const_iterator map_iterator = state_Q_value_map.begin();
+    size_t mapped_index = 0;
+    const size_t mapped_count = m_mapped_shard_sizes[shard];
+    Q_file_record mapped_record;
+    if(mapped_count > 0)
+    {
+        get_mapped_file_record(shard, 0, mapped_record);
+    }
+
+    while(map_iterator != state_Q_value_map.end() || mapped_index != mapped_count)
+    {
+        if(mapped_index == mapped_count ||
+                (map_iterator != state_Q_value_map.end() &&
+                 map_iterator->first <= mapped_record.state_key))
+        {
+            if(mapped_index != mapped_count && map_iterator->first == mapped_record.state_key
+                    && ++mapped_index != mapped_count)
+            {
+                get_mapped_file_record(shard, mapped_index, mapped_record);
+            }
+
+            file_record.state_key = map_iterator->first;
+            file_record.state_record = map_iterator->second;
+            records.push_back(file_record);
+            ++map_iterator;
+        }
+        else
+        {
+            records.push_back(mapped_record);
+            if(++mapped_index != mapped_count)
+            {
+                get_mapped_file_record(shard, mapped_index, mapped_record);
+            }
+        }
+    }
+
+    if(m_dense_table == NULL)
+    {
+        return;
+    }
+
+    // add tried states of dense table whose speed_x falls in this shard
+    const size_t sparse_record_count = records.size();
+    const Q_dense_bounds & bounds = m_dense_table->get_bounds();
+    for(long speed_x_steps = bounds.min_steps[0];
+            speed_x_steps <= bounds.max_steps[0]; speed_x_steps++)
+    {
+        if(get_shard_for(speed_x_steps < 0 ? -speed_x_steps : speed_x_steps) != shard)
+        {
+            continue;
+        }
+
+        long first_slot;
+        const long slot_count = m_dense_table->get_slots_for_speed_x(speed_x_steps, first_slot);
+        for(long slot = first_slot; slot < first_slot + slot_count; slot++)
+        {
+            if(m_dense_table->get_tried_actions(slot) != 0)
+            {
+                file_record.state_key = m_dense_table->get_key_for(slot);
+                get_dense_record(*m_dense_table, slot, file_record.state_record);
+                records.push_back(file_record);
+            }
+        }
+    }
+
+    // dense table is in slot order, so records are sorted again
+    if(records.size() != sparse_record_count)
+    {
+        std::sort(records.begin(), records.end(), is_record_less);
+    }
+}
+
+
+void controller_storage::Q_maps::get_all_records(std::vector<Q_file_record> & records) const
+{
+    records.clear();
+
+    std::vector<Q_file_record> shard_records;
+    for(int shard = 0; shard < Q_MAP_SHARDS; shard++)
+    {
+        get_shard_records(shard, shard_records);
+        records.insert(records.end(), shard_records.begin(), shard_records.end());
+    }
+}
+
+
+void controller_storage::Q_maps::release_mapped_file(const int keep_records)
+{
+    if(m_mapped_file == NULL)
+    {
+        return;
+    }
+
+    if(keep_records)
+    {
+        std::vector<state_Q_record_map *> map_pointer_list;
+        get_all_Q_value_maps(map_pointer_list);
+
+        Q_file_record file_record;
+        for(int shard = 0; shard < Q_MAP_SHARDS; shard++)
+        {
+            // insert does not replace records that are already in the map
+            for(size_t i = 0; i < m_mapped_shard_sizes[shard]; i++)
+            {
+                get_mapped_file_record(shard, i, file_record);
+                map_pointer_list[shard]->insert(map_pointer_list[shard]->end(),
+                        std::make_pair(file_record.state_key, file_record.state_record));
+            }
+        }
+    }
+
+    munmap(m_mapped_file, m_mapped_file_size);
+
+    m_mapped_file = NULL;
+    m_mapped_file_size = 0;
+    m_mapped_file_writable = 0;
+    for(int i = 0; i < Q_MAP_SHARDS; i++)
+    {
+        m_mapped_shards[i] = NULL;
+        m_quantized_shards[i] = NULL;
+        m_mapped_shard_sizes[i] = 0;
+    }
+}
+
+
+void controller_storage::Q_maps::add_records(const int shard,
+        const std::vector<Q_file_record> & records)
+{
+    std::vector<state_Q_record_map *> map_pointer_list;
+    get_all_Q_value_maps(map_pointer_list);
+    state_Q_record_map & state_Q_value_map = *(map_pointer_list[shard]);
+
+    if(m_dense_table == NULL && state_Q_value_map.empty() &&
+            m_mapped_shard_sizes[shard] == 0)
+    {
+        // records are sorted, so each one is inserted at the end of the map
+        for(size_t i = 0; i < records.size(); i++)
+        {
+            state_Q_value_map.insert(state_Q_value_map.end(),
+                    std::make_pair(records[i].state_key, records[i].state_record));
+        }
+        return;
+    }
+
+    // records are merged with the ones that are already there
+    for(size_t i = 0; i < records.size(); i++)
+    {
+        for(int action = 0; action < Q_ACTION_SPACE_SIZE; action++)
+        {
+            if(records[i].state_record.tried_actions & (1u << action))
+            {
+                update_Q_value_for(records[i].state_key, (Q_action_index) action,
+                        records[i].state_record.Q_values[action]);
+            }
+        }
+    }
+}
+
+
+int controller_storage::Q_maps::use_dense_table(const Q_dense_bounds & t_bounds)
+{
+    Q_dense_table * new_dense_table = new Q_dense_table(t_bounds);
+    if(!new_dense_table->is_allocated())
+    {
+        delete new_dense_table;
+        puts("not using dense Q table");
+        return -1;
+    }
+
+    // records are only moved, so they are not updates for journal
+    const int was_recording_updates = m_is_recording_updates;
+    m_is_recording_updates = 0;
+
+    // records of mapped file are moved to sparse maps first
+    // (and from there the ones within bounds are moved to dense table)
+    release_mapped_file(1);
+
+    // previous dense table is replaced, so its records are moved either
+    // to new dense table or to sparse maps
+    Q_dense_table * old_dense_table = m_dense_table;
+    m_dense_table = new_dense_table;
+
+    if(old_dense_table != NULL)
+    {
+        for(long slot = 0; slot < old_dense_table->get_number_of_slots(); slot++)
+        {
+            const unsigned int tried_actions = old_dense_table->get_tried_actions(slot);
+            for(int i = 0; i < Q_ACTION_SPACE_SIZE; i++)
+            {
+                if(tried_actions & (1u << i))
+                {
+                    update_Q_value_for(old_dense_table->get_key_for(slot), (Q_action_index) i,
+                            old_dense_table->get_Q_values(slot)[i]);
+                }
+            }
+        }
+
+        delete old_dense_table;
+    }
+
+    // move records of sparse maps that are within the bounds
+    std::vector<state_Q_record_map *> map_pointer_list;
+    get_all_Q_value_maps(map_pointer_list);
+
+    long long int moved_states = 0;
+    for(std::vector<state_Q_record_map *>::iterator
+            map_list_iterator = map_pointer_list.begin();
+            map_list_iterator != map_pointer_list.end();
+            ++map_list_iterator)
+    {
+        state_Q_record_map::iterator map_iterator = (*map_list_iterator)->begin();
+        while(map_iterator != (*map_list_iterator)->end())
+        {
+            const long slot = m_dense_table->get_slot_for(map_iterator->first);
+            if(slot < 0)
+            {
+                ++map_iterator;
+                continue;
+            }
+
+            for(int i = 0; i < Q_ACTION_SPACE_SIZE; i++)
+            {
+                if(map_iterator->second.tried_actions & (1u << i))
+                {
+                    m_dense_table->set_Q_value(slot, (Q_action_index) i,
+                            map_iterator->second.Q_values[i]);
+                }
+            }
+
+            (*map_list_iterator)->erase(map_iterator++);
+            moved_states++;
+        }
+    }
 
-    // update Q value
-    // adds this key if not there in the map
-    state_Q_value_map[map_key] = t_Q_value;
+    m_is_recording_updates = was_recording_updates;
 
-    // check and update max Q value and action for this state
-    check_and_update_max_Q(state_name, action_name,
-            t_Q_value, state_Q_value_map);
+    printf("using dense Q table of %ld states (%lld states moved from sparse maps)\n",
+            m_dense_table->get_number_of_slots(), moved_states);
+    get_memory_footprint(1);
+
+    return 0;
 }
 
 
-void controller_storage::Q_maps::get_all_Q_value_maps(
-        std::vector<state_action_Q_map * > & map_list) const
+size_t controller_storage::Q_maps::get_memory_footprint(const int print_info) const
 {
-    map_list.clear();
+    // approximate size of a node in sparse map i.e. a red-black tree node
+    // (3 pointers, color) followed by the key and the record
+    const size_t map_node_size = 4 * sizeof(void *) +
+        sizeof(std::pair<const Q_state_key, Q_state_record>);
+
+    std::vector<state_Q_record_map *> map_pointer_list;
+    get_all_Q_value_maps(map_pointer_list);
+
+    size_t sparse_states = 0;
+    for(std::vector<state_Q_record_map *>::const_iterator
+            map_list_iterator = map_pointer_list.begin();
+            map_list_iterator != map_pointer_list.end();
+            ++map_list_iterator)
+    {
+        sparse_states += (*map_list_iterator)->size();
+    }
 
-    // push each velocity map pointer to the vector
-    for(int i = 0; i < Q_MAP_ARRAY_ROWS; i++)
+    const size_t sparse_bytes = sparse_states * map_node_size;
+    const size_t dense_bytes =
+        (m_dense_table == NULL) ? 0 : m_dense_table->get_memory_footprint();
+    // pages of mapped file are shared with page cache until they are written
+    const size_t mapped_bytes = m_mapped_file_size;
+
+    if(print_info)
     {
-        for(int j = 0; j < Q_MAP_ARRAY_COLUMNS; j++)
+        if(m_dense_table != NULL)
         {
-            map_list.push_back(velocity_Q_map_pointers[i][j]);
+            printf("dense Q table - %ld states, %.1f MB\n",
+                    m_dense_table->get_number_of_slots(), dense_bytes / 1048576.0);
+        }
+
+        if(m_mapped_file != NULL)
+        {
+            printf("mapped Q file - %.1f MB (%s%s)\n", mapped_bytes / 1048576.0,
+                    m_mapped_file_writable ? "copy-on-write" : "read-only",
+                    (m_quantized_shards[0] != NULL) ? ", quantized" : "");
         }
+
+        printf("sparse Q maps - %lu states, %.1f MB (approx.)\n",
+                sparse_states, sparse_bytes / 1048576.0);
     }
 
-    // push default map pointer to the vector
-    map_list.push_back(default_velocity_Q_map_pointer);
+    return dense_bytes + mapped_bytes + sparse_bytes;
 }
 
 
@@ -235,15 +1091,59 @@ long long int controller_storage::Q_maps::get_total_size(
         const int print_info) const
 {
     long long int total_size = 0;
-    for(int i = 0; i < Q_MAP_ARRAY_ROWS; i++)
+    long long int total_states = 0;
+
+    // get list of all the maps available
+    std::vector<state_Q_record_map *> map_pointer_list;
+    get_all_Q_value_maps(map_pointer_list);
+
+    // count tried actions in each record of each map
+    for(std::vector<state_Q_record_map *>::const_iterator
+            map_list_iterator = map_pointer_list.begin();
+            map_list_iterator != map_pointer_list.end();
+            ++map_list_iterator)
     {
-        for(int j = 0; j < Q_MAP_ARRAY_COLUMNS; j++)
+        for(state_Q_record_map::const_iterator
+                map_iterator = (*map_list_iterator)->begin();
+                map_iterator != (*map_list_iterator)->end();
+                ++map_iterator)
+        {
+            total_size += __builtin_popcount(map_iterator->second.tried_actions);
+        }
+
+        total_states += (*map_list_iterator)->size();
+    }
+
+    // count tried actions in each record of mapped file
+    // (except the records that are also in sparse maps)
+    for(int shard = 0; m_mapped_file != NULL && shard < Q_MAP_SHARDS; shard++)
+    {
+        const state_Q_record_map & state_Q_value_map = *(map_pointer_list[shard]);
+        Q_file_record mapped_record;
+        for(size_t i = 0; i < m_mapped_shard_sizes[shard]; i++)
         {
-            total_size += (velocity_Q_map_pointers[i][j])->size();
+            get_mapped_file_record(shard, i, mapped_record);
+            if(state_Q_value_map.find(mapped_record.state_key) == state_Q_value_map.end())
+            {
+                total_size += __builtin_popcount(mapped_record.state_record.tried_actions);
+                total_states++;
+            }
         }
     }
 
-    total_size += default_velocity_Q_map_pointer->size();
+    // count tried actions in each slot of dense table
+    if(m_dense_table != NULL)
+    {
+        for(long slot = 0; slot < m_dense_table->get_number_of_slots(); slot++)
+        {
+            const unsigned int tried_actions = m_dense_table->get_tried_actions(slot);
+            if(tried_actions != 0)
+            {
+                total_size += __builtin_popcount(tried_actions);
+                total_states++;
+            }
+        }
+    }
 
     // for displaying sizes of different maps
     if(print_info)
@@ -252,16 +1152,16 @@ long long int controller_storage::Q_maps::get_total_size(
         {
             for(int j = 0; j < Q_MAP_ARRAY_COLUMNS; j++)
             {
-                printf("state_Q_value_map %d%d size - %lu\n", i, j,
+                printf("state_Q_record_map %d%d states - %lu\n", i, j,
                         (velocity_Q_map_pointers[i][j])->size());
             }
         }
 
-        printf("default state_Q_value_map size - %lu\n",
+        printf("default state_Q_record_map states - %lu\n",
                 default_velocity_Q_map_pointer->size());
 
-        printf("max Q action map size - %lu\n",
-                max_Q_and_action_map_pointer->size());
+        printf("total states - %lld, total state-action pairs - %lld\n",
+                total_states, total_size);
     }
 
     return total_size;
@@ -284,55 +1184,53 @@ long long int controller_storage::Q_maps::load_maps_from_file(
     if(t_Q_value_file == NULL)
     {
         printf("error reading file \"%s\"\n", t_Q_value_file_name.c_str());
-        return 0;
+
+        // races before the file was written for the first time
+        // may still be in its journal
+        replay_journal(t_Q_value_file_name);
+        clear_updated_states();
+        return m_training_counter;
     }
     else
     {
-        printf("reading map from file \"%s\"\n", t_Q_value_file_name.c_str());
-        char * line = NULL;
-
-        int line_count = 0;
-        int line_character_count = 0;
-        size_t len = 0;
-        while((line_character_count = getline(&line, &len, t_Q_value_file)) != -1
-                && line[0] != 's')               // Q values ends with "stat" line
+        // check for magic characters of a binary Q value file
+        char magic[sizeof(((Q_binary_header *) NULL)->magic)];
+        if(fread(magic, 1, sizeof(magic), t_Q_value_file) == sizeof(magic) &&
+                memcmp(magic, Q_BINARY_MAGIC, sizeof(magic)) == 0)
         {
-            // break line into state, action and Q value
-            char state_name[STATE_NAME_LENGTH + 1];
-            char action_name[ACTION_NAME_LENGTH + 1];
-            float t_Q_value_float;
-
-            // scan line as fixed length map key (state and action) and Q value
-            sscanf(line, MAP_READ_FORMAT, state_name, action_name, &t_Q_value_float);
+            fclose(t_Q_value_file);
+            return load_maps_from_binary_file(t_Q_value_file_name);
+        }
+        fclose(t_Q_value_file);
 
-            // append null character to char arrays
-            state_name[STATE_NAME_LENGTH] = '\0';
-            action_name[ACTION_NAME_LENGTH] = '\0';
+        printf("reading map from file \"%s\"\n", t_Q_value_file_name.c_str());
 
-            update_Q_value_for(state_name, action_name, t_Q_value_float);
+        Q_text_contents contents;
+        if(read_Q_text_file(t_Q_value_file_name.c_str(), contents) != 0)
+        {
+            printf("error reading file \"%s\"\n", t_Q_value_file_name.c_str());
+            return replay_journal_of_invalid_file(t_Q_value_file_name);
+        }
 
-            line_count++;
+        // records of each shard are added at once
+        for(int shard = 0; shard < Q_MAP_SHARDS; shard++)
+        {
+            add_records(shard, contents.shard_records[shard]);
+            std::vector<Q_file_record>().swap(contents.shard_records[shard]);
         }
 
-        // check for a line containing "stats" followed by
-        // a line with training counter
-        if((line[0] == 's') && (line[1] == 't') &&
-                (line[2] == 'a') && (line[3] == 't') && (line[4] == 's'))
+        // training counter from "stats" line
+        if(contents.has_stats)
         {
-            if( (line_character_count = getline(&line, &len, t_Q_value_file)) != -1 )
-            {
-                sscanf(line, "%lld", &m_training_counter);
-            }
-            else
-            {
-                puts("error reading stats training counter line");
-            }
+            m_training_counter = contents.training_counter;
         }
 
         // set member Q value file_name to given file name
         m_Q_value_file_name = t_Q_value_file_name;
 
-        fclose(t_Q_value_file);
+        // updates made after the file was written
+        replay_journal(t_Q_value_file_name);
+        clear_updated_states();
 
         puts("Q value File loaded successfully");
         return m_training_counter;
@@ -344,68 +1242,570 @@ int controller_storage::Q_maps::write_maps_to_file(
         const std::string & t_Q_value_file_name,
         const long long int race_counter)
 {
-    int close_value = -1;
+    return write_maps(t_Q_value_file_name, race_counter, 0);
+}
+
+
+long long int controller_storage::Q_maps::load_maps_from_binary_file(
+        const std::string & t_Q_value_file_name)
+{
+    printf("loading Q_maps-%s from binary file\n", Q_MAPS_VERSION);
     if(t_Q_value_file_name.empty())
     {
-        puts("empty file name, not writing Q values");
-        return close_value;
+        puts("empty file name, not loading Q values");
+        return 0;
     }
 
-    FILE * t_Q_value_file = fopen(t_Q_value_file_name.c_str(), "w");
-    if(t_Q_value_file == NULL)
+    int file_descriptor = open(t_Q_value_file_name.c_str(), O_RDONLY);
+    struct stat file_stat;
+    if(file_descriptor < 0 || fstat(file_descriptor, &file_stat) != 0)
     {
-        printf("couldn't open file \'%s\' for writing the map.\n",
+        printf("error reading file \"%s\"\n", t_Q_value_file_name.c_str());
+        if(file_descriptor >= 0)
+        {
+            close(file_descriptor);
+            return replay_journal_of_invalid_file(t_Q_value_file_name);
+        }
+
+        // races before the file was written for the first time
+        // may still be in its journal
+        replay_journal(t_Q_value_file_name);
+        clear_updated_states();
+        return m_training_counter;
+    }
+
+    const size_t file_size = (size_t) file_stat.st_size;
+    if(file_size < offsetof(Q_binary_header, value_encoding))
+    {
+        printf("file \"%s\" is too small for a binary Q value file\n",
                 t_Q_value_file_name.c_str());
+        close(file_descriptor);
+        return replay_journal_of_invalid_file(t_Q_value_file_name);
+    }
+
+    // in training, records are updated in private (copy-on-write) pages
+#ifdef TRAINING_MODE
+    const int writable = 1;
+#else
+    const int writable = 0;
+#endif
+
+    void * file_memory = mmap(NULL, file_size,
+            writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+            writable ? MAP_PRIVATE : MAP_SHARED,
+            file_descriptor, 0);
+    close(file_descriptor);
+
+    if(file_memory == MAP_FAILED)
+    {
+        printf("error mapping file \"%s\"\n", t_Q_value_file_name.c_str());
+        return replay_journal_of_invalid_file(t_Q_value_file_name);
+    }
+
+    // check header of the file ( a version 1 header has no value encoding )
+    const Q_binary_header & header = *((const Q_binary_header *) file_memory);
+    int is_valid = memcmp(header.magic, Q_BINARY_MAGIC, sizeof(header.magic)) == 0
+        && header.format_version >= Q_BINARY_MIN_FORMAT_VERSION
+        && header.format_version <= Q_BINARY_FORMAT_VERSION
+        && header.byte_order_mark == Q_BINARY_BYTE_ORDER_MARK
+        && header.header_size == ((header.format_version == 1)
+                ? offsetof(Q_binary_header, value_encoding) : sizeof(Q_binary_header))
+        && header.header_size <= file_size;
+
+    const int value_encoding = (!is_valid || header.format_version == 1)
+        ? Q_VALUES_FLOAT32 : header.value_encoding;
+    const size_t record_size = (value_encoding == Q_VALUES_INT16)
+        ? sizeof(Q_quantized_record) : sizeof(Q_file_record);
+
+    is_valid = is_valid
+        && (value_encoding == Q_VALUES_FLOAT32 || value_encoding == Q_VALUES_INT16)
+        && header.record_size == record_size
+        && header.shard_offsets[0] == 0
+        && header.shard_offsets[Q_MAP_SHARDS] == header.record_count
+        && header.record_count == (file_size - header.header_size) / record_size
+        && (file_size - header.header_size) % record_size == 0;
+
+    for(int i = 0; is_valid && i < Q_MAP_SHARDS; i++)
+    {
+        is_valid = header.shard_offsets[i] <= header.shard_offsets[i + 1];
+    }
+
+    if(!is_valid)
+    {
+        printf("file \"%s\" is not a valid binary Q value file (format v%d to v%d)\n",
+                t_Q_value_file_name.c_str(), Q_BINARY_MIN_FORMAT_VERSION,
+                Q_BINARY_FORMAT_VERSION);
+        munmap(file_memory, file_size);
+        return replay_journal_of_invalid_file(t_Q_value_file_name);
+    }
+
+    check_id("QLearner id", header.Q_learner_id, m_Q_learner_id);
+    check_id("reward id", header.reward_id, m_reward_id);
+    check_id("fuzzy controller version", header.fuzzy_controller_version,
+            m_fuzzy_controller_version);
+
+    // records are either float or quantized records
+    void * records = (char *) file_memory + header.header_size;
+    Q_file_record * file_records =
+        (value_encoding == Q_VALUES_FLOAT32) ? (Q_file_record *) records : NULL;
+    Q_quantized_record * quantized_records =
+        (value_encoding == Q_VALUES_INT16) ? (Q_quantized_record *) records : NULL;
+    const unsigned long long int record_count = header.record_count;
+    m_training_counter = header.training_counter;
+
+    if(m_dense_table != NULL)
+    {
+        // records are copied to dense table and sparse maps
+        Q_file_record file_record;
+        for(unsigned long long int i = 0; i < record_count; i++)
+        {
+            if(quantized_records != NULL)
+            {
+                file_record.state_key = quantized_records[i].state_key;
+                dequantize_Q_record(quantized_records[i], file_record.state_record);
+            }
+            else
+            {
+                file_record = file_records[i];
+            }
+
+            const Q_state_record & state_record = file_record.state_record;
+            for(int j = 0; j < Q_ACTION_SPACE_SIZE; j++)
+            {
+                if(state_record.tried_actions & (1u << j))
+                {
+                    update_Q_value_for(file_record.state_key, (Q_action_index) j,
+                            state_record.Q_values[j]);
+                }
+            }
+        }
+
+        munmap(file_memory, file_size);
     }
     else
     {
-        printf("writing map to file \'%s\'\n", t_Q_value_file_name.c_str());
+        // records of previously mapped file are kept unless it is the same
+        // file loaded again ( its records are replaced by the file's records )
+        release_mapped_file(m_Q_value_file_name != t_Q_value_file_name);
+
+        // quantized records are not updated in place ( updated states
+        // are copied to sparse maps as float records )
+        m_mapped_file = file_memory;
+        m_mapped_file_size = file_size;
+        m_mapped_file_writable = writable && (file_records != NULL);
+        for(int i = 0; i < Q_MAP_SHARDS; i++)
+        {
+            m_mapped_shards[i] =
+                (file_records == NULL) ? NULL : file_records + header.shard_offsets[i];
+            m_quantized_shards[i] =
+                (quantized_records == NULL) ? NULL : quantized_records + header.shard_offsets[i];
+            m_mapped_shard_sizes[i] = header.shard_offsets[i + 1] - header.shard_offsets[i];
+        }
 
-        // get list of all the maps available
-        std::vector<controller_storage::state_action_Q_map *> map_pointer_list;
+        // records of the file replace records of the same states in sparse maps
+        std::vector<state_Q_record_map *> map_pointer_list;
         get_all_Q_value_maps(map_pointer_list);
-
-        // iterate over list of maps
-        for(std::vector<controller_storage::state_action_Q_map *>::iterator
+        for(std::vector<state_Q_record_map *>::iterator
                 map_list_iterator = map_pointer_list.begin();
                 map_list_iterator != map_pointer_list.end();
                 ++map_list_iterator)
         {
-            // iterate over each map
-            for(controller_storage::state_action_Q_map::iterator
-                    map_iterator = (*(map_list_iterator))->begin();
-                    map_iterator != (*(map_list_iterator))->end();
-                    ++map_iterator)
+            state_Q_record_map::iterator map_iterator = (*map_list_iterator)->begin();
+            while(map_iterator != (*map_list_iterator)->end())
             {
-                fprintf(t_Q_value_file, MAP_WRITE_FORMAT,
-                        map_iterator->first.c_str(), map_iterator->second);
+                if(find_mapped_record(map_iterator->first) != NULL ||
+                        find_quantized_record(map_iterator->first) != NULL)
+                {
+                    (*map_list_iterator)->erase(map_iterator++);
+                }
+                else
+                {
+                    ++map_iterator;
+                }
             }
         }
+    }
+
+    printf("loaded %llu states from file \"%s\"%s\n",
+            record_count, t_Q_value_file_name.c_str(),
+            (quantized_records != NULL) ? " (quantized Q values)" : "");
+
+    // set member Q value file_name to given file name
+    m_Q_value_file_name = t_Q_value_file_name;
+    if(m_invalid_file_name == t_Q_value_file_name)
+    {
+        m_invalid_file_name.clear();
+    }
+
+    // updates made after the file was written
+    replay_journal(t_Q_value_file_name);
+    clear_updated_states();
+
+    puts("Q value File loaded successfully");
+    return m_training_counter;
+}
+
+
+long long int controller_storage::Q_maps::replay_journal_of_invalid_file(
+        const std::string & t_Q_value_file_name)
+{
+    printf("Q values of file \"%s\" are not loaded, and the file is not written"
+            " over until it is moved aside ( replaying its journal )\n",
+            t_Q_value_file_name.c_str());
+    m_invalid_file_name = t_Q_value_file_name;
+
+    replay_journal(t_Q_value_file_name);
+    clear_updated_states();
+    return m_training_counter;
+}
+
+
+int controller_storage::Q_maps::is_invalid_file(const std::string & t_Q_value_file_name) const
+{
+    if(m_invalid_file_name.empty() || m_invalid_file_name != t_Q_value_file_name ||
+            access(t_Q_value_file_name.c_str(), F_OK) != 0)
+    {
+        return 0;
+    }
+
+    printf("error : file \"%s\" could not be loaded, not writing Q values over it"
+            " ( they are kept in its journal )\n", t_Q_value_file_name.c_str());
+    return 1;
+}
+
+
+int controller_storage::Q_maps::write_maps_to_binary_file(
+        const std::string & t_Q_value_file_name,
+        const long long int race_counter)
+{
+    return write_maps(t_Q_value_file_name, race_counter, 1);
+}
+
+
+int controller_storage::Q_maps::write_maps(
+        const std::string & t_Q_value_file_name,
+        const long long int race_counter, const int binary_file)
+{
+    if(t_Q_value_file_name.empty())
+    {
+        puts("empty file name, not writing Q values");
+        return -1;
+    }
+
+    if(is_invalid_file(t_Q_value_file_name))
+    {
+        return -1;
+    }
+
+    // a file being written in background may be the same file
+    wait_for_background_write();
+
+    Q_maps_snapshot snapshot;
+    take_snapshot(snapshot, t_Q_value_file_name, race_counter, binary_file);
+
+    const int close_value = write_snapshot(snapshot);
+    if(close_value == 0)
+    {
+        // journals are not needed as all the updates are in the file
+        const std::string journal_file_name = t_Q_value_file_name + Q_JOURNAL_FILE_SUFFIX;
+        remove(journal_file_name.c_str());
+        remove((journal_file_name + Q_JOURNAL_CHECKPOINT_SUFFIX).c_str());
+        clear_updated_states();
+    }
+
+    return close_value;
+}
+
+
+void controller_storage::Q_maps::take_snapshot(Q_maps_snapshot & snapshot,
+        const std::string & t_Q_value_file_name,
+        const long long int race_counter, const int binary_file)
+{
+    struct timespec start_time;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+    if(race_counter > 0)
+    {
+        // resetting training counter
+        m_training_counter = race_counter;
+    }
+
+    snapshot.training_counter = race_counter;
+    snapshot.Q_learner_id = m_Q_learner_id;
+    snapshot.reward_id = m_reward_id;
+    snapshot.fuzzy_controller_version = m_fuzzy_controller_version;
+    snapshot.file_name = t_Q_value_file_name;
+    snapshot.binary_file = binary_file;
+    snapshot.value_encoding = m_binary_value_encoding;
+    snapshot.write_result = -1;
+
+    size_t total_states = 0;
+    for(int shard = 0; shard < Q_MAP_SHARDS; shard++)
+    {
+        get_shard_records(shard, snapshot.shard_records[shard]);
+        total_states += snapshot.shard_records[shard].size();
+    }
+
+    struct timespec end_time;
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    printf("snapshot of %lu states taken in %.1f ms\n", total_states,
+            (end_time.tv_sec - start_time.tv_sec) * 1e3
+            + (end_time.tv_nsec - start_time.tv_nsec) / 1e6);
+}
+
+
+int controller_storage::Q_maps::start_background_write(
+        const std::string & t_Q_value_file_name,
+        const long long int race_counter, const int binary_file)
+{
+    if(t_Q_value_file_name.empty())
+    {
+        puts("empty file name, not writing Q values");
+        return -1;
+    }
+
+    if(is_invalid_file(t_Q_value_file_name))
+    {
+        return -1;
+    }
+
+    // only one file is written in background at a time
+    wait_for_background_write();
+
+    Q_maps_snapshot * snapshot = new Q_maps_snapshot;
+    take_snapshot(*snapshot, t_Q_value_file_name, race_counter, binary_file);
+
+    // journal blocks written so far are in the snapshot. They are moved aside
+    // and removed when the file is written, while blocks of next races go to
+    // a new journal. If a checkpoint journal is still there ( previous write
+    // failed ), blocks are left in the journal ( replay skips old blocks ).
+    const std::string journal_file_name = t_Q_value_file_name + Q_JOURNAL_FILE_SUFFIX;
+    const std::string checkpoint_journal_file_name =
+        journal_file_name + Q_JOURNAL_CHECKPOINT_SUFFIX;
+    if(access(checkpoint_journal_file_name.c_str(), F_OK) != 0)
+    {
+        rename(journal_file_name.c_str(), checkpoint_journal_file_name.c_str());
+    }
+
+    if(pthread_create(&m_writer_thread, NULL, run_background_write, snapshot) != 0)
+    {
+        puts("couldn't start background writer, writing Q values now");
+        run_background_write(snapshot);
+
+        const int write_result = snapshot->write_result;
+        delete snapshot;
+        return write_result;
+    }
+
+    m_writer_snapshot = snapshot;
+    return 0;
+}
+
+
+int controller_storage::Q_maps::wait_for_background_write()
+{
+    if(m_writer_snapshot == NULL)
+    {
+        return 0;
+    }
+
+    pthread_join(m_writer_thread, NULL);
+
+    const int write_result = m_writer_snapshot->write_result;
+    delete m_writer_snapshot;
+    m_writer_snapshot = NULL;
+
+    return write_result;
+}
+
+
+int controller_storage::Q_maps::append_to_journal(
+        const std::string & t_Q_value_file_name,
+        const long long int race_counter)
+{
+    if(t_Q_value_file_name.empty())
+    {
+        puts("empty file name, not writing journal");
+        return -1;
+    }
+
+    // final record of each updated state ( states are sorted in each shard )
+    std::vector<Q_state_key> updated_states;
+    for(int shard = 0; shard < Q_MAP_SHARDS; shard++)
+    {
+        const mutex_guard lock(m_shard_locks[shard]);
+        updated_states.insert(updated_states.end(),
+                m_updated_states[shard].begin(), m_updated_states[shard].end());
+    }
+
+    std::vector<Q_file_record> journal_records(updated_states.size());
+    for(size_t i = 0; i < updated_states.size(); i++)
+    {
+        journal_records[i].state_key = updated_states[i];
+        get_record_for(updated_states[i], journal_records[i].state_record);
+    }
+
+    Q_journal_block_header block_header;
+    memset(&block_header, 0, sizeof(block_header));
+    memcpy(block_header.magic, Q_JOURNAL_MAGIC, sizeof(block_header.magic));
+    block_header.format_version = Q_JOURNAL_FORMAT_VERSION;
+    block_header.record_size = sizeof(Q_file_record);
+    block_header.training_counter = race_counter;
+    block_header.record_count = journal_records.size();
+    block_header.checksum = journal_records.empty() ? get_checksum(NULL, 0) :
+        get_checksum(&journal_records[0], journal_records.size() * sizeof(Q_file_record));
+
+    const std::string journal_file_name = t_Q_value_file_name + Q_JOURNAL_FILE_SUFFIX;
+    FILE * journal_file = fopen(journal_file_name.c_str(), "ab");
+    if(journal_file == NULL)
+    {
+        printf("couldn't open journal \'%s\'\n", journal_file_name.c_str());
+        return -1;
+    }
+
+    int write_error = fwrite(&block_header, sizeof(block_header), 1, journal_file) != 1;
+    if(!write_error && !journal_records.empty())
+    {
+        write_error = fwrite(&journal_records[0], sizeof(Q_file_record),
+                journal_records.size(), journal_file) != journal_records.size();
+    }
+
+    // block should be on disk before next race starts
+    write_error = write_error || fflush(journal_file) != 0
+        || fsync(fileno(journal_file)) != 0;
+    write_error = (fclose(journal_file) == EOF) || write_error;
+
+    if(write_error)
+    {
+        printf("error writing journal \'%s\'\n", journal_file_name.c_str());
+        return -1;
+    }
+
+    clear_updated_states();
+    return 0;
+}
+
+
+void controller_storage::Q_maps::clear_updated_states()
+{
+    for(int shard = 0; shard < Q_MAP_SHARDS; shard++)
+    {
+        const mutex_guard lock(m_shard_locks[shard]);
+        m_updated_states[shard].clear();
+    }
+}
+
+
+long long int controller_storage::Q_maps::replay_journal(
+        const std::string & t_Q_value_file_name)
+{
+    // replayed records are already in journal
+    const int was_recording_updates = m_is_recording_updates;
+    m_is_recording_updates = 0;
+
+    // checkpoint journal ( if a background write did not finish ) has
+    // blocks that are older than the blocks of journal
+    const long long int file_training_counter = m_training_counter;
+    const std::string journal_file_name = t_Q_value_file_name + Q_JOURNAL_FILE_SUFFIX;
+    replay_journal_file(journal_file_name + Q_JOURNAL_CHECKPOINT_SUFFIX,
+            file_training_counter);
+    replay_journal_file(journal_file_name, file_training_counter);
+
+    m_is_recording_updates = was_recording_updates;
+
+    return m_training_counter;
+}
+
+
+void controller_storage::Q_maps::replay_journal_file(
+        const std::string & journal_file_name,
+        const long long int file_training_counter)
+{
+    FILE * journal_file = fopen(journal_file_name.c_str(), "r+b");
+    if(journal_file == NULL)
+    {
+        // no updates after the file was written
+        return;
+    }
+
+    long long int replayed_blocks = 0;
+    long long int replayed_states = 0;
+    long valid_journal_size = 0;
+
+    fseek(journal_file, 0, SEEK_END);
+    const long journal_size = ftell(journal_file);
+    rewind(journal_file);
+
+    Q_journal_block_header block_header;
+    std::vector<Q_file_record> journal_records;
+    while(fread(&block_header, sizeof(block_header), 1, journal_file) == 1)
+    {
+        if(memcmp(block_header.magic, Q_JOURNAL_MAGIC, sizeof(block_header.magic)) != 0
+                || block_header.format_version != Q_JOURNAL_FORMAT_VERSION
+                || block_header.record_size != sizeof(Q_file_record)
+                || block_header.record_count > (unsigned long long int)
+                    (journal_size - ftell(journal_file)) / sizeof(Q_file_record))
+        {
+            break;
+        }
 
-        if(race_counter > 0)
+        journal_records.resize(block_header.record_count);
+        if(!journal_records.empty() &&
+                fread(&journal_records[0], sizeof(Q_file_record),
+                    journal_records.size(), journal_file) != journal_records.size())
         {
-            // resetting training counter
-            m_training_counter = race_counter;
+            break;
         }
 
-        // save this counter in the file
-        fprintf(t_Q_value_file, "stats\n%lld\n", race_counter);
+        const unsigned long long int checksum = journal_records.empty()
+            ? get_checksum(NULL, 0)
+            : get_checksum(&journal_records[0], journal_records.size() * sizeof(Q_file_record));
+        if(checksum != block_header.checksum)
+        {
+            break;
+        }
 
-        // closing the file
-        close_value = fclose(t_Q_value_file);
+        valid_journal_size = ftell(journal_file);
 
-        if(close_value == EOF)
+        // block was written before the file, so its updates are in the file
+        if(block_header.training_counter <= file_training_counter)
         {
-            printf("error closing file \'%s\'\n", t_Q_value_file_name.c_str());
+            continue;
         }
-        else
+
+        for(size_t i = 0; i < journal_records.size(); i++)
+        {
+            const Q_state_record & state_record = journal_records[i].state_record;
+            for(int j = 0; j < Q_ACTION_SPACE_SIZE; j++)
+            {
+                if(state_record.tried_actions & (1u << j))
+                {
+                    update_Q_value_for(journal_records[i].state_key, (Q_action_index) j,
+                            state_record.Q_values[j]);
+                }
+            }
+        }
+
+        m_training_counter = block_header.training_counter;
+        replayed_blocks++;
+        replayed_states += journal_records.size();
+    }
+
+    // discard a partly written block at the end
+    if(journal_size != valid_journal_size)
+    {
+        printf("discarding %ld bytes of incomplete journal block in \'%s\'\n",
+                journal_size - valid_journal_size, journal_file_name.c_str());
+        if(ftruncate(fileno(journal_file), valid_journal_size) != 0)
         {
-            t_Q_value_file = NULL;
-            printf("file closed \'%s\'\n", t_Q_value_file_name.c_str());
+            printf("error truncating journal \'%s\'\n", journal_file_name.c_str());
         }
     }
 
-    return close_value;
+    fclose(journal_file);
+
+    printf("replayed %lld races (%lld state records) from journal \'%s\'\n",
+            replayed_blocks, replayed_states, journal_file_name.c_str());
 }
 
 
@@ -29,43 +29,70 @@
 #define  CAR222_Q_MAPS_H_
 
 
+#include <pthread.h>
 #include <string>
 #include <map>
+#include <set>
 #include <vector>
 
+#include "car222_Q_state_key.h"
+#include "car222_Q_dense_table.h"
+#include "car222_Q_binary_format.h"
+#include "car222_Q_visit_counts.h"
+
 
 // version of Q_maps
-#define Q_MAPS_VERSION "v1.0.0"
+#define Q_MAPS_VERSION "v1.5.0"
 
 // number of rows in Q map array
 #define Q_MAP_ARRAY_ROWS 6
 // number of column in Q map array
 #define Q_MAP_ARRAY_COLUMNS 10
+// number of Q maps ( velocity maps and the default map )
+#define Q_MAP_SHARDS (Q_MAP_ARRAY_ROWS * Q_MAP_ARRAY_COLUMNS + 1)
 
 
 namespace controller_storage
 {
 
     /**
-     * pair containing max Q value and the corresponding action
+     * maps for storing Q value records of states
      **/
-    typedef struct max_Q_and_action_struct
-    {
+    typedef std::map<Q_state_key, Q_state_record> state_Q_record_map;
 
-        float max_Q_value;
-        float max_Q_action;
+    static_assert(Q_MAP_SHARDS == Q_BINARY_SHARDS,
+            "binary Q value files should have a shard for each Q map");
 
-    } max_Q_and_action;
 
     /**
-     * maps for storing Q values for state-action pair
+     * copy of all the Q value records ( taken by Q_maps ) along with what
+     * is needed for writing them to a Q value file. Writing a snapshot does
+     * not need Q_maps, so it can be written while Q_maps is being updated.
      **/
-    typedef std::map<std::string, float> state_action_Q_map;
+    typedef struct Q_maps_snapshot_struct
+    {
+
+        // records of each shard sorted by state key
+        std::vector<Q_file_record> shard_records[Q_MAP_SHARDS];
+        // training counter written to the file
+        long long int training_counter;
+
+        // ids written to binary Q value file
+        std::string Q_learner_id;
+        std::string reward_id;
+        std::string fuzzy_controller_version;
+
+        // name of Q value file and its type ( non-zero for binary file )
+        std::string file_name;
+        int binary_file;
+        // encoding of Q values in binary file ( Q_VALUES_FLOAT32 or Q_VALUES_INT16 )
+        int value_encoding;
+
+        // result of writing the file ( 0 on success, else -1 )
+        int write_result;
+
+    } Q_maps_snapshot;
 
-    /**
-     * map for storing max Q value and action (as float values) for each state
-     **/
-    typedef std::map<std::string, max_Q_and_action * > state_max_Q_and_action_map;
 
     /*
      * ==========================================================================
@@ -76,6 +103,27 @@ namespace controller_storage
      *                methods to read and write these maps to/from files along
      *                with other relevant information while reading or writing
      *                from file.
+     *
+     *                Q value records are kept in sparse maps by default. With
+     *                "use_dense_table", states within given bounds are kept in
+     *                a dense table ( Q_dense_table ) instead, and only states
+     *                outside those bounds are kept in the sparse maps.
+     *
+     *                A binary Q value file ( see car222_Q_binary_format.h ) is
+     *                memory mapped and its records are used in place. Records
+     *                in sparse maps take precedence over records of the mapped
+     *                file, so states that are added (or changed in a read-only
+     *                mapping) after loading the file are kept in sparse maps.
+     *
+     *                Between writes of a Q value file, records of updated states
+     *                can be appended to its journal ( "append_to_journal" ) and
+     *                the journal is replayed when the file is loaded again.
+     *
+     *                Methods for one state ( get and update methods ) lock the
+     *                shard of the state, so several threads ( or learners ) can
+     *                read and update the maps at the same time. Methods for all
+     *                the states ( load, write, journal and layout ) should not
+     *                run while other threads use the maps.
      * ===========================================================================
      */
     class Q_maps
@@ -99,56 +147,113 @@ namespace controller_storage
             /**
              *  loads maps of Q values from given file
              *  (also sets the "m_Q_value_file_name" when file is loaded successfully).
+             *  A binary Q value file is detected from its magic characters and
+             *  is loaded with "load_maps_from_binary_file".
+             *  Journal of the file is replayed after loading it ( also when the
+             *  file does not exist yet or could not be read ).
              *  It returns one of the 2 values -
              *    - 0 for empty file or for error reading file
-             *    - a training counter found in the file
+             *    - a training counter found in the file ( or in its journal )
              **/
             long long int load_maps_from_file(const std::string & t_Q_value_file_name);
 
+            /**
+             *  loads maps of Q values from given binary Q value file by memory
+             *  mapping it. In TRAINING_MODE the mapping is private and writable
+             *  (copy-on-write), so Q values of states in the file are updated in
+             *  place without changing the file. Otherwise the mapping is read-only.
+             *  If a dense table is in use, records are copied to it instead.
+             *  A file with quantized Q values ( Q_VALUES_INT16 ) is never updated in
+             *  place. Its records are converted to float records when they are read,
+             *  and updated states are kept in sparse maps.
+             *  Records of a previously mapped file are copied to sparse maps, unless
+             *  the same file is loaded again.
+             *  A file that fails validation ( too small, not mapped or with an
+             *  invalid header ) is not loaded, but its journal is replayed, and the
+             *  file is not written over until it is moved aside ( see "write_maps_to_file" ).
+             *  Return values are same as "load_maps_from_file".
+             **/
+            long long int load_maps_from_binary_file(const std::string & t_Q_value_file_name);
+
+            /**
+             * sets ids that are written to binary Q value files and that are
+             * checked ( with a warning on mismatch ) when a binary file is loaded
+             **/
+            void set_version_ids(const std::string & t_Q_learner_id,
+                    const std::string & t_reward_id,
+                    const std::string & t_fuzzy_controller_version);
+
+            /**
+             * sets encoding of Q values ( Q_VALUES_FLOAT32 or Q_VALUES_INT16 ) for
+             * binary Q value files written after it. Quantized files are smaller,
+             * but their Q values are within half a level of the float values
+             * ( within a level for Q values less than half a level, see
+             * "quantize_Q_record" ). Default is Q_VALUES_FLOAT32.
+             **/
+            void set_binary_value_encoding(const int t_value_encoding);
+
+            /* returns non-zero if a binary Q value file is mapped */
+            inline int is_using_mapped_file() const
+            {
+                return m_mapped_file != NULL;
+            }
+
             /**
              * returns Q value for given state and action pair
              * (returns 0 if the pair was not found in maps).
              **/
-            float get_Q_value_for(const std::string & state_string,
-                    const std::string & action_string) const;
+            float get_Q_value_for(const Q_state_key state_key,
+                    const Q_action_index action_index) const;
 
             /**
              * returns max Q value for given state
-             * (returns 0 if the state name was not found in the max Q value map).
-             * It uses max Q and action map to return the max Q value. It does not
-             * consider Q values of untried actions as it has no knowledge of the
-             * action space. For more information look into "check_and_update_max_Q"
-             * method.
+             * (returns 0 if the state was not found in maps).
+             * It uses max Q value cached in the state's record. It does not
+             * consider Q values of untried actions. For more information look
+             * into "check_and_update_max_Q" method.
              **/
-            float get_max_Q_value_for(const std::string & state_string) const;
+            float get_max_Q_value_for(const Q_state_key state_key) const;
 
             /**
-             * returns the Q value map for a given state. It uses characters
-             * at position 1 and 2 of the state string (positions are 0-based)
-             * and internally calls the private method "get_map_for" with these
-             * characters. It differs from the private method in arguments
-             * as well as the const qualification of return type. This method
-             * returns a const map while the private method returns a non-const map.
-             *
-             * For example, if a state is as shown below :
-             *
-             *        +15|+0.4|+06|+06|-000.6|-000.2
-             *         ↑↑
-             *
-             * then the characters at position 1, 2 are "1" and "5".
-             * (these correspond to velocity_x value of the state and for each
-             * of these character combinations there is a separate map).
-             * It will return the Q value map that has states with characters "1"
-             * and "5" at position 1 and 2.
-             **/
-            inline const state_action_Q_map & get_map_for(
-                    const std::string & state_string) const
-                {
-                    return get_map_for(state_string.at(1), state_string.at(2));
-                }
+             * copies the Q value record for a given state to second argument
+             * (returns 0 if no action has been tried for the state, else 1).
+             * It uses the dense table if the state is within its bounds, else it
+             * uses magnitude of speed_x of the state to select the map that has
+             * its record ( see "velocity_Q_map_pointers" ) and then the mapped file.
+             **/
+            int get_record_for(const Q_state_key state_key,
+                    Q_state_record & state_record) const;
+
+            /**
+             * clears and fills records of all the states ( of all the shards in
+             * order, each sorted by state key ) to the list.
+             **/
+            void get_all_records(std::vector<Q_file_record> & records) const;
+
+            /**
+             * keeps states within given bounds in a dense table, moving their
+             * records from sparse maps (and from a previous dense table) to it.
+             * Returns 0 on success and -1 if the dense table couldn't be allocated
+             * (in which case layout of the maps is not changed).
+             **/
+            int use_dense_table(const Q_dense_bounds & t_bounds);
+
+            /* returns non-zero if a dense table is in use */
+            inline int is_using_dense_table() const
+            {
+                return m_dense_table != NULL;
+            }
+
+            /**
+             * returns approximate bytes of memory used by Q values (dense table
+             * and sparse maps). If "print_info" is ON ( non-zero ) then prints
+             * memory used by both. "print_info" default is OFF ( zero ).
+             **/
+            size_t get_memory_footprint(const int print_info = 0) const;
 
             /**
-             * get total size of the current Q value maps.
+             * get total size of the current Q value maps i.e. number of
+             * state-action pairs that have Q values.
              * If "print_info" is ON ( non-zero ) then prints size of all the maps.
              * "print_info" default is OFF ( zero ).
              **/
@@ -156,28 +261,99 @@ namespace controller_storage
 
             /**
              * updates Q value for state and action pair
-             * also updates max Q and action map
+             * also updates max Q value and action of the state's record
              **/
-            void update_Q_value_for(const std::string & state_string,
-                    const std::string & action_string, const float t_Q_value);
+            void update_Q_value_for(const Q_state_key state_key,
+                    const Q_action_index action_index, const float t_Q_value);
 
-            /* write Q maps to file (optionally overwrite training_race_counter) */
+            /**
+             * moves Q value for state and action pair towards given target, i.e.
+             * sets it to "(1 - learning_rate) * Q value + learning_rate * target"
+             * while the state is locked, so an update from another thread is not
+             * lost in between. Returns the temporal difference, i.e. target minus
+             * Q value before the update.
+             **/
+            float update_Q_value_towards(const Q_state_key state_key,
+                    const Q_action_index action_index, const float target,
+                    const float learning_rate);
+
+            /**
+             * adds increments to Q values of given state and action pairs
+             * ( arrays of "count" pairs ). Each state is locked while its
+             * Q value is updated.
+             **/
+            void add_to_Q_values(const Q_state_key * state_keys,
+                    const Q_action_index * action_indices,
+                    const float * increments, const int count);
+
+            /**
+             * write Q maps to file (optionally overwrite training_race_counter).
+             * File is written with a temporary name and renamed when it is complete,
+             * then journal of the file is removed as its updates are in the file.
+             * It returns -1 without writing if the file is there but could not be
+             * loaded ( its Q values would be lost ).
+             **/
             int write_maps_to_file(const std::string & t_Q_value_file_name,
                     const long long int race_counter = 0);
 
+            /**
+             * writes Q maps to the given file ( binary if "binary_file" is non-zero,
+             * else text ) in a background thread, so the caller does not wait for
+             * disk. Records are copied to a snapshot before it returns, so updates
+             * made after it are not written. Journal of the file is moved aside
+             * ( and removed when the file is written ) and next journal blocks go
+             * to a new journal. A previous background write is waited for first.
+             * Returns 0 if the write was started ( or done if a thread couldn't be
+             * started ), else -1.
+             **/
+            int start_background_write(const std::string & t_Q_value_file_name,
+                    const long long int race_counter, const int binary_file);
+
+            /* waits for background write (if any) to finish and returns its result */
+            int wait_for_background_write();
+
+            /**
+             * appends records of the states updated since last append ( or since
+             * the maps were loaded or written ) to journal of the given Q value
+             * file as one block with given race counter. Journal is flushed to
+             * disk before it returns. Returns 0 on success and -1 on error.
+             **/
+            int append_to_journal(const std::string & t_Q_value_file_name,
+                    const long long int race_counter);
+
+            /**
+             * replays journal of the given Q value file ( if there is one ) onto
+             * the maps. Blocks with a training counter not greater than
+             * "m_training_counter" are already in the Q value file and are skipped.
+             * A partly written block at the end of journal ( crash while appending )
+             * is discarded by truncating the journal.
+             * It returns "m_training_counter" ( set to counter of the last block ).
+             * Loading a Q value file replays its journal.
+             **/
+            long long int replay_journal(const std::string & t_Q_value_file_name);
+
+            /**
+             * write Q maps to binary file (optionally overwrite training_race_counter).
+             * It writes a temporary file first and renames it to the given name, so
+             * a file that is currently mapped ( or being read ) is never truncated.
+             * Like "write_maps_to_file" it removes journal of the file once the file
+             * is written.
+             **/
+            int write_maps_to_binary_file(const std::string & t_Q_value_file_name,
+                    const long long int race_counter = 0);
+
 
         private :
 
             /** MEMBER VARIABLES **/
 
             /**
-             * a fixed length array of pointers to maps containing state-action and Q value.
+             * a fixed length array of pointers to maps containing Q value records of states.
              *
-             * There are numerous state-action to Q value maps that are stored in this array.
-             * For a given state-action pair, the two characters at position 1 and 2
-             * ( positions are 0-based and these positions correspond to the velocity-x
-             * in a state ), decide the map that is selected for storing the state-action and
-             * Q value.
+             * There are numerous state to Q value record maps that are stored in this array.
+             * For a given state, the magnitude of velocity-x of the state (i.e. the two
+             * characters at position 1 and 2 of the state string), decides the map that is
+             * selected for storing the record of Q values.
              *
              * So, the two states shown below would be stored in two different maps
              *
@@ -194,84 +370,231 @@ namespace controller_storage
              *
              * This is because at position 1 and 2 the digits "2", "5" are same.
              *
-             * Right now in version "v1.0.0" there are 60 maps for velocities 00 to 59 (sign
-             * character is ignored). The states with characters other than [00, 59] at
-             * position 1 and 2 are stored in a separate map "default_velocity_Q_map_pointer".
+             * Right now in version "v1.2.0" there are 60 maps for velocities 00 to 59 (sign
+             * is ignored). The states with velocities other than [00, 59] are stored in
+             * a separate map "default_velocity_Q_map_pointer".
              **/
-            state_action_Q_map *
+            state_Q_record_map *
                 velocity_Q_map_pointers[Q_MAP_ARRAY_ROWS][Q_MAP_ARRAY_COLUMNS];
 
             /* pointer to default map for state with velocities that are out of range */
-            state_action_Q_map * default_velocity_Q_map_pointer;
+            state_Q_record_map * default_velocity_Q_map_pointer;
+
+            /* dense table for states within its bounds (NULL if not in use) */
+            Q_dense_table * m_dense_table;
+
+            /* memory mapped binary Q value file (NULL if no file is mapped) */
+            void * m_mapped_file;
+            /* size of mapped file in bytes */
+            size_t m_mapped_file_size;
+            /* non-zero if records of mapped file can be updated in place */
+            int m_mapped_file_writable;
 
             /**
-             * pointer to map for state's max Q value and action.
-             * In sooner revision this should expand to an array of pointers similar to
-             * "velocity_Q_map_pointers".
+             * first record and number of records of each shard in mapped file.
+             * Records are either float records or quantized records ( the other
+             * pointers are NULL ).
              **/
-            state_max_Q_and_action_map * max_Q_and_action_map_pointer;
+            Q_file_record * m_mapped_shards[Q_MAP_SHARDS];
+            const Q_quantized_record * m_quantized_shards[Q_MAP_SHARDS];
+            size_t m_mapped_shard_sizes[Q_MAP_SHARDS];
+
+            /* encoding of Q values in binary files that are written */
+            int m_binary_value_encoding;
+
+            /**
+             * states of each shard updated since last append to journal ( guarded
+             * by lock of the shard ). Updates are not recorded while records are
+             * only moved or replayed ( "m_is_recording_updates" is 0 ).
+             **/
+            std::set<Q_state_key> m_updated_states[Q_MAP_SHARDS];
+            int m_is_recording_updates;
+
+            /* lock of each shard ( for methods of one state ) */
+            mutable pthread_mutex_t m_shard_locks[Q_MAP_SHARDS];
+
+            /* background thread writing a snapshot and the snapshot being written */
+            pthread_t m_writer_thread;
+            Q_maps_snapshot * m_writer_snapshot;
+
+            /* ids written to binary Q value files */
+            std::string m_Q_learner_id;
+            std::string m_reward_id;
+            std::string m_fuzzy_controller_version;
+
+            /**
+             * Q value file that could not be loaded ( it is kept for inspection, so
+             * Q values are not written over it while it is there )
+             **/
+            std::string m_invalid_file_name;
 
 
             /** MEMBER FUNCTIONS **/
 
             /**
-             * returns the Q value map for a state with given characters
-             * at position 1 and 2 of the state string (positions are 0-based).
+             * returns the Q value map for a state with given magnitude of speed_x.
              *
              * For example, if a state is as shown below :
              *
              *        +15|+0.4|+06|+06|-000.6|-000.2
              *         ↑↑
              *
-             * then the characters at position 1, 2 are "1" and "5".
-             * (these correspond to velocity_x value of the state and for each
-             * of these character combinations there is a separate map).
-             * It will return the Q value map that has states with "1" and "5" at position
-             * 1 and 2.
+             * then speed_x magnitude is 15 and it will return the map at
+             * row 1 and column 5 of "velocity_Q_map_pointers".
              *
-             * This method differs from public method "get_map_for" in arguments as well
-             * as the const-qualification of the return type. The public method returns
-             * a const map while this method returns a non-const map.
              **/
-            inline state_action_Q_map & get_map_for(
-                        const char & map_key_first_char,
-                        const char &  map_key_second_char) const
+            inline state_Q_record_map & get_map_for(
+                        const long speed_x_magnitude) const
                 {
-                    int index_1 = map_key_first_char - '0';
-                    int index_2 = map_key_second_char - '0';
+                    const int shard = get_shard_for(speed_x_magnitude);
 
-                    // check for bounds
-                    if(index_1 < 0 || index_1 >= Q_MAP_ARRAY_ROWS ||
-                            index_2 < 0 || index_2 >= Q_MAP_ARRAY_COLUMNS)
+                    // for out of bound return default map
+                    if(shard == Q_MAP_SHARDS - 1)
                     {
-                        // for out of bound return default map
                         return *default_velocity_Q_map_pointer;
                     }
 
                     // return intended map from the array of maps
-                    return *(velocity_Q_map_pointers[index_1][index_2]);
+                    return *(velocity_Q_map_pointers[shard / Q_MAP_ARRAY_COLUMNS]
+                            [shard % Q_MAP_ARRAY_COLUMNS]);
                 }
 
+            /**
+             * returns index of the Q map ( shard ) for a state with given magnitude
+             * of speed_x. Velocity maps are in row order followed by the default map
+             * ( same order as "get_all_Q_value_maps" ).
+             **/
+            static inline int get_shard_for(const long speed_x_magnitude)
+                {
+                    return get_Q_shard_for(speed_x_magnitude);
+                }
+
+            /* returns lock of the shard of the given state */
+            inline pthread_mutex_t & get_lock_for(const Q_state_key state_key) const
+                {
+                    return m_shard_locks[get_shard_for(speed_x_dimension::magnitude(state_key))];
+                }
+
+            /**
+             * returns Q value for given state and action pair ( same as
+             * "get_Q_value_for" without locking the state )
+             **/
+            float find_Q_value(const Q_state_key state_key,
+                    const Q_action_index action_index) const;
+
+            /**
+             * sets Q value for given state and action pair ( same as
+             * "update_Q_value_for" without locking the state )
+             **/
+            void set_Q_value(const Q_state_key state_key,
+                    const Q_action_index action_index, const float t_Q_value);
+
+            /**
+             * returns record of the given state from sparse maps or from mapped
+             * file ( in that order ) or NULL if state is not found in them.
+             * A quantized record of mapped file is converted to "mapped_record_copy"
+             * and a pointer to it is returned.
+             **/
+            const Q_state_record * find_sparse_record(const Q_state_key state_key,
+                    Q_state_record & mapped_record_copy) const;
+
+            /**
+             * returns float record of the given state in mapped file or NULL if
+             * not found ( or if mapped file has quantized records )
+             **/
+            Q_file_record * find_mapped_record(const Q_state_key state_key) const;
+
+            /**
+             * returns quantized record of the given state in mapped file or NULL
+             * if not found ( or if mapped file has float records )
+             **/
+            const Q_quantized_record * find_quantized_record(const Q_state_key state_key) const;
+
+            /**
+             * copies record of the given state in mapped file ( float or quantized )
+             * to second argument. Returns 1 if it is found, else 0.
+             **/
+            int get_mapped_record(const Q_state_key state_key,
+                    Q_state_record & state_record) const;
+
+            /* copies record at given index of a shard of mapped file as float record */
+            void get_mapped_file_record(const int shard, const size_t index,
+                    Q_file_record & file_record) const;
+
+            /**
+             * clears and fills records of all the states of a shard (from dense
+             * table, sparse map and mapped file) to the list, sorted by state key.
+             **/
+            void get_shard_records(const int shard, std::vector<Q_file_record> & records) const;
+
+            /* writes Q maps to text or binary file ( waits for background write ) */
+            int write_maps(const std::string & t_Q_value_file_name,
+                    const long long int race_counter, const int binary_file);
+
+            /* copies all the records and information for writing them to a snapshot */
+            void take_snapshot(Q_maps_snapshot & snapshot,
+                    const std::string & t_Q_value_file_name,
+                    const long long int race_counter, const int binary_file);
+
+            /* forgets states updated since last append to journal */
+            void clear_updated_states();
+
+            /**
+             * replays journal of a Q value file that could not be loaded ( its
+             * updates are not lost ) and keeps the file from being written over.
+             * It returns "m_training_counter".
+             **/
+            long long int replay_journal_of_invalid_file(
+                    const std::string & t_Q_value_file_name);
+
+            /**
+             * returns non-zero ( with an error ) if given file is a Q value file
+             * that could not be loaded and is still there
+             **/
+            int is_invalid_file(const std::string & t_Q_value_file_name) const;
+
+            /**
+             * replays one journal file, skipping blocks with training counter not
+             * greater than "file_training_counter" ( see "replay_journal" )
+             **/
+            void replay_journal_file(const std::string & journal_file_name,
+                    const long long int file_training_counter);
+
+            /**
+             * unmaps the mapped file. If "keep_records" is non-zero then records of
+             * mapped file are first copied to sparse maps ( records that are already
+             * in sparse maps are kept as they are ).
+             **/
+            void release_mapped_file(const int keep_records);
+
+            /**
+             * adds records ( sorted by state key, with max Q values ) to the
+             * given shard. Records are inserted directly when the shard is empty,
+             * else their Q values are updated like any other update.
+             **/
+            void add_records(const int shard, const std::vector<Q_file_record> & records);
+
             /**
              * clears and fills all the map pointers (also the default map)
              * to the map list
              **/
-            void get_all_Q_value_maps(std::vector<state_action_Q_map *> & map_list) const;
+            void get_all_Q_value_maps(std::vector<state_Q_record_map *> & map_list) const;
+
+            /* copies Q values of the given slot of a dense table to the state record */
+            static void get_dense_record(const Q_dense_table & dense_table,
+                    const long slot, Q_state_record & state_record);
 
             /**
-             * check and update max Q value and action for given state
+             * check and update max Q value and action in the given state record
+             * after Q value of given action has been set to given Q value.
              *
-             * It updates the max Q and action map for the given state.
-             * While finding the max Q value for given state, any action whose Q value
-             * is not there in the state Q value map (i.e. the Q values of untried
-             * action) is not considered for max comparison. This is because it has no
-             * knowledge of action space and only knows Q values for actions that are
-             * there in the state Q value map.
-             **/
-            void check_and_update_max_Q(const std::string & state_name,
-                    const std::string & action_name,
-                    const float t_Q_value,
-                    const std::map<std::string, float> & state_Q_value_map);
+             * While finding the max Q value for the state, any action whose bit
+             * is not set in "tried_actions" of the record (i.e. the Q values of
+             * untried action) is not considered for max comparison.
+             **/
+            static void check_and_update_max_Q(Q_state_record & state_record,
+                    const Q_action_index action_index,
+                    const float t_Q_value);
 
             // restricted copy constructor
             Q_maps(const Q_maps &other) = delete;
@@ -293,19 +616,53 @@ namespace controller_storage
     {
         // pointer to Q_maps object
         Q_maps * _Q_maps;
+        // non-zero if "_Q_maps" is deleted with this storage ( Q_maps of a
+        // Q_table_cache is owned by the cache )
+        int owns_Q_maps;
+        // visit counts of Q values ( NULL when visits are not recorded )
+        Q_visit_counts * _Q_visit_counts;
 
         Q_maps_storage_struct()
         {
             _Q_maps = new Q_maps;
+            owns_Q_maps = 1;
+            _Q_visit_counts = NULL;
+        }
+
+        /* replaces Q_maps of storage with a new empty Q_maps */
+        void reset_Q_maps()
+        {
+            if(owns_Q_maps)
+            {
+                delete _Q_maps;
+            }
+
+            _Q_maps = new Q_maps;
+            owns_Q_maps = 1;
+        }
+
+        /* makes given Q_maps ( owned by someone else ) the Q_maps of storage */
+        void use_Q_maps(Q_maps * t_Q_maps)
+        {
+            if(owns_Q_maps && _Q_maps != t_Q_maps)
+            {
+                delete _Q_maps;
+            }
+
+            _Q_maps = t_Q_maps;
+            owns_Q_maps = 0;
         }
 
         ~Q_maps_storage_struct()
         {
-            if(_Q_maps != NULL)
+            if(_Q_maps != NULL && owns_Q_maps)
             {
                 delete _Q_maps;
-                _Q_maps = NULL;
             }
+            _Q_maps = NULL;
+
+            delete _Q_visit_counts;
+            _Q_visit_counts = NULL;
         }
 
     } Q_maps_storage;
@@ -0,0 +1,333 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * car222_Q_model.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <time.h>
+
+#include "car222_Q_model.h"
+
+
+namespace
+{
+
+    /* returns seconds of monotonic clock */
+    double get_seconds()
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return now.tv_sec + now.tv_nsec / 1e9;
+    }
+
+}
+
+
+/**
+ *  Constructor
+ **/
+controller_storage::Q_transition_model::Q_transition_model()
+{
+    m_memory_budget = 0;
+    m_random_state = 2463534242ULL;
+
+    pthread_mutex_init(&m_mutex, NULL);
+
+    m_is_planning = 0;
+    m_stop_planning.store(0);
+    m_planning_maps = NULL;
+
+    m_stats.pairs = 0;
+    m_stats.memory_footprint = 0;
+    m_stats.observed_steps = 0;
+    m_stats.dropped_steps = 0;
+    m_stats.planning_updates = 0;
+    m_stats.thread_updates = 0;
+    m_stats.thread_seconds = 0;
+}
+
+
+/**
+ *  Destructor
+ **/
+controller_storage::Q_transition_model::~Q_transition_model()
+{
+    stop_planning();
+
+    pthread_mutex_destroy(&m_mutex);
+}
+
+
+void controller_storage::Q_transition_model::set_memory_budget(const size_t t_memory_budget)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_memory_budget = t_memory_budget;
+    pthread_mutex_unlock(&m_mutex);
+}
+
+
+/**
+ *  Returns bytes used by an entry along with its index.
+ **/
+size_t controller_storage::Q_transition_model::get_entry_size()
+{
+    // entry, its key in the index and ( approximately ) a node of the index
+    return sizeof(Q_model_entry) + sizeof(unsigned long long int) + sizeof(size_t)
+        + 2 * sizeof(void *);
+}
+
+
+unsigned long long int controller_storage::Q_transition_model::get_random()
+{
+    m_random_state ^= m_random_state << 13;
+    m_random_state ^= m_random_state >> 7;
+    m_random_state ^= m_random_state << 17;
+
+    return m_random_state;
+}
+
+
+/**
+ *  Learns an observed step.
+ **/
+void controller_storage::Q_transition_model::observe(const Q_state_key state_key,
+        const Q_action_index action_index, const float reward,
+        const Q_state_key next_state_key)
+{
+    const unsigned long long int pair_key = get_pair_key(state_key, action_index);
+
+    pthread_mutex_lock(&m_mutex);
+
+    m_stats.observed_steps++;
+
+    std::unordered_map<unsigned long long int, size_t>::iterator it =
+        m_entry_index.find(pair_key);
+    if(it == m_entry_index.end())
+    {
+        // no new pairs after memory budget is taken
+        if(m_memory_budget > 0 &&
+                (m_entries.size() + 1) * get_entry_size() > m_memory_budget)
+        {
+            m_stats.dropped_steps++;
+            pthread_mutex_unlock(&m_mutex);
+            return;
+        }
+
+        Q_model_entry entry;
+        entry.state_key = state_key;
+        entry.action_index = action_index;
+        entry.count = 0;
+        entry.mean_reward = 0;
+        for(int i = 0; i < Q_MODEL_NEXT_STATES; i++)
+        {
+            entry.next_state_keys[i] = 0;
+            entry.next_state_counts[i] = 0;
+        }
+
+        it = m_entry_index.insert(std::make_pair(pair_key, m_entries.size())).first;
+        m_entries.push_back(entry);
+    }
+
+    Q_model_entry & entry = m_entries[it->second];
+    entry.count++;
+    entry.mean_reward += (reward - entry.mean_reward) / entry.count;
+
+    // count the next state, or replace least frequent next state with it
+    int least_frequent = 0;
+    int found = 0;
+    for(int i = 0; i < Q_MODEL_NEXT_STATES; i++)
+    {
+        if(entry.next_state_counts[i] > 0 && entry.next_state_keys[i] == next_state_key)
+        {
+            entry.next_state_counts[i]++;
+            found = 1;
+            break;
+        }
+
+        if(entry.next_state_counts[i] < entry.next_state_counts[least_frequent])
+        {
+            least_frequent = i;
+        }
+    }
+    if(!found)
+    {
+        entry.next_state_keys[least_frequent] = next_state_key;
+        entry.next_state_counts[least_frequent] = 1;
+    }
+
+    pthread_mutex_unlock(&m_mutex);
+}
+
+
+/**
+ *  Makes planning updates.
+ **/
+int controller_storage::Q_transition_model::plan(Q_maps & t_Q_maps,
+        const Q_planning_parameters & parameters, const int updates)
+{
+    int planned = 0;
+    for(; planned < updates; planned++)
+    {
+        // draw an observed pair and one of its next states ( by frequency )
+        pthread_mutex_lock(&m_mutex);
+        if(m_entries.empty())
+        {
+            pthread_mutex_unlock(&m_mutex);
+            break;
+        }
+
+        const Q_model_entry & entry = m_entries[get_random() % m_entries.size()];
+
+        unsigned int next_state_total = 0;
+        for(int i = 0; i < Q_MODEL_NEXT_STATES; i++)
+        {
+            next_state_total += entry.next_state_counts[i];
+        }
+
+        unsigned int draw = (unsigned int) (get_random() % next_state_total);
+        int next_state = 0;
+        while(draw >= entry.next_state_counts[next_state])
+        {
+            draw -= entry.next_state_counts[next_state];
+            next_state++;
+        }
+
+        const Q_state_key state_key = entry.state_key;
+        const Q_action_index action_index = entry.action_index;
+        const float reward = entry.mean_reward;
+        const Q_state_key next_state_key = entry.next_state_keys[next_state];
+
+        m_stats.planning_updates++;
+        pthread_mutex_unlock(&m_mutex);
+
+        // Q value update as if the step was taken
+        const float max_Q_value_for_next_state = t_Q_maps.get_max_Q_value_for(next_state_key);
+        t_Q_maps.update_Q_value_towards(state_key, action_index,
+                reward + (parameters.discount * max_Q_value_for_next_state),
+                parameters.learning_rate);
+
+        // planned updates are visits, so they have a weight when Q values of
+        // a training farm are merged
+        if(parameters.visit_counts != NULL)
+        {
+            parameters.visit_counts->record_visit(state_key, action_index);
+        }
+    }
+
+    return planned;
+}
+
+
+void * controller_storage::Q_transition_model::run_planning(void * t_model)
+{
+    Q_transition_model * model = (Q_transition_model *) t_model;
+    const Q_planning_parameters & parameters = model->m_planning_parameters;
+
+    const double start_time = get_seconds();
+    long long int updates = 0;
+
+    while(!model->m_stop_planning.load(std::memory_order_acquire) &&
+            (parameters.max_updates == 0 || updates < parameters.max_updates))
+    {
+        // updates are made in small batches so that a stop is seen soon
+        const int planned = model->plan(*(model->m_planning_maps), parameters,
+                Q_PLANNING_BATCH_SIZE);
+        if(planned == 0)
+        {
+            break;
+        }
+
+        updates += planned;
+    }
+
+    pthread_mutex_lock(&model->m_mutex);
+    model->m_stats.thread_updates = updates;
+    model->m_stats.thread_seconds = get_seconds() - start_time;
+    pthread_mutex_unlock(&model->m_mutex);
+
+    return NULL;
+}
+
+
+/**
+ *  Starts planning thread.
+ **/
+void controller_storage::Q_transition_model::start_planning(Q_maps * t_Q_maps,
+        const Q_planning_parameters & parameters)
+{
+    pthread_mutex_lock(&m_mutex);
+    const int is_empty = m_entries.empty();
+    pthread_mutex_unlock(&m_mutex);
+
+    if(m_is_planning || t_Q_maps == NULL || is_empty)
+    {
+        return;
+    }
+
+    m_planning_maps = t_Q_maps;
+    m_planning_parameters = parameters;
+    m_stop_planning.store(0);
+
+    if(pthread_create(&m_planning_thread, NULL, run_planning, this) != 0)
+    {
+        puts("couldn't start planning thread");
+        return;
+    }
+
+    m_is_planning = 1;
+}
+
+
+/**
+ *  Stops planning thread and waits for it.
+ **/
+void controller_storage::Q_transition_model::stop_planning()
+{
+    if(!m_is_planning)
+    {
+        return;
+    }
+
+    m_stop_planning.store(1, std::memory_order_release);
+    pthread_join(m_planning_thread, NULL);
+
+    m_is_planning = 0;
+    m_planning_maps = NULL;
+}
+
+
+/**
+ *  Copies statistics.
+ **/
+void controller_storage::Q_transition_model::get_stats(Q_model_stats & stats)
+{
+    pthread_mutex_lock(&m_mutex);
+    m_stats.pairs = m_entries.size();
+    m_stats.memory_footprint = m_entries.size() * get_entry_size();
+    stats = m_stats;
+    pthread_mutex_unlock(&m_mutex);
+}
+
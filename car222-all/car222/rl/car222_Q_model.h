@@ -0,0 +1,227 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * car222_Q_model.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  CAR222_Q_MODEL_H_
+#define  CAR222_Q_MODEL_H_
+
+
+#include <pthread.h>
+#include <atomic>
+#include <vector>
+#include <unordered_map>
+
+#include "car222_Q_maps.h"
+
+
+// next states kept for each state-action pair ( most frequent ones )
+#define Q_MODEL_NEXT_STATES          4
+// planning updates made by planning thread between checks for a stop
+#define Q_PLANNING_BATCH_SIZE        256
+
+
+namespace controller_storage
+{
+
+    /**
+     * what the model has learnt about a state-action pair : its most frequent
+     * next states with their counts and mean reward
+     **/
+    typedef struct Q_model_entry_struct
+    {
+
+        Q_state_key state_key;
+        Q_action_index action_index;
+
+        // times the pair has been observed
+        unsigned int count;
+        // mean reward of the pair
+        float mean_reward;
+
+        // next states and how many times each of them was observed
+        // ( a rare next state is replaced by a new one when they are full )
+        Q_state_key next_state_keys[Q_MODEL_NEXT_STATES];
+        unsigned int next_state_counts[Q_MODEL_NEXT_STATES];
+
+    } Q_model_entry;
+
+
+    /**
+     * parameters of planning
+     **/
+    typedef struct Q_planning_parameters_struct
+    {
+
+        // learning rate and discount of Q value updates
+        float learning_rate;
+        float discount;
+        // updates after which planning thread stops ( 0 for no limit )
+        long long int max_updates;
+        // visits of planned state-action pairs are counted here ( NULL if
+        // visits are not recorded )
+        Q_visit_counts * visit_counts;
+
+    } Q_planning_parameters;
+
+
+    /**
+     * statistics of the model and of planning
+     **/
+    typedef struct Q_model_stats_struct
+    {
+
+        // state-action pairs in the model and bytes of memory used by them
+        long long int pairs;
+        long long int memory_footprint;
+        // observed steps ( and those of pairs that were not added as the
+        // model was full )
+        long long int observed_steps;
+        long long int dropped_steps;
+        // planning updates since the model was created
+        long long int planning_updates;
+        // updates of last planning thread and its duration
+        long long int thread_updates;
+        double thread_seconds;
+
+    } Q_model_stats;
+
+
+    /*
+     * ==========================================================================
+     *        Class:  Q_transition_model
+     *  Description:  Tabular model of the track learnt from steps of training
+     *                races ( Dyna-Q ) : for each state-action pair it keeps its
+     *                next states ( with their frequencies ) and its mean reward.
+     *
+     *                A planning update draws an observed pair, draws its next
+     *                state from the model and updates Q value of the pair as if
+     *                the step was taken, i.e. it learns without simulating. A few
+     *                planning updates can follow each real step ( "plan" ) and
+     *                many more can run in a background thread between races
+     *                ( "start_planning" and "stop_planning" ).
+     *
+     *                Pairs are not added after the model takes its memory budget.
+     *                Steps can be observed and planned from several threads. Q
+     *                values are updated through locked methods of Q_maps.
+     * ==========================================================================
+     */
+    class Q_transition_model
+    {
+        public :
+
+            /** MEMBER FUNCTIONS **/
+
+            Q_transition_model();
+
+            ~Q_transition_model();
+
+            /* sets memory budget ( in bytes ) of the model ( 0 for no limit ) */
+            void set_memory_budget(const size_t t_memory_budget);
+
+            /* learns an observed step */
+            void observe(const Q_state_key state_key, const Q_action_index action_index,
+                    const float reward, const Q_state_key next_state_key);
+
+            /**
+             * makes given number of planning updates to given Q_maps.
+             * Returns number of updates made ( 0 if the model is empty ).
+             **/
+            int plan(Q_maps & t_Q_maps, const Q_planning_parameters & parameters,
+                    const int updates);
+
+            /**
+             * starts a thread that makes planning updates to given Q_maps until
+             * "max_updates" of parameters or until "stop_planning". Nothing is
+             * done if the model is empty or planning thread is already running.
+             **/
+            void start_planning(Q_maps * t_Q_maps, const Q_planning_parameters & parameters);
+
+            /* stops planning thread and waits for it */
+            void stop_planning();
+
+            /* copies statistics to the argument */
+            void get_stats(Q_model_stats & stats);
+
+
+        private :
+
+            /** MEMBER VARIABLES **/
+
+            /* entries of pairs and their index by pair ( see "get_pair_key" ) */
+            std::vector<Q_model_entry> m_entries;
+            std::unordered_map<unsigned long long int, size_t> m_entry_index;
+
+            /* memory budget of entries ( 0 for no limit ) */
+            size_t m_memory_budget;
+
+            /* state of random number generator ( xorshift ) */
+            unsigned long long int m_random_state;
+
+            /* guards entries, random number generator and statistics */
+            pthread_mutex_t m_mutex;
+
+            /* planning thread and what it plans for */
+            pthread_t m_planning_thread;
+            int m_is_planning;
+            std::atomic<int> m_stop_planning;
+            Q_maps * m_planning_maps;
+            Q_planning_parameters m_planning_parameters;
+
+            Q_model_stats m_stats;
+
+
+            /** MEMBER FUNCTIONS **/
+
+            /* returns a key for state and action pair */
+            static inline unsigned long long int get_pair_key(const Q_state_key state_key,
+                    const Q_action_index action_index)
+            {
+                return (state_key << Q_ACTION_INDEX_BITS) | action_index;
+            }
+
+            /* returns bytes of memory used by an entry */
+            static size_t get_entry_size();
+
+            /* returns next random number ( "m_mutex" should be locked ) */
+            unsigned long long int get_random();
+
+            /* thread function of planning thread ( argument is the model ) */
+            static void * run_planning(void * t_model);
+
+            // restricted copy constructor
+            Q_transition_model(const Q_transition_model &other) = delete;
+
+            // restricted assignment operator
+            Q_transition_model& operator=(const Q_transition_model &other) = delete;
+
+    };
+
+}
+
+
+#endif      /* ifndef CAR222_Q_MODEL_H_ */
+
@@ -0,0 +1,341 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * car222_Q_replay.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+
+#include "car222_Q_replay.h"
+
+
+namespace
+{
+
+    /* a step taken out of the buffer for a batch */
+    typedef struct batch_step_struct
+    {
+
+        // shard of its state in Q_maps
+        int shard;
+        // number of the step ( since the buffer was created )
+        unsigned long long int step_number;
+        controller_storage::Q_replay_transition transition;
+
+    } batch_step;
+
+
+    /* orders steps of a batch by shard and state */
+    bool is_before(const batch_step & a, const batch_step & b)
+    {
+        if(a.shard != b.shard)
+        {
+            return a.shard < b.shard;
+        }
+
+        return a.transition.state_key < b.transition.state_key;
+    }
+
+
+    /* returns seconds of monotonic clock */
+    double get_seconds()
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return now.tv_sec + now.tv_nsec / 1e9;
+    }
+
+}
+
+
+/**
+ *  Constructor
+ **/
+controller_storage::Q_replay_buffer::Q_replay_buffer()
+{
+    m_capacity = 0;
+    m_added = 0;
+    m_random_state = 88172645463325252ULL;
+
+    pthread_mutex_init(&m_mutex, NULL);
+
+    m_is_replaying = 0;
+    m_stop_replay.store(0);
+    m_replay_maps = NULL;
+
+    m_stats.recorded_steps = 0;
+    m_stats.replayed_updates = 0;
+    m_stats.replayed_batches = 0;
+    m_stats.replay_seconds = 0;
+}
+
+
+/**
+ *  Destructor
+ **/
+controller_storage::Q_replay_buffer::~Q_replay_buffer()
+{
+    stop_replay();
+
+    pthread_mutex_destroy(&m_mutex);
+}
+
+
+/**
+ *  Sets capacity and removes all the steps.
+ **/
+void controller_storage::Q_replay_buffer::set_capacity(const size_t t_capacity)
+{
+    stop_replay();
+
+    pthread_mutex_lock(&m_mutex);
+    m_transitions.assign(t_capacity, Q_replay_transition());
+    m_transitions.shrink_to_fit();
+    m_capacity = t_capacity;
+    m_added = 0;
+    pthread_mutex_unlock(&m_mutex);
+}
+
+
+/**
+ *  Adds a step to the buffer.
+ **/
+void controller_storage::Q_replay_buffer::add(const Q_replay_transition & transition)
+{
+    if(m_capacity == 0)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    m_transitions[m_added % m_capacity] = transition;
+    m_added++;
+    m_stats.recorded_steps++;
+    pthread_mutex_unlock(&m_mutex);
+}
+
+
+/**
+ *  Returns number of steps in the buffer.
+ **/
+size_t controller_storage::Q_replay_buffer::get_size()
+{
+    pthread_mutex_lock(&m_mutex);
+    const size_t size = (m_added < m_capacity) ? m_added : m_capacity;
+    pthread_mutex_unlock(&m_mutex);
+
+    return size;
+}
+
+
+unsigned long long int controller_storage::Q_replay_buffer::get_random()
+{
+    m_random_state ^= m_random_state << 13;
+    m_random_state ^= m_random_state >> 7;
+    m_random_state ^= m_random_state << 17;
+
+    return m_random_state;
+}
+
+
+/**
+ *  Replays a batch of steps.
+ **/
+int controller_storage::Q_replay_buffer::replay_batch(Q_maps & t_Q_maps,
+        const Q_replay_parameters & parameters)
+{
+    std::vector<batch_step> batch(parameters.batch_size);
+
+    // take steps of the batch out of the buffer
+    pthread_mutex_lock(&m_mutex);
+    const unsigned long long int size = (m_added < m_capacity) ? m_added : m_capacity;
+    if(size == 0)
+    {
+        pthread_mutex_unlock(&m_mutex);
+        return 0;
+    }
+
+    const unsigned long long int oldest_step = m_added - size;
+    const int candidates = parameters.prioritized ? Q_REPLAY_PRIORITY_CANDIDATES : 1;
+    for(size_t i = 0; i < batch.size(); i++)
+    {
+        // uniformly drawn step, or the step with largest priority among
+        // a few uniformly drawn steps for prioritized replay
+        unsigned long long int step_number = oldest_step + get_random() % size;
+        for(int j = 1; j < candidates; j++)
+        {
+            const unsigned long long int candidate = oldest_step + get_random() % size;
+            if(m_transitions[candidate % m_capacity].priority >
+                    m_transitions[step_number % m_capacity].priority)
+            {
+                step_number = candidate;
+            }
+        }
+
+        batch[i].step_number = step_number;
+        batch[i].transition = m_transitions[step_number % m_capacity];
+        batch[i].shard =
+            get_Q_shard_for(speed_x_dimension::magnitude(batch[i].transition.state_key));
+    }
+    pthread_mutex_unlock(&m_mutex);
+
+    // updates of a shard ( and of a state ) are made together
+    std::sort(batch.begin(), batch.end(), is_before);
+
+    for(size_t i = 0; i < batch.size(); i++)
+    {
+        Q_replay_transition & transition = batch[i].transition;
+
+        const float max_Q_value_for_next_state =
+            t_Q_maps.get_max_Q_value_for(transition.next_state_key);
+
+        const float temporal_difference = t_Q_maps.update_Q_value_towards(
+                transition.state_key, transition.action_index,
+                transition.reward + (parameters.discount * max_Q_value_for_next_state),
+                parameters.learning_rate);
+
+        transition.priority = fabsf(temporal_difference);
+    }
+
+    // replayed updates are visits, so they have a weight when Q values of a
+    // training farm are merged
+    if(parameters.visit_counts != NULL && !batch.empty())
+    {
+        std::vector<Q_state_key> state_keys(batch.size());
+        std::vector<Q_action_index> action_indices(batch.size());
+        for(size_t i = 0; i < batch.size(); i++)
+        {
+            state_keys[i] = batch[i].transition.state_key;
+            action_indices[i] = batch[i].transition.action_index;
+        }
+        parameters.visit_counts->record_visits(&state_keys[0], &action_indices[0],
+                (int) batch.size());
+    }
+
+    // update priorities of steps that have not been overwritten meanwhile
+    pthread_mutex_lock(&m_mutex);
+    for(size_t i = 0; i < batch.size(); i++)
+    {
+        if(batch[i].step_number + m_capacity >= m_added)
+        {
+            m_transitions[batch[i].step_number % m_capacity].priority =
+                batch[i].transition.priority;
+        }
+    }
+    pthread_mutex_unlock(&m_mutex);
+
+    return (int) batch.size();
+}
+
+
+void * controller_storage::Q_replay_buffer::run_replay(void * t_buffer)
+{
+    Q_replay_buffer * buffer = (Q_replay_buffer *) t_buffer;
+    const Q_replay_parameters & parameters = buffer->m_replay_parameters;
+
+    const double start_time = get_seconds();
+    long long int updates = 0;
+    long long int batches = 0;
+
+    while(!buffer->m_stop_replay.load(std::memory_order_acquire) &&
+            (parameters.max_updates == 0 || updates < parameters.max_updates))
+    {
+        const int replayed = buffer->replay_batch(*(buffer->m_replay_maps), parameters);
+        if(replayed == 0)
+        {
+            break;
+        }
+
+        updates += replayed;
+        batches++;
+    }
+
+    pthread_mutex_lock(&buffer->m_mutex);
+    buffer->m_stats.replayed_updates = updates;
+    buffer->m_stats.replayed_batches = batches;
+    buffer->m_stats.replay_seconds = get_seconds() - start_time;
+    pthread_mutex_unlock(&buffer->m_mutex);
+
+    return NULL;
+}
+
+
+/**
+ *  Starts replay thread.
+ **/
+void controller_storage::Q_replay_buffer::start_replay(Q_maps * t_Q_maps,
+        const Q_replay_parameters & parameters)
+{
+    if(m_is_replaying || t_Q_maps == NULL || parameters.batch_size <= 0 ||
+            get_size() == 0)
+    {
+        return;
+    }
+
+    m_replay_maps = t_Q_maps;
+    m_replay_parameters = parameters;
+    m_stop_replay.store(0);
+
+    if(pthread_create(&m_replay_thread, NULL, run_replay, this) != 0)
+    {
+        puts("couldn't start replay thread");
+        return;
+    }
+
+    m_is_replaying = 1;
+}
+
+
+/**
+ *  Stops replay thread and waits for it.
+ **/
+void controller_storage::Q_replay_buffer::stop_replay()
+{
+    if(!m_is_replaying)
+    {
+        return;
+    }
+
+    m_stop_replay.store(1, std::memory_order_release);
+    pthread_join(m_replay_thread, NULL);
+
+    m_is_replaying = 0;
+    m_replay_maps = NULL;
+}
+
+
+/**
+ *  Copies statistics.
+ **/
+void controller_storage::Q_replay_buffer::get_stats(Q_replay_stats & stats)
+{
+    pthread_mutex_lock(&m_mutex);
+    stats = m_stats;
+    pthread_mutex_unlock(&m_mutex);
+}
+
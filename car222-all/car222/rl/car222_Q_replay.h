@@ -0,0 +1,218 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * car222_Q_replay.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  CAR222_Q_REPLAY_H_
+#define  CAR222_Q_REPLAY_H_
+
+
+#include <pthread.h>
+#include <atomic>
+#include <vector>
+
+#include "car222_Q_maps.h"
+
+
+// candidates drawn for each step of a prioritized batch ( the one with
+// largest priority is replayed )
+#define Q_REPLAY_PRIORITY_CANDIDATES 4
+
+
+namespace controller_storage
+{
+
+    /**
+     * a step recorded for replay : state, action, reward and next state along
+     * with its priority ( magnitude of its last temporal difference )
+     **/
+    typedef struct Q_replay_transition_struct
+    {
+
+        Q_state_key state_key;
+        Q_state_key next_state_key;
+        float reward;
+        float priority;
+        Q_action_index action_index;
+
+    } Q_replay_transition;
+
+
+    /**
+     * parameters of replay
+     **/
+    typedef struct Q_replay_parameters_struct
+    {
+
+        // learning rate and discount of Q value updates
+        float learning_rate;
+        float discount;
+        // steps in a batch
+        int batch_size;
+        // non-zero if steps with larger priority are preferred
+        int prioritized;
+        // updates after which replay stops ( 0 for no limit )
+        long long int max_updates;
+        // visits of replayed state-action pairs are counted here ( NULL if
+        // visits are not recorded )
+        Q_visit_counts * visit_counts;
+
+    } Q_replay_parameters;
+
+
+    /**
+     * statistics of replay buffer
+     **/
+    typedef struct Q_replay_stats_struct
+    {
+
+        // steps recorded since the buffer was created
+        long long int recorded_steps;
+        // updates and batches of last replay ( "start_replay" ) and its duration
+        long long int replayed_updates;
+        long long int replayed_batches;
+        double replay_seconds;
+
+    } Q_replay_stats;
+
+
+    /*
+     * ==========================================================================
+     *        Class:  Q_replay_buffer
+     *  Description:  Ring buffer of steps of training races ( experience ) with
+     *                a fixed capacity, oldest steps are overwritten. Batches of
+     *                steps are replayed, i.e. Q values of their state-action
+     *                pairs are updated again, so that each step of a race is
+     *                learnt from more than once.
+     *
+     *                Steps of a batch are sorted by shard and state of Q_maps
+     *                before they are replayed, so updates of a shard are close
+     *                together. Replay can run in a background thread between
+     *                races ( "start_replay" and "stop_replay" ), while a race is
+     *                being set up or while the game waits for the next race.
+     *
+     *                Steps can be added from several threads. Q values of Q_maps
+     *                are updated through its locked methods, but methods of Q_maps
+     *                for all the states should not run during replay.
+     * ==========================================================================
+     */
+    class Q_replay_buffer
+    {
+        public :
+
+            /** MEMBER FUNCTIONS **/
+
+            Q_replay_buffer();
+
+            ~Q_replay_buffer();
+
+            /* sets capacity ( in steps ) and removes all the steps */
+            void set_capacity(const size_t t_capacity);
+
+            /* returns capacity of the buffer ( 0 until it is set ) */
+            size_t get_capacity() const
+            {
+                return m_capacity;
+            }
+
+            /* adds a step ( oldest step is overwritten when the buffer is full ) */
+            void add(const Q_replay_transition & transition);
+
+            /* returns number of steps in the buffer */
+            size_t get_size();
+
+            /* returns bytes of memory used by the steps */
+            size_t get_memory_footprint() const
+            {
+                return m_capacity * sizeof(Q_replay_transition);
+            }
+
+            /**
+             * replays a batch of steps to given Q_maps and updates their
+             * priorities. Returns number of steps replayed.
+             **/
+            int replay_batch(Q_maps & t_Q_maps, const Q_replay_parameters & parameters);
+
+            /**
+             * starts a thread that replays batches to given Q_maps until
+             * "max_updates" of parameters or until "stop_replay". Nothing is
+             * done if the buffer is empty or replay is already running.
+             **/
+            void start_replay(Q_maps * t_Q_maps, const Q_replay_parameters & parameters);
+
+            /* stops replay thread ( after its current batch ) and waits for it */
+            void stop_replay();
+
+            /* copies statistics to the argument */
+            void get_stats(Q_replay_stats & stats);
+
+
+        private :
+
+            /** MEMBER VARIABLES **/
+
+            /* steps ( ring buffer ) and number of steps ever added */
+            std::vector<Q_replay_transition> m_transitions;
+            size_t m_capacity;
+            unsigned long long int m_added;
+
+            /* state of random number generator for sampling ( xorshift ) */
+            unsigned long long int m_random_state;
+
+            /* guards steps, random number generator and statistics */
+            pthread_mutex_t m_mutex;
+
+            /* replay thread and what it replays */
+            pthread_t m_replay_thread;
+            int m_is_replaying;
+            std::atomic<int> m_stop_replay;
+            Q_maps * m_replay_maps;
+            Q_replay_parameters m_replay_parameters;
+
+            Q_replay_stats m_stats;
+
+
+            /** MEMBER FUNCTIONS **/
+
+            /* returns next random number ( "m_mutex" should be locked ) */
+            unsigned long long int get_random();
+
+            /* thread function of replay thread ( argument is the buffer ) */
+            static void * run_replay(void * t_buffer);
+
+            // restricted copy constructor
+            Q_replay_buffer(const Q_replay_buffer &other) = delete;
+
+            // restricted assignment operator
+            Q_replay_buffer& operator=(const Q_replay_buffer &other) = delete;
+
+    };
+
+}
+
+
+#endif      /* ifndef CAR222_Q_REPLAY_H_ */
+
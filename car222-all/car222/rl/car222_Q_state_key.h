@@ -0,0 +1,213 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * car222_Q_state_key.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  CAR222_Q_STATE_KEY_H_
+#define  CAR222_Q_STATE_KEY_H_
+
+
+#include <math.h>
+
+
+// number of actions in action space ( 9 equal intervals in [0,1] )
+#define Q_ACTION_SPACE_SIZE        9
+
+
+namespace controller_storage
+{
+
+    /**
+     * packed integer representation of a Q state
+     * (see "Q_state_dimension" for its layout)
+     **/
+    typedef unsigned long long Q_state_key;
+
+    /**
+     * index of an action in the action space, i.e. [0, Q_ACTION_SPACE_SIZE)
+     **/
+    typedef unsigned char Q_action_index;
+
+
+    /*
+     * ==========================================================================
+     *       Struct:  Q_state_dimension
+     *  Description:  Compile-time description of one dimension of a Q state
+     *                and of its quantization inside a Q_state_key.
+     *
+     *                A value is quantized to SCALE steps per unit and stored as
+     *                a sign bit (lowest bit) followed by MAGNITUDE_BITS bits of
+     *                magnitude, starting at bit BIT_OFFSET of the key.
+     *
+     *                Sign and magnitude are used (instead of an offset value) so
+     *                that quantization is exactly the same as the one done by
+     *                STATE_PRINT_FORMAT in the Q value files. For example,
+     *                "-000.0" and "+000.0" are two different states there and
+     *                they are two different keys here.
+     * ==========================================================================
+     */
+    template <int BIT_OFFSET, int MAGNITUDE_BITS, int SCALE>
+    struct Q_state_dimension
+    {
+        // first bit of this dimension in the key
+        static const int OFFSET = BIT_OFFSET;
+        // bits used by this dimension (including sign bit)
+        static const int BITS = MAGNITUDE_BITS + 1;
+        // first bit available for the next dimension
+        static const int NEXT_OFFSET = BIT_OFFSET + MAGNITUDE_BITS + 1;
+        // quantization steps per unit of value
+        static const int STEPS_PER_UNIT = SCALE;
+        // largest magnitude (in quantization steps) that can be stored
+        static const long MAX_MAGNITUDE = (1L << MAGNITUDE_BITS) - 1;
+        // mask for bits of this dimension (before shifting to OFFSET)
+        static const Q_state_key MASK = (1ULL << (MAGNITUDE_BITS + 1)) - 1;
+
+        /**
+         * returns the given value packed into its bits of the key.
+         * Magnitude is rounded half to even (same as printf) and it
+         * saturates at MAX_MAGNITUDE.
+         **/
+        static inline Q_state_key encode(const double value)
+        {
+            double magnitude = nearbyint(fabs(value) * SCALE);
+            if(magnitude > MAX_MAGNITUDE)
+            {
+                magnitude = MAX_MAGNITUDE;
+            }
+
+            return ( ((Q_state_key) magnitude << 1) | (signbit(value) ? 1 : 0) )
+                << BIT_OFFSET;
+        }
+
+        /* returns the given magnitude (in quantization steps) and sign packed into its bits */
+        static inline Q_state_key encode_steps(const long magnitude, const int negative)
+        {
+            return ( ((Q_state_key) magnitude << 1) | (negative ? 1 : 0) ) << BIT_OFFSET;
+        }
+
+        /* returns magnitude (in quantization steps) stored in the key */
+        static inline long magnitude(const Q_state_key key)
+        {
+            return (long) (((key >> BIT_OFFSET) & MASK) >> 1);
+        }
+
+        /* returns non-zero if the sign bit is set in the key */
+        static inline int is_negative(const Q_state_key key)
+        {
+            return (int) ((key >> BIT_OFFSET) & 1);
+        }
+
+        /* returns the (quantized) value stored in the key */
+        static inline double decode(const Q_state_key key)
+        {
+            const double value = (double) magnitude(key) / SCALE;
+            return is_negative(key) ? -value : value;
+        }
+    };
+
+
+    /**
+     * dimensions of a Q state ( see "controller::Q_state" ). Quantization
+     * of each dimension follows its field in STATE_PRINT_FORMAT.
+     **/
+    // "%+03d" and speed_x is stored in [0, 59] velocity maps
+    typedef Q_state_dimension<0, 10, 1> speed_x_dimension;
+    // "%+04.1f" and speed_y is clipped to [-1, 1]
+    typedef Q_state_dimension<speed_x_dimension::NEXT_OFFSET, 4, 10>
+        speed_y_dimension;
+    // "%+03d" and distance is clipped to [-6, 6]
+    typedef Q_state_dimension<speed_y_dimension::NEXT_OFFSET, 3, 1>
+        right_side_distance_dimension;
+    // "%+03d" and distance is clipped to [-6, 6]
+    typedef Q_state_dimension<right_side_distance_dimension::NEXT_OFFSET, 3, 1>
+        left_side_distance_dimension;
+    // "%+06.1f"
+    typedef Q_state_dimension<left_side_distance_dimension::NEXT_OFFSET, 14, 10>
+        path_dimension;
+    // "%+06.1f"
+    typedef Q_state_dimension<path_dimension::NEXT_OFFSET, 14, 10>
+        next_path_dimension;
+
+    // total number of bits used by a Q_state_key
+    static const int Q_STATE_KEY_BITS = next_path_dimension::NEXT_OFFSET;
+
+    // bits needed for an action index
+    static const int Q_ACTION_INDEX_BITS = 4;
+
+    static_assert(Q_STATE_KEY_BITS + Q_ACTION_INDEX_BITS <= 64,
+            "state key and action index should fit in 64 bits");
+    static_assert(Q_ACTION_SPACE_SIZE <= (1 << Q_ACTION_INDEX_BITS),
+            "action index should fit in Q_ACTION_INDEX_BITS");
+
+
+    /* returns packed key for a state with given values */
+    inline Q_state_key make_Q_state_key(
+            const int speed_x, const float speed_y,
+            const int right_side_distance, const int left_side_distance,
+            const float path, const float next_path)
+    {
+        return speed_x_dimension::encode(speed_x)
+            | speed_y_dimension::encode(speed_y)
+            | right_side_distance_dimension::encode(right_side_distance)
+            | left_side_distance_dimension::encode(left_side_distance)
+            | path_dimension::encode(path)
+            | next_path_dimension::encode(next_path);
+    }
+
+    /* unpacks values of a state from the given key */
+    inline void read_Q_state_key(const Q_state_key key,
+            int & speed_x, float & speed_y,
+            int & right_side_distance, int & left_side_distance,
+            float & path, float & next_path)
+    {
+        speed_x = (int) speed_x_dimension::decode(key);
+        speed_y = (float) speed_y_dimension::decode(key);
+        right_side_distance = (int) right_side_distance_dimension::decode(key);
+        left_side_distance = (int) left_side_distance_dimension::decode(key);
+        path = (float) path_dimension::decode(key);
+        next_path = (float) next_path_dimension::decode(key);
+    }
+
+    /* returns index of the action nearest to the given accel value */
+    inline Q_action_index make_Q_action_index(const float accel)
+    {
+        const double index = nearbyint(accel * (Q_ACTION_SPACE_SIZE - 1));
+
+        return (Q_action_index) (index < 0 ? 0 :
+                (index > (Q_ACTION_SPACE_SIZE - 1) ? (Q_ACTION_SPACE_SIZE - 1) : index));
+    }
+
+    /* returns accel value of the action with given index */
+    inline float get_Q_action_value(const Q_action_index action_index)
+    {
+        return (float) action_index / (Q_ACTION_SPACE_SIZE - 1);
+    }
+
+}
+
+
+#endif      /* ifndef CAR222_Q_STATE_KEY_H_ */
+
+
@@ -0,0 +1,496 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * car222_Q_table_cache.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "car222_Q_table_cache.h"
+
+
+namespace
+{
+
+    using namespace controller_storage;
+
+    /* returns FNV-1a hash of given bytes */
+    unsigned long long int get_checksum(const unsigned char * bytes, const size_t size)
+    {
+        unsigned long long int checksum = 14695981039346656037ULL;
+        for(size_t i = 0; i < size; i++)
+        {
+            checksum = (checksum ^ bytes[i]) * 1099511628211ULL;
+        }
+
+        return checksum;
+    }
+
+
+    /**
+     * fills stamp of the given file. Header of a binary Q value file ( its
+     * version, ids and training counter ) is part of the stamp.
+     **/
+    void get_file_stamp(const std::string & file_name, const int is_binary_file,
+            Q_file_stamp & stamp)
+    {
+        memset(&stamp, 0, sizeof(stamp));
+
+        struct stat file_stat;
+        if(stat(file_name.c_str(), &file_stat) != 0)
+        {
+            return;
+        }
+
+        stamp.exists = 1;
+        stamp.modification_time =
+            file_stat.st_mtim.tv_sec * 1000000000LL + file_stat.st_mtim.tv_nsec;
+        stamp.size = file_stat.st_size;
+        stamp.inode = file_stat.st_ino;
+
+        if(is_binary_file)
+        {
+            const int file_descriptor = open(file_name.c_str(), O_RDONLY);
+            if(file_descriptor >= 0)
+            {
+                unsigned char header[sizeof(Q_binary_header)];
+                const ssize_t header_size =
+                    pread(file_descriptor, header, sizeof(header), 0);
+                if(header_size > 0)
+                {
+                    stamp.header_checksum = get_checksum(header, header_size);
+                }
+                close(file_descriptor);
+            }
+        }
+    }
+
+
+    /* returns non-zero if both stamps are same */
+    int is_same_stamp(const Q_file_stamp & stamp, const Q_file_stamp & other)
+    {
+        return stamp.exists == other.exists &&
+            stamp.modification_time == other.modification_time &&
+            stamp.size == other.size && stamp.inode == other.inode &&
+            stamp.header_checksum == other.header_checksum;
+    }
+
+
+    /* returns non-zero if tables loaded from both sources would be same */
+    int is_same_source(const Q_table_source & source, const Q_table_source & other)
+    {
+        return source.text_file_name == other.text_file_name &&
+            source.binary_file_name == other.binary_file_name &&
+            source.use_binary_file == other.use_binary_file &&
+            source.Q_learner_id == other.Q_learner_id &&
+            source.reward_id == other.reward_id &&
+            source.fuzzy_controller_version == other.fuzzy_controller_version &&
+            source.use_dense_table == other.use_dense_table &&
+            (!source.use_dense_table || memcmp(&source.dense_bounds,
+                    &other.dense_bounds, sizeof(Q_dense_bounds)) == 0);
+    }
+
+
+    /**
+     * returns a new table with Q values of the given source. Binary file is
+     * loaded if it is used and it exists, else text file is loaded ( with
+     * journal of binary file that may have races after the text file ).
+     **/
+    Q_maps * load_table(const Q_table_source & source)
+    {
+        Q_maps * table = new Q_maps;
+
+        if(source.use_dense_table)
+        {
+            table->use_dense_table(source.dense_bounds);
+        }
+
+        // ids are checked against binary file
+        table->set_version_ids(source.Q_learner_id, source.reward_id,
+                source.fuzzy_controller_version);
+
+        if(source.use_binary_file && access(source.binary_file_name.c_str(), R_OK) == 0)
+        {
+            table->load_maps_from_binary_file(source.binary_file_name);
+        }
+        else
+        {
+            table->load_maps_from_file(source.text_file_name);
+
+            if(source.use_binary_file)
+            {
+                table->replay_journal(source.binary_file_name);
+            }
+        }
+
+        return table;
+    }
+
+}
+
+
+
+namespace controller_storage
+{
+
+    /**
+     *  Fills stamps of the Q value files of the given source and their journals.
+     **/
+    void get_Q_file_stamps(const Q_table_source & source,
+            std::vector<Q_file_stamp> & file_stamps)
+    {
+        const std::string file_names[] =
+        {
+            source.text_file_name,
+            source.text_file_name + Q_JOURNAL_FILE_SUFFIX,
+            source.text_file_name + Q_JOURNAL_FILE_SUFFIX + Q_JOURNAL_CHECKPOINT_SUFFIX,
+            source.binary_file_name,
+            source.binary_file_name + Q_JOURNAL_FILE_SUFFIX,
+            source.binary_file_name + Q_JOURNAL_FILE_SUFFIX + Q_JOURNAL_CHECKPOINT_SUFFIX
+        };
+        const int file_count = sizeof(file_names) / sizeof(file_names[0]);
+
+        file_stamps.resize(file_count);
+        for(int i = 0; i < file_count; i++)
+        {
+            get_file_stamp(file_names[i], (i == 3), file_stamps[i]);
+        }
+    }
+
+
+    /**
+     *  Constructor
+     **/
+    Q_table_cache::Q_table_cache()
+    {
+        m_memory_budget = 0;
+        m_use_counter = 0;
+        m_is_preloading = 0;
+
+        pthread_mutex_init(&m_mutex, NULL);
+        pthread_cond_init(&m_table_loaded, NULL);
+    }
+
+
+    /**
+     *  Destructor
+     **/
+    Q_table_cache::~Q_table_cache()
+    {
+        wait_for_preload();
+
+        for(std::map<std::string, Q_table_entry>::iterator it = m_entries.begin();
+                it != m_entries.end(); ++it)
+        {
+            delete it->second.table;
+        }
+        m_entries.clear();
+
+        for(size_t i = 0; i < m_replaced_tables.size(); i++)
+        {
+            delete m_replaced_tables[i];
+        }
+        m_replaced_tables.clear();
+
+        pthread_cond_destroy(&m_table_loaded);
+        pthread_mutex_destroy(&m_mutex);
+    }
+
+
+    /**
+     *  Sets the memory budget of all the tables together ( 0 for no limit ).
+     **/
+    void Q_table_cache::set_memory_budget(const size_t t_memory_budget)
+    {
+        pthread_mutex_lock(&m_mutex);
+        m_memory_budget = t_memory_budget;
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+
+    /**
+     *  Returns Q table of the given track ( loads it if needed ).
+     **/
+    Q_maps * Q_table_cache::get_table(const Q_table_source & source)
+    {
+        pthread_mutex_lock(&m_mutex);
+        const int needs_load = begin_load(source);
+        pthread_mutex_unlock(&m_mutex);
+
+        if(needs_load)
+        {
+            load(source);
+        }
+        else
+        {
+            printf("using cached Q table of track \'%s\'\n", source.track_name.c_str());
+        }
+
+        pthread_mutex_lock(&m_mutex);
+
+        Q_table_entry & entry = m_entries[source.track_name];
+        entry.last_use = ++m_use_counter;
+        m_current_track_name = source.track_name;
+        Q_maps * table = entry.table;
+
+        // tables replaced while they were current are not used any more
+        for(size_t i = 0; i < m_replaced_tables.size(); i++)
+        {
+            delete m_replaced_tables[i];
+        }
+        m_replaced_tables.clear();
+
+        remove_tables_over_budget();
+
+        pthread_mutex_unlock(&m_mutex);
+
+        return table;
+    }
+
+
+    /**
+     *  Starts loading Q table of the given track in a background thread.
+     **/
+    void Q_table_cache::preload_table(const Q_table_source & source)
+    {
+        wait_for_preload();
+
+        pthread_mutex_lock(&m_mutex);
+        const int needs_load = begin_load(source);
+        pthread_mutex_unlock(&m_mutex);
+
+        if(!needs_load)
+        {
+            return;
+        }
+
+        m_preload_source = source;
+        if(pthread_create(&m_preload_thread, NULL, run_preload, this) == 0)
+        {
+            m_is_preloading = 1;
+        }
+        else
+        {
+            // load it now if thread couldn't be started
+            puts("couldn't start thread for loading Q table");
+            load(source);
+        }
+    }
+
+
+    /**
+     *  Returns approximate bytes of memory used by all the tables.
+     **/
+    size_t Q_table_cache::get_memory_footprint()
+    {
+        size_t memory_footprint = 0;
+
+        pthread_mutex_lock(&m_mutex);
+        for(std::map<std::string, Q_table_entry>::const_iterator it = m_entries.begin();
+                it != m_entries.end(); ++it)
+        {
+            if(it->second.table != NULL)
+            {
+                memory_footprint += it->second.table->get_memory_footprint();
+            }
+        }
+        pthread_mutex_unlock(&m_mutex);
+
+        return memory_footprint;
+    }
+
+
+    /**
+     *  Thread function for background load.
+     **/
+    void * Q_table_cache::run_preload(void * t_cache)
+    {
+        Q_table_cache * cache = (Q_table_cache *) t_cache;
+        cache->load(cache->m_preload_source);
+
+        return NULL;
+    }
+
+
+    /**
+     *  Returns non-zero if the entry is loaded from same source and its files
+     *  have not changed since then.
+     **/
+    int Q_table_cache::is_up_to_date(const Q_table_entry & entry,
+            const Q_table_source & source) const
+    {
+        if(entry.table == NULL || !is_same_source(entry.source, source))
+        {
+            return 0;
+        }
+
+        std::vector<Q_file_stamp> file_stamps;
+        get_Q_file_stamps(source, file_stamps);
+
+        for(size_t i = 0; i < file_stamps.size(); i++)
+        {
+            if(!is_same_stamp(file_stamps[i], entry.file_stamps[i]))
+            {
+                return 0;
+            }
+        }
+
+        return 1;
+    }
+
+
+    /**
+     *  Marks entry of the source as being loaded if it needs to be loaded.
+     **/
+    int Q_table_cache::begin_load(const Q_table_source & source)
+    {
+        Q_table_entry & entry = m_entries[source.track_name];
+
+        while(entry.is_loading)
+        {
+            pthread_cond_wait(&m_table_loaded, &m_mutex);
+        }
+
+        if(is_up_to_date(entry, source))
+        {
+            return 0;
+        }
+
+        // table of a track that is raced again is replaced ( files have changed ).
+        // Current table may still be used ( e.g. by Q_maps_storage ) until next
+        // "get_table", so it is deleted then.
+        if(entry.table != NULL)
+        {
+            printf("Q value files of track \'%s\' have changed\n", source.track_name.c_str());
+            if(m_current_track_name == source.track_name)
+            {
+                m_current_track_name.clear();
+                m_replaced_tables.push_back(entry.table);
+            }
+            else
+            {
+                delete entry.table;
+            }
+            entry.table = NULL;
+        }
+
+        entry.is_loading = 1;
+
+        return 1;
+    }
+
+
+    /**
+     *  Loads table of the source and adds it to the cache.
+     **/
+    void Q_table_cache::load(const Q_table_source & source)
+    {
+        // stamps are taken before loading, so a file that changes while
+        // it is being loaded makes the table out of date
+        std::vector<Q_file_stamp> file_stamps;
+        get_Q_file_stamps(source, file_stamps);
+
+        Q_maps * table = load_table(source);
+
+        pthread_mutex_lock(&m_mutex);
+
+        Q_table_entry & entry = m_entries[source.track_name];
+        entry.table = table;
+        entry.is_loading = 0;
+        entry.source = source;
+        entry.file_stamps.swap(file_stamps);
+        entry.last_use = ++m_use_counter;
+
+        pthread_cond_broadcast(&m_table_loaded);
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+
+    /**
+     *  Removes least recently used tables while tables take more memory
+     *  than the budget.
+     **/
+    void Q_table_cache::remove_tables_over_budget()
+    {
+        if(m_memory_budget == 0)
+        {
+            return;
+        }
+
+        while(1)
+        {
+            size_t memory_footprint = 0;
+            std::map<std::string, Q_table_entry>::iterator least_recently_used =
+                m_entries.end();
+
+            for(std::map<std::string, Q_table_entry>::iterator it = m_entries.begin();
+                    it != m_entries.end(); ++it)
+            {
+                if(it->second.table == NULL)
+                {
+                    continue;
+                }
+
+                memory_footprint += it->second.table->get_memory_footprint();
+
+                if(it->first != m_current_track_name && (least_recently_used ==
+                            m_entries.end() ||
+                            it->second.last_use < least_recently_used->second.last_use))
+                {
+                    least_recently_used = it;
+                }
+            }
+
+            if(memory_footprint <= m_memory_budget ||
+                    least_recently_used == m_entries.end())
+            {
+                return;
+            }
+
+            printf("removing cached Q table of track \'%s\'\n",
+                    least_recently_used->first.c_str());
+            delete least_recently_used->second.table;
+            m_entries.erase(least_recently_used);
+        }
+    }
+
+
+    /**
+     *  Waits for background load ( if any ).
+     **/
+    void Q_table_cache::wait_for_preload()
+    {
+        if(m_is_preloading)
+        {
+            pthread_join(m_preload_thread, NULL);
+            m_is_preloading = 0;
+        }
+    }
+
+}
+
@@ -0,0 +1,244 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * car222_Q_table_cache.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  CAR222_Q_TABLE_CACHE_H_
+#define  CAR222_Q_TABLE_CACHE_H_
+
+
+#include <pthread.h>
+#include <string>
+#include <map>
+#include <vector>
+
+#include "car222_Q_maps.h"
+
+
+namespace controller_storage
+{
+
+    /**
+     * everything needed for loading the Q table of a track. It only has
+     * values ( no functions of the robot ), so a table can be loaded in
+     * background even after the robot module is unloaded.
+     **/
+    typedef struct Q_table_source_struct
+    {
+
+        // name of the track ( key of the table in cache )
+        std::string track_name;
+
+        // Q value files of the track
+        std::string text_file_name;
+        std::string binary_file_name;
+        // non-zero if binary file is loaded when it exists ( else text file )
+        int use_binary_file;
+
+        // ids checked against binary file ( see "Q_maps::set_version_ids" )
+        std::string Q_learner_id;
+        std::string reward_id;
+        std::string fuzzy_controller_version;
+
+        // non-zero if states within "dense_bounds" are kept in a dense table
+        int use_dense_table;
+        Q_dense_bounds dense_bounds;
+
+    } Q_table_source;
+
+
+    /**
+     * identity of a Q value file ( or journal ) when its table was loaded
+     **/
+    typedef struct Q_file_stamp_struct
+    {
+
+        // non-zero if the file exists
+        int exists;
+        // modification time ( in nanoseconds ), size and inode of the file
+        long long int modification_time;
+        long long int size;
+        unsigned long long int inode;
+        // checksum of header of a binary Q value file ( 0 for other files )
+        unsigned long long int header_checksum;
+
+    } Q_file_stamp;
+
+
+    /*
+     * ==========================================================================
+     *        Class:  Q_table_cache
+     *  Description:  Keeps Q tables ( Q_maps ) of tracks that have been loaded,
+     *                so racing on a track again does not load its Q value file
+     *                again. A table is loaded again only when its Q value files
+     *                ( or their journals ) have changed, i.e. their modification
+     *                time, size or binary file header is not the same.
+     *
+     *                Tables that were used least recently are removed when all
+     *                the tables together take more memory than the memory budget
+     *                ( the table in use is never removed ).
+     *
+     *                A table can be loaded in a background thread ( "preload_table" )
+     *                and "get_table" waits for it if it is still being loaded.
+     * ===========================================================================
+     */
+    class Q_table_cache
+    {
+        public :
+
+            /** MEMBER FUNCTIONS **/
+
+            Q_table_cache();
+
+            ~Q_table_cache();
+
+            /**
+             * sets the memory budget ( in bytes ) of all the tables together
+             * ( 0 for no limit, which is the default )
+             **/
+            void set_memory_budget(const size_t t_memory_budget);
+
+            /**
+             * returns Q table of the given track. It is loaded if it is not in
+             * the cache or if its files have changed since it was loaded. Returned
+             * table is owned by the cache and stays valid until "get_table" is
+             * called again ( a table that is replaced because its files have
+             * changed is kept until then, as it may still be in use ).
+             **/
+            Q_maps * get_table(const Q_table_source & source);
+
+            /**
+             * starts loading Q table of the given track in a background thread,
+             * unless it is already in the cache and is up to date.
+             * A previous background load is waited for first.
+             **/
+            void preload_table(const Q_table_source & source);
+
+            /* returns approximate bytes of memory used by all the tables */
+            size_t get_memory_footprint();
+
+
+        private :
+
+            /**
+             * a Q table in the cache
+             **/
+            typedef struct Q_table_entry_struct
+            {
+
+                // Q table ( NULL while it is being loaded )
+                Q_maps * table;
+                // non-zero while it is being loaded
+                int is_loading;
+                // source and stamps of its files when it was loaded
+                Q_table_source source;
+                std::vector<Q_file_stamp> file_stamps;
+                // value of "m_use_counter" when it was last used
+                unsigned long long int last_use;
+
+            } Q_table_entry;
+
+
+            /** MEMBER VARIABLES **/
+
+            /* tables by track name */
+            std::map<std::string, Q_table_entry> m_entries;
+
+            /* track whose table was returned by "get_table" last time */
+            std::string m_current_track_name;
+
+            /**
+             * tables replaced while they were current ( their files changed ).
+             * They are deleted by next "get_table", when they are no longer used.
+             **/
+            std::vector<Q_maps *> m_replaced_tables;
+
+            /* memory budget of all the tables together ( 0 for no limit ) */
+            size_t m_memory_budget;
+
+            /* counts uses of tables ( for finding least recently used table ) */
+            unsigned long long int m_use_counter;
+
+            /* guards entries, signals when a table has been loaded */
+            pthread_mutex_t m_mutex;
+            pthread_cond_t m_table_loaded;
+
+            /* background thread loading a table and the source it loads */
+            pthread_t m_preload_thread;
+            int m_is_preloading;
+            Q_table_source m_preload_source;
+
+
+            /** MEMBER FUNCTIONS **/
+
+            /* thread function for background load ( argument is the cache ) */
+            static void * run_preload(void * t_cache);
+
+            /**
+             * returns non-zero if the given entry is loaded from same source and
+             * its files have not changed since then ( "m_mutex" should be locked )
+             **/
+            int is_up_to_date(const Q_table_entry & entry,
+                    const Q_table_source & source) const;
+
+            /**
+             * marks entry of the source as being loaded if it is not in the cache
+             * or is out of date and returns non-zero, else returns 0 ( "m_mutex"
+             * should be locked ). It waits while the table is being loaded.
+             **/
+            int begin_load(const Q_table_source & source);
+
+            /* loads table of the source and adds it to the cache ( after "begin_load" ) */
+            void load(const Q_table_source & source);
+
+            /**
+             * removes least recently used tables ( except the current table ) while
+             * tables take more memory than the budget ( "m_mutex" should be locked )
+             **/
+            void remove_tables_over_budget();
+
+            /* waits for background load ( if any ) */
+            void wait_for_preload();
+
+            // restricted copy constructor
+            Q_table_cache(const Q_table_cache &other) = delete;
+
+            // restricted assignment operator
+            Q_table_cache& operator=(const Q_table_cache &other) = delete;
+
+    };
+
+
+    /**
+     * fills stamps of the Q value files of the given source and their journals
+     **/
+    void get_Q_file_stamps(const Q_table_source & source,
+            std::vector<Q_file_stamp> & file_stamps);
+
+}
+
+
+#endif      /* ifndef CAR222_Q_TABLE_CACHE_H_ */
+
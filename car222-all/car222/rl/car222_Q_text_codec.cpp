@@ -0,0 +1,884 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * car222_Q_text_codec.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "car222_string_formats.h"
+#include "car222_Q_text_codec.h"
+
+
+/* exact powers of 10 in double ( for parsing decimal numbers ) */
+static const double powers_of_10[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// largest number of significant digits that are exact in a double
+#define EXACT_DIGITS 15
+
+
+/**
+ * parses a signed integer ( as "%d" ) at "position" and moves "position"
+ * after it. Returns 0 on success, else -1.
+ **/
+static inline int parse_int(const char * & position, const char * end, int & value)
+{
+    const char * character = position;
+
+    int negative = 0;
+    if(character < end && (*character == '+' || *character == '-'))
+    {
+        negative = (*character == '-');
+        character++;
+    }
+
+    int digits = 0;
+    long magnitude = 0;
+    while(character < end && *character >= '0' && *character <= '9')
+    {
+        // much larger than any value of a state
+        if(++digits > 9)
+        {
+            return -1;
+        }
+
+        magnitude = magnitude * 10 + (*character - '0');
+        character++;
+    }
+
+    if(digits == 0)
+    {
+        return -1;
+    }
+
+    value = (int) (negative ? -magnitude : magnitude);
+    position = character;
+    return 0;
+}
+
+
+/**
+ * parses a float ( as "%f" ) at "position" with strtof and moves "position"
+ * after it. Returns 0 on success, else -1.
+ **/
+static int parse_float_with_strtof(const char * & position, const char * end, float & value)
+{
+    // copy the number, as a mapped file is not null terminated
+    char number[64];
+    size_t length = 0;
+    while(position + length < end && length < sizeof(number) - 1 &&
+            position[length] != '|' && position[length] != '=' && position[length] != '\n')
+    {
+        number[length] = position[length];
+        length++;
+    }
+    number[length] = '\0';
+
+    char * number_end = NULL;
+    value = strtof(number, &number_end);
+    if(number_end == number)
+    {
+        return -1;
+    }
+
+    position += number_end - number;
+    return 0;
+}
+
+
+/**
+ * parses a float ( as "%f" ) at "position" and moves "position" after it.
+ * Returns 0 on success, else -1.
+ *
+ * Digits of a decimal number with at most EXACT_DIGITS significant digits are
+ * an exact integer in a double and dividing it by an exact power of 10 gives
+ * the correctly rounded double of the number. Rounding that double to float
+ * gives the same float as strtof, unless the double is exactly halfway between
+ * two floats. Such numbers ( and numbers in any other form ) are left to strtof.
+ **/
+static inline int parse_float(const char * & position, const char * end, float & value)
+{
+    const char * character = position;
+
+    int negative = 0;
+    if(character < end && (*character == '+' || *character == '-'))
+    {
+        negative = (*character == '-');
+        character++;
+    }
+
+    unsigned long long int mantissa = 0;
+    int digits = 0;
+    int significant_digits = 0;
+    int fraction_digits = 0;
+    int in_fraction = 0;
+    for(; character < end; character++)
+    {
+        if(*character >= '0' && *character <= '9')
+        {
+            mantissa = mantissa * 10 + (*character - '0');
+            digits++;
+            fraction_digits += in_fraction;
+            significant_digits += (mantissa != 0);
+            if(significant_digits > EXACT_DIGITS)
+            {
+                return parse_float_with_strtof(position, end, value);
+            }
+        }
+        else if(*character == '.' && !in_fraction)
+        {
+            in_fraction = 1;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    // no digits ( "nan", "inf" ... ), an exponent or too many fraction digits
+    if(digits == 0 || fraction_digits >= (int) (sizeof(powers_of_10) / sizeof(double)) ||
+            (character < end && (*character == 'e' || *character == 'E' ||
+                                 *character == 'x' || *character == 'X')))
+    {
+        return parse_float_with_strtof(position, end, value);
+    }
+
+    const double number = (double) mantissa / powers_of_10[fraction_digits];
+    float rounded_number = (float) number;
+
+    if((double) rounded_number != number)
+    {
+        // check if the double is halfway between two floats
+        const float next_float = nextafterf(rounded_number,
+                (number > rounded_number) ? HUGE_VALF : -HUGE_VALF);
+        if(isinf(rounded_number) ||
+                ((double) rounded_number + (double) next_float) * 0.5 == number)
+        {
+            return parse_float_with_strtof(position, end, value);
+        }
+    }
+
+    value = negative ? -rounded_number : rounded_number;
+    position = character;
+    return 0;
+}
+
+
+/* moves "position" after the given character if it is there, else returns -1 */
+static inline int skip_character(const char * & position, const char * end,
+        const char character)
+{
+    if(position == end || *position != character)
+    {
+        return -1;
+    }
+
+    position++;
+    return 0;
+}
+
+
+/**
+ * parses a line with sscanf ( see MAP_READ_FORMAT ) like older versions of
+ * Q_maps did. It is used for lines that don't have the layout written by
+ * MAP_WRITE_FORMAT. Returns 0 on success, else -1.
+ **/
+static int scan_Q_text_line(const char * line, const char * line_end,
+        int & speed_x, float & speed_y,
+        int & right_side_distance, int & left_side_distance,
+        float & path, float & next_path, float & accel, float & Q_value)
+{
+    // copy the line, as a mapped file is not null terminated
+    char line_copy[128];
+    const size_t length = line_end - line;
+    if(length >= sizeof(line_copy))
+    {
+        return -1;
+    }
+    memcpy(line_copy, line, length);
+    line_copy[length] = '\0';
+
+    // scan line as fixed length map key (state and action) and Q value
+    char state_name[STATE_NAME_LENGTH + 1];
+    char action_name[ACTION_NAME_LENGTH + 1];
+    if(sscanf(line_copy, MAP_READ_FORMAT, state_name, action_name, &Q_value) != 3)
+    {
+        return -1;
+    }
+
+    // append null character to char arrays
+    state_name[STATE_NAME_LENGTH] = '\0';
+    action_name[ACTION_NAME_LENGTH] = '\0';
+
+    // scan values of state and action
+    if(sscanf(state_name, STATE_READ_FORMAT, &speed_x, &speed_y,
+                &right_side_distance, &left_side_distance, &path, &next_path) != 6 ||
+            sscanf(action_name, ACTION_READ_FORMAT, &accel) != 1)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+
+int controller_storage::parse_Q_text_line(const char * line, const char * line_end,
+        Q_state_key & state_key, Q_action_index & action_index, float & Q_value)
+{
+    int speed_x, right_side_distance, left_side_distance;
+    float speed_y, path, next_path, accel;
+
+    // fields are in the order of MAP_WRITE_FORMAT
+    const char * position = line;
+    if(parse_int(position, line_end, speed_x) != 0 ||
+            skip_character(position, line_end, '|') != 0 ||
+            parse_float(position, line_end, speed_y) != 0 ||
+            skip_character(position, line_end, '|') != 0 ||
+            parse_int(position, line_end, right_side_distance) != 0 ||
+            skip_character(position, line_end, '|') != 0 ||
+            parse_int(position, line_end, left_side_distance) != 0 ||
+            skip_character(position, line_end, '|') != 0 ||
+            parse_float(position, line_end, path) != 0 ||
+            skip_character(position, line_end, '|') != 0 ||
+            parse_float(position, line_end, next_path) != 0 ||
+            skip_character(position, line_end, '|') != 0 ||
+            parse_float(position, line_end, accel) != 0 ||
+            skip_character(position, line_end, '=') != 0 ||
+            parse_float(position, line_end, Q_value) != 0)
+    {
+        if(scan_Q_text_line(line, line_end, speed_x, speed_y,
+                    right_side_distance, left_side_distance,
+                    path, next_path, accel, Q_value) != 0)
+        {
+            return -1;
+        }
+    }
+
+    state_key = make_Q_state_key(speed_x, speed_y,
+            right_side_distance, left_side_distance, path, next_path);
+    action_index = make_Q_action_index(accel);
+    return 0;
+}
+
+
+void controller_storage::find_max_Q(Q_state_record & state_record)
+{
+    int max_found = 0;
+    state_record.max_Q_value = 0;
+    state_record.max_Q_action = 0;
+
+    for(int i = 0; i < Q_ACTION_SPACE_SIZE; i++)
+    {
+        if( (state_record.tried_actions & (1u << i)) &&
+                (!max_found || state_record.Q_values[i] > state_record.max_Q_value) )
+        {
+            state_record.max_Q_value = state_record.Q_values[i];
+            state_record.max_Q_action = (Q_action_index) i;
+            max_found = 1;
+        }
+    }
+}
+
+
+/* orders file records by state key */
+static inline bool is_record_less(const controller_storage::Q_file_record & record_1,
+        const controller_storage::Q_file_record & record_2)
+{
+    return record_1.state_key < record_2.state_key;
+}
+
+
+/**
+ * runs "function" for each of "count" arguments ( of "argument_size" bytes
+ * each, starting at "arguments" ) in its own thread and waits for all of them.
+ * First argument is run in the calling thread, and so are the arguments whose
+ * thread couldn't be started.
+ **/
+static void run_in_threads(void * (*function)(void *), void * arguments,
+        const size_t argument_size, const int count)
+{
+    std::vector<pthread_t> threads(count);
+    std::vector<int> started(count, 0);
+
+    for(int i = 1; i < count; i++)
+    {
+        started[i] = pthread_create(&threads[i], NULL, function,
+                (char *) arguments + i * argument_size) == 0;
+    }
+
+    for(int i = 0; i < count; i++)
+    {
+        if(!started[i])
+        {
+            function((char *) arguments + i * argument_size);
+        }
+    }
+
+    for(int i = 1; i < count; i++)
+    {
+        if(started[i])
+        {
+            pthread_join(threads[i], NULL);
+        }
+    }
+}
+
+
+/* returns number of threads to use for work of given size */
+static int get_thread_count(const size_t size)
+{
+    long thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+    if(thread_count > Q_TEXT_MAX_THREADS)
+    {
+        thread_count = Q_TEXT_MAX_THREADS;
+    }
+    if(thread_count > (long) (size / Q_TEXT_MIN_CHUNK_SIZE))
+    {
+        thread_count = (long) (size / Q_TEXT_MIN_CHUNK_SIZE);
+    }
+
+    return (thread_count < 1) ? 1 : (int) thread_count;
+}
+
+
+/**
+ * a chunk of text Q value file ( whole lines ) that is parsed by one thread
+ **/
+typedef struct Q_text_chunk_struct
+{
+
+    // first character of the chunk and character after its end
+    const char * begin;
+    const char * end;
+
+    // records of each shard in the order their states appear in the chunk
+    std::vector<controller_storage::Q_file_record>
+        shard_records[Q_BINARY_SHARDS];
+
+    // "stats" line if it is in this chunk ( else NULL )
+    const char * stats_line;
+
+    // number of lines with Q values and lines that couldn't be parsed
+    long long int line_count;
+    long long int skipped_line_count;
+
+} Q_text_chunk;
+
+
+/* thread function that parses lines of a chunk ( Q_text_chunk * ) */
+static void * parse_Q_text_chunk(void * t_chunk)
+{
+    using namespace controller_storage;
+
+    Q_text_chunk & chunk = *((Q_text_chunk *) t_chunk);
+
+    const char * line = chunk.begin;
+    while(line < chunk.end)
+    {
+        const char * line_end = (const char *) memchr(line, '\n', chunk.end - line);
+        if(line_end == NULL)
+        {
+            line_end = chunk.end;
+        }
+
+        // Q values end with "stats" line
+        if(*line == 's')
+        {
+            chunk.stats_line = line;
+            break;
+        }
+
+        Q_state_key state_key;
+        Q_action_index action_index;
+        float Q_value;
+        if(parse_Q_text_line(line, line_end, state_key, action_index, Q_value) == 0)
+        {
+            std::vector<Q_file_record> & shard_records = chunk.shard_records[
+                get_Q_shard_for(speed_x_dimension::magnitude(state_key))];
+
+            // lines of a state are usually next to each other, so a record is
+            // added only when state changes ( duplicates are merged later )
+            if(shard_records.empty() || shard_records.back().state_key != state_key)
+            {
+                Q_file_record file_record;
+                memset(&file_record, 0, sizeof(file_record));
+                file_record.state_key = state_key;
+                shard_records.push_back(file_record);
+            }
+
+            Q_state_record & state_record = shard_records.back().state_record;
+            state_record.Q_values[action_index] = Q_value;
+            state_record.tried_actions |= (1u << action_index);
+
+            chunk.line_count++;
+        }
+        else
+        {
+            chunk.skipped_line_count++;
+        }
+
+        line = line_end + 1;
+    }
+
+    return NULL;
+}
+
+
+/**
+ * shards of chunks that are merged by one thread. A thread merges every
+ * "shard_step"-th shard starting from "first_shard".
+ **/
+typedef struct Q_text_merge_struct
+{
+
+    Q_text_chunk * chunks;
+    int chunk_count;
+    int first_shard;
+    int shard_step;
+    controller_storage::Q_text_contents * contents;
+
+} Q_text_merge;
+
+
+/**
+ * thread function ( Q_text_merge * ) that joins records of a shard from all
+ * the chunks, sorts them by state key, merges records of the same state ( Q
+ * value of a later line is used ) and finds max Q value of each record
+ **/
+static void * merge_Q_text_shards(void * t_merge)
+{
+    using namespace controller_storage;
+
+    Q_text_merge & merge = *((Q_text_merge *) t_merge);
+
+    for(int shard = merge.first_shard; shard < Q_BINARY_SHARDS; shard += merge.shard_step)
+    {
+        std::vector<Q_file_record> & records = merge.contents->shard_records[shard];
+
+        size_t record_count = 0;
+        for(int i = 0; i < merge.chunk_count; i++)
+        {
+            record_count += merge.chunks[i].shard_records[shard].size();
+        }
+
+        records.clear();
+        records.reserve(record_count);
+        for(int i = 0; i < merge.chunk_count; i++)
+        {
+            std::vector<Q_file_record> & chunk_records = merge.chunks[i].shard_records[shard];
+            records.insert(records.end(), chunk_records.begin(), chunk_records.end());
+            std::vector<Q_file_record>().swap(chunk_records);
+        }
+
+        // files written by Q_maps are already sorted
+        if(!std::is_sorted(records.begin(), records.end(), is_record_less))
+        {
+            // stable, so that later lines of a state are merged after earlier ones
+            std::stable_sort(records.begin(), records.end(), is_record_less);
+        }
+
+        // merge records of same state
+        size_t last = 0;
+        for(size_t i = 1; i < records.size(); i++)
+        {
+            if(records[i].state_key != records[last].state_key)
+            {
+                records[++last] = records[i];
+                continue;
+            }
+
+            Q_state_record & state_record = records[last].state_record;
+            const Q_state_record & later_record = records[i].state_record;
+            for(int action = 0; action < Q_ACTION_SPACE_SIZE; action++)
+            {
+                if(later_record.tried_actions & (1u << action))
+                {
+                    state_record.Q_values[action] = later_record.Q_values[action];
+                }
+            }
+            state_record.tried_actions |= later_record.tried_actions;
+        }
+        if(!records.empty())
+        {
+            records.resize(last + 1);
+        }
+
+        // max Q value is found once for each state
+        for(size_t i = 0; i < records.size(); i++)
+        {
+            find_max_Q(records[i].state_record);
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * reads training counter from the line after "stats" line ( if there is one )
+ **/
+static void read_stats(const char * stats_line, const char * end,
+        controller_storage::Q_text_contents & contents)
+{
+    if(end - stats_line < 5 || memcmp(stats_line, "stats", 5) != 0)
+    {
+        return;
+    }
+
+    const char * counter_line = (const char *) memchr(stats_line, '\n', end - stats_line);
+    if(counter_line == NULL || counter_line + 1 == end)
+    {
+        puts("error reading stats training counter line");
+        return;
+    }
+    counter_line++;
+
+    // copy the line, as a mapped file is not null terminated
+    char counter[32];
+    size_t length = 0;
+    while(counter_line + length < end && length < sizeof(counter) - 1 &&
+            counter_line[length] != '\n')
+    {
+        counter[length] = counter_line[length];
+        length++;
+    }
+    counter[length] = '\0';
+
+    contents.has_stats = (sscanf(counter, "%lld", &contents.training_counter) == 1);
+}
+
+
+int controller_storage::read_Q_text_file(const char * file_name, Q_text_contents & contents)
+{
+    for(int shard = 0; shard < Q_BINARY_SHARDS; shard++)
+    {
+        contents.shard_records[shard].clear();
+    }
+    contents.has_stats = 0;
+    contents.training_counter = 0;
+    contents.line_count = 0;
+    contents.skipped_line_count = 0;
+
+    const int file_descriptor = open(file_name, O_RDONLY);
+    if(file_descriptor < 0)
+    {
+        return -1;
+    }
+
+    struct stat file_status;
+    if(fstat(file_descriptor, &file_status) != 0)
+    {
+        close(file_descriptor);
+        return -1;
+    }
+
+    const size_t file_size = (size_t) file_status.st_size;
+    if(file_size == 0)
+    {
+        close(file_descriptor);
+        return 0;
+    }
+
+    void * mapped_file = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    close(file_descriptor);
+    if(mapped_file == MAP_FAILED)
+    {
+        return -1;
+    }
+    madvise(mapped_file, file_size, MADV_SEQUENTIAL);
+
+    const char * text = (const char *) mapped_file;
+    const char * text_end = text + file_size;
+
+    // split file at line boundaries into a chunk for each thread
+    const int chunk_count = get_thread_count(file_size);
+    std::vector<Q_text_chunk> chunks(chunk_count);
+    for(int i = 0; i < chunk_count; i++)
+    {
+        Q_text_chunk & chunk = chunks[i];
+        chunk.begin = (i == 0) ? text : chunks[i - 1].end;
+        chunk.end = text_end;
+        if(i < chunk_count - 1)
+        {
+            const char * split = text + file_size / chunk_count * (i + 1);
+            if(split < chunk.begin)
+            {
+                split = chunk.begin;
+            }
+            const char * line_end = (const char *) memchr(split, '\n', text_end - split);
+            if(line_end != NULL)
+            {
+                chunk.end = line_end + 1;
+            }
+        }
+        chunk.stats_line = NULL;
+        chunk.line_count = 0;
+        chunk.skipped_line_count = 0;
+    }
+
+    run_in_threads(parse_Q_text_chunk, &chunks[0], sizeof(Q_text_chunk), chunk_count);
+
+    // lines after the first "stats" line are not used
+    int used_chunk_count = chunk_count;
+    for(int i = 0; i < chunk_count; i++)
+    {
+        contents.line_count += chunks[i].line_count;
+        contents.skipped_line_count += chunks[i].skipped_line_count;
+
+        if(chunks[i].stats_line != NULL)
+        {
+            read_stats(chunks[i].stats_line, text_end, contents);
+            used_chunk_count = i + 1;
+            break;
+        }
+    }
+
+    // merge shards of chunks
+    std::vector<Q_text_merge> merges(chunk_count);
+    for(int i = 0; i < chunk_count; i++)
+    {
+        merges[i].chunks = &chunks[0];
+        merges[i].chunk_count = used_chunk_count;
+        merges[i].first_shard = i;
+        merges[i].shard_step = chunk_count;
+        merges[i].contents = &contents;
+    }
+
+    run_in_threads(merge_Q_text_shards, &merges[0], sizeof(Q_text_merge), chunk_count);
+
+    munmap(mapped_file, file_size);
+
+    if(contents.skipped_line_count > 0)
+    {
+        printf("skipped %lld lines that couldn't be read\n", contents.skipped_line_count);
+    }
+
+    return 0;
+}
+
+
+// number of shards that can be formatted ahead of the shard being written
+#define Q_TEXT_WRITE_AHEAD (2 * Q_TEXT_MAX_THREADS)
+
+/**
+ * state of writing a text Q value file. Threads take shards in order and
+ * format their lines, while the calling thread writes formatted shards to
+ * the file in order.
+ **/
+typedef struct Q_text_writer_struct
+{
+
+    // records of each shard
+    const std::vector<controller_storage::Q_file_record> * shard_records;
+
+    // formatted lines of each shard and whether they are ready
+    std::string shard_lines[Q_BINARY_SHARDS];
+    int is_formatted[Q_BINARY_SHARDS];
+
+    // next shard to be formatted and next shard to be written
+    int next_shard_to_format;
+    int next_shard_to_write;
+
+    // "action=" part of the line for each action
+    char action_names[Q_ACTION_SPACE_SIZE][16];
+
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+
+} Q_text_writer;
+
+
+/* formats lines of tried actions of each record ( see MAP_WRITE_FORMAT ) */
+static void format_Q_text_lines(const Q_text_writer & writer,
+        const std::vector<controller_storage::Q_file_record> & records,
+        std::string & lines)
+{
+    using namespace controller_storage;
+
+    // a line is less than 64 characters
+    lines.reserve(records.size() * 64 * 2);
+
+    char state_name[64];
+    char Q_value_text[32];
+    for(size_t i = 0; i < records.size(); i++)
+    {
+        const Q_state_record & state_record = records[i].state_record;
+
+        // state part is same for all the lines of a state
+        int speed_x, right_side_distance, left_side_distance;
+        float speed_y, path, next_path;
+        read_Q_state_key(records[i].state_key, speed_x, speed_y,
+                right_side_distance, left_side_distance, path, next_path);
+        const int state_name_length = snprintf(state_name, sizeof(state_name),
+                STATE_PRINT_FORMAT "|", speed_x, speed_y,
+                right_side_distance, left_side_distance, path, next_path);
+
+        for(int action = 0; action < Q_ACTION_SPACE_SIZE; action++)
+        {
+            if(state_record.tried_actions & (1u << action))
+            {
+                const int Q_value_length = snprintf(Q_value_text, sizeof(Q_value_text),
+                        "%+012f\n", state_record.Q_values[action]);
+
+                lines.append(state_name, state_name_length);
+                lines.append(writer.action_names[action]);
+                lines.append(Q_value_text, Q_value_length);
+            }
+        }
+    }
+}
+
+
+/* thread function that formats shards of a writer ( Q_text_writer * ) */
+static void * format_Q_text_shards(void * t_writer)
+{
+    Q_text_writer & writer = *((Q_text_writer *) t_writer);
+
+    pthread_mutex_lock(&writer.mutex);
+    while(writer.next_shard_to_format < Q_BINARY_SHARDS)
+    {
+        const int shard = writer.next_shard_to_format;
+
+        // don't format too far ahead of writing
+        if(shard >= writer.next_shard_to_write + Q_TEXT_WRITE_AHEAD)
+        {
+            pthread_cond_wait(&writer.condition, &writer.mutex);
+            continue;
+        }
+        writer.next_shard_to_format++;
+        pthread_mutex_unlock(&writer.mutex);
+
+        std::string lines;
+        format_Q_text_lines(writer, writer.shard_records[shard], lines);
+
+        pthread_mutex_lock(&writer.mutex);
+        writer.shard_lines[shard].swap(lines);
+        writer.is_formatted[shard] = 1;
+        pthread_cond_broadcast(&writer.condition);
+    }
+    pthread_mutex_unlock(&writer.mutex);
+
+    return NULL;
+}
+
+
+int controller_storage::write_Q_text_file(FILE * t_Q_value_file,
+        const std::vector<Q_file_record> * shard_records,
+        const long long int training_counter)
+{
+    Q_text_writer writer;
+    writer.shard_records = shard_records;
+    writer.next_shard_to_format = 0;
+    writer.next_shard_to_write = 0;
+    for(int shard = 0; shard < Q_BINARY_SHARDS; shard++)
+    {
+        writer.is_formatted[shard] = 0;
+    }
+    for(int action = 0; action < Q_ACTION_SPACE_SIZE; action++)
+    {
+        snprintf(writer.action_names[action], sizeof(writer.action_names[action]),
+                ACTION_PRINT_FORMAT "=", get_Q_action_value((Q_action_index) action));
+    }
+    pthread_mutex_init(&writer.mutex, NULL);
+    pthread_cond_init(&writer.condition, NULL);
+
+    size_t record_count = 0;
+    for(int shard = 0; shard < Q_BINARY_SHARDS; shard++)
+    {
+        record_count += shard_records[shard].size();
+    }
+
+    // threads format shards, assuming about 64 bytes for a record
+    const int thread_count = get_thread_count(record_count * 64);
+    std::vector<pthread_t> threads(thread_count);
+    int started_thread_count = 0;
+    for(int i = 0; i < thread_count; i++)
+    {
+        if(pthread_create(&threads[started_thread_count], NULL,
+                    format_Q_text_shards, &writer) == 0)
+        {
+            started_thread_count++;
+        }
+    }
+
+    // write shards in order as they are formatted
+    int write_error = 0;
+    for(int shard = 0; shard < Q_BINARY_SHARDS; shard++)
+    {
+        pthread_mutex_lock(&writer.mutex);
+        while(!writer.is_formatted[shard] && started_thread_count > 0)
+        {
+            pthread_cond_wait(&writer.condition, &writer.mutex);
+        }
+        pthread_mutex_unlock(&writer.mutex);
+
+        // no thread could be started
+        if(!writer.is_formatted[shard])
+        {
+            format_Q_text_lines(writer, shard_records[shard], writer.shard_lines[shard]);
+        }
+
+        const std::string & lines = writer.shard_lines[shard];
+        if(!write_error && !lines.empty())
+        {
+            write_error = fwrite(lines.data(), 1, lines.size(), t_Q_value_file) != lines.size();
+        }
+
+        pthread_mutex_lock(&writer.mutex);
+        std::string().swap(writer.shard_lines[shard]);
+        writer.next_shard_to_write = shard + 1;
+        pthread_cond_broadcast(&writer.condition);
+        pthread_mutex_unlock(&writer.mutex);
+    }
+
+    for(int i = 0; i < started_thread_count; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_mutex_destroy(&writer.mutex);
+    pthread_cond_destroy(&writer.condition);
+
+    // save this counter in the file
+    write_error = write_error ||
+        fprintf(t_Q_value_file, "stats\n%lld\n", training_counter) < 0 ||
+        ferror(t_Q_value_file);
+
+    return write_error ? -1 : 0;
+}
+
@@ -0,0 +1,111 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * car222_Q_text_codec.h
+ *
+ * Reading and writing of text Q value files ( see MAP_WRITE_FORMAT )
+ *
+ * A text Q value file is memory mapped and split at line boundaries into
+ * chunks that are parsed by separate threads. Lines are parsed without
+ * sscanf and Q values of each state are collected into one record per state
+ * ( max Q value is found once for each record ). While writing, shards are
+ * formatted by separate threads and written to the file in shard order.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  CAR222_Q_TEXT_CODEC_H_
+#define  CAR222_Q_TEXT_CODEC_H_
+
+
+#include <stdio.h>
+#include <vector>
+
+#include "car222_Q_binary_format.h"
+
+
+// maximum number of threads used for reading or writing a text Q value file
+#define Q_TEXT_MAX_THREADS           8
+// minimum size of a chunk of text Q value file that is read by a thread
+#define Q_TEXT_MIN_CHUNK_SIZE        (1 << 20)
+
+
+namespace controller_storage
+{
+
+    /**
+     * Q value records read from a text Q value file
+     **/
+    typedef struct Q_text_contents_struct
+    {
+
+        // records of each shard sorted by state key ( with max Q values )
+        std::vector<Q_file_record> shard_records[Q_BINARY_SHARDS];
+
+        // non-zero if "stats" line was found and training counter after it
+        int has_stats;
+        long long int training_counter;
+
+        // number of lines with Q values and lines that couldn't be parsed
+        long long int line_count;
+        long long int skipped_line_count;
+
+    } Q_text_contents;
+
+
+    /**
+     * parses a line of text Q value file ( see MAP_WRITE_FORMAT ) between "line"
+     * and "line_end" ( new line character is not needed ) into state key, action
+     * and Q value. Values are same as found by scanning the line with sscanf.
+     * Returns 0 on success and -1 if the line couldn't be parsed.
+     **/
+    int parse_Q_text_line(const char * line, const char * line_end,
+            Q_state_key & state_key, Q_action_index & action_index, float & Q_value);
+
+    /**
+     * reads all the Q value lines ( until "stats" line ) and the training
+     * counter of given text Q value file to "contents". When a state has more
+     * than one line for an action, the last one is used.
+     * Returns 0 on success and -1 if the file couldn't be read.
+     **/
+    int read_Q_text_file(const char * file_name, Q_text_contents & contents);
+
+    /**
+     * writes lines ( see MAP_WRITE_FORMAT ) for tried actions of records of each
+     * shard ( in shard order ) to the given file, followed by "stats" line and
+     * the training counter. Returns 0 on success and -1 on write error.
+     **/
+    int write_Q_text_file(FILE * t_Q_value_file,
+            const std::vector<Q_file_record> * shard_records,
+            const long long int training_counter);
+
+    /**
+     * sets max Q value and max Q action of the record from its Q values of
+     * tried actions ( lowest action wins if there is a tie ).
+     **/
+    void find_max_Q(Q_state_record & state_record);
+
+}
+
+
+#endif      /* ifndef CAR222_Q_TEXT_CODEC_H_ */
+
@@ -0,0 +1,216 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * car222_Q_visit_counts.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "car222_Q_visit_counts.h"
+
+
+/**
+ *  Constructor
+ **/
+controller_storage::Q_visit_counts::Q_visit_counts()
+{
+    pthread_mutex_init(&m_record_lock, NULL);
+}
+
+
+/**
+ *  Destructor
+ **/
+controller_storage::Q_visit_counts::~Q_visit_counts()
+{
+    pthread_mutex_destroy(&m_record_lock);
+}
+
+
+/**
+ *  Copies visit counts of the given state to second argument.
+ **/
+int controller_storage::Q_visit_counts::get_visit_record(const Q_state_key state_key,
+        Q_visit_record & visit_record) const
+{
+    state_visit_record_map::const_iterator it = m_visit_records.find(state_key);
+    if(it == m_visit_records.end())
+    {
+        memset(&visit_record, 0, sizeof(visit_record));
+        return 0;
+    }
+
+    visit_record = it->second;
+    return 1;
+}
+
+
+/**
+ *  Sets visit counts of the given state.
+ **/
+void controller_storage::Q_visit_counts::set_visit_record(const Q_state_key state_key,
+        const Q_visit_record & visit_record)
+{
+    m_visit_records[state_key] = visit_record;
+}
+
+
+/**
+ *  Clears and fills records of all the states ( sorted by state key ).
+ **/
+void controller_storage::Q_visit_counts::get_all_records(
+        std::vector<Q_visit_file_record> & records) const
+{
+    records.clear();
+    records.reserve(m_visit_records.size());
+
+    for(state_visit_record_map::const_iterator it = m_visit_records.begin();
+            it != m_visit_records.end(); ++it)
+    {
+        Q_visit_file_record record;
+        record.state_key = it->first;
+        record.visit_record = it->second;
+        records.push_back(record);
+    }
+}
+
+
+/**
+ *  Removes all the counts.
+ **/
+void controller_storage::Q_visit_counts::clear()
+{
+    m_visit_records.clear();
+}
+
+
+/**
+ *  Writes counts to visit count file of the given Q value file.
+ **/
+int controller_storage::Q_visit_counts::write_to_file(
+        const std::string & t_Q_value_file_name,
+        const long long int race_counter) const
+{
+    const std::string visit_file_name = t_Q_value_file_name + Q_VISIT_FILE_SUFFIX;
+    // file is written with a temporary name and renamed when it is complete
+    const std::string temporary_file_name = visit_file_name + ".tmp";
+
+    FILE * visit_file = fopen(temporary_file_name.c_str(), "wb");
+    if(visit_file == NULL)
+    {
+        printf("couldn't open file \'%s\' for writing visit counts.\n",
+                temporary_file_name.c_str());
+        return -1;
+    }
+
+    std::vector<Q_visit_file_record> records;
+    get_all_records(records);
+
+    Q_visit_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, Q_VISIT_MAGIC, sizeof(header.magic));
+    header.format_version = Q_VISIT_FORMAT_VERSION;
+    header.byte_order_mark = Q_BINARY_BYTE_ORDER_MARK;
+    header.record_size = sizeof(Q_visit_file_record);
+    header.training_counter = race_counter;
+    header.record_count = records.size();
+
+    int write_error = fwrite(&header, sizeof(header), 1, visit_file) != 1;
+    if(!write_error && !records.empty())
+    {
+        write_error = fwrite(&records[0], sizeof(Q_visit_file_record),
+                records.size(), visit_file) != records.size();
+    }
+
+    write_error = write_error || fflush(visit_file) != 0 || fsync(fileno(visit_file)) != 0;
+    if(fclose(visit_file) == EOF || write_error)
+    {
+        printf("error writing file \'%s\'\n", temporary_file_name.c_str());
+        remove(temporary_file_name.c_str());
+        return -1;
+    }
+
+    if(rename(temporary_file_name.c_str(), visit_file_name.c_str()) != 0)
+    {
+        printf("error renaming file \'%s\' to \'%s\'\n",
+                temporary_file_name.c_str(), visit_file_name.c_str());
+        remove(temporary_file_name.c_str());
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/**
+ *  Replaces counts with those in visit count file of the given Q value file.
+ **/
+long long int controller_storage::Q_visit_counts::load_from_file(
+        const std::string & t_Q_value_file_name)
+{
+    const std::string visit_file_name = t_Q_value_file_name + Q_VISIT_FILE_SUFFIX;
+
+    m_visit_records.clear();
+
+    FILE * visit_file = fopen(visit_file_name.c_str(), "rb");
+    if(visit_file == NULL)
+    {
+        return -1;
+    }
+
+    Q_visit_header header;
+    if(fread(&header, sizeof(header), 1, visit_file) != 1 ||
+            memcmp(header.magic, Q_VISIT_MAGIC, sizeof(header.magic)) != 0 ||
+            header.format_version != Q_VISIT_FORMAT_VERSION ||
+            header.byte_order_mark != Q_BINARY_BYTE_ORDER_MARK ||
+            header.record_size != sizeof(Q_visit_file_record))
+    {
+        printf("\'%s\' is not a visit count file of this version or machine\n",
+                visit_file_name.c_str());
+        fclose(visit_file);
+        return -1;
+    }
+
+    std::vector<Q_visit_file_record> records(header.record_count);
+    if(!records.empty() && fread(&records[0], sizeof(Q_visit_file_record),
+                records.size(), visit_file) != records.size())
+    {
+        printf("error reading visit counts from \'%s\'\n", visit_file_name.c_str());
+        fclose(visit_file);
+        return -1;
+    }
+    fclose(visit_file);
+
+    // records are sorted, so each one is inserted at the end of the map
+    for(size_t i = 0; i < records.size(); i++)
+    {
+        m_visit_records.insert(m_visit_records.end(),
+                std::make_pair(records[i].state_key, records[i].visit_record));
+    }
+
+    return header.training_counter;
+}
@@ -0,0 +1,157 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * car222_Q_visit_counts.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  CAR222_Q_VISIT_COUNTS_H_
+#define  CAR222_Q_VISIT_COUNTS_H_
+
+
+#include <pthread.h>
+#include <string>
+#include <map>
+#include <vector>
+
+#include "car222_Q_binary_format.h"
+
+
+namespace controller_storage
+{
+
+    /*
+     * ==========================================================================
+     *        Class:  Q_visit_counts
+     *  Description:  Counts Q value updates ( visits ) of each state-action pair.
+     *                Counts are kept apart from Q values ( Q_maps ), so they cost
+     *                nothing when they are not recorded. They are written to a
+     *                visit count file next to the Q value file ( Q value file name
+     *                with Q_VISIT_FILE_SUFFIX ).
+     *
+     *                Visit counts are used as weights when Q values learnt by
+     *                workers of a training farm are merged ( see car222_training_farm.h ).
+     * ==========================================================================
+     */
+    class Q_visit_counts
+    {
+        public :
+
+            /** MEMBER FUNCTIONS **/
+
+            Q_visit_counts();
+
+            ~Q_visit_counts();
+
+            /**
+             * counts a visit of given state and action pair ( visits can be
+             * counted by several learner threads at the same time )
+             **/
+            inline void record_visit(const Q_state_key state_key,
+                    const Q_action_index action_index)
+            {
+                pthread_mutex_lock(&m_record_lock);
+                m_visit_records[state_key].visit_counts[action_index]++;
+                pthread_mutex_unlock(&m_record_lock);
+            }
+
+            /**
+             * counts a visit of each of the given state and action pairs
+             * ( arrays of "count" pairs ) while the counts are locked once
+             **/
+            inline void record_visits(const Q_state_key * state_keys,
+                    const Q_action_index * action_indices, const int count)
+            {
+                pthread_mutex_lock(&m_record_lock);
+                for(int i = 0; i < count; i++)
+                {
+                    m_visit_records[state_keys[i]].visit_counts[action_indices[i]]++;
+                }
+                pthread_mutex_unlock(&m_record_lock);
+            }
+
+            /**
+             * copies visit counts of the given state to second argument
+             * ( returns 0 and zero counts if the state was never visited, else 1 )
+             **/
+            int get_visit_record(const Q_state_key state_key,
+                    Q_visit_record & visit_record) const;
+
+            /* sets visit counts of the given state */
+            void set_visit_record(const Q_state_key state_key,
+                    const Q_visit_record & visit_record);
+
+            /* clears and fills records of all the states ( sorted by state key ) */
+            void get_all_records(std::vector<Q_visit_file_record> & records) const;
+
+            /* returns number of visited states */
+            inline size_t get_number_of_states() const
+            {
+                return m_visit_records.size();
+            }
+
+            /* removes all the counts */
+            void clear();
+
+            /**
+             * writes counts to visit count file of the given Q value file with
+             * the given training counter. It is written with a temporary name and
+             * renamed when it is complete. Returns 0 on success and -1 on error.
+             **/
+            int write_to_file(const std::string & t_Q_value_file_name,
+                    const long long int race_counter) const;
+
+            /**
+             * replaces counts with those in visit count file of the given Q value
+             * file. Returns training counter of the file, or -1 if there is no
+             * such file or it couldn't be read ( counts are cleared ).
+             **/
+            long long int load_from_file(const std::string & t_Q_value_file_name);
+
+
+        private :
+
+            typedef std::map<Q_state_key, Q_visit_record> state_visit_record_map;
+
+            /** MEMBER VARIABLES **/
+
+            /* visit counts of states */
+            state_visit_record_map m_visit_records;
+
+            /* guards "m_visit_records" while visits are recorded */
+            pthread_mutex_t m_record_lock;
+
+            // restricted copy constructor
+            Q_visit_counts(const Q_visit_counts &other) = delete;
+
+            // restricted assignment operator
+            Q_visit_counts& operator=(const Q_visit_counts &other) = delete;
+
+    };
+
+}
+
+
+#endif      /* ifndef CAR222_Q_VISIT_COUNTS_H_ */
+
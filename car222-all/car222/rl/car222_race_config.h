@@ -32,6 +32,11 @@
 #include <stdlib.h>
 
 #include "car222_Q_maps.h"
+#include "car222_Q_table_cache.h"
+#include "car222_training_farm.h"
+#include "car222_Q_replay.h"
+#include "car222_Q_model.h"
+#include "car222_trajectory_log.h"
 
 
 // format for describing a general Q value file for a track
@@ -39,35 +44,148 @@
 // Q value file name for a given track
 #define Q_VALUE_FILE_NAME(track_name)  \
     getenv("HOME"), ".torcs/drivers/car222/q_learner_", track_name, "txt"
+// binary Q value file name for a given track
+#define Q_VALUE_BINARY_FILE_NAME(track_name)  \
+    getenv("HOME"), ".torcs/drivers/car222/q_learner_", track_name, "bin"
+
+// format of binary Q value file name of a worker of training farm for a track
+#define Q_VALUE_WORKER_FILE_NAME_FORMAT  "%s/%s%s_worker%d.%s"
+// binary Q value file name of a worker of training farm for a given track
+#define Q_VALUE_WORKER_FILE_NAME(track_name, worker_index)  \
+    getenv("HOME"), ".torcs/drivers/car222/q_learner_", track_name, worker_index, "bin"
+
+// format of trajectory log file name for a track ( see car222_trajectory_log.h )
+#define TRAJECTORY_FILE_NAME_FORMAT  "%s/%s%s.%s"
+// trajectory log file name for a given track
+#define TRAJECTORY_FILE_NAME(track_name)  \
+    getenv("HOME"), ".torcs/drivers/car222/trajectory_", track_name, "log"
+
+// format of telemetry file name of a car for a track ( see telemetry_format.h )
+#define TELEMETRY_FILE_NAME_FORMAT   "%s/%s%s_%d.%s"
+// telemetry file name of a car ( robot index ) for a given track
+#define TELEMETRY_FILE_NAME(track_name, robot_index)  \
+    getenv("HOME"), ".torcs/drivers/car222/telemetry_", track_name, robot_index, "tlm"
+
+// format of fuzzy table file name ( see fuzzy_table.h )
+#define FUZZY_TABLE_FILE_NAME_FORMAT "%s/%s"
+// fuzzy table file name ( same for all tracks )
+#define FUZZY_TABLE_FILE_NAME  \
+    getenv("HOME"), ".torcs/drivers/car222/fuzzy_table.bin"
+
+// format of fuzzy parameter file name ( see fuzzy_parameters.h )
+#define FUZZY_PARAMETERS_FILE_NAME_FORMAT  "%s/%s"
+// fuzzy parameter file name ( same for all tracks )
+#define FUZZY_PARAMETERS_FILE_NAME  \
+    getenv("HOME"), ".torcs/drivers/car222/fuzzy_parameters.txt"
+
+
+// types of Q value file
+#define Q_FILE_TEXT                  0
+#define Q_FILE_BINARY                1
+
+// type of Q value file that is written after training races. Binary file
+// is memory mapped when it is loaded, so it loads much faster than text file.
+// Both types are read ( binary file first, if it exists and type is binary ).
+#define Q_VALUE_FILE_TYPE            Q_FILE_BINARY
+
+// encoding of Q values in binary Q value file ( see car222_Q_binary_format.h ).
+// Q_VALUES_INT16 quantizes Q values of each state to 16 bits with a shared
+// exponent, which makes the file ( and memory of a race ) 43% smaller.
+#define Q_VALUE_ENCODING             Q_VALUES_FLOAT32
+
+
+// layouts of Q table in memory
+#define Q_TABLE_SPARSE               0
+#define Q_TABLE_DENSE                1
+
+// layout of Q table ( sparse maps, or dense table for states within
+// Q_DENSE_TABLE_BOUNDS along with sparse maps for other states )
+#define Q_TABLE_LAYOUT               Q_TABLE_SPARSE
+
+// environment variable for selecting layout at load time ( "dense" or "sparse" )
+#define Q_TABLE_LAYOUT_ENV           "CAR222_Q_TABLE_LAYOUT"
+
+
+// record telemetry of each tick of car222 cars ( 1 or 0 ). The robot only
+// copies a record to a ring buffer of TELEMETRY_BUFFER_SIZE records and a
+// writer thread appends encoded blocks to telemetry file of the car ( about
+// 25 bytes a tick ). It is off in TRAINING_MODE, where races are many and
+// short ( see RECORD_TRAJECTORIES for steps of training races ).
+#ifdef TRAINING_MODE
+#define RECORD_TELEMETRY             0
+#else
+#define RECORD_TELEMETRY             1
+#endif
+#define TELEMETRY_BUFFER_SIZE        8192
+
+
+// interpolate fuzzy outputs from fuzzy table ( 1 or 0 ) made by car222_fuzzy_table
+// tool, instead of running fuzzy engine at each tick. Engine is still used for
+// inputs outside exact cells of the table ( and for all inputs without the file ).
+#define USE_FUZZY_TABLE              1
+
+// use terms of fuzzy parameter file ( 1 or 0 ) made by car222_fuzzy_tune tool,
+// instead of compiled terms, when the file is there ( fuzzy table is then only
+// used if it was made for version of the parameters )
+#define USE_FUZZY_PARAMETERS         1
+
+
+// memory budget ( in MB ) of Q tables of tracks kept in Q_table_cache in race
+// mode. Least recently raced tracks are removed when tables take more memory.
+#define Q_TABLE_CACHE_BUDGET_MB      2048
 
 
 namespace controller
 {
     extern controller_storage::Q_maps_storage  _Q_maps_storage;
+    extern controller_storage::Q_table_cache  _Q_table_cache;
+
+    /**
+     * bounds of states kept in dense Q table ( in quantization steps of each
+     * dimension of Q state ). Speed_y and side distances are clipped in car222
+     * so these bounds cover them fully. With these bounds the dense table has
+     * about 4 million states and takes about 160 MB.
+     **/
+    static const controller_storage::Q_dense_bounds Q_DENSE_TABLE_BOUNDS =
+    {
+        /**
+         * speed_x, speed_y, right_side_distance, left_side_distance, path, next_path
+         * --------------------------------------------------------------------------
+         **/
+        {0,  -10, 0, 0, -3, -3},        // min steps
+        {59,  10, 6, 6,  3,  3}         // max steps
+    };
 
 
 /* only available in training mode */
 #ifdef TRAINING_MODE
 
     extern int training_race_counter;
+    extern controller_storage::Q_replay_buffer  _Q_replay_buffer;
+    extern controller_storage::Q_transition_model  _Q_transition_model;
 
     // number of training stages ( each stage has its own learning parameters )
     extern const int LEARNING_STAGES = 4;
 
     // learning parameters for various stages
-    extern const float LEARNING_PARAMETERS[][4] =
+    extern const float LEARNING_PARAMETERS[][5] =
     {
         /**
-         * Four columns are -
+         * Five columns are -
          * ------------------
-         * upper bound race counter, learning rate, discount, epsilon
-         * ----------------------------------------------------------
+         * upper bound race counter, learning rate, discount, epsilon,
+         * lambda ( trace decay of Q(lambda), 0 for one-step Q learning )
+         * --------------------------------------------------------------
+         * lambda is 0 in all the stages ( one-step Q learning ), as traces
+         * change how far a learning rate moves Q values and learning rates
+         * above were set without them ( "tools/car222_Q_lambda_benchmark.cpp"
+         * compares races needed with each lambda )
          **/
-        {30000, 1.0/4, 1020.0/1024, 1.0/256},
-        {50000, 1.0/4, 1020.0/1024, 1.0/1024},
-        {70000, 3.0/16, 1020.0/1024, 1.0/1024},
-        {75000, 3.0/16, 1020.0/1024, 0.0},
-        {0, 0.0, 0.0, 0.0}
+        {30000, 1.0/4, 1020.0/1024, 1.0/256, 0.0},
+        {50000, 1.0/4, 1020.0/1024, 1.0/1024, 0.0},
+        {70000, 3.0/16, 1020.0/1024, 1.0/1024, 0.0},
+        {75000, 3.0/16, 1020.0/1024, 0.0, 0.0},
+        {0, 0.0, 0.0, 0.0, 0.0}
     };
 
 
@@ -83,6 +201,57 @@ namespace controller
 
 // write Q values to file after 1000 races
 #define WRITE_AFTER_N_RACES          1000
+// append Q values updated in each race to journal of Q value file ( 1 or 0 ).
+// Journal is replayed when Q value file is loaded ( so races after last write
+// are not lost in a crash ) and it is removed when Q value file is written.
+#define JOURNAL_EACH_RACE            1
+
+// write Q value file in a background thread ( 1 or 0 ). Q values are copied
+// to a snapshot after the race and the next race starts while it is written.
+#define WRITE_IN_BACKGROUND          1
+
+// update Q values in a learner thread of each Q Learner ( 1 or 0 ). Robot only
+// puts transitions in a lock-free queue of TRANSITION_QUEUE_SIZE transitions
+// while driving ( it waits only if the learner falls that far behind ).
+#define LEARN_IN_BACKGROUND          1
+#define TRANSITION_QUEUE_SIZE        4096
+
+// experience replay ( 1 or 0 ). Steps of training races are kept in a replay
+// buffer of REPLAY_BUFFER_SIZE steps ( 32 bytes each ). From the end of a race
+// until the next race starts, batches of REPLAY_BATCH_SIZE steps are replayed
+// in a background thread ( at most REPLAY_UPDATES_PER_RACE updates ). With
+// REPLAY_PRIORITIZED steps with larger temporal difference are replayed more.
+// It is off by default, as replayed steps were driven with Q values ( and an
+// epsilon ) of earlier races ( "-r" of car222_Q_lambda_benchmark measures it ).
+#define EXPERIENCE_REPLAY            0
+#define REPLAY_BUFFER_SIZE           (1 << 20)
+#define REPLAY_BATCH_SIZE            256
+#define REPLAY_UPDATES_PER_RACE      100000
+#define REPLAY_PRIORITIZED           1
+
+// Dyna-Q planning ( 1 or 0 ). A model of next states and rewards of each
+// state-action pair is learnt from steps of training races ( it takes at most
+// DYNA_MODEL_BUDGET_MB ). After each step DYNA_PLANNING_STEPS Q values are
+// updated from the model by the thread that updates Q values and after each
+// race a background thread makes at most DYNA_UPDATES_PER_RACE updates until
+// the next race starts. It is off by default, as the model keeps only the most
+// frequent next states of a pair and a mean reward, so its updates are only as
+// good as that approximation ( "-p" and "-d" of car222_Q_lambda_benchmark ).
+#define DYNA_PLANNING                0
+#define DYNA_PLANNING_STEPS          5
+#define DYNA_UPDATES_PER_RACE        20000
+#define DYNA_MODEL_BUDGET_MB         256
+
+// record steps of training races in trajectory log of the track ( 1 or 0 ).
+// Steps of a car are kept in memory during a race ( 32 bytes each ) and are
+// appended to the log when the car is shut down. Q values can be learnt from
+// the log without TORCS ( see "tools/car222_offline_train.cpp" ).
+#define RECORD_TRAJECTORIES          0
+
+// races of each worker of a training farm between merges of their Q values
+// ( see car222_training_farm.h ). Workers write binary Q value files at merges
+// instead of after each WRITE_AFTER_N_RACES ( journal is still appended ).
+#define FARM_SYNC_AFTER_N_RACES      200
 
 
 #endif    // #ifdef TRAINING_MODE
@@ -26,6 +26,9 @@
 
 
 #include "car222_Q_maps.h"
+#include "car222_Q_table_cache.h"
+#include "car222_Q_replay.h"
+#include "car222_Q_model.h"
 
 
 namespace controller
@@ -33,12 +36,21 @@ namespace controller
     // Q maps storage that has the Q maps
     controller_storage::Q_maps_storage  _Q_maps_storage;
 
+    // Q tables of tracks ( kept across races, robot module is unloaded after each race )
+    controller_storage::Q_table_cache  _Q_table_cache;
+
 
 #ifdef TRAINING_MODE  /* only available in training mode */
 
     // race counter for training
     int training_race_counter = 0;
 
+    // steps of training races for experience replay ( kept across races )
+    controller_storage::Q_replay_buffer  _Q_replay_buffer;
+
+    // model of the track learnt from steps of training races ( Dyna-Q )
+    controller_storage::Q_transition_model  _Q_transition_model;
+
 #endif
 
 }
@@ -38,11 +38,13 @@
 #define STATE_MASK                 "%*30c|"
 // format for scanning action
 #define ACTION_READ_FORMAT         "%f"
+// format for scanning state values from state string
+#define STATE_READ_FORMAT          "%d|%f|%d|%d|%f|%f"
 
 // format for scanning a line
 #define MAP_READ_FORMAT            "%30c|%5c=%f\n"
-// format for writing a line
-#define MAP_WRITE_FORMAT           "%s=%+012f\n"
+// format for writing a line ( state values, action value and Q value )
+#define MAP_WRITE_FORMAT           STATE_PRINT_FORMAT "|" ACTION_PRINT_FORMAT "=%+012f\n"
 
 
 // length excludes the trailing null character
@@ -0,0 +1,254 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * car222_training_farm.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stddef.h>
+#include <unordered_map>
+
+#include "car222_training_farm.h"
+
+
+namespace
+{
+
+    using namespace controller_storage;
+
+    /**
+     * Q values and visits of a state while workers are merged
+     **/
+    typedef struct Q_merge_record_struct
+    {
+
+        // sums of visits since last merge and of Q values weighted by them
+        double visit_sums[Q_ACTION_SPACE_SIZE];
+        double weighted_Q_sums[Q_ACTION_SPACE_SIZE];
+
+        // base visits ( visits of workers since last merge are added to them )
+        Q_visit_record base_visits;
+        Q_visit_record merged_visits;
+
+        // Q values used when no worker has visited an action since last merge
+        // ( base Q value, else Q value of first worker that has tried it )
+        float unvisited_Q_values[Q_ACTION_SPACE_SIZE];
+        unsigned short tried_actions;
+
+    } Q_merge_record;
+
+
+    /* returns merge record of the given state ( adds it with its base visits ) */
+    Q_merge_record & get_merge_record(
+            std::unordered_map<Q_state_key, Q_merge_record> & merge_records,
+            const Q_state_key state_key, const Q_visit_counts & base_visits)
+    {
+        std::unordered_map<Q_state_key, Q_merge_record>::iterator it =
+            merge_records.find(state_key);
+        if(it != merge_records.end())
+        {
+            return it->second;
+        }
+
+        Q_merge_record & merge_record = merge_records[state_key];
+        memset(&merge_record, 0, sizeof(merge_record));
+        base_visits.get_visit_record(state_key, merge_record.base_visits);
+        merge_record.merged_visits = merge_record.base_visits;
+
+        return merge_record;
+    }
+
+}
+
+
+/**
+ *  Reads configuration of this process from environment.
+ **/
+int controller_storage::get_farm_config(Q_farm_config & config)
+{
+    const char * worker_count = getenv(FARM_WORKERS_ENV);
+    const char * worker_index = getenv(FARM_WORKER_INDEX_ENV);
+
+    config.worker_count = (worker_count == NULL) ? 0 : atoi(worker_count);
+    config.worker_index = (worker_index == NULL) ? -1 : atoi(worker_index);
+
+    if(config.worker_count < 1 || config.worker_index < 0 ||
+            config.worker_index >= config.worker_count)
+    {
+        config.worker_count = 0;
+        config.worker_index = -1;
+        return 0;
+    }
+
+    return 1;
+}
+
+
+/**
+ *  Reads header of the given binary Q value file.
+ **/
+int controller_storage::read_Q_binary_header(const std::string & t_Q_value_file_name,
+        Q_binary_header & header)
+{
+    FILE * t_Q_value_file = fopen(t_Q_value_file_name.c_str(), "rb");
+    if(t_Q_value_file == NULL)
+    {
+        return -1;
+    }
+
+    // a version 1 header is shorter, so only its fields are read
+    memset(&header, 0, sizeof(header));
+    const size_t header_size =
+        fread(&header, 1, sizeof(header), t_Q_value_file);
+    fclose(t_Q_value_file);
+
+    if(header_size < offsetof(Q_binary_header, value_encoding) ||
+            memcmp(header.magic, Q_BINARY_MAGIC, sizeof(header.magic)) != 0 ||
+            header.byte_order_mark != Q_BINARY_BYTE_ORDER_MARK)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/**
+ *  Waits until the given binary Q value file is merged up to the race counter.
+ **/
+long long int controller_storage::wait_for_merged_Q_values(
+        const std::string & t_Q_value_file_name, const long long int race_counter)
+{
+    printf("waiting for Q values of training farm merged up to race %lld in \'%s\'\n",
+            race_counter, t_Q_value_file_name.c_str());
+
+    Q_binary_header header;
+    while(read_Q_binary_header(t_Q_value_file_name, header) != 0 ||
+            header.training_counter < race_counter)
+    {
+        sleep(FARM_POLL_INTERVAL);
+    }
+
+    return header.training_counter;
+}
+
+
+/**
+ *  Merges Q values and visit counts of workers.
+ **/
+void controller_storage::merge_farm_Q_values(const Q_maps & base_maps,
+        const Q_visit_counts & base_visits,
+        const std::vector<const Q_maps *> & worker_maps,
+        const std::vector<const Q_visit_counts *> & worker_visits,
+        Q_maps & merged_maps, Q_visit_counts & merged_visits)
+{
+    std::unordered_map<Q_state_key, Q_merge_record> merge_records;
+    std::vector<Q_file_record> records;
+
+    // Q values of base are used for actions not visited since last merge
+    base_maps.get_all_records(records);
+    merge_records.reserve(records.size());
+    for(size_t i = 0; i < records.size(); i++)
+    {
+        Q_merge_record & merge_record =
+            get_merge_record(merge_records, records[i].state_key, base_visits);
+        const Q_state_record & state_record = records[i].state_record;
+
+        memcpy(merge_record.unvisited_Q_values, state_record.Q_values,
+                sizeof(merge_record.unvisited_Q_values));
+        merge_record.tried_actions = state_record.tried_actions;
+    }
+
+    for(size_t worker = 0; worker < worker_maps.size(); worker++)
+    {
+        worker_maps[worker]->get_all_records(records);
+        for(size_t i = 0; i < records.size(); i++)
+        {
+            Q_merge_record & merge_record =
+                get_merge_record(merge_records, records[i].state_key, base_visits);
+            const Q_state_record & state_record = records[i].state_record;
+
+            Q_visit_record visit_record;
+            worker_visits[worker]->get_visit_record(records[i].state_key, visit_record);
+
+            for(int action = 0; action < Q_ACTION_SPACE_SIZE; action++)
+            {
+                if(!(state_record.tried_actions & (1u << action)))
+                {
+                    continue;
+                }
+
+                // visits since last merge ( a worker restarted from an older
+                // merge may have fewer visits than base )
+                const unsigned int base_visit_count =
+                    merge_record.base_visits.visit_counts[action];
+                const unsigned int visit_count =
+                    (visit_record.visit_counts[action] > base_visit_count)
+                    ? visit_record.visit_counts[action] - base_visit_count : 0;
+
+                merge_record.visit_sums[action] += visit_count;
+                merge_record.weighted_Q_sums[action] +=
+                    (double) visit_count * state_record.Q_values[action];
+                merge_record.merged_visits.visit_counts[action] += visit_count;
+
+                if(!(merge_record.tried_actions & (1u << action)))
+                {
+                    merge_record.unvisited_Q_values[action] = state_record.Q_values[action];
+                    merge_record.tried_actions |= (1u << action);
+                }
+            }
+        }
+    }
+
+    merged_visits.clear();
+    for(std::unordered_map<Q_state_key, Q_merge_record>::const_iterator it =
+            merge_records.begin(); it != merge_records.end(); ++it)
+    {
+        const Q_merge_record & merge_record = it->second;
+        int has_visits = 0;
+
+        for(int action = 0; action < Q_ACTION_SPACE_SIZE; action++)
+        {
+            if(merge_record.tried_actions & (1u << action))
+            {
+                const float Q_value = (merge_record.visit_sums[action] > 0)
+                    ? (float) (merge_record.weighted_Q_sums[action] /
+                            merge_record.visit_sums[action])
+                    : merge_record.unvisited_Q_values[action];
+                merged_maps.update_Q_value_for(it->first, action, Q_value);
+            }
+
+            has_visits = has_visits || merge_record.merged_visits.visit_counts[action] > 0;
+        }
+
+        if(has_visits)
+        {
+            merged_visits.set_visit_record(it->first, merge_record.merged_visits);
+        }
+    }
+}
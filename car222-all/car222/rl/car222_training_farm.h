@@ -0,0 +1,119 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * car222_training_farm.h
+ *
+ * Training farm - several TORCS processes ( workers ) training on the same
+ * track at the same time, each with its own Q value file.
+ *
+ * Each worker starts with the Q values of the track's Q value file and records
+ * visit counts of state-action pairs ( see Q_visit_counts ). Its race counter
+ * goes up by number of workers after each race, so the counter is the total
+ * number of races of all the workers and the schedule of learning parameters
+ * stays the same as for one process.
+ *
+ * After every FARM_SYNC_AFTER_N_RACES races a worker writes its Q value and
+ * visit count files and waits until the track's Q value file has been merged
+ * up to its race counter ( by "car222_Q_merge", see tools ). Then it continues
+ * with the merged Q values. Q value of a state-action pair is merged as the
+ * average of the workers' Q values weighted by their visits since last merge.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  CAR222_TRAINING_FARM_H_
+#define  CAR222_TRAINING_FARM_H_
+
+
+#include <string>
+#include <vector>
+
+#include "car222_Q_maps.h"
+#include "car222_Q_visit_counts.h"
+
+
+// environment variables with number of workers and index of this worker
+#define FARM_WORKERS_ENV             "CAR222_FARM_WORKERS"
+#define FARM_WORKER_INDEX_ENV        "CAR222_FARM_WORKER"
+
+// seconds between checks for merged Q value file ( or for files of workers )
+#define FARM_POLL_INTERVAL           1
+
+
+namespace controller_storage
+{
+
+    /**
+     * configuration of a worker of a training farm
+     **/
+    typedef struct Q_farm_config_struct
+    {
+
+        // number of workers and index of this worker ( [0, worker_count) )
+        int worker_count;
+        int worker_index;
+
+    } Q_farm_config;
+
+
+    /**
+     * reads configuration of this process from environment ( FARM_WORKERS_ENV
+     * and FARM_WORKER_INDEX_ENV ). Returns non-zero if this process is a worker
+     * of a training farm.
+     **/
+    int get_farm_config(Q_farm_config & config);
+
+    /**
+     * reads header of the given binary Q value file.
+     * Returns 0 on success and -1 if it is not a binary Q value file.
+     **/
+    int read_Q_binary_header(const std::string & t_Q_value_file_name,
+            Q_binary_header & header);
+
+    /**
+     * waits until the given ( merged ) binary Q value file has a training
+     * counter not less than the given race counter and returns its counter.
+     **/
+    long long int wait_for_merged_Q_values(const std::string & t_Q_value_file_name,
+            const long long int race_counter);
+
+    /**
+     * merges Q values and visit counts of workers into "merged_maps" and
+     * "merged_visits". Base maps and visits are the ones all the workers
+     * started from ( last merge ). For each state-action pair,
+     *   - visits of a worker since last merge are its visits minus base visits
+     *   - merged Q value is the average of workers' Q values weighted by their
+     *     visits since last merge ( or base Q value if no worker has visited it )
+     *   - merged visits are base visits plus visits of all the workers since
+     *     last merge
+     **/
+    void merge_farm_Q_values(const Q_maps & base_maps, const Q_visit_counts & base_visits,
+            const std::vector<const Q_maps *> & worker_maps,
+            const std::vector<const Q_visit_counts *> & worker_visits,
+            Q_maps & merged_maps, Q_visit_counts & merged_visits);
+
+}
+
+
+#endif      /* ifndef CAR222_TRAINING_FARM_H_ */
+
@@ -0,0 +1,204 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * car222_trajectory_log.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <vector>
+
+#include "car222_trajectory_log.h"
+
+
+int controller_storage::append_trajectory(const char * file_name,
+        const std::vector<Q_trajectory_step> & steps)
+{
+    Q_trajectory_block_header block_header;
+    memset(&block_header, 0, sizeof(block_header));
+    memcpy(block_header.magic, Q_TRAJECTORY_MAGIC, sizeof(block_header.magic));
+    block_header.format_version = Q_TRAJECTORY_FORMAT_VERSION;
+    block_header.step_size = sizeof(Q_trajectory_step);
+    block_header.step_count = steps.size();
+
+    // header and steps are copied together, so the block is one write
+    const size_t steps_size = steps.size() * sizeof(Q_trajectory_step);
+    std::vector<char> block(sizeof(block_header) + steps_size);
+    memcpy(&block[0], &block_header, sizeof(block_header));
+    if(steps_size > 0)
+    {
+        memcpy(&block[sizeof(block_header)], &steps[0], steps_size);
+    }
+
+    const int file_descriptor = open(file_name, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if(file_descriptor < 0)
+    {
+        printf("couldn't open trajectory log \'%s\'\n", file_name);
+        return -1;
+    }
+
+    const int write_error = (write(file_descriptor, &block[0], block.size())
+            != (ssize_t) block.size());
+    if((::close(file_descriptor) != 0) || write_error)
+    {
+        printf("error writing trajectory log \'%s\'\n", file_name);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/**
+ *  Constructor
+ **/
+controller_storage::Q_trajectory_reader::Q_trajectory_reader()
+{
+    m_file = NULL;
+    m_file_size = 0;
+    m_step_count = 0;
+    m_unread_steps = 0;
+}
+
+
+/**
+ *  Destructor
+ **/
+controller_storage::Q_trajectory_reader::~Q_trajectory_reader()
+{
+    close();
+}
+
+
+int controller_storage::Q_trajectory_reader::open(const char * file_name)
+{
+    close();
+
+    m_file = fopen(file_name, "rb");
+    if(m_file == NULL)
+    {
+        printf("couldn't open trajectory log \'%s\'\n", file_name);
+        return -1;
+    }
+
+    struct stat file_stat;
+    if(fstat(fileno(m_file), &file_stat) != 0)
+    {
+        printf("couldn't read size of trajectory log \'%s\'\n", file_name);
+        close();
+        return -1;
+    }
+    m_file_size = file_stat.st_size;
+
+    return 0;
+}
+
+
+void controller_storage::Q_trajectory_reader::close()
+{
+    if(m_file != NULL)
+    {
+        fclose(m_file);
+        m_file = NULL;
+    }
+
+    m_file_size = 0;
+    m_step_count = 0;
+    m_unread_steps = 0;
+}
+
+
+int controller_storage::Q_trajectory_reader::next_race()
+{
+    if(m_file == NULL)
+    {
+        return -1;
+    }
+
+    // skip steps of current race that have not been read
+    if(m_unread_steps > 0 &&
+            fseeko(m_file, m_unread_steps * sizeof(Q_trajectory_step), SEEK_CUR) != 0)
+    {
+        return -1;
+    }
+    m_step_count = 0;
+    m_unread_steps = 0;
+
+    Q_trajectory_block_header block_header;
+    if(fread(&block_header, sizeof(block_header), 1, m_file) != 1)
+    {
+        // end of the log ( or a partly written header )
+        return 0;
+    }
+
+    if(memcmp(block_header.magic, Q_TRAJECTORY_MAGIC, sizeof(block_header.magic)) != 0
+            || block_header.format_version != Q_TRAJECTORY_FORMAT_VERSION
+            || block_header.step_size != sizeof(Q_trajectory_step))
+    {
+        puts("trajectory log has a block of unknown format");
+        return -1;
+    }
+
+    // a block that was partly written is not read
+    const long long int remaining_size = m_file_size - ftello(m_file);
+    if(block_header.step_count > remaining_size / sizeof(Q_trajectory_step))
+    {
+        puts("ignoring partly written block at the end of trajectory log");
+        return 0;
+    }
+
+    m_step_count = block_header.step_count;
+    m_unread_steps = block_header.step_count;
+    return 1;
+}
+
+
+long long int controller_storage::Q_trajectory_reader::read_steps(
+        Q_trajectory_step * steps, const long long int max_count)
+{
+    if(m_file == NULL)
+    {
+        return -1;
+    }
+
+    const unsigned long long int count = (m_unread_steps < (unsigned long long int) max_count) ?
+        m_unread_steps : max_count;
+    if(count == 0)
+    {
+        return 0;
+    }
+
+    if(fread(steps, sizeof(Q_trajectory_step), count, m_file) != count)
+    {
+        return -1;
+    }
+
+    m_unread_steps -= count;
+    return count;
+}
+
@@ -0,0 +1,185 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * car222_trajectory_log.h
+ *
+ * Trajectory logs : steps of races of car222 cars ( raw inputs of the state,
+ * damages and the action taken ) that Q values can be learnt from without
+ * TORCS ( see "tools/car222_offline_train.cpp" ). Rewards are not logged, they
+ * are found again from the steps, so a log can be learnt from with another
+ * reward configuration.
+ *
+ * A log file is a sequence of blocks, one for each race of a car :
+ *
+ *      +--------------------------------+
+ *      | Q_trajectory_block_header      |
+ *      +--------------------------------+
+ *      | Q_trajectory_step ( x count )  |
+ *      +--------------------------------+
+ *      | Q_trajectory_block_header      |
+ *      +--------------------------------+
+ *      | ...                            |
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  CAR222_TRAJECTORY_LOG_H_
+#define  CAR222_TRAJECTORY_LOG_H_
+
+
+#include <stdio.h>
+#include <vector>
+
+
+// magic characters at the start of each block of a trajectory log
+#define Q_TRAJECTORY_MAGIC           "C222QTRJ"
+// version of the format of a block
+#define Q_TRAJECTORY_FORMAT_VERSION  1
+
+
+namespace controller_storage
+{
+
+    /**
+     * a step of a car : values read from the car ( and fuzzy inputs ) that
+     * its Q state and reward are found from, and the accel that was taken
+     **/
+    typedef struct Q_trajectory_step_struct
+    {
+
+        float speed_x;              // speed in x direction
+        float speed_y;              // speed in y direction
+        float to_right;             // distance to track edge on right side
+        float to_left;              // distance to track edge on left side
+        float path;                 // path ( fuzzy input ) of current segment
+        float next_path;            // path ( fuzzy input ) of next segment
+        float damages;              // total damages of the car so far
+        float accel;                // value for acceleration pedal
+
+    } Q_trajectory_step;
+
+
+    /**
+     * header of a block of steps of a race in a trajectory log
+     **/
+    typedef struct Q_trajectory_block_header_struct
+    {
+
+        // Q_TRAJECTORY_MAGIC ( without null character )
+        char magic[8];
+        // Q_TRAJECTORY_FORMAT_VERSION ( steps are Q_trajectory_step )
+        unsigned int format_version;
+        // size of each step in bytes
+        unsigned int step_size;
+
+        // number of steps in this block
+        unsigned long long int step_count;
+
+    } Q_trajectory_block_header;
+
+
+    /**
+     * appends steps of a race as one block to the given trajectory log
+     * ( it is created if it does not exist ). The block is written with one
+     * "write" call to a file opened for appending, so processes that append
+     * to the same log do not mix their blocks.
+     * Returns 0 on success and -1 on error.
+     **/
+    int append_trajectory(const char * file_name,
+            const std::vector<Q_trajectory_step> & steps);
+
+
+    /*
+     * ==========================================================================
+     *        Class:  Q_trajectory_reader
+     *  Description:  Reads a trajectory log one race at a time and the steps
+     *                of a race in parts, so a log of any size is read with a
+     *                buffer of fixed size. A partly written block at the end
+     *                of the log ( crash while appending ) is ignored.
+     * ===========================================================================
+     */
+    class Q_trajectory_reader
+    {
+        public :
+
+            /** MEMBER FUNCTIONS **/
+
+            Q_trajectory_reader();
+
+            ~Q_trajectory_reader();
+
+            /* opens the given log ( returns 0 on success, else -1 ) */
+            int open(const char * file_name);
+
+            /* closes the log ( it is also closed when the reader is destroyed ) */
+            void close();
+
+            /**
+             * moves to the next race ( skipping unread steps of current race ).
+             * Returns 1 if there is a race, 0 at the end of the log and -1 if
+             * the block is not a trajectory block.
+             **/
+            int next_race();
+
+            /**
+             * reads at most "max_count" of the remaining steps of current race
+             * to "steps" and returns the number of steps read ( 0 when all the
+             * steps of the race have been read, -1 on error )
+             **/
+            long long int read_steps(Q_trajectory_step * steps, const long long int max_count);
+
+            /* returns number of steps of current race */
+            unsigned long long int get_step_count() const
+            {
+                return m_step_count;
+            }
+
+
+        private :
+
+            /** MEMBER VARIABLES **/
+
+            /* log file ( NULL if not open ) and its size in bytes */
+            FILE * m_file;
+            long long int m_file_size;
+
+            /* steps of current race and those that have not been read */
+            unsigned long long int m_step_count;
+            unsigned long long int m_unread_steps;
+
+
+            /** MEMBER FUNCTIONS **/
+
+            // restricted copy constructor
+            Q_trajectory_reader(const Q_trajectory_reader &other) = delete;
+
+            // restricted assignment operator
+            Q_trajectory_reader& operator=(const Q_trajectory_reader &other) = delete;
+
+    };
+
+}
+
+
+#endif      /* ifndef CAR222_TRAJECTORY_LOG_H_ */
+
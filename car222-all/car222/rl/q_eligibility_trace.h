@@ -0,0 +1,194 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * q_eligibility_trace.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  Q_ELIGIBILITY_TRACE_H_
+#define  Q_ELIGIBILITY_TRACE_H_
+
+
+#include <string.h>
+
+#include "car222_Q_maps.h"
+
+
+// maximum number of state-action pairs in an eligibility trace
+#define Q_TRACE_MAX_LENGTH           32
+// pairs are removed from the trace when their eligibility is below this value
+#define Q_TRACE_MIN_ELIGIBILITY      (1.0f/256)
+
+
+namespace controller
+{
+
+    /*
+     * ==========================================================================
+     *        Class:  Q_eligibility_trace
+     *  Description:  Recently visited state-action pairs of a Q Learner with
+     *                their eligibility for Q(λ) updates. Pairs are kept in the
+     *                order of their visits ( oldest first ) in separate arrays of
+     *                keys, actions and eligibilities, so that increments and decay
+     *                are computed for the whole trace in simple loops that the
+     *                compiler vectorizes.
+     *
+     *                A pair is added with eligibility 1 ( replacing trace ) and all
+     *                the pairs decay together, so eligibility never decreases from
+     *                oldest to most recent pair and pairs below
+     *                Q_TRACE_MIN_ELIGIBILITY are always at the front.
+     * ==========================================================================
+     */
+    class Q_eligibility_trace
+    {
+        public :
+
+            /** MEMBER FUNCTIONS **/
+
+            Q_eligibility_trace()
+            {
+                m_length = 0;
+            }
+
+            /* returns number of pairs in the trace */
+            inline int get_length() const
+            {
+                return m_length;
+            }
+
+            inline const controller_storage::Q_state_key * get_state_keys() const
+            {
+                return m_state_keys;
+            }
+
+            inline const controller_storage::Q_action_index * get_action_indices() const
+            {
+                return m_action_indices;
+            }
+
+            /* removes all the pairs */
+            inline void clear()
+            {
+                m_length = 0;
+            }
+
+            /* removes given pair if it is in the trace */
+            void remove(const controller_storage::Q_state_key state_key,
+                    const controller_storage::Q_action_index action_index)
+            {
+                for(int i = m_length - 1; i >= 0; i--)
+                {
+                    if(m_state_keys[i] == state_key && m_action_indices[i] == action_index)
+                    {
+                        remove_range(i, 1);
+                        return;
+                    }
+                }
+            }
+
+            /**
+             * adds given pair with eligibility 1 as the most recent pair
+             * ( oldest pair is removed if the trace is full )
+             **/
+            void add(const controller_storage::Q_state_key state_key,
+                    const controller_storage::Q_action_index action_index)
+            {
+                if(m_length == Q_TRACE_MAX_LENGTH)
+                {
+                    remove_range(0, 1);
+                }
+
+                m_state_keys[m_length] = state_key;
+                m_action_indices[m_length] = action_index;
+                m_eligibilities[m_length] = 1;
+                m_length++;
+            }
+
+            /* fills increment of Q value of each pair ( step times its eligibility ) */
+            inline void get_increments(const float step, float * increments) const
+            {
+                for(int i = 0; i < m_length; i++)
+                {
+                    increments[i] = step * m_eligibilities[i];
+                }
+            }
+
+            /**
+             * multiplies eligibilities by given decay ( discount times λ ) and
+             * removes pairs whose eligibility falls below Q_TRACE_MIN_ELIGIBILITY
+             **/
+            void decay(const float decay_factor)
+            {
+                for(int i = 0; i < m_length; i++)
+                {
+                    m_eligibilities[i] *= decay_factor;
+                }
+
+                int expired = 0;
+                while(expired < m_length && m_eligibilities[expired] < Q_TRACE_MIN_ELIGIBILITY)
+                {
+                    expired++;
+                }
+                remove_range(0, expired);
+            }
+
+
+        private :
+
+            /** MEMBER VARIABLES **/
+
+            /* pairs and their eligibilities ( oldest first ) */
+            controller_storage::Q_state_key m_state_keys[Q_TRACE_MAX_LENGTH];
+            controller_storage::Q_action_index m_action_indices[Q_TRACE_MAX_LENGTH];
+            float m_eligibilities[Q_TRACE_MAX_LENGTH];
+            int m_length;
+
+
+            /** MEMBER FUNCTIONS **/
+
+            /* removes "count" pairs starting at given position */
+            void remove_range(const int start, const int count)
+            {
+                if(count <= 0)
+                {
+                    return;
+                }
+
+                const int moved = m_length - start - count;
+                memmove(m_state_keys + start, m_state_keys + start + count,
+                        moved * sizeof(m_state_keys[0]));
+                memmove(m_action_indices + start, m_action_indices + start + count,
+                        moved * sizeof(m_action_indices[0]));
+                memmove(m_eligibilities + start, m_eligibilities + start + count,
+                        moved * sizeof(m_eligibilities[0]));
+                m_length -= count;
+            }
+
+    };
+
+}
+
+
+#endif      /* ifndef Q_ELIGIBILITY_TRACE_H_ */
+
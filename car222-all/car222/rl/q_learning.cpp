@@ -28,6 +28,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
+#include <sched.h>
 #include <string>
 #include <map>
 #include <vector>
@@ -84,6 +86,10 @@ controller::QLearner::QLearner(
     m_learning_rate = t_learning_rate;
     m_discount = t_discount;
     m_epsilon = t_epsilon;
+    m_lambda = DEFAULT_LAMBDA;
+    m_replay_buffer = NULL;
+    m_transition_model = NULL;
+    m_planning_steps = 0;
 
     ref_Q_maps_storage = &a_ref_Q_maps_storage;
 
@@ -92,11 +98,27 @@ controller::QLearner::QLearner(
     m_next_state = new Q_state;
     m_current_action = new Q_action;
     m_next_action = new Q_action;
+
+    m_transition_queue = NULL;
+    m_stop_learner.store(0);
+    m_learner_waiting.store(0);
+    pthread_mutex_init(&m_learner_mutex, NULL);
+    pthread_cond_init(&m_learner_wakeup, NULL);
+    m_queue_stats.transitions = 0;
+    m_queue_stats.max_depth = 0;
+    m_queue_stats.depth_sum = 0;
+    m_queue_stats.full_waits = 0;
 }
 
 
 controller::QLearner::~QLearner()
 {
+#ifdef TRAINING_MODE
+    stop_learner_thread();
+#endif
+    pthread_cond_destroy(&m_learner_wakeup);
+    pthread_mutex_destroy(&m_learner_mutex);
+
     delete m_current_state;
     delete m_next_state;
     delete m_current_action;
@@ -106,62 +128,28 @@ controller::QLearner::~QLearner()
 
 /**
  * select an action that has not been tried i.e. select an action
- * such that the action is not there in the given "all_action_record"
- * (actions that are not there in the "all_action_record" have not been
- * tried and have zero Q value). Also, "all_actions_record" is supposed to
- * be a "proper subset" of the action space. The values of the selected
+ * whose bit is not set in the given "tried_actions" mask (actions that
+ * have not been tried have zero Q value). Also, "tried_actions" is supposed
+ * to be a "proper subset" of the action space. The values of the selected
  * action are copied to the second argument "selected_action".
  **/
 void select_action_not_tried(
-        const std::vector<std::string> & all_actions_record,
+        const unsigned int tried_actions,
         controller::Q_action & selected_action)
 {
     selected_action.accel = 0;
 
-    // scan the float values from the string values
-    std::vector<float> actions_in_record;
-    for(std::vector<std::string>::const_iterator
-            record_iterator = all_actions_record.begin();
-            record_iterator != all_actions_record.end();
-            record_iterator++)
-    {
-        float an_action_in_record;
-        sscanf(record_iterator->c_str(),
-                STATE_MASK ACTION_READ_FORMAT,
-                &(an_action_in_record));
-        actions_in_record.push_back(an_action_in_record);
-    }
-
     // move over each action in the entire action space and
     // try to find an action that is not there in the records
     int test_action_index = 0;     // starting index of action space
     while(test_action_index < controller::TOTAL_NUM_ACTIONS)
     {
-        float test_action = controller::values_0_to_1_in_9_steps[test_action_index];
-
-        int matched = 0;
-        // iterate over each action in the records
-        for(std::vector<float>::iterator
-                record_iterator = actions_in_record.begin();
-                record_iterator != actions_in_record.end();
-                record_iterator++)
-        {
-            // in later version this equality check could
-            // be a check for very small difference in floating value
-            if(test_action == *record_iterator)
-            {
-                // action matched a record so
-                // no need to match other action in records
-                matched = 1;
-                break;
-            }
-        }
-
-        if(!matched)
+        if(!(tried_actions & (1u << test_action_index)))
         {
             // no record matched this test action so search ends here
             // as found an action that is not there in the action records
-            selected_action.accel = test_action;
+            selected_action.accel =
+                controller::values_0_to_1_in_9_steps[test_action_index];
             break;
         }
 
@@ -178,33 +166,23 @@ void controller::QLearner::get_suggested_action(
         const Q_state& given_state,
         Q_action & suggested_action)
 {
-    // string representation of the given state
-    const std::string state_string = given_state.get_string();
-    // the map that has Q values for this state
-    const std::map<std::string, float> state_Q_map =
-        ref_Q_maps_storage->_Q_maps->get_map_for(state_string);
-
-    // records of Q value of the given state for various actions
-    std::vector<std::string> all_matching_records;
+    // the record that has Q values for the given state
+    controller_storage::Q_state_record state_record;
+    const int state_record_found =
+        ref_Q_maps_storage->_Q_maps->get_record_for(given_state.get_key(), state_record);
+
+    // bit mask of actions that have Q value records for the given state
+    unsigned int tried_actions = 0;
+    int number_of_tried_actions = 0;
     // default max Q value (if no records for the given state is found)
     float max_Q_value = 0;
-    std::string action_with_max_Q;
-    for(std::map<std::string, float>::const_iterator
-            map_iterator = state_Q_map.begin();
-            map_iterator != state_Q_map .end();
-            map_iterator++) 
+    int action_with_max_Q = -1;
+    if(state_record_found)
     {
-        if(map_iterator->first.find(state_string) == 0)
-        {
-            if(max_Q_value < map_iterator->second || action_with_max_Q.empty())
-            {
-                action_with_max_Q = map_iterator->first;
-                max_Q_value = map_iterator->second;
-            }
-
-            // add to records of Q value for this state
-            all_matching_records.push_back(map_iterator->first);
-        }
+        tried_actions = state_record.tried_actions;
+        number_of_tried_actions = __builtin_popcount(tried_actions);
+        max_Q_value = state_record.max_Q_value;
+        action_with_max_Q = state_record.max_Q_action;
     }
 
     float rand_value = (float) rand()/RAND_MAX;
@@ -212,11 +190,11 @@ void controller::QLearner::get_suggested_action(
     {
         // check if there are some actions still left to be tried
         // as their Q value would be zero which is better than negative Q value
-        if(all_matching_records.size() < TOTAL_NUM_ACTIONS)
+        if(number_of_tried_actions < TOTAL_NUM_ACTIONS)
         {
             // check if no action has been tried yet for this state
             // to select a random action
-            if(action_with_max_Q.empty())
+            if(action_with_max_Q < 0)
             {
                 // pick from random array index
                 suggested_action.accel = controller::
@@ -227,21 +205,19 @@ void controller::QLearner::get_suggested_action(
                 // other untried actions have still zero Q values
             {
                 // choose the best action found
-                sscanf(action_with_max_Q.c_str(),
-                        STATE_MASK "%f", &(suggested_action.accel));
+                suggested_action.accel = values_0_to_1_in_9_steps[action_with_max_Q];
             }
             else // maps have all negative Q values as max_Q_value < 0
                 // select an action that is not tried
             {
-                select_action_not_tried(all_matching_records, suggested_action);
+                select_action_not_tried(tried_actions, suggested_action);
             }
         }
         else // no more untried actions left (even if max Q value is negative
              // still no untried action with zero Q value is left to be tried)
         {
             // select the best action found as there are no more actions to try
-            sscanf(action_with_max_Q.c_str(),
-                    STATE_MASK "%f", &(suggested_action.accel));
+            suggested_action.accel = values_0_to_1_in_9_steps[action_with_max_Q];
         }
     }
     else    // explore by choosing a random action
@@ -256,31 +232,92 @@ void controller::QLearner::get_suggested_action(
 #ifdef TRAINING_MODE
 
 
-/* update Q value for current state and action pair */
-void controller::QLearner::update_Q_value()
+/* update Q value for state and action pair of the transition */
+void controller::QLearner::update_Q_value(const Q_transition & transition)
 {
-    // string representation of current state and action
-    const std::string current_state_string = m_current_state->get_string();
-    const std::string current_action_string = m_current_action->get_string();
-
     // max Q value for next state
     const float max_Q_value_for_next_state = ref_Q_maps_storage->
-        _Q_maps->get_max_Q_value_for(m_next_state->get_string());
-
-    // Q value for state and action pair before updating
-    const float t_Q_value_for_state_action = ref_Q_maps_storage->
-        _Q_maps->get_Q_value_for(current_state_string, current_action_string);
-
-    // calculate updated Q value
-    const float updated_Q_value_for_current_state_current_action
-        = ((1 - m_learning_rate) * t_Q_value_for_state_action)
-        + (m_learning_rate *
-                (m_current_state_reward + (m_discount * max_Q_value_for_next_state)));
-
-    // update Q value in the map
-    ref_Q_maps_storage->_Q_maps->update_Q_value_for(
-            current_state_string, current_action_string,
-            updated_Q_value_for_current_state_current_action);
+        _Q_maps->get_max_Q_value_for(transition.next_state_key);
+
+    // replacing trace : an earlier visit of this pair is not in the trace
+    // any more, as this pair is updated below with eligibility 1
+    m_trace.remove(transition.state_key, transition.action_index);
+
+    // move Q value for current state and action pair towards its target
+    // ( read and written while the state is locked, as other learners may
+    // update same Q table )
+    const float temporal_difference = ref_Q_maps_storage->_Q_maps->update_Q_value_towards(
+            transition.state_key, transition.action_index,
+            transition.reward + (transition.discount * max_Q_value_for_next_state),
+            transition.learning_rate);
+
+    // same temporal difference updates recently visited pairs by their eligibility
+    if(m_trace.get_length() > 0)
+    {
+        float increments[Q_TRACE_MAX_LENGTH];
+        m_trace.get_increments(transition.learning_rate * temporal_difference, increments);
+        ref_Q_maps_storage->_Q_maps->add_to_Q_values(m_trace.get_state_keys(),
+                m_trace.get_action_indices(), increments, m_trace.get_length());
+    }
+
+    // count visits of state-action pairs ( if they are recorded ). Pairs of
+    // the trace are counted too, so that their updates have a weight when
+    // Q values of a training farm are merged
+    if(ref_Q_maps_storage->_Q_visit_counts != NULL)
+    {
+        ref_Q_maps_storage->_Q_visit_counts->record_visit(
+                transition.state_key, transition.action_index);
+
+        if(m_trace.get_length() > 0)
+        {
+            ref_Q_maps_storage->_Q_visit_counts->record_visits(m_trace.get_state_keys(),
+                    m_trace.get_action_indices(), m_trace.get_length());
+        }
+    }
+
+    // record the step for experience replay
+    if(m_replay_buffer != NULL)
+    {
+        controller_storage::Q_replay_transition replay_transition;
+        replay_transition.state_key = transition.state_key;
+        replay_transition.next_state_key = transition.next_state_key;
+        replay_transition.reward = transition.reward;
+        replay_transition.priority = fabsf(temporal_difference);
+        replay_transition.action_index = transition.action_index;
+        m_replay_buffer->add(replay_transition);
+    }
+
+    // Watkins Q(λ) : trace goes on only while next action is greedy
+    // ( untried actions have Q value 0 )
+    if(transition.lambda > 0 &&
+            ref_Q_maps_storage->_Q_maps->get_Q_value_for(transition.next_state_key,
+                transition.next_action_index) >= max_Q_value_for_next_state)
+    {
+        m_trace.add(transition.state_key, transition.action_index);
+        m_trace.decay(transition.discount * transition.lambda);
+    }
+    else
+    {
+        m_trace.clear();
+    }
+
+    // learn the step in the model and plan from the model ( Dyna-Q )
+    if(m_transition_model != NULL)
+    {
+        m_transition_model->observe(transition.state_key, transition.action_index,
+                transition.reward, transition.next_state_key);
+
+        if(m_planning_steps > 0)
+        {
+            controller_storage::Q_planning_parameters planning_parameters;
+            planning_parameters.learning_rate = transition.learning_rate;
+            planning_parameters.discount = transition.discount;
+            planning_parameters.max_updates = 0;
+            planning_parameters.visit_counts = ref_Q_maps_storage->_Q_visit_counts;
+            m_transition_model->plan(*(ref_Q_maps_storage->_Q_maps),
+                    planning_parameters, m_planning_steps);
+        }
+    }
 }
 
 
@@ -303,9 +340,143 @@ void controller::QLearner::set_state_action_and_reward(
     // current action in current state
     m_current_state_reward = given_state_reward;
 
-    // update Q value for current state-action pair
-    // with the given next state and given reward
-    update_Q_value();
+    // transition from current state-action pair
+    // to the given next state with given reward
+    Q_transition transition;
+    transition.state_key = m_current_state->get_key();
+    transition.action_index = m_current_action->get_index();
+    transition.reward = m_current_state_reward;
+    transition.next_state_key = m_next_state->get_key();
+    transition.next_action_index = m_next_action->get_index();
+    transition.learning_rate = m_learning_rate;
+    transition.discount = m_discount;
+    transition.lambda = m_lambda;
+
+    if(m_transition_queue == NULL)
+    {
+        // update Q value for current state-action pair
+        update_Q_value(transition);
+        return;
+    }
+
+    // learner thread updates Q value for current state-action pair
+    if(!m_transition_queue->try_push(transition))
+    {
+        m_queue_stats.full_waits++;
+        while(!m_transition_queue->try_push(transition))
+        {
+            sched_yield();
+        }
+    }
+    wake_learner();
+
+    const long long int depth = m_transition_queue->get_depth();
+    m_queue_stats.transitions++;
+    m_queue_stats.depth_sum += depth;
+    if(depth > m_queue_stats.max_depth)
+    {
+        m_queue_stats.max_depth = depth;
+    }
+}
+
+
+void controller::QLearner::wake_learner()
+{
+    // the fence orders the push before reading the flag, and the learner
+    // orders setting the flag before checking the queue again, so either
+    // it sees the transition or it is seen waiting here
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(m_learner_waiting.load(std::memory_order_relaxed))
+    {
+        // signalled under the mutex so it can't be lost between the
+        // learner's last check and its wait
+        pthread_mutex_lock(&m_learner_mutex);
+        pthread_cond_signal(&m_learner_wakeup);
+        pthread_mutex_unlock(&m_learner_mutex);
+    }
+}
+
+
+void * controller::QLearner::run_learner(void * t_q_learner)
+{
+    QLearner * q_learner = (QLearner *) t_q_learner;
+
+    Q_transition transition;
+    while(1)
+    {
+        if(q_learner->m_transition_queue->try_pop(transition))
+        {
+            q_learner->update_Q_value(transition);
+            continue;
+        }
+
+        // queue is empty, so all the transitions are done if it should stop
+        // ( they were put before the stop was set )
+        if(q_learner->m_stop_learner.load(std::memory_order_acquire))
+        {
+            while(q_learner->m_transition_queue->try_pop(transition))
+            {
+                q_learner->update_Q_value(transition);
+            }
+            break;
+        }
+
+        // sleep until a transition is put or it should stop
+        int is_popped = 0;
+        pthread_mutex_lock(&q_learner->m_learner_mutex);
+        q_learner->m_learner_waiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while(!(is_popped = q_learner->m_transition_queue->try_pop(transition))
+                && !q_learner->m_stop_learner.load(std::memory_order_acquire))
+        {
+            pthread_cond_wait(&q_learner->m_learner_wakeup, &q_learner->m_learner_mutex);
+        }
+        q_learner->m_learner_waiting.store(0, std::memory_order_relaxed);
+        pthread_mutex_unlock(&q_learner->m_learner_mutex);
+
+        if(is_popped)
+        {
+            q_learner->update_Q_value(transition);
+        }
+    }
+
+    return NULL;
+}
+
+
+void controller::QLearner::start_learner_thread(const size_t queue_capacity)
+{
+    if(m_transition_queue != NULL)
+    {
+        return;
+    }
+
+    m_transition_queue = new Q_transition_queue(queue_capacity);
+    m_stop_learner.store(0);
+
+    if(pthread_create(&m_learner_thread, NULL, run_learner, this) != 0)
+    {
+        // Q values are updated in the driving thread
+        puts("couldn't start learner thread, Q values are updated while driving");
+        delete m_transition_queue;
+        m_transition_queue = NULL;
+    }
+}
+
+
+void controller::QLearner::stop_learner_thread()
+{
+    if(m_transition_queue == NULL)
+    {
+        return;
+    }
+
+    m_stop_learner.store(1, std::memory_order_release);
+    wake_learner();
+    pthread_join(m_learner_thread, NULL);
+
+    delete m_transition_queue;
+    m_transition_queue = NULL;
 }
 
 
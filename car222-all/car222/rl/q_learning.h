@@ -27,9 +27,15 @@
 #ifndef  Q_LEARNING_H_
 #define  Q_LEARNING_H_
 
+#include <pthread.h>
 #include <string>
+#include <atomic>
 
 #include "car222_Q_maps.h"
+#include "car222_Q_replay.h"
+#include "car222_Q_model.h"
+#include "q_transition_queue.h"
+#include "q_eligibility_trace.h"
 
 
 #define Q_LEARNER_VERSION     "v1.0.0"
@@ -39,13 +45,14 @@
 #define DEFAULT_LEARNING_RATE  1.0/4
 #define DEFAULT_DISCOUNT_RATE  1020.0/1024
 #define DEFAULT_EPSILON        1.0/1024
+#define DEFAULT_LAMBDA         0.0
 
 
 namespace controller
 {
 
     // action space is 9 equal intervals in [0,1]
-    static const int TOTAL_NUM_ACTIONS = 9;
+    static const int TOTAL_NUM_ACTIONS = Q_ACTION_SPACE_SIZE;
     static const float values_0_to_1_in_9_steps[TOTAL_NUM_ACTIONS]
         = {0.0, 1.0/8, 2.0/8, 3.0/8, 4.0/8, 5.0/8, 6.0/8, 7.0/8, 8.0/8};
 
@@ -68,6 +75,13 @@ namespace controller
         // string representation of the state
         std::string get_string() const;
 
+        // packed integer representation of the state
+        inline controller_storage::Q_state_key get_key() const
+        {
+            return controller_storage::make_Q_state_key(speed_x, speed_y,
+                    right_side_distance, left_side_distance, path, next_path);
+        }
+
     } Q_state;
 
 
@@ -82,9 +96,30 @@ namespace controller
         // string representation of the action
         std::string get_string() const;
 
+        // index of the action in action space
+        inline controller_storage::Q_action_index get_index() const
+        {
+            return controller_storage::make_Q_action_index(accel);
+        }
+
     } Q_action;
 
 
+    /* statistics of transition queue of a QLearner */
+    typedef struct Q_queue_stats_struct
+    {
+
+        // transitions put in the queue
+        long long int transitions;
+        // max and sum of queue depths seen when transitions were put
+        long long int max_depth;
+        long long int depth_sum;
+        // transitions that waited for the learner as the queue was full
+        long long int full_waits;
+
+    } Q_queue_stats;
+
+
     /*
      * ==============================================================================
      *        Class:  QLearner
@@ -100,6 +135,18 @@ namespace controller
      *                epsilon-greedy policy that generates action for a given
      *                state which it returns as a suggested action (this action may
      *                or may not be taken in actual).
+     *
+     *                With λ > 0 it is a Watkins Q(λ) learner. Each update is also
+     *                applied to recently visited state-action pairs ( eligibility
+     *                trace ), and the trace is cut when an exploratory ( not greedy )
+     *                action is taken. With λ = 0 it is one-step Q learning.
+     *
+     *                In TRAINING_MODE, Q values can be updated by a learner thread
+     *                ( see "start_learner_thread" ). Then the driving thread only
+     *                puts transitions in a lock-free queue and the learner thread
+     *                takes them out and updates Q values in the same order. The
+     *                learner thread sleeps while the queue is empty and is woken
+     *                up by the next transition.
      * ==============================================================================
      */
     class QLearner
@@ -148,6 +195,48 @@ namespace controller
                     const Q_action & given_action,
                     float given_state_reward);
 
+            /**
+             * starts a learner thread with a transition queue of given capacity.
+             * After this "set_state_action_and_reward" only puts transitions in
+             * the queue ( it waits if the queue is full ) and Q values are
+             * updated by the learner thread a few steps later.
+             **/
+            void start_learner_thread(const size_t queue_capacity);
+
+            /**
+             * waits until the learner thread has updated Q values for all the
+             * queued transitions and stops it ( nothing is done if it is not
+             * running ). It is also stopped when the QLearner is destroyed.
+             **/
+            void stop_learner_thread();
+
+            /**
+             * sets replay buffer where steps are recorded after their Q value
+             * is updated ( NULL, the default, for not recording them )
+             **/
+            void set_replay_buffer(controller_storage::Q_replay_buffer * t_replay_buffer)
+            {
+                m_replay_buffer = t_replay_buffer;
+            }
+
+            /**
+             * sets model that learns steps after their Q value is updated
+             * ( NULL, the default, for no model ) and number of planning
+             * updates from the model after each step ( Dyna-Q )
+             **/
+            void set_transition_model(controller_storage::Q_transition_model * t_model,
+                    const int t_planning_steps)
+            {
+                m_transition_model = t_model;
+                m_planning_steps = t_planning_steps;
+            }
+
+            /* copies statistics of transition queue to the argument */
+            void get_queue_stats(Q_queue_stats & stats) const
+            {
+                stats = m_queue_stats;
+            }
+
             /* get learning rate α */
             float get_learning_rate()
             {
@@ -184,6 +273,18 @@ namespace controller
                 m_epsilon = t_epsilon;
             }
 
+            /* get trace decay λ */
+            float get_lambda()
+            {
+                return m_lambda;
+            }
+
+            /* set trace decay λ ( 0 for one-step Q learning ) */
+            void set_lambda(const float t_lambda)
+            {
+                m_lambda = t_lambda;
+            }
+
 #endif
 
         private:
@@ -212,6 +313,31 @@ namespace controller
             float m_discount;
             /* exploration rate ε */
             float m_epsilon;
+            /* trace decay λ */
+            float m_lambda;
+
+            /* recently visited state-action pairs ( used by the thread that updates Q values ) */
+            Q_eligibility_trace m_trace;
+
+            /* replay buffer for steps ( NULL if they are not recorded ) */
+            controller_storage::Q_replay_buffer * m_replay_buffer;
+
+            /* model learnt from steps ( NULL if none ) and planning updates per step */
+            controller_storage::Q_transition_model * m_transition_model;
+            int m_planning_steps;
+
+            /* queue of transitions and learner thread ( NULL if not started ) */
+            Q_transition_queue * m_transition_queue;
+            pthread_t m_learner_thread;
+            /* set when the learner thread should stop after emptying the queue */
+            std::atomic<int> m_stop_learner;
+            /* learner thread waits on the condition while the queue is empty
+             * ( it sets the flag first, so it is only signalled when waiting ) */
+            pthread_mutex_t m_learner_mutex;
+            pthread_cond_t m_learner_wakeup;
+            std::atomic<int> m_learner_waiting;
+            /* statistics of transition queue ( updated by the driving thread ) */
+            Q_queue_stats m_queue_stats;
 
             /*--------------------------------------------------------------
              *                 MEMBER FUNCTIONS
@@ -219,8 +345,14 @@ namespace controller
 
 #ifdef TRAINING_MODE
 
-            /* update Q value for current state and action pair */
-            void update_Q_value();
+            /* update Q value for state and action pair of the transition */
+            void update_Q_value(const Q_transition & transition);
+
+            /* thread function of learner thread ( argument is the QLearner ) */
+            static void * run_learner(void * t_q_learner);
+
+            /* wakes up the learner thread if it is waiting for transitions */
+            void wake_learner();
 
 #endif
 
@@ -0,0 +1,195 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * q_transition_queue.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  Q_TRANSITION_QUEUE_H_
+#define  Q_TRANSITION_QUEUE_H_
+
+
+#include <stddef.h>
+#include <atomic>
+
+#include "car222_Q_maps.h"
+
+
+// size of a cache line ( producer and consumer indices are kept apart )
+#define Q_QUEUE_CACHE_LINE_SIZE      64
+
+
+namespace controller
+{
+
+    /**
+     * a step of a Q Learner : state, action and reward observed after taking
+     * the action, followed by the next state. Learning parameters are those
+     * of the Q Learner when the step was taken.
+     **/
+    typedef struct Q_transition_struct
+    {
+
+        controller_storage::Q_state_key state_key;
+        controller_storage::Q_action_index action_index;
+        float reward;
+        controller_storage::Q_state_key next_state_key;
+        controller_storage::Q_action_index next_action_index;
+
+        float learning_rate;
+        float discount;
+        float lambda;
+
+    } Q_transition;
+
+
+    /*
+     * ==========================================================================
+     *        Class:  Q_transition_queue
+     *  Description:  Ring buffer of transitions with one producer thread ( the
+     *                robot that drives ) and one consumer thread ( the learner
+     *                that updates Q values ). Neither side takes a lock, each
+     *                side only writes its own index and reads index of the other
+     *                side. Transitions are taken out in the order they were put.
+     * ==========================================================================
+     */
+    class Q_transition_queue
+    {
+        public :
+
+            /** MEMBER FUNCTIONS **/
+
+            /* capacity is rounded up to a power of 2 */
+            explicit Q_transition_queue(const size_t t_capacity)
+            {
+                m_capacity = 1;
+                while(m_capacity < t_capacity)
+                {
+                    m_capacity <<= 1;
+                }
+                m_mask = m_capacity - 1;
+                m_buffer = new Q_transition[m_capacity];
+
+                m_head.store(0, std::memory_order_relaxed);
+                m_tail.store(0, std::memory_order_relaxed);
+                m_cached_head = 0;
+                m_cached_tail = 0;
+            }
+
+            ~Q_transition_queue()
+            {
+                delete[] m_buffer;
+            }
+
+            /**
+             * puts a transition at the end of the queue ( producer only ).
+             * Returns 1 on success and 0 if the queue is full.
+             **/
+            inline int try_push(const Q_transition & transition)
+            {
+                const size_t head = m_head.load(std::memory_order_relaxed);
+                if(head - m_cached_tail >= m_capacity)
+                {
+                    // index of consumer is read only when queue looks full
+                    m_cached_tail = m_tail.load(std::memory_order_acquire);
+                    if(head - m_cached_tail >= m_capacity)
+                    {
+                        return 0;
+                    }
+                }
+
+                m_buffer[head & m_mask] = transition;
+                m_head.store(head + 1, std::memory_order_release);
+
+                return 1;
+            }
+
+            /**
+             * takes the transition at the front of the queue ( consumer only ).
+             * Returns 1 on success and 0 if the queue is empty.
+             **/
+            inline int try_pop(Q_transition & transition)
+            {
+                const size_t tail = m_tail.load(std::memory_order_relaxed);
+                if(tail == m_cached_head)
+                {
+                    // index of producer is read only when queue looks empty
+                    m_cached_head = m_head.load(std::memory_order_acquire);
+                    if(tail == m_cached_head)
+                    {
+                        return 0;
+                    }
+                }
+
+                transition = m_buffer[tail & m_mask];
+                m_tail.store(tail + 1, std::memory_order_release);
+
+                return 1;
+            }
+
+            /* returns number of transitions in the queue ( as seen by the caller ) */
+            inline size_t get_depth() const
+            {
+                const size_t tail = m_tail.load(std::memory_order_acquire);
+                return m_head.load(std::memory_order_acquire) - tail;
+            }
+
+            inline size_t get_capacity() const
+            {
+                return m_capacity;
+            }
+
+
+        private :
+
+            /** MEMBER VARIABLES **/
+
+            Q_transition * m_buffer;
+            size_t m_capacity;
+            size_t m_mask;
+
+            /* index of next push ( written by producer ) and its copy of tail */
+            char m_head_padding[Q_QUEUE_CACHE_LINE_SIZE];
+            std::atomic<size_t> m_head;
+            size_t m_cached_tail;
+
+            /* index of next pop ( written by consumer ) and its copy of head */
+            char m_tail_padding[Q_QUEUE_CACHE_LINE_SIZE];
+            std::atomic<size_t> m_tail;
+            size_t m_cached_head;
+            char m_end_padding[Q_QUEUE_CACHE_LINE_SIZE];
+
+            // restricted copy constructor
+            Q_transition_queue(const Q_transition_queue &other) = delete;
+
+            // restricted assignment operator
+            Q_transition_queue& operator=(const Q_transition_queue &other) = delete;
+
+    };
+
+}
+
+
+#endif      /* ifndef Q_TRANSITION_QUEUE_H_ */
+
@@ -0,0 +1,202 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * test_Q_binary_format.cpp
+ *
+ * Checks binary Q value files ( format v2 ) - header and layout of records
+ * of a written file, loading it back ( memory mapped ) with the same records,
+ * loading a version 1 file made from it and rejecting a truncated file.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include "car222_Q_maps.h"
+#include "test_check.h"
+#include "test_Q_files.h"
+
+
+// random states written to the file
+#define TEST_STATES                  20000
+// seed of random Q values ( same Q values for each run )
+#define TEST_VALUES_SEED             222
+// training counter written to the file
+#define TEST_TRAINING_COUNTER        1234
+
+// ids written to the file
+#define TEST_Q_LEARNER_ID            "QLearner-test"
+#define TEST_REWARD_ID               "reward-test"
+#define TEST_FUZZY_VERSION           "fuzzy-test"
+
+
+using namespace controller_storage;
+
+
+/* checks header and records of a written file against records of the maps */
+static void check_file_layout(const std::string & file_name,
+        const std::vector<Q_file_record> & records)
+{
+    std::vector<char> contents;
+    if(!CHECK(read_file(file_name, contents) == 0)
+            || !CHECK(contents.size() >= sizeof(Q_binary_header)))
+    {
+        return;
+    }
+
+    const Q_binary_header & header = *((const Q_binary_header *) contents.data());
+    CHECK(memcmp(header.magic, Q_BINARY_MAGIC, sizeof(header.magic)) == 0);
+    CHECK(header.format_version == 2);
+    CHECK(header.byte_order_mark == Q_BINARY_BYTE_ORDER_MARK);
+    CHECK(header.header_size == sizeof(Q_binary_header));
+    CHECK(header.record_size == sizeof(Q_file_record));
+    CHECK(header.value_encoding == Q_VALUES_FLOAT32);
+    CHECK(strcmp(header.Q_learner_id, TEST_Q_LEARNER_ID) == 0);
+    CHECK(strcmp(header.reward_id, TEST_REWARD_ID) == 0);
+    CHECK(strcmp(header.fuzzy_controller_version, TEST_FUZZY_VERSION) == 0);
+    CHECK(header.training_counter == TEST_TRAINING_COUNTER);
+    CHECK(header.record_count == records.size());
+    CHECK(contents.size() == sizeof(Q_binary_header) + records.size() * sizeof(Q_file_record));
+    CHECK(header.shard_offsets[0] == 0);
+    CHECK(header.shard_offsets[Q_BINARY_SHARDS] == header.record_count);
+    if(contents.size() != sizeof(Q_binary_header) + header.record_count * sizeof(Q_file_record))
+    {
+        return;
+    }
+
+    // records of each shard are sorted by state key, and they are the records of the maps
+    const Q_file_record * file_records =
+        (const Q_file_record *) (contents.data() + sizeof(Q_binary_header));
+    for(int shard = 0; shard < Q_BINARY_SHARDS; shard++)
+    {
+        CHECK(header.shard_offsets[shard] <= header.shard_offsets[shard + 1]);
+        for(unsigned long long int i = header.shard_offsets[shard];
+                i < header.shard_offsets[shard + 1] && i < header.record_count; i++)
+        {
+            CHECK(get_Q_shard_for(speed_x_dimension::magnitude(file_records[i].state_key))
+                    == shard);
+            CHECK(i == header.shard_offsets[shard]
+                    || file_records[i - 1].state_key < file_records[i].state_key);
+            CHECK(are_records_equal(file_records[i], records[i]));
+        }
+    }
+}
+
+
+/* checks records and Q values of maps loaded from a file against records that were written */
+static void check_loaded_maps(const std::string & file_name,
+        const std::vector<Q_file_record> & records)
+{
+    Q_maps loaded_maps;
+    loaded_maps.set_version_ids(TEST_Q_LEARNER_ID, TEST_REWARD_ID, TEST_FUZZY_VERSION);
+    CHECK(loaded_maps.load_maps_from_file(file_name) == TEST_TRAINING_COUNTER);
+    CHECK(loaded_maps.is_using_mapped_file());
+
+    std::vector<Q_file_record> loaded_records;
+    loaded_maps.get_all_records(loaded_records);
+    CHECK(are_records_equal(loaded_records, records));
+
+    // Q values are found in the mapped file
+    for(size_t i = 0; i < records.size(); i++)
+    {
+        const Q_state_record & state_record = records[i].state_record;
+        CHECK(loaded_maps.get_max_Q_value_for(records[i].state_key) == state_record.max_Q_value);
+        for(int j = 0; j < Q_ACTION_SPACE_SIZE; j++)
+        {
+            CHECK(loaded_maps.get_Q_value_for(records[i].state_key, (Q_action_index) j)
+                    == state_record.Q_values[j]);
+        }
+    }
+}
+
+
+/* makes a version 1 file ( header without value encoding ) of a version 2 file */
+static int make_version_1_file(const std::string & file_name, const std::string & v1_file_name)
+{
+    std::vector<char> contents;
+    if(read_file(file_name, contents) != 0 || contents.size() < sizeof(Q_binary_header))
+    {
+        return -1;
+    }
+
+    const size_t v1_header_size = offsetof(Q_binary_header, value_encoding);
+    Q_binary_header & header = *((Q_binary_header *) contents.data());
+    header.format_version = 1;
+    header.header_size = v1_header_size;
+
+    std::vector<char> v1_contents(contents.begin(), contents.begin() + v1_header_size);
+    v1_contents.insert(v1_contents.end(),
+            contents.begin() + sizeof(Q_binary_header), contents.end());
+
+    return write_file(v1_file_name, v1_contents.data(), v1_contents.size());
+}
+
+
+int main()
+{
+    const std::string directory = make_test_directory();
+    if(!CHECK(!directory.empty()))
+    {
+        return finish_checks("test_Q_binary_format");
+    }
+    const std::string file_name = directory + "/q_learner_test.bin";
+    const std::string v1_file_name = directory + "/q_learner_test_v1.bin";
+    const std::string truncated_file_name = directory + "/q_learner_test_truncated.bin";
+
+    srand(TEST_VALUES_SEED);
+    std::vector<Q_file_record> records;
+    {
+        Q_maps Q_maps;
+        Q_maps.set_version_ids(TEST_Q_LEARNER_ID, TEST_REWARD_ID, TEST_FUZZY_VERSION);
+        fill_random_Q_values(Q_maps, TEST_STATES);
+        Q_maps.get_all_records(records);
+        CHECK(Q_maps.write_maps_to_binary_file(file_name, TEST_TRAINING_COUNTER) == 0);
+    }
+    CHECK(records.size() > TEST_STATES / 2);
+
+    check_file_layout(file_name, records);
+    check_loaded_maps(file_name, records);
+
+    // a version 1 file is loaded with same records
+    CHECK(make_version_1_file(file_name, v1_file_name) == 0);
+    check_loaded_maps(v1_file_name, records);
+
+    // a file that was not completely written is not loaded
+    std::vector<char> contents;
+    CHECK(read_file(file_name, contents) == 0);
+    CHECK(write_file(truncated_file_name, contents.data(), contents.size() - 10) == 0);
+    {
+        Q_maps truncated_maps;
+        CHECK(truncated_maps.load_maps_from_file(truncated_file_name) == 0);
+        CHECK(!truncated_maps.is_using_mapped_file());
+        CHECK(truncated_maps.get_total_size() == 0);
+    }
+
+    remove_test_directory(directory);
+
+    return finish_checks("test_Q_binary_format");
+}
@@ -0,0 +1,266 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * test_Q_dense_table.cpp
+ *
+ * Checks that Q maps with a dense table ( Q_DENSE_TABLE_BOUNDS ) give the
+ * same Q values, max Q values and max Q actions as sparse maps for the same
+ * updates - for random states and for states at the bounds of each dimension
+ * ( and just outside them ), including "-0" and "+0" of speed_y. Also checks
+ * slots of the dense table for those states.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include "car222_race_config.h"
+#include "test_check.h"
+#include "test_Q_files.h"
+
+
+// random states updated ( besides states at the bounds )
+#define TEST_STATES                  20000
+// seed of random states and Q values ( same values for each run )
+#define TEST_VALUES_SEED             222
+// updates of each state ( Q values are small integers, so actions have ties )
+#define TEST_STATE_UPDATES           12
+#define TEST_Q_VALUE_RANGE           5
+
+
+using namespace controller_storage;
+
+
+/* steps of a dimension at and around its bounds ( "-0" is step 0 with negative sign ) */
+typedef struct test_steps_struct
+{
+
+    long steps;
+    int negative;
+
+} test_steps;
+
+
+/**
+ * sets steps at the bounds, just outside them and at zero ( "+0", and "-0"
+ * of a fractional dimension, as Q state keys of integer values have no "-0" )
+ **/
+template <typename DIMENSION>
+static void get_bound_steps(const long min_steps, const long max_steps,
+        std::vector<test_steps> & steps)
+{
+    const long step_values[] = {min_steps - 1, min_steps, max_steps, max_steps + 1, 0};
+
+    steps.clear();
+    for(size_t i = 0; i < sizeof(step_values) / sizeof(step_values[0]); i++)
+    {
+        test_steps bound_steps = {step_values[i], step_values[i] < 0};
+        steps.push_back(bound_steps);
+    }
+
+    if(DIMENSION::STEPS_PER_UNIT > 1)
+    {
+        test_steps negative_zero = {0, 1};
+        steps.push_back(negative_zero);
+    }
+}
+
+
+/* returns bits of a dimension for the given steps */
+template <typename DIMENSION>
+static Q_state_key get_dimension_key(const test_steps & steps)
+{
+    return DIMENSION::encode_steps(steps.steps < 0 ? -steps.steps : steps.steps,
+            steps.negative);
+}
+
+
+/* returns non-zero if the given steps are within bounds of a dimension */
+static int is_within_bounds(const test_steps & steps, const int dimension)
+{
+    return steps.steps >= controller::Q_DENSE_TABLE_BOUNDS.min_steps[dimension]
+        && steps.steps <= controller::Q_DENSE_TABLE_BOUNDS.max_steps[dimension];
+}
+
+
+/**
+ * adds keys of states with each dimension at or around its bounds and checks
+ * slots of the dense table for them ( only states within all the bounds have
+ * a slot, and each of them has its own slot )
+ **/
+static void add_bound_state_keys(const Q_dense_table & dense_table,
+        std::vector<Q_state_key> & state_keys)
+{
+    const Q_dense_bounds & bounds = controller::Q_DENSE_TABLE_BOUNDS;
+    std::vector<test_steps> steps[Q_STATE_DIMENSIONS];
+    get_bound_steps<speed_x_dimension>(bounds.min_steps[0], bounds.max_steps[0], steps[0]);
+    get_bound_steps<speed_y_dimension>(bounds.min_steps[1], bounds.max_steps[1], steps[1]);
+    get_bound_steps<right_side_distance_dimension>(bounds.min_steps[2],
+            bounds.max_steps[2], steps[2]);
+    get_bound_steps<left_side_distance_dimension>(bounds.min_steps[3],
+            bounds.max_steps[3], steps[3]);
+    get_bound_steps<path_dimension>(bounds.min_steps[4], bounds.max_steps[4], steps[4]);
+    get_bound_steps<next_path_dimension>(bounds.min_steps[5], bounds.max_steps[5], steps[5]);
+
+    // speed_x can't be negative ( it is a magnitude in velocity maps )
+    steps[0].erase(steps[0].begin());
+
+    std::set<Q_state_key> added_state_keys;
+    std::vector<long> slots;
+    for(size_t a = 0; a < steps[0].size(); a++)
+    for(size_t b = 0; b < steps[1].size(); b++)
+    for(size_t c = 0; c < steps[2].size(); c++)
+    for(size_t d = 0; d < steps[3].size(); d++)
+    for(size_t e = 0; e < steps[4].size(); e++)
+    for(size_t f = 0; f < steps[5].size(); f++)
+    {
+        const Q_state_key state_key = get_dimension_key<speed_x_dimension>(steps[0][a])
+            | get_dimension_key<speed_y_dimension>(steps[1][b])
+            | get_dimension_key<right_side_distance_dimension>(steps[2][c])
+            | get_dimension_key<left_side_distance_dimension>(steps[3][d])
+            | get_dimension_key<path_dimension>(steps[4][e])
+            | get_dimension_key<next_path_dimension>(steps[5][f]);
+
+        // zero is also a bound of some dimensions
+        if(!added_state_keys.insert(state_key).second)
+        {
+            continue;
+        }
+        state_keys.push_back(state_key);
+
+        const int within_bounds = is_within_bounds(steps[0][a], 0)
+            && is_within_bounds(steps[1][b], 1) && is_within_bounds(steps[2][c], 2)
+            && is_within_bounds(steps[3][d], 3) && is_within_bounds(steps[4][e], 4)
+            && is_within_bounds(steps[5][f], 5);
+
+        const long slot = dense_table.get_slot_for(state_key);
+        if(CHECK(within_bounds ? (slot >= 0) : (slot == -1)) && slot >= 0)
+        {
+            CHECK(slot < dense_table.get_number_of_slots());
+            CHECK(dense_table.get_key_for(slot) == state_key);
+            slots.push_back(slot);
+        }
+    }
+
+    // no two states share a slot
+    std::sort(slots.begin(), slots.end());
+    CHECK(std::adjacent_find(slots.begin(), slots.end()) == slots.end());
+}
+
+
+/* checks Q values, max Q value and max Q action of a state in both maps */
+static void check_state(const Q_maps & sparse_maps, const Q_maps & dense_maps,
+        const Q_state_key state_key)
+{
+    Q_state_record sparse_record;
+    Q_state_record dense_record;
+    const int has_sparse_record = sparse_maps.get_record_for(state_key, sparse_record);
+    if(!CHECK(dense_maps.get_record_for(state_key, dense_record) == has_sparse_record)
+            || !has_sparse_record)
+    {
+        return;
+    }
+
+    CHECK(dense_record.tried_actions == sparse_record.tried_actions);
+    CHECK(dense_record.max_Q_value == sparse_record.max_Q_value);
+    CHECK(dense_record.max_Q_action == sparse_record.max_Q_action);
+    CHECK(dense_maps.get_max_Q_value_for(state_key) == sparse_maps.get_max_Q_value_for(state_key));
+
+    for(int action = 0; action < Q_ACTION_SPACE_SIZE; action++)
+    {
+        CHECK(dense_maps.get_Q_value_for(state_key, (Q_action_index) action) ==
+                sparse_maps.get_Q_value_for(state_key, (Q_action_index) action));
+    }
+}
+
+
+/* returns non-zero if first record has a lower state key */
+static int is_lower_state_key(const Q_file_record & record, const Q_file_record & other)
+{
+    return record.state_key < other.state_key;
+}
+
+
+int main()
+{
+    Q_maps sparse_maps;
+    Q_maps dense_maps;
+    if(!CHECK(dense_maps.use_dense_table(controller::Q_DENSE_TABLE_BOUNDS) == 0))
+    {
+        return finish_checks("test_Q_dense_table");
+    }
+
+    Q_dense_table dense_table(controller::Q_DENSE_TABLE_BOUNDS);
+    std::vector<Q_state_key> state_keys;
+    if(CHECK(dense_table.is_allocated()))
+    {
+        add_bound_state_keys(dense_table, state_keys);
+    }
+
+    srand(TEST_VALUES_SEED);
+    for(int i = 0; i < TEST_STATES; i++)
+    {
+        state_keys.push_back(get_random_state_key());
+    }
+
+    // same updates of both maps ( Q values of an action may go down as well )
+    for(size_t i = 0; i < state_keys.size(); i++)
+    {
+        for(int j = 0; j < TEST_STATE_UPDATES; j++)
+        {
+            const Q_action_index action = (Q_action_index) (rand() % Q_ACTION_SPACE_SIZE);
+            const float Q_value = (float) ((rand() % (2 * TEST_Q_VALUE_RANGE + 1))
+                    - TEST_Q_VALUE_RANGE);
+            sparse_maps.update_Q_value_for(state_keys[i], action, Q_value);
+            dense_maps.update_Q_value_for(state_keys[i], action, Q_value);
+        }
+    }
+
+    for(size_t i = 0; i < state_keys.size(); i++)
+    {
+        check_state(sparse_maps, dense_maps, state_keys[i]);
+    }
+
+    // a state that was never updated is not in either maps
+    const Q_state_key state_key = make_Q_state_key(1, 0.0f, 1, 1, 0.0f, 0.0f);
+    if(std::find(state_keys.begin(), state_keys.end(), state_key) == state_keys.end())
+    {
+        check_state(sparse_maps, dense_maps, state_key);
+        CHECK(dense_maps.get_Q_value_for(state_key, (Q_action_index) 0) == 0);
+    }
+
+    // both maps have the same records
+    std::vector<Q_file_record> sparse_records;
+    std::vector<Q_file_record> dense_records;
+    sparse_maps.get_all_records(sparse_records);
+    dense_maps.get_all_records(dense_records);
+    std::sort(sparse_records.begin(), sparse_records.end(), is_lower_state_key);
+    std::sort(dense_records.begin(), dense_records.end(), is_lower_state_key);
+    CHECK(are_records_equal(dense_records, sparse_records));
+
+    return finish_checks("test_Q_dense_table");
+}
@@ -0,0 +1,209 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * test_Q_files.h
+ *
+ * Helpers of tests of Q value files - a directory for the files of a test,
+ * Q maps with random Q values and comparison of records.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  TEST_Q_FILES_H_
+#define  TEST_Q_FILES_H_
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <string>
+#include <vector>
+
+#include "car222_Q_maps.h"
+
+
+// template of directories made for files of a test
+#define TEST_DIRECTORY_TEMPLATE      "/tmp/car222_test_XXXXXX"
+
+
+/* makes an empty directory for files of a test and returns its name ( empty on error ) */
+static inline std::string make_test_directory()
+{
+    char directory[] = TEST_DIRECTORY_TEMPLATE;
+    if(mkdtemp(directory) == NULL)
+    {
+        printf("couldn't make a test directory from \'%s\'\n", TEST_DIRECTORY_TEMPLATE);
+        return std::string();
+    }
+
+    return directory;
+}
+
+
+/* removes a directory made by "make_test_directory" along with its files */
+static inline void remove_test_directory(const std::string & directory)
+{
+    DIR * dir = opendir(directory.c_str());
+    if(dir == NULL)
+    {
+        return;
+    }
+
+    struct dirent * entry;
+    while((entry = readdir(dir)) != NULL)
+    {
+        if(strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+        {
+            unlink((directory + "/" + entry->d_name).c_str());
+        }
+    }
+    closedir(dir);
+    rmdir(directory.c_str());
+}
+
+
+/* returns a random key of a state as QLearner makes them ( all shards are used ) */
+static inline controller_storage::Q_state_key get_random_state_key()
+{
+    return controller_storage::make_Q_state_key((rand() % 80) - 10,
+            ((rand() % 21) - 10) / 10.0f, (rand() % 13) - 6, (rand() % 13) - 6,
+            ((rand() % 4001) - 2000) / 10.0f, ((rand() % 4001) - 2000) / 10.0f);
+}
+
+
+/* returns a random Q value ( with all the bits of a float used ) */
+static inline float get_random_Q_value()
+{
+    return ((float) rand() / RAND_MAX - 0.5f) * 200;
+}
+
+
+/* sets random Q values of random actions of "states" random states */
+static inline void fill_random_Q_values(controller_storage::Q_maps & Q_maps, const int states)
+{
+    for(int i = 0; i < states; i++)
+    {
+        const controller_storage::Q_state_key state_key = get_random_state_key();
+        const int actions = 1 + rand() % Q_ACTION_SPACE_SIZE;
+        for(int j = 0; j < actions; j++)
+        {
+            Q_maps.update_Q_value_for(state_key,
+                    (controller_storage::Q_action_index) (rand() % Q_ACTION_SPACE_SIZE),
+                    get_random_Q_value());
+        }
+    }
+}
+
+
+/* returns non-zero if both records are of same state and have same Q values */
+static inline int are_records_equal(const controller_storage::Q_file_record & record,
+        const controller_storage::Q_file_record & other)
+{
+    const controller_storage::Q_state_record & state_record = record.state_record;
+    const controller_storage::Q_state_record & other_state_record = other.state_record;
+
+    return record.state_key == other.state_key
+        && memcmp(state_record.Q_values, other_state_record.Q_values,
+                sizeof(state_record.Q_values)) == 0
+        && state_record.max_Q_value == other_state_record.max_Q_value
+        && state_record.max_Q_action == other_state_record.max_Q_action
+        && state_record.tried_actions == other_state_record.tried_actions;
+}
+
+
+/* returns non-zero if both lists have equal records in same order */
+static inline int are_records_equal(const std::vector<controller_storage::Q_file_record> & records,
+        const std::vector<controller_storage::Q_file_record> & other)
+{
+    if(records.size() != other.size())
+    {
+        return 0;
+    }
+
+    for(size_t i = 0; i < records.size(); i++)
+    {
+        if(!are_records_equal(records[i], other[i]))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+
+/* returns size of a file ( -1 if it doesn't exist ) */
+static inline long get_file_size(const std::string & file_name)
+{
+    FILE * file = fopen(file_name.c_str(), "rb");
+    if(file == NULL)
+    {
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fclose(file);
+
+    return size;
+}
+
+
+/* reads a whole file to "contents" and returns 0 on success, else -1 */
+static inline int read_file(const std::string & file_name, std::vector<char> & contents)
+{
+    const long size = get_file_size(file_name);
+    FILE * file = fopen(file_name.c_str(), "rb");
+    if(size < 0 || file == NULL)
+    {
+        if(file != NULL)
+        {
+            fclose(file);
+        }
+        return -1;
+    }
+
+    contents.resize(size);
+    const size_t read_size = fread(contents.data(), 1, size, file);
+    fclose(file);
+
+    return (read_size == (size_t) size) ? 0 : -1;
+}
+
+
+/* writes "size" bytes to a file ( replacing it ) and returns 0 on success, else -1 */
+static inline int write_file(const std::string & file_name, const char * data, const size_t size)
+{
+    FILE * file = fopen(file_name.c_str(), "wb");
+    if(file == NULL)
+    {
+        return -1;
+    }
+
+    const size_t written_size = fwrite(data, 1, size, file);
+
+    return (fclose(file) == 0 && written_size == size) ? 0 : -1;
+}
+
+
+#endif      /* ifndef TEST_Q_FILES_H_ */
@@ -0,0 +1,341 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * test_Q_journal.cpp
+ *
+ * Checks journals of Q value files - blocks appended after each race hold the
+ * states updated in that race, loading a file replays its journal, a partly
+ * written or damaged last block is discarded ( journal is truncated ), blocks
+ * already in the file are skipped and updates from several threads are kept.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "car222_Q_maps.h"
+#include "test_check.h"
+#include "test_Q_files.h"
+
+
+// random states written to the file
+#define TEST_STATES                  5000
+// seed of random Q values ( same Q values for each run )
+#define TEST_VALUES_SEED             222
+// training counter written to the file ( races after it are journaled )
+#define TEST_TRAINING_COUNTER        10
+// races whose updates are appended to the journal
+#define TEST_RACES                   3
+// updates of each race ( of states in the file and of new states )
+#define TEST_RACE_UPDATES            2000
+
+// threads updating Q values at the same time and updates of each thread
+#define TEST_THREADS                 4
+#define TEST_THREAD_UPDATES          20000
+// learning rate of updates of the threads
+#define TEST_LEARNING_RATE           0.1f
+
+
+using namespace controller_storage;
+
+
+/* records of a journal block as found in the journal file */
+typedef struct test_journal_block_struct
+{
+    Q_journal_block_header header;
+    // offset of the block in the journal and offset after its records
+    long offset;
+    long end_offset;
+
+} test_journal_block;
+
+
+/* reads headers of the blocks of a journal and returns their number ( stops at a bad block ) */
+static int read_journal_blocks(const std::string & journal_file_name,
+        std::vector<test_journal_block> & blocks)
+{
+    blocks.clear();
+    std::vector<char> contents;
+    if(read_file(journal_file_name, contents) != 0)
+    {
+        return 0;
+    }
+
+    size_t offset = 0;
+    while(offset + sizeof(Q_journal_block_header) <= contents.size())
+    {
+        test_journal_block block;
+        memcpy(&block.header, contents.data() + offset, sizeof(block.header));
+        block.offset = offset;
+        block.end_offset = offset + sizeof(block.header)
+            + block.header.record_count * sizeof(Q_file_record);
+        if(memcmp(block.header.magic, Q_JOURNAL_MAGIC, sizeof(block.header.magic)) != 0
+                || (size_t) block.end_offset > contents.size())
+        {
+            break;
+        }
+        blocks.push_back(block);
+        offset = block.end_offset;
+    }
+
+    return blocks.size();
+}
+
+
+/* updates Q values of a race - states in the maps and new states - and returns the updated states */
+static void make_race_updates(Q_maps & Q_maps, const std::vector<Q_file_record> & records,
+        std::set<Q_state_key> & updated_states)
+{
+    updated_states.clear();
+    for(int i = 0; i < TEST_RACE_UPDATES; i++)
+    {
+        const Q_state_key state_key = (i % 2 == 0 && !records.empty())
+            ? records[rand() % records.size()].state_key
+            : get_random_state_key();
+        Q_maps.update_Q_value_for(state_key,
+                (Q_action_index) (rand() % Q_ACTION_SPACE_SIZE), get_random_Q_value());
+        updated_states.insert(state_key);
+    }
+}
+
+
+/* checks that loading a file ( and replaying its journal ) gives the expected records */
+static void check_loaded_maps(const std::string & file_name,
+        const long long int training_counter, const std::vector<Q_file_record> & records)
+{
+    Q_maps loaded_maps;
+    CHECK(loaded_maps.load_maps_from_file(file_name) == training_counter);
+
+    std::vector<Q_file_record> loaded_records;
+    loaded_maps.get_all_records(loaded_records);
+    CHECK(are_records_equal(loaded_records, records));
+}
+
+
+/* arguments of a thread updating Q values */
+typedef struct test_thread_arguments_struct
+{
+    Q_maps * maps;
+    const std::vector<Q_file_record> * records;
+    unsigned int seed;
+
+} test_thread_arguments;
+
+
+/* moves Q values of random states ( in the file or new ) towards random targets */
+static void * run_updates(void * arguments)
+{
+    test_thread_arguments & thread_arguments = *((test_thread_arguments *) arguments);
+    const std::vector<Q_file_record> & records = *thread_arguments.records;
+    unsigned int seed = thread_arguments.seed;
+
+    for(int i = 0; i < TEST_THREAD_UPDATES; i++)
+    {
+        // few states, so threads often update the same state
+        const Q_state_key state_key = records[rand_r(&seed) % 500].state_key;
+        thread_arguments.maps->update_Q_value_towards(state_key,
+                (Q_action_index) (rand_r(&seed) % Q_ACTION_SPACE_SIZE),
+                ((float) rand_r(&seed) / RAND_MAX - 0.5f) * 200, TEST_LEARNING_RATE);
+    }
+
+    return NULL;
+}
+
+
+int main()
+{
+    const std::string directory = make_test_directory();
+    if(!CHECK(!directory.empty()))
+    {
+        return finish_checks("test_Q_journal");
+    }
+    const std::string file_name = directory + "/q_learner_test.bin";
+    const std::string journal_file_name = file_name + Q_JOURNAL_FILE_SUFFIX;
+
+    srand(TEST_VALUES_SEED);
+
+    // records after each race ( after the file was written for race 0 )
+    std::vector<Q_file_record> race_records[TEST_RACES + 1];
+    std::vector<char> journal;
+    {
+        Q_maps Q_maps;
+        fill_random_Q_values(Q_maps, TEST_STATES);
+        CHECK(Q_maps.write_maps_to_binary_file(file_name, TEST_TRAINING_COUNTER) == 0);
+        Q_maps.get_all_records(race_records[0]);
+        CHECK(get_file_size(journal_file_name) == -1);
+
+        // training continues with the mapped file, as in the races
+        CHECK(Q_maps.load_maps_from_file(file_name) == TEST_TRAINING_COUNTER);
+        for(int race = 1; race <= TEST_RACES; race++)
+        {
+            std::set<Q_state_key> updated_states;
+            make_race_updates(Q_maps, race_records[0], updated_states);
+            CHECK(Q_maps.append_to_journal(file_name, TEST_TRAINING_COUNTER + race) == 0);
+            Q_maps.get_all_records(race_records[race]);
+
+            // a block for each race with each state updated in the race
+            std::vector<test_journal_block> blocks;
+            CHECK(read_journal_blocks(journal_file_name, blocks) == race);
+            if(CHECK((int) blocks.size() == race))
+            {
+                const Q_journal_block_header & header = blocks[race - 1].header;
+                CHECK(header.format_version == Q_JOURNAL_FORMAT_VERSION);
+                CHECK(header.record_size == sizeof(Q_file_record));
+                CHECK(header.training_counter == TEST_TRAINING_COUNTER + race);
+                CHECK(header.record_count == updated_states.size());
+                CHECK(blocks[race - 1].end_offset == get_file_size(journal_file_name));
+            }
+        }
+    }
+    CHECK(read_file(journal_file_name, journal) == 0);
+
+    std::vector<test_journal_block> blocks;
+    if(!CHECK(read_journal_blocks(journal_file_name, blocks) == TEST_RACES))
+    {
+        remove_test_directory(directory);
+        return finish_checks("test_Q_journal");
+    }
+    const test_journal_block & last_block = blocks[TEST_RACES - 1];
+
+    // all the races are replayed, and journal is kept as it is
+    check_loaded_maps(file_name, TEST_TRAINING_COUNTER + TEST_RACES, race_records[TEST_RACES]);
+    CHECK(get_file_size(journal_file_name) == (long) journal.size());
+
+    // last block was partly written ( records, only header, part of header )
+    const long truncated_sizes[] = {
+        last_block.end_offset - 1,
+        last_block.offset + (long) sizeof(Q_journal_block_header) + 1,
+        last_block.offset + (long) sizeof(Q_journal_block_header),
+        last_block.offset + 5 };
+    for(size_t i = 0; i < sizeof(truncated_sizes) / sizeof(truncated_sizes[0]); i++)
+    {
+        CHECK(write_file(journal_file_name, journal.data(), truncated_sizes[i]) == 0);
+        check_loaded_maps(file_name, TEST_TRAINING_COUNTER + TEST_RACES - 1,
+                race_records[TEST_RACES - 1]);
+        CHECK(get_file_size(journal_file_name) == last_block.offset);
+
+        // journal is valid after it was truncated
+        check_loaded_maps(file_name, TEST_TRAINING_COUNTER + TEST_RACES - 1,
+                race_records[TEST_RACES - 1]);
+    }
+
+    // a damaged record of last block ( checksum doesn't match )
+    std::vector<char> damaged_journal(journal);
+    damaged_journal[last_block.end_offset - sizeof(Q_file_record) / 2] ^= 0x10;
+    CHECK(write_file(journal_file_name, damaged_journal.data(), damaged_journal.size()) == 0);
+    check_loaded_maps(file_name, TEST_TRAINING_COUNTER + TEST_RACES - 1,
+            race_records[TEST_RACES - 1]);
+    CHECK(get_file_size(journal_file_name) == last_block.offset);
+
+    // a damaged record of first block leaves only the file
+    damaged_journal = journal;
+    damaged_journal[blocks[0].end_offset - 1] ^= 0x01;
+    CHECK(write_file(journal_file_name, damaged_journal.data(), damaged_journal.size()) == 0);
+    check_loaded_maps(file_name, TEST_TRAINING_COUNTER, race_records[0]);
+    CHECK(get_file_size(journal_file_name) == 0);
+
+    // blocks written before the file are in the file and are skipped
+    {
+        Q_maps Q_maps;
+        CHECK(write_file(journal_file_name, journal.data(), journal.size()) == 0);
+        CHECK(Q_maps.load_maps_from_file(file_name) == TEST_TRAINING_COUNTER + TEST_RACES);
+        CHECK(Q_maps.write_maps_to_binary_file(file_name, TEST_TRAINING_COUNTER + TEST_RACES) == 0);
+        CHECK(get_file_size(journal_file_name) == -1);
+    }
+    CHECK(write_file(journal_file_name, journal.data(), last_block.offset) == 0);
+    check_loaded_maps(file_name, TEST_TRAINING_COUNTER + TEST_RACES, race_records[TEST_RACES]);
+
+    // updates from several threads at the same time are all journaled
+    std::vector<Q_file_record> threads_records;
+    {
+        Q_maps Q_maps;
+        remove(journal_file_name.c_str());
+        CHECK(Q_maps.load_maps_from_file(file_name) == TEST_TRAINING_COUNTER + TEST_RACES);
+
+        pthread_t threads[TEST_THREADS];
+        test_thread_arguments thread_arguments[TEST_THREADS];
+        for(int i = 0; i < TEST_THREADS; i++)
+        {
+            thread_arguments[i].maps = &Q_maps;
+            thread_arguments[i].records = &race_records[TEST_RACES];
+            thread_arguments[i].seed = TEST_VALUES_SEED + i;
+            CHECK(pthread_create(&threads[i], NULL, run_updates, &thread_arguments[i]) == 0);
+        }
+        for(int i = 0; i < TEST_THREADS; i++)
+        {
+            pthread_join(threads[i], NULL);
+        }
+
+        CHECK(Q_maps.append_to_journal(file_name, TEST_TRAINING_COUNTER + TEST_RACES + 1) == 0);
+        Q_maps.get_all_records(threads_records);
+    }
+    CHECK(read_journal_blocks(journal_file_name, blocks) == 1);
+    check_loaded_maps(file_name, TEST_TRAINING_COUNTER + TEST_RACES + 1, threads_records);
+
+    // journal of a file that fails validation is replayed, and the file is not
+    // written over ( a file that is too small and a file with a missing byte )
+    std::vector<char> file_contents;
+    CHECK(read_file(file_name, file_contents) == 0);
+    const std::string damaged_file_name = directory + "/q_learner_damaged.bin";
+    std::vector<Q_file_record> damaged_records;
+    {
+        Q_maps Q_maps;
+        std::set<Q_state_key> updated_states;
+        make_race_updates(Q_maps, damaged_records, updated_states);
+        CHECK(Q_maps.append_to_journal(damaged_file_name, TEST_TRAINING_COUNTER) == 0);
+        Q_maps.get_all_records(damaged_records);
+    }
+    const size_t damaged_sizes[] = {4, file_contents.size() - 1};
+    for(int i = 0; i < 2; i++)
+    {
+        CHECK(write_file(damaged_file_name, file_contents.data(), damaged_sizes[i]) == 0);
+
+        Q_maps Q_maps;
+        CHECK(Q_maps.load_maps_from_binary_file(damaged_file_name) == TEST_TRAINING_COUNTER);
+        CHECK(!Q_maps.is_using_mapped_file());
+        std::vector<Q_file_record> loaded_records;
+        Q_maps.get_all_records(loaded_records);
+        CHECK(are_records_equal(loaded_records, damaged_records));
+
+        CHECK(Q_maps.write_maps_to_binary_file(damaged_file_name, TEST_TRAINING_COUNTER) == -1);
+        CHECK(get_file_size(damaged_file_name) == (long) damaged_sizes[i]);
+        CHECK(get_file_size(damaged_file_name + Q_JOURNAL_FILE_SUFFIX) > 0);
+
+        // once the file is moved aside, Q values are written
+        if(i == 1)
+        {
+            remove(damaged_file_name.c_str());
+            CHECK(Q_maps.write_maps_to_binary_file(damaged_file_name, TEST_TRAINING_COUNTER) == 0);
+            check_loaded_maps(damaged_file_name, TEST_TRAINING_COUNTER, damaged_records);
+        }
+    }
+
+    remove_test_directory(directory);
+
+    return finish_checks("test_Q_journal");
+}
@@ -0,0 +1,248 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * test_Q_quantization.cpp
+ *
+ * Checks quantization of Q values to 16 bit levels ( Q_VALUES_INT16 ) - each
+ * Q value is within half a level of its float value ( also the largest one of
+ * a state just below a power of 2 ), non-zero Q values stay
+ * non-zero with the same sign, order of Q values and max Q action are kept,
+ * and a quantized binary Q value file is loaded with the quantized values.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+
+#include "car222_Q_maps.h"
+#include "car222_Q_text_codec.h"
+#include "test_check.h"
+#include "test_Q_files.h"
+
+
+// random records quantized ( for each way of making Q values )
+#define TEST_RECORDS                 200000
+// random states written to the file
+#define TEST_STATES                  20000
+// seed of random Q values ( same Q values for each run )
+#define TEST_VALUES_SEED             222
+// training counter written to the file
+#define TEST_TRAINING_COUNTER        1234
+
+// smallest exponent of a quantized record ( smaller Q values are not within half a level )
+#define TEST_MIN_Q_EXPONENT          (-128)
+
+
+using namespace controller_storage;
+
+
+/* returns a float with random bits ( not nan or infinity ) */
+static float get_random_float_bits()
+{
+    float value;
+    do
+    {
+        const unsigned int bits = ((unsigned int) rand() << 16) ^ (unsigned int) rand();
+        memcpy(&value, &bits, sizeof(value));
+    } while(!isfinite(value));
+
+    return value;
+}
+
+
+/* returns a Q value just below a power of 2 ( largest level is rounded up there ) */
+static float get_Q_value_below_power_of_2()
+{
+    const float value = ldexpf(1.0f, (rand() % 40) - 20) * (1.0f - ldexpf(rand() % 64, -24));
+    return (rand() % 2) ? value : -value;
+}
+
+
+/* makes a record with random tried actions and Q values made by "get_Q_value" */
+static void make_random_record(Q_state_record & state_record, float (* get_Q_value)())
+{
+    memset(&state_record, 0, sizeof(state_record));
+    state_record.tried_actions = rand() % (1u << Q_ACTION_SPACE_SIZE);
+    for(int i = 0; i < Q_ACTION_SPACE_SIZE; i++)
+    {
+        if(state_record.tried_actions & (1u << i))
+        {
+            // some Q values are zero or same as other Q values
+            const int kind = rand() % 16;
+            state_record.Q_values[i] = (kind == 0) ? 0.0f :
+                ((kind == 1 && i > 0) ? state_record.Q_values[i - 1] : get_Q_value());
+        }
+    }
+    find_max_Q(state_record);
+}
+
+
+/* checks Q values of a quantized record against the float record */
+static void check_quantized_record(const Q_state_record & state_record,
+        const Q_quantized_record & quantized_record)
+{
+    Q_state_record dequantized_record;
+    dequantize_Q_record(quantized_record, dequantized_record);
+
+    CHECK(quantized_record.tried_actions == state_record.tried_actions);
+    CHECK(dequantized_record.tried_actions == state_record.tried_actions);
+    CHECK(dequantized_record.max_Q_action == state_record.max_Q_action);
+    CHECK(dequantized_record.max_Q_value
+            == dequantized_record.Q_values[state_record.max_Q_action]);
+
+    const double half_level = ldexp(1.0, quantized_record.Q_exponent) / 2;
+    for(int i = 0; i < Q_ACTION_SPACE_SIZE; i++)
+    {
+        const float Q_value = state_record.Q_values[i];
+        const float dequantized_Q_value = dequantized_record.Q_values[i];
+        if(!(state_record.tried_actions & (1u << i)))
+        {
+            CHECK(quantized_record.Q_levels[i] == 0);
+            continue;
+        }
+
+        // within half a level ( within a level if it is less than half a level, as it
+        // doesn't become zero ), unless Q values are too small for the smallest exponent
+        if(quantized_record.Q_exponent > TEST_MIN_Q_EXPONENT)
+        {
+            const double error = fabs((double) dequantized_Q_value - Q_value);
+            if(!CHECK((fabs(Q_value) < half_level) ? (error <= 2 * half_level)
+                        : (error <= half_level)))
+            {
+                printf("Q value %.9g quantized to %.9g ( level %d, exponent %d )\n",
+                        Q_value, dequantized_Q_value,
+                        quantized_record.Q_levels[i], quantized_record.Q_exponent);
+            }
+        }
+
+        // zero stays zero, and others keep their sign
+        CHECK((Q_value == 0) == (dequantized_Q_value == 0));
+        CHECK((Q_value < 0) == (dequantized_Q_value < 0));
+
+        // order of Q values is kept ( and max Q value is still the max )
+        for(int j = 0; j < Q_ACTION_SPACE_SIZE; j++)
+        {
+            if(state_record.tried_actions & (1u << j))
+            {
+                CHECK(!(Q_value < state_record.Q_values[j])
+                        || dequantized_Q_value <= dequantized_record.Q_values[j]);
+            }
+        }
+        CHECK(dequantized_Q_value <= dequantized_record.max_Q_value);
+    }
+}
+
+
+/* checks quantization of random records with Q values made by "get_Q_value" */
+static void check_records(float (* get_Q_value)())
+{
+    for(int i = 0; i < TEST_RECORDS; i++)
+    {
+        Q_state_record state_record;
+        make_random_record(state_record, get_Q_value);
+
+        const Q_state_key state_key = get_random_state_key();
+        Q_quantized_record quantized_record;
+        quantize_Q_record(state_key, state_record, quantized_record);
+        CHECK(quantized_record.state_key == state_key);
+        check_quantized_record(state_record, quantized_record);
+    }
+}
+
+
+/* checks a quantized binary Q value file and loading it */
+static void check_file(const std::string & file_name)
+{
+    std::vector<Q_file_record> records;
+    {
+        Q_maps Q_maps;
+        fill_random_Q_values(Q_maps, TEST_STATES);
+        Q_maps.get_all_records(records);
+        Q_maps.set_binary_value_encoding(Q_VALUES_INT16);
+        CHECK(Q_maps.write_maps_to_binary_file(file_name, TEST_TRAINING_COUNTER) == 0);
+    }
+
+    std::vector<char> contents;
+    if(!CHECK(read_file(file_name, contents) == 0)
+            || !CHECK(contents.size() >= sizeof(Q_binary_header)))
+    {
+        return;
+    }
+    const Q_binary_header & header = *((const Q_binary_header *) contents.data());
+    CHECK(header.value_encoding == Q_VALUES_INT16);
+    CHECK(header.record_size == sizeof(Q_quantized_record));
+    CHECK(header.record_size == 32);
+    CHECK(header.record_count == records.size());
+    CHECK(contents.size()
+            == sizeof(Q_binary_header) + records.size() * sizeof(Q_quantized_record));
+
+    // records are loaded with quantized Q values
+    std::vector<Q_file_record> expected_records(records.size());
+    for(size_t i = 0; i < records.size(); i++)
+    {
+        Q_quantized_record quantized_record;
+        quantize_Q_record(records[i].state_key, records[i].state_record, quantized_record);
+        check_quantized_record(records[i].state_record, quantized_record);
+
+        expected_records[i].state_key = records[i].state_key;
+        dequantize_Q_record(quantized_record, expected_records[i].state_record);
+    }
+
+    Q_maps loaded_maps;
+    CHECK(loaded_maps.load_maps_from_file(file_name) == TEST_TRAINING_COUNTER);
+    std::vector<Q_file_record> loaded_records;
+    loaded_maps.get_all_records(loaded_records);
+    CHECK(are_records_equal(loaded_records, expected_records));
+    for(size_t i = 0; i < expected_records.size(); i++)
+    {
+        const Q_state_record & state_record = expected_records[i].state_record;
+        CHECK(loaded_maps.get_max_Q_value_for(expected_records[i].state_key)
+                == state_record.max_Q_value);
+        CHECK(loaded_maps.get_Q_value_for(expected_records[i].state_key,
+                    state_record.max_Q_action) == state_record.max_Q_value);
+    }
+}
+
+
+int main()
+{
+    const std::string directory = make_test_directory();
+    if(!CHECK(!directory.empty()))
+    {
+        return finish_checks("test_Q_quantization");
+    }
+
+    srand(TEST_VALUES_SEED);
+    check_records(get_random_Q_value);
+    check_records(get_random_float_bits);
+    check_records(get_Q_value_below_power_of_2);
+    check_file(directory + "/q_learner_test.bin");
+
+    remove_test_directory(directory);
+
+    return finish_checks("test_Q_quantization");
+}
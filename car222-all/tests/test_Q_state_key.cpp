@@ -0,0 +1,178 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * test_Q_state_key.cpp
+ *
+ * Checks that a Q_state_key keeps values of a state as STATE_PRINT_FORMAT
+ * does - packing and unpacking a key gives the same key, unpacked values are
+ * printed as the values they were packed from, and two states have the same
+ * key only if they are printed the same. Also checks saturation of values out
+ * of range and action indices.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "car222_string_formats.h"
+#include "car222_Q_state_key.h"
+#include "test_check.h"
+
+
+// random states checked
+#define TEST_STATES                  200000
+// seed of random states ( same states for each run )
+#define TEST_STATES_SEED             222
+// size of a printed state ( longer than STATE_NAME_LENGTH, so a value out of
+// its width is not cut )
+#define STATE_STRING_SIZE            64
+
+
+using namespace controller_storage;
+
+
+/* returns a random value in [min_value, max_value] */
+static float get_random_value(const float min_value, const float max_value)
+{
+    return min_value + (max_value - min_value) * ((float) rand() / RAND_MAX);
+}
+
+
+/* returns a random value in [min_value, max_value] rounded to tenths ( ties are likely ) */
+static float get_random_tenths(const float min_value, const float max_value)
+{
+    return roundf(get_random_value(min_value, max_value) * 20) / 20;
+}
+
+
+/* prints a state as it is printed in a Q value file */
+static void print_state(char * state_string, const int speed_x, const float speed_y,
+        const int right_side_distance, const int left_side_distance,
+        const float path, const float next_path)
+{
+    snprintf(state_string, STATE_STRING_SIZE, STATE_PRINT_FORMAT, speed_x, speed_y,
+            right_side_distance, left_side_distance, path, next_path);
+}
+
+
+/* checks packing and unpacking of random states within ranges that QLearner gives */
+static void check_round_trip()
+{
+    char state_string[STATE_STRING_SIZE];
+    char unpacked_string[STATE_STRING_SIZE];
+    char previous_string[STATE_STRING_SIZE] = "";
+    Q_state_key previous_key = 0;
+
+    for(int i = 0; i < TEST_STATES; i++)
+    {
+        const int speed_x = (rand() % 121) - 20;
+        // half of the values are on ties of rounding to tenths
+        const float speed_y = (i & 1) ? get_random_value(-1, 1) : get_random_tenths(-1, 1);
+        const int right_side_distance = (rand() % 13) - 6;
+        const int left_side_distance = (rand() % 13) - 6;
+        const float path = (i & 1) ? get_random_value(-200, 200) : get_random_tenths(-5, 5);
+        const float next_path = (i & 1) ? get_random_value(-200, 200) : get_random_tenths(-5, 5);
+
+        const Q_state_key key = make_Q_state_key(speed_x, speed_y,
+                right_side_distance, left_side_distance, path, next_path);
+        CHECK((key >> Q_STATE_KEY_BITS) == 0);
+
+        int unpacked_speed_x, unpacked_right_side_distance, unpacked_left_side_distance;
+        float unpacked_speed_y, unpacked_path, unpacked_next_path;
+        read_Q_state_key(key, unpacked_speed_x, unpacked_speed_y,
+                unpacked_right_side_distance, unpacked_left_side_distance,
+                unpacked_path, unpacked_next_path);
+
+        // unpacked values are packed to the same key
+        CHECK(make_Q_state_key(unpacked_speed_x, unpacked_speed_y,
+                    unpacked_right_side_distance, unpacked_left_side_distance,
+                    unpacked_path, unpacked_next_path) == key);
+
+        // and they are printed as the values they were packed from
+        print_state(state_string, speed_x, speed_y,
+                right_side_distance, left_side_distance, path, next_path);
+        print_state(unpacked_string, unpacked_speed_x, unpacked_speed_y,
+                unpacked_right_side_distance, unpacked_left_side_distance,
+                unpacked_path, unpacked_next_path);
+        if(!CHECK(strcmp(state_string, unpacked_string) == 0))
+        {
+            printf("    \'%s\' is unpacked as \'%s\'\n", state_string, unpacked_string);
+        }
+
+        // states have same key only if they are printed the same
+        CHECK((key == previous_key) == (strcmp(state_string, previous_string) == 0));
+        previous_key = key;
+        strcpy(previous_string, state_string);
+    }
+}
+
+
+/* checks states that differ only in sign of zero and values out of range */
+static void check_edge_values()
+{
+    // "+000.0" and "-000.0" are different states in Q value files
+    CHECK(make_Q_state_key(10, 0.0f, 1, 1, 0.0f, 0.0f)
+            != make_Q_state_key(10, 0.0f, 1, 1, -0.0f, 0.0f));
+    CHECK(make_Q_state_key(10, 0.01f, 1, 1, 0.0f, 0.0f)
+            != make_Q_state_key(10, -0.01f, 1, 1, 0.0f, 0.0f));
+    CHECK(make_Q_state_key(10, 0.01f, 1, 1, 0.0f, 0.0f)
+            == make_Q_state_key(10, 0.0f, 1, 1, 0.0f, 0.0f));
+
+    // magnitudes saturate instead of spilling into the next dimension
+    const Q_state_key key = make_Q_state_key(100000, 0.0f, 1, 1, 1e6f, -1e6f);
+    CHECK(speed_x_dimension::magnitude(key) == speed_x_dimension::MAX_MAGNITUDE);
+    CHECK(speed_y_dimension::magnitude(key) == 0);
+    CHECK(path_dimension::magnitude(key) == path_dimension::MAX_MAGNITUDE);
+    CHECK(next_path_dimension::magnitude(key) == next_path_dimension::MAX_MAGNITUDE);
+    CHECK(next_path_dimension::is_negative(key));
+    CHECK(!path_dimension::is_negative(key));
+    CHECK((key >> Q_STATE_KEY_BITS) == 0);
+}
+
+
+/* checks that action indices and accel values of actions map to each other */
+static void check_action_indices()
+{
+    for(int i = 0; i < Q_ACTION_SPACE_SIZE; i++)
+    {
+        CHECK(make_Q_action_index(get_Q_action_value(i)) == i);
+        // nearest action is found
+        CHECK(make_Q_action_index(get_Q_action_value(i) + 0.4f / (Q_ACTION_SPACE_SIZE - 1)) == i);
+    }
+    CHECK(make_Q_action_index(-0.5f) == 0);
+    CHECK(make_Q_action_index(1.5f) == Q_ACTION_SPACE_SIZE - 1);
+}
+
+
+int main()
+{
+    srand(TEST_STATES_SEED);
+
+    check_round_trip();
+    check_edge_values();
+    check_action_indices();
+
+    return finish_checks("test_Q_state_key");
+}
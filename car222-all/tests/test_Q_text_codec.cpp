@@ -0,0 +1,361 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * test_Q_text_codec.cpp
+ *
+ * Checks reading and writing of text Q value files - lines parsed without
+ * sscanf give the same states, actions and Q values ( bit for bit ) as
+ * scanning them with sscanf ( MAP_READ_FORMAT ) and strtof, and a written
+ * file is read back with the printed Q values of each state.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+
+#include "car222_string_formats.h"
+#include "car222_Q_maps.h"
+#include "car222_Q_text_codec.h"
+#include "test_check.h"
+#include "test_Q_files.h"
+
+
+// random lines parsed ( for each way of printing Q values )
+#define TEST_LINES                   100000
+// random states written to the file ( more than a chunk for each thread )
+#define TEST_STATES                  40000
+// seed of random values ( same values for each run )
+#define TEST_VALUES_SEED             222
+// training counter written to the file
+#define TEST_TRAINING_COUNTER        1234
+
+// size of buffers for lines and for parts of a line
+#define TEST_LINE_SIZE               128
+
+
+using namespace controller_storage;
+
+
+/* Q values printed in other ways than MAP_WRITE_FORMAT, which are left to strtof */
+static const char * const other_Q_values[] =
+{
+    // halfway between two floats with few digits
+    "+16777217.000000", "-16777219.000000", "+33554434.000000", "+33554438.5",
+    // more digits than are exact in a double
+    "+0.1000000000000000055511151231257827", "-3.40282346638528859811704183484516925440e+38",
+    "+1.00000005960464477539062500000000001", "+123456789012345678901234567890",
+    // exponents, hexadecimal and special values
+    "1e10", "-2.5E-3", "0x1p-3", "inf", "-inf", "nan", "1e50", "1e-50",
+    // no sign, leading zeros, spaces and no fraction
+    "42", "0007.250", " 2.5", "-.5", "+5.", "-0.000000", "+000000.000000"
+};
+
+
+/* scans a line like older versions of Q_maps did ( MAP_READ_FORMAT and STATE_READ_FORMAT ) */
+static int scan_line(const char * line, Q_state_key & state_key,
+        Q_action_index & action_index, float & Q_value)
+{
+    char state_name[STATE_NAME_LENGTH + 1];
+    char action_name[ACTION_NAME_LENGTH + 1];
+    if(sscanf(line, MAP_READ_FORMAT, state_name, action_name, &Q_value) != 3)
+    {
+        return -1;
+    }
+    state_name[STATE_NAME_LENGTH] = '\0';
+    action_name[ACTION_NAME_LENGTH] = '\0';
+
+    int speed_x, right_side_distance, left_side_distance;
+    float speed_y, path, next_path, accel;
+    if(sscanf(state_name, STATE_READ_FORMAT, &speed_x, &speed_y,
+                &right_side_distance, &left_side_distance, &path, &next_path) != 6 ||
+            sscanf(action_name, ACTION_READ_FORMAT, &accel) != 1)
+    {
+        return -1;
+    }
+
+    state_key = make_Q_state_key(speed_x, speed_y,
+            right_side_distance, left_side_distance, path, next_path);
+    action_index = make_Q_action_index(accel);
+    return 0;
+}
+
+
+/* returns non-zero if both floats have same bits ( or both are nan ) */
+static int are_floats_same(const float value, const float other)
+{
+    return (isnan(value) && isnan(other)) || memcmp(&value, &other, sizeof(float)) == 0;
+}
+
+
+/* checks parsing a line with given Q value text against sscanf and strtof */
+static void check_line(const Q_state_key state_key, const Q_action_index action_index,
+        const char * Q_value_text)
+{
+    int speed_x, right_side_distance, left_side_distance;
+    float speed_y, path, next_path;
+    read_Q_state_key(state_key, speed_x, speed_y,
+            right_side_distance, left_side_distance, path, next_path);
+
+    char line[TEST_LINE_SIZE];
+    snprintf(line, sizeof(line), STATE_PRINT_FORMAT "|" ACTION_PRINT_FORMAT "=%s\n",
+            speed_x, speed_y, right_side_distance, left_side_distance, path, next_path,
+            get_Q_action_value(action_index), Q_value_text);
+
+    Q_state_key parsed_state_key = 0;
+    Q_action_index parsed_action_index = 0;
+    float parsed_Q_value = 0;
+    if(!CHECK(parse_Q_text_line(line, line + strlen(line) - 1,
+                    parsed_state_key, parsed_action_index, parsed_Q_value) == 0))
+    {
+        printf("line - %s", line);
+        return;
+    }
+
+    Q_state_key scanned_state_key = 0;
+    Q_action_index scanned_action_index = 0;
+    float scanned_Q_value = 0;
+    if(CHECK(scan_line(line, scanned_state_key, scanned_action_index, scanned_Q_value) == 0))
+    {
+        CHECK(parsed_state_key == scanned_state_key);
+        CHECK(parsed_action_index == scanned_action_index);
+        if(!CHECK(are_floats_same(parsed_Q_value, scanned_Q_value)))
+        {
+            printf("line - %s", line);
+        }
+    }
+
+    CHECK(parsed_state_key == state_key);
+    CHECK(parsed_action_index == action_index);
+    CHECK(are_floats_same(parsed_Q_value, strtof(Q_value_text, NULL)));
+}
+
+
+/* returns a float with random bits ( not nan or infinity ) */
+static float get_random_float_bits()
+{
+    float value;
+    do
+    {
+        const unsigned int bits = ((unsigned int) rand() << 16) ^ (unsigned int) rand();
+        memcpy(&value, &bits, sizeof(value));
+    } while(!isfinite(value));
+
+    return value;
+}
+
+
+/* writes random decimal digits with a decimal point and a sign to "text" */
+static void make_random_digits(char * text, const size_t size)
+{
+    const int digits = 1 + rand() % 24;
+    const int point = rand() % (digits + 1);
+
+    size_t length = 0;
+    text[length++] = (rand() % 2) ? '+' : '-';
+    for(int i = 0; i < digits && length < size - 2; i++)
+    {
+        if(i == point)
+        {
+            text[length++] = '.';
+        }
+        text[length++] = '0' + rand() % 10;
+    }
+    text[length] = '\0';
+}
+
+
+/* checks lines with Q values printed as MAP_WRITE_FORMAT does and in other ways */
+static void check_lines()
+{
+    char Q_value_text[TEST_LINE_SIZE];
+    for(int i = 0; i < TEST_LINES; i++)
+    {
+        const Q_state_key state_key = get_random_state_key();
+        const Q_action_index action_index = (Q_action_index) (rand() % Q_ACTION_SPACE_SIZE);
+
+        // as written by Q_maps
+        snprintf(Q_value_text, sizeof(Q_value_text), "%+012f", get_random_Q_value());
+        check_line(state_key, action_index, Q_value_text);
+
+        // any float, with as many digits as needed to read it back exactly
+        snprintf(Q_value_text, sizeof(Q_value_text), "%+012f", get_random_float_bits());
+        check_line(state_key, action_index, Q_value_text);
+        snprintf(Q_value_text, sizeof(Q_value_text), "%.9g", get_random_float_bits());
+        check_line(state_key, action_index, Q_value_text);
+
+        // decimal numbers with up to 24 digits
+        make_random_digits(Q_value_text, sizeof(Q_value_text));
+        check_line(state_key, action_index, Q_value_text);
+    }
+
+    for(size_t i = 0; i < sizeof(other_Q_values) / sizeof(other_Q_values[0]); i++)
+    {
+        check_line(get_random_state_key(), (Q_action_index) (i % Q_ACTION_SPACE_SIZE),
+                other_Q_values[i]);
+    }
+
+    // lines that are not Q values
+    const char * const bad_lines[] =
+    {
+        "", "stats", "1234", "+12|+0.5|+03|-02|+012.0|-003.0",
+        "+12|+0.5|+03|-02|+012.0|-003.0|0.250=", "+12|x0.5|+03|-02|+012.0|-003.0|0.250=+1.0"
+    };
+    for(size_t i = 0; i < sizeof(bad_lines) / sizeof(bad_lines[0]); i++)
+    {
+        Q_state_key state_key;
+        Q_action_index action_index;
+        float Q_value;
+        CHECK(parse_Q_text_line(bad_lines[i], bad_lines[i] + strlen(bad_lines[i]),
+                    state_key, action_index, Q_value) == -1);
+    }
+}
+
+
+/* checks writing records to a text Q value file and reading them back */
+static void check_file(const std::string & file_name)
+{
+    std::vector<Q_file_record> records;
+    {
+        Q_maps Q_maps;
+        fill_random_Q_values(Q_maps, TEST_STATES);
+        Q_maps.get_all_records(records);
+    }
+
+    // records of each shard, and the records expected to be read ( printed Q values )
+    std::vector<Q_file_record> shard_records[Q_BINARY_SHARDS];
+    std::vector<Q_file_record> expected_records[Q_BINARY_SHARDS];
+    long long int line_count = 0;
+    for(size_t i = 0; i < records.size(); i++)
+    {
+        const int shard = get_Q_shard_for(speed_x_dimension::magnitude(records[i].state_key));
+        shard_records[shard].push_back(records[i]);
+
+        Q_file_record expected_record;
+        memset(&expected_record, 0, sizeof(expected_record));
+        expected_record.state_key = records[i].state_key;
+        Q_state_record & state_record = expected_record.state_record;
+        state_record.tried_actions = records[i].state_record.tried_actions;
+        for(int j = 0; j < Q_ACTION_SPACE_SIZE; j++)
+        {
+            if(state_record.tried_actions & (1u << j))
+            {
+                char Q_value_text[TEST_LINE_SIZE];
+                snprintf(Q_value_text, sizeof(Q_value_text), "%+012f",
+                        records[i].state_record.Q_values[j]);
+                state_record.Q_values[j] = strtof(Q_value_text, NULL);
+                line_count++;
+            }
+        }
+        find_max_Q(state_record);
+        expected_records[shard].push_back(expected_record);
+    }
+
+    FILE * file = fopen(file_name.c_str(), "w");
+    if(!CHECK(file != NULL))
+    {
+        return;
+    }
+    CHECK(write_Q_text_file(file, shard_records, TEST_TRAINING_COUNTER) == 0);
+    CHECK(fclose(file) == 0);
+
+    Q_text_contents contents;
+    CHECK(read_Q_text_file(file_name.c_str(), contents) == 0);
+    CHECK(contents.has_stats);
+    CHECK(contents.training_counter == TEST_TRAINING_COUNTER);
+    CHECK(contents.line_count == line_count);
+    CHECK(contents.skipped_line_count == 0);
+    for(int shard = 0; shard < Q_BINARY_SHARDS; shard++)
+    {
+        CHECK(are_records_equal(contents.shard_records[shard], expected_records[shard]));
+    }
+}
+
+
+/* checks reading a file with lines out of order, repeated lines and a bad line */
+static void check_unordered_file(const std::string & file_name)
+{
+    const char text[] =
+        "+12|+0.5|+03|-02|+012.0|-003.0|0.250=+0001.000000\n"
+        "-05|-0.3|+01|+00|-100.5|+050.0|1.000=-0002.500000\n"
+        "not a line of Q values\n"
+        "+12|+0.5|+03|-02|+012.0|-003.0|0.500=+0003.000000\n"
+        "+12|+0.5|+03|-02|+012.0|-003.0|0.250=+0004.000000\n"
+        "stats\n"
+        "77\n"
+        "+12|+0.5|+03|-02|+012.0|-003.0|0.250=+0005.000000\n";
+    CHECK(write_file(file_name, text, sizeof(text) - 1) == 0);
+
+    Q_text_contents contents;
+    CHECK(read_Q_text_file(file_name.c_str(), contents) == 0);
+    CHECK(contents.has_stats);
+    CHECK(contents.training_counter == 77);
+    CHECK(contents.line_count == 4);
+    CHECK(contents.skipped_line_count == 1);
+
+    const Q_state_key state_key = make_Q_state_key(12, 0.5f, 3, -2, 12.0f, -3.0f);
+    const Q_state_key other_state_key = make_Q_state_key(-5, -0.3f, 1, 0, -100.5f, 50.0f);
+    std::vector<Q_file_record> & records = contents.shard_records[
+        get_Q_shard_for(speed_x_dimension::magnitude(state_key))];
+    if(CHECK(records.size() == 1) && CHECK(records[0].state_key == state_key))
+    {
+        // last line of an action is used
+        const Q_state_record & state_record = records[0].state_record;
+        CHECK(state_record.tried_actions == ((1u << make_Q_action_index(0.25f))
+                    | (1u << make_Q_action_index(0.5f))));
+        CHECK(state_record.Q_values[make_Q_action_index(0.25f)] == 4.0f);
+        CHECK(state_record.Q_values[make_Q_action_index(0.5f)] == 3.0f);
+        CHECK(state_record.max_Q_value == 4.0f);
+        CHECK(state_record.max_Q_action == make_Q_action_index(0.25f));
+    }
+
+    std::vector<Q_file_record> & other_records = contents.shard_records[
+        get_Q_shard_for(speed_x_dimension::magnitude(other_state_key))];
+    if(CHECK(other_records.size() == 1) && CHECK(other_records[0].state_key == other_state_key))
+    {
+        CHECK(other_records[0].state_record.Q_values[Q_ACTION_SPACE_SIZE - 1] == -2.5f);
+        CHECK(other_records[0].state_record.max_Q_value == -2.5f);
+    }
+}
+
+
+int main()
+{
+    const std::string directory = make_test_directory();
+    if(!CHECK(!directory.empty()))
+    {
+        return finish_checks("test_Q_text_codec");
+    }
+
+    srand(TEST_VALUES_SEED);
+    check_lines();
+    check_file(directory + "/q_learner_test.txt");
+    check_unordered_file(directory + "/q_learner_test_unordered.txt");
+
+    remove_test_directory(directory);
+
+    return finish_checks("test_Q_text_codec");
+}
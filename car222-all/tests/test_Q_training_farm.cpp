@@ -0,0 +1,181 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * test_Q_training_farm.cpp
+ *
+ * Checks merging of Q values and visit counts of two workers of a training
+ * farm - Q values weighted by visits since last merge, base Q values of
+ * actions no worker has visited since last merge, a worker restarted from an
+ * older merge ( fewer visits than base ) and actions tried by only one worker.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "car222_training_farm.h"
+#include "test_check.h"
+
+
+using namespace controller_storage;
+
+
+/* returns key of a test state ( states differ in their speed_x ) */
+static Q_state_key get_test_state_key(const int state)
+{
+    return make_Q_state_key(10 * state, 0.0f, 0, 0, 0.0f, 0.0f);
+}
+
+
+/* sets Q value and visit count of a state-action pair */
+static void set_pair(Q_maps & maps, Q_visit_counts & visits, const int state,
+        const int action, const float Q_value, const unsigned int visit_count)
+{
+    const Q_state_key state_key = get_test_state_key(state);
+    maps.update_Q_value_for(state_key, (Q_action_index) action, Q_value);
+
+    Q_visit_record visit_record;
+    visits.get_visit_record(state_key, visit_record);
+    visit_record.visit_counts[action] = visit_count;
+    visits.set_visit_record(state_key, visit_record);
+}
+
+
+/* checks merged Q value and visit count of a state-action pair */
+static void check_pair(const Q_maps & maps, const Q_visit_counts & visits,
+        const int state, const int action, const float Q_value,
+        const unsigned int visit_count)
+{
+    const Q_state_key state_key = get_test_state_key(state);
+
+    Q_state_record state_record;
+    CHECK(maps.get_record_for(state_key, state_record) == 1);
+    CHECK(state_record.tried_actions & (1u << action));
+    CHECK(maps.get_Q_value_for(state_key, (Q_action_index) action) == Q_value);
+
+    Q_visit_record visit_record;
+    visits.get_visit_record(state_key, visit_record);
+    CHECK(visit_record.visit_counts[action] == visit_count);
+}
+
+
+/* checks that only the given actions of a state are tried in merged Q values */
+static void check_tried_actions(const Q_maps & maps, const int state,
+        const unsigned short tried_actions)
+{
+    Q_state_record state_record;
+    maps.get_record_for(get_test_state_key(state), state_record);
+    CHECK(state_record.tried_actions == tried_actions);
+}
+
+
+int main()
+{
+    // Q values and visits of last merge ( base ) and of two workers
+    Q_maps base_maps;
+    Q_visit_counts base_visits;
+    Q_maps worker_maps[2];
+    Q_visit_counts worker_visits[2];
+
+    // state 1 - action 0 is visited by worker 0 since last merge, while worker 1
+    // has restarted from an older merge ( fewer visits than base ). Action 1 is
+    // visited only by worker 1.
+    set_pair(base_maps, base_visits, 1, 0, 10.0f, 4);
+    set_pair(base_maps, base_visits, 1, 1, 20.0f, 2);
+    set_pair(worker_maps[0], worker_visits[0], 1, 0, 12.0f, 7);
+    set_pair(worker_maps[0], worker_visits[0], 1, 1, 20.0f, 2);
+    set_pair(worker_maps[1], worker_visits[1], 1, 0, 50.0f, 2);
+    set_pair(worker_maps[1], worker_visits[1], 1, 1, 26.0f, 3);
+
+    // state 2 - no worker has visited action 2 since last merge ( worker 1
+    // has a Q value of an older merge )
+    set_pair(base_maps, base_visits, 2, 2, 5.0f, 1);
+    set_pair(worker_maps[0], worker_visits[0], 2, 2, 5.0f, 1);
+    set_pair(worker_maps[1], worker_visits[1], 2, 2, 7.0f, 0);
+
+    // state 3 - new state tried only by worker 1
+    set_pair(worker_maps[1], worker_visits[1], 3, 3, -8.0f, 2);
+
+    // state 4 - new state tried only by worker 0, with no visits counted
+    set_pair(worker_maps[0], worker_visits[0], 4, 4, 3.0f, 0);
+
+    // state 5 - new state visited by both workers ( 1 and 3 visits )
+    set_pair(worker_maps[0], worker_visits[0], 5, 5, 1.0f, 1);
+    set_pair(worker_maps[1], worker_visits[1], 5, 5, 4.0f, 3);
+
+    // state 6 - worker 0 tried another action besides the action of base
+    set_pair(base_maps, base_visits, 6, 0, -2.0f, 5);
+    set_pair(worker_maps[0], worker_visits[0], 6, 0, -2.0f, 5);
+    set_pair(worker_maps[0], worker_visits[0], 6, 7, 9.0f, 2);
+    set_pair(worker_maps[1], worker_visits[1], 6, 0, -4.0f, 6);
+
+    std::vector<const Q_maps *> worker_map_list;
+    std::vector<const Q_visit_counts *> worker_visit_list;
+    for(int worker = 0; worker < 2; worker++)
+    {
+        worker_map_list.push_back(&worker_maps[worker]);
+        worker_visit_list.push_back(&worker_visits[worker]);
+    }
+
+    Q_maps merged_maps;
+    Q_visit_counts merged_visits;
+    merge_farm_Q_values(base_maps, base_visits, worker_map_list, worker_visit_list,
+            merged_maps, merged_visits);
+
+    // visits since last merge weight Q values and are added to base visits
+    check_pair(merged_maps, merged_visits, 1, 0, 12.0f, 7);
+    check_pair(merged_maps, merged_visits, 1, 1, 26.0f, 3);
+    check_tried_actions(merged_maps, 1, 0x03);
+
+    // Q value of base is kept for an action not visited since last merge
+    check_pair(merged_maps, merged_visits, 2, 2, 5.0f, 1);
+    check_tried_actions(merged_maps, 2, 1u << 2);
+
+    // actions tried by only one worker have its Q value
+    check_pair(merged_maps, merged_visits, 3, 3, -8.0f, 2);
+    check_tried_actions(merged_maps, 3, 1u << 3);
+    check_tried_actions(merged_maps, 4, 1u << 4);
+    CHECK(merged_maps.get_Q_value_for(get_test_state_key(4), (Q_action_index) 4) == 3.0f);
+
+    // a state without visits has no visit record
+    Q_visit_record visit_record;
+    CHECK(merged_visits.get_visit_record(get_test_state_key(4), visit_record) == 0);
+
+    // ( 1 * 1 + 3 * 4 ) / 4
+    check_pair(merged_maps, merged_visits, 5, 5, 3.25f, 4);
+
+    // visits of worker 1 since last merge ( 1 ) and none of worker 0
+    check_pair(merged_maps, merged_visits, 6, 0, -4.0f, 6);
+    check_pair(merged_maps, merged_visits, 6, 7, 9.0f, 2);
+    check_tried_actions(merged_maps, 6, (1u << 0) | (1u << 7));
+
+    // merged maps have states of base and of both workers
+    std::vector<Q_file_record> merged_records;
+    merged_maps.get_all_records(merged_records);
+    CHECK(merged_records.size() == 6);
+    CHECK(merged_visits.get_number_of_states() == 5);
+
+    return finish_checks("test_Q_training_farm");
+}
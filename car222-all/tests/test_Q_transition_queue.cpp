@@ -0,0 +1,322 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * test_Q_transition_queue.cpp
+ *
+ * Checks the queue of transitions between the driving thread and the learner
+ * thread - capacity, full and empty queue, order of transitions taken out by
+ * another thread, and Q values updated by a learner thread ( which sleeps
+ * while the queue is empty ) being same as Q values updated while driving.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <vector>
+
+#include "car222_Q_maps.h"
+#include "q_transition_queue.h"
+#include "q_learning.h"
+#include "test_check.h"
+#include "test_Q_files.h"
+
+
+// transitions put by the producer thread and capacity of its queue
+#define TEST_TRANSITIONS             5000000
+#define TEST_QUEUE_CAPACITY          64
+
+// steps learnt by QLearners, and steps after which the driving thread pauses
+#define TEST_STEPS                   200000
+#define TEST_PAUSE_STEPS             5000
+// capacity of transition queue of a learner thread ( small, so it gets full )
+#define TEST_LEARNER_QUEUE_CAPACITY  16
+// trace decay of QLearners ( both one-step and with eligibility trace )
+#define TEST_LAMBDA                  0.8f
+
+// seed of random states ( same states for each run )
+#define TEST_VALUES_SEED             222
+// seconds after which a test that hangs is stopped ( alarm )
+#define TEST_TIMEOUT                 120
+
+
+using namespace controller;
+using namespace controller_storage;
+
+
+/* makes a transition whose values are found from its number */
+static void make_transition(const size_t number, Q_transition & transition)
+{
+    memset(&transition, 0, sizeof(transition));
+    transition.state_key = (Q_state_key) number;
+    transition.action_index = (Q_action_index) (number % Q_ACTION_SPACE_SIZE);
+    transition.reward = (float) (number % 1000);
+    transition.next_state_key = (Q_state_key) (number * 3);
+    transition.next_action_index = (Q_action_index) ((number + 1) % Q_ACTION_SPACE_SIZE);
+}
+
+
+/* returns non-zero if the transition is the one with given number */
+static int is_transition(const size_t number, const Q_transition & transition)
+{
+    Q_transition expected_transition;
+    make_transition(number, expected_transition);
+
+    return memcmp(&transition, &expected_transition, sizeof(transition)) == 0;
+}
+
+
+/* checks capacity, full and empty queue and order of transitions in one thread */
+static void check_queue()
+{
+    const size_t capacities[][2] = { {0, 1}, {1, 1}, {5, 8}, {8, 8}, {1000, 1024} };
+    for(size_t i = 0; i < sizeof(capacities) / sizeof(capacities[0]); i++)
+    {
+        Q_transition_queue queue(capacities[i][0]);
+        CHECK(queue.get_capacity() == capacities[i][1]);
+    }
+
+    Q_transition_queue queue(TEST_QUEUE_CAPACITY);
+    Q_transition transition;
+    CHECK(queue.get_depth() == 0);
+    CHECK(queue.try_pop(transition) == 0);
+
+    // indices go around the ring buffer many times
+    size_t pushed = 0;
+    size_t popped = 0;
+    for(int round = 0; round < 1000; round++)
+    {
+        const size_t pushes = rand() % (TEST_QUEUE_CAPACITY + 1);
+        for(size_t i = 0; i < pushes; i++)
+        {
+            make_transition(pushed, transition);
+            if(queue.try_push(transition))
+            {
+                pushed++;
+            }
+            else
+            {
+                // only a full queue refuses a transition
+                CHECK(queue.get_depth() == TEST_QUEUE_CAPACITY);
+            }
+        }
+        CHECK(queue.get_depth() == pushed - popped);
+
+        const size_t pops = rand() % (TEST_QUEUE_CAPACITY + 1);
+        for(size_t i = 0; i < pops; i++)
+        {
+            if(queue.try_pop(transition))
+            {
+                CHECK(is_transition(popped, transition));
+                popped++;
+            }
+            else
+            {
+                CHECK(queue.get_depth() == 0);
+            }
+        }
+        CHECK(queue.get_depth() == pushed - popped);
+    }
+
+    // a full queue takes nothing more, and gives all of its transitions in order
+    while(queue.try_pop(transition))
+    {
+        CHECK(is_transition(popped, transition));
+        popped++;
+    }
+    for(size_t i = 0; i < TEST_QUEUE_CAPACITY; i++)
+    {
+        make_transition(pushed++, transition);
+        CHECK(queue.try_push(transition) == 1);
+    }
+    CHECK(queue.get_depth() == TEST_QUEUE_CAPACITY);
+    CHECK(queue.try_push(transition) == 0);
+    for(size_t i = 0; i < TEST_QUEUE_CAPACITY; i++)
+    {
+        CHECK(queue.try_pop(transition) == 1);
+        CHECK(is_transition(popped++, transition));
+    }
+    CHECK(queue.try_pop(transition) == 0);
+    CHECK(pushed == popped);
+}
+
+
+/* thread function that puts numbered transitions in a queue ( Q_transition_queue * ) */
+static void * run_producer(void * t_queue)
+{
+    Q_transition_queue & queue = *((Q_transition_queue *) t_queue);
+
+    Q_transition transition;
+    for(size_t number = 0; number < TEST_TRANSITIONS; number++)
+    {
+        make_transition(number, transition);
+        while(!queue.try_push(transition))
+        {
+            // consumer is behind ( it may need this cpu )
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+
+/* checks that transitions put by another thread are taken out whole and in order */
+static void check_queue_threads()
+{
+    Q_transition_queue queue(TEST_QUEUE_CAPACITY);
+
+    pthread_t producer;
+    if(!CHECK(pthread_create(&producer, NULL, run_producer, &queue) == 0))
+    {
+        return;
+    }
+
+    size_t wrong_transitions = 0;
+    size_t number = 0;
+    Q_transition transition;
+    while(number < TEST_TRANSITIONS)
+    {
+        if(queue.try_pop(transition))
+        {
+            wrong_transitions += !is_transition(number, transition);
+            number++;
+        }
+        else
+        {
+            sched_yield();
+        }
+    }
+    pthread_join(producer, NULL);
+
+    CHECK(wrong_transitions == 0);
+    CHECK(queue.get_depth() == 0);
+    CHECK(queue.try_pop(transition) == 0);
+}
+
+
+/* makes random steps of a race ( few states, so pairs are visited again ) */
+static void make_steps(std::vector<Q_state> & states, std::vector<Q_action> & actions,
+        std::vector<float> & rewards)
+{
+    states.resize(TEST_STEPS);
+    actions.resize(TEST_STEPS);
+    rewards.resize(TEST_STEPS);
+    for(int i = 0; i < TEST_STEPS; i++)
+    {
+        states[i].speed_x = rand() % 10;
+        states[i].speed_y = ((rand() % 3) - 1) / 10.0f;
+        states[i].right_side_distance = rand() % 4;
+        states[i].left_side_distance = rand() % 4;
+        states[i].path = ((rand() % 5) - 2) * 10.0f;
+        states[i].next_path = ((rand() % 5) - 2) * 10.0f;
+        actions[i].accel = values_0_to_1_in_9_steps[rand() % TOTAL_NUM_ACTIONS];
+        rewards[i] = get_random_Q_value();
+    }
+}
+
+
+/* learns the steps with or without a learner thread and returns the records learnt */
+static void learn_steps(const std::vector<Q_state> & states,
+        const std::vector<Q_action> & actions, const std::vector<float> & rewards,
+        const float lambda, const int use_learner_thread,
+        std::vector<Q_file_record> & records, Q_queue_stats & stats)
+{
+    Q_maps_storage Q_maps_storage;
+    QLearner q_learner(Q_maps_storage);
+    q_learner.set_lambda(lambda);
+    memset(&stats, 0, sizeof(stats));
+
+    if(use_learner_thread)
+    {
+        // learner thread sleeps before it is given a transition, and is stopped
+        // and started again with nothing to do
+        q_learner.start_learner_thread(TEST_LEARNER_QUEUE_CAPACITY);
+        usleep(1000);
+        q_learner.stop_learner_thread();
+        q_learner.stop_learner_thread();
+        q_learner.start_learner_thread(TEST_LEARNER_QUEUE_CAPACITY);
+    }
+
+    for(int i = 0; i < TEST_STEPS; i++)
+    {
+        q_learner.set_state_action_and_reward(states[i], actions[i], rewards[i]);
+
+        // learner thread empties the queue and sleeps until next transition
+        if(use_learner_thread && i % TEST_PAUSE_STEPS == 0)
+        {
+            usleep(1000);
+        }
+    }
+
+    if(use_learner_thread)
+    {
+        q_learner.get_queue_stats(stats);
+        q_learner.stop_learner_thread();
+    }
+
+    Q_maps_storage._Q_maps->get_all_records(records);
+}
+
+
+/* checks that Q values updated by a learner thread are same as those updated while driving */
+static void check_learner_thread()
+{
+    std::vector<Q_state> states;
+    std::vector<Q_action> actions;
+    std::vector<float> rewards;
+    make_steps(states, actions, rewards);
+
+    const float lambdas[] = { 0.0f, TEST_LAMBDA };
+    for(size_t i = 0; i < sizeof(lambdas) / sizeof(lambdas[0]); i++)
+    {
+        std::vector<Q_file_record> driving_records;
+        std::vector<Q_file_record> learner_records;
+        Q_queue_stats driving_stats;
+        Q_queue_stats learner_stats;
+        learn_steps(states, actions, rewards, lambdas[i], 0, driving_records, driving_stats);
+        learn_steps(states, actions, rewards, lambdas[i], 1, learner_records, learner_stats);
+
+        CHECK(!driving_records.empty());
+        CHECK(are_records_equal(learner_records, driving_records));
+        CHECK(learner_stats.transitions == TEST_STEPS);
+        CHECK(learner_stats.max_depth <= TEST_LEARNER_QUEUE_CAPACITY);
+    }
+}
+
+
+int main()
+{
+    // a lost wake up of the learner thread would hang the test
+    alarm(TEST_TIMEOUT);
+
+    srand(TEST_VALUES_SEED);
+    check_queue();
+    check_queue_threads();
+    check_learner_thread();
+
+    return finish_checks("test_Q_transition_queue");
+}
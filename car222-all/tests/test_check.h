@@ -0,0 +1,75 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * test_check.h
+ *
+ * Checks of the tests of car222. Each test is a program that runs its checks,
+ * prints the ones that failed and exits with 1 if any of them failed
+ * ( see "finish_checks" ).
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  TEST_CHECK_H_
+#define  TEST_CHECK_H_
+
+
+#include <stdio.h>
+
+
+// checks a condition and prints it with its place if it is false
+#define CHECK(condition)    check_condition((condition) ? 1 : 0, #condition, __FILE__, __LINE__)
+
+
+// number of checks done and of checks that failed
+static long long int checks_done = 0;
+static long long int checks_failed = 0;
+
+
+/* counts a check and prints it if it failed ( only first failures are printed ) */
+static inline int check_condition(const int passed, const char * condition,
+        const char * file, const int line)
+{
+    checks_done++;
+    if(!passed)
+    {
+        if(checks_failed < 20)
+        {
+            printf("%s:%d: check failed - %s\n", file, line, condition);
+        }
+        checks_failed++;
+    }
+
+    return passed;
+}
+
+
+/* prints result of the checks of a test and returns exit status of the test */
+static inline int finish_checks(const char * test_name)
+{
+    printf("%s - %lld checks, %lld failed\n", test_name, checks_done, checks_failed);
+
+    return (checks_failed == 0) ? 0 : 1;
+}
+
+
+#endif      /* ifndef TEST_CHECK_H_ */
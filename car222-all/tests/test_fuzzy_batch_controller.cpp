@@ -0,0 +1,154 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * test_fuzzy_batch_controller.cpp
+ *
+ * Checks that each lane of FuzzyBatchController gives same outputs as a
+ * FuzzyController of its own ( exact centroid, so it is built with
+ * USE_EXACT_CENTROID=1 ) for the same inputs in the same order, also after
+ * a lane is started again. Floats may differ by rounding, gears are same.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "fuzzy_controller.h"
+#include "fuzzy_batch_controller.h"
+#include "test_check.h"
+#include "test_fuzzy_inputs.h"
+
+
+#if !USE_EXACT_CENTROID
+#error "batch controller is checked against FuzzyController with exact centroid ( USE_EXACT_CENTROID=1 )"
+#endif
+
+
+// lanes ( not a multiple of FUZZY_BATCH_LANES, so last lanes are padded ) and steps
+#define TEST_LANES                   13
+#define TEST_STEPS                   20000
+// steps after which a lane is started again
+#define TEST_RESET_STEPS             3000
+
+// largest difference of float outputs ( rounding )
+#define TEST_MAX_VALUE_DIFFERENCE    1e-5f
+
+// seed of random inputs ( same inputs for each run )
+#define TEST_INPUTS_SEED             222
+
+
+/* returns non-zero if float outputs differ by more than rounding ( NaN is only same as NaN ) */
+static int is_different(const float value, const float other)
+{
+    if(isnan(value) || isnan(other))
+    {
+        return isnan(value) != isnan(other);
+    }
+
+    return !(fabsf(value - other) <= TEST_MAX_VALUE_DIFFERENCE);
+}
+
+
+int main()
+{
+    srand(TEST_INPUTS_SEED);
+
+    // a trajectory for each lane
+    std::vector<controller::fuzzy_inputs> lane_inputs[TEST_LANES];
+    for(int lane = 0; lane < TEST_LANES; lane++)
+    {
+        get_trajectory_fuzzy_inputs(TEST_STEPS, lane_inputs[lane]);
+    }
+
+    // controllers of lanes print their status, which is not needed for each lane
+    std::ostringstream controller_messages;
+    std::streambuf * cout_buffer = std::cout.rdbuf(controller_messages.rdbuf());
+    controller::FuzzyController * lane_controllers[TEST_LANES];
+    for(int lane = 0; lane < TEST_LANES; lane++)
+    {
+        lane_controllers[lane] = new controller::FuzzyController();
+    }
+
+    controller::FuzzyBatchController batch_controller(TEST_LANES);
+    CHECK(batch_controller.get_lane_count() == TEST_LANES);
+
+    std::vector<float> speed(TEST_LANES), acceleration(TEST_LANES), path(TEST_LANES),
+        next_path(TEST_LANES), stability(TEST_LANES);
+    const controller::fuzzy_input_batch inputs = {speed.data(), acceleration.data(),
+        path.data(), next_path.data(), stability.data()};
+    std::vector<float> steer(TEST_LANES), accel(TEST_LANES), brake(TEST_LANES);
+    std::vector<int> gear(TEST_LANES);
+    const controller::fuzzy_output_batch outputs = {steer.data(), accel.data(),
+        gear.data(), brake.data()};
+
+    long long int differs[controller_fuzzy::OUTPUT_COUNT] = {};
+    for(int step = 0; step < TEST_STEPS; step++)
+    {
+        // a lane starts again as a new controller
+        if(step > 0 && step % TEST_RESET_STEPS == 0)
+        {
+            const int lane = (step / TEST_RESET_STEPS) % TEST_LANES;
+            batch_controller.reset_lane(lane);
+            delete lane_controllers[lane];
+            lane_controllers[lane] = new controller::FuzzyController();
+        }
+
+        for(int lane = 0; lane < TEST_LANES; lane++)
+        {
+            speed[lane] = lane_inputs[lane][step].speed;
+            acceleration[lane] = lane_inputs[lane][step].acceleration;
+            path[lane] = lane_inputs[lane][step].path;
+            next_path[lane] = lane_inputs[lane][step].next_path;
+            stability[lane] = lane_inputs[lane][step].stability;
+        }
+        batch_controller.get_outputs(inputs, outputs);
+
+        for(int lane = 0; lane < TEST_LANES; lane++)
+        {
+            const controller::fuzzy_outputs lane_outputs =
+                lane_controllers[lane]->get_output(&lane_inputs[lane][step]);
+
+            differs[controller_fuzzy::STEER_OUTPUT] += is_different(steer[lane], lane_outputs.steer);
+            differs[controller_fuzzy::ACCEL_OUTPUT] += is_different(accel[lane], lane_outputs.accel);
+            differs[controller_fuzzy::GEAR_OUTPUT] += (gear[lane] != lane_outputs.gear);
+            differs[controller_fuzzy::BRAKE_OUTPUT] += is_different(brake[lane], lane_outputs.brake);
+        }
+    }
+    std::cout.rdbuf(cout_buffer);
+
+    for(int lane = 0; lane < TEST_LANES; lane++)
+    {
+        delete lane_controllers[lane];
+    }
+
+    CHECK(differs[controller_fuzzy::STEER_OUTPUT] == 0);
+    CHECK(differs[controller_fuzzy::ACCEL_OUTPUT] == 0);
+    CHECK(differs[controller_fuzzy::GEAR_OUTPUT] == 0);
+    CHECK(differs[controller_fuzzy::BRAKE_OUTPUT] == 0);
+
+    return finish_checks("test_fuzzy_batch_controller");
+}
@@ -0,0 +1,265 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * test_fuzzy_engine.cpp
+ *
+ * Checks the fuzzy engine and the fuzzy controller without fuzzylite -
+ *
+ *  1. outputs of rule blocks that run ( output mask ) are same as outputs of
+ *     the engine with all rule blocks, and the controller gives same steer,
+ *     gear and brake when it only runs their rule blocks ( as car222 does )
+ *  2. terms of a fuzzy parameter set made from the compiled terms give same
+ *     outputs as the compiled terms, also through a parameter file
+ *  3. exact centroid is close to a centroid of many samples
+ *
+ * Outputs of the engine are compared with fuzzylite in test_fuzzy_fuzzylite.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <vector>
+
+#include "fuzzy_controller.h"
+#include "fuzzy_parameters.h"
+#include "test_check.h"
+#include "test_fuzzy_inputs.h"
+
+
+// random inputs and steps of a trajectory given to the engines
+#define TEST_RANDOM_INPUTS           20000
+#define TEST_TRAJECTORY_STEPS        50000
+// inputs for centroid of many samples ( which is slow )
+#define TEST_CENTROID_INPUTS         300
+
+// samples of reference centroid and largest difference of exact centroid from it
+#define TEST_CENTROID_RESOLUTION     100000
+#define TEST_MAX_CENTROID_ERROR      1e-4
+
+// seed of random inputs ( same inputs for each run )
+#define TEST_INPUTS_SEED             222
+// version of the parameter set made from compiled terms
+#define TEST_PARAMETERS_VERSION      "test-1.0.0"
+// template of parameter files made by the test
+#define TEST_PARAMETERS_FILE_TEMPLATE    "/tmp/car222_test_XXXXXX"
+
+
+using controller_fuzzy::scalar;
+using controller_fuzzy::output_state;
+using controller_fuzzy::INPUT_COUNT;
+using controller_fuzzy::OUTPUT_COUNT;
+
+// rules of v1.0.0 with terms of the parameter set in use
+typedef controller_fuzzy::fuzzy_rules<controller_fuzzy::centroid<100>,
+        controller_fuzzy::parameter_terms>::rule_base parameter_rule_base;
+
+// rules with a centroid of many samples ( reference of exact centroid )
+typedef controller_fuzzy::fuzzy_rules<controller_fuzzy::centroid<TEST_CENTROID_RESOLUTION> >
+    ::rule_base reference_rule_base;
+
+
+/* checks that outputs of the mask are same as outputs of all rule blocks ( others are kept ) */
+static void check_output_masks(const std::vector<controller::fuzzy_inputs> & inputs)
+{
+    for(int output_mask = 1; output_mask <= FUZZY_ALL_OUTPUTS; output_mask++)
+    {
+        output_state all_states[OUTPUT_COUNT];
+        output_state mask_states[OUTPUT_COUNT];
+        reset_output_states(all_states);
+        reset_output_states(mask_states);
+
+        long long int different_states = 0;
+        for(size_t i = 0; i < inputs.size(); i++)
+        {
+            scalar engine_inputs[INPUT_COUNT];
+            get_engine_inputs(inputs[i], engine_inputs);
+
+            output_state previous_mask_states[OUTPUT_COUNT];
+            memcpy(previous_mask_states, mask_states, sizeof(mask_states));
+
+            controller_fuzzy::sampled_rule_base::process(engine_inputs, all_states);
+            controller_fuzzy::sampled_rule_base::process(engine_inputs, mask_states, output_mask);
+
+            for(int output = 0; output < OUTPUT_COUNT; output++)
+            {
+                different_states += (output_mask & (1 << output))
+                    ? !are_states_same(mask_states[output], all_states[output])
+                    : !are_states_same(mask_states[output], previous_mask_states[output]);
+            }
+        }
+        CHECK(different_states == 0);
+    }
+
+    // car222 doesn't use fuzzy accel
+    const int output_mask = FUZZY_OUTPUT_STEER | FUZZY_OUTPUT_GEAR | FUZZY_OUTPUT_BRAKE;
+    controller::FuzzyController all_controller;
+    controller::FuzzyController mask_controller;
+    long long int different_outputs = 0;
+    for(size_t i = 0; i < inputs.size(); i++)
+    {
+        const controller::fuzzy_outputs all_outputs = all_controller.get_output(&inputs[i]);
+        const controller::fuzzy_outputs mask_outputs =
+            mask_controller.get_output(&inputs[i], output_mask);
+
+        different_outputs += !are_values_same(all_outputs.steer, mask_outputs.steer)
+            || all_outputs.gear != mask_outputs.gear
+            || !are_values_same(all_outputs.brake, mask_outputs.brake);
+    }
+    CHECK(different_outputs == 0);
+}
+
+
+/* checks that terms of parameters made from compiled terms give same outputs as compiled terms */
+static void check_parameter_terms(const std::vector<controller::fuzzy_inputs> & inputs)
+{
+    controller_fuzzy::fuzzy_parameters parameters;
+    CHECK(controller_fuzzy::get_compiled_parameters(TEST_PARAMETERS_VERSION, parameters) == 0);
+    CHECK(strcmp(parameters.version, TEST_PARAMETERS_VERSION) == 0);
+    for(int i = 0; i < controller_fuzzy::TERM_COUNT; i++)
+    {
+        CHECK(controller_fuzzy::is_valid_term(parameters.terms[i]));
+    }
+    controller_fuzzy::use_parameters(parameters);
+
+    output_state compiled_states[OUTPUT_COUNT];
+    output_state parameter_states[OUTPUT_COUNT];
+    reset_output_states(compiled_states);
+    reset_output_states(parameter_states);
+    long long int different_states = 0;
+    for(size_t i = 0; i < inputs.size(); i++)
+    {
+        scalar engine_inputs[INPUT_COUNT];
+        get_engine_inputs(inputs[i], engine_inputs);
+        controller_fuzzy::sampled_rule_base::process(engine_inputs, compiled_states);
+        parameter_rule_base::process(engine_inputs, parameter_states);
+
+        for(int output = 0; output < OUTPUT_COUNT; output++)
+        {
+            different_states += !are_states_same(parameter_states[output], compiled_states[output]);
+        }
+    }
+    CHECK(different_states == 0);
+
+    // a parameter file is read with same terms
+    char file_name[] = TEST_PARAMETERS_FILE_TEMPLATE;
+    const int file_descriptor = mkstemp(file_name);
+    if(!CHECK(file_descriptor >= 0))
+    {
+        return;
+    }
+    close(file_descriptor);
+    controller_fuzzy::fuzzy_parameters read_parameters;
+    CHECK(controller_fuzzy::write_parameters(file_name, parameters) == 0);
+    CHECK(controller_fuzzy::read_parameters(file_name, read_parameters) == 0);
+    CHECK(strcmp(read_parameters.version, TEST_PARAMETERS_VERSION) == 0);
+    CHECK(memcmp(read_parameters.terms, parameters.terms, sizeof(parameters.terms)) == 0);
+
+    // and a controller using the file has its version and same outputs
+    controller::FuzzyController compiled_controller;
+    controller::FuzzyController parameter_controller;
+    CHECK(parameter_controller.use_parameters(file_name) == 0);
+    CHECK(strcmp(parameter_controller.get_version(), TEST_PARAMETERS_VERSION) == 0);
+    CHECK(strcmp(compiled_controller.get_version(), FUZZY_CONTROLLER_VERSION) == 0);
+    long long int different_outputs = 0;
+    for(size_t i = 0; i < inputs.size(); i++)
+    {
+        const controller::fuzzy_outputs compiled_outputs = compiled_controller.get_output(&inputs[i]);
+        const controller::fuzzy_outputs parameter_outputs =
+            parameter_controller.get_output(&inputs[i]);
+
+        different_outputs += memcmp(&compiled_outputs, &parameter_outputs,
+                sizeof(compiled_outputs)) != 0;
+    }
+    CHECK(different_outputs == 0);
+
+    // a file that is not there is not used
+    unlink(file_name);
+    controller::FuzzyController missing_file_controller;
+    CHECK(missing_file_controller.use_parameters(file_name) == -1);
+    CHECK(strcmp(missing_file_controller.get_version(), FUZZY_CONTROLLER_VERSION) == 0);
+}
+
+
+/* checks exact centroid against a centroid of many samples */
+static void check_exact_centroid(const std::vector<controller::fuzzy_inputs> & inputs)
+{
+    long long int large_errors = 0;
+    long long int different_empty_states = 0;
+    double max_error = 0;
+    for(size_t i = 0; i < inputs.size() && i < TEST_CENTROID_INPUTS; i++)
+    {
+        // each input without previous values ( an empty output keeps no value )
+        output_state exact_states[OUTPUT_COUNT];
+        output_state reference_states[OUTPUT_COUNT];
+        reset_output_states(exact_states);
+        reset_output_states(reference_states);
+
+        scalar engine_inputs[INPUT_COUNT];
+        get_engine_inputs(inputs[i], engine_inputs);
+        controller_fuzzy::exact_rule_base::process(engine_inputs, exact_states);
+        reference_rule_base::process(engine_inputs, reference_states);
+
+        for(int output = 0; output < OUTPUT_COUNT; output++)
+        {
+            different_empty_states +=
+                (exact_states[output].is_empty != 0) != (reference_states[output].is_empty != 0);
+            if(isnan(exact_states[output].value) || isnan(reference_states[output].value))
+            {
+                different_empty_states +=
+                    isnan(exact_states[output].value) != isnan(reference_states[output].value);
+                continue;
+            }
+
+            const double error = fabs(exact_states[output].value - reference_states[output].value);
+            max_error = (error > max_error) ? error : max_error;
+            large_errors += !(error <= TEST_MAX_CENTROID_ERROR);
+        }
+    }
+    CHECK(different_empty_states == 0);
+    if(!CHECK(large_errors == 0))
+    {
+        printf("exact centroid differs from centroid of %d samples by %g\n",
+                TEST_CENTROID_RESOLUTION, max_error);
+    }
+}
+
+
+int main()
+{
+    srand(TEST_INPUTS_SEED);
+    std::vector<controller::fuzzy_inputs> random_inputs;
+    std::vector<controller::fuzzy_inputs> trajectory_inputs;
+    get_random_fuzzy_inputs(TEST_RANDOM_INPUTS, random_inputs);
+    get_trajectory_fuzzy_inputs(TEST_TRAJECTORY_STEPS, trajectory_inputs);
+
+    check_output_masks(random_inputs);
+    check_output_masks(trajectory_inputs);
+    check_parameter_terms(random_inputs);
+    check_parameter_terms(trajectory_inputs);
+    check_exact_centroid(random_inputs);
+
+    return finish_checks("test_fuzzy_engine");
+}
@@ -0,0 +1,147 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * test_fuzzy_fuzzylite.cpp
+ *
+ * Checks that outputs of the fuzzy engine of v1.0.0 ( sampled_rule_base,
+ * Centroid of 100 samples ) are identical to outputs of fuzzylite engine of
+ * fuzzy controller v1.0.0 ( fuzzylite_reference.h ), bit for bit, along with
+ * empty state of each output. Inputs are a grid of path and speed ( inputs
+ * used by rules ), random inputs and a trajectory, processed one after the
+ * other by both engines, so previous values of outputs are compared as well.
+ *
+ * It needs fuzzylite ( FUZZYLITE_HOME ), so it is only built when it is set.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "fuzzy_controller.h"
+#include "fuzzylite_reference.h"
+#include "test_check.h"
+#include "test_fuzzy_inputs.h"
+
+
+// points of grid of path and speed, random inputs and steps of a trajectory
+#define TEST_PATH_POINTS             201
+#define TEST_SPEED_POINTS            251
+#define TEST_RANDOM_INPUTS           50000
+#define TEST_TRAJECTORY_STEPS        100000
+
+// seed of random inputs ( same inputs for each run )
+#define TEST_INPUTS_SEED             222
+
+
+using controller_fuzzy::scalar;
+using controller_fuzzy::OUTPUT_COUNT;
+
+
+/* returns inputs on a grid of path and speed ( other inputs are random ) */
+static void get_grid_inputs(std::vector<controller::fuzzy_inputs> & inputs)
+{
+    get_random_fuzzy_inputs(TEST_PATH_POINTS * TEST_SPEED_POINTS, inputs);
+    for(int i = 0; i < TEST_PATH_POINTS; i++)
+    {
+        for(int j = 0; j < TEST_SPEED_POINTS; j++)
+        {
+            controller::fuzzy_inputs & grid_inputs = inputs[i * TEST_SPEED_POINTS + j];
+            grid_inputs.path = -TEST_MAX_ABS_PATH + 2 * TEST_MAX_ABS_PATH * i / (TEST_PATH_POINTS - 1);
+            grid_inputs.speed = TEST_MIN_SPEED
+                + (TEST_MAX_SPEED - TEST_MIN_SPEED) * j / (TEST_SPEED_POINTS - 1);
+        }
+    }
+}
+
+
+/**
+ * processes the inputs with both engines ( each engine keeps its outputs from
+ * one input to the next ) and checks that their outputs are identical
+ **/
+static void check_outputs(const char * inputs_name,
+        const std::vector<controller::fuzzy_inputs> & inputs,
+        controller_fuzzy::output_state states[OUTPUT_COUNT],
+        controller::FuzzyliteReference & reference)
+{
+    long long int different_values[OUTPUT_COUNT] = {};
+    long long int different_empty_states[OUTPUT_COUNT] = {};
+    for(size_t i = 0; i < inputs.size(); i++)
+    {
+        scalar engine_inputs[controller_fuzzy::INPUT_COUNT];
+        get_engine_inputs(inputs[i], engine_inputs);
+        controller_fuzzy::sampled_rule_base::process(engine_inputs, states);
+
+        scalar reference_values[OUTPUT_COUNT];
+        int reference_is_empty[OUTPUT_COUNT];
+        reference.get_values(&inputs[i], reference_values, reference_is_empty);
+
+        for(int output = 0; output < OUTPUT_COUNT; output++)
+        {
+            different_values[output] += !are_values_same(states[output].value,
+                    reference_values[output]);
+            different_empty_states[output] +=
+                (states[output].is_empty != 0) != (reference_is_empty[output] != 0);
+        }
+    }
+
+    for(int output = 0; output < OUTPUT_COUNT; output++)
+    {
+        if(!CHECK(different_values[output] == 0) || !CHECK(different_empty_states[output] == 0))
+        {
+            printf("%s inputs - output %d has %lld different values and %lld different"
+                    " empty states\n", inputs_name, output, different_values[output],
+                    different_empty_states[output]);
+        }
+    }
+}
+
+
+int main()
+{
+    controller::FuzzyliteReference reference;
+    std::string message;
+    if(!CHECK(reference.is_ready(&message)))
+    {
+        printf("fuzzylite engine is not ready : %s\n", message.c_str());
+        return finish_checks("test_fuzzy_fuzzylite");
+    }
+
+    srand(TEST_INPUTS_SEED);
+    std::vector<controller::fuzzy_inputs> grid_inputs;
+    std::vector<controller::fuzzy_inputs> random_inputs;
+    std::vector<controller::fuzzy_inputs> trajectory_inputs;
+    get_grid_inputs(grid_inputs);
+    get_random_fuzzy_inputs(TEST_RANDOM_INPUTS, random_inputs);
+    get_trajectory_fuzzy_inputs(TEST_TRAJECTORY_STEPS, trajectory_inputs);
+
+    // both engines start without previous values and keep them through all inputs
+    controller_fuzzy::output_state states[OUTPUT_COUNT];
+    reset_output_states(states);
+    check_outputs("grid", grid_inputs, states, reference);
+    check_outputs("random", random_inputs, states, reference);
+    check_outputs("trajectory", trajectory_inputs, states, reference);
+
+    return finish_checks("test_fuzzy_fuzzylite");
+}
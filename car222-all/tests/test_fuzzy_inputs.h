@@ -0,0 +1,158 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * test_fuzzy_inputs.h
+ *
+ * Helpers of tests of the fuzzy controller - random inputs, inputs of a car
+ * that weaves across its path as in a race, and comparison of outputs.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  TEST_FUZZY_INPUTS_H_
+#define  TEST_FUZZY_INPUTS_H_
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+#include "fuzzy_controller.h"
+
+
+// ranges of inputs ( a little beyond the values a race gives )
+#define TEST_MAX_ABS_PATH            1.0f
+#define TEST_MIN_SPEED               -5.0f
+#define TEST_MAX_SPEED               120.0f
+#define TEST_MIN_ACCELERATION        -5.0f
+#define TEST_MAX_ACCELERATION        30.0f
+
+// time between steps of a trajectory ( seconds, robot step of TORCS )
+#define TEST_TRAJECTORY_STEP         0.02f
+
+
+/* returns a random value from "minimum" to "maximum" */
+static inline float get_random_value(const float minimum, const float maximum)
+{
+    return minimum + (maximum - minimum) * ((float) rand() / RAND_MAX);
+}
+
+
+/* returns random inputs */
+static inline void get_random_fuzzy_inputs(const int count,
+        std::vector<controller::fuzzy_inputs> & inputs)
+{
+    inputs.resize(count);
+    for(size_t i = 0; i < inputs.size(); i++)
+    {
+        inputs[i].speed = get_random_value(TEST_MIN_SPEED, TEST_MAX_SPEED);
+        inputs[i].acceleration = get_random_value(TEST_MIN_ACCELERATION, TEST_MAX_ACCELERATION);
+        inputs[i].path = get_random_value(-TEST_MAX_ABS_PATH, TEST_MAX_ABS_PATH);
+        inputs[i].next_path = get_random_value(-TEST_MAX_ABS_PATH, TEST_MAX_ABS_PATH);
+        inputs[i].stability = get_random_value(0, 1);
+    }
+}
+
+
+/**
+ * returns inputs of a car that speeds up and slows down while it weaves
+ * across its path ( path and speed change a little at each step, so gear
+ * hysteresis and previous values of outputs are used )
+ **/
+static inline void get_trajectory_fuzzy_inputs(const int count,
+        std::vector<controller::fuzzy_inputs> & inputs)
+{
+    inputs.resize(count);
+
+    float speed = 0;
+    float path = 0;
+    float path_rate = 0;
+    float acceleration = 0;
+    for(size_t i = 0; i < inputs.size(); i++)
+    {
+        // acceleration drifts, and car slows down at top speed
+        acceleration += get_random_value(-1, 1);
+        acceleration = std::max(-10.0f, std::min(10.0f, acceleration));
+        if(speed > TEST_MAX_SPEED * 0.9f)
+        {
+            acceleration = -fabsf(acceleration);
+        }
+        speed = std::max(TEST_MIN_SPEED, speed + acceleration * TEST_TRAJECTORY_STEP);
+
+        // path drifts back to the middle ( and sometimes far to a side )
+        path_rate += get_random_value(-0.05f, 0.05f) - 0.01f * path;
+        path_rate = std::max(-0.5f, std::min(0.5f, path_rate));
+        path = std::max(-TEST_MAX_ABS_PATH,
+                std::min(TEST_MAX_ABS_PATH, path + path_rate * TEST_TRAJECTORY_STEP));
+
+        inputs[i].speed = speed;
+        inputs[i].acceleration = acceleration;
+        inputs[i].path = path;
+        inputs[i].next_path = path + path_rate;
+        inputs[i].stability = fabsf(path_rate);
+    }
+}
+
+
+/* copies inputs of the controller to inputs of the engine ( in order of input_index ) */
+static inline void get_engine_inputs(const controller::fuzzy_inputs & inputs,
+        controller_fuzzy::scalar engine_inputs[controller_fuzzy::INPUT_COUNT])
+{
+    engine_inputs[controller_fuzzy::SPEED_INPUT] = inputs.speed;
+    engine_inputs[controller_fuzzy::ACCELERATION_INPUT] = inputs.acceleration;
+    engine_inputs[controller_fuzzy::PATH_INPUT] = inputs.path;
+    engine_inputs[controller_fuzzy::NEXT_PATH_INPUT] = inputs.next_path;
+    engine_inputs[controller_fuzzy::STABILITY_INPUT] = inputs.stability;
+}
+
+
+/* resets states of all outputs of the engine ( no values yet ) */
+static inline void reset_output_states(
+        controller_fuzzy::output_state states[controller_fuzzy::OUTPUT_COUNT])
+{
+    for(int i = 0; i < controller_fuzzy::OUTPUT_COUNT; i++)
+    {
+        controller_fuzzy::reset_output_state(states[i]);
+    }
+}
+
+
+/* returns non-zero if both values have same bits ( NaN is same as NaN ) */
+static inline int are_values_same(const double value, const double other)
+{
+    return (isnan(value) && isnan(other)) || memcmp(&value, &other, sizeof(value)) == 0;
+}
+
+
+/* returns non-zero if both states of an output have same values and empty state */
+static inline int are_states_same(const controller_fuzzy::output_state & state,
+        const controller_fuzzy::output_state & other)
+{
+    return are_values_same(state.value, other.value)
+        && are_values_same(state.previous_value, other.previous_value)
+        && (state.is_empty != 0) == (other.is_empty != 0);
+}
+
+
+#endif      /* ifndef TEST_FUZZY_INPUTS_H_ */
@@ -0,0 +1,122 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * car222_Q_convert.cpp
+ *
+ * Converts a Q value file ( text or binary ) to text or binary format.
+ * "quantized" writes a binary file with Q values quantized to 16 bits
+ * ( Q_VALUES_INT16 ).
+ *
+ *  usage : car222_Q_convert <text|binary|quantized> <input file> <output file>
+ *              [<QLearner id> <reward id> <fuzzy controller version>]
+ *
+ * Ids are written to the header of a binary output file. They are the values
+ * of Q_LEARNER_ID, RACE_REWARD_ID and FUZZY_CONTROLLER_VERSION that were used
+ * for learning the Q values.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+
+#include "car222_Q_maps.h"
+
+
+static void print_usage(const char * program_name)
+{
+    printf("usage : %s <text|binary|quantized> <input file> <output file>"
+            " [<QLearner id> <reward id> <fuzzy controller version>]\n", program_name);
+}
+
+
+/* returns seconds elapsed since given time */
+static double get_elapsed_seconds(const struct timespec & start_time)
+{
+    struct timespec end_time;
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+
+    return (end_time.tv_sec - start_time.tv_sec)
+        + (end_time.tv_nsec - start_time.tv_nsec) / 1e9;
+}
+
+
+int main(int argc, char * argv[])
+{
+    if((argc != 4 && argc != 7) || (strcmp(argv[1], "text") != 0 &&
+                strcmp(argv[1], "binary") != 0 && strcmp(argv[1], "quantized") != 0))
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const int to_quantized = (strcmp(argv[1], "quantized") == 0);
+    const int to_binary = (strcmp(argv[1], "binary") == 0) || to_quantized;
+    const std::string input_file_name = argv[2];
+    const std::string output_file_name = argv[3];
+
+    controller_storage::Q_maps_storage storage;
+    if(argc == 7)
+    {
+        storage._Q_maps->set_version_ids(argv[4], argv[5], argv[6]);
+    }
+    storage._Q_maps->set_binary_value_encoding(
+            to_quantized ? Q_VALUES_INT16 : Q_VALUES_FLOAT32);
+
+    // load input file ( its type is detected from its content )
+    struct timespec start_time;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+    const long long int training_counter =
+        storage._Q_maps->load_maps_from_file(input_file_name);
+    if(storage._Q_maps->m_Q_value_file_name != input_file_name)
+    {
+        printf("couldn't load Q value file \"%s\"\n", input_file_name.c_str());
+        return 1;
+    }
+
+    printf("loaded in %.3f seconds\n", get_elapsed_seconds(start_time));
+
+    // write output file
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+    const int write_value = to_binary
+        ? storage._Q_maps->write_maps_to_binary_file(output_file_name, training_counter)
+        : storage._Q_maps->write_maps_to_file(output_file_name, training_counter);
+    if(write_value != 0)
+    {
+        printf("couldn't write Q value file \"%s\"\n", output_file_name.c_str());
+        return 1;
+    }
+
+    printf("written in %.3f seconds\n", get_elapsed_seconds(start_time));
+    printf("converted \"%s\" to %s file \"%s\" (%lld state-action pairs)\n",
+            input_file_name.c_str(),
+            to_quantized ? "quantized binary" : (to_binary ? "binary" : "text"),
+            output_file_name.c_str(), storage._Q_maps->get_total_size(0));
+
+    return 0;
+}
+
+
@@ -0,0 +1,393 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * car222_Q_lambda_benchmark.cpp
+ *
+ * Compares how many training races QLearner needs with different λ ( Q(λ) )
+ * on a simple track model : a lap with two curves where the car slides off
+ * the track when it takes a curve faster than its safe speed. QLearner sets
+ * accel ( as in car222 ) and rewards are same as those of race_reward.cpp.
+ *
+ *  usage : car222_Q_lambda_benchmark [-r <replay updates>] [-p <planning steps>]
+ *                [-d <planning updates>] [<runs> [<max races> [<lambda>...]]]
+ *
+ * For each λ it runs training from empty Q values ( once for each seed ) and
+ * reports races until the car completes RACES_FOR_THRESHOLD laps in a row,
+ * along with the lap time at that point. Options are same as in car222 :
+ *  -r  steps of the races are replayed ( experience replay ) after each race
+ *  -p  planning updates from a model of the track ( Dyna-Q ) after each step
+ *  -d  planning updates from the model after each race
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "q_learning.h"
+#include "car222_Q_maps.h"
+#include "car222_Q_replay.h"
+#include "car222_Q_model.h"
+
+
+// learning parameters ( first stage of LEARNING_PARAMETERS )
+#define LEARNING_RATE                1.0/4
+#define DISCOUNT                     1020.0/1024
+#define EPSILON                      1.0/256
+
+// laps completed in a row for the threshold
+#define RACES_FOR_THRESHOLD          20
+
+// experience replay ( see car222_race_config.h )
+#define REPLAY_BUFFER_SIZE           (1 << 16)
+#define REPLAY_BATCH_SIZE            256
+
+// track model ( lengths in m, speeds in m/s, time in s )
+#define LAP_LENGTH                   1200.0
+#define TRACK_WIDTH                  12.0
+#define CURVE_SAFE_SPEED             22.0
+#define CURVE_LOOKAHEAD              60.0
+#define TIME_STEP                    0.2
+#define MAX_STEPS                    2000
+
+// rewards ( same as race_reward.h )
+#define MIN_SLOW_SPEED               5
+#define HIGH_SPEED_CUTOFF            45
+#define SLOW_SPEED_PENALTY_COEFFICIENT     1.0/8
+#define HIGH_SPEED_REWARD_COEFFICIENT      1.0/1024
+#define PENALTY_FOR_GOING_OUT        10000
+#define SPEED_UNIT_REWARD            1.0/256
+
+
+// curves of the lap ( start and end distance )
+static const double CURVES[][2] = { {300, 450}, {900, 1050} };
+
+
+/* returns non-zero if given distance of the lap is in a curve */
+static int is_in_curve(const double distance)
+{
+    const double lap_distance = fmod(distance, LAP_LENGTH);
+    for(size_t i = 0; i < sizeof(CURVES) / sizeof(CURVES[0]); i++)
+    {
+        if(lap_distance >= CURVES[i][0] && lap_distance < CURVES[i][1])
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+/* returns reward of a step ( see race_reward.cpp ) */
+static float get_step_reward(const double speed, const int is_outside)
+{
+    if(is_outside)
+    {
+        return -PENALTY_FOR_GOING_OUT;
+    }
+
+    const int speed_x = (int) speed;
+    if(speed_x < MIN_SLOW_SPEED)
+    {
+        return -pow(MIN_SLOW_SPEED - speed_x, 3) * SLOW_SPEED_PENALTY_COEFFICIENT;
+    }
+
+    float reward = speed_x * SPEED_UNIT_REWARD;
+    if(speed_x >= HIGH_SPEED_CUTOFF)
+    {
+        reward += pow(speed_x - HIGH_SPEED_CUTOFF, 3) * HIGH_SPEED_REWARD_COEFFICIENT;
+    }
+
+    return reward;
+}
+
+
+/**
+ * drives a lap with the given QLearner ( it learns while driving ).
+ * Returns lap time, or -1 if the car went outside the track.
+ **/
+static double race(controller::QLearner & q_learner)
+{
+    double distance = 0;
+    double speed = 0;
+    double to_right = TRACK_WIDTH / 2;
+
+    for(int step = 0; step < MAX_STEPS; step++)
+    {
+        const int in_curve = is_in_curve(distance);
+
+        // car slides towards right side of a ( left ) curve when it is too fast
+        double slide_speed = 0;
+        if(in_curve && speed > CURVE_SAFE_SPEED)
+        {
+            slide_speed = 0.8 * (speed - CURVE_SAFE_SPEED);
+            to_right -= slide_speed * TIME_STEP;
+        }
+        else
+        {
+            // back towards middle of the track
+            to_right += fmax(-TIME_STEP, fmin(TIME_STEP, TRACK_WIDTH / 2 - to_right));
+        }
+        const int is_outside = (to_right < 0);
+
+        controller::Q_state state;
+        state.speed_x = (int) speed;
+        state.speed_y = (float) -fmin(slide_speed, 1.0);
+        state.right_side_distance = (int) fmin(to_right, 6);
+        state.left_side_distance = (int) fmin(TRACK_WIDTH - to_right, 6);
+        state.path = in_curve ? 0.5 : 0;
+        state.next_path = is_in_curve(distance + CURVE_LOOKAHEAD) ? 0.5 : 0;
+
+        controller::Q_action action;
+        q_learner.get_suggested_action(state, action);
+
+        const float reward = get_step_reward(speed, is_outside);
+
+        if(is_outside)
+        {
+            // end state as in car222
+            state.speed_x = -99;
+            state.speed_y = 0;
+            state.right_side_distance = -1;
+            state.left_side_distance = -1;
+            state.path = 0;
+            state.next_path = 0;
+            action.accel = 0;
+        }
+
+        q_learner.set_state_action_and_reward(state, action, reward);
+
+        if(is_outside)
+        {
+            return -1;
+        }
+
+        // low accel brakes ( like fuzzy controller does ) and drag grows with speed
+        speed = fmax(0, speed + (14 * action.accel - 4 - 0.002 * speed * speed) * TIME_STEP);
+        distance += speed * TIME_STEP;
+
+        if(distance >= LAP_LENGTH)
+        {
+            return (step + 1) * TIME_STEP;
+        }
+    }
+
+    // too slow to finish the lap
+    return MAX_STEPS * TIME_STEP;
+}
+
+
+/**
+ * updates made besides those of the steps of races
+ **/
+typedef struct benchmark_options_struct
+{
+
+    // replayed updates after each race
+    long long int replay_updates;
+    // planning updates after each step and after each race
+    int planning_steps;
+    long long int planning_updates;
+
+} benchmark_options;
+
+
+/**
+ * trains from empty Q values with given λ and seed ( and updates of options ).
+ * Returns races until the threshold ( -1 if not reached within max races )
+ * and lap time at that point.
+ **/
+static int train(const float lambda, const benchmark_options & options,
+        const unsigned int seed, const int max_races, double & lap_time)
+{
+    const long long int replay_updates = options.replay_updates;
+
+    srand(seed);
+
+    controller_storage::Q_maps_storage storage;
+    controller::QLearner q_learner(storage, LEARNING_RATE, DISCOUNT, EPSILON);
+    q_learner.set_lambda(lambda);
+
+    controller_storage::Q_replay_buffer replay_buffer;
+    controller_storage::Q_replay_parameters replay_parameters;
+    replay_parameters.learning_rate = LEARNING_RATE;
+    replay_parameters.discount = DISCOUNT;
+    replay_parameters.batch_size = REPLAY_BATCH_SIZE;
+    replay_parameters.prioritized = 1;
+    replay_parameters.max_updates = replay_updates;
+    replay_parameters.visit_counts = NULL;
+    if(replay_updates > 0)
+    {
+        replay_buffer.set_capacity(REPLAY_BUFFER_SIZE);
+        q_learner.set_replay_buffer(&replay_buffer);
+    }
+
+    controller_storage::Q_transition_model transition_model;
+    controller_storage::Q_planning_parameters planning_parameters;
+    planning_parameters.learning_rate = LEARNING_RATE;
+    planning_parameters.discount = DISCOUNT;
+    planning_parameters.max_updates = 0;
+    planning_parameters.visit_counts = NULL;
+    if(options.planning_steps > 0 || options.planning_updates > 0)
+    {
+        q_learner.set_transition_model(&transition_model, options.planning_steps);
+    }
+
+    int laps_in_a_row = 0;
+    for(int race_number = 1; race_number <= max_races; race_number++)
+    {
+        lap_time = race(q_learner);
+
+        // replay between races
+        for(long long int updates = 0; updates < replay_updates; )
+        {
+            updates += replay_buffer.replay_batch(*storage._Q_maps, replay_parameters);
+        }
+
+        // planning between races
+        for(long long int updates = 0; updates < options.planning_updates; )
+        {
+            updates += transition_model.plan(*storage._Q_maps, planning_parameters,
+                    Q_PLANNING_BATCH_SIZE);
+        }
+
+        laps_in_a_row = (lap_time > 0 && lap_time < MAX_STEPS * TIME_STEP) ?
+            laps_in_a_row + 1 : 0;
+        if(laps_in_a_row == RACES_FOR_THRESHOLD)
+        {
+            return race_number;
+        }
+    }
+
+    return -1;
+}
+
+
+int main(int argc, char * argv[])
+{
+    setbuf(stdout, NULL);
+
+    benchmark_options options;
+    options.replay_updates = 0;
+    options.planning_steps = 0;
+    options.planning_updates = 0;
+
+    int first_argument = 1;
+    while(first_argument + 1 < argc && argv[first_argument][0] == '-')
+    {
+        const std::string option = argv[first_argument];
+        if(option == "-r")
+        {
+            options.replay_updates = atoll(argv[first_argument + 1]);
+        }
+        else if(option == "-p")
+        {
+            options.planning_steps = atoi(argv[first_argument + 1]);
+        }
+        else if(option == "-d")
+        {
+            options.planning_updates = atoll(argv[first_argument + 1]);
+        }
+        else
+        {
+            options.replay_updates = -1;
+            break;
+        }
+        first_argument += 2;
+    }
+
+    const int runs = (argc > first_argument) ? atoi(argv[first_argument]) : 10;
+    const int max_races = (argc > first_argument + 1) ? atoi(argv[first_argument + 1]) : 20000;
+
+    std::vector<float> lambdas;
+    for(int i = first_argument + 2; i < argc; i++)
+    {
+        lambdas.push_back((float) atof(argv[i]));
+    }
+    if(lambdas.empty())
+    {
+        lambdas.push_back(0.0f);
+        lambdas.push_back(0.5f);
+        lambdas.push_back(0.8f);
+        lambdas.push_back(0.9f);
+    }
+
+    if(runs <= 0 || max_races <= 0 || options.replay_updates < 0 ||
+            options.planning_steps < 0 || options.planning_updates < 0)
+    {
+        printf("usage : %s [-r <replay updates>] [-p <planning steps>]"
+                " [-d <planning updates>] [<runs> [<max races> [<lambda>...]]]\n",
+                argv[0]);
+        return 1;
+    }
+
+    printf("races until %d laps in a row ( %d runs, at most %d races each )\n",
+            RACES_FOR_THRESHOLD, runs, max_races);
+    printf("replay updates per race %lld, planning updates per step %d and per race %lld\n",
+            options.replay_updates, options.planning_steps, options.planning_updates);
+    printf("%8s %10s %10s %10s %10s %12s\n",
+            "lambda", "reached", "median", "mean", "max", "lap time");
+
+    for(size_t i = 0; i < lambdas.size(); i++)
+    {
+        std::vector<int> races;
+        double lap_time_sum = 0;
+        for(int run = 0; run < runs; run++)
+        {
+            double lap_time = 0;
+            const int race_count = train(lambdas[i], options, 1 + run,
+                    max_races, lap_time);
+            if(race_count > 0)
+            {
+                races.push_back(race_count);
+                lap_time_sum += lap_time;
+            }
+        }
+
+        if(races.empty())
+        {
+            printf("%8.2f %7d/%-2d %10s %10s %10s %12s\n",
+                    lambdas[i], 0, runs, "-", "-", "-", "-");
+            continue;
+        }
+
+        std::sort(races.begin(), races.end());
+        double race_sum = 0;
+        for(size_t j = 0; j < races.size(); j++)
+        {
+            race_sum += races[j];
+        }
+
+        printf("%8.2f %7d/%-2d %10d %10.1f %10d %12.1f\n", lambdas[i],
+                (int) races.size(), runs, races[races.size() / 2],
+                race_sum / races.size(), races.back(), lap_time_sum / races.size());
+    }
+
+    return 0;
+}
+
@@ -0,0 +1,184 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * car222_Q_merge.cpp
+ *
+ * Merges Q value files of workers of a training farm into the Q value file
+ * of the track ( see car222_training_farm.h ). Workers wait for the merged
+ * file and then continue with it.
+ *
+ *  usage : car222_Q_merge [-w] <merged Q value file> <worker Q value file>...
+ *
+ * Files of all the workers must have same training counter ( they are written
+ * at same race counter ) that is more than training counter of merged file.
+ * With "-w" it keeps watching worker files and merges them each time they
+ * are ready, else it merges once ( if they are ready ).
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include "car222_Q_maps.h"
+#include "car222_Q_visit_counts.h"
+#include "car222_training_farm.h"
+
+
+static void print_usage(const char * program_name)
+{
+    printf("usage : %s [-w] <merged Q value file> <worker Q value file>...\n", program_name);
+}
+
+
+/* returns id of binary file header as string */
+static std::string get_id(const char * id_field)
+{
+    return std::string(id_field, strnlen(id_field, Q_BINARY_ID_LENGTH));
+}
+
+
+/**
+ * merges worker files into merged file if they are ready. Returns 1 if they
+ * were merged, 0 if they are not ready and -1 on error.
+ **/
+static int merge_if_ready(const std::string & merged_file_name,
+        const std::vector<std::string> & worker_file_names)
+{
+    using namespace controller_storage;
+
+    // all the workers have written their files at same race counter
+    Q_binary_header worker_header;
+    long long int race_counter = -1;
+    for(size_t i = 0; i < worker_file_names.size(); i++)
+    {
+        if(read_Q_binary_header(worker_file_names[i], worker_header) != 0 ||
+                (race_counter >= 0 && worker_header.training_counter != race_counter))
+        {
+            return 0;
+        }
+        race_counter = worker_header.training_counter;
+    }
+
+    // ... and they have not been merged yet
+    Q_binary_header merged_header;
+    const int has_merged_file = (read_Q_binary_header(merged_file_name, merged_header) == 0);
+    if(has_merged_file && merged_header.training_counter >= race_counter)
+    {
+        return 0;
+    }
+
+    // workers have started from merged file ( without it, they have started
+    // from a text file and have same Q values for states they haven't visited )
+    Q_maps base_maps;
+    Q_visit_counts base_visits;
+    if(has_merged_file)
+    {
+        base_maps.load_maps_from_binary_file(merged_file_name);
+        base_visits.load_from_file(merged_file_name);
+    }
+
+    std::vector<Q_maps *> worker_maps;
+    std::vector<Q_visit_counts *> worker_visits;
+    int is_ready = 1;
+    for(size_t i = 0; i < worker_file_names.size() && is_ready; i++)
+    {
+        worker_maps.push_back(new Q_maps);
+        worker_visits.push_back(new Q_visit_counts);
+
+        worker_maps[i]->load_maps_from_binary_file(worker_file_names[i]);
+        // visit counts are written before Q value file
+        is_ready = (worker_visits[i]->load_from_file(worker_file_names[i]) == race_counter &&
+                worker_maps[i]->m_training_counter == race_counter);
+    }
+
+    int return_value = 0;
+    if(is_ready)
+    {
+        printf("merging %lu workers at race %lld\n", worker_file_names.size(), race_counter);
+
+        Q_maps merged_maps;
+        Q_visit_counts merged_visits;
+        merge_farm_Q_values(base_maps, base_visits,
+                std::vector<const Q_maps *>(worker_maps.begin(), worker_maps.end()),
+                std::vector<const Q_visit_counts *>(worker_visits.begin(), worker_visits.end()),
+                merged_maps, merged_visits);
+
+        merged_maps.set_version_ids(get_id(worker_header.Q_learner_id),
+                get_id(worker_header.reward_id),
+                get_id(worker_header.fuzzy_controller_version));
+
+        // workers wait for Q value file, so visit counts are written first
+        return_value = (merged_visits.write_to_file(merged_file_name, race_counter) == 0 &&
+                merged_maps.write_maps_to_binary_file(merged_file_name, race_counter) == 0)
+            ? 1 : -1;
+    }
+
+    for(size_t i = 0; i < worker_maps.size(); i++)
+    {
+        delete worker_maps[i];
+        delete worker_visits[i];
+    }
+
+    return return_value;
+}
+
+
+int main(int argc, char * argv[])
+{
+    // output of a watching merge is usually redirected to a log
+    setbuf(stdout, NULL);
+
+    const int watch = (argc > 1 && strcmp(argv[1], "-w") == 0);
+    const int first_file_arg = watch ? 2 : 1;
+
+    if(argc - first_file_arg < 2)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const std::string merged_file_name = argv[first_file_arg];
+    const std::vector<std::string> worker_file_names(argv + first_file_arg + 1, argv + argc);
+
+    if(!watch)
+    {
+        const int merged = merge_if_ready(merged_file_name, worker_file_names);
+        if(merged == 0)
+        {
+            puts("worker files are not ready for merging");
+        }
+
+        return (merged == 1) ? 0 : 1;
+    }
+
+    while(merge_if_ready(merged_file_name, worker_file_names) >= 0)
+    {
+        sleep(FARM_POLL_INTERVAL);
+    }
+
+    return 1;
+}
@@ -0,0 +1,213 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * car222_Q_quantization_report.cpp
+ *
+ * Compares Q values of a Q value file ( text or binary with float Q values )
+ * with their quantized values ( Q_VALUES_INT16 ) and reports how often the
+ * greedy action changes and how large the errors are.
+ *
+ *  usage : car222_Q_quantization_report <Q value file> [<quantized Q value file>]
+ *
+ * Without a quantized file, Q values are quantized in memory the same way
+ * as they are quantized while writing a quantized binary file.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <math.h>
+#include <string>
+#include <vector>
+
+#include "car222_Q_maps.h"
+
+
+static void print_usage(const char * program_name)
+{
+    printf("usage : %s <Q value file> [<quantized Q value file>]\n", program_name);
+}
+
+
+/**
+ * returns the action that QLearner chooses for a record when it does not
+ * explore, or -1 when it chooses an untried action ( see
+ * "QLearner::get_suggested_action" ).
+ **/
+static int get_greedy_action(const controller_storage::Q_state_record & state_record)
+{
+    if(__builtin_popcount(state_record.tried_actions) < Q_ACTION_SPACE_SIZE &&
+            state_record.max_Q_value < 0)
+    {
+        return -1;
+    }
+
+    return state_record.max_Q_action;
+}
+
+
+/* returns the tried action with max Q value ( lowest action if there is a tie ) */
+static int get_max_Q_action(const controller_storage::Q_state_record & state_record)
+{
+    int max_Q_action = -1;
+    for(int i = 0; i < Q_ACTION_SPACE_SIZE; i++)
+    {
+        if( (state_record.tried_actions & (1u << i)) && (max_Q_action < 0 ||
+                    state_record.Q_values[i] > state_record.Q_values[max_Q_action]) )
+        {
+            max_Q_action = i;
+        }
+    }
+
+    return max_Q_action;
+}
+
+
+/* prints a count along with its percentage of the given total */
+static void print_rate(const char * name, const long long int count,
+        const long long int total)
+{
+    printf("%-40s %12lld  (%.4f %%)\n", name, count,
+            (total == 0) ? 0.0 : 100.0 * count / total);
+}
+
+
+int main(int argc, char * argv[])
+{
+    using namespace controller_storage;
+
+    if(argc != 2 && argc != 3)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // load Q value file ( its type is detected from its content )
+    Q_maps float_maps;
+    float_maps.load_maps_from_file(argv[1]);
+    if(float_maps.m_Q_value_file_name != argv[1])
+    {
+        printf("couldn't load Q value file \"%s\"\n", argv[1]);
+        return 1;
+    }
+
+    Q_maps quantized_maps;
+    if(argc == 3)
+    {
+        quantized_maps.load_maps_from_binary_file(argv[2]);
+        if(quantized_maps.m_Q_value_file_name != argv[2])
+        {
+            printf("couldn't load quantized Q value file \"%s\"\n", argv[2]);
+            return 1;
+        }
+    }
+
+    std::vector<Q_file_record> records;
+    float_maps.get_all_records(records);
+
+    long long int state_count = 0;
+    long long int Q_value_count = 0;
+    long long int missing_states = 0;
+    long long int greedy_action_changes = 0;
+    long long int max_Q_action_changes = 0;
+    long long int max_Q_sign_changes = 0;
+    double error_sum = 0;
+    double max_error = 0;
+    double max_relative_error = 0;
+
+    for(size_t i = 0; i < records.size(); i++)
+    {
+        const Q_state_record & state_record = records[i].state_record;
+
+        Q_state_record quantized_record;
+        if(argc == 3)
+        {
+            if(!quantized_maps.get_record_for(records[i].state_key, quantized_record))
+            {
+                missing_states++;
+                continue;
+            }
+        }
+        else
+        {
+            Q_quantized_record record;
+            quantize_Q_record(records[i].state_key, state_record, record);
+            dequantize_Q_record(record, quantized_record);
+        }
+
+        state_count++;
+
+        // action chosen by QLearner and action found from Q values
+        greedy_action_changes +=
+            (get_greedy_action(state_record) != get_greedy_action(quantized_record));
+        max_Q_action_changes +=
+            (get_max_Q_action(state_record) != get_max_Q_action(quantized_record));
+        max_Q_sign_changes +=
+            ((state_record.max_Q_value < 0) != (quantized_record.max_Q_value < 0));
+
+        // errors of Q values ( relative to largest Q value of the state )
+        double max_magnitude = 0;
+        for(int action = 0; action < Q_ACTION_SPACE_SIZE; action++)
+        {
+            if(state_record.tried_actions & (1u << action))
+            {
+                max_magnitude = fmax(max_magnitude, fabs(state_record.Q_values[action]));
+            }
+        }
+
+        for(int action = 0; action < Q_ACTION_SPACE_SIZE; action++)
+        {
+            if(state_record.tried_actions & (1u << action))
+            {
+                const double error = fabs((double) state_record.Q_values[action]
+                        - quantized_record.Q_values[action]);
+                error_sum += error;
+                max_error = fmax(max_error, error);
+                if(max_magnitude > 0)
+                {
+                    max_relative_error = fmax(max_relative_error, error / max_magnitude);
+                }
+                Q_value_count++;
+            }
+        }
+    }
+
+    printf("states                                   %12lld\n", state_count);
+    printf("state-action pairs                       %12lld\n", Q_value_count);
+    if(argc == 3)
+    {
+        print_rate("states missing in quantized file", missing_states,
+                state_count + missing_states);
+    }
+    print_rate("greedy action changed", greedy_action_changes, state_count);
+    print_rate("max Q action ( from Q values ) changed", max_Q_action_changes, state_count);
+    print_rate("sign of max Q value changed", max_Q_sign_changes, state_count);
+    printf("mean absolute error                      %12g\n",
+            (Q_value_count == 0) ? 0.0 : error_sum / Q_value_count);
+    printf("max absolute error                       %12g\n", max_error);
+    printf("max error relative to state's max |Q|    %12g\n", max_relative_error);
+    printf("record size ( float / quantized )        %5lu / %lu bytes\n",
+            sizeof(Q_file_record), sizeof(Q_quantized_record));
+
+    return 0;
+}
+
@@ -0,0 +1,477 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * car222_offline_train.cpp
+ *
+ * Learns Q values from trajectory logs of car222 races ( see
+ * car222_trajectory_log.h ) without TORCS and writes them to a Q value file.
+ *
+ *  usage : car222_offline_train [-i <initial Q value file>] [-t <threads>]
+ *                               [-n <sweeps>] [-a <learning rate>] [-g <discount>]
+ *                               [-e <tolerance>] [-c <training counter>] [-b]
+ *                               <Q value file> <trajectory log>...
+ *
+ * Logs are read one race at a time and steps are turned into transitions
+ * the same way as in car222 ( same Q states, same rewards of "race_reward"
+ * and same transition from each step to the next step ). So Q values can be
+ * learnt again for a new reward configuration by changing "race_reward" and
+ * running this instead of training races.
+ *
+ * Transitions are kept by shard of their state in Q_maps ( speed_x ) and
+ * each sweep updates Q values for all the transitions, with threads taking
+ * whole shards ( largest first ). A thread updates states of its shard only,
+ * so threads lock different shards except when they read max Q value of a
+ * next state. Sweeps stop after "-n" sweeps ( default 20 ) or when mean
+ * magnitude of temporal differences of a sweep is below "-e" ( default 0 ).
+ *
+ * It starts from "-i" Q value file if it is given and writes a binary Q value
+ * file with "-b", else a text Q value file.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+#include "car222_Q_maps.h"
+#include "car222_trajectory_log.h"
+#include "q_learning.h"
+#include "race_reward.h"
+#include "car_utils.h"
+#include "fuzzy_controller.h"
+
+
+// steps read from a log at a time
+#define READ_STEPS_AT_A_TIME     4096
+// maximum number of threads of a sweep
+#define MAX_SWEEP_THREADS        64
+
+
+/* a transition from a state-action pair to next state */
+typedef struct offline_transition_struct
+{
+
+    controller_storage::Q_state_key state_key;
+    controller_storage::Q_state_key next_state_key;
+    float reward;
+    controller_storage::Q_action_index action_index;
+
+} offline_transition;
+
+
+/* options given on command line */
+typedef struct train_options_struct
+{
+
+    std::string initial_file_name;
+    int threads;
+    int sweeps;
+    float learning_rate;
+    float discount;
+    double tolerance;
+    long long int training_counter;
+    int binary_file;
+
+} train_options;
+
+
+/* everything shared by threads of a sweep */
+typedef struct sweep_struct
+{
+
+    controller_storage::Q_maps * maps;
+    // transitions of each shard
+    const std::vector<offline_transition> * shard_transitions;
+    // shards in the order they are taken by threads ( largest first )
+    std::vector<int> shard_order;
+    // next position in "shard_order" to be taken
+    std::atomic<int> next_shard;
+    float learning_rate;
+    float discount;
+    // sum of magnitudes of temporal differences of each shard
+    std::vector<double> shard_errors;
+
+} sweep;
+
+
+static void print_usage(const char * program_name)
+{
+    printf("usage : %s [-i <initial Q value file>] [-t <threads>] [-n <sweeps>]"
+            " [-a <learning rate>] [-g <discount>] [-e <tolerance>]"
+            " [-c <training counter>] [-b] <Q value file> <trajectory log>...\n",
+            program_name);
+}
+
+
+/* returns seconds of monotonic clock */
+static double get_seconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+/* returns shard of Q_maps that has the given state */
+static int get_shard_of(const controller_storage::Q_state_key state_key)
+{
+    using namespace controller_storage;
+    return get_Q_shard_for(speed_x_dimension::magnitude(state_key));
+}
+
+
+/**
+ * reads all the races of a trajectory log and adds their transitions to
+ * the shards. Returns number of races read or -1 on error.
+ **/
+static long long int read_log(const char * file_name,
+        std::vector<offline_transition> * shard_transitions, long long int & step_count)
+{
+    controller_storage::Q_trajectory_reader reader;
+    if(reader.open(file_name) != 0)
+    {
+        return -1;
+    }
+
+    std::vector<controller_storage::Q_trajectory_step> steps(READ_STEPS_AT_A_TIME);
+    long long int race_count = 0;
+
+    int has_race;
+    while((has_race = reader.next_race()) == 1)
+    {
+        race_count++;
+
+        // a race starts like it does for a new QLearner in car222 ( its first
+        // transition is from default state and action to first state )
+        controller::Q_state previous_state;
+        controller::Q_action previous_action;
+        float prev_damages = 0;
+        int is_out_of_track = 0;
+
+        long long int read_count;
+        while(!is_out_of_track &&
+                (read_count = reader.read_steps(&steps[0], READ_STEPS_AT_A_TIME)) > 0)
+        {
+            for(long long int i = 0; i < read_count && !is_out_of_track; i++)
+            {
+                const controller_storage::Q_trajectory_step & step = steps[i];
+
+                controller::Q_state state;
+                set_Q_state(step, state);
+                controller::Q_action action;
+                action.accel = step.accel;
+
+                offline_transition transition;
+                transition.reward = get_reward(get_race_step(step), prev_damages);
+
+                // race of the car ends when it goes outside the track
+                if(is_outside_track(step))
+                {
+                    set_end_Q_state(state, action);
+                    is_out_of_track = 1;
+                }
+
+                transition.state_key = previous_state.get_key();
+                transition.action_index = previous_action.get_index();
+                transition.next_state_key = state.get_key();
+                shard_transitions[get_shard_of(transition.state_key)].push_back(transition);
+
+                previous_state = state;
+                previous_action = action;
+                step_count++;
+            }
+        }
+
+        if(read_count < 0)
+        {
+            printf("error reading trajectory log \'%s\'\n", file_name);
+            return -1;
+        }
+    }
+
+    return (has_race < 0) ? -1 : race_count;
+}
+
+
+/* thread function of a sweep ( argument is the sweep ) */
+static void * run_sweep(void * t_sweep)
+{
+    sweep * current_sweep = (sweep *) t_sweep;
+    controller_storage::Q_maps & maps = *(current_sweep->maps);
+
+    int position;
+    while((position = current_sweep->next_shard.fetch_add(1)) <
+            (int) current_sweep->shard_order.size())
+    {
+        const int shard = current_sweep->shard_order[position];
+        const std::vector<offline_transition> & transitions =
+            current_sweep->shard_transitions[shard];
+
+        // transitions of a shard are updated in the order of the races
+        double error_sum = 0;
+        for(size_t i = 0; i < transitions.size(); i++)
+        {
+            const offline_transition & transition = transitions[i];
+            const float temporal_difference = maps.update_Q_value_towards(
+                    transition.state_key, transition.action_index,
+                    transition.reward + current_sweep->discount *
+                    maps.get_max_Q_value_for(transition.next_state_key),
+                    current_sweep->learning_rate);
+            error_sum += fabs(temporal_difference);
+        }
+
+        current_sweep->shard_errors[shard] = error_sum;
+    }
+
+    return NULL;
+}
+
+
+/* returns mean magnitude of temporal differences of a sweep over all the transitions */
+static double run_sweep_threads(sweep & current_sweep, const int thread_count,
+        const long long int transition_count)
+{
+    current_sweep.next_shard = 0;
+    std::fill(current_sweep.shard_errors.begin(), current_sweep.shard_errors.end(), 0.0);
+
+    std::vector<pthread_t> threads(thread_count);
+    int started_threads = 0;
+    for(int i = 0; i < thread_count; i++)
+    {
+        if(pthread_create(&threads[started_threads], NULL, run_sweep, &current_sweep) == 0)
+        {
+            started_threads++;
+        }
+    }
+
+    // shards are swept here if no thread could be started
+    if(started_threads == 0)
+    {
+        run_sweep(&current_sweep);
+    }
+
+    for(int i = 0; i < started_threads; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    double error_sum = 0;
+    for(size_t i = 0; i < current_sweep.shard_errors.size(); i++)
+    {
+        error_sum += current_sweep.shard_errors[i];
+    }
+
+    return (transition_count == 0) ? 0.0 : error_sum / transition_count;
+}
+
+
+/**
+ * reads options to "options" and returns index of first argument after
+ * them ( or -1 if an option is not valid )
+ **/
+static int read_options(int argc, char * argv[], train_options & options)
+{
+    const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    options.threads = (processors > 0) ? processors : 1;
+    options.sweeps = 20;
+    options.learning_rate = DEFAULT_LEARNING_RATE;
+    options.discount = DEFAULT_DISCOUNT_RATE;
+    options.tolerance = 0;
+    options.training_counter = -1;
+    options.binary_file = 0;
+
+    int first_argument = 1;
+    while(first_argument < argc && argv[first_argument][0] == '-')
+    {
+        const std::string option = argv[first_argument];
+        if(option == "-b")
+        {
+            options.binary_file = 1;
+            first_argument++;
+            continue;
+        }
+
+        if(first_argument + 1 >= argc)
+        {
+            return -1;
+        }
+
+        const char * value = argv[first_argument + 1];
+        if(option == "-i")
+        {
+            options.initial_file_name = value;
+        }
+        else if(option == "-t")
+        {
+            options.threads = atoi(value);
+        }
+        else if(option == "-n")
+        {
+            options.sweeps = atoi(value);
+        }
+        else if(option == "-a")
+        {
+            options.learning_rate = atof(value);
+        }
+        else if(option == "-g")
+        {
+            options.discount = atof(value);
+        }
+        else if(option == "-e")
+        {
+            options.tolerance = atof(value);
+        }
+        else if(option == "-c")
+        {
+            options.training_counter = atoll(value);
+        }
+        else
+        {
+            return -1;
+        }
+        first_argument += 2;
+    }
+
+    if(options.threads <= 0 || options.sweeps <= 0 || options.learning_rate <= 0 ||
+            options.learning_rate > 1 || options.discount < 0 || options.discount > 1)
+    {
+        return -1;
+    }
+    options.threads = std::min(options.threads, MAX_SWEEP_THREADS);
+
+    return first_argument;
+}
+
+
+int main(int argc, char * argv[])
+{
+    using namespace controller_storage;
+
+    setbuf(stdout, NULL);
+
+    train_options options;
+    const int first_argument = read_options(argc, argv, options);
+    if(first_argument < 0 || argc - first_argument < 2)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+    const std::string Q_value_file_name = argv[first_argument];
+
+    Q_maps maps;
+    maps.set_version_ids(Q_LEARNER_ID, RACE_REWARD_ID, FUZZY_CONTROLLER_VERSION);
+    long long int training_counter = 0;
+    if(!options.initial_file_name.empty())
+    {
+        training_counter = maps.load_maps_from_file(options.initial_file_name);
+        if(maps.m_Q_value_file_name != options.initial_file_name)
+        {
+            printf("couldn't load Q value file \"%s\"\n", options.initial_file_name.c_str());
+            return 1;
+        }
+    }
+    if(options.training_counter >= 0)
+    {
+        training_counter = options.training_counter;
+    }
+
+    // transitions of all the logs by shard of their state
+    std::vector<offline_transition> shard_transitions[Q_MAP_SHARDS];
+    long long int race_count = 0;
+    long long int step_count = 0;
+    double start_time = get_seconds();
+    for(int i = first_argument + 1; i < argc; i++)
+    {
+        const long long int log_races = read_log(argv[i], shard_transitions, step_count);
+        if(log_races < 0)
+        {
+            return 1;
+        }
+        race_count += log_races;
+    }
+    printf("read %lld races, %lld steps in %.3f seconds ( reward configuration %s )\n",
+            race_count, step_count, get_seconds() - start_time, RACE_REWARD_ID);
+
+    sweep current_sweep;
+    current_sweep.maps = &maps;
+    current_sweep.shard_transitions = shard_transitions;
+    current_sweep.learning_rate = options.learning_rate;
+    current_sweep.discount = options.discount;
+    current_sweep.shard_errors.resize(Q_MAP_SHARDS);
+
+    // largest shards are taken first, so no thread is left with a large one at the end
+    for(int shard = 0; shard < Q_MAP_SHARDS; shard++)
+    {
+        if(!shard_transitions[shard].empty())
+        {
+            current_sweep.shard_order.push_back(shard);
+        }
+    }
+    std::stable_sort(current_sweep.shard_order.begin(), current_sweep.shard_order.end(),
+            [&shard_transitions](const int a, const int b)
+            {
+                return shard_transitions[a].size() > shard_transitions[b].size();
+            });
+
+    const int thread_count = std::min(options.threads,
+            std::max((int) current_sweep.shard_order.size(), 1));
+    printf("%d sweeps with %d threads over %lu shards ( learning rate %g, discount %g )\n",
+            options.sweeps, thread_count, current_sweep.shard_order.size(),
+            options.learning_rate, options.discount);
+
+    for(int i = 0; i < options.sweeps; i++)
+    {
+        start_time = get_seconds();
+        const double mean_error = run_sweep_threads(current_sweep, thread_count, step_count);
+        printf("sweep %3d - mean |temporal difference| %12.6f  ( %.3f seconds )\n",
+                i + 1, mean_error, get_seconds() - start_time);
+
+        if(mean_error < options.tolerance)
+        {
+            break;
+        }
+    }
+
+    start_time = get_seconds();
+    const int write_result = options.binary_file ?
+        maps.write_maps_to_binary_file(Q_value_file_name, training_counter) :
+        maps.write_maps_to_file(Q_value_file_name, training_counter);
+    if(write_result != 0)
+    {
+        printf("couldn't write Q value file \"%s\"\n", Q_value_file_name.c_str());
+        return 1;
+    }
+    printf("wrote %lld state-action pairs to \"%s\" in %.3f seconds\n",
+            maps.get_total_size(), Q_value_file_name.c_str(), get_seconds() - start_time);
+
+    return 0;
+}
+
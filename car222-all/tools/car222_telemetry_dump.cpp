@@ -0,0 +1,243 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * car222_telemetry_dump.cpp
+ *
+ * Prints races and records of a telemetry file of car222 ( or car111 ) and
+ * converts races of a telemetry file to a trajectory log for offline training.
+ *
+ *  usage : car222_telemetry_dump <telemetry file> [<race id> [<first tick> [<ticks>]]]
+ *          car222_telemetry_dump -t <trajectory log> <telemetry file>...
+ *
+ * Without a race id it prints races of the file. With a race id it prints
+ * records of the race from the given tick ( blocks before it are not read ).
+ * With "-t" each race is appended to the trajectory log as steps with the
+ * accel suggested by Q Learner ( or the fuzzy accel for car111 ).
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "telemetry_reader.h"
+#include "car222_trajectory_log.h"
+
+
+static void print_usage(const char * program_name)
+{
+    printf("usage : %s <telemetry file> [<race id> [<first tick> [<ticks>]]]\n"
+            "        %s -t <trajectory log> <telemetry file>...\n",
+            program_name, program_name);
+}
+
+
+/* prints races of the file with their blocks, records and time */
+static int print_races(controller_telemetry::telemetry_reader & reader)
+{
+    using namespace controller_telemetry;
+
+    const std::vector<telemetry_index_entry> & blocks = reader.get_blocks();
+    printf("%20s %8s %10s %12s %12s\n", "race id", "blocks", "records", "first time", "last time");
+
+    std::vector<telemetry_record> first_records;
+    std::vector<telemetry_record> last_records;
+    size_t first_block = 0;
+    for(size_t i = 0; i < blocks.size(); i++)
+    {
+        // last block of a race
+        if(i + 1 < blocks.size() && blocks[i + 1].race_id == blocks[i].race_id)
+        {
+            continue;
+        }
+
+        long long int record_count = 0;
+        for(size_t j = first_block; j <= i; j++)
+        {
+            record_count += blocks[j].record_count;
+        }
+
+        if(reader.read_block(first_block, first_records) != 0 ||
+                reader.read_block(i, last_records) != 0 ||
+                first_records.empty() || last_records.empty())
+        {
+            printf("couldn't read blocks of race %llu\n", blocks[i].race_id);
+            return -1;
+        }
+
+        printf("%20llu %8lu %10lld %12.2f %12.2f\n", blocks[i].race_id,
+                i + 1 - first_block, record_count, first_records[0].time,
+                last_records.back().time);
+        first_block = i + 1;
+    }
+
+    return 0;
+}
+
+
+/* prints records of a race from the first tick */
+static int print_records(controller_telemetry::telemetry_reader & reader,
+        const unsigned long long int race_id, const unsigned int first_tick,
+        const long long int tick_count)
+{
+    using namespace controller_telemetry;
+
+    printf("%8s %9s %5s %8s %7s %7s %7s %7s %7s %7s %7s %4s %7s %5s %5s %5s %10s\n",
+            "tick", "time", "seg", "speed_x", "speed_y", "accel_x", "left", "right",
+            "damage", "path", "next", "gear", "steer", "accel", "brake", "Q", "reward");
+
+    const std::vector<telemetry_index_entry> & blocks = reader.get_blocks();
+    std::vector<telemetry_record> records;
+    long long int printed = 0;
+    for(int i = reader.find_block(race_id, first_tick);
+            i >= 0 && i < (int) blocks.size() && blocks[i].race_id == race_id &&
+            printed < tick_count; i++)
+    {
+        if(reader.read_block(i, records) != 0)
+        {
+            printf("couldn't read block %d\n", i);
+            return -1;
+        }
+
+        for(size_t j = 0; j < records.size() && printed < tick_count; j++)
+        {
+            const telemetry_record & record = records[j];
+            if(record.tick < first_tick)
+            {
+                continue;
+            }
+
+            printf("%8u %9.2f %5d %8.3f %7.3f %7.3f %7.3f %7.3f %7.0f %7.3f %7.3f"
+                    " %4d %7.3f %5.3f %5.3f %5.3f %10.4f\n",
+                    record.tick, record.time, record.segment_id, record.speed_x,
+                    record.speed_y, record.accel_x, record.to_left, record.to_right,
+                    record.damage, record.path, record.next_path, record.gear,
+                    record.steer, record.accel, record.brake, record.Q_accel,
+                    record.reward);
+            printed++;
+        }
+    }
+
+    return 0;
+}
+
+
+/* appends each race of the file to trajectory log ( returns races appended or -1 ) */
+static int convert_to_trajectory(controller_telemetry::telemetry_reader & reader,
+        const char * trajectory_file_name)
+{
+    using namespace controller_telemetry;
+
+    const std::vector<telemetry_index_entry> & blocks = reader.get_blocks();
+    std::vector<telemetry_record> records;
+    std::vector<controller_storage::Q_trajectory_step> steps;
+    int race_count = 0;
+    for(size_t i = 0; i < blocks.size(); i++)
+    {
+        if(reader.read_block(i, records) != 0)
+        {
+            printf("couldn't read block %lu\n", i);
+            return -1;
+        }
+
+        for(size_t j = 0; j < records.size(); j++)
+        {
+            const telemetry_record & record = records[j];
+
+            controller_storage::Q_trajectory_step step;
+            step.speed_x = record.speed_x;
+            step.speed_y = record.speed_y;
+            step.to_right = record.to_right;
+            step.to_left = record.to_left;
+            step.path = record.path;
+            step.next_path = record.next_path;
+            step.damages = record.damage;
+            step.accel = (record.Q_accel == TELEMETRY_NO_Q_ACTION) ?
+                record.accel : record.Q_accel;
+            steps.push_back(step);
+        }
+
+        // race ends with its last block
+        if(i + 1 == blocks.size() || blocks[i + 1].race_id != blocks[i].race_id)
+        {
+            if(controller_storage::append_trajectory(trajectory_file_name, steps) != 0)
+            {
+                return -1;
+            }
+            steps.clear();
+            race_count++;
+        }
+    }
+
+    return race_count;
+}
+
+
+int main(int argc, char * argv[])
+{
+    using namespace controller_telemetry;
+
+    if(argc >= 4 && strcmp(argv[1], "-t") == 0)
+    {
+        for(int i = 3; i < argc; i++)
+        {
+            telemetry_reader reader;
+            const int race_count = (reader.open(argv[i]) == 0) ?
+                convert_to_trajectory(reader, argv[2]) : -1;
+            if(race_count < 0)
+            {
+                return 1;
+            }
+            printf("%s - %d races appended to \"%s\"\n", argv[i], race_count, argv[2]);
+        }
+        return 0;
+    }
+
+    if(argc < 2 || argc > 5 || argv[1][0] == '-')
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    telemetry_reader reader;
+    if(reader.open(argv[1]) != 0)
+    {
+        return 1;
+    }
+
+    if(argc == 2)
+    {
+        return (print_races(reader) == 0) ? 0 : 1;
+    }
+
+    const unsigned long long int race_id = strtoull(argv[2], NULL, 10);
+    const unsigned int first_tick = (argc > 3) ? strtoul(argv[3], NULL, 10) : 0;
+    const long long int tick_count = (argc > 4) ? atoll(argv[4]) : -1;
+
+    return (print_records(reader, race_id, first_tick,
+                (tick_count < 0) ? (1LL << 62) : tick_count) == 0) ? 0 : 1;
+}
+
@@ -0,0 +1,46 @@
+#!/bin/sh
+#
+# file              : car222_training_farm.sh
+# description       : runs a training farm of car222, i.e. several headless
+#                     torcs processes ( workers ) training on the same track,
+#                     with their Q values merged by car222_Q_merge after each
+#                     FARM_SYNC_AFTER_N_RACES races of the workers
+# usage             : car222_training_farm.sh <number of workers> <track name>
+#                         [<race config file>]
+# created           : 17 Oct 2026
+# copyright         : (C) 2018 M.S.Khan
+# license           : GNU GPLv3
+#
+
+
+if [ $# -lt 2 ]; then
+    echo "usage : $0 <number of workers> <track name> [<race config file>]"
+    exit 1
+fi
+
+WORKERS=$1
+TRACK=$2
+RACE_CONFIG=${3:-$HOME/.torcs/config/raceman/quickrace.xml}
+
+Q_VALUE_DIR=$HOME/.torcs/drivers/car222
+MERGED_FILE=$Q_VALUE_DIR/q_learner_$TRACK.bin
+TOOLS_DIR=$(dirname "$0")
+
+# start workers ( each one writes its own Q value file and log )
+WORKER_FILES=""
+WORKER_PIDS=""
+i=0
+while [ $i -lt $WORKERS ]; do
+    WORKER_FILES="$WORKER_FILES $Q_VALUE_DIR/q_learner_${TRACK}_worker$i.bin"
+    CAR222_FARM_WORKERS=$WORKERS CAR222_FARM_WORKER=$i \
+        torcs -r "$RACE_CONFIG" > "$Q_VALUE_DIR/farm_worker$i.log" 2>&1 &
+    WORKER_PIDS="$WORKER_PIDS $!"
+    i=$((i + 1))
+done
+
+# merge Q values of workers until all of them are done
+"$TOOLS_DIR/car222_Q_merge" -w "$MERGED_FILE" $WORKER_FILES > "$Q_VALUE_DIR/farm_merge.log" 2>&1 &
+MERGE_PID=$!
+
+wait $WORKER_PIDS
+kill $MERGE_PID
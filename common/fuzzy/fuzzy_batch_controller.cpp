@@ -0,0 +1,165 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * fuzzy_batch_controller.cpp
+ *
+ *     version  : 1.0.0
+ *  created on  : 17 Oct 2026
+ *      author  : M.S.Khan
+ */
+
+
+#include <cmath>
+
+#include "fuzzy_batch_controller.h"
+#include "fuzzy_batch_engine.h"
+#include "fuzzy_controller.h"
+
+
+controller::FuzzyBatchController::FuzzyBatchController(const int lane_count)
+{
+    m_lane_count = lane_count > 0 ? lane_count : 0;
+    m_lane_stride = (m_lane_count + FUZZY_BATCH_LANES - 1) / FUZZY_BATCH_LANES * FUZZY_BATCH_LANES;
+
+    m_values.resize(controller_fuzzy::OUTPUT_COUNT * m_lane_stride);
+    m_previous_values.resize(controller_fuzzy::OUTPUT_COUNT * m_lane_stride);
+    m_fuzzy_gears.resize(m_lane_stride);
+    m_gears.resize(m_lane_stride);
+    m_speeds_at_gear_change.resize(m_lane_stride);
+
+    for(int lane = 0; lane < m_lane_stride; lane++)
+    {
+        reset_lane(lane);
+    }
+}
+
+
+int controller::FuzzyBatchController::get_lane_count() const
+{
+    return m_lane_count;
+}
+
+
+void controller::FuzzyBatchController::reset_lane(const int lane)
+{
+    if(lane < 0 || lane >= m_lane_stride)
+    {
+        return;
+    }
+
+    // same as a new FuzzyController
+    for(int i = 0; i < controller_fuzzy::OUTPUT_COUNT; i++)
+    {
+        m_values[i * m_lane_stride + lane] = NAN;
+        m_previous_values[i * m_lane_stride + lane] = NAN;
+    }
+    m_fuzzy_gears[lane] = NAN;
+    m_gears[lane] = 0;
+    m_speeds_at_gear_change[lane] = 0;
+}
+
+
+void controller::FuzzyBatchController::get_outputs(const fuzzy_input_batch & inputs,
+        const fuzzy_output_batch & outputs)
+{
+    for(int first_lane = 0; first_lane < m_lane_count; first_lane += FUZZY_BATCH_LANES)
+    {
+        const int count = m_lane_count - first_lane < FUZZY_BATCH_LANES ?
+            m_lane_count - first_lane : FUZZY_BATCH_LANES;
+        process_lanes(first_lane, count, inputs, outputs);
+    }
+}
+
+
+void controller::FuzzyBatchController::process_lanes(const int first_lane, const int count,
+        const fuzzy_input_batch & inputs, const fuzzy_output_batch & outputs)
+{
+    using namespace controller_fuzzy;
+
+    // inputs of the lanes ( 0 in padding lanes )
+    const float * input_arrays[INPUT_COUNT];
+    input_arrays[SPEED_INPUT] = inputs.speed;
+    input_arrays[ACCELERATION_INPUT] = inputs.acceleration;
+    input_arrays[PATH_INPUT] = inputs.path;
+    input_arrays[NEXT_PATH_INPUT] = inputs.next_path;
+    input_arrays[STABILITY_INPUT] = inputs.stability;
+
+    batch_vector batch_inputs[INPUT_COUNT];
+    for(int i = 0; i < INPUT_COUNT; i++)
+    {
+        scalar lane_inputs[FUZZY_BATCH_LANES];
+        for(int l = 0; l < FUZZY_BATCH_LANES; l++)
+        {
+            lane_inputs[l] = l < count ? input_arrays[i][first_lane + l] : 0.0;
+        }
+        batch_inputs[i] = batch_load(lane_inputs);
+    }
+
+    batch_output_state states[OUTPUT_COUNT];
+    for(int i = 0; i < OUTPUT_COUNT; i++)
+    {
+        states[i].value = batch_load(&m_values[i * m_lane_stride + first_lane]);
+        states[i].previous_value = batch_load(&m_previous_values[i * m_lane_stride + first_lane]);
+    }
+
+    // gear is locked to previous gear output ( as in FuzzyController )
+    scalar fuzzy_gears[FUZZY_BATCH_LANES];
+    for(int l = 0; l < FUZZY_BATCH_LANES; l++)
+    {
+        fuzzy_gears[l] = m_fuzzy_gears[first_lane + l];
+    }
+    states[GEAR_OUTPUT].value = batch_load(fuzzy_gears);
+
+    // process the inputs
+    batch_engine<exact_rule_base>::process(batch_inputs, states);
+
+    scalar values[OUTPUT_COUNT][FUZZY_BATCH_LANES];
+    for(int i = 0; i < OUTPUT_COUNT; i++)
+    {
+        batch_store(&m_values[i * m_lane_stride + first_lane], states[i].value);
+        batch_store(&m_previous_values[i * m_lane_stride + first_lane], states[i].previous_value);
+        batch_store(values[i], states[i].value);
+    }
+
+    // copy the outputs and modify gear as FuzzyController::get_output does
+    for(int l = 0; l < count; l++)
+    {
+        const int lane = first_lane + l;
+        outputs.steer[lane] = values[STEER_OUTPUT][l];
+        outputs.accel[lane] = values[ACCEL_OUTPUT][l];
+        outputs.brake[lane] = values[BRAKE_OUTPUT][l];
+        m_fuzzy_gears[lane] = values[GEAR_OUTPUT][l];
+
+        const float speed = inputs.speed[lane];
+        if(std::fabs(speed - m_speeds_at_gear_change[lane]) >= MIN_ABS_SPEED_DIFF_FOR_GEAR_CHANGE
+                || m_gears[lane] <= LOW_GEAR_FOR_FREE_GEAR_CHANGES)
+        {
+            m_gears[lane] = m_fuzzy_gears[lane] > 0 ?
+                std::ceil(m_fuzzy_gears[lane]) : std::floor(m_fuzzy_gears[lane]);
+            m_speeds_at_gear_change[lane] = speed;
+        }
+        outputs.gear[lane] = m_gears[lane];
+    }
+}
+
+
+controller::FuzzyBatchController::~FuzzyBatchController()
+{
+}
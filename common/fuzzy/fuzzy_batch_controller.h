@@ -0,0 +1,136 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * fuzzy_batch_controller.h
+ *
+ * Fuzzy controller for many sets of inputs at once ( e.g. cars of a training
+ * farm or of a simulator ). Inputs and outputs are structures of arrays, with
+ * one element for each lane, and lanes are processed FUZZY_BATCH_LANES at a
+ * time by the engine of fuzzy_batch_engine.h.
+ *
+ * Each lane is a FuzzyController of its own - gear hysteresis and previous
+ * values of outputs are kept for each lane, so outputs of a lane are same as
+ * outputs of a FuzzyController with exact centroid and without fuzzy table
+ * for the same inputs in the same order ( floats up to rounding of about
+ * 1e-7, gears are same ).
+ *
+ *     version  : 1.0.0
+ *  created on  : 17 Oct 2026
+ *      author  : M.S.Khan
+ */
+
+
+#ifndef FUZZY_BATCH_CONTROLLER_H_
+#define FUZZY_BATCH_CONTROLLER_H_
+
+#include <vector>
+
+#include "fuzzy_engine.h"
+#include "fuzzy_rule_base.h"
+
+
+namespace controller
+{
+
+    /** inputs of all lanes ( same variables as fuzzy_inputs ) **/
+    typedef struct fuzzy_input_batch_struct
+    {
+
+        const float * speed;
+        const float * acceleration;
+        const float * path;
+        const float * next_path;
+        const float * stability;
+
+    } fuzzy_input_batch;
+
+
+    /** outputs of all lanes ( same variables as fuzzy_outputs ) **/
+    typedef struct fuzzy_output_batch_struct
+    {
+
+        float * steer;
+        float * accel;
+        int * gear;
+        float * brake;
+
+    } fuzzy_output_batch;
+
+
+    /*
+     * =====================================================================================
+     *        Class:  FuzzyBatchController
+     *  Description:  Fuzzy controllers of a number of lanes, which get outputs
+     *                for inputs of all lanes with one call.
+     * =====================================================================================
+     */
+    class FuzzyBatchController
+    {
+        public:
+
+            explicit FuzzyBatchController(const int lane_count);
+            ~FuzzyBatchController();
+
+            int get_lane_count() const;
+
+            // get fuzzy outputs of all lanes for their inputs ( arrays of lane count )
+            void get_outputs(const fuzzy_input_batch & inputs, const fuzzy_output_batch & outputs);
+
+            // starts a lane again ( as a new FuzzyController )
+            void reset_lane(const int lane);
+
+
+        private:
+
+            /** MEMBER VARIABLES **/
+
+            int m_lane_count;
+
+            // values and previous values of engine outputs ( values of lane "l" of
+            // output "i" at i * m_lane_stride + l, lanes padded to FUZZY_BATCH_LANES )
+            int m_lane_stride;
+            std::vector<controller_fuzzy::scalar> m_values;
+            std::vector<controller_fuzzy::scalar> m_previous_values;
+
+            // gear output of last inputs ( before it is rounded ), applied gear and
+            // recorded speed at last gear change of each lane
+            std::vector<float> m_fuzzy_gears;
+            std::vector<int> m_gears;
+            std::vector<float> m_speeds_at_gear_change;
+
+
+            /** MEMBER FUNCTIONS **/
+
+            // runs the engine for lanes from "first_lane" ( FUZZY_BATCH_LANES of them,
+            // "count" with inputs ) and writes their outputs
+            void process_lanes(const int first_lane, const int count,
+                    const fuzzy_input_batch & inputs, const fuzzy_output_batch & outputs);
+
+            // copy constructor
+            FuzzyBatchController(const FuzzyBatchController &other);
+
+            // assignment operator
+            FuzzyBatchController& operator=(const FuzzyBatchController &other);
+
+    };       /** class FuzzyBatchController **/
+
+}
+
+#endif      /** ifndef FUZZY_BATCH_CONTROLLER_H_ **/
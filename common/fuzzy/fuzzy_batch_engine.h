@@ -0,0 +1,779 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * fuzzy_batch_engine.h
+ *
+ * The engine of fuzzy_engine.h for FUZZY_BATCH_LANES sets of inputs at once
+ * ( lanes, e.g. one for each car ). Memberships, rules and activations are
+ * computed for all lanes with the same operations as the engine, so degrees
+ * of rules are same as in the engine. Instructions are AVX2 if compiled with
+ * -mavx2 ( two vectors of 4 lanes ), else SSE2 ( four vectors of 2 lanes ) or
+ * plain C++.
+ *
+ * Outputs are defuzzified with exact centroid, in a form that has no branches
+ * for lanes. For AlgebraicProduct implication and AlgebraicSum aggregation,
+ * aggregated membership of rules with activation degrees a ( r ) and terms
+ * mu ( r ) is
+ *
+ *      1 - ( 1 - a ( 1 ) mu ( 1 ) ) ( 1 - a ( 2 ) mu ( 2 ) ) ...
+ *
+ *    = sum over non-empty sets S of rules of
+ *          - product over S of ( - a ( r ) ) * product over S of mu ( r )
+ *
+ * so its area and moment are sums of integrals of products of terms of each
+ * set of rules ( computed once for a rule block ), times products of degrees.
+ * With First activation only one rule is activated, so any aggregation works
+ * and only sets of one rule are needed. Results are same as exact centroid
+ * of fuzzy_engine.h up to rounding ( about 1e-15 ).
+ *
+ *     version  : 1.0.0
+ *  created on  : 17 Oct 2026
+ *      author  : M.S.Khan
+ */
+
+
+#ifndef FUZZY_BATCH_ENGINE_H_
+#define FUZZY_BATCH_ENGINE_H_
+
+#include <string.h>
+#include <stdint.h>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "fuzzy_engine.h"
+
+
+// lanes processed at once
+#define FUZZY_BATCH_LANES            8
+
+// most rules of a rule block with Proportional activation ( area and moment
+// are kept for each set of its rules )
+#define FUZZY_MAX_BATCH_RULES        8
+
+
+namespace controller_fuzzy
+{
+
+    /** a vector of one value for each lane and operations on it **/
+
+#if defined(__AVX2__)
+
+    typedef __m256d batch_part;
+    #define FUZZY_BATCH_PART_LANES   4
+
+    inline batch_part part_set(const scalar a) { return _mm256_set1_pd(a); }
+    inline batch_part part_load(const scalar * p) { return _mm256_loadu_pd(p); }
+    inline void part_store(scalar * p, const batch_part a) { _mm256_storeu_pd(p, a); }
+    inline batch_part part_add(const batch_part a, const batch_part b) { return _mm256_add_pd(a, b); }
+    inline batch_part part_sub(const batch_part a, const batch_part b) { return _mm256_sub_pd(a, b); }
+    inline batch_part part_mul(const batch_part a, const batch_part b) { return _mm256_mul_pd(a, b); }
+    inline batch_part part_div(const batch_part a, const batch_part b) { return _mm256_div_pd(a, b); }
+    inline batch_part part_and(const batch_part a, const batch_part b) { return _mm256_and_pd(a, b); }
+    inline batch_part part_or(const batch_part a, const batch_part b) { return _mm256_or_pd(a, b); }
+    inline batch_part part_and_not(const batch_part a, const batch_part b) { return _mm256_andnot_pd(b, a); }
+    inline batch_part part_lt(const batch_part a, const batch_part b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    inline batch_part part_gt(const batch_part a, const batch_part b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+    inline batch_part part_eq(const batch_part a, const batch_part b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+    inline batch_part part_nan(const batch_part a) { return _mm256_cmp_pd(a, a, _CMP_UNORD_Q); }
+    inline batch_part part_select(const batch_part mask, const batch_part a, const batch_part b)
+    {
+        return _mm256_blendv_pd(b, a, mask);
+    }
+
+#elif defined(__SSE2__)
+
+    typedef __m128d batch_part;
+    #define FUZZY_BATCH_PART_LANES   2
+
+    inline batch_part part_set(const scalar a) { return _mm_set1_pd(a); }
+    inline batch_part part_load(const scalar * p) { return _mm_loadu_pd(p); }
+    inline void part_store(scalar * p, const batch_part a) { _mm_storeu_pd(p, a); }
+    inline batch_part part_add(const batch_part a, const batch_part b) { return _mm_add_pd(a, b); }
+    inline batch_part part_sub(const batch_part a, const batch_part b) { return _mm_sub_pd(a, b); }
+    inline batch_part part_mul(const batch_part a, const batch_part b) { return _mm_mul_pd(a, b); }
+    inline batch_part part_div(const batch_part a, const batch_part b) { return _mm_div_pd(a, b); }
+    inline batch_part part_and(const batch_part a, const batch_part b) { return _mm_and_pd(a, b); }
+    inline batch_part part_or(const batch_part a, const batch_part b) { return _mm_or_pd(a, b); }
+    inline batch_part part_and_not(const batch_part a, const batch_part b) { return _mm_andnot_pd(b, a); }
+    inline batch_part part_lt(const batch_part a, const batch_part b) { return _mm_cmplt_pd(a, b); }
+    inline batch_part part_gt(const batch_part a, const batch_part b) { return _mm_cmpgt_pd(a, b); }
+    inline batch_part part_eq(const batch_part a, const batch_part b) { return _mm_cmpeq_pd(a, b); }
+    inline batch_part part_nan(const batch_part a) { return _mm_cmpunord_pd(a, a); }
+    inline batch_part part_select(const batch_part mask, const batch_part a, const batch_part b)
+    {
+        return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+    }
+
+#else
+
+    // one lane, with masks as all bits set ( true ) or none ( false )
+    typedef scalar batch_part;
+    #define FUZZY_BATCH_PART_LANES   1
+
+    inline uint64_t part_bits(const batch_part a)
+    {
+        uint64_t bits;
+        memcpy(&bits, &a, sizeof(bits));
+        return bits;
+    }
+    inline batch_part part_from_bits(const uint64_t bits)
+    {
+        batch_part a;
+        memcpy(&a, &bits, sizeof(a));
+        return a;
+    }
+    inline batch_part part_mask(const bool is_set) { return part_from_bits(is_set ? ~0ULL : 0ULL); }
+
+    inline batch_part part_set(const scalar a) { return a; }
+    inline batch_part part_load(const scalar * p) { return *p; }
+    inline void part_store(scalar * p, const batch_part a) { *p = a; }
+    inline batch_part part_add(const batch_part a, const batch_part b) { return a + b; }
+    inline batch_part part_sub(const batch_part a, const batch_part b) { return a - b; }
+    inline batch_part part_mul(const batch_part a, const batch_part b) { return a * b; }
+    inline batch_part part_div(const batch_part a, const batch_part b) { return a / b; }
+    inline batch_part part_and(const batch_part a, const batch_part b)
+    {
+        return part_from_bits(part_bits(a) & part_bits(b));
+    }
+    inline batch_part part_or(const batch_part a, const batch_part b)
+    {
+        return part_from_bits(part_bits(a) | part_bits(b));
+    }
+    inline batch_part part_and_not(const batch_part a, const batch_part b)
+    {
+        return part_from_bits(part_bits(a) & ~part_bits(b));
+    }
+    inline batch_part part_lt(const batch_part a, const batch_part b) { return part_mask(a < b); }
+    inline batch_part part_gt(const batch_part a, const batch_part b) { return part_mask(a > b); }
+    inline batch_part part_eq(const batch_part a, const batch_part b) { return part_mask(a == b); }
+    inline batch_part part_nan(const batch_part a) { return part_mask(a != a); }
+    inline batch_part part_select(const batch_part mask, const batch_part a, const batch_part b)
+    {
+        return part_bits(mask) ? a : b;
+    }
+
+#endif
+
+    #define FUZZY_BATCH_PARTS        (FUZZY_BATCH_LANES / FUZZY_BATCH_PART_LANES)
+
+
+    /**
+     * "statement" for each part "p" of vectors. Parts are written out instead
+     * of a loop, so that vectors of all lanes stay in registers ( at -O2 such
+     * loops are not unrolled ). Conditions are constant.
+     **/
+    #define FUZZY_BATCH_PART(n, ...) \
+        if(n < FUZZY_BATCH_PARTS) \
+        { \
+            const int p = n % FUZZY_BATCH_PARTS; \
+            __VA_ARGS__; \
+        }
+
+    #define FUZZY_BATCH_EACH_PART(...) \
+        { \
+            FUZZY_BATCH_PART(0, __VA_ARGS__) FUZZY_BATCH_PART(1, __VA_ARGS__) \
+            FUZZY_BATCH_PART(2, __VA_ARGS__) FUZZY_BATCH_PART(3, __VA_ARGS__) \
+            FUZZY_BATCH_PART(4, __VA_ARGS__) FUZZY_BATCH_PART(5, __VA_ARGS__) \
+            FUZZY_BATCH_PART(6, __VA_ARGS__) FUZZY_BATCH_PART(7, __VA_ARGS__) \
+        }
+
+    static_assert(FUZZY_BATCH_PARTS <= 8, "parts of vectors are written out for up to 8");
+
+
+    // values of all lanes ( or masks, with all bits of a lane set for true )
+    typedef struct batch_vector_struct
+    {
+
+        batch_part parts[FUZZY_BATCH_PARTS];
+
+    } batch_vector;
+
+
+    /* applies an operation of parts to each part of vectors */
+    #define FUZZY_BATCH_UNARY(name, part_function) \
+        inline batch_vector name(const batch_vector & a) \
+        { \
+            batch_vector result; \
+            FUZZY_BATCH_EACH_PART(result.parts[p] = part_function(a.parts[p])) \
+            return result; \
+        }
+
+    #define FUZZY_BATCH_BINARY(name, part_function) \
+        inline batch_vector name(const batch_vector & a, const batch_vector & b) \
+        { \
+            batch_vector result; \
+            FUZZY_BATCH_EACH_PART(result.parts[p] = part_function(a.parts[p], b.parts[p])) \
+            return result; \
+        }
+
+    FUZZY_BATCH_BINARY(batch_add, part_add)
+    FUZZY_BATCH_BINARY(batch_sub, part_sub)
+    FUZZY_BATCH_BINARY(batch_mul, part_mul)
+    FUZZY_BATCH_BINARY(batch_div, part_div)
+    FUZZY_BATCH_BINARY(batch_and, part_and)
+    FUZZY_BATCH_BINARY(batch_or, part_or)
+    FUZZY_BATCH_BINARY(batch_and_not, part_and_not)
+    FUZZY_BATCH_BINARY(batch_lt, part_lt)
+    FUZZY_BATCH_BINARY(batch_gt, part_gt)
+    FUZZY_BATCH_BINARY(batch_eq, part_eq)
+    FUZZY_BATCH_UNARY(batch_nan, part_nan)
+
+    #undef FUZZY_BATCH_UNARY
+    #undef FUZZY_BATCH_BINARY
+
+
+    inline batch_vector batch_set(const scalar a)
+    {
+        batch_vector result;
+        FUZZY_BATCH_EACH_PART(result.parts[p] = part_set(a))
+        return result;
+    }
+
+    inline batch_vector batch_load(const scalar values[FUZZY_BATCH_LANES])
+    {
+        batch_vector result;
+        FUZZY_BATCH_EACH_PART(result.parts[p] = part_load(values + p * FUZZY_BATCH_PART_LANES))
+        return result;
+    }
+
+    inline void batch_store(scalar values[FUZZY_BATCH_LANES], const batch_vector & a)
+    {
+        FUZZY_BATCH_EACH_PART(part_store(values + p * FUZZY_BATCH_PART_LANES, a.parts[p]))
+    }
+
+    // "a" in lanes of the mask and "b" in other lanes
+    inline batch_vector batch_select(const batch_vector & mask, const batch_vector & a,
+            const batch_vector & b)
+    {
+        batch_vector result;
+        FUZZY_BATCH_EACH_PART(result.parts[p] = part_select(mask.parts[p], a.parts[p], b.parts[p]))
+        return result;
+    }
+
+    inline batch_vector batch_abs(const batch_vector & a)
+    {
+        return batch_and_not(a, batch_set(-0.0));
+    }
+
+
+    /** comparisons and norms for all lanes ( same as for one value ) **/
+    inline batch_vector batch_is_eq(const batch_vector & a, const batch_vector & b)
+    {
+        return batch_or(batch_or(batch_eq(a, b), batch_lt(batch_abs(batch_sub(a, b)),
+                        batch_set(MACHEPS))), batch_and(batch_nan(a), batch_nan(b)));
+    }
+
+    inline batch_vector batch_is_lt(const batch_vector & a, const batch_vector & b)
+    {
+        return batch_and_not(batch_lt(a, b), batch_is_eq(a, b));
+    }
+
+    inline batch_vector batch_is_le(const batch_vector & a, const batch_vector & b)
+    {
+        return batch_or(batch_is_eq(a, b), batch_lt(a, b));
+    }
+
+    inline batch_vector batch_is_gt(const batch_vector & a, const batch_vector & b)
+    {
+        return batch_and_not(batch_gt(a, b), batch_is_eq(a, b));
+    }
+
+    inline batch_vector batch_is_ge(const batch_vector & a, const batch_vector & b)
+    {
+        return batch_or(batch_is_eq(a, b), batch_gt(a, b));
+    }
+
+    inline batch_vector batch_min_of(const batch_vector & a, const batch_vector & b)
+    {
+        return batch_select(batch_nan(a), b, batch_select(batch_nan(b), a,
+                    batch_select(batch_lt(a, b), a, b)));
+    }
+
+    inline batch_vector batch_max_of(const batch_vector & a, const batch_vector & b)
+    {
+        return batch_select(batch_nan(a), b, batch_select(batch_nan(b), a,
+                    batch_select(batch_gt(a, b), a, b)));
+    }
+
+
+    template<typename Norm>
+    struct batch_norm;
+
+    template<>
+    struct batch_norm<minimum>
+    {
+        static batch_vector compute(const batch_vector & a, const batch_vector & b)
+        {
+            return batch_min_of(a, b);
+        }
+    };
+
+    template<>
+    struct batch_norm<maximum>
+    {
+        static batch_vector compute(const batch_vector & a, const batch_vector & b)
+        {
+            return batch_max_of(a, b);
+        }
+    };
+
+    template<>
+    struct batch_norm<algebraic_product>
+    {
+        static batch_vector compute(const batch_vector & a, const batch_vector & b)
+        {
+            return batch_mul(a, b);
+        }
+    };
+
+    template<>
+    struct batch_norm<algebraic_sum>
+    {
+        static batch_vector compute(const batch_vector & a, const batch_vector & b)
+        {
+            return batch_sub(batch_add(a, b), batch_mul(a, b));
+        }
+    };
+
+
+    /**
+     * membership of values of all lanes in a term ( same as get_membership,
+     * with branches of the lanes selected from the last to the first ). Each
+     * vertex is compared once - vertices are not NaN, so is_eq is a
+     * difference within MACHEPS, and NaN lanes are set at the end.
+     **/
+    inline batch_vector get_batch_membership(const term & t, const batch_vector & x)
+    {
+        const scalar infinity = std::numeric_limits<scalar>::infinity();
+        const batch_vector zero = batch_set(0.0);
+        const batch_vector one = batch_set(1.0);
+        const batch_vector epsilon = batch_set(MACHEPS);
+        batch_vector result = zero;
+
+        switch(t.shape)
+        {
+            case TRAPEZOID :
+            {
+                const batch_vector a = batch_set(t.a);
+                const batch_vector b = batch_set(t.b);
+                const batch_vector c = batch_set(t.c);
+                const batch_vector d = batch_set(t.d);
+                const batch_vector x_is_a = batch_or(batch_eq(x, a),
+                        batch_lt(batch_abs(batch_sub(x, a)), epsilon));
+                const batch_vector x_is_b = batch_or(batch_eq(x, b),
+                        batch_lt(batch_abs(batch_sub(x, b)), epsilon));
+                const batch_vector x_is_c = batch_or(batch_eq(x, c),
+                        batch_lt(batch_abs(batch_sub(x, c)), epsilon));
+                const batch_vector x_is_d = batch_or(batch_eq(x, d),
+                        batch_lt(batch_abs(batch_sub(x, d)), epsilon));
+
+                result = (t.d == infinity) ? one : zero;
+                result = batch_select(batch_and_not(batch_lt(x, d), x_is_d), (t.d == infinity) ?
+                        one : batch_div(batch_sub(d, x), batch_sub(d, c)), result);
+                result = batch_select(batch_or(x_is_c, batch_lt(x, c)), one, result);
+                result = batch_select(batch_and_not(batch_lt(x, b), x_is_b), (t.a == -infinity) ?
+                        one : batch_min_of(one, batch_div(batch_sub(x, a), batch_sub(b, a))), result);
+                result = batch_select(batch_or(batch_and_not(batch_lt(x, a), x_is_a),
+                            batch_and_not(batch_gt(x, d), x_is_d)), zero, result);
+                break;
+            }
+
+            case RAMP :
+            {
+                if(is_eq(t.a, t.b))
+                {
+                    return zero;
+                }
+
+                const batch_vector start = batch_set(t.a);
+                const batch_vector end = batch_set(t.b);
+                const batch_vector x_is_start = batch_or(batch_eq(x, start),
+                        batch_lt(batch_abs(batch_sub(x, start)), epsilon));
+                const batch_vector x_is_end = batch_or(batch_eq(x, end),
+                        batch_lt(batch_abs(batch_sub(x, end)), epsilon));
+                if(is_lt(t.a, t.b))
+                {
+                    result = batch_select(batch_or(x_is_end, batch_gt(x, end)), one,
+                            batch_div(batch_sub(x, start), batch_sub(end, start)));
+                    result = batch_select(batch_or(x_is_start, batch_lt(x, start)), zero, result);
+                }
+                else
+                {
+                    result = batch_select(batch_or(x_is_end, batch_lt(x, end)), one,
+                            batch_div(batch_sub(start, x), batch_sub(start, end)));
+                    result = batch_select(batch_or(x_is_start, batch_gt(x, start)), zero, result);
+                }
+                break;
+            }
+
+            case RECTANGLE :
+                result = batch_select(batch_and(batch_is_ge(x, batch_set(t.a)),
+                            batch_is_le(x, batch_set(t.b))), one, zero);
+                break;
+        }
+
+        // membership of NaN is NaN
+        return batch_select(batch_nan(x), x, result);
+    }
+
+
+    /** antecedents for all lanes ( Block has conjunction and disjunction ) **/
+    template<typename Antecedent>
+    struct batch_antecedent;
+
+    template<typename Input, int Term>
+    struct batch_antecedent<is<Input, Term> >
+    {
+        template<typename Block>
+        static batch_vector get_degree(const batch_vector inputs[])
+        {
+            return get_batch_membership(Input::get_term(Term), inputs[Input::index]);
+        }
+    };
+
+    template<typename Left, typename Right>
+    struct batch_antecedent<fuzzy_and<Left, Right> >
+    {
+        template<typename Block>
+        static batch_vector get_degree(const batch_vector inputs[])
+        {
+            return batch_norm<typename Block::conjunction>::compute(
+                    batch_antecedent<Left>::template get_degree<Block>(inputs),
+                    batch_antecedent<Right>::template get_degree<Block>(inputs));
+        }
+    };
+
+    template<typename Left, typename Right>
+    struct batch_antecedent<fuzzy_or<Left, Right> >
+    {
+        template<typename Block>
+        static batch_vector get_degree(const batch_vector inputs[])
+        {
+            return batch_norm<typename Block::disjunction>::compute(
+                    batch_antecedent<Left>::template get_degree<Block>(inputs),
+                    batch_antecedent<Right>::template get_degree<Block>(inputs));
+        }
+    };
+
+
+    /**
+     * activations for all lanes - activation degree of each rule ( 0 if not
+     * activated ) and mask of lanes where no rule is activated
+     **/
+    template<typename Activation>
+    struct batch_activation;
+
+    template<>
+    struct batch_activation<first>
+    {
+        static void activate(const batch_vector degrees[], const int rule_count,
+                batch_vector activations[], batch_vector & is_empty)
+        {
+            const batch_vector zero = batch_set(0.0);
+            batch_vector is_activated = batch_eq(zero, batch_set(1.0));
+            for(int i = 0; i < rule_count; i++)
+            {
+                const batch_vector fires = batch_and_not(batch_and(batch_is_gt(degrees[i], zero),
+                            batch_is_ge(degrees[i], zero)), is_activated);
+                activations[i] = batch_select(fires, degrees[i], zero);
+                is_activated = batch_or(is_activated, fires);
+            }
+            is_empty = batch_eq(is_activated, zero);
+        }
+    };
+
+    template<>
+    struct batch_activation<proportional>
+    {
+        static void activate(const batch_vector degrees[], const int rule_count,
+                batch_vector activations[], batch_vector & is_empty)
+        {
+            const batch_vector zero = batch_set(0.0);
+            batch_vector sum_of_degrees = zero;
+            for(int i = 0; i < rule_count; i++)
+            {
+                sum_of_degrees = batch_add(sum_of_degrees, degrees[i]);
+            }
+
+            batch_vector is_activated = batch_eq(zero, batch_set(1.0));
+            for(int i = 0; i < rule_count; i++)
+            {
+                const batch_vector degree = batch_div(degrees[i], sum_of_degrees);
+                const batch_vector fires = batch_is_gt(degree, zero);
+                activations[i] = batch_select(fires, degree, zero);
+                is_activated = batch_or(is_activated, fires);
+            }
+            is_empty = batch_eq(is_activated, zero);
+        }
+    };
+
+
+    /* state of an output in all lanes ( as output_state ) */
+    typedef struct batch_output_state_struct
+    {
+
+        batch_vector value;
+        batch_vector previous_value;
+        // mask of lanes where no term was activated in last process
+        batch_vector is_empty;
+
+    } batch_output_state;
+
+
+    /**
+     * integrals of product of memberships of the given terms over the range
+     * of the output - area and moment ( x times the product ). Terms are
+     * lines between their vertices, so the product is a polynomial of degree
+     * of number of terms, which Gauss-Legendre quadrature integrates exactly.
+     **/
+    template<typename Output>
+    void integrate_terms(const int terms[], const int term_count, scalar & area, scalar & moment)
+    {
+        scalar points[2 + 4 * FUZZY_MAX_BATCH_RULES];
+        int point_count = 0;
+        points[point_count++] = Output::min_value;
+        points[point_count++] = Output::max_value;
+        for(int j = 0; j < term_count; j++)
+        {
+            const term t = Output::get_term(terms[j]);
+            const scalar vertices[4] = {t.a, t.b, t.c, t.d};
+            const int vertex_count = (t.shape == TRAPEZOID) ? 4 : 2;
+            for(int v = 0; v < vertex_count; v++)
+            {
+                if(vertices[v] > Output::min_value && vertices[v] < Output::max_value)
+                {
+                    points[point_count++] = vertices[v];
+                }
+            }
+        }
+        std::sort(points, points + point_count);
+
+        const int gauss_points = std::min((term_count + 3) / 2, FUZZY_MAX_GAUSS_POINTS);
+        const scalar * nodes = GAUSS_NODES[gauss_points - 1];
+        const scalar * weights = GAUSS_WEIGHTS[gauss_points - 1];
+
+        area = 0.0;
+        moment = 0.0;
+        for(int i = 0; i + 1 < point_count; i++)
+        {
+            const scalar start = points[i];
+            const scalar length = points[i + 1] - start;
+            if(!(length > 0.0))
+            {
+                continue;
+            }
+
+            // lines of terms from membership at 1/4 and 3/4 of the piece
+            scalar line_starts[FUZZY_MAX_BATCH_RULES];
+            scalar line_slopes[FUZZY_MAX_BATCH_RULES];
+            for(int j = 0; j < term_count; j++)
+            {
+                const term t = Output::get_term(terms[j]);
+                const scalar first = get_membership(t, start + 0.25 * length);
+                const scalar second = get_membership(t, start + 0.75 * length);
+                line_starts[j] = first - 0.5 * (second - first);
+                line_slopes[j] = 2.0 * (second - first);
+            }
+
+            for(int p = 0; p < gauss_points; p++)
+            {
+                const scalar fraction = 0.5 + 0.5 * nodes[p];
+                scalar product = 1.0;
+                for(int j = 0; j < term_count; j++)
+                {
+                    product *= line_starts[j] + fraction * line_slopes[j];
+                }
+
+                const scalar x = start + fraction * length;
+                area += weights[p] * 0.5 * length * product;
+                moment += weights[p] * 0.5 * length * product * x;
+            }
+        }
+    }
+
+
+    /** rule blocks for all lanes **/
+    template<typename Block>
+    struct batch_rule_block;
+
+    template<typename Output, typename Conjunction, typename Disjunction,
+        typename Implication, typename Activation, typename... Rules>
+    struct batch_rule_block<rule_block<Output, Conjunction, Disjunction, Implication,
+        Activation, Rules...> >
+    {
+        typedef rule_block<Output, Conjunction, Disjunction, Implication, Activation,
+                Rules...> block;
+
+        static const int rule_count = sizeof...(Rules);
+
+        // only one rule is activated by First, else terms are aggregated as products
+        static const bool has_one_activation = std::is_same<Activation, first>::value;
+
+        static_assert(std::is_same<typename Output::defuzzifier, exact_centroid>::value,
+                "batch engine defuzzifies with exact centroid");
+        static_assert(has_one_activation ||
+                (std::is_same<Implication, algebraic_product>::value &&
+                 std::is_same<typename Output::aggregation, algebraic_sum>::value &&
+                 rule_count <= FUZZY_MAX_BATCH_RULES),
+                "batch engine aggregates more than one activated rule only with"
+                " AlgebraicProduct implication and AlgebraicSum aggregation");
+
+        static const int set_count = has_one_activation ? rule_count : (1 << rule_count) - 1;
+
+
+        /**
+         * area and moment of product of terms of each set of rules ( bits of
+         * the set, from 1 ), or of each rule with First activation
+         **/
+        typedef struct set_integrals_struct
+        {
+
+            scalar areas[set_count + 1];
+            scalar moments[set_count + 1];
+
+        } set_integrals;
+
+        static const set_integrals & get_set_integrals()
+        {
+            static const set_integrals integrals = integrate_sets();
+            return integrals;
+        }
+
+        static set_integrals integrate_sets()
+        {
+            const int terms[] = {Rules::term...};
+
+            set_integrals integrals;
+            integrals.areas[0] = 0.0;
+            integrals.moments[0] = 0.0;
+            for(int set = 1; set <= set_count; set++)
+            {
+                int set_terms[FUZZY_MAX_BATCH_RULES];
+                int term_count = 0;
+                if(has_one_activation)
+                {
+                    set_terms[term_count++] = terms[set - 1];
+                }
+                else
+                {
+                    for(int i = 0; i < rule_count; i++)
+                    {
+                        if(set & (1 << i))
+                        {
+                            set_terms[term_count++] = terms[i];
+                        }
+                    }
+                }
+                integrate_terms<Output>(set_terms, term_count, integrals.areas[set],
+                        integrals.moments[set]);
+            }
+
+            return integrals;
+        }
+
+
+        /* activates rules for inputs of all lanes and defuzzifies states of the output */
+        static void process(const batch_vector inputs[], batch_output_state states[])
+        {
+            const batch_vector degrees[rule_count] =
+                {batch_antecedent<typename Rules::antecedent>::template get_degree<block>(inputs)...};
+
+            batch_vector activations[rule_count];
+            batch_vector is_empty;
+            batch_activation<Activation>::activate(degrees, rule_count, activations, is_empty);
+
+            // area and moment of aggregated membership
+            const set_integrals & integrals = get_set_integrals();
+            batch_vector area = batch_set(0.0);
+            batch_vector moment = batch_set(0.0);
+            if(has_one_activation)
+            {
+                for(int i = 0; i < rule_count; i++)
+                {
+                    area = batch_add(area, batch_mul(activations[i],
+                                batch_set(integrals.areas[i + 1])));
+                    moment = batch_add(moment, batch_mul(activations[i],
+                                batch_set(integrals.moments[i + 1])));
+                }
+            }
+            else
+            {
+                // products of ( - a ) of each set, from products of smaller sets
+                batch_vector products[set_count + 1];
+                products[0] = batch_set(1.0);
+                for(int set = 1; set <= set_count; set++)
+                {
+                    int lowest = 0;
+                    while(!(set & (1 << lowest)))
+                    {
+                        lowest++;
+                    }
+                    products[set] = batch_mul(products[set & (set - 1)],
+                            batch_sub(batch_set(0.0), activations[lowest]));
+
+                    area = batch_sub(area, batch_mul(products[set],
+                                batch_set(integrals.areas[set])));
+                    moment = batch_sub(moment, batch_mul(products[set],
+                                batch_set(integrals.moments[set])));
+                }
+            }
+
+            // same as rule_block::process for each lane
+            batch_output_state & state = states[Output::index];
+            const batch_vector is_finite = batch_lt(batch_abs(state.value),
+                    batch_set(std::numeric_limits<scalar>::infinity()));
+            state.previous_value = batch_select(is_finite, state.value, state.previous_value);
+
+            batch_vector empty_value = batch_set(Output::default_value);
+            if(Output::lock_previous_value)
+            {
+                empty_value = batch_select(batch_nan(state.previous_value), empty_value,
+                        state.previous_value);
+            }
+
+            state.is_empty = is_empty;
+            state.value = batch_select(is_empty, empty_value, batch_div(moment, area));
+        }
+    };
+
+
+    /** rule blocks of an engine for all lanes **/
+    template<typename Engine>
+    struct batch_engine;
+
+    template<typename... Blocks>
+    struct batch_engine<engine<Blocks...> >
+    {
+        /* sets states of all outputs in all lanes for their inputs */
+        static void process(const batch_vector inputs[], batch_output_state states[])
+        {
+            // rule blocks in order ( braced lists are evaluated in order )
+            const int order[] = {0, (batch_rule_block<Blocks>::process(inputs, states), 0)...};
+            (void) order;
+        }
+    };
+
+}
+
+#endif      /** ifndef FUZZY_BATCH_ENGINE_H_ **/
+
@@ -0,0 +1,308 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * fuzzy_controller.cpp
+ *
+ *     version  : 1.0.0
+ *  created on  : 18 Feb 2018
+ *      author  : M.S.Khan
+ */
+
+
+#include<cmath>
+#include<cstring>
+#include<iostream>
+
+#include "fuzzy_controller.h"
+
+
+// outputs of the engine are in the same order as outputs of fuzzy table
+static_assert(controller_fuzzy::STEER_OUTPUT == FUZZY_TABLE_STEER &&
+        controller_fuzzy::ACCEL_OUTPUT == FUZZY_TABLE_ACCEL &&
+        controller_fuzzy::GEAR_OUTPUT == FUZZY_TABLE_GEAR &&
+        controller_fuzzy::BRAKE_OUTPUT == FUZZY_TABLE_BRAKE &&
+        controller_fuzzy::OUTPUT_COUNT == FUZZY_TABLE_OUTPUTS,
+        "outputs of fuzzy engine and fuzzy table are not in the same order");
+
+// bits of output mask are bits of engine outputs
+static_assert(FUZZY_OUTPUT_STEER == (1 << controller_fuzzy::STEER_OUTPUT) &&
+        FUZZY_OUTPUT_ACCEL == (1 << controller_fuzzy::ACCEL_OUTPUT) &&
+        FUZZY_OUTPUT_GEAR == (1 << controller_fuzzy::GEAR_OUTPUT) &&
+        FUZZY_OUTPUT_BRAKE == (1 << controller_fuzzy::BRAKE_OUTPUT),
+        "bits of fuzzy output mask are not bits of fuzzy engine outputs");
+
+// tables are made for versions of fuzzy parameters
+static_assert(FUZZY_PARAMETERS_VERSION_SIZE <= FUZZY_TABLE_VERSION_SIZE,
+        "version of fuzzy parameters doesn't fit in fuzzy table");
+
+// rules of the controller with its defuzzifier
+#if USE_EXACT_CENTROID
+typedef controller_fuzzy::exact_centroid controller_defuzzifier;
+#else
+typedef controller_fuzzy::centroid<100> controller_defuzzifier;
+#endif
+typedef controller_fuzzy::fuzzy_rules<controller_defuzzifier> controller_rules;
+
+// same rules with terms of fuzzy parameters
+typedef controller_fuzzy::fuzzy_rules<controller_defuzzifier, controller_fuzzy::parameter_terms>
+    parameter_rules;
+
+
+controller::FuzzyController::FuzzyController()
+{
+    m_fuzzy_outputs = {0, 0, 0, 1};    // initialize steer, accel, gear and brake values
+    m_fuzzy_gear = NAN;                // engine starts without previous gear
+    m_speed_at_gear_change = 0;
+    m_pending_gear_terms.count = 0;
+    m_is_using_parameters = 0;
+    strcpy(m_version, FUZZY_CONTROLLER_VERSION);
+
+    // outputs start without values, as in a new fuzzylite engine
+    for(int i = 0; i < controller_fuzzy::OUTPUT_COUNT; i++)
+    {
+        controller_fuzzy::reset_output_state(m_output_states[i]);
+    }
+
+    // display version information with status ( rules are compiled in, so
+    // the engine is always ready )
+    std::cout<<"Fuzzy Controller v"<<FUZZY_CONTROLLER_VERSION<<" - "
+        <<"Loaded successfully."<<std::endl;
+}
+
+
+const controller::fuzzy_outputs & controller::FuzzyController::get_output(
+        const fuzzy_inputs * t_fuzzy_inputs, const int output_mask)
+{
+    /**
+     * Modify gear value
+     * -----------------
+     * For discouraging frequent gear change only make suggested gear change when either :
+     *
+     * 1. The difference of current speed and speed at previous gear change
+     *    is large enough (defined by MIN_ABS_SPEED_DIFF_FOR_GEAR_CHANGE).
+     *
+     * 2. The suggested gear is a small value (defined by LOW_GEAR_FOR_FREE_GEAR_CHANGES).
+     *
+     * This doesn't depend on the suggested gear, so it is checked first and
+     * gear is only defuzzified when it is applied.
+     */
+    const int is_gear_applied = (output_mask & FUZZY_OUTPUT_GEAR) &&
+        (std::fabs(t_fuzzy_inputs->speed - m_speed_at_gear_change)
+         >= MIN_ABS_SPEED_DIFF_FOR_GEAR_CHANGE
+         || m_fuzzy_outputs.gear <= LOW_GEAR_FOR_FREE_GEAR_CHANGES);
+
+    // outputs from fuzzy table if the inputs are in one of its exact cells
+    float values[FUZZY_TABLE_OUTPUTS];
+    if(m_fuzzy_table.get_values(t_fuzzy_inputs->path, t_fuzzy_inputs->speed, values) == 0)
+    {
+        // gear of the table replaces pending gear
+        if(output_mask & FUZZY_OUTPUT_GEAR)
+        {
+            m_pending_gear_terms.count = 0;
+        }
+    }
+    else
+    {
+        process_engine(t_fuzzy_inputs, output_mask, is_gear_applied, values);
+    }
+
+    // copy the calculated outputs
+    if(output_mask & FUZZY_OUTPUT_STEER)
+    {
+        m_fuzzy_outputs.steer = values[FUZZY_TABLE_STEER];
+    }
+    if(output_mask & FUZZY_OUTPUT_ACCEL)
+    {
+        m_fuzzy_outputs.accel = values[FUZZY_TABLE_ACCEL];
+    }
+    if(output_mask & FUZZY_OUTPUT_BRAKE)
+    {
+        m_fuzzy_outputs.brake = values[FUZZY_TABLE_BRAKE];
+    }
+    if(output_mask & FUZZY_OUTPUT_GEAR)
+    {
+        m_fuzzy_gear = values[FUZZY_TABLE_GEAR];
+    }
+
+    if(is_gear_applied)
+    {
+        // use std::ceil for normal gears and std::floor for reverse gear
+        m_fuzzy_outputs.gear = m_fuzzy_gear > 0 ?
+            std::ceil(m_fuzzy_gear) : std::floor(m_fuzzy_gear);
+
+        // record this speed for later comparison
+        m_speed_at_gear_change = t_fuzzy_inputs->speed;
+    }
+
+    return m_fuzzy_outputs;
+}
+
+
+int controller::FuzzyController::use_parameters(const char * file_name)
+{
+    controller_fuzzy::fuzzy_parameters parameters;
+    if(controller_fuzzy::read_parameters(file_name, parameters) != 0)
+    {
+        std::cout<<"Fuzzy Controller - using compiled fuzzy terms"<<std::endl;
+        return -1;
+    }
+
+    // a table loaded before is for compiled terms
+    m_fuzzy_table.clear();
+
+    controller_fuzzy::use_parameters(parameters);
+    m_is_using_parameters = 1;
+    strcpy(m_version, parameters.version);
+
+    std::cout<<"Fuzzy Controller - using fuzzy parameters '"<<file_name<<"' ( v"
+        <<m_version<<" )"<<std::endl;
+
+    return 0;
+}
+
+
+int controller::FuzzyController::use_table(const char * file_name)
+{
+    if(m_fuzzy_table.load_from_file(file_name, m_version) != 0)
+    {
+        std::cout<<"Fuzzy Controller - using fuzzy engine for all inputs"<<std::endl;
+        return -1;
+    }
+
+    const fuzzy_table_header & header = m_fuzzy_table.get_header();
+    std::cout<<"Fuzzy Controller - using fuzzy table '"<<file_name<<"' ( "
+        <<header.path_axis.points<<" x "<<header.speed_axis.points<<" points, "
+        <<m_fuzzy_table.get_exact_cell_count()<<" exact cells )"<<std::endl;
+
+    return 0;
+}
+
+
+const char * controller::FuzzyController::get_version() const
+{
+    return m_version;
+}
+
+
+void controller::FuzzyController::get_engine_values(const fuzzy_inputs * t_fuzzy_inputs,
+        float values[FUZZY_TABLE_OUTPUTS])
+{
+    process_engine(t_fuzzy_inputs, FUZZY_ALL_OUTPUTS, 1, values);
+
+    if(m_output_states[controller_fuzzy::GEAR_OUTPUT].is_empty)
+    {
+        values[FUZZY_TABLE_GEAR] = NAN;
+    }
+}
+
+
+void controller::FuzzyController::process_engine(const fuzzy_inputs * t_fuzzy_inputs,
+        const int output_mask, const int is_gear_applied, float values[FUZZY_TABLE_OUTPUTS])
+{
+    if(m_is_using_parameters)
+    {
+        process_rules<parameter_rules>(t_fuzzy_inputs, output_mask, is_gear_applied, values);
+    }
+    else
+    {
+        process_rules<controller_rules>(t_fuzzy_inputs, output_mask, is_gear_applied, values);
+    }
+}
+
+
+template<typename Rules>
+void controller::FuzzyController::process_rules(const fuzzy_inputs * t_fuzzy_inputs,
+        const int output_mask, const int is_gear_applied, float values[FUZZY_TABLE_OUTPUTS])
+{
+    typedef typename Rules::gear_rule_block gear_rule_block;
+
+    // apply fuzzy inputs
+    controller_fuzzy::scalar inputs[controller_fuzzy::INPUT_COUNT];
+    inputs[controller_fuzzy::SPEED_INPUT] = t_fuzzy_inputs->speed;
+    inputs[controller_fuzzy::ACCELERATION_INPUT] = t_fuzzy_inputs->acceleration;
+    inputs[controller_fuzzy::PATH_INPUT] = t_fuzzy_inputs->path;
+    inputs[controller_fuzzy::NEXT_PATH_INPUT] = t_fuzzy_inputs->next_path;
+    inputs[controller_fuzzy::STABILITY_INPUT] = t_fuzzy_inputs->stability;
+
+    // process the input for outputs other than gear
+    Rules::rule_base::process(inputs, m_output_states, output_mask & ~FUZZY_OUTPUT_GEAR);
+
+    // gear is locked to previous value when no gear rule fires, which may
+    // have come from fuzzy table instead of the engine
+    controller_fuzzy::output_state & gear_state = m_output_states[controller_fuzzy::GEAR_OUTPUT];
+    gear_state.value = m_fuzzy_gear;
+
+    if(output_mask & FUZZY_OUTPUT_GEAR)
+    {
+        controller_fuzzy::activated_terms activated;
+        gear_rule_block::activate(inputs, activated);
+
+        if(activated.count > 0 && is_gear_applied)
+        {
+            // gear of these inputs doesn't depend on earlier inputs
+            m_pending_gear_terms.count = 0;
+            gear_rule_block::set_output(activated, m_output_states);
+        }
+        else if(activated.count > 0)
+        {
+            // gear that is not applied is defuzzified later, if it is locked by
+            // inputs without gear rules before a gear is applied
+            m_pending_gear_terms = activated;
+        }
+        else if(is_gear_applied || m_pending_gear_terms.count == 0)
+        {
+            // previous gear is locked ( it is same for pending gear until it is applied )
+            apply_pending_gear<Rules>();
+            gear_rule_block::set_output(activated, m_output_states);
+        }
+    }
+
+    for(int i = 0; i < controller_fuzzy::OUTPUT_COUNT; i++)
+    {
+        values[i] = m_output_states[i].value;
+    }
+}
+
+
+template<typename Rules>
+void controller::FuzzyController::apply_pending_gear()
+{
+    typedef typename Rules::gear_rule_block gear_rule_block;
+
+    if(m_pending_gear_terms.count == 0)
+    {
+        return;
+    }
+
+    controller_fuzzy::output_state & gear_state = m_output_states[controller_fuzzy::GEAR_OUTPUT];
+    gear_state.value = m_fuzzy_gear;
+    gear_rule_block::set_output(m_pending_gear_terms, m_output_states);
+
+    // gear value is kept as float between inputs
+    m_fuzzy_gear = gear_state.value;
+    gear_state.value = m_fuzzy_gear;
+    m_pending_gear_terms.count = 0;
+}
+
+
+controller::FuzzyController::~FuzzyController()
+{
+}
+
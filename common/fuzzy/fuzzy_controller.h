@@ -0,0 +1,194 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * fuzzy_controller.h
+ *
+ *     version  : 1.0.0
+ *  created on  : 18 Feb 2018
+ *      author  : M.S.Khan
+ */
+
+
+#ifndef FUZZY_CONTROLLER_H_
+#define FUZZY_CONTROLLER_H_
+
+#include "fuzzy_rule_base.h"
+#include "fuzzy_parameters.h"
+#include "fuzzy_table.h"
+
+
+// Defuzzify outputs with exact centroid ( 1 ) or with Centroid of 100 samples
+// as fuzzylite did ( 0 ). Rules are same, but outputs differ a little, so it is
+// a new controller version and Q values trained with one don't fit the other.
+// Exact centroid is opt-in ( -DUSE_EXACT_CENTROID=1 ).
+#ifndef USE_EXACT_CENTROID
+#define USE_EXACT_CENTROID 0
+#endif
+
+// Fuzzy controller version - 1.1.0 ( exact centroid ) or 1.0.0
+#if USE_EXACT_CENTROID
+#define FUZZY_CONTROLLER_VERSION "1.1.0"
+#else
+#define FUZZY_CONTROLLER_VERSION "1.0.0"
+#endif
+
+
+// Outputs of the controller as bits of an output mask ( get_output only
+// runs rule blocks of outputs in its mask )
+#define FUZZY_OUTPUT_STEER           0x1
+#define FUZZY_OUTPUT_ACCEL           0x2
+#define FUZZY_OUTPUT_GEAR            0x4
+#define FUZZY_OUTPUT_BRAKE           0x8
+#define FUZZY_ALL_OUTPUTS            0xF
+
+// Threshold for discouraging frequent gear changes
+#define MIN_ABS_SPEED_DIFF_FOR_GEAR_CHANGE 5
+// Rule does not apply for lower gears
+#define LOW_GEAR_FOR_FREE_GEAR_CHANGES 2
+
+namespace controller
+{
+
+    /** fuzzy controller input variables **/
+    typedef struct fuzzy_input_struct
+    {
+
+        float speed;
+        float acceleration;
+        float path;
+        float next_path;
+        float stability;
+
+    } fuzzy_inputs;
+
+
+    /** fuzzy controller output variables **/
+    typedef struct fuzzy_output_struct
+    {
+
+        float steer;
+        float accel;
+        int gear;
+        float brake;
+
+    } fuzzy_outputs;
+
+
+    /*
+     * =====================================================================================
+     *        Class:  FuzzyController
+     *  Description:  This class has a fuzzy engine which accepts fuzzy_input_struct,
+     *                fuzzifies the input values, applies rules to them,
+     *                gets fuzzy outputs, defuzzifies them and then returns
+     *                the defuzzified outputs. Rules are those of fuzzy_rule_base.h,
+     *                processed by the engine of fuzzy_engine.h.
+     * =====================================================================================
+     */
+    class FuzzyController
+    {
+        public:
+
+            FuzzyController();
+            ~FuzzyController();
+
+            // get fuzzy outputs for the given set of fuzzy inputs. Only outputs of the
+            // mask ( FUZZY_OUTPUT_* ) are found, others keep their last values. Gear
+            // and its hysteresis are only kept up to date by calls with gear in the mask.
+            const fuzzy_outputs & get_output(const fuzzy_inputs * m_fuzzy_inputs,
+                    const int output_mask = FUZZY_ALL_OUTPUTS);
+
+            // use terms of a fuzzy parameter file ( see fuzzy_parameters.h ) instead of
+            // compiled terms. Version of the controller is then version of the parameter
+            // set, so call it before use_table. Terms are used by all fuzzy controllers
+            // of the process that use parameters. Returns 0 on success and -1 if the file
+            // is not loaded ( compiled terms are then used ).
+            int use_parameters(const char * file_name);
+
+            // use outputs of a fuzzy table ( see fuzzy_table.h ) for inputs within its
+            // exact cells and run the engine only for other inputs. Returns 0 on success
+            // and -1 if the table is not loaded ( engine is then used for all inputs ).
+            int use_table(const char * file_name);
+
+            // returns FUZZY_CONTROLLER_VERSION, or version of fuzzy parameters in use
+            const char * get_version() const;
+
+            // run fuzzy engine for the given inputs and get its outputs in order of
+            // fuzzy table outputs ( gear before it is rounded ). Gear is NaN when no
+            // gear rule fires ( get_output keeps previous gear for such inputs ).
+            void get_engine_values(const fuzzy_inputs * t_fuzzy_inputs,
+                    float values[FUZZY_TABLE_OUTPUTS]);
+
+
+        private:
+
+            /** MEMBER VARIABLES **/
+
+            // states of fuzzy engine outputs ( in order of controller_fuzzy::output_index )
+            controller_fuzzy::output_state m_output_states[controller_fuzzy::OUTPUT_COUNT];
+            // fuzzy output values
+            fuzzy_outputs m_fuzzy_outputs; 
+            // gear output of last inputs ( before it is rounded )
+            float m_fuzzy_gear;
+
+            // outputs of fuzzy engine sampled on a grid ( empty if not used )
+            FuzzyTable m_fuzzy_table;
+
+            // non-zero if terms of fuzzy parameters are used, and version of the controller
+            int m_is_using_parameters;
+            char m_version[FUZZY_PARAMETERS_VERSION_SIZE];
+
+            // recorded speed at last gear change
+            float m_speed_at_gear_change;
+
+            // gear terms activated by inputs for which gear was not applied ( count is
+            // 0 if none ). They are defuzzified only if a later gear needs them.
+            controller_fuzzy::activated_terms m_pending_gear_terms;
+
+
+            /** MEMBER FUNCTIONS **/
+
+            // run fuzzy engine for outputs of the mask and copy them in order of fuzzy
+            // table outputs. Gear output is only defuzzified if "is_gear_applied" is
+            // non-zero ( else gear value is still the last one ).
+            void process_engine(const fuzzy_inputs * t_fuzzy_inputs, const int output_mask,
+                    const int is_gear_applied, float values[FUZZY_TABLE_OUTPUTS]);
+
+            // process_engine with the given rules ( compiled terms or fuzzy parameters )
+            template<typename Rules>
+            void process_rules(const fuzzy_inputs * t_fuzzy_inputs, const int output_mask,
+                    const int is_gear_applied, float values[FUZZY_TABLE_OUTPUTS]);
+
+            // defuzzifies pending gear terms ( if any ) into gear value
+            template<typename Rules>
+            void apply_pending_gear();
+
+            // copy constructor
+            FuzzyController(const FuzzyController &other);
+
+            // assignment operator
+            FuzzyController& operator=(const FuzzyController &other);
+
+    };       /** class FuzzyController **/
+
+}
+
+#endif      /** ifndef FUZZY_CONTROLLER_H_ **/
+
+
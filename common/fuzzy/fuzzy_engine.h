@@ -0,0 +1,830 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * fuzzy_engine.h
+ *
+ * Fuzzy inference engine without fuzzylite. Terms ( Trapezoid, Ramp and
+ * Rectangle ), norms ( Minimum, Maximum, AlgebraicProduct and AlgebraicSum ),
+ * activations ( First and Proportional ) and Centroid defuzzifier work the same
+ * way as in fuzzylite v6.0, with the same double precision values and the
+ * same order of operations, so outputs are same as outputs of fuzzylite.
+ *
+ * A rule base is fixed at compile time. Terms are constexpr data, and inputs,
+ * outputs, rules and rule blocks are types, so that the compiler sees the
+ * whole rule base ( no name lookups, virtual calls or heap allocations while
+ * it is processed ). See fuzzy_rule_base.h for rules of fuzzy controller.
+ *
+ *  e.g. rule "if (path is too_left or path is too_right) and speed is fast
+ *  then accel is slow" is
+ *
+ *      rule<fuzzy_and<fuzzy_or<is<path, PATH_TOO_LEFT>, is<path, PATH_TOO_RIGHT>>,
+ *                     is<speed, SPEED_FAST>>, ACCEL_SLOW>
+ *
+ * Work that can't change outputs is left out - an output mask selects rule
+ * blocks to process, First activation stops at the first rule that fires,
+ * and "and" of a rule with First activation is not evaluated further once
+ * one side can't fire ( e.g. speed is not fuzzified for the rule above when
+ * path is not too wide ).
+ *
+ *     version  : 1.0.0
+ *  created on  : 17 Oct 2026
+ *      author  : M.S.Khan
+ */
+
+
+#ifndef FUZZY_ENGINE_H_
+#define FUZZY_ENGINE_H_
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+
+// most rules of a rule block
+#define FUZZY_MAX_BLOCK_RULES        16
+
+// most points of Gauss-Legendre quadrature of exact centroid
+#define FUZZY_MAX_GAUSS_POINTS       5
+
+
+namespace controller_fuzzy
+{
+
+    // values of the engine ( same as fl::scalar )
+    typedef double scalar;
+
+    // tolerance of comparisons ( same as fl::fuzzylite::macheps )
+    constexpr scalar MACHEPS = 1e-6;
+
+
+    /** comparisons of values ( same as fl::Op ) **/
+    inline bool is_nan(const scalar a)
+    {
+        return a != a;
+    }
+
+    inline bool is_eq(const scalar a, const scalar b)
+    {
+        return a == b || std::fabs(a - b) < MACHEPS || (is_nan(a) && is_nan(b));
+    }
+
+    inline bool is_lt(const scalar a, const scalar b)
+    {
+        return !is_eq(a, b) && a < b;
+    }
+
+    inline bool is_le(const scalar a, const scalar b)
+    {
+        return is_eq(a, b) || a < b;
+    }
+
+    inline bool is_gt(const scalar a, const scalar b)
+    {
+        return !is_eq(a, b) && a > b;
+    }
+
+    inline bool is_ge(const scalar a, const scalar b)
+    {
+        return is_eq(a, b) || a > b;
+    }
+
+    // minimum and maximum ignore NaN
+    inline scalar min_of(const scalar a, const scalar b)
+    {
+        return is_nan(a) ? b : (is_nan(b) ? a : (a < b ? a : b));
+    }
+
+    inline scalar max_of(const scalar a, const scalar b)
+    {
+        return is_nan(a) ? b : (is_nan(b) ? a : (a > b ? a : b));
+    }
+
+    // non-zero if a rule of the degree activates its term ( as fl::First )
+    inline bool is_firing(const scalar degree)
+    {
+        return is_gt(degree, 0.0) && is_ge(degree, 0.0);
+    }
+
+
+    /** shapes of terms **/
+    enum term_shape
+    {
+        TRAPEZOID,
+        RAMP,
+        RECTANGLE
+    };
+
+
+    /**
+     * a term of a variable. Trapezoid has vertices a, b, c and d, while ramp
+     * and rectangle are from "a" ( start ) to "b" ( end ).
+     **/
+    typedef struct term_struct
+    {
+
+        term_shape shape;
+        scalar a;
+        scalar b;
+        scalar c;
+        scalar d;
+
+    } term;
+
+
+    constexpr term trapezoid(const scalar a, const scalar b, const scalar c, const scalar d)
+    {
+        return term{TRAPEZOID, a, b, c, d};
+    }
+
+    constexpr term ramp(const scalar start, const scalar end)
+    {
+        return term{RAMP, start, end, 0, 0};
+    }
+
+    constexpr term rectangle(const scalar start, const scalar end)
+    {
+        return term{RECTANGLE, start, end, 0, 0};
+    }
+
+
+    /* membership of a value in a term ( heights of terms are 1 ) */
+    inline scalar get_membership(const term & t, const scalar x)
+    {
+        if(is_nan(x))
+        {
+            return x;
+        }
+
+        const scalar infinity = std::numeric_limits<scalar>::infinity();
+        switch(t.shape)
+        {
+            case TRAPEZOID :
+                if(is_lt(x, t.a) || is_gt(x, t.d))
+                {
+                    return 0.0;
+                }
+                if(is_lt(x, t.b))
+                {
+                    return (t.a == -infinity) ? 1.0 : min_of(1.0, (x - t.a) / (t.b - t.a));
+                }
+                if(is_le(x, t.c))
+                {
+                    return 1.0;
+                }
+                if(is_lt(x, t.d))
+                {
+                    return (t.d == infinity) ? 1.0 : (t.d - x) / (t.d - t.c);
+                }
+                return (t.d == infinity) ? 1.0 : 0.0;
+
+            case RAMP :
+                if(is_eq(t.a, t.b))
+                {
+                    return 0.0;
+                }
+                if(is_lt(t.a, t.b))
+                {
+                    if(is_le(x, t.a))
+                    {
+                        return 0.0;
+                    }
+                    return is_ge(x, t.b) ? 1.0 : (x - t.a) / (t.b - t.a);
+                }
+                if(is_ge(x, t.a))
+                {
+                    return 0.0;
+                }
+                return is_le(x, t.b) ? 1.0 : (t.a - x) / (t.a - t.b);
+
+            case RECTANGLE :
+                return (is_ge(x, t.a) && is_le(x, t.b)) ? 1.0 : 0.0;
+        }
+
+        return 0.0;
+    }
+
+
+    /**
+     * norms ( "has_kinks" is true for norms that are not smooth where their
+     * arguments cross, so exact centroid splits pieces at those points )
+     **/
+    struct minimum
+    {
+        static const bool has_kinks = true;
+
+        static scalar compute(const scalar a, const scalar b)
+        {
+            return min_of(a, b);
+        }
+    };
+
+    struct maximum
+    {
+        static const bool has_kinks = true;
+
+        static scalar compute(const scalar a, const scalar b)
+        {
+            return max_of(a, b);
+        }
+    };
+
+    struct algebraic_product
+    {
+        static const bool has_kinks = false;
+
+        static scalar compute(const scalar a, const scalar b)
+        {
+            return a * b;
+        }
+    };
+
+    struct algebraic_sum
+    {
+        static const bool has_kinks = false;
+
+        static scalar compute(const scalar a, const scalar b)
+        {
+            return a + b - (a * b);
+        }
+    };
+
+
+    /**
+     * terms of an output that rules of a rule block activated, with their
+     * activation degrees ( fl::Aggregated )
+     **/
+    typedef struct activated_terms_struct
+    {
+
+        int count;
+        int terms[FUZZY_MAX_BLOCK_RULES];
+        scalar degrees[FUZZY_MAX_BLOCK_RULES];
+
+    } activated_terms;
+
+
+    /**
+     * value of an output and its value before last process ( outputs that
+     * lock previous value keep it when no rule activates their terms )
+     **/
+    typedef struct output_state_struct
+    {
+
+        scalar value;
+        scalar previous_value;
+        // non-zero if no term was activated in last process
+        int is_empty;
+
+    } output_state;
+
+
+    /**
+     * antecedents - degree of an antecedent, and its firing degree which is
+     * same when the antecedent fires, but may be left out ( as a degree that
+     * doesn't fire ) when it can't fire. Firing degree is only for whole
+     * antecedents of rules with First activation.
+     **/
+
+    // "<input> is <term>" - Input has index of the input and its terms
+    template<typename Input, int Term>
+    struct is
+    {
+        template<typename Block>
+        static scalar get_degree(const scalar inputs[])
+        {
+            return get_membership(Input::get_term(Term), inputs[Input::index]);
+        }
+
+        template<typename Block>
+        static scalar get_firing_degree(const scalar inputs[])
+        {
+            return get_degree<Block>(inputs);
+        }
+    };
+
+    // "<antecedent> and <antecedent>" ( conjunction of the rule block )
+    template<typename Left, typename Right>
+    struct fuzzy_and
+    {
+        template<typename Block>
+        static scalar get_degree(const scalar inputs[])
+        {
+            return Block::conjunction::compute(Left::template get_degree<Block>(inputs),
+                    Right::template get_degree<Block>(inputs));
+        }
+
+        /**
+         * conjunctions ( T-norms ) are not above either argument for memberships,
+         * so "and" can't fire if its left side doesn't fire ( unless it is NaN,
+         * which Minimum ignores ) and right side is not needed
+         **/
+        template<typename Block>
+        static scalar get_firing_degree(const scalar inputs[])
+        {
+            const scalar left = Left::template get_degree<Block>(inputs);
+            if(!is_nan(left) && !is_firing(left))
+            {
+                return left;
+            }
+
+            return Block::conjunction::compute(left, Right::template get_degree<Block>(inputs));
+        }
+    };
+
+    // "<antecedent> or <antecedent>" ( disjunction of the rule block )
+    template<typename Left, typename Right>
+    struct fuzzy_or
+    {
+        template<typename Block>
+        static scalar get_degree(const scalar inputs[])
+        {
+            return Block::disjunction::compute(Left::template get_degree<Block>(inputs),
+                    Right::template get_degree<Block>(inputs));
+        }
+
+        template<typename Block>
+        static scalar get_firing_degree(const scalar inputs[])
+        {
+            return get_degree<Block>(inputs);
+        }
+    };
+
+
+    /** "if <antecedent> then <output> is <term>" ( output of its rule block ) **/
+    template<typename Antecedent, int Term>
+    struct rule
+    {
+        typedef Antecedent antecedent;
+        static const int term = Term;
+    };
+
+
+    /** rules of a rule block as a list ( degrees and terms in order of rules ) **/
+    template<typename Block, typename... Rules>
+    struct rule_list;
+
+    template<typename Block>
+    struct rule_list<Block>
+    {
+        static void get_degrees(const scalar /* inputs */[], scalar /* degrees */[])
+        {
+        }
+
+        static void activate_first(const scalar /* inputs */[], activated_terms & /* activated */)
+        {
+        }
+    };
+
+    template<typename Block, typename Rule, typename... Rules>
+    struct rule_list<Block, Rule, Rules...>
+    {
+        static void get_degrees(const scalar inputs[], scalar degrees[])
+        {
+            degrees[0] = Rule::antecedent::template get_degree<Block>(inputs);
+            rule_list<Block, Rules...>::get_degrees(inputs, degrees + 1);
+        }
+
+        // activates term of the first rule that fires ( later rules are not evaluated )
+        static void activate_first(const scalar inputs[], activated_terms & activated)
+        {
+            const scalar degree = Rule::antecedent::template get_firing_degree<Block>(inputs);
+            if(is_firing(degree))
+            {
+                activated.terms[activated.count] = Rule::term;
+                activated.degrees[activated.count] = degree;
+                activated.count++;
+                return;
+            }
+            rule_list<Block, Rules...>::activate_first(inputs, activated);
+        }
+    };
+
+
+    /** activations ( of rules of a rule block for the inputs ) **/
+
+    // only first rule that fires activates its term
+    struct first
+    {
+        template<typename Block, typename... Rules>
+        static void activate(const scalar inputs[], activated_terms & activated)
+        {
+            rule_list<Block, Rules...>::activate_first(inputs, activated);
+        }
+    };
+
+    // all rules that fire activate their terms, with degrees divided by their sum
+    struct proportional
+    {
+        template<typename Block, typename... Rules>
+        static void activate(const scalar inputs[], activated_terms & activated)
+        {
+            const int rule_count = sizeof...(Rules);
+            const int terms[rule_count] = {Rules::term...};
+            scalar degrees[rule_count];
+            rule_list<Block, Rules...>::get_degrees(inputs, degrees);
+
+            scalar sum_of_degrees = 0.0;
+            for(int i = 0; i < rule_count; i++)
+            {
+                sum_of_degrees += degrees[i];
+            }
+
+            for(int i = 0; i < rule_count; i++)
+            {
+                const scalar degree = degrees[i] / sum_of_degrees;
+                if(is_gt(degree, 0.0))
+                {
+                    activated.terms[activated.count] = terms[i];
+                    activated.degrees[activated.count] = degree;
+                    activated.count++;
+                }
+            }
+        }
+    };
+
+
+    /** defuzzifiers **/
+
+    // centroid of membership at "Resolution" points from minimum to maximum
+    template<int Resolution>
+    struct centroid
+    {
+        template<typename Output, typename Implication>
+        static scalar defuzzify(const activated_terms & activated)
+        {
+            if(!std::isfinite(Output::min_value + Output::max_value))
+            {
+                return std::numeric_limits<scalar>::quiet_NaN();
+            }
+
+            const scalar dx = (Output::max_value - Output::min_value) / Resolution;
+            scalar area = 0;
+            scalar x_centroid = 0;
+            for(int i = 0; i < Resolution; ++i)
+            {
+                const scalar x = Output::min_value + (i + 0.5) * dx;
+
+                // aggregated membership of activated terms at x
+                scalar y = 0.0;
+                for(int j = 0; j < activated.count; j++)
+                {
+                    y = Output::aggregation::compute(y, Implication::compute(
+                                get_membership(Output::get_term(activated.terms[j]), x),
+                                activated.degrees[j]));
+                }
+
+                x_centroid += y * x;
+                area += y;
+            }
+
+            return x_centroid / area;
+        }
+    };
+
+
+    /**
+     * nodes ( from -1 to 1 ) and weights of Gauss-Legendre quadrature of 1 to
+     * FUZZY_MAX_GAUSS_POINTS points. N points integrate polynomials of degree
+     * up to 2N - 1 exactly.
+     **/
+    constexpr scalar GAUSS_NODES[FUZZY_MAX_GAUSS_POINTS][FUZZY_MAX_GAUSS_POINTS] =
+    {
+        {0.0},
+        {-0.5773502691896257645, 0.5773502691896257645},
+        {-0.7745966692414833770, 0.0, 0.7745966692414833770},
+        {-0.8611363115940525752, -0.3399810435848562648, 0.3399810435848562648,
+            0.8611363115940525752},
+        {-0.9061798459386639928, -0.5384693101056830910, 0.0, 0.5384693101056830910,
+            0.9061798459386639928}
+    };
+
+    constexpr scalar GAUSS_WEIGHTS[FUZZY_MAX_GAUSS_POINTS][FUZZY_MAX_GAUSS_POINTS] =
+    {
+        {2.0},
+        {1.0, 1.0},
+        {0.5555555555555555556, 0.8888888888888888889, 0.5555555555555555556},
+        {0.3478548451374538574, 0.6521451548625461427, 0.6521451548625461427,
+            0.3478548451374538574},
+        {0.2369268850561890875, 0.4786286704993664680, 0.5688888888888888889,
+            0.4786286704993664680, 0.2369268850561890875}
+    };
+
+
+    /**
+     * centroid of aggregated membership, integrated piece by piece instead of
+     * sampled ( Trapezoid, Ramp and Rectangle are linear between their vertices ).
+     *
+     * Output range is cut at vertices of activated terms, so membership of each
+     * term is a line within a piece, and implied membership is a line too ( or
+     * a line cut by its degree for Minimum ). Pieces are cut again where norms
+     * with kinks switch from one argument to the other, and then aggregated
+     * membership is a polynomial of degree up to number of terms in the piece
+     * ( a line for Maximum ), which Gauss-Legendre quadrature integrates exactly
+     * for up to 2 * FUZZY_MAX_GAUSS_POINTS - 2 overlapping terms ( with more,
+     * the piece is split and result is close but not exact ).
+     *
+     * Membership at a vertex itself ( e.g. a jump of Rectangle ) doesn't
+     * change the integral, while Centroid( Resolution ) depends on where its
+     * samples fall around it.
+     **/
+    struct exact_centroid
+    {
+        template<typename Output, typename Implication>
+        static scalar defuzzify(const activated_terms & activated)
+        {
+            if(!std::isfinite(Output::min_value + Output::max_value))
+            {
+                return std::numeric_limits<scalar>::quiet_NaN();
+            }
+
+            // ends of pieces - range of the output and vertices of terms within it
+            scalar points[2 + 4 * FUZZY_MAX_BLOCK_RULES];
+            int point_count = 0;
+            points[point_count++] = Output::min_value;
+            points[point_count++] = Output::max_value;
+            for(int j = 0; j < activated.count; j++)
+            {
+                const term t = Output::get_term(activated.terms[j]);
+                const scalar vertices[4] = {t.a, t.b, t.c, t.d};
+                const int vertex_count = (t.shape == TRAPEZOID) ? 4 : 2;
+                for(int v = 0; v < vertex_count; v++)
+                {
+                    if(vertices[v] > Output::min_value && vertices[v] < Output::max_value)
+                    {
+                        points[point_count++] = vertices[v];
+                    }
+                }
+            }
+            std::sort(points, points + point_count);
+
+            scalar area = 0.0;
+            scalar x_centroid = 0.0;
+            for(int i = 0; i + 1 < point_count; i++)
+            {
+                if(points[i + 1] > points[i])
+                {
+                    add_piece<Output, Implication>(activated, points[i], points[i + 1],
+                            area, x_centroid);
+                }
+            }
+
+            return x_centroid / area;
+        }
+
+
+        private:
+
+        /* a line within a piece, as its values at both ends of the piece */
+        typedef struct line_struct
+        {
+
+            scalar start;
+            scalar end;
+
+        } line;
+
+
+        /* adds point where two lines cross inside the piece ( if they do ) */
+        static void add_crossing(const line & a, const line & b, const scalar start,
+                const scalar length, scalar cuts[], int & cut_count)
+        {
+            const scalar start_difference = a.start - b.start;
+            const scalar end_difference = a.end - b.end;
+            if(start_difference * end_difference < 0.0)
+            {
+                cuts[cut_count++] = start + length * start_difference /
+                    (start_difference - end_difference);
+            }
+        }
+
+
+        /* adds area and moment of aggregated membership from "start" to "end" */
+        template<typename Output, typename Implication>
+        static void add_piece(const activated_terms & activated, const scalar start,
+                const scalar end, scalar & area, scalar & x_centroid)
+        {
+            typedef typename Output::aggregation aggregation;
+
+            /**
+             * lines of terms from membership at 1/4 and 3/4 of the piece ( away
+             * from jumps at its ends ). Terms without membership in the piece
+             * don't change the aggregation ( implication of 0 is 0, and 0 is the
+             * identity of aggregations ).
+             **/
+            const scalar length = end - start;
+            line lines[FUZZY_MAX_BLOCK_RULES];
+            scalar degrees[FUZZY_MAX_BLOCK_RULES];
+            int line_count = 0;
+            for(int j = 0; j < activated.count; j++)
+            {
+                const term t = Output::get_term(activated.terms[j]);
+                const scalar first = get_membership(t, start + 0.25 * length);
+                const scalar second = get_membership(t, start + 0.75 * length);
+                if(first == 0.0 && second == 0.0)
+                {
+                    continue;
+                }
+
+                lines[line_count].start = first - 0.5 * (second - first);
+                lines[line_count].end = second + 0.5 * (second - first);
+                degrees[line_count] = activated.degrees[j];
+                line_count++;
+            }
+            if(line_count == 0)
+            {
+                return;
+            }
+
+            // cuts where norms with kinks switch arguments
+            scalar cuts[2 + 2 * FUZZY_MAX_BLOCK_RULES * (2 * FUZZY_MAX_BLOCK_RULES - 1)];
+            int cut_count = 0;
+            cuts[cut_count++] = start;
+            cuts[cut_count++] = end;
+            if(Implication::has_kinks || aggregation::has_kinks)
+            {
+                // implied membership is made of these lines ( a term and its
+                // degree for Minimum, or the term scaled by its degree )
+                line forms[2 * FUZZY_MAX_BLOCK_RULES];
+                int form_count = 0;
+                for(int j = 0; j < line_count; j++)
+                {
+                    if(Implication::has_kinks)
+                    {
+                        forms[form_count++] = lines[j];
+                        forms[form_count++] = line{degrees[j], degrees[j]};
+                    }
+                    else
+                    {
+                        forms[form_count++] = line{Implication::compute(lines[j].start, degrees[j]),
+                            Implication::compute(lines[j].end, degrees[j])};
+                    }
+                }
+
+                for(int j = 0; j < form_count; j++)
+                {
+                    for(int k = j + 1; k < form_count; k++)
+                    {
+                        add_crossing(forms[j], forms[k], start, length, cuts, cut_count);
+                    }
+                }
+                std::sort(cuts, cuts + cut_count);
+            }
+
+            // degree of aggregated membership times x, and points that integrate it
+            const int degree = (aggregation::has_kinks ? 1 : line_count) + 1;
+            const int points = std::min((degree + 2) / 2, FUZZY_MAX_GAUSS_POINTS);
+            const int splits = (degree + 1 + 2 * FUZZY_MAX_GAUSS_POINTS - 1) /
+                (2 * FUZZY_MAX_GAUSS_POINTS);
+            const scalar * nodes = GAUSS_NODES[points - 1];
+            const scalar * weights = GAUSS_WEIGHTS[points - 1];
+
+            for(int c = 0; c + 1 < cut_count; c++)
+            {
+                const scalar split_length = (cuts[c + 1] - cuts[c]) / splits;
+                for(int s = 0; s < splits; s++)
+                {
+                    const scalar half_length = 0.5 * split_length;
+                    const scalar middle = cuts[c] + (s + 0.5) * split_length;
+                    for(int p = 0; p < points; p++)
+                    {
+                        const scalar x = middle + half_length * nodes[p];
+                        const scalar fraction = (x - start) / length;
+
+                        scalar y = 0.0;
+                        for(int j = 0; j < line_count; j++)
+                        {
+                            const scalar membership = lines[j].start +
+                                fraction * (lines[j].end - lines[j].start);
+                            y = aggregation::compute(y, Implication::compute(membership,
+                                        degrees[j]));
+                        }
+
+                        area += weights[p] * half_length * y;
+                        x_centroid += weights[p] * half_length * y * x;
+                    }
+                }
+            }
+        }
+    };
+
+
+    /**
+     * a rule block for an output ( fl::RuleBlock with all rules for the same
+     * output ). Output has its index, range, default value, terms, aggregation
+     * and defuzzifier, and whether it locks previous value.
+     **/
+    template<typename Output, typename Conjunction, typename Disjunction,
+        typename Implication, typename Activation, typename... Rules>
+    struct rule_block
+    {
+        typedef Conjunction conjunction;
+        typedef Disjunction disjunction;
+
+        static_assert(sizeof...(Rules) <= FUZZY_MAX_BLOCK_RULES, "too many rules in a block");
+
+        // bit of the output in output masks of engine
+        static const int output_mask = 1 << Output::index;
+
+        /* activates rules for the inputs */
+        static void activate(const scalar inputs[], activated_terms & activated)
+        {
+            activated.count = 0;
+            Activation::template activate<rule_block, Rules...>(inputs, activated);
+        }
+
+        /* defuzzifies state of the output for activated terms */
+        static void set_output(const activated_terms & activated, output_state states[])
+        {
+            output_state & state = states[Output::index];
+            if(std::isfinite(state.value))
+            {
+                state.previous_value = state.value;
+            }
+
+            state.is_empty = (activated.count == 0);
+            if(!state.is_empty)
+            {
+                state.value = Output::defuzzifier::template defuzzify<Output, Implication>(activated);
+            }
+            else if(Output::lock_previous_value && !is_nan(state.previous_value))
+            {
+                state.value = state.previous_value;
+            }
+            else
+            {
+                state.value = Output::default_value;
+            }
+        }
+
+        /* activates rules for the inputs and defuzzifies state of the output */
+        static void process(const scalar inputs[], output_state states[])
+        {
+            activated_terms activated;
+            activate(inputs, activated);
+            set_output(activated, states);
+        }
+    };
+
+
+    /**
+     * rule blocks of an engine ( one for each output ). Output mask has bit
+     * ( 1 << index ) of each output to process, and states of other outputs
+     * are not changed.
+     **/
+    template<typename... Blocks>
+    struct engine;
+
+    template<>
+    struct engine<>
+    {
+        static void process(const scalar /* inputs */[], output_state /* states */[],
+                const int /* output_mask */ = ~0)
+        {
+        }
+    };
+
+    template<typename Block, typename... Blocks>
+    struct engine<Block, Blocks...>
+    {
+        /* sets states of outputs of the mask ( all outputs by default ) for the inputs */
+        static void process(const scalar inputs[], output_state states[],
+                const int output_mask = ~0)
+        {
+            if(output_mask & Block::output_mask)
+            {
+                Block::process(inputs, states);
+            }
+            engine<Blocks...>::process(inputs, states, output_mask);
+        }
+    };
+
+
+    /* resets state of an output ( no value yet ) */
+    inline void reset_output_state(output_state & state)
+    {
+        state.value = std::numeric_limits<scalar>::quiet_NaN();
+        state.previous_value = std::numeric_limits<scalar>::quiet_NaN();
+        state.is_empty = 1;
+    }
+
+}
+
+#endif      /** ifndef FUZZY_ENGINE_H_ **/
+
@@ -0,0 +1,294 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * fuzzy_parameters.cpp
+ *
+ *     version  : 1.0.0
+ *  created on  : 17 Oct 2026
+ *      author  : M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "fuzzy_parameters.h"
+#include "fuzzy_values.h"
+
+
+// longest line of a parameter file
+#define PARAMETER_LINE_SIZE          256
+
+
+controller_fuzzy::fuzzy_parameters controller_fuzzy::parameters_in_use;
+
+
+namespace
+{
+    using controller_fuzzy::term;
+
+    /** names of a term in parameter files **/
+    typedef struct term_name_struct
+    {
+
+        const char * variable;
+        const char * term;
+
+    } term_name;
+
+
+    // names of terms, in order of variables and their terms
+    const term_name TERM_NAMES[] =
+    {
+        {"speed", VERY_VERY_SLOW}, {"speed", VERY_SLOW}, {"speed", SLOW},
+        {"speed", MEDIUM}, {"speed", FAST}, {"speed", VERY_FAST},
+        {"acceleration", NEGATIVE}, {"acceleration", VERY_SLOW}, {"acceleration", SLOW},
+        {"acceleration", MEDIUM}, {"acceleration", FAST}, {"acceleration", VERY_FAST},
+        {"path", TOO_LEFT}, {"path", LEFT}, {"path", STRAIGHT}, {"path", RIGHT},
+        {"path", TOO_RIGHT},
+        {"next_path", LEFT}, {"next_path", STRAIGHT}, {"next_path", RIGHT},
+        {"stability", STABLE}, {"stability", UNSTABLE},
+        {"steer", TOO_LEFT}, {"steer", LEFT}, {"steer", STRAIGHT}, {"steer", RIGHT},
+        {"steer", TOO_RIGHT},
+        {"accel", VERY_SLOW}, {"accel", SLOW}, {"accel", MEDIUM}, {"accel", FAST},
+        {"accel", VERY_FAST},
+        {"gear", REVERSE_GEAR}, {"gear", VERY_LOW_GEAR}, {"gear", LOW_GEAR},
+        {"gear", MEDIUM_GEAR}, {"gear", HIGH_GEAR}, {"gear", VERY_HIGH_GEAR},
+        {"brake", VERY_SLOW}, {"brake", SLOW}, {"brake", MEDIUM}, {"brake", FAST},
+        {"brake", VERY_FAST}
+    };
+
+    static_assert(sizeof(TERM_NAMES) / sizeof(TERM_NAMES[0]) == controller_fuzzy::TERM_COUNT,
+            "names of terms don't match terms of fuzzy rule base");
+
+
+    // names of shapes ( in order of controller_fuzzy::term_shape )
+    const char * SHAPE_NAMES[] = {"trapezoid", "ramp", "rectangle"};
+
+
+    /* returns number of vertices of a term */
+    int get_vertex_count(const term & t)
+    {
+        return (t.shape == controller_fuzzy::TRAPEZOID) ? 4 : 2;
+    }
+
+
+    /* copies terms of a variable to a parameter set */
+    template<int N>
+    void copy_terms(const term (&terms)[N], const int first_term,
+            controller_fuzzy::fuzzy_parameters & parameters)
+    {
+        for(int i = 0; i < N; i++)
+        {
+            parameters.terms[first_term + i] = terms[i];
+        }
+    }
+
+
+    /* reads next line that is not empty or a comment, returns 0 on success and -1 at end */
+    int read_line(FILE * file, char line[PARAMETER_LINE_SIZE], int & line_number)
+    {
+        while(fgets(line, PARAMETER_LINE_SIZE, file) != NULL)
+        {
+            line_number++;
+
+            const char * text = line + strspn(line, " \t\r\n");
+            if(*text != '\0' && *text != '#')
+            {
+                return 0;
+            }
+        }
+
+        return -1;
+    }
+
+
+    /* reads a term line of the given term, returns 0 on success and -1 on failure */
+    int read_term(const char * line, const int term_index, term & t)
+    {
+        char variable[PARAMETER_LINE_SIZE];
+        char name[PARAMETER_LINE_SIZE];
+        char shape[PARAMETER_LINE_SIZE];
+        double vertices[4];
+        const int values = sscanf(line, "%255s %255s %255s %lf %lf %lf %lf", variable, name,
+                shape, &vertices[0], &vertices[1], &vertices[2], &vertices[3]);
+
+        if(values < 3 || strcmp(variable, TERM_NAMES[term_index].variable) != 0 ||
+                strcmp(name, TERM_NAMES[term_index].term) != 0 ||
+                strcmp(shape, SHAPE_NAMES[t.shape]) != 0 ||
+                values != 3 + get_vertex_count(t))
+        {
+            return -1;
+        }
+
+        t.a = vertices[0];
+        t.b = vertices[1];
+        if(t.shape == controller_fuzzy::TRAPEZOID)
+        {
+            t.c = vertices[2];
+            t.d = vertices[3];
+        }
+
+        return controller_fuzzy::is_valid_term(t) ? 0 : -1;
+    }
+}
+
+
+void controller_fuzzy::use_parameters(const fuzzy_parameters & parameters)
+{
+    parameters_in_use = parameters;
+}
+
+
+int controller_fuzzy::get_compiled_parameters(const char * version,
+        fuzzy_parameters & parameters)
+{
+    if(strlen(version) >= FUZZY_PARAMETERS_VERSION_SIZE)
+    {
+        return -1;
+    }
+
+    memset(&parameters, 0, sizeof(parameters));
+    strcpy(parameters.version, version);
+
+    copy_terms(SPEED_TERMS, SPEED_FIRST_TERM, parameters);
+    copy_terms(ACCELERATION_TERMS, ACCELERATION_FIRST_TERM, parameters);
+    copy_terms(PATH_TERMS, PATH_FIRST_TERM, parameters);
+    copy_terms(NEXT_PATH_TERMS, NEXT_PATH_FIRST_TERM, parameters);
+    copy_terms(STABILITY_TERMS, STABILITY_FIRST_TERM, parameters);
+    copy_terms(STEER_TERMS, STEER_FIRST_TERM, parameters);
+    copy_terms(ACCEL_TERMS, ACCEL_FIRST_TERM, parameters);
+    copy_terms(GEAR_TERMS, GEAR_FIRST_TERM, parameters);
+    copy_terms(BRAKE_TERMS, BRAKE_FIRST_TERM, parameters);
+
+    return 0;
+}
+
+
+int controller_fuzzy::is_valid_term(const term & t)
+{
+    switch(t.shape)
+    {
+        case TRAPEZOID :
+            return t.a <= t.b && t.b <= t.c && t.c <= t.d;
+
+        case RAMP :
+            return t.a != t.b;
+
+        case RECTANGLE :
+            return t.a < t.b;
+    }
+
+    return 0;
+}
+
+
+const char * controller_fuzzy::get_variable_name(const int term_index)
+{
+    return TERM_NAMES[term_index].variable;
+}
+
+
+const char * controller_fuzzy::get_term_name(const int term_index)
+{
+    return TERM_NAMES[term_index].term;
+}
+
+
+int controller_fuzzy::read_parameters(const char * file_name, fuzzy_parameters & parameters)
+{
+    FILE * file = fopen(file_name, "r");
+    if(file == NULL)
+    {
+        printf("couldn't open fuzzy parameter file \'%s\'\n", file_name);
+        return -1;
+    }
+
+    // shapes are those of compiled terms
+    fuzzy_parameters read;
+    get_compiled_parameters("", read);
+
+    char line[PARAMETER_LINE_SIZE];
+    int line_number = 0;
+    char version[PARAMETER_LINE_SIZE];
+    int is_valid = read_line(file, line, line_number) == 0 &&
+        sscanf(line, "version %255s", version) == 1 &&
+        strlen(version) < FUZZY_PARAMETERS_VERSION_SIZE;
+    if(is_valid)
+    {
+        strcpy(read.version, version);
+    }
+
+    for(int i = 0; i < TERM_COUNT && is_valid; i++)
+    {
+        is_valid = read_line(file, line, line_number) == 0 &&
+            read_term(line, i, read.terms[i]) == 0;
+    }
+    is_valid = is_valid && read_line(file, line, line_number) != 0;
+    fclose(file);
+
+    if(!is_valid)
+    {
+        printf("fuzzy parameter file \'%s\' is not valid ( line %d )\n",
+                file_name, line_number);
+        return -1;
+    }
+
+    parameters = read;
+
+    return 0;
+}
+
+
+int controller_fuzzy::write_parameters(const char * file_name,
+        const fuzzy_parameters & parameters)
+{
+    FILE * file = fopen(file_name, "w");
+    if(file == NULL)
+    {
+        printf("couldn't create fuzzy parameter file \'%s\'\n", file_name);
+        return -1;
+    }
+
+    fprintf(file, "# fuzzy parameters ( see fuzzy_parameters.h )\n");
+    fprintf(file, "version %s\n", parameters.version);
+    for(int i = 0; i < TERM_COUNT; i++)
+    {
+        const term & t = parameters.terms[i];
+        const double vertices[4] = {t.a, t.b, t.c, t.d};
+
+        fprintf(file, "%s %s %s", TERM_NAMES[i].variable, TERM_NAMES[i].term,
+                SHAPE_NAMES[t.shape]);
+        for(int v = 0; v < get_vertex_count(t); v++)
+        {
+            fprintf(file, " %.17g", vertices[v]);
+        }
+        fprintf(file, "\n");
+    }
+
+    if(fclose(file) != 0)
+    {
+        printf("couldn't write fuzzy parameter file \'%s\'\n", file_name);
+        return -1;
+    }
+
+    return 0;
+}
+
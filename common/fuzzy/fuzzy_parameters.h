@@ -0,0 +1,107 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * fuzzy_parameters.h
+ *
+ * Fuzzy parameter sets - terms of all variables of the controller ( in order
+ * of variables and their terms, see fuzzy_rule_base.h ) with a version, so
+ * that terms tuned by fuzzy tune tool are used without compiling them in.
+ *
+ * Rules of fuzzy_rules<Defuzzifier, parameter_terms> take terms of their
+ * variables from the parameter set in use. There is one such set in a process
+ * ( set by use_parameters ), while compiled terms stay as they are.
+ *
+ *  Parameter file
+ *  --------------
+ *  Text file with "version <version>" and then a line for each term -
+ *  "<variable> <term> <shape> <vertices>", e.g. "speed slow trapezoid 15 25 40 45".
+ *  Variables, terms and shapes are same as those of compiled terms, in the
+ *  same order. Empty lines and lines starting with '#' are left out.
+ *
+ *     version  : 1.0.0
+ *  created on  : 17 Oct 2026
+ *      author  : M.S.Khan
+ */
+
+
+#ifndef FUZZY_PARAMETERS_H_
+#define FUZZY_PARAMETERS_H_
+
+#include "fuzzy_rule_base.h"
+
+
+// longest version of a parameter set ( same as FUZZY_TABLE_VERSION_SIZE, so
+// that tables are made for it )
+#define FUZZY_PARAMETERS_VERSION_SIZE  16
+
+
+namespace controller_fuzzy
+{
+
+    /** terms of all variables with version of the set **/
+    typedef struct fuzzy_parameters_struct
+    {
+
+        char version[FUZZY_PARAMETERS_VERSION_SIZE];
+        term terms[TERM_COUNT];
+
+    } fuzzy_parameters;
+
+
+    // parameter set used by rules with parameter_terms
+    extern fuzzy_parameters parameters_in_use;
+
+
+    /** a variable with terms of the parameter set in use **/
+    template<typename Variable>
+    struct parameter_terms : Variable
+    {
+        static term get_term(const int i)
+        {
+            return parameters_in_use.terms[Variable::first_term + i];
+        }
+    };
+
+
+    // uses the given set for rules with parameter_terms
+    void use_parameters(const fuzzy_parameters & parameters);
+
+    // gets compiled terms as a parameter set of the given version
+    // returns 0 on success and -1 if the version is too long
+    int get_compiled_parameters(const char * version, fuzzy_parameters & parameters);
+
+    // returns non-zero if vertices of the term are in order of its shape ( and
+    // ramp and rectangle are not empty )
+    int is_valid_term(const term & t);
+
+    // names of variable and term of a term in parameter sets
+    const char * get_variable_name(const int term_index);
+    const char * get_term_name(const int term_index);
+
+    // reads a parameter file, returns 0 on success and -1 on failure
+    int read_parameters(const char * file_name, fuzzy_parameters & parameters);
+
+    // writes a parameter file, returns 0 on success and -1 on failure
+    int write_parameters(const char * file_name, const fuzzy_parameters & parameters);
+
+}
+
+#endif      /** ifndef FUZZY_PARAMETERS_H_ **/
+
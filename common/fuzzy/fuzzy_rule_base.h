@@ -0,0 +1,420 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * fuzzy_rule_base.h
+ *
+ * Terms and rules of fuzzy controller for the engine of fuzzy_engine.h ( same
+ * terms and rules as fuzzylite engine of fuzzylite_reference.cpp, which is only
+ * used to compare outputs of the two engines ). Outputs are defuzzified with
+ * Centroid of 100 samples in v1.0.0 and with exact centroid in v1.1.0.
+ *
+ * Terms below are the compiled terms of the controller. Rules can also take
+ * terms of their variables from a fuzzy parameter set ( see fuzzy_parameters.h ),
+ * which keeps terms of all variables in one list, in order of the variables.
+ *
+ *     version  : 1.0.0
+ *  created on  : 17 Oct 2026
+ *      author  : M.S.Khan
+ */
+
+
+#ifndef FUZZY_RULE_BASE_H_
+#define FUZZY_RULE_BASE_H_
+
+#include "fuzzy_engine.h"
+
+
+namespace controller_fuzzy
+{
+
+    /** inputs and outputs of the engine ( in this order ) **/
+    enum input_index
+    {
+        SPEED_INPUT,
+        ACCELERATION_INPUT,
+        PATH_INPUT,
+        NEXT_PATH_INPUT,
+        STABILITY_INPUT,
+        INPUT_COUNT
+    };
+
+    enum output_index
+    {
+        STEER_OUTPUT,
+        ACCEL_OUTPUT,
+        GEAR_OUTPUT,
+        BRAKE_OUTPUT,
+        OUTPUT_COUNT
+    };
+
+
+    /** terms of inputs **/
+    enum speed_term
+    {
+        SPEED_VERY_VERY_SLOW,
+        SPEED_VERY_SLOW,
+        SPEED_SLOW,
+        SPEED_MEDIUM,
+        SPEED_FAST,
+        SPEED_VERY_FAST
+    };
+
+    constexpr term SPEED_TERMS[] =
+    {
+        trapezoid(-0.5, -0.1, 0.1, 0.5),
+        trapezoid(0.4999, 2, 10, 15),
+        trapezoid(15, 25, 40, 45),
+        trapezoid(40, 45, 60, 65),
+        trapezoid(60, 65, 80, 85),
+        ramp(80, 85)
+    };
+
+
+    enum acceleration_term
+    {
+        ACCELERATION_NEGATIVE,
+        ACCELERATION_VERY_SLOW,
+        ACCELERATION_SLOW,
+        ACCELERATION_MEDIUM,
+        ACCELERATION_FAST,
+        ACCELERATION_VERY_FAST
+    };
+
+    constexpr term ACCELERATION_TERMS[] =
+    {
+        ramp(0, -1),
+        trapezoid(0, 0.5, 1, 1.5),
+        trapezoid(1, 1.5, 4, 6),
+        trapezoid(4, 6, 15, 20),
+        trapezoid(12, 15, 20, 25),
+        ramp(20, 30)
+    };
+
+
+    enum path_term
+    {
+        PATH_TOO_LEFT,
+        PATH_LEFT,
+        PATH_STRAIGHT,
+        PATH_RIGHT,
+        PATH_TOO_RIGHT
+    };
+
+    constexpr term PATH_TERMS[] =
+    {
+        ramp(-0.4, -0.5),
+        trapezoid(-0.5, -0.35, -0.2, -0.1),
+        trapezoid(-0.15, -0.07, 0.07, 0.15),
+        trapezoid(0.1, 0.2, 0.35, 0.5),
+        ramp(0.4, 0.5)
+    };
+
+
+    enum next_path_term
+    {
+        NEXT_PATH_LEFT,
+        NEXT_PATH_STRAIGHT,
+        NEXT_PATH_RIGHT
+    };
+
+    constexpr term NEXT_PATH_TERMS[] =
+    {
+        ramp(-0.15, -0.4),
+        trapezoid(-0.16, -0.1, 0.1, 0.16),
+        ramp(0.15, 0.4)
+    };
+
+
+    enum stability_term
+    {
+        STABILITY_STABLE,
+        STABILITY_UNSTABLE
+    };
+
+    constexpr term STABILITY_TERMS[] =
+    {
+        ramp(0.2, 0.000),
+        ramp(0.2, 0.4)
+    };
+
+
+    /** terms of outputs **/
+    enum steer_term
+    {
+        STEER_TOO_LEFT,
+        STEER_LEFT,
+        STEER_STRAIGHT,
+        STEER_RIGHT,
+        STEER_TOO_RIGHT
+    };
+
+    constexpr term STEER_TERMS[] =
+    {
+        ramp(-0.3, -0.4),
+        trapezoid(-0.4, -0.3, -0.15, -0.1),
+        trapezoid(-0.12, -0.05, 0.05, 0.12),
+        trapezoid(0.1, 0.15, 0.3, 0.4),
+        ramp(0.3, 0.4)
+    };
+
+
+    enum accel_term
+    {
+        ACCEL_VERY_SLOW,
+        ACCEL_SLOW,
+        ACCEL_MEDIUM,
+        ACCEL_FAST,
+        ACCEL_VERY_FAST
+    };
+
+    constexpr term ACCEL_TERMS[] =
+    {
+        ramp(0.2, 0.1),
+        trapezoid(0.15, 0.3, 0.5, 0.6),
+        trapezoid(0.4, 0.5, 0.6, 0.7),
+        trapezoid(0.55, 0.7, 0.8, 0.95),
+        ramp(0.9, 1.0)
+    };
+
+
+    enum gear_term
+    {
+        GEAR_REVERSE,
+        GEAR_VERY_LOW,
+        GEAR_LOW,
+        GEAR_MEDIUM,
+        GEAR_HIGH,
+        GEAR_VERY_HIGH
+    };
+
+    constexpr term GEAR_TERMS[] =
+    {
+        ramp(0, -1),
+        rectangle(1, 2),
+        rectangle(2, 3),
+        rectangle(3, 4),
+        rectangle(4, 5),
+        ramp(5, 6)
+    };
+
+
+    enum brake_term
+    {
+        BRAKE_VERY_SLOW,
+        BRAKE_SLOW,
+        BRAKE_MEDIUM,
+        BRAKE_FAST,
+        BRAKE_VERY_FAST
+    };
+
+    constexpr term BRAKE_TERMS[] =
+    {
+        ramp(0.05, 0.02),
+        trapezoid(0.02, 0.05, 0.08, 0.09),
+        trapezoid(0.08, 0.09, 0.1, 0.11),
+        trapezoid(0.11, 0.115, 0.12, 0.125),
+        ramp(0.12, 0.13)
+    };
+
+
+    /** first term of each variable in a list of terms of all variables **/
+    template<int N>
+    constexpr int get_term_count(const term (&)[N])
+    {
+        return N;
+    }
+
+    constexpr int SPEED_FIRST_TERM = 0;
+    constexpr int ACCELERATION_FIRST_TERM = SPEED_FIRST_TERM + get_term_count(SPEED_TERMS);
+    constexpr int PATH_FIRST_TERM = ACCELERATION_FIRST_TERM + get_term_count(ACCELERATION_TERMS);
+    constexpr int NEXT_PATH_FIRST_TERM = PATH_FIRST_TERM + get_term_count(PATH_TERMS);
+    constexpr int STABILITY_FIRST_TERM = NEXT_PATH_FIRST_TERM + get_term_count(NEXT_PATH_TERMS);
+    constexpr int STEER_FIRST_TERM = STABILITY_FIRST_TERM + get_term_count(STABILITY_TERMS);
+    constexpr int ACCEL_FIRST_TERM = STEER_FIRST_TERM + get_term_count(STEER_TERMS);
+    constexpr int GEAR_FIRST_TERM = ACCEL_FIRST_TERM + get_term_count(ACCEL_TERMS);
+    constexpr int BRAKE_FIRST_TERM = GEAR_FIRST_TERM + get_term_count(GEAR_TERMS);
+    constexpr int TERM_COUNT = BRAKE_FIRST_TERM + get_term_count(BRAKE_TERMS);
+
+
+    /** input variables **/
+    struct speed
+    {
+        static const int index = SPEED_INPUT;
+        static const int first_term = SPEED_FIRST_TERM;
+        static constexpr term get_term(const int i) { return SPEED_TERMS[i]; }
+    };
+
+    struct acceleration
+    {
+        static const int index = ACCELERATION_INPUT;
+        static const int first_term = ACCELERATION_FIRST_TERM;
+        static constexpr term get_term(const int i) { return ACCELERATION_TERMS[i]; }
+    };
+
+    struct path
+    {
+        static const int index = PATH_INPUT;
+        static const int first_term = PATH_FIRST_TERM;
+        static constexpr term get_term(const int i) { return PATH_TERMS[i]; }
+    };
+
+    struct next_path
+    {
+        static const int index = NEXT_PATH_INPUT;
+        static const int first_term = NEXT_PATH_FIRST_TERM;
+        static constexpr term get_term(const int i) { return NEXT_PATH_TERMS[i]; }
+    };
+
+    struct stability
+    {
+        static const int index = STABILITY_INPUT;
+        static const int first_term = STABILITY_FIRST_TERM;
+        static constexpr term get_term(const int i) { return STABILITY_TERMS[i]; }
+    };
+
+
+    /** output variables ( defuzzified by Defuzzifier ) **/
+
+    // angle of steer to be applied
+    template<typename Defuzzifier>
+    struct steer
+    {
+        static const int index = STEER_OUTPUT;
+        static const int first_term = STEER_FIRST_TERM;
+        static constexpr scalar min_value = -1;
+        static constexpr scalar max_value = 1;
+        static constexpr scalar default_value = 0;
+        static const bool lock_previous_value = false;
+        typedef algebraic_sum aggregation;
+        typedef Defuzzifier defuzzifier;
+        static constexpr term get_term(const int i) { return STEER_TERMS[i]; }
+    };
+
+    // intensity of accelerator to be applied
+    template<typename Defuzzifier>
+    struct accel
+    {
+        static const int index = ACCEL_OUTPUT;
+        static const int first_term = ACCEL_FIRST_TERM;
+        static constexpr scalar min_value = 0;
+        static constexpr scalar max_value = 1;
+        static constexpr scalar default_value = 1.0;
+        static const bool lock_previous_value = false;
+        typedef algebraic_sum aggregation;
+        typedef Defuzzifier defuzzifier;
+        static constexpr term get_term(const int i) { return ACCEL_TERMS[i]; }
+    };
+
+    // value of gear to be applied
+    template<typename Defuzzifier>
+    struct gear
+    {
+        static const int index = GEAR_OUTPUT;
+        static const int first_term = GEAR_FIRST_TERM;
+        static constexpr scalar min_value = -1;
+        static constexpr scalar max_value = 6;
+        static constexpr scalar default_value = 1;
+        static const bool lock_previous_value = true;
+        typedef maximum aggregation;
+        typedef Defuzzifier defuzzifier;
+        static constexpr term get_term(const int i) { return GEAR_TERMS[i]; }
+    };
+
+    // intensity of brake to be applied
+    template<typename Defuzzifier>
+    struct brake
+    {
+        static const int index = BRAKE_OUTPUT;
+        static const int first_term = BRAKE_FIRST_TERM;
+        static constexpr scalar min_value = 0;
+        static constexpr scalar max_value = 1;
+        static constexpr scalar default_value = 0;
+        static const bool lock_previous_value = false;
+        typedef algebraic_sum aggregation;
+        typedef Defuzzifier defuzzifier;
+        static constexpr term get_term(const int i) { return BRAKE_TERMS[i]; }
+    };
+
+
+    /** rules **/
+
+    // variables with their compiled terms
+    template<typename Variable>
+    using compiled_terms = Variable;
+
+    /**
+     * rule blocks of the controller, with outputs defuzzified by Defuzzifier
+     * ( same for all outputs ) and terms of each variable given by Terms
+     **/
+    template<typename Defuzzifier, template<typename> class Terms = compiled_terms>
+    struct fuzzy_rules
+    {
+        typedef Terms<speed> speed_input;
+        typedef Terms<path> path_input;
+        typedef Terms<steer<Defuzzifier> > steer_output;
+        typedef Terms<accel<Defuzzifier> > accel_output;
+        typedef Terms<gear<Defuzzifier> > gear_output;
+        typedef Terms<brake<Defuzzifier> > brake_output;
+
+        // "path is too_left or path is too_right"
+        typedef fuzzy_or<is<path_input, PATH_TOO_LEFT>, is<path_input, PATH_TOO_RIGHT> >
+            path_is_too_wide;
+
+        typedef rule_block<steer_output, minimum, maximum, algebraic_product, proportional,
+                rule<is<path_input, PATH_STRAIGHT>, STEER_STRAIGHT>,
+                rule<is<path_input, PATH_RIGHT>, STEER_RIGHT>,
+                rule<is<path_input, PATH_LEFT>, STEER_LEFT>,
+                rule<is<path_input, PATH_TOO_RIGHT>, STEER_TOO_RIGHT>,
+                rule<is<path_input, PATH_TOO_LEFT>, STEER_TOO_LEFT> > steer_rule_block;
+
+        typedef rule_block<gear_output, minimum, maximum, algebraic_product, first,
+                rule<is<speed_input, SPEED_VERY_FAST>, GEAR_VERY_HIGH>,
+                rule<is<speed_input, SPEED_FAST>, GEAR_HIGH>,
+                rule<is<speed_input, SPEED_MEDIUM>, GEAR_MEDIUM>,
+                rule<is<speed_input, SPEED_SLOW>, GEAR_LOW>,
+                rule<is<speed_input, SPEED_VERY_SLOW>, GEAR_VERY_LOW> > gear_rule_block;
+
+        typedef rule_block<accel_output, minimum, maximum, algebraic_product, first,
+                rule<fuzzy_and<path_is_too_wide, is<speed_input, SPEED_VERY_FAST> >, ACCEL_VERY_SLOW>,
+                rule<fuzzy_and<path_is_too_wide, is<speed_input, SPEED_FAST> >, ACCEL_SLOW>,
+                rule<fuzzy_and<path_is_too_wide, is<speed_input, SPEED_MEDIUM> >, ACCEL_SLOW> >
+                accel_rule_block;
+
+        typedef rule_block<brake_output, minimum, maximum, algebraic_product, first,
+                rule<fuzzy_and<path_is_too_wide, is<speed_input, SPEED_VERY_FAST> >, BRAKE_VERY_FAST>,
+                rule<fuzzy_and<path_is_too_wide, is<speed_input, SPEED_FAST> >, BRAKE_FAST>,
+                rule<fuzzy_and<path_is_too_wide, is<speed_input, SPEED_MEDIUM> >, BRAKE_MEDIUM> >
+                brake_rule_block;
+
+        // rule blocks in the same order as in fuzzylite engine
+        typedef engine<steer_rule_block, gear_rule_block, accel_rule_block, brake_rule_block>
+            rule_base;
+    };
+
+    // rule base of v1.0.0, with Centroid of 100 samples as in fuzzylite
+    typedef fuzzy_rules<centroid<100> >::rule_base sampled_rule_base;
+
+    // same rules with exact centroid ( v1.1.0 )
+    typedef fuzzy_rules<exact_centroid>::rule_base exact_rule_base;
+
+}
+
+#endif      /** ifndef FUZZY_RULE_BASE_H_ **/
+
@@ -25,7 +25,7 @@
  *      author  : M.S.Khan
  */
 
-#include "fuzzy_controller.h"
+#include "fuzzylite_reference.h"
 #include "fuzzy_values.h"
 
 #include <fl/activation/First.h>
@@ -38,7 +38,7 @@
 #include <fl/rule/RuleBlock.h>
 
 
-void controller::FuzzyController::add_rules()
+void controller::FuzzyliteReference::add_rules()
 {
     // add steering rules to the engine
     add_steer_rules();
@@ -54,7 +54,7 @@ void controller::FuzzyController::add_rules()
 }
 
 
-void controller::FuzzyController::add_steer_rules()
+void controller::FuzzyliteReference::add_steer_rules()
 {
     // deleted in class fl::Engine
     fl::RuleBlock * steer_rule_block = new fl::RuleBlock("steer_rule_block");
@@ -88,7 +88,7 @@ void controller::FuzzyController::add_steer_rules()
 }
 
 
-void controller::FuzzyController::add_gear_rules()
+void controller::FuzzyliteReference::add_gear_rules()
 {
     // deleted in class fl::Engine
     fl::RuleBlock * gear_rule_block = new fl::RuleBlock("gear_rule_block");
@@ -122,7 +122,7 @@ void controller::FuzzyController::add_gear_rules()
 }
 
 
-void controller::FuzzyController::add_accel_rules()
+void controller::FuzzyliteReference::add_accel_rules()
 {
     // deleted in class fl::Engine
     fl::RuleBlock * accel_rule_block = new fl::RuleBlock("accel_rule_block");
@@ -156,7 +156,7 @@ void controller::FuzzyController::add_accel_rules()
 }
 
 
-void controller::FuzzyController::add_brake_rules()
+void controller::FuzzyliteReference::add_brake_rules()
 {
     // deleted in class fl::Engine
     fl::RuleBlock * brake_rule_block = new fl::RuleBlock("brake_rule_block");
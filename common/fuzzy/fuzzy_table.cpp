@@ -0,0 +1,313 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * fuzzy_table.cpp
+ *
+ *     version  : 1.0.0
+ *  created on  : 17 Oct 2026
+ *      author  : M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "fuzzy_table.h"
+
+
+namespace
+{
+    /* returns non-zero if the axis has at least two points in a range */
+    int is_valid_axis(const controller::fuzzy_table_axis & axis)
+    {
+        return axis.points >= 2 && axis.minimum < axis.maximum;
+    }
+}
+
+
+controller::FuzzyTable::FuzzyTable()
+{
+    clear();
+}
+
+
+int controller::FuzzyTable::create(const fuzzy_table_axis & path_axis,
+        const fuzzy_table_axis & speed_axis, const char * controller_version)
+{
+    clear();
+
+    if(!is_valid_axis(path_axis) || !is_valid_axis(speed_axis) ||
+            strlen(controller_version) >= FUZZY_TABLE_VERSION_SIZE)
+    {
+        return -1;
+    }
+
+    memcpy(m_header.magic, FUZZY_TABLE_MAGIC, sizeof(m_header.magic));
+    m_header.format_version = FUZZY_TABLE_FORMAT_VERSION;
+    strcpy(m_header.controller_version, controller_version);
+    m_header.path_axis = path_axis;
+    m_header.speed_axis = speed_axis;
+
+    m_values.assign((size_t) path_axis.points * speed_axis.points * FUZZY_TABLE_OUTPUTS, 0);
+    m_exact_cells.assign((size_t) (path_axis.points - 1) * (speed_axis.points - 1), 0);
+    set_scales();
+
+    return 0;
+}
+
+
+int controller::FuzzyTable::load_from_file(const char * file_name,
+        const char * controller_version)
+{
+    clear();
+
+    FILE * file = fopen(file_name, "rb");
+    if(file == NULL)
+    {
+        printf("couldn't open fuzzy table file \'%s\'\n", file_name);
+        return -1;
+    }
+
+    fuzzy_table_header header;
+    int is_valid = fread(&header, sizeof(header), 1, file) == 1 &&
+        memcmp(header.magic, FUZZY_TABLE_MAGIC, sizeof(header.magic)) == 0 &&
+        header.format_version == FUZZY_TABLE_FORMAT_VERSION &&
+        is_valid_axis(header.path_axis) && is_valid_axis(header.speed_axis);
+
+    if(is_valid)
+    {
+        header.controller_version[FUZZY_TABLE_VERSION_SIZE - 1] = '\0';
+        if(strcmp(header.controller_version, controller_version) != 0)
+        {
+            printf("fuzzy table \'%s\' is for fuzzy controller v%s ( not v%s )\n",
+                    file_name, header.controller_version, controller_version);
+            fclose(file);
+            return -1;
+        }
+
+        m_header = header;
+        m_values.resize((size_t) header.path_axis.points * header.speed_axis.points
+                * FUZZY_TABLE_OUTPUTS);
+        m_exact_cells.resize((size_t) (header.path_axis.points - 1)
+                * (header.speed_axis.points - 1));
+        is_valid = fread(&m_values[0], sizeof(float), m_values.size(), file) == m_values.size()
+            && fread(&m_exact_cells[0], 1, m_exact_cells.size(), file) == m_exact_cells.size()
+            && get_checksum() == header.checksum;
+    }
+    fclose(file);
+
+    if(!is_valid)
+    {
+        printf("fuzzy table file \'%s\' is not valid\n", file_name);
+        clear();
+        return -1;
+    }
+
+    set_scales();
+
+    return 0;
+}
+
+
+int controller::FuzzyTable::write_to_file(const char * file_name) const
+{
+    if(!is_loaded())
+    {
+        return -1;
+    }
+
+    FILE * file = fopen(file_name, "wb");
+    if(file == NULL)
+    {
+        printf("couldn't create fuzzy table file \'%s\'\n", file_name);
+        return -1;
+    }
+
+    fuzzy_table_header header = m_header;
+    header.checksum = get_checksum();
+
+    const int is_written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        fwrite(&m_values[0], sizeof(float), m_values.size(), file) == m_values.size() &&
+        fwrite(&m_exact_cells[0], 1, m_exact_cells.size(), file) == m_exact_cells.size();
+
+    if(fclose(file) != 0 || !is_written)
+    {
+        printf("couldn't write fuzzy table file \'%s\'\n", file_name);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+void controller::FuzzyTable::clear()
+{
+    memset(&m_header, 0, sizeof(m_header));
+    m_values.clear();
+    m_exact_cells.clear();
+    m_path_scale = 0;
+    m_speed_scale = 0;
+}
+
+
+int controller::FuzzyTable::is_loaded() const
+{
+    return !m_values.empty();
+}
+
+
+const controller::fuzzy_table_header & controller::FuzzyTable::get_header() const
+{
+    return m_header;
+}
+
+
+float controller::FuzzyTable::get_path(const int path_index) const
+{
+    return m_header.path_axis.minimum + path_index / m_path_scale;
+}
+
+
+float controller::FuzzyTable::get_speed(const int speed_index) const
+{
+    return m_header.speed_axis.minimum + speed_index / m_speed_scale;
+}
+
+
+void controller::FuzzyTable::set_values(const int path_index, const int speed_index,
+        const float values[FUZZY_TABLE_OUTPUTS])
+{
+    float * point_values = &m_values[((size_t) path_index * m_header.speed_axis.points
+            + speed_index) * FUZZY_TABLE_OUTPUTS];
+    memcpy(point_values, values, FUZZY_TABLE_OUTPUTS * sizeof(float));
+}
+
+
+void controller::FuzzyTable::set_exact_cell(const int path_index, const int speed_index,
+        const int is_exact)
+{
+    m_exact_cells[(size_t) path_index * (m_header.speed_axis.points - 1) + speed_index] =
+        is_exact ? 1 : 0;
+}
+
+
+int controller::FuzzyTable::get_exact_cell_count() const
+{
+    int exact_cells = 0;
+    for(size_t i = 0; i < m_exact_cells.size(); i++)
+    {
+        exact_cells += m_exact_cells[i];
+    }
+
+    return exact_cells;
+}
+
+
+int controller::FuzzyTable::get_values(const float path, const float speed,
+        float values[FUZZY_TABLE_OUTPUTS]) const
+{
+    // comparisons are also false for NaN inputs ( and for an empty table )
+    if(!(path >= m_header.path_axis.minimum && path <= m_header.path_axis.maximum &&
+                speed >= m_header.speed_axis.minimum && speed <= m_header.speed_axis.maximum &&
+                is_loaded()))
+    {
+        return -1;
+    }
+
+    // cell of the inputs ( last cell for inputs at maximum ) and position in the cell
+    const float path_steps = (path - m_header.path_axis.minimum) * m_path_scale;
+    const float speed_steps = (speed - m_header.speed_axis.minimum) * m_speed_scale;
+    const int speed_cells = m_header.speed_axis.points - 1;
+    int path_index = (int) path_steps;
+    int speed_index = (int) speed_steps;
+    path_index = (path_index < m_header.path_axis.points - 1) ? path_index :
+        m_header.path_axis.points - 2;
+    speed_index = (speed_index < speed_cells) ? speed_index : speed_cells - 1;
+
+    if(!m_exact_cells[(size_t) path_index * speed_cells + speed_index])
+    {
+        return -1;
+    }
+
+    const float path_weight = path_steps - path_index;
+    const float speed_weight = speed_steps - speed_index;
+
+    // outputs at four corners of the cell
+    const float * values_00 = &m_values[((size_t) path_index * (speed_cells + 1)
+            + speed_index) * FUZZY_TABLE_OUTPUTS];
+    const float * values_01 = values_00 + FUZZY_TABLE_OUTPUTS;
+    const float * values_10 = values_00 + (speed_cells + 1) * FUZZY_TABLE_OUTPUTS;
+    const float * values_11 = values_10 + FUZZY_TABLE_OUTPUTS;
+
+#if defined(__SSE2__)
+    // all four outputs are interpolated together
+    const __m128 speed_weights = _mm_set1_ps(speed_weight);
+    const __m128 low_path = _mm_loadu_ps(values_00);
+    const __m128 high_path = _mm_loadu_ps(values_10);
+    const __m128 at_low_path = _mm_add_ps(low_path, _mm_mul_ps(speed_weights,
+                _mm_sub_ps(_mm_loadu_ps(values_01), low_path)));
+    const __m128 at_high_path = _mm_add_ps(high_path, _mm_mul_ps(speed_weights,
+                _mm_sub_ps(_mm_loadu_ps(values_11), high_path)));
+    _mm_storeu_ps(values, _mm_add_ps(at_low_path, _mm_mul_ps(_mm_set1_ps(path_weight),
+                    _mm_sub_ps(at_high_path, at_low_path))));
+#else
+    for(int i = 0; i < FUZZY_TABLE_OUTPUTS; i++)
+    {
+        const float at_low_path = values_00[i] + speed_weight * (values_01[i] - values_00[i]);
+        const float at_high_path = values_10[i] + speed_weight * (values_11[i] - values_10[i]);
+        values[i] = at_low_path + path_weight * (at_high_path - at_low_path);
+    }
+#endif
+
+    return 0;
+}
+
+
+void controller::FuzzyTable::set_scales()
+{
+    m_path_scale = (m_header.path_axis.points - 1) /
+        (m_header.path_axis.maximum - m_header.path_axis.minimum);
+    m_speed_scale = (m_header.speed_axis.points - 1) /
+        (m_header.speed_axis.maximum - m_header.speed_axis.minimum);
+}
+
+
+unsigned long long int controller::FuzzyTable::get_checksum() const
+{
+    unsigned long long int checksum = 14695981039346656037ULL;
+
+    const unsigned char * bytes = (const unsigned char *) m_values.data();
+    const size_t value_bytes = m_values.size() * sizeof(float);
+    for(size_t i = 0; i < value_bytes; i++)
+    {
+        checksum = (checksum ^ bytes[i]) * 1099511628211ULL;
+    }
+    for(size_t i = 0; i < m_exact_cells.size(); i++)
+    {
+        checksum = (checksum ^ m_exact_cells[i]) * 1099511628211ULL;
+    }
+
+    return checksum;
+}
+
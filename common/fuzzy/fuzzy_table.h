@@ -0,0 +1,192 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * fuzzy_table.h
+ *
+ * Outputs of the fuzzy engine sampled on a grid of its inputs, so that they
+ * are interpolated instead of running the engine at each tick.
+ *
+ * Rules of fuzzy controller v1.0.0 only use "path" and "speed" inputs, so
+ * the grid has these two axes and each grid point keeps the four fuzzy
+ * outputs ( before gear is rounded ). Outputs are bilinearly interpolated
+ * between four grid points around the inputs, all four outputs at once with
+ * SSE when it is available.
+ *
+ * Some outputs jump where a rule starts to fire ( "First" activation of
+ * accel, gear and brake ), so interpolation is not close to the engine in
+ * cells of the grid around such jumps. A table marks each cell which was
+ * checked to be within a tolerance of the engine ( "exact" cell ), and inputs
+ * that are not in an exact cell, or are outside the grid, are left to the
+ * engine ( tables are made by fuzzy table tool, which samples the engine ).
+ *
+ *  Table file
+ *  ----------
+ *  fuzzy_table_header, values of grid points ( FUZZY_TABLE_OUTPUTS floats for
+ *  each point, speed index changes first ), one byte for each cell ( 1 if
+ *  exact ). Table of a different version of fuzzy controller is not loaded.
+ *
+ *     version  : 1.0.0
+ *  created on  : 17 Oct 2026
+ *      author  : M.S.Khan
+ */
+
+
+#ifndef FUZZY_TABLE_H_
+#define FUZZY_TABLE_H_
+
+#include <vector>
+
+
+// marks a fuzzy table file and version of its format
+#define FUZZY_TABLE_MAGIC            "FUZZYTBL"
+#define FUZZY_TABLE_FORMAT_VERSION   1
+
+// outputs kept for each grid point ( in this order )
+#define FUZZY_TABLE_STEER            0
+#define FUZZY_TABLE_ACCEL            1
+#define FUZZY_TABLE_GEAR             2
+#define FUZZY_TABLE_BRAKE            3
+#define FUZZY_TABLE_OUTPUTS          4
+
+// longest FUZZY_CONTROLLER_VERSION kept in table file
+#define FUZZY_TABLE_VERSION_SIZE     16
+
+
+namespace controller
+{
+
+    /** an input of the grid, from "minimum" to "maximum" in "points" points **/
+    typedef struct fuzzy_table_axis_struct
+    {
+
+        float minimum;
+        float maximum;
+        int points;
+
+    } fuzzy_table_axis;
+
+
+    /** header of a fuzzy table file **/
+    typedef struct fuzzy_table_header_struct
+    {
+
+        char magic[8];
+        int format_version;
+        // version of fuzzy controller that was sampled
+        char controller_version[FUZZY_TABLE_VERSION_SIZE];
+
+        fuzzy_table_axis path_axis;
+        fuzzy_table_axis speed_axis;
+
+        // checksum of values and cells after the header ( FNV-1a )
+        unsigned long long int checksum;
+
+    } fuzzy_table_header;
+
+
+    /*
+     * =====================================================================================
+     *        Class:  FuzzyTable
+     *  Description:  Fuzzy outputs on a grid of path and speed, which are
+     *                interpolated for inputs within exact cells of the grid.
+     * =====================================================================================
+     */
+    class FuzzyTable
+    {
+        public:
+
+            FuzzyTable();
+
+            // creates an empty table ( no exact cells ) of the given grid for a
+            // version of fuzzy controller
+            // returns 0 on success and -1 if an axis is not valid
+            int create(const fuzzy_table_axis & path_axis, const fuzzy_table_axis & speed_axis,
+                    const char * controller_version);
+
+            // loads a table file written for the given version of fuzzy controller
+            // returns 0 on success and -1 on failure ( table is then empty )
+            int load_from_file(const char * file_name, const char * controller_version);
+
+            // writes the table to a file, returns 0 on success and -1 on failure
+            int write_to_file(const char * file_name) const;
+
+            // removes the table
+            void clear();
+
+            // returns non-zero if the table has a grid
+            int is_loaded() const;
+
+            const fuzzy_table_header & get_header() const;
+
+            // path and speed of a grid point
+            float get_path(const int path_index) const;
+            float get_speed(const int speed_index) const;
+
+            // sets outputs of a grid point
+            void set_values(const int path_index, const int speed_index,
+                    const float values[FUZZY_TABLE_OUTPUTS]);
+
+            // marks a cell ( from the given grid point to the next points ) exact or not
+            void set_exact_cell(const int path_index, const int speed_index, const int is_exact);
+
+            // returns number of exact cells
+            int get_exact_cell_count() const;
+
+            // interpolates outputs for the given path and speed
+            // returns 0 if they are in an exact cell and -1 otherwise ( outputs are not set )
+            int get_values(const float path, const float speed,
+                    float values[FUZZY_TABLE_OUTPUTS]) const;
+
+
+        private:
+
+            /** MEMBER VARIABLES **/
+
+            fuzzy_table_header m_header;
+
+            // outputs of grid points and exact flags of cells
+            std::vector<float> m_values;
+            std::vector<unsigned char> m_exact_cells;
+
+            // grid points in a unit of path and speed
+            float m_path_scale;
+            float m_speed_scale;
+
+
+            /** MEMBER FUNCTIONS **/
+
+            // sets scales of axes from the header
+            void set_scales();
+
+            // returns checksum of values and cells
+            unsigned long long int get_checksum() const;
+
+            // copy constructor
+            FuzzyTable(const FuzzyTable &other);
+
+            // assignment operator
+            FuzzyTable& operator=(const FuzzyTable &other);
+
+    };       /** class FuzzyTable **/
+
+}
+
+#endif      /** ifndef FUZZY_TABLE_H_ **/
+
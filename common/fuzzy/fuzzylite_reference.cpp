@@ -18,18 +18,15 @@
  */
 
 /*
- * fuzzy_controller.cpp
+ * fuzzylite_reference.cpp
  *
  *     version  : 1.0.0
- *  created on  : 18 Feb 2018
+ *  created on  : 17 Oct 2026
  *      author  : M.S.Khan
  */
 
 
-#include<cmath>
-#include<string>
-
-#include "fuzzy_controller.h"
+#include "fuzzylite_reference.h"
 #include "fuzzy_values.h"
 
 #include <fl/Engine.h>
@@ -42,15 +39,12 @@
 #include <fl/variable/OutputVariable.h>
 
 
-controller::FuzzyController::FuzzyController()
+controller::FuzzyliteReference::FuzzyliteReference()
 {
     m_fuzzy_engine = new fl::Engine;
     m_fuzzy_engine->setName("Fuzzy Controller Engine");
     m_fuzzy_engine->setDescription("fuzzy controller for deciding control values");
 
-    m_fuzzy_outputs = {0, 0, 0, 1};    // initialize steer, accel, gear and brake values
-    m_speed_at_gear_change = 0;
-
     // add input variables to the engine
     add_input_variables();
 
@@ -60,24 +54,24 @@ controller::FuzzyController::FuzzyController()
     // add rules to the engine
     add_rules();
 
-    // display version information with status
-    std::cout<<"Fuzzy Controller v"<<FUZZY_CONTROLLER_VERSION<<" - ";
+    m_output_variables[controller_fuzzy::STEER_OUTPUT] =
+        m_fuzzy_engine->getOutputVariable(OUTPUT_STEER);
+    m_output_variables[controller_fuzzy::ACCEL_OUTPUT] =
+        m_fuzzy_engine->getOutputVariable(OUTPUT_ACCEL);
+    m_output_variables[controller_fuzzy::GEAR_OUTPUT] =
+        m_fuzzy_engine->getOutputVariable(OUTPUT_GEAR);
+    m_output_variables[controller_fuzzy::BRAKE_OUTPUT] =
+        m_fuzzy_engine->getOutputVariable(OUTPUT_BRAKE);
+}
 
-    // make sure engine is ready
-    std::string message;
-    if(!m_fuzzy_engine->isReady(&message))
-    {
-        std::cout<<"Error loading Fuzzy engine : "
-            <<std::endl<<message<<std::endl;
-    }
-    else
-    {
-        std::cout<<"Loaded successfully."<<std::endl;
-    }
+
+int controller::FuzzyliteReference::is_ready(std::string * message) const
+{
+    return m_fuzzy_engine->isReady(message) ? 1 : 0;
 }
 
 
-void controller::FuzzyController::add_input_variables()
+void controller::FuzzyliteReference::add_input_variables()
 {
     // deleted in class fl::Engine
     fl::InputVariable *speed = new fl::InputVariable(INPUT_SPEED);
@@ -132,7 +126,7 @@ void controller::FuzzyController::add_input_variables()
 }
 
 
-void controller::FuzzyController::add_output_variables()
+void controller::FuzzyliteReference::add_output_variables()
 {
     // deleted in class fl::Engine
     fl::OutputVariable * steer = new fl::OutputVariable(OUTPUT_STEER, -1, 1);
@@ -212,8 +206,9 @@ void controller::FuzzyController::add_output_variables()
 }
 
 
-const controller::fuzzy_outputs & controller::FuzzyController::get_output(
-        const fuzzy_inputs * t_fuzzy_inputs)
+void controller::FuzzyliteReference::get_values(const fuzzy_inputs * t_fuzzy_inputs,
+        controller_fuzzy::scalar values[controller_fuzzy::OUTPUT_COUNT],
+        int is_empty[controller_fuzzy::OUTPUT_COUNT])
 {
     // apply fuzzy inputs
     m_fuzzy_engine->setInputValue(INPUT_SPEED, t_fuzzy_inputs->speed);
@@ -225,41 +220,15 @@ const controller::fuzzy_outputs & controller::FuzzyController::get_output(
     // process the input
     m_fuzzy_engine->process();
 
-    // copy the calculated outputs
-    m_fuzzy_outputs.steer = m_fuzzy_engine->getOutputVariable(OUTPUT_STEER)->getValue();
-    m_fuzzy_outputs.accel = m_fuzzy_engine->getOutputVariable(OUTPUT_ACCEL)->getValue();
-    m_fuzzy_outputs.brake = m_fuzzy_engine->getOutputVariable(OUTPUT_BRAKE)->getValue();
-
-    /**
-     * Modify gear value
-     * -----------------
-     * For discouraging frequent gear change only make suggested gear change when either :
-     *
-     * 1. The difference of current speed and speed at previous gear change
-     *    is large enough (defined by MIN_ABS_SPEED_DIFF_FOR_GEAR_CHANGE).
-     *
-     * 2. The suggested gear is a small value (defined by LOW_GEAR_FOR_FREE_GEAR_CHANGES).
-     *
-     */
-    if(std::fabs(t_fuzzy_inputs->speed - m_speed_at_gear_change)
-            >= MIN_ABS_SPEED_DIFF_FOR_GEAR_CHANGE
-            || m_fuzzy_outputs.gear <= LOW_GEAR_FOR_FREE_GEAR_CHANGES)
+    for(int i = 0; i < controller_fuzzy::OUTPUT_COUNT; i++)
     {
-        float fuzzy_gear = m_fuzzy_engine->getOutputVariable(OUTPUT_GEAR)->getValue();
-
-        // use std::ceil for normal gears and std::floor for reverse gear
-        m_fuzzy_outputs.gear = fuzzy_gear > 0 ?
-            std::ceil(fuzzy_gear) : std::floor(fuzzy_gear);
-
-        // record this speed for later comparison
-        m_speed_at_gear_change = t_fuzzy_inputs->speed;
+        values[i] = m_output_variables[i]->getValue();
+        is_empty[i] = m_output_variables[i]->fuzzyOutput()->isEmpty() ? 1 : 0;
     }
-
-    return m_fuzzy_outputs;
 }
 
 
-controller::FuzzyController::~FuzzyController()
+controller::FuzzyliteReference::~FuzzyliteReference()
 {
     if(m_fuzzy_engine != NULL)
     {
@@ -268,4 +237,3 @@ controller::FuzzyController::~FuzzyController()
     }
 }
 
-
@@ -18,28 +18,28 @@
  */
 
 /*
- * fuzzy_controller.h
+ * fuzzylite_reference.h
+ *
+ * Fuzzy controller v1.0.0 as a fuzzylite engine ( as it was before the engine
+ * of fuzzy_engine.h ). Only used to check that outputs of fuzzy_rule_base.h
+ * are same as outputs of fuzzylite ( see tools/<robot>_fuzzy_compare.cpp ),
+ * so that the robot itself doesn't need fuzzylite.
  *
  *     version  : 1.0.0
- *  created on  : 18 Feb 2018
+ *  created on  : 17 Oct 2026
  *      author  : M.S.Khan
  */
 
 
-#ifndef FUZZY_CONTROLLER_H_
-#define FUZZY_CONTROLLER_H_
-
-#include <fl/Engine.h>
+#ifndef FUZZYLITE_REFERENCE_H_
+#define FUZZYLITE_REFERENCE_H_
 
+#include <string>
 
-// Fuzzy controller version - 1.0.0
-#define FUZZY_CONTROLLER_VERSION "1.0.0"
+#include <fl/Engine.h>
 
+#include "fuzzy_controller.h"
 
-// Threshold for discouraging frequent gear changes
-#define MIN_ABS_SPEED_DIFF_FOR_GEAR_CHANGE 5
-// Rule does not apply for lower gears
-#define LOW_GEAR_FOR_FREE_GEAR_CHANGES 2
 
 // Input and Output names used in fuzzy engine
 #define INPUT_SPEED "speed"
@@ -57,49 +57,30 @@
 namespace controller
 {
 
-    /** fuzzy controller input variables **/
-    typedef struct fuzzy_input_struct
-    {
-
-        float speed;
-        float acceleration;
-        float path;
-        float next_path;
-        float stability;
-
-    } fuzzy_inputs;
-
-
-    /** fuzzy controller output variables **/
-    typedef struct fuzzy_output_struct
-    {
-
-        float steer;
-        float accel;
-        int gear;
-        float brake;
-
-    } fuzzy_outputs;
-
-
     /*
      * =====================================================================================
-     *        Class:  FuzzyController
-     *  Description:  This class has a fuzzy engine which accepts fuzzy_input_struct,
-     *                fuzzifies the input values, applies rules to them,
-     *                gets fuzzy outputs, defuzzifies them and then returns
-     *                the defuzzified outputs.
+     *        Class:  FuzzyliteReference
+     *  Description:  This class has the fuzzylite engine of fuzzy controller v1.0.0.
+     *                It processes inputs one after the other, as the engine of
+     *                fuzzy_rule_base.h does, and returns values of all outputs.
      * =====================================================================================
      */
-    class FuzzyController
+    class FuzzyliteReference
     {
         public:
 
-            FuzzyController();
-            ~FuzzyController();
+            FuzzyliteReference();
+            ~FuzzyliteReference();
+
+            // returns 1 if fuzzylite engine is ready, else 0 ( with the reason in message )
+            int is_ready(std::string * message) const;
 
-            // get fuzzy outputs for the given set of fuzzy inputs
-            const fuzzy_outputs & get_output(const fuzzy_inputs * m_fuzzy_inputs);
+            // run fuzzy engine for the given inputs and get values of its outputs
+            // ( in order of controller_fuzzy::output_index ) and whether each output
+            // had no activated term ( value is then previous or default value )
+            void get_values(const fuzzy_inputs * t_fuzzy_inputs,
+                    controller_fuzzy::scalar values[controller_fuzzy::OUTPUT_COUNT],
+                    int is_empty[controller_fuzzy::OUTPUT_COUNT]);
 
 
         private:
@@ -108,11 +89,8 @@ namespace controller
 
             // fuzzy engine
             fl::Engine * m_fuzzy_engine;
-            // fuzzy output values
-            fuzzy_outputs m_fuzzy_outputs; 
-
-            // recorded speed at last gear change
-            float m_speed_at_gear_change;
+            // output variables in order of controller_fuzzy::output_index
+            fl::OutputVariable * m_output_variables[controller_fuzzy::OUTPUT_COUNT];
 
 
             /** MEMBER FUNCTIONS **/
@@ -131,15 +109,14 @@ namespace controller
             void add_brake_rules();
 
             // copy constructor
-            FuzzyController(const FuzzyController &other);
+            FuzzyliteReference(const FuzzyliteReference &other);
 
             // assignment operator
-            FuzzyController& operator=(const FuzzyController &other);
+            FuzzyliteReference& operator=(const FuzzyliteReference &other);
 
-    };       /** class FuzzyController **/
+    };       /** class FuzzyliteReference **/
 
 }
 
-#endif      /** ifndef FUZZY_CONTROLLER_H_ **/
-
+#endif      /** ifndef FUZZYLITE_REFERENCE_H_ **/
 
@@ -0,0 +1,325 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * sim_car.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#include "sim_car.h"
+
+
+#define SIM_GRAVITY                  9.81f
+
+// engine gives its full power from this fraction of top speed of a gear
+#define FULL_POWER_SPEED_FRACTION    0.25f
+// least fraction of force of a higher gear below full power speed
+#define MIN_LOW_SPEED_FORCE_FRACTION 0.3f
+
+// speed along a barrier lost for each m/s of speed towards it
+#define BARRIER_FRICTION             0.5f
+
+
+void race_sim::get_default_car_params(sim_car_params & params)
+{
+    params.mass = 1200;
+    params.wheelbase = 2.7;
+    params.steer_lock = 21 * PI / 180;
+
+    params.max_power = 330000;
+    const float gear_speeds[SIM_GEARS] = {22, 35, 47, 58, 70, 84};
+    std::copy(gear_speeds, gear_speeds + SIM_GEARS, params.gear_speeds);
+    params.reverse_speed = 10;
+    params.max_brake_deceleration = 14;
+
+    params.drag = 0.45;
+    params.rolling_resistance = 0.015;
+    params.tyre_grip = 1.4;
+    params.outside_grip = 0.6;
+    params.outside_rolling_resistance = 0.1;
+    params.slide_decay = 2;
+
+    params.damage_per_impact = 5;
+    params.max_damage = 10000;
+}
+
+
+race_sim::sim_car::sim_car(sim_track & track, const sim_car_params & params) :
+    m_track(track),
+    m_params(params)
+{
+    m_seg = NULL;
+    m_distance = 0;
+    m_to_middle = 0;
+    m_heading = 0;
+    m_speed_x = 0;
+    m_speed_y = 0;
+    m_yaw_rate = 0;
+    m_accel_x = 0;
+    m_damage = 0;
+    m_distance_raced = 0;
+    m_lap_start_time = 0;
+}
+
+
+void race_sim::sim_car::reset(tCarElt * car, const float distance_to_start,
+        const float to_middle)
+{
+    // last segment ends at the start line
+    m_seg = m_track.get_track()->seg;
+    m_distance = m_seg->length - distance_to_start;
+    while(m_distance < 0)
+    {
+        m_seg = m_seg->prev;
+        m_distance += m_seg->length;
+    }
+
+    m_to_middle = to_middle;
+    m_heading = 0;
+    m_speed_x = 0;
+    m_speed_y = 0;
+    m_yaw_rate = 0;
+    m_accel_x = 0;
+    m_damage = 0;
+    m_distance_raced = 0;
+    m_lap_start_time = 0;
+
+    memset(&car->pub, 0, sizeof(car->pub));
+    memset(&car->race, 0, sizeof(car->race));
+    memset(&car->priv, 0, sizeof(car->priv));
+    memset(&car->ctrl, 0, sizeof(car->ctrl));
+    car->_steerLock = m_params.steer_lock;
+
+    set_car_values(car);
+}
+
+
+void race_sim::sim_car::update(tCarElt * car, const double dt, const double race_time)
+{
+    const float steer = std::max(-1.0f, std::min(1.0f, car->ctrl.steer));
+    const float accel = std::max(0.0f, std::min(1.0f, car->ctrl.accelCmd));
+    const float brake = std::max(0.0f, std::min(1.0f, car->ctrl.brakeCmd));
+
+    // grip and rolling resistance depend on whether the car is outside the track
+    const int is_outside = fabsf(m_to_middle) > m_seg->width / 2;
+    const float grip = is_outside ? m_params.outside_grip : m_params.tyre_grip;
+    const float grip_force = grip * m_params.mass * SIM_GRAVITY;
+    const float rolling_force = m_params.mass * SIM_GRAVITY * (is_outside ?
+            m_params.outside_rolling_resistance : m_params.rolling_resistance);
+
+    /**
+     * speed along the car - engine and drag change the speed, while brake
+     * and rolling resistance only slow the car down until it stops
+     **/
+    const float drive_force = get_engine_force(car->ctrl.gear, accel, grip_force)
+        - m_params.drag * m_speed_x * fabsf(m_speed_x);
+    const float resistance_force =
+        std::min(brake * m_params.max_brake_deceleration * m_params.mass, grip_force)
+        + rolling_force;
+
+    float speed_x = m_speed_x + drive_force / m_params.mass * dt;
+    const float resistance_speed = resistance_force / m_params.mass * dt;
+    speed_x = (fabsf(speed_x) <= resistance_speed) ? 0 :
+        speed_x - copysignf(resistance_speed, speed_x);
+    m_accel_x = (speed_x - m_speed_x) / dt;
+    m_speed_x = speed_x;
+
+    /**
+     * yaw rate of a bicycle model for the steer angle, as long as grip left
+     * after acceleration ( or braking ) allows. Lateral acceleration that grip
+     * doesn't allow makes the car slide sideways ( out of the curve ).
+     **/
+    const float max_lateral_accel = sqrtf(std::max(0.0f,
+                grip * grip * SIM_GRAVITY * SIM_GRAVITY - m_accel_x * m_accel_x));
+    const float wanted_yaw_rate = m_speed_x * tanf(steer * m_params.steer_lock)
+        / m_params.wheelbase;
+    const float wanted_lateral_accel = m_speed_x * wanted_yaw_rate;
+
+    m_yaw_rate = wanted_yaw_rate;
+    if(fabsf(wanted_lateral_accel) > max_lateral_accel)
+    {
+        m_yaw_rate *= max_lateral_accel / fabsf(wanted_lateral_accel);
+    }
+    const float slide_accel = wanted_lateral_accel - m_speed_x * m_yaw_rate;
+    m_speed_y += (-slide_accel - m_params.slide_decay * m_speed_y) * dt;
+
+    /**
+     * move along the track. Distance along middle of the track is covered
+     * faster on inner side of a curve.
+     **/
+    const float curvature = sim_track::get_curvature(m_seg);
+    const float cos_heading = cosf(m_heading);
+    const float sin_heading = sinf(m_heading);
+    const float speed_along_track = (m_speed_x * cos_heading - m_speed_y * sin_heading)
+        / (1 - curvature * m_to_middle);
+    const float speed_across_track = m_speed_x * sin_heading + m_speed_y * cos_heading;
+
+    m_heading += (m_yaw_rate - curvature * speed_along_track) * dt;
+    NORM_PI_PI(m_heading);
+    m_to_middle += speed_across_track * dt;
+    move(car, speed_along_track * dt, race_time);
+
+    // barriers are at same distance from both sides of the track
+    const float barrier_to_middle = m_seg->width / 2 + m_track.get_barrier_distance();
+    if(m_to_middle > barrier_to_middle)
+    {
+        hit_barrier(barrier_to_middle);
+    }
+    else if(m_to_middle < -barrier_to_middle)
+    {
+        hit_barrier(-barrier_to_middle);
+    }
+
+    if(m_damage > m_params.max_damage)
+    {
+        car->_state |= RM_CAR_STATE_ELIMINATED;
+    }
+
+    if(car->_laps > 0)
+    {
+        car->_curLapTime = race_time - m_lap_start_time;
+    }
+
+    set_car_values(car);
+}
+
+
+float race_sim::sim_car::get_engine_force(const int gear, const float accel,
+        const float grip) const
+{
+    if(gear == 0 || accel <= 0)
+    {
+        return 0;
+    }
+
+    const float top_speed = (gear > 0) ?
+        m_params.gear_speeds[std::min(gear, SIM_GEARS) - 1] : m_params.reverse_speed;
+    const float speed = (gear > 0) ? m_speed_x : -m_speed_x;
+
+    // engine is at its limit at top speed of the gear
+    if(speed >= top_speed)
+    {
+        return 0;
+    }
+
+    // force for full power, with less force from higher gears at low speed
+    const float full_power_speed = top_speed * FULL_POWER_SPEED_FRACTION;
+    float force = accel * m_params.max_power / std::max(speed, full_power_speed);
+    if(gear > 1 && speed < full_power_speed)
+    {
+        force *= std::max(MIN_LOW_SPEED_FORCE_FRACTION, speed / full_power_speed);
+    }
+
+    // tyres can't pass more force than their grip
+    force = std::min(force, grip);
+
+    return (gear > 0) ? force : -force;
+}
+
+
+void race_sim::sim_car::move(tCarElt * car, const float distance, const double race_time)
+{
+    m_distance += distance;
+    m_distance_raced += distance;
+
+    while(m_distance >= m_seg->length)
+    {
+        m_distance -= m_seg->length;
+        m_seg = m_seg->next;
+
+        // a lap starts at each crossing of the start line
+        if(m_seg->id == 0)
+        {
+            car->_laps++;
+            if(car->_laps > 1)
+            {
+                car->_lastLapTime = race_time - m_lap_start_time;
+                if(car->_bestLapTime == 0 || car->_lastLapTime < car->_bestLapTime)
+                {
+                    car->_bestLapTime = car->_lastLapTime;
+                }
+            }
+            m_lap_start_time = race_time;
+        }
+    }
+
+    while(m_distance < 0)
+    {
+        // lap is lost when the car goes back over the start line
+        if(m_seg->id == 0)
+        {
+            car->_laps--;
+        }
+
+        m_seg = m_seg->prev;
+        m_distance += m_seg->length;
+    }
+}
+
+
+void race_sim::sim_car::hit_barrier(const float barrier_to_middle)
+{
+    const float cos_heading = cosf(m_heading);
+    const float sin_heading = sinf(m_heading);
+    float speed_along = m_speed_x * cos_heading - m_speed_y * sin_heading;
+    const float speed_across = m_speed_x * sin_heading + m_speed_y * cos_heading;
+
+    // only speed towards the barrier hits it
+    if(speed_across * barrier_to_middle > 0)
+    {
+        m_damage += m_params.damage_per_impact * speed_across * speed_across;
+
+        speed_along -= copysignf(std::min(fabsf(speed_along),
+                    BARRIER_FRICTION * fabsf(speed_across)), speed_along);
+
+        // car keeps its heading and moves along the barrier
+        m_speed_x = speed_along * cos_heading;
+        m_speed_y = -speed_along * sin_heading;
+    }
+
+    m_to_middle = barrier_to_middle;
+}
+
+
+void race_sim::sim_car::set_car_values(tCarElt * car) const
+{
+    sim_track::get_position(m_seg, m_distance, m_to_middle, car->_trkPos);
+
+    float yaw = sim_track::get_tangent_angle(m_seg, m_distance) + m_heading;
+    NORM_PI_PI(yaw);
+    car->_yaw = yaw;
+
+    car->_speed_x = m_speed_x;
+    car->_speed_y = m_speed_y;
+    car->_yaw_rate = m_yaw_rate;
+    car->_accel_x = m_accel_x;
+    car->_accel_y = m_speed_x * m_yaw_rate;
+
+    car->_distRaced = m_distance_raced;
+    car->_dammage = (int) m_damage;
+    car->_gear = car->ctrl.gear;
+}
+
@@ -0,0 +1,176 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * sim_car.h
+ *
+ * Car of the headless simulator. It is a bicycle model moved along the track
+ * ( in distance along middle of the track, distance to middle and heading
+ * relative to the track ), with an engine of limited power, a grip limit of
+ * tyres ( the car slides when it asks for more ) and the rules -
+ *
+ *  - outside the sides of the track the car has less grip and more drag
+ *  - a car that hits a barrier loses its speed towards the barrier and gets
+ *    damage for it ( square of that speed times "damage_per_impact" )
+ *  - a car with more than "max_damage" damage is eliminated
+ *
+ * It is not TORCS physics, but it gives robots values in same units and of
+ * about same size as a TORCS car ( "cg-nascar-rwd" ) does.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  SIM_CAR_H_
+#define  SIM_CAR_H_
+
+
+#include <car.h>
+
+#include "sim_track.h"
+
+
+// number of forward gears
+#define SIM_GEARS                    6
+
+
+namespace race_sim
+{
+
+    /**
+     * parameters of the car model ( SI units )
+     **/
+    typedef struct sim_car_params_struct
+    {
+
+        float mass;                         // kg
+        float wheelbase;                    // m
+        float steer_lock;                   // rad
+
+        float max_power;                    // W
+        float gear_speeds[SIM_GEARS];       // top speed of each forward gear ( m/s )
+        float reverse_speed;                // top speed in reverse gear ( m/s )
+        float max_brake_deceleration;       // m/s2 with full brake ( within grip )
+
+        float drag;                         // N / ( m/s )2
+        float rolling_resistance;           // fraction of weight
+        float tyre_grip;                    // friction coefficient on the track
+        float outside_grip;                 // friction coefficient outside the track
+        float outside_rolling_resistance;   // fraction of weight outside the track
+        float slide_decay;                  // decay of sideways speed ( 1/s )
+
+        float damage_per_impact;            // damage per ( m/s )2 of impact speed
+        int max_damage;                     // car is eliminated after this damage
+
+    } sim_car_params;
+
+
+    /* fills parameters of a car close to "cg-nascar-rwd" of TORCS */
+    void get_default_car_params(sim_car_params & params);
+
+
+    /*
+     * ==========================================================================
+     *        Class:  sim_car
+     *  Description:  Moves a car with controls set by its robot ( ctrl of the
+     *                tCarElt ) and sets values of the tCarElt that robots read
+     *                ( position on the track, speeds, yaw, damage, laps ... ).
+     * ===========================================================================
+     */
+    class sim_car
+    {
+        public :
+
+            /** MEMBER FUNCTIONS **/
+
+            sim_car(sim_track & track, const sim_car_params & params);
+
+            /**
+             * places the car at rest at the given distance before the start line
+             * and distance to middle of the track, and resets the tCarElt
+             **/
+            void reset(tCarElt * car, const float distance_to_start, const float to_middle);
+
+            /**
+             * moves the car by "dt" seconds with its controls and updates its
+             * tCarElt. "race_time" is time at the end of the move ( for lap times ).
+             **/
+            void update(tCarElt * car, const double dt, const double race_time);
+
+
+        private :
+
+            /** MEMBER VARIABLES **/
+
+            sim_track & m_track;
+            sim_car_params m_params;
+
+            /* segment of the car and distance along middle of the track from its start */
+            tTrackSeg * m_seg;
+            float m_distance;
+            /* distance to middle of the track ( positive on left ) */
+            float m_to_middle;
+            /* heading relative to tangent of the track */
+            float m_heading;
+
+            /* speeds along and across the car and yaw rate */
+            float m_speed_x;
+            float m_speed_y;
+            float m_yaw_rate;
+            float m_accel_x;
+
+            /* damage and distance raced */
+            float m_damage;
+            double m_distance_raced;
+
+            /* time of start of current lap */
+            double m_lap_start_time;
+
+
+            /** MEMBER FUNCTIONS **/
+
+            /* returns force of the engine for the given gear and accel command */
+            float get_engine_force(const int gear, const float accel, const float grip) const;
+
+            /* moves the car along the track and counts laps */
+            void move(tCarElt * car, const float distance, const double race_time);
+
+            /**
+             * stops the car at a barrier it has gone past and adds damage for
+             * its speed towards the barrier
+             **/
+            void hit_barrier(const float barrier_to_middle);
+
+            /* sets values of the tCarElt from state of the car */
+            void set_car_values(tCarElt * car) const;
+
+            // restricted copy constructor
+            sim_car(const sim_car &other) = delete;
+
+            // restricted assignment operator
+            sim_car& operator=(const sim_car &other) = delete;
+
+    };
+
+}
+
+
+#endif      /* ifndef SIM_CAR_H_ */
+
@@ -0,0 +1,263 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * sim_main.cpp
+ *
+ * Runs races of a robot module ( SIM_ROBOT_MODULE, set by Makefile ) in the
+ * headless simulator, as fast as the robot and the car model allow, and
+ * reports results of each race and time taken by "rbDrive" of the robot.
+ *
+ *  usage : <robot>_sim [-t <track file>] [-n <races>] [-l <laps>] [-c <cars>]
+ *                      [-m <max race time>] [-q]
+ *
+ *  -t  track file ( default is SIM_DEFAULT_TRACK_FILE )
+ *  -n  races run one after the other ( e.g. training races of car222 )
+ *  -l  laps of each race
+ *  -c  cars of the robot module in each race
+ *  -m  race ends after this race time ( seconds ) even if cars are racing
+ *  -q  results of each race are not printed ( only the summary )
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+#include "sim_track.h"
+#include "sim_car.h"
+#include "sim_race.h"
+
+
+#ifndef SIM_ROBOT_MODULE
+#error "SIM_ROBOT_MODULE should be set to entry point of a robot module ( e.g. car222 )"
+#endif
+
+#define SIM_STRING_VALUE(x)          #x
+#define SIM_STRING(x)                SIM_STRING_VALUE(x)
+
+// track file used when none is given ( from the sim directory of a robot )
+#define SIM_DEFAULT_TRACK_FILE       "../../common/sim/tracks/sim-speedway.trk"
+
+
+/* entry point of the robot module */
+extern "C" int SIM_ROBOT_MODULE(tModInfo * modInfo);
+
+
+/**
+ * options of the simulator
+ **/
+typedef struct sim_options_struct
+{
+
+    std::string track_file_name;
+    int races;
+    int quiet;
+    race_sim::sim_race_config race_config;
+
+} sim_options;
+
+
+static void print_usage(const char * program_name)
+{
+    printf("usage : %s [-t <track file>] [-n <races>] [-l <laps>] [-c <cars>]"
+            " [-m <max race time>] [-q]\n", program_name);
+}
+
+
+/**
+ * reads options to "options" and returns 0, or -1 if an option is not valid
+ **/
+static int read_options(int argc, char * argv[], sim_options & options)
+{
+    options.track_file_name = SIM_DEFAULT_TRACK_FILE;
+    options.races = 1;
+    options.quiet = 0;
+    options.race_config.car_count = 1;
+    options.race_config.laps = 3;
+    options.race_config.max_time = 3600;
+
+    int argument = 1;
+    while(argument < argc)
+    {
+        const std::string option = argv[argument];
+        if(option == "-q")
+        {
+            options.quiet = 1;
+            argument++;
+            continue;
+        }
+
+        if(argument + 1 >= argc)
+        {
+            return -1;
+        }
+
+        const char * value = argv[argument + 1];
+        if(option == "-t")
+        {
+            options.track_file_name = value;
+        }
+        else if(option == "-n")
+        {
+            options.races = atoi(value);
+        }
+        else if(option == "-l")
+        {
+            options.race_config.laps = atoi(value);
+        }
+        else if(option == "-c")
+        {
+            options.race_config.car_count = atoi(value);
+        }
+        else if(option == "-m")
+        {
+            options.race_config.max_time = atof(value);
+        }
+        else
+        {
+            return -1;
+        }
+        argument += 2;
+    }
+
+    if(options.races <= 0 || options.race_config.laps <= 0 ||
+            options.race_config.car_count <= 0 || options.race_config.car_count > MAX_MOD_ITF ||
+            options.race_config.max_time <= 0)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/* returns state of a car at end of a race as text */
+static const char * get_state_text(const int state)
+{
+    if(state & RM_CAR_STATE_FINISH)
+    {
+        return "finished";
+    }
+    if(state & RM_CAR_STATE_ELIMINATED)
+    {
+        return "eliminated ( damage )";
+    }
+    if(state & RM_CAR_STATE_NO_SIMU)
+    {
+        return "stopped by robot";
+    }
+
+    return "racing at time limit";
+}
+
+
+int main(int argc, char * argv[])
+{
+    using namespace race_sim;
+
+    sim_options options;
+    if(read_options(argc, argv, options) != 0)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    sim_track track;
+    if(track.load_from_file(options.track_file_name.c_str()) != 0)
+    {
+        return 1;
+    }
+
+    sim_car_params car_params;
+    get_default_car_params(car_params);
+
+    sim_race race(track, car_params);
+    const int robot_count = race.load_robot(SIM_ROBOT_MODULE);
+    if(robot_count <= 0)
+    {
+        printf("couldn't load robot module \"%s\"\n", SIM_STRING(SIM_ROBOT_MODULE));
+        return 1;
+    }
+    if(options.race_config.car_count > robot_count)
+    {
+        printf("robot module \"%s\" has only %d cars\n",
+                SIM_STRING(SIM_ROBOT_MODULE), robot_count);
+        options.race_config.car_count = robot_count;
+    }
+
+    printf("track \"%s\" - %d segments, %.1f m\n", track.get_track()->name,
+            track.get_track()->nseg, track.get_length());
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    sim_race_stats total_stats = {};
+    std::vector<sim_car_result> results;
+    for(int race_number = 1; race_number <= options.races; race_number++)
+    {
+        sim_race_stats stats;
+        race.run(options.race_config, results, stats);
+
+        total_stats.race_time += stats.race_time;
+        total_stats.steps += stats.steps;
+        total_stats.drive_calls += stats.drive_calls;
+        total_stats.drive_seconds += stats.drive_seconds;
+        total_stats.physics_seconds += stats.physics_seconds;
+
+        if(options.quiet)
+        {
+            continue;
+        }
+
+        printf("race %d - %.2f s race time, %lld steps ( rbDrive %.3f s, car model %.3f s )\n",
+                race_number, stats.race_time, stats.steps,
+                stats.drive_seconds, stats.physics_seconds);
+        for(size_t i = 0; i < results.size(); i++)
+        {
+            printf("    car %lu - %d laps, %.1f m, best lap %.2f s, finish %.2f s,"
+                    " damage %d, off track %.2f s, %s\n", i + 1, results[i].laps,
+                    results[i].distance_raced, results[i].best_lap_time,
+                    results[i].finish_time, results[i].damage, results[i].off_track_time,
+                    get_state_text(results[i].state));
+        }
+    }
+
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    const double wall_seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+
+    printf("%d races - %.1f s race time in %.3f s ( %.0f times real time ),"
+            " %lld rbDrive calls ( %.2f us each ), car model %.2f us per step\n",
+            options.races, total_stats.race_time, wall_seconds,
+            (wall_seconds > 0) ? total_stats.race_time / wall_seconds : 0.0,
+            total_stats.drive_calls,
+            (total_stats.drive_calls == 0) ? 0.0 :
+            total_stats.drive_seconds * 1e6 / total_stats.drive_calls,
+            (total_stats.steps == 0) ? 0.0 :
+            total_stats.physics_seconds * 1e6 / total_stats.steps);
+
+    return 0;
+}
+
@@ -0,0 +1,247 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * sim_race.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+
+#include "sim_race.h"
+
+
+// race manager of the race that is running ( robots end training races with it )
+tRmInfo * ReInfo = NULL;
+
+
+namespace
+{
+    /* returns seconds of monotonic clock */
+    double get_clock_seconds()
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        return now.tv_sec + now.tv_nsec * 1e-9;
+    }
+}
+
+
+race_sim::sim_race::sim_race(sim_track & track, const sim_car_params & params) :
+    m_track(track),
+    m_params(params)
+{
+    memset(m_modules, 0, sizeof(m_modules));
+    memset(m_robots, 0, sizeof(m_robots));
+    m_robot_count = 0;
+}
+
+
+race_sim::sim_race::~sim_race()
+{
+    for(int i = 0; i < MAX_MOD_ITF; i++)
+    {
+        free(m_modules[i].name);
+        free(m_modules[i].desc);
+    }
+}
+
+
+int race_sim::sim_race::load_robot(sim_module_entry module_entry)
+{
+    if(module_entry(m_modules) != 0)
+    {
+        return -1;
+    }
+
+    // interfaces are filled from the first one
+    m_robot_count = 0;
+    while(m_robot_count < MAX_MOD_ITF && m_modules[m_robot_count].name != NULL)
+    {
+        tModInfo & module = m_modules[m_robot_count];
+        if(module.fctInit(module.index, &m_robots[m_robot_count]) != 0)
+        {
+            return -1;
+        }
+        m_robot_count++;
+    }
+
+    return m_robot_count;
+}
+
+
+int race_sim::sim_race::run(const sim_race_config & config,
+        std::vector<sim_car_result> & results, sim_race_stats & stats)
+{
+    const int car_count = std::min(config.car_count, m_robot_count);
+    if(car_count <= 0)
+    {
+        return -1;
+    }
+
+    memset(&stats, 0, sizeof(stats));
+
+    std::vector<tCarElt> cars(car_count);
+    std::vector<tCarElt *> car_pointers(car_count);
+    std::vector<sim_car *> sim_cars(car_count);
+    std::vector<double> finish_times(car_count, 0);
+    std::vector<double> off_track_times(car_count, 0);
+
+    tSituation situation;
+    memset(&situation, 0, sizeof(situation));
+    situation._ncars = car_count;
+    situation._totLaps = config.laps;
+    situation._raceState = RM_RACE_RUNNING;
+    situation.deltaTime = SIM_ROBOT_STEP;
+    situation.cars = &car_pointers[0];
+
+    tRmInfo race_info;
+    race_info.carList = &cars[0];
+    race_info.s = &situation;
+    race_info.track = m_track.get_track();
+    ReInfo = &race_info;
+
+    // cars start one behind the other, on alternate sides of the track
+    for(int i = 0; i < car_count; i++)
+    {
+        memset(&cars[i], 0, sizeof(tCarElt));
+        cars[i].index = i;
+        strncpy(cars[i]._name, m_modules[i].name, sizeof(cars[i]._name) - 1);
+        car_pointers[i] = &cars[i];
+
+        const float to_middle = (car_count == 1) ? 0 :
+            ((i % 2 == 0) ? SIM_GRID_TO_MIDDLE : -SIM_GRID_TO_MIDDLE);
+        sim_cars[i] = new sim_car(m_track, m_params);
+        sim_cars[i]->reset(&cars[i], SIM_GRID_DISTANCE * (i + 1), to_middle);
+    }
+
+    for(int i = 0; i < car_count; i++)
+    {
+        void * car_settings = NULL;
+        m_robots[i].rbNewTrack(m_robots[i].index, m_track.get_track(), NULL,
+                &car_settings, &situation);
+    }
+    for(int i = 0; i < car_count; i++)
+    {
+        m_robots[i].rbNewRace(m_robots[i].index, &cars[i], &situation);
+    }
+
+    const double physics_step = SIM_ROBOT_STEP / SIM_PHYSICS_STEPS;
+    while(!(situation._raceState & RM_RACE_ENDED) && situation.currentTime < config.max_time)
+    {
+        const double step_start_time = situation.currentTime;
+        situation.currentTime += SIM_ROBOT_STEP;
+
+        // robots set controls of their cars
+        const double drive_start = get_clock_seconds();
+        for(int i = 0; i < car_count; i++)
+        {
+            if(is_racing(cars[i]))
+            {
+                m_robots[i].rbDrive(m_robots[i].index, &cars[i], &situation);
+                stats.drive_calls++;
+            }
+        }
+
+        // cars are moved with those controls until robots are called again
+        const double physics_start = get_clock_seconds();
+        for(int step = 1; step <= SIM_PHYSICS_STEPS; step++)
+        {
+            for(int i = 0; i < car_count; i++)
+            {
+                if(is_racing(cars[i]))
+                {
+                    sim_cars[i]->update(&cars[i], physics_step,
+                            step_start_time + step * physics_step);
+                }
+            }
+        }
+        const double physics_end = get_clock_seconds();
+
+        stats.drive_seconds += physics_start - drive_start;
+        stats.physics_seconds += physics_end - physics_start;
+        stats.steps++;
+
+        // a car finishes when it crosses the start line after its last lap
+        int racing_cars = 0;
+        for(int i = 0; i < car_count; i++)
+        {
+            if(is_racing(cars[i]) &&
+                    (cars[i]._trkPos.toLeft < 0 || cars[i]._trkPos.toRight < 0))
+            {
+                off_track_times[i] += SIM_ROBOT_STEP;
+            }
+
+            if(is_racing(cars[i]) && cars[i]._laps > config.laps)
+            {
+                cars[i]._state |= RM_CAR_STATE_FINISH;
+                finish_times[i] = situation.currentTime;
+            }
+            racing_cars += is_racing(cars[i]);
+        }
+
+        if(racing_cars == 0)
+        {
+            situation._raceState = RM_RACE_ENDED;
+        }
+    }
+    stats.race_time = situation.currentTime;
+
+    for(int i = 0; i < car_count; i++)
+    {
+        m_robots[i].rbEndRace(m_robots[i].index, &cars[i], &situation);
+    }
+    for(int i = 0; i < car_count; i++)
+    {
+        m_robots[i].rbShutdown(m_robots[i].index);
+    }
+
+    results.resize(car_count);
+    for(int i = 0; i < car_count; i++)
+    {
+        results[i].laps = std::max(0, cars[i]._laps - 1);
+        results[i].distance_raced = cars[i]._distRaced;
+        results[i].damage = cars[i]._dammage;
+        results[i].off_track_time = off_track_times[i];
+        results[i].best_lap_time = cars[i]._bestLapTime;
+        results[i].finish_time = finish_times[i];
+        results[i].state = cars[i]._state;
+
+        delete sim_cars[i];
+    }
+
+    ReInfo = NULL;
+
+    return 0;
+}
+
+
+int race_sim::sim_race::is_racing(const tCarElt & car)
+{
+    return !(car._state &
+            (RM_CAR_STATE_NO_SIMU | RM_CAR_STATE_FINISH | RM_CAR_STATE_ELIMINATED));
+}
+
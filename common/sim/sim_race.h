@@ -0,0 +1,183 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * sim_race.h
+ *
+ * Races of the headless simulator. A robot module ( car111 or car222 ) is
+ * linked with the simulator and driven through its TORCS interface, in the
+ * same order as TORCS calls it - rbNewTrack, rbNewRace, rbDrive at each
+ * robot step, rbEndRace and rbShutdown. Cars do not collide with each other.
+ *
+ * The module is not unloaded after a race ( as it is in TORCS ), so its
+ * static values are kept from one race to the next.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  SIM_RACE_H_
+#define  SIM_RACE_H_
+
+
+#include <vector>
+
+#include <tgf.h>
+#include <robot.h>
+
+#include "sim_track.h"
+#include "sim_car.h"
+
+
+// time between calls of robots ( seconds, same as in TORCS )
+#define SIM_ROBOT_STEP               0.02
+// steps of car model between calls of robots
+#define SIM_PHYSICS_STEPS            10
+
+// distance between cars on the starting grid and from middle of the track
+#define SIM_GRID_DISTANCE            10
+#define SIM_GRID_TO_MIDDLE           2
+
+
+namespace race_sim
+{
+
+    /* entry point of a robot module ( e.g. "car222" ) */
+    typedef int (*sim_module_entry)(tModInfo * modInfo);
+
+
+    /**
+     * settings of a race
+     **/
+    typedef struct sim_race_config_struct
+    {
+
+        // cars in the race ( interfaces of the module, from the first one )
+        int car_count;
+        // laps of the race
+        int laps;
+        // race ends after this race time ( seconds ) even if cars are racing
+        double max_time;
+
+    } sim_race_config;
+
+
+    /**
+     * result of a car in a race
+     **/
+    typedef struct sim_car_result_struct
+    {
+
+        // laps completed, distance raced and damage
+        int laps;
+        float distance_raced;
+        int damage;
+        // race time with the car outside sides of the track
+        double off_track_time;
+        // best lap time and race time at finish ( 0 if not finished )
+        double best_lap_time;
+        double finish_time;
+        // state of the car at end of the race ( RM_CAR_STATE_* )
+        int state;
+
+    } sim_car_result;
+
+
+    /**
+     * time taken by a race
+     **/
+    typedef struct sim_race_stats_struct
+    {
+
+        // race time ( seconds ) and robot steps
+        double race_time;
+        long long int steps;
+        // calls of "rbDrive" and wall clock time spent in them
+        long long int drive_calls;
+        double drive_seconds;
+        // wall clock time spent in car model
+        double physics_seconds;
+
+    } sim_race_stats;
+
+
+    /*
+     * ==========================================================================
+     *        Class:  sim_race
+     *  Description:  Runs races of cars of a robot module on a track ( much
+     *                faster than real time, as nothing waits for the clock ).
+     * ===========================================================================
+     */
+    class sim_race
+    {
+        public :
+
+            /** MEMBER FUNCTIONS **/
+
+            sim_race(sim_track & track, const sim_car_params & params);
+
+            ~sim_race();
+
+            /**
+             * calls entry point of the robot module and init function of each
+             * of its interfaces ( as TORCS does when it loads the module ).
+             * Returns number of interfaces ( cars ) or -1 on failure.
+             **/
+            int load_robot(sim_module_entry module_entry);
+
+            /**
+             * runs a race with the given settings and fills result of each car
+             * and time taken. Returns 0 on success and -1 if no robot is loaded.
+             **/
+            int run(const sim_race_config & config, std::vector<sim_car_result> & results,
+                    sim_race_stats & stats);
+
+
+        private :
+
+            /** MEMBER VARIABLES **/
+
+            sim_track & m_track;
+            sim_car_params m_params;
+
+            /* interfaces of the robot module and robots of the interfaces */
+            tModInfo m_modules[MAX_MOD_ITF];
+            tRobotItf m_robots[MAX_MOD_ITF];
+            int m_robot_count;
+
+
+            /** MEMBER FUNCTIONS **/
+
+            /* returns non-zero if the car is still racing */
+            static int is_racing(const tCarElt & car);
+
+            // restricted copy constructor
+            sim_race(const sim_race &other) = delete;
+
+            // restricted assignment operator
+            sim_race& operator=(const sim_race &other) = delete;
+
+    };
+
+}
+
+
+#endif      /* ifndef SIM_RACE_H_ */
+
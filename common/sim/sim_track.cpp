@@ -0,0 +1,319 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * sim_track.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <robottools.h>
+
+#include "sim_track.h"
+
+
+// maximum length of a line of track file
+#define TRACK_LINE_BUFFER_SIZE       256
+
+
+race_sim::sim_track::sim_track()
+{
+    memset(&m_track, 0, sizeof(m_track));
+    m_barrier_distance = SIM_DEFAULT_BARRIER_DISTANCE;
+}
+
+
+int race_sim::sim_track::load_from_file(const char * file_name)
+{
+    FILE * track_file = fopen(file_name, "r");
+    if(track_file == NULL)
+    {
+        printf("couldn't open track file \"%s\"\n", file_name);
+        return -1;
+    }
+
+    m_segments.clear();
+    m_name = "sim-track";
+    m_file_name = file_name;
+    m_barrier_distance = SIM_DEFAULT_BARRIER_DISTANCE;
+
+    float width = SIM_DEFAULT_TRACK_WIDTH;
+    float step_length = 0;
+
+    char line[TRACK_LINE_BUFFER_SIZE];
+    int line_number = 0;
+    int is_valid = 1;
+    while(is_valid && fgets(line, sizeof(line), track_file) != NULL)
+    {
+        line_number++;
+
+        // rest of the line after "#" is a comment
+        char * comment = strchr(line, '#');
+        if(comment != NULL)
+        {
+            *comment = '\0';
+        }
+
+        char keyword[TRACK_LINE_BUFFER_SIZE];
+        char text[TRACK_LINE_BUFFER_SIZE];
+        float first_value = 0;
+        float second_value = 0;
+        if(sscanf(line, "%255s", keyword) != 1)
+        {
+            continue;
+        }
+
+        if(strcmp(keyword, "name") == 0 && sscanf(line, "%*s %255s", text) == 1)
+        {
+            m_name = text;
+        }
+        else if(strcmp(keyword, "width") == 0 &&
+                sscanf(line, "%*s %f", &first_value) == 1 && first_value > 0)
+        {
+            width = first_value;
+        }
+        else if(strcmp(keyword, "barrier") == 0 &&
+                sscanf(line, "%*s %f", &first_value) == 1 && first_value >= 0)
+        {
+            m_barrier_distance = first_value;
+        }
+        else if(strcmp(keyword, "step") == 0 &&
+                sscanf(line, "%*s %f", &first_value) == 1 && first_value >= 0)
+        {
+            step_length = first_value;
+        }
+        else if(strcmp(keyword, "straight") == 0 &&
+                sscanf(line, "%*s %f", &first_value) == 1 && first_value > 0)
+        {
+            add_segment(TR_STR, width, first_value, 0);
+        }
+        else if((strcmp(keyword, "left") == 0 || strcmp(keyword, "right") == 0) &&
+                sscanf(line, "%*s %f %f", &first_value, &second_value) == 2 &&
+                second_value > 0)
+        {
+            // barrier on inner side of a curve should not go past its center
+            if(first_value <= width / 2 + m_barrier_distance)
+            {
+                printf("track file \"%s\" - radius of curve at line %d should be more"
+                        " than half width of the track and barrier distance\n",
+                        file_name, line_number);
+                is_valid = 0;
+                continue;
+            }
+
+            // a curve is split into segments of equal length ( as TORCS
+            // splits curves into steps )
+            const int type = (keyword[0] == 'l') ? TR_LFT : TR_RGT;
+            const float length = first_value * second_value * PI / 180;
+            const int pieces = (step_length > 0) ? (int) ceilf(length / step_length) : 1;
+            for(int i = 0; i < pieces; i++)
+            {
+                add_segment(type, width, length / pieces, first_value);
+            }
+        }
+        else
+        {
+            printf("track file \"%s\" - entry at line %d is not valid\n",
+                    file_name, line_number);
+            is_valid = 0;
+        }
+    }
+
+    fclose(track_file);
+
+    if(!is_valid || m_segments.empty())
+    {
+        m_segments.clear();
+        return -1;
+    }
+
+    link_segments();
+
+    const float closing_distance = get_closing_distance();
+    if(closing_distance > SIM_TRACK_CLOSE_TOLERANCE)
+    {
+        printf("track file \"%s\" - end of the track is %.2f m away from its start"
+                " ( cars are moved from end to start )\n", file_name, closing_distance);
+    }
+
+    return 0;
+}
+
+
+tTrack * race_sim::sim_track::get_track()
+{
+    return &m_track;
+}
+
+
+float race_sim::sim_track::get_length() const
+{
+    return m_track.length;
+}
+
+
+float race_sim::sim_track::get_barrier_distance() const
+{
+    return m_barrier_distance;
+}
+
+
+float race_sim::sim_track::get_curvature(const tTrackSeg * seg)
+{
+    if(seg->type == TR_STR)
+    {
+        return 0;
+    }
+
+    return (seg->type == TR_LFT) ? 1 / seg->radius : -1 / seg->radius;
+}
+
+
+float race_sim::sim_track::get_tangent_angle(const tTrackSeg * seg, const float distance)
+{
+    float angle = seg->angle[TR_ZS] + get_curvature(seg) * distance;
+    NORM_PI_PI(angle);
+
+    return angle;
+}
+
+
+void race_sim::sim_track::get_position(tTrackSeg * seg, const float distance,
+        const float to_middle, tTrkLocPos & position)
+{
+    position.seg = seg;
+    position.type = TR_LPOS_MAIN;
+
+    // distance from start of a curve is an arc ( as in TORCS )
+    position.toStart = (seg->type == TR_STR) ? distance : distance / seg->radius;
+    position.toMiddle = to_middle;
+    position.toRight = seg->width / 2 + to_middle;
+    position.toLeft = seg->width / 2 - to_middle;
+}
+
+
+void race_sim::sim_track::add_segment(const int type, const float width,
+        const float length, const float radius)
+{
+    tTrackSeg seg;
+    memset(&seg, 0, sizeof(seg));
+
+    seg.type = type;
+    seg.width = width;
+    seg.length = length;
+
+    if(type != TR_STR)
+    {
+        seg.radius = radius;
+        seg.arc = length / radius;
+        // inner side of a curve has smaller radius
+        seg.radiusr = (type == TR_LFT) ? radius + width / 2 : radius - width / 2;
+        seg.radiusl = (type == TR_LFT) ? radius - width / 2 : radius + width / 2;
+    }
+
+    m_segments.push_back(seg);
+}
+
+
+void race_sim::sim_track::link_segments()
+{
+    const int segment_count = m_segments.size();
+
+    float length_from_start = 0;
+    float angle = 0;
+    for(int i = 0; i < segment_count; i++)
+    {
+        tTrackSeg & seg = m_segments[i];
+
+        seg.id = i;
+        seg.next = &m_segments[(i + 1) % segment_count];
+        seg.prev = &m_segments[(i + segment_count - 1) % segment_count];
+
+        seg.lgfromstart = length_from_start;
+        NORM_PI_PI(angle);
+        seg.angle[TR_ZS] = angle;
+
+        length_from_start += seg.length;
+        angle += get_curvature(&seg) * seg.length;
+    }
+
+    m_track.name = m_name.c_str();
+    m_track.filename = m_file_name.c_str();
+    m_track.nseg = segment_count;
+    m_track.length = length_from_start;
+    m_track.width = m_segments[0].width;
+    m_track.seg = &m_segments[segment_count - 1];
+}
+
+
+float race_sim::sim_track::get_closing_distance() const
+{
+    double x = 0;
+    double y = 0;
+    for(size_t i = 0; i < m_segments.size(); i++)
+    {
+        const tTrackSeg & seg = m_segments[i];
+        const double start_angle = seg.angle[TR_ZS];
+
+        if(seg.type == TR_STR)
+        {
+            x += seg.length * cos(start_angle);
+            y += seg.length * sin(start_angle);
+        }
+        else
+        {
+            const double curvature = get_curvature(&seg);
+            const double end_angle = start_angle + curvature * seg.length;
+            x += (sin(end_angle) - sin(start_angle)) / curvature;
+            y -= (cos(end_angle) - cos(start_angle)) / curvature;
+        }
+    }
+
+    return sqrt(x * x + y * y);
+}
+
+
+/* same as "RtTrackSideTgAngleL" of TORCS for a flat track */
+tdble RtTrackSideTgAngleL(tTrkLocPos * p)
+{
+    tdble angle = p->seg->angle[TR_ZS];
+
+    switch(p->seg->type)
+    {
+        case TR_LFT :
+            angle += p->toStart;
+            break;
+        case TR_RGT :
+            angle -= p->toStart;
+            break;
+        default :
+            break;
+    }
+
+    NORM_PI_PI(angle);
+
+    return angle;
+}
+
@@ -0,0 +1,159 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * sim_track.h
+ *
+ * Track of the headless simulator, built from straight and arc segments of
+ * a track file. A track file has one entry on each line ( "#" starts a
+ * comment ) -
+ *
+ *    name      <name of the track>
+ *    width     <width of the track>
+ *    barrier   <distance from sides of the track to its barriers>
+ *    step      <curves are split into segments of at most this length ( 0 for no split )>
+ *    straight  <length>
+ *    left      <radius> <arc in degrees>
+ *    right     <radius> <arc in degrees>
+ *
+ * Lengths are in meters. Settings are used for the segments after them.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  SIM_TRACK_H_
+#define  SIM_TRACK_H_
+
+
+#include <string>
+#include <vector>
+
+#include <track.h>
+
+
+// default settings of a track file
+#define SIM_DEFAULT_TRACK_WIDTH      15
+#define SIM_DEFAULT_BARRIER_DISTANCE 5
+
+// start and end of a track should meet within this distance ( meters )
+#define SIM_TRACK_CLOSE_TOLERANCE    1.0
+
+
+namespace race_sim
+{
+
+    /*
+     * ==========================================================================
+     *        Class:  sim_track
+     *  Description:  A flat track of straights and arcs as TORCS segments
+     *                ( tTrackSeg ) in a ring, so robots see same values as on
+     *                a TORCS track. Positions on the track are distances along
+     *                middle of the track and distances to middle of the track.
+     * ===========================================================================
+     */
+    class sim_track
+    {
+        public :
+
+            /** MEMBER FUNCTIONS **/
+
+            sim_track();
+
+            /**
+             * loads segments from the given track file ( see above ).
+             * Returns 0 on success and -1 if the file couldn't be read or
+             * has an entry that is not valid.
+             **/
+            int load_from_file(const char * file_name);
+
+            /* returns the track as seen by robots */
+            tTrack * get_track();
+
+            /* returns length of middle of the track */
+            float get_length() const;
+
+            /* returns distance from sides of the track to its barriers */
+            float get_barrier_distance() const;
+
+            /**
+             * returns curvature of the given segment ( 1 / radius, positive
+             * for left curves and 0 for straights )
+             **/
+            static float get_curvature(const tTrackSeg * seg);
+
+            /**
+             * returns angle of tangent of middle of the segment at the given
+             * distance from its start
+             **/
+            static float get_tangent_angle(const tTrackSeg * seg, const float distance);
+
+            /**
+             * fills position on the track for the given distance from start of
+             * the segment and distance to middle of the track
+             **/
+            static void get_position(tTrackSeg * seg, const float distance,
+                    const float to_middle, tTrkLocPos & position);
+
+
+        private :
+
+            /** MEMBER VARIABLES **/
+
+            /* track as seen by robots and its segments */
+            tTrack m_track;
+            std::vector<tTrackSeg> m_segments;
+
+            /* name and file name of the track */
+            std::string m_name;
+            std::string m_file_name;
+
+            /* distance from sides of the track to its barriers */
+            float m_barrier_distance;
+
+
+            /** MEMBER FUNCTIONS **/
+
+            /* adds a segment with given type, length and radius ( 0 for straight ) */
+            void add_segment(const int type, const float width, const float length,
+                    const float radius);
+
+            /* links segments in a ring and sets their angles and distances */
+            void link_segments();
+
+            /**
+             * returns distance between start and end of the track ( track
+             * should be a closed loop )
+             **/
+            float get_closing_distance() const;
+
+            // restricted copy constructor
+            sim_track(const sim_track &other) = delete;
+
+            // restricted assignment operator
+            sim_track& operator=(const sim_track &other) = delete;
+
+    };
+
+}
+
+
+#endif      /* ifndef SIM_TRACK_H_ */
+
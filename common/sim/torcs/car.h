@@ -0,0 +1,169 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * car.h
+ *
+ * Stand-in for "car.h" of TORCS used by the headless simulator ( see tgf.h ).
+ * Only fields that robots read ( or set ) are kept and they are reached with
+ * same macros as in TORCS ( "_speed_x", "_trkPos" ... ).
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  SIM_TORCS_CAR_H_
+#define  SIM_TORCS_CAR_H_
+
+
+#include "track.h"
+
+
+// states of a car
+#define RM_CAR_STATE_DNF             0x00000001     // car did not finish
+#define RM_CAR_STATE_PULLUP          0x00000002
+#define RM_CAR_STATE_PULLSIDE        0x00000004
+#define RM_CAR_STATE_PULLDN          0x00000008
+#define RM_CAR_STATE_SIMU_NO_PIT     0x00000010
+#define RM_CAR_STATE_OUT             RM_CAR_STATE_DNF
+#define RM_CAR_STATE_NO_SIMU         0x000000FF     // car is not simulated ( or driven )
+#define RM_CAR_STATE_FINISH          0x00000100     // car has finished the race
+#define RM_CAR_STATE_ELIMINATED      0x00000800     // car has too much damage
+
+
+/**
+ * position ( or speed or acceleration ) of a car
+ **/
+typedef struct
+{
+
+    tdble x, y, z;                  // along axes of the car ( x forward, y left )
+    tdble xy;
+    tdble ax, ay, az;               // around axes ( az is yaw )
+
+} tPosd;
+
+/* position, speed and acceleration of center of gravity */
+typedef struct
+{
+
+    tPosd pos;
+    tPosd vel;
+    tPosd acc;
+
+} tDynPt;
+
+
+/* values of the car that don't change during the race */
+typedef struct
+{
+
+    char name[32];
+    tdble steerLock;                // steer lock angle ( in radians )
+
+} tInitCar;
+
+#define _name           info.name
+#define _steerLock      info.steerLock
+
+
+/* values of the car that other cars may see */
+typedef struct
+{
+
+    tDynPt DynGC;                   // center of gravity
+    tTrkLocPos trkPos;              // position on the track
+    int state;                      // state of the car ( RM_CAR_STATE_* )
+
+} tPublicCar;
+
+#define _yaw            pub.DynGC.pos.az
+#define _speed_x        pub.DynGC.vel.x
+#define _speed_y        pub.DynGC.vel.y
+#define _yaw_rate       pub.DynGC.vel.az
+#define _accel_x        pub.DynGC.acc.x
+#define _accel_y        pub.DynGC.acc.y
+#define _trkPos         pub.trkPos
+#define _state          pub.state
+
+
+/* race values of the car */
+typedef struct
+{
+
+    int laps;                       // laps started ( 1 after first crossing of start line )
+    tdble distRaced;                // distance raced
+    double curLapTime;              // time of current lap
+    double lastLapTime;             // time of last lap
+    double bestLapTime;             // time of best lap
+
+} tCarRaceInfo;
+
+#define _laps           race.laps
+#define _distRaced      race.distRaced
+#define _curLapTime     race.curLapTime
+#define _lastLapTime    race.lastLapTime
+#define _bestLapTime    race.bestLapTime
+
+
+/* values of the car that only the robot sees */
+typedef struct
+{
+
+    int gear;                       // current gear
+    int dammage;                    // damage of the car
+
+} tPrivCar;
+
+#define _gear           priv.gear
+#define _dammage        priv.dammage
+
+
+/* controls set by the robot */
+typedef struct
+{
+
+    tdble steer;                    // steer ( -1 for full right to 1 for full left )
+    tdble accelCmd;                 // accelerator pedal ( 0 to 1 )
+    tdble brakeCmd;                 // brake pedal ( 0 to 1 )
+    tdble clutchCmd;                // clutch pedal ( 0 to 1 )
+    int gear;                       // gear ( -1 for reverse, 0 for neutral )
+
+} tCarCtrl;
+
+
+/**
+ * a car in the race
+ **/
+typedef struct CarElt
+{
+
+    int index;                      // index of the car in the race
+    tInitCar info;
+    tPublicCar pub;
+    tCarRaceInfo race;
+    tPrivCar priv;
+    tCarCtrl ctrl;
+
+} tCarElt;
+
+
+#endif      /* ifndef SIM_TORCS_CAR_H_ */
+
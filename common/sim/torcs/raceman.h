@@ -0,0 +1,87 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * raceman.h
+ *
+ * Stand-in for "raceman.h" of TORCS used by the headless simulator ( see tgf.h ).
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  SIM_TORCS_RACEMAN_H_
+#define  SIM_TORCS_RACEMAN_H_
+
+
+#include "car.h"
+#include "track.h"
+
+
+// states of the race
+#define RM_RACE_RUNNING              0x00000001
+#define RM_RACE_FINISHING            0x00000002
+#define RM_RACE_ENDED                0x00000004
+
+
+/* race values ( same for all the cars ) */
+typedef struct
+{
+
+    int ncars;                      // number of cars
+    int totLaps;                    // laps of the race
+    int state;                      // state of the race ( RM_RACE_* )
+
+} tRaceAdmInfo;
+
+#define _ncars          raceInfo.ncars
+#define _totLaps        raceInfo.totLaps
+#define _raceState      raceInfo.state
+
+
+/**
+ * situation of the race, passed to robots at each step
+ **/
+typedef struct Situation
+{
+
+    tRaceAdmInfo raceInfo;
+    double deltaTime;               // time since last call of robots
+    double currentTime;             // time since start of the race
+    tCarElt ** cars;                // cars of the race
+
+} tSituation;
+
+
+/**
+ * race manager ( "ReInfo" of raceengineclient library )
+ **/
+typedef struct RmInfo
+{
+
+    tCarElt * carList;              // cars of the race
+    tSituation * s;                 // situation of the race
+    tTrack * track;                 // track of the race
+
+} tRmInfo;
+
+
+#endif      /* ifndef SIM_TORCS_RACEMAN_H_ */
+
@@ -0,0 +1,69 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * robot.h
+ *
+ * Stand-in for "robot.h" of TORCS used by the headless simulator ( see tgf.h ).
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  SIM_TORCS_ROBOT_H_
+#define  SIM_TORCS_ROBOT_H_
+
+
+#include "raceman.h"
+
+
+// framework version of robots
+#define ROB_IDENT                    0
+
+
+/* functions of a robot interface */
+typedef void (*tfRbNewTrack)(int index, tTrack * track, void * carHandle,
+        void ** myCarSettings, tSituation * s);
+typedef void (*tfRbNewRace)(int index, tCarElt * car, tSituation * s);
+typedef void (*tfRbEndRace)(int index, tCarElt * car, tSituation * s);
+typedef void (*tfRbDrive)(int index, tCarElt * car, tSituation * s);
+typedef int  (*tfRbPitCmd)(int index, tCarElt * car, tSituation * s);
+typedef void (*tfRbShutdown)(int index);
+
+
+/**
+ * interface of a robot ( a car ), filled by "fctInit" of its module
+ **/
+typedef struct RobotItf
+{
+
+    tfRbNewTrack rbNewTrack;        // give the robot the track view
+    tfRbNewRace rbNewRace;          // start a new race
+    tfRbEndRace rbEndRace;          // end of the current race
+    tfRbDrive rbDrive;              // drive during race
+    tfRbPitCmd rbPitCmd;            // get the driver's pit commands
+    tfRbShutdown rbShutdown;        // called before the module is unloaded
+    int index;                      // index used if multiple interfaces
+
+} tRobotItf;
+
+
+#endif      /* ifndef SIM_TORCS_ROBOT_H_ */
+
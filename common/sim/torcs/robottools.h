@@ -0,0 +1,46 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * robottools.h
+ *
+ * Stand-in for "robottools.h" of TORCS used by the headless simulator
+ * ( see tgf.h ). Functions are defined in "sim_track.cpp".
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  SIM_TORCS_ROBOTTOOLS_H_
+#define  SIM_TORCS_ROBOTTOOLS_H_
+
+
+#include "car.h"
+#include "track.h"
+
+
+/**
+ * returns angle of tangent of the track ( in radians ) at the given position
+ **/
+extern tdble RtTrackSideTgAngleL(tTrkLocPos * p);
+
+
+#endif      /* ifndef SIM_TORCS_ROBOTTOOLS_H_ */
+
@@ -0,0 +1,77 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * tgf.h
+ *
+ * Stand-in for "tgf.h" of TORCS used by the headless simulator. It has only
+ * the part of TORCS that robot modules of car111 and car222 use, with same
+ * names, so robots are compiled without any change.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  SIM_TORCS_TGF_H_
+#define  SIM_TORCS_TGF_H_
+
+
+#include <math.h>
+
+
+typedef float tdble;
+
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif
+
+// angle normalized to [-PI, PI]
+#define NORM_PI_PI(x)                       \
+{                                           \
+    while((x) > PI) { (x) -= 2 * PI; }      \
+    while((x) < -PI) { (x) += 2 * PI; }     \
+}
+
+// maximum number of interfaces ( cars ) of a robot module
+#define MAX_MOD_ITF                  10
+
+
+/* initialization function of an interface of a module */
+typedef int (*tfModPrivInit)(int index, void * pt);
+
+/**
+ * interface of a module ( filled by entry point of the module )
+ **/
+typedef struct ModInfo
+{
+
+    char * name;                    // name of the module ( short )
+    char * desc;                    // description of the module
+    tfModPrivInit fctInit;          // init function
+    unsigned int gfId;              // supported framework version
+    int index;                      // index if multiple interfaces
+    int prio;                       // priority if needed
+    int magic;                      // magic number for integrity check
+
+} tModInfo;
+
+
+#endif      /* ifndef SIM_TORCS_TGF_H_ */
+
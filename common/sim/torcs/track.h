@@ -0,0 +1,112 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * track.h
+ *
+ * Stand-in for "track.h" of TORCS used by the headless simulator ( see tgf.h ).
+ * Segments are only straights and arcs of constant width on a flat track.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  SIM_TORCS_TRACK_H_
+#define  SIM_TORCS_TRACK_H_
+
+
+#include "tgf.h"
+
+
+// types of segment
+#define TR_RGT                       1      // right curve
+#define TR_LFT                       2      // left curve
+#define TR_STR                       3      // straight
+
+// index of angle of segment at its start ( in "angle" )
+#define TR_ZS                        0
+
+// type of position on the track
+#define TR_LPOS_MAIN                 0      // relative to the main segment
+
+
+/**
+ * segment of the track
+ **/
+typedef struct trackSeg
+{
+
+    int id;                         // segment number ( 0 at the start line )
+    int type;                       // TR_RGT, TR_LFT or TR_STR
+
+    tdble length;                   // length of the middle of the segment
+    tdble width;                    // width of the segment
+    tdble lgfromstart;              // length from start line to start of the segment
+
+    tdble radius;                   // radius of the middle of a curve ( 0 for straight )
+    tdble radiusr;                  // radius of right side of a curve
+    tdble radiusl;                  // radius of left side of a curve
+    tdble arc;                      // arc of a curve ( in radians )
+
+    tdble angle[7];                 // angle of the segment at its start ( TR_ZS )
+
+    struct trackSeg * next;         // next segment
+    struct trackSeg * prev;         // previous segment
+
+} tTrackSeg;
+
+
+/**
+ * position of a car on the track
+ **/
+typedef struct
+{
+
+    tTrackSeg * seg;                // segment of the car
+    int type;                       // TR_LPOS_MAIN
+
+    tdble toStart;                  // distance ( arc for curves ) from start of the segment
+    tdble toRight;                  // distance to right side of the track
+    tdble toMiddle;                 // distance to middle of the track ( positive on left )
+    tdble toLeft;                   // distance to left side of the track
+
+} tTrkLocPos;
+
+
+/**
+ * the track
+ **/
+typedef struct Track
+{
+
+    const char * name;              // name of the track
+    const char * filename;          // file of the track
+
+    int nseg;                       // number of segments
+    tdble length;                   // length of the track
+    tdble width;                    // width of the track
+
+    tTrackSeg * seg;                // last segment ( its next segment is at start line )
+
+} tTrack;
+
+
+#endif      /* ifndef SIM_TORCS_TRACK_H_ */
+
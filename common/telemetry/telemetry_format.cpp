@@ -0,0 +1,191 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * telemetry_format.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "telemetry_format.h"
+
+
+namespace
+{
+
+    /* appends an unsigned value with 7 bits in each byte ( high bit for more bytes ) */
+    inline void put_varint(unsigned int value, std::vector<unsigned char> & encoded)
+    {
+        while(value >= 0x80)
+        {
+            encoded.push_back((unsigned char) (value | 0x80));
+            value >>= 7;
+        }
+        encoded.push_back((unsigned char) value);
+    }
+
+
+    /* reads a value written by "put_varint" ( returns 0 if bytes run out ) */
+    inline int get_varint(const unsigned char * & position, const unsigned char * end,
+            unsigned int & value)
+    {
+        value = 0;
+        for(int shift = 0; shift < 35; shift += 7)
+        {
+            if(position == end)
+            {
+                return 0;
+            }
+
+            const unsigned char byte = *(position++);
+            value |= (unsigned int) (byte & 0x7f) << shift;
+            if((byte & 0x80) == 0)
+            {
+                return 1;
+            }
+        }
+
+        return 0;
+    }
+
+
+    /* copies words of a record */
+    inline void get_words(const controller_telemetry::telemetry_record & record,
+            unsigned int * words)
+    {
+        memcpy(words, &record, sizeof(record));
+    }
+
+}
+
+
+void controller_telemetry::encode_telemetry_records(const telemetry_record * records,
+        const size_t count, std::vector<unsigned char> & encoded)
+{
+    unsigned int previous_words[TELEMETRY_RECORD_WORDS] = {0};
+    unsigned int previous_deltas[TELEMETRY_RECORD_WORDS] = {0};
+    unsigned int words[TELEMETRY_RECORD_WORDS];
+
+    for(size_t i = 0; i < count; i++)
+    {
+        get_words(records[i], words);
+
+        // mask of words that are not as predicted ( previous word plus
+        // previous change, i.e. change is same as in previous record )
+        unsigned int mask = 0;
+        for(int j = 0; j < TELEMETRY_RECORD_WORDS; j++)
+        {
+            mask |= (unsigned int) (words[j] != previous_words[j] + previous_deltas[j]) << j;
+        }
+        put_varint(mask, encoded);
+
+        // difference of each such word from its prediction in zigzag form
+        // ( small negative differences are small numbers too )
+        for(int j = 0; j < TELEMETRY_RECORD_WORDS; j++)
+        {
+            const unsigned int delta = words[j] - previous_words[j];
+            if(mask & (1u << j))
+            {
+                const int difference = (int) (delta - previous_deltas[j]);
+                put_varint(((unsigned int) difference << 1) ^ (unsigned int) (difference >> 31),
+                        encoded);
+            }
+            previous_deltas[j] = delta;
+            previous_words[j] = words[j];
+        }
+    }
+}
+
+
+int controller_telemetry::decode_telemetry_records(const unsigned char * encoded,
+        const size_t size, const size_t count, std::vector<telemetry_record> & records)
+{
+    const unsigned char * position = encoded;
+    const unsigned char * end = encoded + size;
+
+    unsigned int words[TELEMETRY_RECORD_WORDS] = {0};
+    unsigned int deltas[TELEMETRY_RECORD_WORDS] = {0};
+    records.resize(count);
+
+    for(size_t i = 0; i < count; i++)
+    {
+        unsigned int mask;
+        if(!get_varint(position, end, mask) || (mask >> TELEMETRY_RECORD_WORDS) != 0)
+        {
+            return -1;
+        }
+
+        for(int j = 0; j < TELEMETRY_RECORD_WORDS; j++)
+        {
+            if(mask & (1u << j))
+            {
+                unsigned int zigzag;
+                if(!get_varint(position, end, zigzag))
+                {
+                    return -1;
+                }
+                deltas[j] += (zigzag >> 1) ^ (0u - (zigzag & 1));
+            }
+            words[j] += deltas[j];
+        }
+
+        memcpy(&records[i], words, sizeof(telemetry_record));
+    }
+
+    // all the bytes belong to the records
+    return (position == end) ? 0 : -1;
+}
+
+
+unsigned int controller_telemetry::get_telemetry_checksum(const unsigned char * bytes,
+        const size_t size)
+{
+    unsigned int checksum = 2166136261u;
+    for(size_t i = 0; i < size; i++)
+    {
+        checksum = (checksum ^ bytes[i]) * 16777619u;
+    }
+
+    return checksum;
+}
+
+
+long long int controller_telemetry::read_telemetry_trailer(FILE * file,
+        const long long int file_size)
+{
+    telemetry_trailer trailer;
+    if(file_size < (long long int) sizeof(trailer) ||
+            fseeko(file, file_size - sizeof(trailer), SEEK_SET) != 0 ||
+            fread(&trailer, sizeof(trailer), 1, file) != 1 ||
+            memcmp(trailer.magic, TELEMETRY_TRAILER_MAGIC, sizeof(trailer.magic)) != 0 ||
+            trailer.index_offset < 0 || trailer.index_offset >= file_size)
+    {
+        return -1;
+    }
+
+    return trailer.index_offset;
+}
+
@@ -0,0 +1,233 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * telemetry_format.h
+ *
+ * Telemetry file : a record of each tick of a car ( inputs read from the car,
+ * fuzzy outputs, Q action and reward ) in blocks of delta encoded records.
+ * Each race of a car appends its blocks followed by an index of the blocks
+ * and a trailer that points to the index :
+ *
+ *      +--------------------------------+
+ *      | telemetry_block_header         |  <- race 1
+ *      | encoded records                |
+ *      +--------------------------------+
+ *      | ...                            |
+ *      +--------------------------------+
+ *      | telemetry_index_header         |
+ *      | telemetry_index_entry ( x n )  |
+ *      +--------------------------------+
+ *      | telemetry_trailer              |
+ *      +--------------------------------+
+ *      | telemetry_block_header         |  <- race 2
+ *      | ...                            |
+ *
+ * Index of a race has offset of index of previous race, so all the blocks
+ * are found from the trailer at the end of the file without reading them.
+ *
+ * Records are encoded as 4 byte words. Each word is predicted to change
+ * as much as it changed in previous record. Each record has a mask of the
+ * words that are not as predicted ( varint ) followed by the difference of
+ * each such word from its prediction ( zigzag varint ). Float words are
+ * subtracted as integers ( their bits ), so the encoding is lossless and
+ * a smooth change of a float value ( speed, time ) is a small number or
+ * nothing at all. First record of a block is encoded against records of
+ * zeros, so each block is decoded on its own.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  TELEMETRY_FORMAT_H_
+#define  TELEMETRY_FORMAT_H_
+
+
+#include <stdio.h>
+#include <stddef.h>
+#include <vector>
+
+
+// magic characters of a block, an index and a trailer
+#define TELEMETRY_BLOCK_MAGIC        "TLMBLOCK"
+#define TELEMETRY_INDEX_MAGIC        "TLMINDEX"
+#define TELEMETRY_TRAILER_MAGIC      "TLMTRAIL"
+// version of the format of telemetry file
+#define TELEMETRY_FORMAT_VERSION     1
+
+// records in a block ( last block of a race may have less )
+#define TELEMETRY_BLOCK_RECORDS      1024
+
+// Q action of a car without Q Learner ( car111 )
+#define TELEMETRY_NO_Q_ACTION        -1.0f
+
+
+namespace controller_telemetry
+{
+
+    /**
+     * values of a car at a tick of the race
+     **/
+    typedef struct telemetry_record_struct
+    {
+
+        // number of the tick since start of the race and race time
+        unsigned int tick;
+        float time;
+        // id of current track segment
+        int segment_id;
+
+        // raw inputs read from the car
+        float speed_x;
+        float speed_y;
+        float accel_x;
+        float to_left;
+        float to_right;
+        float damage;
+
+        // fuzzy inputs for current and next segment
+        float path;
+        float next_path;
+
+        // fuzzy outputs
+        int gear;
+        float steer;
+        float accel;
+        float brake;
+
+        // accel suggested by Q Learner ( TELEMETRY_NO_Q_ACTION if none )
+        // and reward for being in current state ( 0 if none )
+        float Q_accel;
+        float reward;
+
+    } telemetry_record;
+
+    // number of 4 byte words in a record
+    static const int TELEMETRY_RECORD_WORDS = sizeof(telemetry_record) / 4;
+
+    static_assert(sizeof(telemetry_record) % 4 == 0 && TELEMETRY_RECORD_WORDS < 32,
+            "telemetry record should be 4 byte words with one mask bit for each");
+
+
+    /**
+     * header of a block of encoded records
+     **/
+    typedef struct telemetry_block_header_struct
+    {
+
+        // TELEMETRY_BLOCK_MAGIC ( without null character )
+        char magic[8];
+        // TELEMETRY_FORMAT_VERSION
+        unsigned int format_version;
+        // size of a decoded record in bytes
+        unsigned int record_size;
+
+        // race the records belong to ( same for all blocks of a race )
+        unsigned long long int race_id;
+
+        // tick of first record and number of records
+        unsigned int first_tick;
+        unsigned int record_count;
+
+        // size of encoded records after this header and their checksum
+        unsigned int payload_size;
+        unsigned int checksum;
+
+    } telemetry_block_header;
+
+
+    /**
+     * a block in index of telemetry file
+     **/
+    typedef struct telemetry_index_entry_struct
+    {
+
+        unsigned long long int race_id;
+        // offset of block header in the file
+        long long int offset;
+        unsigned int first_tick;
+        unsigned int record_count;
+
+    } telemetry_index_entry;
+
+
+    /**
+     * header of index of blocks of a race
+     **/
+    typedef struct telemetry_index_header_struct
+    {
+
+        // TELEMETRY_INDEX_MAGIC ( without null character )
+        char magic[8];
+        // TELEMETRY_FORMAT_VERSION
+        unsigned int format_version;
+        // number of entries after this header
+        unsigned int entry_count;
+
+        // offset of index of previous race in the file ( -1 if none )
+        long long int previous_index_offset;
+
+    } telemetry_index_header;
+
+
+    /**
+     * trailer after index of a race
+     **/
+    typedef struct telemetry_trailer_struct
+    {
+
+        // TELEMETRY_TRAILER_MAGIC ( without null character )
+        char magic[8];
+        // offset of index of the race in the file
+        long long int index_offset;
+
+    } telemetry_trailer;
+
+
+    /**
+     * appends encoded records to "encoded" ( each record against prediction
+     * from previous records of the list )
+     **/
+    void encode_telemetry_records(const telemetry_record * records, const size_t count,
+            std::vector<unsigned char> & encoded);
+
+    /**
+     * decodes "count" records from "size" bytes of encoded records.
+     * Returns 0 on success and -1 if the bytes are not valid.
+     **/
+    int decode_telemetry_records(const unsigned char * encoded, const size_t size,
+            const size_t count, std::vector<telemetry_record> & records);
+
+    /* returns checksum of the given bytes ( FNV-1a ) */
+    unsigned int get_telemetry_checksum(const unsigned char * bytes, const size_t size);
+
+    /**
+     * reads trailer at the end of the given open telemetry file of given size.
+     * Returns offset of index of the last race, or -1 if the file does not end
+     * with a trailer ( empty file, or last race was not stopped ).
+     **/
+    long long int read_telemetry_trailer(FILE * file, const long long int file_size);
+
+}
+
+
+#endif      /* ifndef TELEMETRY_FORMAT_H_ */
+
@@ -0,0 +1,270 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * telemetry_reader.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <vector>
+#include <algorithm>
+
+#include "telemetry_reader.h"
+
+
+/**
+ *  Constructor
+ **/
+controller_telemetry::telemetry_reader::telemetry_reader()
+{
+    m_file = NULL;
+    m_file_size = 0;
+}
+
+
+/**
+ *  Destructor
+ **/
+controller_telemetry::telemetry_reader::~telemetry_reader()
+{
+    close();
+}
+
+
+int controller_telemetry::telemetry_reader::open(const char * file_name)
+{
+    close();
+
+    m_file = fopen(file_name, "rb");
+    struct stat file_stat;
+    if(m_file == NULL || fstat(fileno(m_file), &file_stat) != 0)
+    {
+        printf("couldn't open telemetry file \'%s\'\n", file_name);
+        close();
+        return -1;
+    }
+    m_file_size = file_stat.st_size;
+
+    if(read_indices() != 0)
+    {
+        // last race was not stopped ( or an index is not valid )
+        if(scan_blocks() != 0)
+        {
+            printf("couldn't read blocks of telemetry file \'%s\'\n", file_name);
+            close();
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+void controller_telemetry::telemetry_reader::close()
+{
+    if(m_file != NULL)
+    {
+        fclose(m_file);
+        m_file = NULL;
+    }
+
+    m_file_size = 0;
+    m_blocks.clear();
+}
+
+
+int controller_telemetry::telemetry_reader::find_block(const unsigned long long int race_id,
+        const unsigned int tick) const
+{
+    for(size_t i = 0; i < m_blocks.size(); i++)
+    {
+        if(m_blocks[i].race_id == race_id &&
+                tick < m_blocks[i].first_tick + m_blocks[i].record_count)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+
+int controller_telemetry::telemetry_reader::read_block(const size_t block_index,
+        std::vector<telemetry_record> & records)
+{
+    if(m_file == NULL || block_index >= m_blocks.size())
+    {
+        return -1;
+    }
+
+    telemetry_block_header block_header;
+    if(fseeko(m_file, m_blocks[block_index].offset, SEEK_SET) != 0 ||
+            fread(&block_header, sizeof(block_header), 1, m_file) != 1 ||
+            memcmp(block_header.magic, TELEMETRY_BLOCK_MAGIC, sizeof(block_header.magic)) != 0)
+    {
+        return -1;
+    }
+
+    m_encoded.resize(block_header.payload_size);
+    if((block_header.payload_size > 0 &&
+                fread(&m_encoded[0], block_header.payload_size, 1, m_file) != 1) ||
+            get_telemetry_checksum(m_encoded.data(), m_encoded.size()) != block_header.checksum)
+    {
+        return -1;
+    }
+
+    return decode_telemetry_records(m_encoded.data(), m_encoded.size(),
+            block_header.record_count, records);
+}
+
+
+int controller_telemetry::telemetry_reader::read_indices()
+{
+    long long int index_offset = read_telemetry_trailer(m_file, m_file_size);
+    if(index_offset < 0)
+    {
+        return -1;
+    }
+
+    // indices are found from last race to first race
+    std::vector< std::vector<telemetry_index_entry> > race_blocks;
+    long long int first_offset = m_file_size;
+    while(index_offset >= 0)
+    {
+        telemetry_index_header index_header;
+        if(fseeko(m_file, index_offset, SEEK_SET) != 0 ||
+                fread(&index_header, sizeof(index_header), 1, m_file) != 1 ||
+                memcmp(index_header.magic, TELEMETRY_INDEX_MAGIC, sizeof(index_header.magic)) != 0 ||
+                index_header.format_version != TELEMETRY_FORMAT_VERSION ||
+                index_header.previous_index_offset >= index_offset)
+        {
+            return -1;
+        }
+
+        race_blocks.push_back(std::vector<telemetry_index_entry>(index_header.entry_count));
+        std::vector<telemetry_index_entry> & entries = race_blocks.back();
+        if(!entries.empty() &&
+                fread(&entries[0], sizeof(telemetry_index_entry), entries.size(), m_file)
+                != entries.size())
+        {
+            return -1;
+        }
+
+        first_offset = std::min(first_offset, index_offset);
+        if(!entries.empty())
+        {
+            first_offset = std::min(first_offset, entries[0].offset);
+        }
+
+        index_offset = index_header.previous_index_offset;
+    }
+
+    // a race before first index found was not stopped, so its blocks
+    // ( and races before it ) are not in these indices
+    if(first_offset != 0)
+    {
+        return -1;
+    }
+
+    m_blocks.clear();
+    for(size_t i = race_blocks.size(); i > 0; i--)
+    {
+        m_blocks.insert(m_blocks.end(), race_blocks[i - 1].begin(), race_blocks[i - 1].end());
+    }
+
+    return 0;
+}
+
+
+int controller_telemetry::telemetry_reader::scan_blocks()
+{
+    m_blocks.clear();
+
+    long long int offset = 0;
+    char magic[8];
+    while(offset + (long long int) sizeof(magic) <= m_file_size)
+    {
+        if(fseeko(m_file, offset, SEEK_SET) != 0 ||
+                fread(magic, sizeof(magic), 1, m_file) != 1 ||
+                fseeko(m_file, offset, SEEK_SET) != 0)
+        {
+            return -1;
+        }
+
+        // size of a valid block, index or trailer at the offset ( 0 if there
+        // is none, e.g. a part written before a crash, and next byte is tried )
+        long long int size = 0;
+        if(memcmp(magic, TELEMETRY_BLOCK_MAGIC, sizeof(magic)) == 0)
+        {
+            telemetry_block_header block_header;
+            if(fread(&block_header, sizeof(block_header), 1, m_file) == 1 &&
+                    offset + (long long int) sizeof(block_header) +
+                    block_header.payload_size <= m_file_size)
+            {
+                m_encoded.resize(block_header.payload_size);
+                if((block_header.payload_size == 0 ||
+                            fread(&m_encoded[0], block_header.payload_size, 1, m_file) == 1) &&
+                        get_telemetry_checksum(m_encoded.data(), m_encoded.size())
+                        == block_header.checksum)
+                {
+                    telemetry_index_entry entry;
+                    entry.race_id = block_header.race_id;
+                    entry.offset = offset;
+                    entry.first_tick = block_header.first_tick;
+                    entry.record_count = block_header.record_count;
+                    m_blocks.push_back(entry);
+
+                    size = sizeof(block_header) + (long long int) block_header.payload_size;
+                }
+            }
+        }
+        else if(memcmp(magic, TELEMETRY_INDEX_MAGIC, sizeof(magic)) == 0)
+        {
+            // an index is complete if its trailer follows it
+            telemetry_index_header index_header;
+            if(fread(&index_header, sizeof(index_header), 1, m_file) == 1)
+            {
+                size = sizeof(index_header) +
+                    (long long int) index_header.entry_count * sizeof(telemetry_index_entry);
+                if(fseeko(m_file, offset + size, SEEK_SET) != 0 ||
+                        fread(magic, sizeof(magic), 1, m_file) != 1 ||
+                        memcmp(magic, TELEMETRY_TRAILER_MAGIC, sizeof(magic)) != 0)
+                {
+                    size = 0;
+                }
+            }
+        }
+        else if(memcmp(magic, TELEMETRY_TRAILER_MAGIC, sizeof(magic)) == 0)
+        {
+            size = sizeof(telemetry_trailer);
+        }
+
+        offset += (size > 0) ? size : 1;
+    }
+
+    return 0;
+}
+
@@ -0,0 +1,127 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * telemetry_reader.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  TELEMETRY_READER_H_
+#define  TELEMETRY_READER_H_
+
+
+#include <stdio.h>
+#include <vector>
+
+#include "telemetry_format.h"
+
+
+namespace controller_telemetry
+{
+
+    /*
+     * ==========================================================================
+     *        Class:  telemetry_reader
+     *  Description:  Reads blocks of a telemetry file ( see telemetry_format.h ).
+     *                Blocks are found from indices of races ( starting from the
+     *                trailer at the end of the file ), so a block is read without
+     *                reading blocks before it. If the file does not end with a
+     *                trailer ( last race was not stopped ) or an index is not
+     *                valid, blocks are found by reading the whole file.
+     * ===========================================================================
+     */
+    class telemetry_reader
+    {
+        public :
+
+            /** MEMBER FUNCTIONS **/
+
+            telemetry_reader();
+
+            ~telemetry_reader();
+
+            /* opens the given file and finds its blocks ( returns 0 on success, else -1 ) */
+            int open(const char * file_name);
+
+            /* closes the file ( it is also closed when the reader is destroyed ) */
+            void close();
+
+            /* returns blocks of all the races in the order they were written */
+            inline const std::vector<telemetry_index_entry> & get_blocks() const
+            {
+                return m_blocks;
+            }
+
+            /**
+             * returns index of the block of given race that has the given tick
+             * ( or the first block after it ), or -1 if there is none
+             **/
+            int find_block(const unsigned long long int race_id,
+                    const unsigned int tick) const;
+
+            /**
+             * reads and decodes records of the given block. Returns 0 on success
+             * and -1 if the block couldn't be read or is not valid.
+             **/
+            int read_block(const size_t block_index, std::vector<telemetry_record> & records);
+
+
+        private :
+
+            /** MEMBER VARIABLES **/
+
+            /* telemetry file ( NULL if not open ) and its size in bytes */
+            FILE * m_file;
+            long long int m_file_size;
+
+            /* blocks of the file */
+            std::vector<telemetry_index_entry> m_blocks;
+
+            /* encoded records of a block being read */
+            std::vector<unsigned char> m_encoded;
+
+
+            /** MEMBER FUNCTIONS **/
+
+            /* finds blocks from indices of races ( returns 0 on success, else -1 ) */
+            int read_indices();
+
+            /**
+             * finds blocks by reading all the blocks ( bytes that are not a valid
+             * block, index or trailer are skipped ). Returns 0 on success, else -1.
+             **/
+            int scan_blocks();
+
+            // restricted copy constructor
+            telemetry_reader(const telemetry_reader &other) = delete;
+
+            // restricted assignment operator
+            telemetry_reader& operator=(const telemetry_reader &other) = delete;
+
+    };
+
+}
+
+
+#endif      /* ifndef TELEMETRY_READER_H_ */
+
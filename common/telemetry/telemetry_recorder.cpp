@@ -0,0 +1,288 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * telemetry_recorder.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <vector>
+
+#include "telemetry_recorder.h"
+
+
+/**
+ *  Constructor
+ **/
+controller_telemetry::telemetry_recorder::telemetry_recorder()
+{
+    m_buffer = NULL;
+    m_capacity = 0;
+    m_mask = 0;
+
+    m_file = NULL;
+    m_race_id = 0;
+    m_previous_index_offset = -1;
+
+    m_records = 0;
+    m_dropped_records = 0;
+    m_bytes_written = 0;
+    m_write_error = 0;
+
+    m_stop_writer.store(0);
+    m_head.store(0);
+    m_cached_tail = 0;
+    m_tail.store(0);
+}
+
+
+/**
+ *  Destructor
+ **/
+controller_telemetry::telemetry_recorder::~telemetry_recorder()
+{
+    stop();
+}
+
+
+int controller_telemetry::telemetry_recorder::start(const char * file_name,
+        const unsigned long long int race_id, const size_t buffer_capacity)
+{
+    stop();
+
+    // offsets of blocks in index are positions in the file, so position is
+    // set to the end ( where writes are appended )
+    m_file = fopen(file_name, "ab");
+    if(m_file == NULL || fseeko(m_file, 0, SEEK_END) != 0)
+    {
+        if(m_file != NULL)
+        {
+            fclose(m_file);
+            m_file = NULL;
+        }
+        printf("couldn't open telemetry file \'%s\'\n", file_name);
+        return -1;
+    }
+
+    // index of this race points to index of previous race ( if the file
+    // ends with its trailer )
+    FILE * previous_file = fopen(file_name, "rb");
+    struct stat file_stat;
+    m_previous_index_offset = -1;
+    if(previous_file != NULL)
+    {
+        if(fstat(fileno(previous_file), &file_stat) == 0)
+        {
+            m_previous_index_offset = read_telemetry_trailer(previous_file, file_stat.st_size);
+        }
+        fclose(previous_file);
+    }
+
+    m_capacity = 1;
+    while(m_capacity < buffer_capacity)
+    {
+        m_capacity <<= 1;
+    }
+    m_mask = m_capacity - 1;
+    m_buffer = new telemetry_record[m_capacity];
+
+    m_race_id = race_id;
+    m_block_records.clear();
+    m_block_records.reserve(TELEMETRY_BLOCK_RECORDS);
+    m_encoded.clear();
+    m_index.clear();
+
+    m_records = 0;
+    m_dropped_records = 0;
+    m_bytes_written = 0;
+    m_write_error = 0;
+
+    m_head.store(0, std::memory_order_relaxed);
+    m_cached_tail = 0;
+    m_tail.store(0, std::memory_order_relaxed);
+    m_stop_writer.store(0, std::memory_order_relaxed);
+
+    if(pthread_create(&m_writer_thread, NULL, run_writer, this) != 0)
+    {
+        puts("couldn't start telemetry writer thread");
+        delete[] m_buffer;
+        m_buffer = NULL;
+        fclose(m_file);
+        m_file = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+
+void controller_telemetry::telemetry_recorder::stop()
+{
+    if(m_buffer == NULL)
+    {
+        return;
+    }
+
+    // records put before this are written by the thread before it stops
+    m_stop_writer.store(1, std::memory_order_release);
+    pthread_join(m_writer_thread, NULL);
+
+    write_index();
+
+    if(fclose(m_file) != 0 || m_write_error)
+    {
+        puts("error writing telemetry file");
+    }
+    m_file = NULL;
+
+    delete[] m_buffer;
+    m_buffer = NULL;
+}
+
+
+void controller_telemetry::telemetry_recorder::get_stats(telemetry_stats & stats) const
+{
+    stats.records = m_records;
+    stats.dropped_records = m_dropped_records;
+    stats.blocks = m_index.size();
+    stats.bytes_written = m_bytes_written;
+}
+
+
+void * controller_telemetry::telemetry_recorder::run_writer(void * t_recorder)
+{
+    telemetry_recorder * recorder = (telemetry_recorder *) t_recorder;
+
+    while(!recorder->m_stop_writer.load(std::memory_order_acquire))
+    {
+        recorder->write_buffered_records(0);
+
+        // a tick of the race takes a few milliseconds, so a sleep takes
+        // a few records at a time
+        usleep(TELEMETRY_WRITER_SLEEP);
+    }
+
+    // records that were put before the stop was set
+    recorder->write_buffered_records(1);
+
+    return NULL;
+}
+
+
+void controller_telemetry::telemetry_recorder::write_buffered_records(const int flush_all)
+{
+    const size_t head = m_head.load(std::memory_order_acquire);
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+
+    while(tail != head)
+    {
+        m_block_records.push_back(m_buffer[tail & m_mask]);
+        tail++;
+
+        // slot is given back as soon as the record is copied
+        m_tail.store(tail, std::memory_order_release);
+
+        if(m_block_records.size() == TELEMETRY_BLOCK_RECORDS)
+        {
+            write_block();
+        }
+    }
+
+    if(flush_all && !m_block_records.empty())
+    {
+        write_block();
+    }
+}
+
+
+void controller_telemetry::telemetry_recorder::write_block()
+{
+    m_encoded.clear();
+    encode_telemetry_records(&m_block_records[0], m_block_records.size(), m_encoded);
+
+    telemetry_block_header block_header;
+    memset(&block_header, 0, sizeof(block_header));
+    memcpy(block_header.magic, TELEMETRY_BLOCK_MAGIC, sizeof(block_header.magic));
+    block_header.format_version = TELEMETRY_FORMAT_VERSION;
+    block_header.record_size = sizeof(telemetry_record);
+    block_header.race_id = m_race_id;
+    block_header.first_tick = m_block_records[0].tick;
+    block_header.record_count = m_block_records.size();
+    block_header.payload_size = m_encoded.size();
+    block_header.checksum = get_telemetry_checksum(&m_encoded[0], m_encoded.size());
+
+    telemetry_index_entry entry;
+    entry.race_id = m_race_id;
+    entry.offset = ftello(m_file);
+    entry.first_tick = block_header.first_tick;
+    entry.record_count = block_header.record_count;
+    m_index.push_back(entry);
+
+    write_bytes(&block_header, sizeof(block_header));
+    write_bytes(&m_encoded[0], m_encoded.size());
+
+    // a block is on its way to disk even if the game does not shut down
+    m_write_error = (fflush(m_file) != 0) || m_write_error;
+
+    m_records += m_block_records.size();
+    m_block_records.clear();
+}
+
+
+void controller_telemetry::telemetry_recorder::write_index()
+{
+    telemetry_index_header index_header;
+    memset(&index_header, 0, sizeof(index_header));
+    memcpy(index_header.magic, TELEMETRY_INDEX_MAGIC, sizeof(index_header.magic));
+    index_header.format_version = TELEMETRY_FORMAT_VERSION;
+    index_header.entry_count = m_index.size();
+    index_header.previous_index_offset = m_previous_index_offset;
+
+    telemetry_trailer trailer;
+    memset(&trailer, 0, sizeof(trailer));
+    memcpy(trailer.magic, TELEMETRY_TRAILER_MAGIC, sizeof(trailer.magic));
+    trailer.index_offset = ftello(m_file);
+
+    write_bytes(&index_header, sizeof(index_header));
+    if(!m_index.empty())
+    {
+        write_bytes(&m_index[0], m_index.size() * sizeof(telemetry_index_entry));
+    }
+    write_bytes(&trailer, sizeof(trailer));
+}
+
+
+void controller_telemetry::telemetry_recorder::write_bytes(const void * bytes,
+        const size_t size)
+{
+    if(fwrite(bytes, 1, size, m_file) != size)
+    {
+        m_write_error = 1;
+    }
+    m_bytes_written += size;
+}
+
@@ -0,0 +1,204 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+
+/*
+ * telemetry_recorder.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#ifndef  TELEMETRY_RECORDER_H_
+#define  TELEMETRY_RECORDER_H_
+
+
+#include <stdio.h>
+#include <pthread.h>
+#include <atomic>
+#include <vector>
+
+#include "telemetry_format.h"
+
+
+// size of a cache line ( producer and consumer indices are kept apart )
+#define TELEMETRY_CACHE_LINE_SIZE    64
+// sleep ( in micro seconds ) of writer thread while no record is buffered
+#define TELEMETRY_WRITER_SLEEP       10000
+
+
+namespace controller_telemetry
+{
+
+    /**
+     * statistics of a telemetry recorder
+     **/
+    typedef struct telemetry_stats_struct
+    {
+
+        // records written and records dropped as the buffer was full
+        long long int records;
+        long long int dropped_records;
+        // blocks and bytes written to the file ( with headers and index )
+        long long int blocks;
+        long long int bytes_written;
+
+    } telemetry_stats;
+
+
+    /*
+     * ==========================================================================
+     *        Class:  telemetry_recorder
+     *  Description:  Records a telemetry record for each tick of a race to a
+     *                telemetry file ( see telemetry_format.h ). The driving thread
+     *                only copies the record to a preallocated ring buffer ( it
+     *                does not lock, allocate or wait ) and a writer thread encodes
+     *                records and appends them to the file in blocks. If the buffer
+     *                is full, the record is dropped and counted.
+     * ===========================================================================
+     */
+    class telemetry_recorder
+    {
+        public :
+
+            /** MEMBER FUNCTIONS **/
+
+            telemetry_recorder();
+
+            ~telemetry_recorder();
+
+            /**
+             * starts recording a race to the given file ( appended if it exists )
+             * with a ring buffer of given capacity ( rounded up to a power of 2 ).
+             * A previous recording is stopped first.
+             * Returns 0 on success and -1 if the file or thread couldn't be started.
+             **/
+            int start(const char * file_name, const unsigned long long int race_id,
+                    const size_t buffer_capacity);
+
+            /**
+             * writes buffered records, index and trailer of the race and closes
+             * the file ( nothing is done if it is not recording ). It is also
+             * stopped when the recorder is destroyed.
+             **/
+            void stop();
+
+            /* returns non-zero while it is recording */
+            inline int is_recording() const
+            {
+                return m_buffer != NULL;
+            }
+
+            /**
+             * puts a record in the ring buffer ( called by the driving thread only ).
+             * The record is dropped if the buffer is full.
+             **/
+            inline void record(const telemetry_record & t_record)
+            {
+                const size_t head = m_head.load(std::memory_order_relaxed);
+                if(head - m_cached_tail >= m_capacity)
+                {
+                    // index of writer is read only when buffer looks full
+                    m_cached_tail = m_tail.load(std::memory_order_acquire);
+                    if(head - m_cached_tail >= m_capacity)
+                    {
+                        m_dropped_records++;
+                        return;
+                    }
+                }
+
+                m_buffer[head & m_mask] = t_record;
+                m_head.store(head + 1, std::memory_order_release);
+            }
+
+            /* copies statistics of the recording ( after "stop" ) to the argument */
+            void get_stats(telemetry_stats & stats) const;
+
+
+        private :
+
+            /** MEMBER VARIABLES **/
+
+            /* ring buffer of records ( NULL if not recording ) */
+            telemetry_record * m_buffer;
+            size_t m_capacity;
+            size_t m_mask;
+
+            /* telemetry file, race being recorded and offset of previous index */
+            FILE * m_file;
+            unsigned long long int m_race_id;
+            long long int m_previous_index_offset;
+
+            /* records of the block being filled, its encoding and index of blocks */
+            std::vector<telemetry_record> m_block_records;
+            std::vector<unsigned char> m_encoded;
+            std::vector<telemetry_index_entry> m_index;
+
+            /* statistics ( counters of writer thread are read after it stops ) */
+            long long int m_records;
+            long long int m_dropped_records;
+            long long int m_bytes_written;
+            int m_write_error;
+
+            /* writer thread and flag to stop it after emptying the buffer */
+            pthread_t m_writer_thread;
+            std::atomic<int> m_stop_writer;
+
+            /* index of next record put ( written by driving thread ) and its copy of tail */
+            char m_head_padding[TELEMETRY_CACHE_LINE_SIZE];
+            std::atomic<size_t> m_head;
+            size_t m_cached_tail;
+
+            /* index of next record taken ( written by writer thread ) */
+            char m_tail_padding[TELEMETRY_CACHE_LINE_SIZE];
+            std::atomic<size_t> m_tail;
+            char m_end_padding[TELEMETRY_CACHE_LINE_SIZE];
+
+
+            /** MEMBER FUNCTIONS **/
+
+            /* thread function of writer thread ( argument is the recorder ) */
+            static void * run_writer(void * t_recorder);
+
+            /* takes buffered records and writes full blocks ( all blocks if "flush_all" ) */
+            void write_buffered_records(const int flush_all);
+
+            /* encodes and appends records of current block to the file */
+            void write_block();
+
+            /* appends index and trailer of the race to the file */
+            void write_index();
+
+            /* appends bytes to the file and counts them */
+            void write_bytes(const void * bytes, const size_t size);
+
+            // restricted copy constructor
+            telemetry_recorder(const telemetry_recorder &other) = delete;
+
+            // restricted assignment operator
+            telemetry_recorder& operator=(const telemetry_recorder &other) = delete;
+
+    };
+
+}
+
+
+#endif      /* ifndef TELEMETRY_RECORDER_H_ */
+
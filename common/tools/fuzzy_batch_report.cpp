@@ -0,0 +1,323 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * fuzzy_batch_report.cpp
+ *
+ * Checks FuzzyBatchController with FuzzyController - random
+ * trajectories of inputs ( one for each lane ) are given to a batch
+ * controller and to one FuzzyController for each lane, step by step, and
+ * outputs that differ are counted ( gears must be same and other outputs
+ * within MAX_VALUE_DIFFERENCE ). Time of each step of all lanes is printed for
+ * both. Batch engine uses AVX2 if this tool is compiled with -mavx2.
+ *
+ *  usage : <robot>_fuzzy_batch_report [-l <lanes>] [-s <steps>]
+ *
+ *  -l  lanes ( cars ) of the trajectories
+ *  -s  steps of each trajectory
+ *
+ *  Returns 0 if all outputs are same and 1 otherwise.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+
+#include "fuzzy_controller.h"
+#include "fuzzy_batch_controller.h"
+#include "fuzzy_batch_engine.h"
+
+
+// lanes are checked with FuzzyController of v1.1.0 ( batch engine only has exact centroid )
+#if !USE_EXACT_CENTROID
+#error "build with -DUSE_EXACT_CENTROID=1, so FuzzyController defuzzifies with exact centroid"
+#endif
+
+
+#define DEFAULT_LANES                100
+#define DEFAULT_STEPS                2000
+
+// largest difference of float outputs ( engines round differently )
+#define MAX_VALUE_DIFFERENCE         1e-5f
+
+// ranges of inputs ( a little beyond the values a race gives )
+#define MAX_ABS_PATH                 1.0f
+#define MIN_SPEED                    -5.0f
+#define MAX_SPEED                    120.0f
+#define MIN_ACCELERATION             -5.0f
+#define MAX_ACCELERATION             30.0f
+
+// largest change of speed and path from one step to the next
+#define MAX_SPEED_STEP               2.0f
+#define MAX_PATH_STEP                0.1f
+
+// seed of random inputs ( same inputs for each run, ROBOT_SEED is set by
+// the Makefile of tools of a robot )
+#ifndef ROBOT_SEED
+#error "ROBOT_SEED should be set to seed of random inputs of a robot ( e.g. 222 )"
+#endif
+#define TEST_INPUTS_SEED             ROBOT_SEED
+
+
+/**
+ * inputs of all lanes at one step ( arrays of lanes )
+ **/
+typedef struct step_inputs_struct
+{
+
+    std::vector<float> speed;
+    std::vector<float> acceleration;
+    std::vector<float> path;
+    std::vector<float> next_path;
+    std::vector<float> stability;
+
+} step_inputs;
+
+
+static void print_usage(const char * program_name)
+{
+    printf("usage : %s [-l <lanes>] [-s <steps>]\n", program_name);
+}
+
+
+/* returns seconds of monotonic clock */
+static double get_clock_seconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+
+/* returns a random value from "minimum" to "maximum" */
+static float get_random_value(const float minimum, const float maximum)
+{
+    return minimum + (maximum - minimum) * ((float) rand() / RAND_MAX);
+}
+
+
+/* returns "value" moved randomly by up to "max_step" within "minimum" and "maximum" */
+static float get_random_step(const float value, const float max_step, const float minimum,
+        const float maximum)
+{
+    const float next_value = value + get_random_value(-max_step, max_step);
+    return next_value < minimum ? minimum : (next_value > maximum ? maximum : next_value);
+}
+
+
+/**
+ * returns random trajectories - speed and path of each lane change a little
+ * from one step to the next ( so gear hysteresis applies ), other inputs are
+ * random at each step
+ **/
+static void get_random_trajectories(const int lane_count, const int step_count,
+        std::vector<step_inputs> & steps)
+{
+    steps.resize(step_count);
+    for(int step = 0; step < step_count; step++)
+    {
+        step_inputs & inputs = steps[step];
+        inputs.speed.resize(lane_count);
+        inputs.acceleration.resize(lane_count);
+        inputs.path.resize(lane_count);
+        inputs.next_path.resize(lane_count);
+        inputs.stability.resize(lane_count);
+
+        for(int lane = 0; lane < lane_count; lane++)
+        {
+            if(step == 0)
+            {
+                inputs.speed[lane] = get_random_value(MIN_SPEED, MAX_SPEED);
+                inputs.path[lane] = get_random_value(-MAX_ABS_PATH, MAX_ABS_PATH);
+            }
+            else
+            {
+                inputs.speed[lane] = get_random_step(steps[step - 1].speed[lane],
+                        MAX_SPEED_STEP, MIN_SPEED, MAX_SPEED);
+                inputs.path[lane] = get_random_step(steps[step - 1].path[lane],
+                        MAX_PATH_STEP, -MAX_ABS_PATH, MAX_ABS_PATH);
+            }
+            inputs.acceleration[lane] = get_random_value(MIN_ACCELERATION, MAX_ACCELERATION);
+            inputs.next_path[lane] = get_random_value(-MAX_ABS_PATH, MAX_ABS_PATH);
+            inputs.stability[lane] = get_random_value(0, 1);
+        }
+    }
+}
+
+
+/* returns batch inputs of a step */
+static controller::fuzzy_input_batch get_input_batch(const step_inputs & inputs)
+{
+    controller::fuzzy_input_batch batch;
+    batch.speed = inputs.speed.data();
+    batch.acceleration = inputs.acceleration.data();
+    batch.path = inputs.path.data();
+    batch.next_path = inputs.next_path.data();
+    batch.stability = inputs.stability.data();
+
+    return batch;
+}
+
+
+/* returns inputs of a lane at a step */
+static controller::fuzzy_inputs get_lane_inputs(const step_inputs & inputs, const int lane)
+{
+    controller::fuzzy_inputs lane_inputs;
+    lane_inputs.speed = inputs.speed[lane];
+    lane_inputs.acceleration = inputs.acceleration[lane];
+    lane_inputs.path = inputs.path[lane];
+    lane_inputs.next_path = inputs.next_path[lane];
+    lane_inputs.stability = inputs.stability[lane];
+
+    return lane_inputs;
+}
+
+
+/* returns non-zero if float outputs differ more than MAX_VALUE_DIFFERENCE */
+static int is_different(const float value, const float reference)
+{
+    // NaN outputs are same only as NaN
+    if(isnan(value) || isnan(reference))
+    {
+        return isnan(value) != isnan(reference);
+    }
+
+    return fabsf(value - reference) > MAX_VALUE_DIFFERENCE;
+}
+
+
+int main(int argc, char * argv[])
+{
+    int lane_count = DEFAULT_LANES;
+    int step_count = DEFAULT_STEPS;
+
+    int argument = 1;
+    while(argument + 1 < argc)
+    {
+        const std::string option = argv[argument];
+        if(option == "-l")
+        {
+            lane_count = atoi(argv[argument + 1]);
+        }
+        else if(option == "-s")
+        {
+            step_count = atoi(argv[argument + 1]);
+        }
+        else
+        {
+            break;
+        }
+        argument += 2;
+    }
+    if(argument != argc || lane_count <= 0 || step_count <= 0)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    srand(TEST_INPUTS_SEED);
+    std::vector<step_inputs> steps;
+    get_random_trajectories(lane_count, step_count, steps);
+
+    // controllers of lanes print their status, which is not needed for each lane
+    std::ostringstream controller_messages;
+    std::streambuf * cout_buffer = std::cout.rdbuf(controller_messages.rdbuf());
+    std::vector<controller::FuzzyController *> lane_controllers(lane_count);
+    for(int lane = 0; lane < lane_count; lane++)
+    {
+        lane_controllers[lane] = new controller::FuzzyController();
+    }
+    std::cout.rdbuf(cout_buffer);
+
+    controller::FuzzyBatchController batch_controller(lane_count);
+
+    std::vector<float> steer(lane_count);
+    std::vector<float> accel(lane_count);
+    std::vector<int> gear(lane_count);
+    std::vector<float> brake(lane_count);
+    controller::fuzzy_output_batch outputs = {steer.data(), accel.data(), gear.data(),
+        brake.data()};
+
+    long long int differs[controller_fuzzy::OUTPUT_COUNT] = {};
+    double scalar_seconds = 0;
+    double batch_seconds = 0;
+    for(int step = 0; step < step_count; step++)
+    {
+        const double batch_start = get_clock_seconds();
+        batch_controller.get_outputs(get_input_batch(steps[step]), outputs);
+        batch_seconds += get_clock_seconds() - batch_start;
+
+        const double scalar_start = get_clock_seconds();
+        std::vector<controller::fuzzy_outputs> lane_outputs(lane_count);
+        for(int lane = 0; lane < lane_count; lane++)
+        {
+            const controller::fuzzy_inputs lane_inputs = get_lane_inputs(steps[step], lane);
+            lane_outputs[lane] = lane_controllers[lane]->get_output(&lane_inputs);
+        }
+        scalar_seconds += get_clock_seconds() - scalar_start;
+
+        for(int lane = 0; lane < lane_count; lane++)
+        {
+            differs[controller_fuzzy::STEER_OUTPUT] +=
+                is_different(steer[lane], lane_outputs[lane].steer);
+            differs[controller_fuzzy::ACCEL_OUTPUT] +=
+                is_different(accel[lane], lane_outputs[lane].accel);
+            differs[controller_fuzzy::GEAR_OUTPUT] += (gear[lane] != lane_outputs[lane].gear);
+            differs[controller_fuzzy::BRAKE_OUTPUT] +=
+                is_different(brake[lane], lane_outputs[lane].brake);
+        }
+    }
+
+    for(int lane = 0; lane < lane_count; lane++)
+    {
+        delete lane_controllers[lane];
+    }
+
+    const long long int output_count = (long long int) lane_count * step_count;
+    printf("%d lanes, %d steps - outputs that differ from FuzzyController : steer %lld,"
+            " accel %lld, gear %lld, brake %lld ( of %lld each )\n", lane_count, step_count,
+            differs[controller_fuzzy::STEER_OUTPUT], differs[controller_fuzzy::ACCEL_OUTPUT],
+            differs[controller_fuzzy::GEAR_OUTPUT], differs[controller_fuzzy::BRAKE_OUTPUT],
+            output_count);
+    printf("FuzzyController %.1f ns, FuzzyBatchController %.1f ns per lane and step"
+            " ( %.1f times faster, %d lanes at a time, %d in each vector )\n",
+            scalar_seconds * 1e9 / output_count, batch_seconds * 1e9 / output_count,
+            (batch_seconds > 0) ? scalar_seconds / batch_seconds : 0.0, FUZZY_BATCH_LANES,
+            FUZZY_BATCH_PART_LANES);
+
+    for(int output = 0; output < controller_fuzzy::OUTPUT_COUNT; output++)
+    {
+        if(differs[output] != 0)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,304 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * fuzzy_centroid_report.cpp
+ *
+ * Compares the two defuzzifiers of the fuzzy engine - Centroid of 100
+ * samples ( as fuzzylite, controller v1.0.0 ) and exact centroid ( v1.1.0 ) -
+ * with a Centroid of REFERENCE_RESOLUTION samples, which is taken as the true
+ * centroid. Same rules are processed with each of them for random inputs, and
+ * errors of each output, gears that differ after rounding and time taken by
+ * the engine with each defuzzifier are printed.
+ *
+ *  usage : <robot>_fuzzy_centroid_report [-n <inputs>] [-t <timed inputs>]
+ *
+ *  -n  random inputs compared with the reference ( it is slow )
+ *  -t  random inputs processed for time of each defuzzifier
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "fuzzy_rule_base.h"
+
+
+#define DEFAULT_INPUTS               1000
+#define DEFAULT_TIMED_INPUTS         200000
+
+// samples of the reference centroid
+#define REFERENCE_RESOLUTION         100000
+
+// ranges of inputs ( a little beyond the values a race gives )
+#define MAX_ABS_PATH                 1.0f
+#define MIN_SPEED                    -5.0f
+#define MAX_SPEED                    120.0f
+#define MIN_ACCELERATION             -5.0f
+#define MAX_ACCELERATION             30.0f
+
+// seed of random inputs ( same inputs for each run, ROBOT_SEED is set by
+// the Makefile of tools of a robot )
+#ifndef ROBOT_SEED
+#error "ROBOT_SEED should be set to seed of random inputs of a robot ( e.g. 222 )"
+#endif
+#define TEST_INPUTS_SEED             ROBOT_SEED
+
+
+using controller_fuzzy::scalar;
+using controller_fuzzy::INPUT_COUNT;
+using controller_fuzzy::OUTPUT_COUNT;
+
+typedef controller_fuzzy::fuzzy_rules<controller_fuzzy::centroid<REFERENCE_RESOLUTION> >::rule_base
+    reference_rule_base;
+
+
+/**
+ * inputs of the engine
+ **/
+typedef struct engine_inputs_struct
+{
+
+    scalar values[INPUT_COUNT];
+
+} engine_inputs;
+
+
+/**
+ * errors of an output from the reference
+ **/
+typedef struct output_error_struct
+{
+
+    double max_error;
+    double error_sum;
+
+} output_error;
+
+
+static const char * OUTPUT_NAMES[OUTPUT_COUNT] = {"steer", "accel", "gear", "brake"};
+
+
+static void print_usage(const char * program_name)
+{
+    printf("usage : %s [-n <inputs>] [-t <timed inputs>]\n", program_name);
+}
+
+
+/* returns seconds of monotonic clock */
+static double get_clock_seconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+
+/* returns a random value from "minimum" to "maximum" */
+static float get_random_value(const float minimum, const float maximum)
+{
+    return minimum + (maximum - minimum) * ((float) rand() / RAND_MAX);
+}
+
+
+/* returns random inputs */
+static void get_random_inputs(const int count, std::vector<engine_inputs> & inputs)
+{
+    inputs.resize(count);
+    for(size_t i = 0; i < inputs.size(); i++)
+    {
+        scalar * values = inputs[i].values;
+        values[controller_fuzzy::SPEED_INPUT] = get_random_value(MIN_SPEED, MAX_SPEED);
+        values[controller_fuzzy::ACCELERATION_INPUT] =
+            get_random_value(MIN_ACCELERATION, MAX_ACCELERATION);
+        values[controller_fuzzy::PATH_INPUT] = get_random_value(-MAX_ABS_PATH, MAX_ABS_PATH);
+        values[controller_fuzzy::NEXT_PATH_INPUT] = get_random_value(-MAX_ABS_PATH, MAX_ABS_PATH);
+        values[controller_fuzzy::STABILITY_INPUT] = get_random_value(0, 1);
+    }
+}
+
+
+/* resets states of all outputs */
+static void reset_states(controller_fuzzy::output_state states[OUTPUT_COUNT])
+{
+    for(int output = 0; output < OUTPUT_COUNT; output++)
+    {
+        controller_fuzzy::reset_output_state(states[output]);
+    }
+}
+
+
+/* adds error of "value" from "reference" */
+static void add_error(output_error & error, const scalar value, const scalar reference)
+{
+    const double difference = fabs(value - reference);
+    error.max_error = std::max(error.max_error, difference);
+    error.error_sum += difference;
+}
+
+
+/* returns gear that FuzzyController would apply for a gear output */
+static int get_rounded_gear(const scalar gear)
+{
+    return (int) (gear > 0 ? ceil(gear) : floor(gear));
+}
+
+
+/**
+ * returns seconds taken by a rule base for the inputs ( steer is added to
+ * "check_sum" so that the work is not left out )
+ **/
+template<typename RuleBase>
+static double time_rule_base(const std::vector<engine_inputs> & inputs, double & check_sum)
+{
+    controller_fuzzy::output_state states[OUTPUT_COUNT];
+    reset_states(states);
+
+    const double start = get_clock_seconds();
+    for(size_t i = 0; i < inputs.size(); i++)
+    {
+        RuleBase::process(inputs[i].values, states);
+        check_sum += states[controller_fuzzy::STEER_OUTPUT].value;
+    }
+
+    return get_clock_seconds() - start;
+}
+
+
+int main(int argc, char * argv[])
+{
+    int input_count = DEFAULT_INPUTS;
+    int timed_input_count = DEFAULT_TIMED_INPUTS;
+
+    int argument = 1;
+    while(argument + 1 < argc)
+    {
+        const std::string option = argv[argument];
+        if(option == "-n")
+        {
+            input_count = atoi(argv[argument + 1]);
+        }
+        else if(option == "-t")
+        {
+            timed_input_count = atoi(argv[argument + 1]);
+        }
+        else
+        {
+            break;
+        }
+        argument += 2;
+    }
+    if(argument != argc || input_count <= 0 || timed_input_count <= 0)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    srand(TEST_INPUTS_SEED);
+    std::vector<engine_inputs> inputs;
+    get_random_inputs(input_count, inputs);
+
+    // each rule base keeps its own outputs from one input to the next
+    controller_fuzzy::output_state sampled_states[OUTPUT_COUNT];
+    controller_fuzzy::output_state exact_states[OUTPUT_COUNT];
+    controller_fuzzy::output_state reference_states[OUTPUT_COUNT];
+    reset_states(sampled_states);
+    reset_states(exact_states);
+    reset_states(reference_states);
+
+    output_error sampled_errors[OUTPUT_COUNT] = {};
+    output_error exact_errors[OUTPUT_COUNT] = {};
+    long long int defuzzified[OUTPUT_COUNT] = {};
+    long long int sampled_gear_differs = 0;
+    long long int exact_gear_differs = 0;
+
+    for(size_t i = 0; i < inputs.size(); i++)
+    {
+        controller_fuzzy::sampled_rule_base::process(inputs[i].values, sampled_states);
+        controller_fuzzy::exact_rule_base::process(inputs[i].values, exact_states);
+        reference_rule_base::process(inputs[i].values, reference_states);
+
+        for(int output = 0; output < OUTPUT_COUNT; output++)
+        {
+            // outputs without activated terms are not defuzzified ( same for all )
+            if(reference_states[output].is_empty)
+            {
+                continue;
+            }
+            defuzzified[output]++;
+
+            add_error(sampled_errors[output], sampled_states[output].value,
+                    reference_states[output].value);
+            add_error(exact_errors[output], exact_states[output].value,
+                    reference_states[output].value);
+        }
+
+        if(!reference_states[controller_fuzzy::GEAR_OUTPUT].is_empty)
+        {
+            const int reference_gear =
+                get_rounded_gear(reference_states[controller_fuzzy::GEAR_OUTPUT].value);
+            sampled_gear_differs += reference_gear !=
+                get_rounded_gear(sampled_states[controller_fuzzy::GEAR_OUTPUT].value);
+            exact_gear_differs += reference_gear !=
+                get_rounded_gear(exact_states[controller_fuzzy::GEAR_OUTPUT].value);
+        }
+    }
+
+    printf("errors from centroid of %d samples for %d random inputs\n",
+            REFERENCE_RESOLUTION, input_count);
+    printf("%-8s %12s %16s %16s %16s %16s\n", "output", "defuzzified",
+            "centroid(100)", "", "exact centroid", "");
+    printf("%-8s %12s %16s %16s %16s %16s\n", "", "", "max error", "mean error",
+            "max error", "mean error");
+    for(int output = 0; output < OUTPUT_COUNT; output++)
+    {
+        const long long int count = std::max(defuzzified[output], 1LL);
+        printf("%-8s %12lld %16.3g %16.3g %16.3g %16.3g\n", OUTPUT_NAMES[output],
+                defuzzified[output], sampled_errors[output].max_error,
+                sampled_errors[output].error_sum / count, exact_errors[output].max_error,
+                exact_errors[output].error_sum / count);
+    }
+    printf("rounded gear differs from reference - centroid(100) %lld, exact centroid %lld\n",
+            sampled_gear_differs, exact_gear_differs);
+
+    std::vector<engine_inputs> timed_inputs;
+    get_random_inputs(timed_input_count, timed_inputs);
+
+    double check_sum = 0;
+    const double sampled_seconds =
+        time_rule_base<controller_fuzzy::sampled_rule_base>(timed_inputs, check_sum);
+    const double exact_seconds =
+        time_rule_base<controller_fuzzy::exact_rule_base>(timed_inputs, check_sum);
+    printf("engine with centroid(100) %.1f ns, with exact centroid %.1f ns per input"
+            " ( %.1f times faster, check sum %g )\n",
+            sampled_seconds * 1e9 / timed_input_count, exact_seconds * 1e9 / timed_input_count,
+            (exact_seconds > 0) ? sampled_seconds / exact_seconds : 0.0, check_sum);
+
+    return 0;
+}
+
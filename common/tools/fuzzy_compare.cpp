@@ -0,0 +1,443 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * fuzzy_compare.cpp
+ *
+ * Compares outputs of the fuzzy engine ( sampled_rule_base of
+ * fuzzy_rule_base.h, processed by fuzzy_engine.h ) with outputs of fuzzylite
+ * for fuzzy controller v1.0.0 ( fuzzylite_reference.h ). Inputs are processed
+ * one after the other by both engines, so previous values of outputs ( gear )
+ * are compared as well :
+ *
+ *  1. a grid of path and speed ( the inputs that rules use ), with the other
+ *     inputs random
+ *  2. random inputs
+ *  3. a trajectory of inputs that change a little at each step, as in a race
+ *
+ * For each output, number of identical values, largest difference and number
+ * of steps with different empty state ( no activated term ) are printed, with
+ * time taken by each engine. Exits with 1 if any value differs by more than
+ * the tolerance ( 0 by default, values should be identical ) or if empty state
+ * of an output differs.
+ *
+ *  usage : <robot>_fuzzy_compare [-p <path points>] [-s <speed points>]
+ *                                [-n <random inputs>] [-t <trajectory steps>]
+ *                                [-e <tolerance>]
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "fuzzy_controller.h"
+#include "fuzzylite_reference.h"
+
+
+// default inputs ( grid steps of 0.005 for path and 0.25 m/s for speed )
+#define DEFAULT_PATH_POINTS          401
+#define DEFAULT_SPEED_POINTS         501
+#define DEFAULT_RANDOM_INPUTS        200000
+#define DEFAULT_TRAJECTORY_STEPS     500000
+
+// ranges of inputs ( a little beyond the values a race gives )
+#define MAX_ABS_PATH                 1.0f
+#define MIN_SPEED                    -5.0f
+#define MAX_SPEED                    120.0f
+#define MIN_ACCELERATION             -5.0f
+#define MAX_ACCELERATION             30.0f
+
+// time between steps of the trajectory ( seconds, robot step of TORCS )
+#define TRAJECTORY_STEP              0.02f
+
+// seed of random inputs ( same inputs for each run, ROBOT_SEED is set by
+// the Makefile of tools of a robot )
+#ifndef ROBOT_SEED
+#error "ROBOT_SEED should be set to seed of random inputs of a robot ( e.g. 222 )"
+#endif
+#define TEST_INPUTS_SEED             ROBOT_SEED
+
+
+using controller_fuzzy::scalar;
+using controller_fuzzy::OUTPUT_COUNT;
+
+
+/**
+ * options of the tool
+ **/
+typedef struct compare_options_struct
+{
+
+    int path_points;
+    int speed_points;
+    int random_inputs;
+    int trajectory_steps;
+    double tolerance;
+
+} compare_options;
+
+
+/**
+ * differences of an output between the two engines
+ **/
+typedef struct output_difference_struct
+{
+
+    long long int identical;
+    long long int empty_differs;
+    double max_difference;
+
+} output_difference;
+
+
+static const char * OUTPUT_NAMES[OUTPUT_COUNT] = {"steer", "accel", "gear", "brake"};
+
+
+static void print_usage(const char * program_name)
+{
+    printf("usage : %s [-p <path points>] [-s <speed points>] [-n <random inputs>]"
+            " [-t <trajectory steps>] [-e <tolerance>]\n", program_name);
+}
+
+
+/**
+ * reads options to "options" and returns 0, or -1 if an option is not valid
+ **/
+static int read_options(int argc, char * argv[], compare_options & options)
+{
+    options.path_points = DEFAULT_PATH_POINTS;
+    options.speed_points = DEFAULT_SPEED_POINTS;
+    options.random_inputs = DEFAULT_RANDOM_INPUTS;
+    options.trajectory_steps = DEFAULT_TRAJECTORY_STEPS;
+    options.tolerance = 0;
+
+    int argument = 1;
+    while(argument + 1 < argc)
+    {
+        const std::string option = argv[argument];
+        const char * value = argv[argument + 1];
+        if(option == "-p")
+        {
+            options.path_points = atoi(value);
+        }
+        else if(option == "-s")
+        {
+            options.speed_points = atoi(value);
+        }
+        else if(option == "-n")
+        {
+            options.random_inputs = atoi(value);
+        }
+        else if(option == "-t")
+        {
+            options.trajectory_steps = atoi(value);
+        }
+        else if(option == "-e")
+        {
+            options.tolerance = atof(value);
+        }
+        else
+        {
+            return -1;
+        }
+        argument += 2;
+    }
+
+    if(argument != argc || options.path_points < 2 || options.speed_points < 2 ||
+            options.random_inputs < 0 || options.trajectory_steps < 0 || options.tolerance < 0)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/* returns seconds of monotonic clock */
+static double get_clock_seconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+
+/* returns a random value from "minimum" to "maximum" */
+static float get_random_value(const float minimum, const float maximum)
+{
+    return minimum + (maximum - minimum) * ((float) rand() / RAND_MAX);
+}
+
+
+/* sets inputs that rules do not use ( yet ) to random values */
+static void set_other_inputs(controller::fuzzy_inputs & inputs)
+{
+    inputs.acceleration = get_random_value(MIN_ACCELERATION, MAX_ACCELERATION);
+    inputs.next_path = get_random_value(-MAX_ABS_PATH, MAX_ABS_PATH);
+    inputs.stability = get_random_value(0, 1);
+}
+
+
+/* returns inputs on a grid of path and speed */
+static void get_grid_inputs(const compare_options & options,
+        std::vector<controller::fuzzy_inputs> & inputs)
+{
+    inputs.resize((size_t) options.path_points * options.speed_points);
+    for(int i = 0; i < options.path_points; i++)
+    {
+        for(int j = 0; j < options.speed_points; j++)
+        {
+            controller::fuzzy_inputs & grid_inputs = inputs[(size_t) i * options.speed_points + j];
+            grid_inputs.path = -MAX_ABS_PATH + 2 * MAX_ABS_PATH * i / (options.path_points - 1);
+            grid_inputs.speed = MIN_SPEED + (MAX_SPEED - MIN_SPEED) * j / (options.speed_points - 1);
+            set_other_inputs(grid_inputs);
+        }
+    }
+}
+
+
+/* returns random inputs */
+static void get_random_inputs(const compare_options & options,
+        std::vector<controller::fuzzy_inputs> & inputs)
+{
+    inputs.resize(options.random_inputs);
+    for(size_t i = 0; i < inputs.size(); i++)
+    {
+        inputs[i].path = get_random_value(-MAX_ABS_PATH, MAX_ABS_PATH);
+        inputs[i].speed = get_random_value(MIN_SPEED, MAX_SPEED);
+        set_other_inputs(inputs[i]);
+    }
+}
+
+
+/**
+ * returns inputs of a car that speeds up and slows down while it weaves
+ * across its path ( path and speed change a little at each step )
+ **/
+static void get_trajectory_inputs(const compare_options & options,
+        std::vector<controller::fuzzy_inputs> & inputs)
+{
+    inputs.resize(options.trajectory_steps);
+
+    float speed = 0;
+    float path = 0;
+    float path_rate = 0;
+    float acceleration = 0;
+    for(size_t i = 0; i < inputs.size(); i++)
+    {
+        // acceleration drifts, and car slows down at top speed
+        acceleration += get_random_value(-1, 1);
+        acceleration = std::max(-10.0f, std::min(10.0f, acceleration));
+        if(speed > MAX_SPEED * 0.9f)
+        {
+            acceleration = -fabsf(acceleration);
+        }
+        speed = std::max(MIN_SPEED, speed + acceleration * TRAJECTORY_STEP);
+
+        // path drifts back to the middle
+        path_rate += get_random_value(-0.05f, 0.05f) - 0.01f * path;
+        path_rate = std::max(-0.5f, std::min(0.5f, path_rate));
+        path = std::max(-MAX_ABS_PATH, std::min(MAX_ABS_PATH, path + path_rate * TRAJECTORY_STEP));
+
+        inputs[i].speed = speed;
+        inputs[i].acceleration = acceleration;
+        inputs[i].path = path;
+        inputs[i].next_path = path + path_rate;
+        inputs[i].stability = fabsf(path_rate);
+    }
+}
+
+
+/**
+ * processes the inputs with both engines ( in this order, each engine keeps
+ * its outputs from one input to the next ) and adds differences of outputs.
+ * Returns number of values that differ by more than the tolerance.
+ **/
+static long long int compare_engines(const std::vector<controller::fuzzy_inputs> & inputs,
+        const double tolerance, controller_fuzzy::output_state states[OUTPUT_COUNT],
+        controller::FuzzyliteReference & reference, output_difference differences[OUTPUT_COUNT])
+{
+    long long int failures = 0;
+    for(size_t i = 0; i < inputs.size(); i++)
+    {
+        scalar engine_inputs[controller_fuzzy::INPUT_COUNT];
+        engine_inputs[controller_fuzzy::SPEED_INPUT] = inputs[i].speed;
+        engine_inputs[controller_fuzzy::ACCELERATION_INPUT] = inputs[i].acceleration;
+        engine_inputs[controller_fuzzy::PATH_INPUT] = inputs[i].path;
+        engine_inputs[controller_fuzzy::NEXT_PATH_INPUT] = inputs[i].next_path;
+        engine_inputs[controller_fuzzy::STABILITY_INPUT] = inputs[i].stability;
+        controller_fuzzy::sampled_rule_base::process(engine_inputs, states);
+
+        scalar reference_values[OUTPUT_COUNT];
+        int reference_is_empty[OUTPUT_COUNT];
+        reference.get_values(&inputs[i], reference_values, reference_is_empty);
+
+        for(int output = 0; output < OUTPUT_COUNT; output++)
+        {
+            const scalar value = states[output].value;
+            const scalar reference_value = reference_values[output];
+
+            // NaN is same as NaN
+            const int is_identical = (value == reference_value) ||
+                (std::isnan(value) && std::isnan(reference_value));
+            const double difference = is_identical ? 0 : fabs(value - reference_value);
+
+            const int empty_differs =
+                (states[output].is_empty != 0) != (reference_is_empty[output] != 0);
+
+            differences[output].identical += is_identical;
+            differences[output].empty_differs += empty_differs;
+            // NaN compared with a number is a failure
+            if(empty_differs || (!is_identical && !(difference <= tolerance)))
+            {
+                failures++;
+            }
+            if(!std::isnan(difference))
+            {
+                differences[output].max_difference =
+                    std::max(differences[output].max_difference, difference);
+            }
+        }
+    }
+
+    return failures;
+}
+
+
+/**
+ * returns seconds taken by each engine for the inputs ( outputs are added
+ * to "check_sum" so that the work is not left out )
+ **/
+static void time_engines(const std::vector<controller::fuzzy_inputs> & inputs,
+        controller::FuzzyliteReference & reference, double & engine_seconds,
+        double & reference_seconds, double & check_sum)
+{
+    controller_fuzzy::output_state states[OUTPUT_COUNT];
+    for(int output = 0; output < OUTPUT_COUNT; output++)
+    {
+        controller_fuzzy::reset_output_state(states[output]);
+    }
+
+    const double engine_start = get_clock_seconds();
+    for(size_t i = 0; i < inputs.size(); i++)
+    {
+        scalar engine_inputs[controller_fuzzy::INPUT_COUNT];
+        engine_inputs[controller_fuzzy::SPEED_INPUT] = inputs[i].speed;
+        engine_inputs[controller_fuzzy::ACCELERATION_INPUT] = inputs[i].acceleration;
+        engine_inputs[controller_fuzzy::PATH_INPUT] = inputs[i].path;
+        engine_inputs[controller_fuzzy::NEXT_PATH_INPUT] = inputs[i].next_path;
+        engine_inputs[controller_fuzzy::STABILITY_INPUT] = inputs[i].stability;
+        controller_fuzzy::sampled_rule_base::process(engine_inputs, states);
+        check_sum += states[controller_fuzzy::STEER_OUTPUT].value;
+    }
+    const double reference_start = get_clock_seconds();
+    for(size_t i = 0; i < inputs.size(); i++)
+    {
+        scalar values[OUTPUT_COUNT];
+        int is_empty[OUTPUT_COUNT];
+        reference.get_values(&inputs[i], values, is_empty);
+        check_sum += values[controller_fuzzy::STEER_OUTPUT];
+    }
+    const double reference_end = get_clock_seconds();
+
+    engine_seconds = reference_start - engine_start;
+    reference_seconds = reference_end - reference_start;
+}
+
+
+int main(int argc, char * argv[])
+{
+    compare_options options;
+    if(read_options(argc, argv, options) != 0)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    controller::FuzzyliteReference reference;
+    std::string message;
+    if(!reference.is_ready(&message))
+    {
+        printf("fuzzylite engine is not ready : %s\n", message.c_str());
+        return 1;
+    }
+
+    srand(TEST_INPUTS_SEED);
+    const char * input_names[] = {"grid", "random", "trajectory"};
+    std::vector<controller::fuzzy_inputs> inputs[3];
+    get_grid_inputs(options, inputs[0]);
+    get_random_inputs(options, inputs[1]);
+    get_trajectory_inputs(options, inputs[2]);
+
+    // both engines start without previous values and keep them through all inputs
+    controller_fuzzy::output_state states[OUTPUT_COUNT];
+    for(int output = 0; output < OUTPUT_COUNT; output++)
+    {
+        controller_fuzzy::reset_output_state(states[output]);
+    }
+
+    long long int failures = 0;
+    for(int i = 0; i < 3; i++)
+    {
+        output_difference differences[OUTPUT_COUNT] = {};
+        failures += compare_engines(inputs[i], options.tolerance, states, reference, differences);
+
+        printf("%s inputs ( %lu )\n", input_names[i], inputs[i].size());
+        printf("    %-8s %14s %16s %14s\n", "output", "identical", "max difference",
+                "empty differs");
+        for(int output = 0; output < OUTPUT_COUNT; output++)
+        {
+            printf("    %-8s %14lld %16.3g %14lld\n", OUTPUT_NAMES[output],
+                    differences[output].identical, differences[output].max_difference,
+                    differences[output].empty_differs);
+        }
+    }
+
+    double engine_seconds = 0;
+    double reference_seconds = 0;
+    double check_sum = 0;
+    time_engines(inputs[1], reference, engine_seconds, reference_seconds, check_sum);
+    if(!inputs[1].empty())
+    {
+        printf("engine %.1f ns, fuzzylite %.1f ns per input ( %.0f times faster,"
+                " check sum %g )\n", engine_seconds * 1e9 / inputs[1].size(),
+                reference_seconds * 1e9 / inputs[1].size(),
+                (engine_seconds > 0) ? reference_seconds / engine_seconds : 0.0, check_sum);
+    }
+
+    if(failures > 0)
+    {
+        printf("%lld values differ by more than %g ( or in empty state )\n", failures,
+                options.tolerance);
+        return 1;
+    }
+    printf("outputs of both engines are within %g\n", options.tolerance);
+
+    return 0;
+}
+
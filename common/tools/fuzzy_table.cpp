@@ -0,0 +1,423 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * fuzzy_table.cpp
+ *
+ * Samples fuzzy engine of fuzzy controller on a grid of path and speed, and
+ * writes a fuzzy table ( see fuzzy_table.h ) that FuzzyController uses instead
+ * of the engine. Each cell of the grid is checked at a few points inside it and
+ * marked exact when interpolated outputs are within a tolerance of the engine.
+ *
+ * Then outputs for random inputs ( all five inputs, within the grid ) are
+ * compared with the engine, and errors of each output, share of inputs within
+ * exact cells and time taken by the table and by the engine are reported.
+ *
+ *  usage : <robot>_fuzzy_table [-p <path points>] [-s <speed points>]
+ *                              [-r <max path>] [-m <max speed>] [-e <tolerance>]
+ *                              [-n <test inputs>] [-f <parameter file>] <table file>
+ *
+ *  -p, -s  points of path and speed axes
+ *  -r      path axis is from -<max path> to <max path>
+ *  -m      speed axis is from 0 to <max speed> ( m/s )
+ *  -e      largest difference of an output from the engine in an exact cell
+ *  -n      random inputs compared with the engine
+ *  -f      fuzzy parameter file ( see fuzzy_parameters.h ) whose terms are
+ *          sampled instead of compiled terms ( table is for its version )
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "fuzzy_controller.h"
+
+
+// default grid ( steps of 0.005 for path and 0.5 m/s for speed )
+#define DEFAULT_PATH_POINTS          401
+#define DEFAULT_SPEED_POINTS         241
+#define DEFAULT_MAX_PATH             1.0
+#define DEFAULT_MAX_SPEED            120.0
+#define DEFAULT_TOLERANCE            1e-3
+#define DEFAULT_TEST_INPUTS          200000
+
+// points checked along each axis inside a cell ( at 1/4, 1/2 and 3/4 of the cell )
+#define CELL_CHECK_POINTS            3
+
+// seed of random inputs ( same inputs for each run, ROBOT_SEED is set by
+// the Makefile of tools of a robot )
+#ifndef ROBOT_SEED
+#error "ROBOT_SEED should be set to seed of random inputs of a robot ( e.g. 222 )"
+#endif
+#define TEST_INPUTS_SEED             ROBOT_SEED
+
+
+/**
+ * options of the tool
+ **/
+typedef struct table_options_struct
+{
+
+    controller::fuzzy_table_axis path_axis;
+    controller::fuzzy_table_axis speed_axis;
+    float tolerance;
+    int test_inputs;
+    const char * parameter_file_name;
+    const char * table_file_name;
+
+} table_options;
+
+
+/**
+ * errors of an output in exact cells
+ **/
+typedef struct output_error_struct
+{
+
+    double max_error;
+    double error_sum;
+
+} output_error;
+
+
+static const char * OUTPUT_NAMES[FUZZY_TABLE_OUTPUTS] = {"steer", "accel", "gear", "brake"};
+
+
+static void print_usage(const char * program_name)
+{
+    printf("usage : %s [-p <path points>] [-s <speed points>] [-r <max path>]"
+            " [-m <max speed>] [-e <tolerance>] [-n <test inputs>] [-f <parameter file>]"
+            " <table file>\n",
+            program_name);
+}
+
+
+/**
+ * reads options to "options" and returns 0, or -1 if an option is not valid
+ **/
+static int read_options(int argc, char * argv[], table_options & options)
+{
+    options.path_axis.minimum = -DEFAULT_MAX_PATH;
+    options.path_axis.maximum = DEFAULT_MAX_PATH;
+    options.path_axis.points = DEFAULT_PATH_POINTS;
+    options.speed_axis.minimum = 0;
+    options.speed_axis.maximum = DEFAULT_MAX_SPEED;
+    options.speed_axis.points = DEFAULT_SPEED_POINTS;
+    options.tolerance = DEFAULT_TOLERANCE;
+    options.test_inputs = DEFAULT_TEST_INPUTS;
+    options.parameter_file_name = NULL;
+    options.table_file_name = NULL;
+
+    int argument = 1;
+    while(argument + 1 < argc)
+    {
+        const std::string option = argv[argument];
+        const char * value = argv[argument + 1];
+        if(option == "-p")
+        {
+            options.path_axis.points = atoi(value);
+        }
+        else if(option == "-s")
+        {
+            options.speed_axis.points = atoi(value);
+        }
+        else if(option == "-r")
+        {
+            options.path_axis.maximum = atof(value);
+            options.path_axis.minimum = -options.path_axis.maximum;
+        }
+        else if(option == "-m")
+        {
+            options.speed_axis.maximum = atof(value);
+        }
+        else if(option == "-e")
+        {
+            options.tolerance = atof(value);
+        }
+        else if(option == "-n")
+        {
+            options.test_inputs = atoi(value);
+        }
+        else if(option == "-f")
+        {
+            options.parameter_file_name = value;
+        }
+        else
+        {
+            return -1;
+        }
+        argument += 2;
+    }
+
+    if(argument != argc - 1 || options.path_axis.points < 2 || options.speed_axis.points < 2 ||
+            options.path_axis.maximum <= 0 || options.speed_axis.maximum <= 0 ||
+            options.tolerance < 0 || options.test_inputs < 0)
+    {
+        return -1;
+    }
+    options.table_file_name = argv[argument];
+
+    return 0;
+}
+
+
+/* returns seconds of monotonic clock */
+static double get_clock_seconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+
+/* returns a random value from "minimum" to "maximum" */
+static float get_random_value(const float minimum, const float maximum)
+{
+    return minimum + (maximum - minimum) * ((float) rand() / RAND_MAX);
+}
+
+
+/* returns non-zero if all outputs are numbers ( gear is NaN if no gear rule fires ) */
+static int has_all_outputs(const float values[FUZZY_TABLE_OUTPUTS])
+{
+    for(int i = 0; i < FUZZY_TABLE_OUTPUTS; i++)
+    {
+        if(std::isnan(values[i]))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+
+/**
+ * runs the engine at each grid point and marks each cell exact if outputs
+ * at its check points are within tolerance of the engine. Returns number of
+ * exact cells.
+ **/
+static int fill_table(controller::FuzzyController & fuzzy_controller,
+        const table_options & options, controller::FuzzyTable & table)
+{
+    const int path_points = options.path_axis.points;
+    const int speed_points = options.speed_axis.points;
+
+    // inputs that rules of the engine do not use are left at 0
+    controller::fuzzy_inputs inputs = {};
+    float values[FUZZY_TABLE_OUTPUTS];
+
+    // grid points with all outputs
+    std::vector<unsigned char> has_outputs((size_t) path_points * speed_points);
+    for(int i = 0; i < path_points; i++)
+    {
+        for(int j = 0; j < speed_points; j++)
+        {
+            inputs.path = table.get_path(i);
+            inputs.speed = table.get_speed(j);
+            fuzzy_controller.get_engine_values(&inputs, values);
+
+            table.set_values(i, j, values);
+            has_outputs[(size_t) i * speed_points + j] = has_all_outputs(values);
+        }
+    }
+
+    int exact_cells = 0;
+    for(int i = 0; i < path_points - 1; i++)
+    {
+        for(int j = 0; j < speed_points - 1; j++)
+        {
+            int is_exact = has_outputs[(size_t) i * speed_points + j] &&
+                has_outputs[(size_t) i * speed_points + j + 1] &&
+                has_outputs[(size_t) (i + 1) * speed_points + j] &&
+                has_outputs[(size_t) (i + 1) * speed_points + j + 1];
+
+            // cell is exact while it is checked, so that the table interpolates in it
+            table.set_exact_cell(i, j, is_exact);
+            for(int k = 1; k <= CELL_CHECK_POINTS && is_exact; k++)
+            {
+                for(int l = 1; l <= CELL_CHECK_POINTS && is_exact; l++)
+                {
+                    const float fraction_of_path = (float) k / (CELL_CHECK_POINTS + 1);
+                    const float fraction_of_speed = (float) l / (CELL_CHECK_POINTS + 1);
+                    inputs.path = table.get_path(i) +
+                        fraction_of_path * (table.get_path(i + 1) - table.get_path(i));
+                    inputs.speed = table.get_speed(j) +
+                        fraction_of_speed * (table.get_speed(j + 1) - table.get_speed(j));
+
+                    float table_values[FUZZY_TABLE_OUTPUTS];
+                    fuzzy_controller.get_engine_values(&inputs, values);
+                    is_exact = has_all_outputs(values) &&
+                        table.get_values(inputs.path, inputs.speed, table_values) == 0;
+                    for(int output = 0; output < FUZZY_TABLE_OUTPUTS && is_exact; output++)
+                    {
+                        is_exact = fabsf(table_values[output] - values[output]) <=
+                            options.tolerance;
+                    }
+                }
+            }
+
+            table.set_exact_cell(i, j, is_exact);
+            exact_cells += is_exact;
+        }
+    }
+
+    return exact_cells;
+}
+
+
+/**
+ * compares outputs of the table with the engine for random inputs within
+ * the grid and prints errors of each output and time taken
+ **/
+static void report_accuracy(controller::FuzzyController & fuzzy_controller,
+        const table_options & options, const controller::FuzzyTable & table)
+{
+    srand(TEST_INPUTS_SEED);
+    std::vector<controller::fuzzy_inputs> test_inputs(options.test_inputs);
+    for(size_t i = 0; i < test_inputs.size(); i++)
+    {
+        test_inputs[i].path = get_random_value(options.path_axis.minimum,
+                options.path_axis.maximum);
+        test_inputs[i].speed = get_random_value(options.speed_axis.minimum,
+                options.speed_axis.maximum);
+        test_inputs[i].acceleration = get_random_value(-5, 30);
+        test_inputs[i].next_path = get_random_value(-1, 1);
+        test_inputs[i].stability = get_random_value(0, 1);
+    }
+
+    output_error errors[FUZZY_TABLE_OUTPUTS] = {};
+    long long int table_inputs = 0;
+    long long int gear_changes = 0;
+    float values[FUZZY_TABLE_OUTPUTS];
+    float table_values[FUZZY_TABLE_OUTPUTS];
+
+    for(size_t i = 0; i < test_inputs.size(); i++)
+    {
+        if(table.get_values(test_inputs[i].path, test_inputs[i].speed, table_values) != 0)
+        {
+            // engine is used for these inputs
+            continue;
+        }
+        table_inputs++;
+
+        fuzzy_controller.get_engine_values(&test_inputs[i], values);
+        for(int output = 0; output < FUZZY_TABLE_OUTPUTS; output++)
+        {
+            const double error = fabs(table_values[output] - values[output]);
+            errors[output].max_error = std::max(errors[output].max_error, error);
+            errors[output].error_sum += error;
+        }
+
+        // gear is rounded up by FuzzyController
+        gear_changes += ceilf(table_values[FUZZY_TABLE_GEAR]) != ceilf(values[FUZZY_TABLE_GEAR]);
+    }
+
+    printf("%lld of %lu random inputs ( %.2f %% ) are in exact cells\n", table_inputs,
+            test_inputs.size(), test_inputs.empty() ? 0.0 : 100.0 * table_inputs / test_inputs.size());
+    printf("%-8s %14s %14s\n", "output", "max error", "mean error");
+    for(int output = 0; output < FUZZY_TABLE_OUTPUTS; output++)
+    {
+        printf("%-8s %14.3g %14.3g\n", OUTPUT_NAMES[output], errors[output].max_error,
+                (table_inputs == 0) ? 0.0 : errors[output].error_sum / table_inputs);
+    }
+    printf("rounded gear differs for %lld inputs\n", gear_changes);
+
+    if(test_inputs.empty())
+    {
+        return;
+    }
+
+    // time of the table ( for all inputs ) and of the engine
+    double check_sum = 0;
+    const double table_start = get_clock_seconds();
+    for(size_t i = 0; i < test_inputs.size(); i++)
+    {
+        if(table.get_values(test_inputs[i].path, test_inputs[i].speed, table_values) == 0)
+        {
+            check_sum += table_values[FUZZY_TABLE_STEER];
+        }
+    }
+    const double engine_start = get_clock_seconds();
+    for(size_t i = 0; i < test_inputs.size(); i++)
+    {
+        fuzzy_controller.get_engine_values(&test_inputs[i], values);
+        check_sum += values[FUZZY_TABLE_STEER];
+    }
+    const double engine_end = get_clock_seconds();
+
+    printf("table lookup %.1f ns, engine %.1f ns per input ( check sum %g )\n",
+            (engine_start - table_start) * 1e9 / test_inputs.size(),
+            (engine_end - engine_start) * 1e9 / test_inputs.size(), check_sum);
+}
+
+
+int main(int argc, char * argv[])
+{
+    using namespace controller;
+
+    table_options options;
+    if(read_options(argc, argv, options) != 0)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    FuzzyController fuzzy_controller;
+    if(options.parameter_file_name != NULL &&
+            fuzzy_controller.use_parameters(options.parameter_file_name) != 0)
+    {
+        return 1;
+    }
+
+    FuzzyTable table;
+    if(table.create(options.path_axis, options.speed_axis, fuzzy_controller.get_version()) != 0)
+    {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    const double start = get_clock_seconds();
+    const int exact_cells = fill_table(fuzzy_controller, options, table);
+    const int cells = (options.path_axis.points - 1) * (options.speed_axis.points - 1);
+    printf("path %g to %g ( %d points ), speed %g to %g ( %d points ) - %d of %d cells"
+            " are exact ( %.2f %% ) in %.1f s\n", options.path_axis.minimum,
+            options.path_axis.maximum, options.path_axis.points, options.speed_axis.minimum,
+            options.speed_axis.maximum, options.speed_axis.points, exact_cells, cells,
+            100.0 * exact_cells / cells, get_clock_seconds() - start);
+
+    if(table.write_to_file(options.table_file_name) != 0)
+    {
+        return 1;
+    }
+
+    report_accuracy(fuzzy_controller, options, table);
+
+    return 0;
+}
+
@@ -0,0 +1,1202 @@
+/*
+ * =====================================================================================
+ * Copyright (C) 2018 M.S.Khan
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * =====================================================================================
+ */
+
+/*
+ * fuzzy_tune.cpp
+ *
+ * Tunes vertices of terms of fuzzy controller with CMA-ES and writes them as
+ * a fuzzy parameter file ( see fuzzy_parameters.h ) of a new version, which
+ * the robot ( ROBOT_NAME, set by the Makefile of its tools ) uses instead of
+ * its compiled terms.
+ *
+ *  usage : <robot>_fuzzy_tune [-s <simulator>] [-t <track file>]... [-l <laps>]
+ *                             [-m <max race time>] [-x <variables>] [-i <parameter file>]
+ *                             [-g <generations>] [-n <population>] [-e <step size>]
+ *                             [-j <jobs>] [-d <damage penalty>] [-o <off track penalty>]
+ *                             [-r <seed>] [-v <version>] [-w <work directory>]
+ *                             <parameter file>
+ *
+ *  -s  headless simulator of the robot in race mode ( default ../sim/<robot>_sim )
+ *  -t  track file of the simulator, once for each track ( default both tracks
+ *      of the simulator )
+ *  -l  laps of each race
+ *  -m  race ends after this race time ( seconds ) even if the car is racing
+ *  -x  variables whose terms are tuned, separated by commas ( default are the
+ *      variables that rules use - speed, path and all outputs )
+ *  -i  parameters to start from ( default compiled terms )
+ *  -g  generations of CMA-ES
+ *  -n  candidates of each generation ( default 4 + 3 ln(number of vertices) )
+ *  -e  initial step size, as a share of range of vertices of each variable
+ *  -j  races run at the same time ( default number of processors )
+ *  -d  cost of a unit of damage ( seconds )
+ *  -o  cost of a second outside the track ( seconds )
+ *  -r  seed of random samples
+ *  -v  version of written parameters
+ *  -w  directory for simulator runs
+ *
+ * Each candidate races once on each track, and each race is a simulator
+ * process of its own ( with HOME set to a directory of a job slot, where its
+ * parameter file is written ), so races of a generation run independently on
+ * all processors. Files of the robot ( in its directory of HOME ) whose names
+ * start with LINKED_FILE_PREFIX, if it is set ( Q value files of car222 ), are
+ * linked in each job slot, so races drive with the same files as the robot
+ * does in race mode. Cost of a candidate is the sum over tracks of race time
+ * ( or, if the car didn't finish, race time plus time to cover the rest of the
+ * race at UNFINISHED_SPEED ) and penalties for damage and time off the track.
+ *
+ * Candidates are steps from the initial parameters, scaled by range of each
+ * variable. Vertices of a candidate are put back in order of their shape
+ * ( and ramps keep their direction ) before it races, and the distance moved
+ * is added to its cost. Best parameters so far are written after each
+ * generation that finds better ones, so a long run can be stopped at any time.
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: M.S.Khan
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "fuzzy_controller.h"
+
+
+#ifndef ROBOT_NAME
+#error "ROBOT_NAME should be set to name of a robot ( e.g. \"car222\" )"
+#endif
+#ifndef ROBOT_SEED
+#error "ROBOT_SEED should be set to default seed of a robot ( e.g. 222 )"
+#endif
+
+// defaults of options
+#define DEFAULT_SIMULATOR            "../sim/" ROBOT_NAME "_sim"
+#define DEFAULT_TRACK_FILES          {"../../common/sim/tracks/sim-circuit.trk", \
+                                      "../../common/sim/tracks/sim-speedway.trk"}
+#define DEFAULT_LAPS                 3
+#define DEFAULT_MAX_RACE_TIME        600
+#define DEFAULT_VARIABLES            "speed,path,steer,accel,gear,brake"
+#define DEFAULT_GENERATIONS          200
+#define DEFAULT_STEP_SIZE            0.05
+#define DEFAULT_DAMAGE_PENALTY       0.01
+#define DEFAULT_OFF_TRACK_PENALTY    1.0
+#define DEFAULT_SEED                 ROBOT_SEED
+#define DEFAULT_VERSION              FUZZY_CONTROLLER_VERSION "-tuned"
+#define DEFAULT_WORK_DIRECTORY       "/tmp/" ROBOT_NAME "_fuzzy_tune"
+
+// speed ( m/s ) of a car that didn't finish, for the rest of the race
+#define UNFINISHED_SPEED             10.0
+
+// cost of a unit of distance ( in steps ) that vertices moved to be in order
+#define ORDER_PENALTY                100.0
+
+// smallest width of ramps and rectangles, as a share of range of the variable
+#define MIN_TERM_WIDTH               1e-3
+
+// longest line of simulator output
+#define OUTPUT_LINE_SIZE             512
+
+
+/**
+ * options of the tool
+ **/
+typedef struct tune_options_struct
+{
+
+    std::string simulator;
+    std::vector<std::string> track_files;
+    int laps;
+    double max_race_time;
+    std::string variables;
+    const char * initial_file_name;
+    int generations;
+    int population;
+    double step_size;
+    int jobs;
+    double damage_penalty;
+    double off_track_penalty;
+    unsigned int seed;
+    std::string version;
+    std::string work_directory;
+    const char * parameter_file_name;
+
+} tune_options;
+
+
+/**
+ * a vertex that is tuned - its term, which vertex of the term it is ( 0 for
+ * "a" to 3 for "d" ) and its scale ( range of vertices of its variable )
+ **/
+typedef struct tuned_vertex_struct
+{
+
+    int term_index;
+    int vertex;
+    double scale;
+
+} tuned_vertex;
+
+
+/**
+ * result of a race from simulator output
+ **/
+typedef struct race_result_struct
+{
+
+    double track_length;
+    double race_time;
+    int laps;
+    double distance_raced;
+    double finish_time;
+    int damage;
+    double off_track_time;
+
+} race_result;
+
+
+/**
+ * state of CMA-ES ( covariance matrix adaptation evolution strategy, with
+ * weighted recombination of the best half and rank-one and rank-mu updates )
+ **/
+typedef struct cma_state_struct
+{
+
+    int dimension;
+    int population;
+    int parents;
+    std::vector<double> weights;
+    double mu_effective;
+
+    // learning rates and damping
+    double c_sigma;
+    double d_sigma;
+    double c_c;
+    double c_1;
+    double c_mu;
+    double expected_norm;
+
+    // mean, step size, evolution paths and covariance ( row major )
+    std::vector<double> mean;
+    double sigma;
+    std::vector<double> path_sigma;
+    std::vector<double> path_c;
+    std::vector<double> covariance;
+
+    // eigenvectors ( columns ) and square roots of eigenvalues of covariance
+    std::vector<double> eigenvectors;
+    std::vector<double> eigen_roots;
+    int eigen_generation;
+
+} cma_state;
+
+
+/**
+ * a sampled candidate - standard normal sample, step from mean and position
+ **/
+typedef struct candidate_struct
+{
+
+    std::vector<double> z;
+    std::vector<double> y;
+    std::vector<double> x;
+    double cost;
+
+} candidate;
+
+
+static void print_usage(const char * program_name)
+{
+    printf("usage : %s [-s <simulator>] [-t <track file>]... [-l <laps>] [-m <max race time>]"
+            " [-x <variables>] [-i <parameter file>] [-g <generations>] [-n <population>]"
+            " [-e <step size>] [-j <jobs>] [-d <damage penalty>] [-o <off track penalty>]"
+            " [-r <seed>] [-v <version>] [-w <work directory>] <parameter file>\n",
+            program_name);
+}
+
+
+/**
+ * reads options to "options" and returns 0, 1 if usage is asked for ( with
+ * -h or --help ) or -1 if an option is not valid
+ **/
+static int read_options(int argc, char * argv[], tune_options & options)
+{
+    for(int argument = 1; argument < argc; argument++)
+    {
+        if(strcmp(argv[argument], "-h") == 0 || strcmp(argv[argument], "--help") == 0)
+        {
+            return 1;
+        }
+    }
+
+    options.simulator = DEFAULT_SIMULATOR;
+    options.laps = DEFAULT_LAPS;
+    options.max_race_time = DEFAULT_MAX_RACE_TIME;
+    options.variables = DEFAULT_VARIABLES;
+    options.initial_file_name = NULL;
+    options.generations = DEFAULT_GENERATIONS;
+    options.population = 0;
+    options.step_size = DEFAULT_STEP_SIZE;
+    options.jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    options.damage_penalty = DEFAULT_DAMAGE_PENALTY;
+    options.off_track_penalty = DEFAULT_OFF_TRACK_PENALTY;
+    options.seed = DEFAULT_SEED;
+    options.version = DEFAULT_VERSION;
+    options.work_directory = DEFAULT_WORK_DIRECTORY;
+    options.parameter_file_name = NULL;
+
+    int argument = 1;
+    while(argument + 1 < argc)
+    {
+        const std::string option = argv[argument];
+        const char * value = argv[argument + 1];
+        if(option == "-s")
+        {
+            options.simulator = value;
+        }
+        else if(option == "-t")
+        {
+            options.track_files.push_back(value);
+        }
+        else if(option == "-l")
+        {
+            options.laps = atoi(value);
+        }
+        else if(option == "-m")
+        {
+            options.max_race_time = atof(value);
+        }
+        else if(option == "-x")
+        {
+            options.variables = value;
+        }
+        else if(option == "-i")
+        {
+            options.initial_file_name = value;
+        }
+        else if(option == "-g")
+        {
+            options.generations = atoi(value);
+        }
+        else if(option == "-n")
+        {
+            options.population = atoi(value);
+        }
+        else if(option == "-e")
+        {
+            options.step_size = atof(value);
+        }
+        else if(option == "-j")
+        {
+            options.jobs = atoi(value);
+        }
+        else if(option == "-d")
+        {
+            options.damage_penalty = atof(value);
+        }
+        else if(option == "-o")
+        {
+            options.off_track_penalty = atof(value);
+        }
+        else if(option == "-r")
+        {
+            options.seed = strtoul(value, NULL, 10);
+        }
+        else if(option == "-v")
+        {
+            options.version = value;
+        }
+        else if(option == "-w")
+        {
+            options.work_directory = value;
+        }
+        else
+        {
+            return -1;
+        }
+        argument += 2;
+    }
+
+    if(options.track_files.empty())
+    {
+        options.track_files = DEFAULT_TRACK_FILES;
+    }
+
+    if(argument != argc - 1 || options.laps <= 0 || options.max_race_time <= 0 ||
+            options.generations < 0 || options.population < 0 || options.population == 1 ||
+            options.step_size <= 0 || options.jobs <= 0 || options.damage_penalty < 0 ||
+            options.off_track_penalty < 0 || options.version.empty() ||
+            options.version.size() >= FUZZY_PARAMETERS_VERSION_SIZE ||
+            options.version.find_first_of(" \t") != std::string::npos)
+    {
+        return -1;
+    }
+
+    // a mistyped option is not taken as name of the tuned parameter file
+    if(argv[argument][0] == '-')
+    {
+        return -1;
+    }
+    options.parameter_file_name = argv[argument];
+
+    return 0;
+}
+
+
+/* returns seconds of monotonic clock */
+static double get_clock_seconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+
+/* returns a vertex of a term ( 0 for "a" to 3 for "d" ) */
+static double get_vertex(const controller_fuzzy::term & t, const int vertex)
+{
+    return (vertex == 0) ? t.a : ((vertex == 1) ? t.b : ((vertex == 2) ? t.c : t.d));
+}
+
+
+/* sets a vertex of a term */
+static void set_vertex(controller_fuzzy::term & t, const int vertex, const double value)
+{
+    double * vertices[4] = {&t.a, &t.b, &t.c, &t.d};
+    *vertices[vertex] = value;
+}
+
+
+/* returns number of vertices of a term */
+static int get_vertex_count(const controller_fuzzy::term & t)
+{
+    return (t.shape == controller_fuzzy::TRAPEZOID) ? 4 : 2;
+}
+
+
+/**
+ * finds vertices of terms of the tuned variables ( names separated by commas ),
+ * scaled by range of vertices of each variable in "initial". Returns 0 on
+ * success and -1 if a name is not a variable.
+ **/
+static int find_tuned_vertices(const std::string & variables,
+        const controller_fuzzy::fuzzy_parameters & initial, std::vector<tuned_vertex> & vertices)
+{
+    vertices.clear();
+
+    size_t start = 0;
+    while(start <= variables.size())
+    {
+        size_t end = variables.find(',', start);
+        if(end == std::string::npos)
+        {
+            end = variables.size();
+        }
+        const std::string name = variables.substr(start, end - start);
+        start = end + 1;
+
+        // range of vertices of the variable
+        double minimum = INFINITY;
+        double maximum = -INFINITY;
+        for(int i = 0; i < controller_fuzzy::TERM_COUNT; i++)
+        {
+            const controller_fuzzy::term & t = initial.terms[i];
+            for(int v = 0; v < get_vertex_count(t) && name == controller_fuzzy::get_variable_name(i);
+                    v++)
+            {
+                minimum = std::min(minimum, get_vertex(t, v));
+                maximum = std::max(maximum, get_vertex(t, v));
+            }
+        }
+        if(!(minimum < maximum))
+        {
+            printf("\'%s\' is not a variable of fuzzy controller\n", name.c_str());
+            return -1;
+        }
+
+        for(int i = 0; i < controller_fuzzy::TERM_COUNT; i++)
+        {
+            for(int v = 0; v < get_vertex_count(initial.terms[i]) &&
+                    name == controller_fuzzy::get_variable_name(i); v++)
+            {
+                vertices.push_back(tuned_vertex{i, v, maximum - minimum});
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+/**
+ * sets tuned vertices of "parameters" from position "x" ( steps from "initial" )
+ * and puts vertices of each term in order of its shape. Returns squared
+ * distance ( in steps ) that vertices moved to be in order.
+ **/
+static double set_parameters(const std::vector<tuned_vertex> & vertices, const double x[],
+        const controller_fuzzy::fuzzy_parameters & initial,
+        controller_fuzzy::fuzzy_parameters & parameters)
+{
+    parameters = initial;
+    for(size_t k = 0; k < vertices.size(); k++)
+    {
+        controller_fuzzy::term & t = parameters.terms[vertices[k].term_index];
+        set_vertex(t, vertices[k].vertex,
+                get_vertex(t, vertices[k].vertex) + vertices[k].scale * x[k]);
+    }
+
+    // smallest width of ramps and rectangles of each term
+    std::vector<double> min_widths(controller_fuzzy::TERM_COUNT, 0);
+    for(size_t k = 0; k < vertices.size(); k++)
+    {
+        min_widths[vertices[k].term_index] = MIN_TERM_WIDTH * vertices[k].scale;
+    }
+
+    for(int i = 0; i < controller_fuzzy::TERM_COUNT; i++)
+    {
+        controller_fuzzy::term & t = parameters.terms[i];
+        const controller_fuzzy::term & initial_term = initial.terms[i];
+        switch(t.shape)
+        {
+            case controller_fuzzy::TRAPEZOID :
+                {
+                    double sorted[4] = {t.a, t.b, t.c, t.d};
+                    std::sort(sorted, sorted + 4);
+                    t.a = sorted[0];
+                    t.b = sorted[1];
+                    t.c = sorted[2];
+                    t.d = sorted[3];
+                }
+                break;
+
+            case controller_fuzzy::RAMP :
+                // ramp keeps its direction
+                if(initial_term.b > initial_term.a && t.b < t.a + min_widths[i])
+                {
+                    t.b = t.a + min_widths[i];
+                }
+                else if(initial_term.b < initial_term.a && t.b > t.a - min_widths[i])
+                {
+                    t.b = t.a - min_widths[i];
+                }
+                break;
+
+            case controller_fuzzy::RECTANGLE :
+                if(t.b < t.a)
+                {
+                    std::swap(t.a, t.b);
+                }
+                t.b = std::max(t.b, t.a + min_widths[i]);
+                break;
+        }
+    }
+
+    double moved = 0;
+    for(size_t k = 0; k < vertices.size(); k++)
+    {
+        const int i = vertices[k].term_index;
+        const double step = (get_vertex(parameters.terms[i], vertices[k].vertex) -
+                get_vertex(initial.terms[i], vertices[k].vertex)) / vertices[k].scale;
+        moved += (step - x[k]) * (step - x[k]);
+    }
+
+    return moved;
+}
+
+
+/* makes a directory and its parents, returns 0 on success and -1 on failure */
+static int make_directories(const std::string & directory)
+{
+    for(size_t end = directory.find('/', 1); ; end = directory.find('/', end + 1))
+    {
+        const std::string path = directory.substr(0, end);
+        if(mkdir(path.c_str(), 0755) != 0 && errno != EEXIST)
+        {
+            printf("couldn't create directory \'%s\'\n", path.c_str());
+            return -1;
+        }
+        if(end == std::string::npos)
+        {
+            return 0;
+        }
+    }
+}
+
+
+/* removes files of a directory that are not links ( files written by the robot ) */
+static void remove_files(const std::string & directory)
+{
+    DIR * dir = opendir(directory.c_str());
+    if(dir == NULL)
+    {
+        return;
+    }
+
+    struct dirent * entry;
+    while((entry = readdir(dir)) != NULL)
+    {
+        const std::string path = directory + "/" + entry->d_name;
+        struct stat status;
+        if(lstat(path.c_str(), &status) == 0 && S_ISREG(status.st_mode))
+        {
+            unlink(path.c_str());
+        }
+    }
+    closedir(dir);
+}
+
+
+#ifdef LINKED_FILE_PREFIX
+
+/* links files of the robot ( in its directory of HOME ) in a directory */
+static void link_robot_files(const std::string & directory)
+{
+    const char * home = getenv("HOME");
+    if(home == NULL)
+    {
+        return;
+    }
+
+    const std::string robot_directory = std::string(home) + "/.torcs/drivers/" ROBOT_NAME;
+    DIR * dir = opendir(robot_directory.c_str());
+    if(dir == NULL)
+    {
+        return;
+    }
+
+    struct dirent * entry;
+    while((entry = readdir(dir)) != NULL)
+    {
+        if(strncmp(entry->d_name, LINKED_FILE_PREFIX, strlen(LINKED_FILE_PREFIX)) == 0)
+        {
+            const std::string link_name = directory + "/" + entry->d_name;
+            unlink(link_name.c_str());
+            if(symlink((robot_directory + "/" + entry->d_name).c_str(), link_name.c_str()) != 0)
+            {
+                printf("couldn't link \'%s\' in \'%s\'\n", entry->d_name, directory.c_str());
+            }
+        }
+    }
+    closedir(dir);
+}
+
+#endif
+
+
+/* home directory of a job slot and directory of the robot in it */
+static std::string get_slot_home(const tune_options & options, const int slot)
+{
+    char name[32];
+    sprintf(name, "/slot%d", slot);
+
+    return options.work_directory + name;
+}
+
+static std::string get_slot_robot_directory(const tune_options & options, const int slot)
+{
+    return get_slot_home(options, slot) + "/.torcs/drivers/" ROBOT_NAME;
+}
+
+
+/**
+ * starts a simulator race of the parameters on a track in a job slot and
+ * returns its process id, or -1 on failure. Output goes to "race.out" of
+ * the slot.
+ **/
+static pid_t start_race(const tune_options & options, const int slot,
+        const controller_fuzzy::fuzzy_parameters & parameters, const std::string & track_file)
+{
+    const std::string robot_directory = get_slot_robot_directory(options, slot);
+    remove_files(robot_directory);
+    if(controller_fuzzy::write_parameters((robot_directory + "/fuzzy_parameters.txt").c_str(),
+                parameters) != 0)
+    {
+        return -1;
+    }
+
+    const std::string home = get_slot_home(options, slot);
+    const std::string output_file_name = home + "/race.out";
+
+    char laps[16];
+    char max_race_time[32];
+    sprintf(laps, "%d", options.laps);
+    sprintf(max_race_time, "%g", options.max_race_time);
+
+    const char * arguments[] = {options.simulator.c_str(), "-t", track_file.c_str(),
+        "-n", "1", "-l", laps, "-c", "1", "-m", max_race_time, NULL};
+
+    fflush(stdout);
+    const pid_t pid = fork();
+    if(pid == 0)
+    {
+        const int output = open(output_file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if(output < 0 || setenv("HOME", home.c_str(), 1) != 0)
+        {
+            _exit(126);
+        }
+        dup2(output, STDOUT_FILENO);
+        dup2(output, STDERR_FILENO);
+        close(output);
+
+        execv(arguments[0], (char * const *) arguments);
+        _exit(127);
+    }
+
+    return pid;
+}
+
+
+/**
+ * reads result of the race of a job slot from its output, returns 0 on
+ * success and -1 if the output has no result
+ **/
+static int read_race_result(const tune_options & options, const int slot, race_result & result)
+{
+    const std::string output_file_name = get_slot_home(options, slot) + "/race.out";
+    FILE * file = fopen(output_file_name.c_str(), "r");
+    if(file == NULL)
+    {
+        return -1;
+    }
+
+    int has_track = 0;
+    int has_race = 0;
+    int has_car = 0;
+    char line[OUTPUT_LINE_SIZE];
+    while(fgets(line, sizeof(line), file) != NULL)
+    {
+        float distance_raced;
+        const char * text = strstr(line, "\" - ");
+        if(strncmp(line, "track \"", 7) == 0 && text != NULL)
+        {
+            has_track = sscanf(text, "\" - %*d segments, %lf m", &result.track_length) == 1;
+        }
+        else if(sscanf(line, "race %*d - %lf s race time", &result.race_time) == 1)
+        {
+            has_race = 1;
+        }
+        else if(sscanf(line, " car %*d - %d laps, %f m, best lap %*f s, finish %lf s,"
+                    " damage %d, off track %lf s", &result.laps, &distance_raced,
+                    &result.finish_time, &result.damage, &result.off_track_time) == 5)
+        {
+            result.distance_raced = distance_raced;
+            has_car = 1;
+        }
+    }
+    fclose(file);
+
+    return (has_track && has_race && has_car) ? 0 : -1;
+}
+
+
+/* returns cost of a race result */
+static double get_race_cost(const tune_options & options, const race_result & result)
+{
+    double time = result.finish_time;
+    if(time <= 0)
+    {
+        const double rest = std::max(0.0, options.laps * result.track_length -
+                result.distance_raced);
+        time = result.race_time + rest / UNFINISHED_SPEED;
+    }
+
+    return time + options.damage_penalty * result.damage +
+        options.off_track_penalty * result.off_track_time;
+}
+
+
+/**
+ * races each parameter set on each track, with up to "jobs" simulators at a
+ * time, and fills results ( for set i and track j at i * tracks + j ).
+ * Returns 0 on success and -1 if a race failed.
+ **/
+static int run_races(const tune_options & options,
+        const std::vector<controller_fuzzy::fuzzy_parameters> & parameters,
+        std::vector<race_result> & results)
+{
+    const int tracks = options.track_files.size();
+    const int races = parameters.size() * tracks;
+    results.resize(races);
+
+    std::vector<pid_t> slot_pids(options.jobs, 0);
+    std::vector<int> slot_races(options.jobs, -1);
+    int next_race = 0;
+    int running = 0;
+    int status = 0;
+    while((next_race < races && status == 0) || running > 0)
+    {
+        // free slots start next races
+        for(int slot = 0; slot < options.jobs && next_race < races && status == 0; slot++)
+        {
+            if(slot_pids[slot] != 0)
+            {
+                continue;
+            }
+
+            slot_pids[slot] = start_race(options, slot, parameters[next_race / tracks],
+                    options.track_files[next_race % tracks]);
+            if(slot_pids[slot] < 0)
+            {
+                slot_pids[slot] = 0;
+                status = -1;
+                break;
+            }
+            slot_races[slot] = next_race++;
+            running++;
+        }
+        if(running == 0)
+        {
+            break;
+        }
+
+        int exit_status;
+        const pid_t pid = wait(&exit_status);
+        if(pid < 0)
+        {
+            return -1;
+        }
+        for(int slot = 0; slot < options.jobs; slot++)
+        {
+            if(slot_pids[slot] != pid)
+            {
+                continue;
+            }
+
+            slot_pids[slot] = 0;
+            running--;
+
+            const int race = slot_races[slot];
+            if(!WIFEXITED(exit_status) || WEXITSTATUS(exit_status) != 0 ||
+                    read_race_result(options, slot, results[race]) != 0)
+            {
+                printf("race on \'%s\' failed ( see %s/race.out )\n",
+                        options.track_files[race % tracks].c_str(),
+                        get_slot_home(options, slot).c_str());
+                status = -1;
+            }
+        }
+    }
+
+    return status;
+}
+
+
+/**
+ * sets up CMA-ES for "dimension" steps from mean 0, with step size "sigma"
+ * and "population" candidates ( default size if 0 )
+ **/
+static void init_cma(cma_state & cma, const int dimension, const int population,
+        const double sigma)
+{
+    const double n = dimension;
+
+    cma.dimension = dimension;
+    cma.population = (population > 0) ? population : 4 + (int) (3 * log(n));
+    cma.parents = cma.population / 2;
+
+    cma.weights.resize(cma.parents);
+    double weight_sum = 0;
+    for(int i = 0; i < cma.parents; i++)
+    {
+        cma.weights[i] = log(cma.parents + 0.5) - log(i + 1.0);
+        weight_sum += cma.weights[i];
+    }
+    double square_sum = 0;
+    for(int i = 0; i < cma.parents; i++)
+    {
+        cma.weights[i] /= weight_sum;
+        square_sum += cma.weights[i] * cma.weights[i];
+    }
+    cma.mu_effective = 1 / square_sum;
+
+    const double mu = cma.mu_effective;
+    cma.c_sigma = (mu + 2) / (n + mu + 5);
+    cma.d_sigma = 1 + 2 * std::max(0.0, sqrt((mu - 1) / (n + 1)) - 1) + cma.c_sigma;
+    cma.c_c = (4 + mu / n) / (n + 4 + 2 * mu / n);
+    cma.c_1 = 2 / ((n + 1.3) * (n + 1.3) + mu);
+    cma.c_mu = std::min(1 - cma.c_1, 2 * (mu - 2 + 1 / mu) / ((n + 2) * (n + 2) + mu));
+    cma.expected_norm = sqrt(n) * (1 - 1 / (4 * n) + 1 / (21 * n * n));
+
+    cma.mean.assign(dimension, 0);
+    cma.sigma = sigma;
+    cma.path_sigma.assign(dimension, 0);
+    cma.path_c.assign(dimension, 0);
+    cma.covariance.assign(dimension * dimension, 0);
+    cma.eigenvectors.assign(dimension * dimension, 0);
+    cma.eigen_roots.assign(dimension, 1);
+    for(int i = 0; i < dimension; i++)
+    {
+        cma.covariance[i * dimension + i] = 1;
+        cma.eigenvectors[i * dimension + i] = 1;
+    }
+    cma.eigen_generation = 0;
+}
+
+
+/**
+ * eigenvectors and square roots of eigenvalues of covariance, by cyclic
+ * Jacobi rotations ( covariance is small and symmetric )
+ **/
+static void update_eigen(cma_state & cma)
+{
+    const int n = cma.dimension;
+    std::vector<double> a = cma.covariance;
+    std::vector<double> & v = cma.eigenvectors;
+    std::fill(v.begin(), v.end(), 0.0);
+    for(int i = 0; i < n; i++)
+    {
+        v[i * n + i] = 1;
+    }
+
+    for(int sweep = 0; sweep < 50; sweep++)
+    {
+        double off_diagonal = 0;
+        double diagonal = 0;
+        for(int i = 0; i < n; i++)
+        {
+            diagonal += a[i * n + i] * a[i * n + i];
+            for(int j = i + 1; j < n; j++)
+            {
+                off_diagonal += a[i * n + j] * a[i * n + j];
+            }
+        }
+        if(off_diagonal <= 1e-24 * diagonal)
+        {
+            break;
+        }
+
+        for(int p = 0; p < n; p++)
+        {
+            for(int q = p + 1; q < n; q++)
+            {
+                const double apq = a[p * n + q];
+                if(apq == 0)
+                {
+                    continue;
+                }
+
+                const double theta = (a[q * n + q] - a[p * n + p]) / (2 * apq);
+                const double t = ((theta >= 0) ? 1 : -1) / (fabs(theta) + sqrt(theta * theta + 1));
+                const double c = 1 / sqrt(t * t + 1);
+                const double s = t * c;
+
+                for(int k = 0; k < n; k++)
+                {
+                    const double akp = a[k * n + p];
+                    const double akq = a[k * n + q];
+                    a[k * n + p] = c * akp - s * akq;
+                    a[k * n + q] = s * akp + c * akq;
+                }
+                for(int k = 0; k < n; k++)
+                {
+                    const double apk = a[p * n + k];
+                    const double aqk = a[q * n + k];
+                    a[p * n + k] = c * apk - s * aqk;
+                    a[q * n + k] = s * apk + c * aqk;
+                }
+                for(int k = 0; k < n; k++)
+                {
+                    const double vkp = v[k * n + p];
+                    const double vkq = v[k * n + q];
+                    v[k * n + p] = c * vkp - s * vkq;
+                    v[k * n + q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    for(int i = 0; i < n; i++)
+    {
+        cma.eigen_roots[i] = sqrt(std::max(a[i * n + i], 1e-20));
+    }
+}
+
+
+/* samples candidates of a generation around the mean */
+static void sample_candidates(const cma_state & cma, std::mt19937 & random,
+        std::vector<candidate> & candidates)
+{
+    const int n = cma.dimension;
+    std::normal_distribution<double> normal(0.0, 1.0);
+
+    candidates.resize(cma.population);
+    for(int k = 0; k < cma.population; k++)
+    {
+        candidate & c = candidates[k];
+        c.z.resize(n);
+        c.y.assign(n, 0);
+        c.x.resize(n);
+        for(int i = 0; i < n; i++)
+        {
+            c.z[i] = normal(random);
+        }
+
+        // y = B D z
+        for(int i = 0; i < n; i++)
+        {
+            for(int j = 0; j < n; j++)
+            {
+                c.y[i] += cma.eigenvectors[i * n + j] * cma.eigen_roots[j] * c.z[j];
+            }
+            c.x[i] = cma.mean[i] + cma.sigma * c.y[i];
+        }
+    }
+}
+
+
+/* moves mean, step size and covariance towards the best candidates ( sorted by cost ) */
+static void update_cma(cma_state & cma, const std::vector<candidate> & candidates,
+        const int generation)
+{
+    const int n = cma.dimension;
+
+    // weighted steps of the best candidates ( in y and in z )
+    std::vector<double> y_mean(n, 0);
+    std::vector<double> z_mean(n, 0);
+    for(int k = 0; k < cma.parents; k++)
+    {
+        for(int i = 0; i < n; i++)
+        {
+            y_mean[i] += cma.weights[k] * candidates[k].y[i];
+            z_mean[i] += cma.weights[k] * candidates[k].z[i];
+        }
+    }
+    for(int i = 0; i < n; i++)
+    {
+        cma.mean[i] += cma.sigma * y_mean[i];
+    }
+
+    // path of step size uses C^(-1/2) y = B z
+    const double sigma_rate = sqrt(cma.c_sigma * (2 - cma.c_sigma) * cma.mu_effective);
+    double path_norm = 0;
+    for(int i = 0; i < n; i++)
+    {
+        double bz = 0;
+        for(int j = 0; j < n; j++)
+        {
+            bz += cma.eigenvectors[i * n + j] * z_mean[j];
+        }
+        cma.path_sigma[i] = (1 - cma.c_sigma) * cma.path_sigma[i] + sigma_rate * bz;
+        path_norm += cma.path_sigma[i] * cma.path_sigma[i];
+    }
+    path_norm = sqrt(path_norm);
+
+    const int is_stalled = path_norm / sqrt(1 - pow(1 - cma.c_sigma, 2.0 * (generation + 1))) /
+        cma.expected_norm < 1.4 + 2 / (n + 1.0);
+    const double c_rate = sqrt(cma.c_c * (2 - cma.c_c) * cma.mu_effective);
+    for(int i = 0; i < n; i++)
+    {
+        cma.path_c[i] = (1 - cma.c_c) * cma.path_c[i] + (is_stalled ? c_rate * y_mean[i] : 0);
+    }
+
+    // rank-one and rank-mu updates of covariance
+    const double lost = is_stalled ? 0 : cma.c_1 * cma.c_c * (2 - cma.c_c);
+    for(int i = 0; i < n; i++)
+    {
+        for(int j = 0; j <= i; j++)
+        {
+            double rank_mu = 0;
+            for(int k = 0; k < cma.parents; k++)
+            {
+                rank_mu += cma.weights[k] * candidates[k].y[i] * candidates[k].y[j];
+            }
+            const double value = (1 - cma.c_1 - cma.c_mu + lost) * cma.covariance[i * n + j] +
+                cma.c_1 * cma.path_c[i] * cma.path_c[j] + cma.c_mu * rank_mu;
+            cma.covariance[i * n + j] = value;
+            cma.covariance[j * n + i] = value;
+        }
+    }
+
+    cma.sigma *= exp(cma.c_sigma / cma.d_sigma * (path_norm / cma.expected_norm - 1));
+
+    // eigen decomposition is done again once its cost is small against the generations
+    if(generation - cma.eigen_generation > 1 / ((cma.c_1 + cma.c_mu) * n * 10))
+    {
+        update_eigen(cma);
+        cma.eigen_generation = generation;
+    }
+}
+
+
+/* prints a race result */
+static void print_race_result(const std::string & track_file, const race_result & result)
+{
+    printf("    %s - %d laps, %.1f m, finish %.2f s, damage %d, off track %.2f s\n",
+            track_file.c_str(), result.laps, result.distance_raced, result.finish_time,
+            result.damage, result.off_track_time);
+}
+
+
+int main(int argc, char * argv[])
+{
+    using namespace controller_fuzzy;
+
+    tune_options options;
+    const int options_read = read_options(argc, argv, options);
+    if(options_read != 0)
+    {
+        print_usage(argv[0]);
+        return (options_read > 0) ? 0 : 1;
+    }
+
+    fuzzy_parameters initial;
+    if(options.initial_file_name != NULL)
+    {
+        if(read_parameters(options.initial_file_name, initial) != 0)
+        {
+            return 1;
+        }
+    }
+    else
+    {
+        get_compiled_parameters(FUZZY_CONTROLLER_VERSION, initial);
+    }
+
+    std::vector<tuned_vertex> vertices;
+    if(find_tuned_vertices(options.variables, initial, vertices) != 0)
+    {
+        return 1;
+    }
+
+    for(int slot = 0; slot < options.jobs; slot++)
+    {
+        if(make_directories(get_slot_robot_directory(options, slot)) != 0)
+        {
+            return 1;
+        }
+#ifdef LINKED_FILE_PREFIX
+        link_robot_files(get_slot_robot_directory(options, slot));
+#endif
+    }
+
+    const int tracks = options.track_files.size();
+    printf("tuning %lu vertices of \'%s\' on %d tracks with %d races at a time\n",
+            vertices.size(), options.variables.c_str(), tracks, options.jobs);
+
+    // cost of the initial parameters
+    std::vector<fuzzy_parameters> parameters(1, initial);
+    std::vector<race_result> results;
+    if(run_races(options, parameters, results) != 0)
+    {
+        return 1;
+    }
+
+    fuzzy_parameters best = initial;
+    strcpy(best.version, options.version.c_str());
+    std::vector<race_result> best_results = results;
+    double best_cost = 0;
+    for(int j = 0; j < tracks; j++)
+    {
+        best_cost += get_race_cost(options, results[j]);
+    }
+    printf("initial parameters ( v%s ) - cost %.2f\n", initial.version, best_cost);
+    for(int j = 0; j < tracks; j++)
+    {
+        print_race_result(options.track_files[j], results[j]);
+    }
+
+    cma_state cma;
+    init_cma(cma, vertices.size(), options.population, options.step_size);
+    std::mt19937 random(options.seed);
+
+    std::vector<candidate> candidates;
+    const double start = get_clock_seconds();
+    for(int generation = 1; generation <= options.generations; generation++)
+    {
+        const double generation_start = get_clock_seconds();
+
+        sample_candidates(cma, random, candidates);
+        parameters.resize(cma.population);
+        std::vector<double> order_costs(cma.population);
+        for(int k = 0; k < cma.population; k++)
+        {
+            order_costs[k] = ORDER_PENALTY * set_parameters(vertices, &candidates[k].x[0],
+                    initial, parameters[k]);
+            strcpy(parameters[k].version, options.version.c_str());
+        }
+
+        if(run_races(options, parameters, results) != 0)
+        {
+            return 1;
+        }
+
+        // candidates are ranked with the cost of putting vertices in order, while
+        // written parameters are those of the best races
+        std::vector<double> race_costs(cma.population, 0);
+        for(int k = 0; k < cma.population; k++)
+        {
+            for(int j = 0; j < tracks; j++)
+            {
+                race_costs[k] += get_race_cost(options, results[k * tracks + j]);
+            }
+            candidates[k].cost = race_costs[k] + order_costs[k];
+        }
+
+        const int generation_best = std::min_element(race_costs.begin(), race_costs.end()) -
+            race_costs.begin();
+        const double generation_cost = race_costs[generation_best];
+        const int is_better = generation_cost < best_cost;
+        if(is_better)
+        {
+            best_cost = generation_cost;
+            best = parameters[generation_best];
+            best_results.assign(results.begin() + generation_best * tracks,
+                    results.begin() + (generation_best + 1) * tracks);
+            if(write_parameters(options.parameter_file_name, best) != 0)
+            {
+                return 1;
+            }
+        }
+
+        std::sort(candidates.begin(), candidates.end(),
+                [](const candidate & a, const candidate & b) { return a.cost < b.cost; });
+        update_cma(cma, candidates, generation);
+
+        printf("generation %d - cost %.2f, best %.2f%s, step size %.4f ( %d races in %.1f s )\n",
+                generation, generation_cost, best_cost, is_better ? " ( written )" : "",
+                cma.sigma, cma.population * tracks, get_clock_seconds() - generation_start);
+        fflush(stdout);
+    }
+
+    if(write_parameters(options.parameter_file_name, best) != 0)
+    {
+        return 1;
+    }
+
+    printf("best parameters ( v%s ) - cost %.2f, written to \'%s\' in %.1f s\n", best.version,
+            best_cost, options.parameter_file_name, get_clock_seconds() - start);
+    for(int j = 0; j < tracks; j++)
+    {
+        print_race_result(options.track_files[j], best_results[j]);
+    }
+
+    return 0;
+}